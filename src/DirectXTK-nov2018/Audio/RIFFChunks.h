@@ -0,0 +1,702 @@
+//--------------------------------------------------------------------------------------
+// File: RIFFChunks.h
+//
+// The RIFF chunk index behind the WAV loaders: a single pass over the chunk list finds the
+// format, data, loop point and seek table chunks, either in a file held in memory or by
+// reading only the chunk headers of a file on disk. This has no Win32 dependencies, so
+// malformed files can be tested on any platform.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+// http://go.microsoft.com/fwlink/?LinkID=615561
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <new>
+
+#include <stdint.h>
+#include <string.h>
+
+#include "WAVFileReader.h"
+
+
+namespace DirectX
+{
+    namespace RIFFChunks
+    {
+        //---------------------------------------------------------------------------------
+        // .WAV files
+        //---------------------------------------------------------------------------------
+        const uint32_t FOURCC_RIFF_TAG = MAKEFOURCC('R', 'I', 'F', 'F');
+        const uint32_t FOURCC_FORMAT_TAG = MAKEFOURCC('f', 'm', 't', ' ');
+        const uint32_t FOURCC_DATA_TAG = MAKEFOURCC('d', 'a', 't', 'a');
+        const uint32_t FOURCC_WAVE_FILE_TAG = MAKEFOURCC('W', 'A', 'V', 'E');
+        const uint32_t FOURCC_XWMA_FILE_TAG = MAKEFOURCC('X', 'W', 'M', 'A');
+        const uint32_t FOURCC_DLS_SAMPLE = MAKEFOURCC('w', 's', 'm', 'p');
+        const uint32_t FOURCC_MIDI_SAMPLE = MAKEFOURCC('s', 'm', 'p', 'l');
+        const uint32_t FOURCC_XWMA_DPDS = MAKEFOURCC('d', 'p', 'd', 's');
+        const uint32_t FOURCC_XMA_SEEK = MAKEFOURCC('s', 'e', 'e', 'k');
+
+#pragma pack(push,1)
+        struct RIFFChunk
+        {
+            uint32_t tag;
+            uint32_t size;
+        };
+
+        struct RIFFChunkHeader
+        {
+            uint32_t tag;
+            uint32_t size;
+            uint32_t riff;
+        };
+
+        struct DLSLoop
+        {
+            static const uint32_t LOOP_TYPE_FORWARD = 0x00000000;
+            static const uint32_t LOOP_TYPE_RELEASE = 0x00000001;
+
+            uint32_t size;
+            uint32_t loopType;
+            uint32_t loopStart;
+            uint32_t loopLength;
+        };
+
+        struct RIFFDLSSample
+        {
+            static const uint32_t OPTIONS_NOTRUNCATION = 0x00000001;
+            static const uint32_t OPTIONS_NOCOMPRESSION = 0x00000002;
+
+            uint32_t    size;
+            uint16_t    unityNote;
+            int16_t     fineTune;
+            int32_t     gain;
+            uint32_t    options;
+            uint32_t    loopCount;
+        };
+
+        struct MIDILoop
+        {
+            static const uint32_t LOOP_TYPE_FORWARD = 0x00000000;
+            static const uint32_t LOOP_TYPE_ALTERNATING = 0x00000001;
+            static const uint32_t LOOP_TYPE_BACKWARD = 0x00000002;
+
+            uint32_t cuePointId;
+            uint32_t type;
+            uint32_t start;
+            uint32_t end;
+            uint32_t fraction;
+            uint32_t playCount;
+        };
+
+        struct RIFFMIDISample
+        {
+            uint32_t        manufacturerId;
+            uint32_t        productId;
+            uint32_t        samplePeriod;
+            uint32_t        unityNode;
+            uint32_t        pitchFraction;
+            uint32_t        SMPTEFormat;
+            uint32_t        SMPTEOffset;
+            uint32_t        loopCount;
+            uint32_t        samplerData;
+        };
+#pragma pack(pop)
+
+        static_assert(sizeof(RIFFChunk) == 8, "structure size mismatch");
+        static_assert(sizeof(RIFFChunkHeader) == 12, "structure size mismatch");
+        static_assert(sizeof(DLSLoop) == 16, "structure size mismatch");
+        static_assert(sizeof(RIFFDLSSample) == 20, "structure size mismatch");
+        static_assert(sizeof(MIDILoop) == 24, "structure size mismatch");
+        static_assert(sizeof(RIFFMIDISample) == 36, "structure size mismatch");
+
+
+        //---------------------------------------------------------------------------------
+        inline const RIFFChunk* FindChunk(
+            _In_reads_bytes_(sizeBytes) const uint8_t* data,
+            _In_ size_t sizeBytes,
+            _In_ uint32_t tag)
+        {
+            if (!data)
+                return nullptr;
+
+            // The offset is kept in 64 bits, so a chunk size near 4 GB cannot wrap it around on 32-bit platforms
+            uint64_t offset = 0;
+
+            while (sizeBytes > (offset + sizeof(RIFFChunk)))
+            {
+                auto header = reinterpret_cast<const RIFFChunk*>(data + offset);
+                if (header->tag == tag)
+                    return header;
+
+                offset += uint64_t(header->size) + sizeof(RIFFChunk);
+            }
+
+            return nullptr;
+        }
+
+
+        //---------------------------------------------------------------------------------
+        // Location of every chunk the loaders use, gathered in a single pass over the RIFF chunk list
+        struct RIFFChunkSpan
+        {
+            const uint8_t*  ptr;        // Chunk payload, or null if it was not loaded
+            uint32_t        size;
+            uint32_t        offset;     // Offset of the payload from the start of the file
+            bool            present;
+        };
+
+        struct WAVChunkIndex
+        {
+            uint32_t        riff;       // 'WAVE' or 'XWMA'
+            const uint8_t*  end;        // End of the memory holding the loaded chunks
+            uint64_t        fileSize;   // Size of the file the chunk offsets refer to
+            RIFFChunkSpan   format;
+            RIFFChunkSpan   data;
+            RIFFChunkSpan   dls;
+            RIFFChunkSpan   midi;
+            RIFFChunkSpan   dpds;
+            RIFFChunkSpan   seek;
+
+            RIFFChunkSpan* Find(uint32_t tag)
+            {
+                switch (tag)
+                {
+                    case FOURCC_FORMAT_TAG: return &format;
+                    case FOURCC_DATA_TAG: return &data;
+                    case FOURCC_DLS_SAMPLE: return &dls;
+                    case FOURCC_MIDI_SAMPLE: return &midi;
+                    case FOURCC_XWMA_DPDS: return &dpds;
+                    case FOURCC_XMA_SEEK: return &seek;
+                    default: return nullptr;
+                }
+            }
+
+            bool IsLoaded(const RIFFChunkSpan& span) const
+            {
+                return span.ptr && (span.size <= size_t(end - span.ptr));
+            }
+        };
+
+
+        //---------------------------------------------------------------------------------
+        inline HRESULT IndexChunks(
+            _In_reads_bytes_(wavDataSize) const uint8_t* wavData,
+            _In_ size_t wavDataSize,
+            _Out_ WAVChunkIndex& index)
+        {
+            memset(&index, 0, sizeof(index));
+
+            if (!wavData)
+                return E_POINTER;
+
+            index.end = wavData + wavDataSize;
+            index.fileSize = wavDataSize;
+
+            // Locate RIFF 'WAVE'
+            auto riffChunk = FindChunk(wavData, wavDataSize, FOURCC_RIFF_TAG);
+            if (!riffChunk || riffChunk->size < 4)
+            {
+                return E_FAIL;
+            }
+
+            // FindChunk only guarantees the chunk header, not the form type that follows it
+            if ((reinterpret_cast<const uint8_t*>(riffChunk) + sizeof(RIFFChunkHeader)) > index.end)
+            {
+                return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+            }
+
+            auto riffHeader = reinterpret_cast<const RIFFChunkHeader*>(riffChunk);
+            if (riffHeader->riff != FOURCC_WAVE_FILE_TAG && riffHeader->riff != FOURCC_XWMA_FILE_TAG)
+            {
+                return E_FAIL;
+            }
+
+            index.riff = riffHeader->riff;
+
+            auto ptr = reinterpret_cast<const uint8_t*>(riffHeader) + sizeof(RIFFChunkHeader);
+            if ((ptr + sizeof(RIFFChunk)) > index.end)
+            {
+                return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+            }
+
+            // Walk the chunk list once, keeping the first chunk of each kind
+            uint64_t length = std::min<uint64_t>(riffChunk->size - sizeof(uint32_t), uint64_t(index.end - ptr));
+            uint64_t offset = 0;
+
+            while (length > (offset + sizeof(RIFFChunk)))
+            {
+                auto header = reinterpret_cast<const RIFFChunk*>(ptr + offset);
+
+                auto span = index.Find(header->tag);
+                if (span && !span->present)
+                {
+                    span->ptr = ptr + offset + sizeof(RIFFChunk);
+                    span->size = header->size;
+                    span->offset = uint32_t(span->ptr - wavData);
+                    span->present = true;
+                }
+
+                offset += uint64_t(header->size) + sizeof(RIFFChunk);
+            }
+
+            return S_OK;
+        }
+
+
+        //---------------------------------------------------------------------------------
+        inline HRESULT WaveFindFormatAndData(
+            const WAVChunkIndex& index,
+            _Outptr_ const WAVEFORMATEX** pwfx,
+            _Outptr_result_maybenull_ const uint8_t** pdata,
+            _Out_ uint32_t* dataSize,
+            _Out_ bool& dpds,
+            _Out_ bool& seek)
+        {
+            if (!pwfx || !pdata || !dataSize)
+                return E_POINTER;
+
+            dpds = seek = false;
+
+            // Locate 'fmt '
+            auto& fmtChunk = index.format;
+            if (!fmtChunk.present || fmtChunk.size < sizeof(PCMWAVEFORMAT))
+            {
+                return E_FAIL;
+            }
+
+            if (!index.IsLoaded(fmtChunk))
+            {
+                return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+            }
+
+            auto ptr = fmtChunk.ptr;
+            auto wf = reinterpret_cast<const WAVEFORMAT*>(ptr);
+
+            // Validate WAVEFORMAT (focused on chunk size and format tag, not other data that XAUDIO2 will validate)
+            switch (wf->wFormatTag)
+            {
+                case WAVE_FORMAT_PCM:
+                case WAVE_FORMAT_IEEE_FLOAT:
+                    // Can be a PCMWAVEFORMAT (16 bytes) or WAVEFORMATEX (18 bytes)
+                    // We validiated chunk as at least sizeof(PCMWAVEFORMAT) above
+                    break;
+
+                default:
+                {
+                    if (fmtChunk.size < sizeof(WAVEFORMATEX))
+                    {
+                        return E_FAIL;
+                    }
+
+                    auto wfx = reinterpret_cast<const WAVEFORMATEX*>(ptr);
+
+                    if (fmtChunk.size < (sizeof(WAVEFORMATEX) + wfx->cbSize))
+                    {
+                        return E_FAIL;
+                    }
+
+                    switch (wfx->wFormatTag)
+                    {
+                        case WAVE_FORMAT_WMAUDIO2:
+                        case WAVE_FORMAT_WMAUDIO3:
+                            dpds = true;
+                            break;
+
+                        case  0x166 /*WAVE_FORMAT_XMA2*/: // XMA2 is supported by Xbox One
+                            if ((fmtChunk.size < 52 /*sizeof(XMA2WAVEFORMATEX)*/) || (wfx->cbSize < 34 /*( sizeof(XMA2WAVEFORMATEX) - sizeof(WAVEFORMATEX) )*/))
+                            {
+                                return E_FAIL;
+                            }
+                            seek = true;
+                            break;
+
+                        case WAVE_FORMAT_ADPCM:
+                            if ((fmtChunk.size < (sizeof(WAVEFORMATEX) + 32)) || (wfx->cbSize < 32 /*MSADPCM_FORMAT_EXTRA_BYTES*/))
+                            {
+                                return E_FAIL;
+                            }
+                            break;
+
+                        case WAVE_FORMAT_EXTENSIBLE:
+                            if ((fmtChunk.size < sizeof(WAVEFORMATEXTENSIBLE)) || (wfx->cbSize < (sizeof(WAVEFORMATEXTENSIBLE) - sizeof(WAVEFORMATEX))))
+                            {
+                                return E_FAIL;
+                            }
+                            else
+                            {
+                                static const GUID s_wfexBase = { 0x00000000, 0x0000, 0x0010, { 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71 } };
+
+                                auto wfex = reinterpret_cast<const WAVEFORMATEXTENSIBLE*>(ptr);
+
+                                if (memcmp(reinterpret_cast<const BYTE*>(&wfex->SubFormat) + sizeof(DWORD),
+                                    reinterpret_cast<const BYTE*>(&s_wfexBase) + sizeof(DWORD), sizeof(GUID) - sizeof(DWORD)) != 0)
+                                {
+                                    return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+                                }
+
+                                switch (wfex->SubFormat.Data1)
+                                {
+                                    case WAVE_FORMAT_PCM:
+                                    case WAVE_FORMAT_IEEE_FLOAT:
+                                        break;
+
+                                    // MS-ADPCM and XMA2 are not supported as WAVEFORMATEXTENSIBLE
+
+                                    case WAVE_FORMAT_WMAUDIO2:
+                                    case WAVE_FORMAT_WMAUDIO3:
+                                        dpds = true;
+                                        break;
+
+                                    default:
+                                        return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+                                }
+
+                            }
+                            break;
+
+                        default:
+                            return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+                    }
+                }
+            }
+
+            // Locate 'data'
+            auto& dataChunk = index.data;
+            if (!dataChunk.present || !dataChunk.size)
+            {
+                return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+            }
+
+            // Header-only loads skip the payload, so it is checked against the size of the file
+            if ((uint64_t(dataChunk.offset) + dataChunk.size) > index.fileSize)
+            {
+                return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+            }
+
+            *pwfx = reinterpret_cast<const WAVEFORMATEX*>(wf);
+            *pdata = dataChunk.ptr;
+            *dataSize = dataChunk.size;
+            return S_OK;
+        }
+
+
+        //---------------------------------------------------------------------------------
+        inline HRESULT WaveFindLoopInfo(
+            const WAVChunkIndex& index,
+            _Out_ uint32_t* pLoopStart,
+            _Out_ uint32_t* pLoopLength)
+        {
+            if (!pLoopStart || !pLoopLength)
+                return E_POINTER;
+
+            *pLoopStart = 0;
+            *pLoopLength = 0;
+
+            if (index.riff == FOURCC_XWMA_FILE_TAG)
+            {
+                // xWMA files do not contain loop information
+                return S_OK;
+            }
+
+            if (index.riff != FOURCC_WAVE_FILE_TAG)
+            {
+                return E_FAIL;
+            }
+
+            // Locate 'wsmp' (DLS Chunk)
+            auto& dlsChunk = index.dls;
+            if (dlsChunk.present)
+            {
+                if (!index.IsLoaded(dlsChunk))
+                {
+                    return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+                }
+
+                if (dlsChunk.size >= sizeof(RIFFDLSSample))
+                {
+                    auto dlsSample = reinterpret_cast<const RIFFDLSSample*>(dlsChunk.ptr);
+
+                    if (dlsChunk.size >= (uint64_t(dlsSample->size) + uint64_t(dlsSample->loopCount) * sizeof(DLSLoop)))
+                    {
+                        auto loops = reinterpret_cast<const DLSLoop*>(dlsChunk.ptr + dlsSample->size);
+                        for (uint32_t j = 0; j < dlsSample->loopCount; ++j)
+                        {
+                            if ((loops[j].loopType == DLSLoop::LOOP_TYPE_FORWARD || loops[j].loopType == DLSLoop::LOOP_TYPE_RELEASE))
+                            {
+                                // Return 'forward' loop
+                                *pLoopStart = loops[j].loopStart;
+                                *pLoopLength = loops[j].loopLength;
+                                return S_OK;
+                            }
+                        }
+                    }
+                }
+            }
+
+            // Locate 'smpl' (Sample Chunk)
+            auto& midiChunk = index.midi;
+            if (midiChunk.present)
+            {
+                if (!index.IsLoaded(midiChunk))
+                {
+                    return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+                }
+
+                if (midiChunk.size >= sizeof(RIFFMIDISample))
+                {
+                    auto midiSample = reinterpret_cast<const RIFFMIDISample*>(midiChunk.ptr);
+
+                    if (midiChunk.size >= (sizeof(RIFFMIDISample) + uint64_t(midiSample->loopCount) * sizeof(MIDILoop)))
+                    {
+                        auto loops = reinterpret_cast<const MIDILoop*>(midiChunk.ptr + sizeof(RIFFMIDISample));
+                        for (uint32_t j = 0; j < midiSample->loopCount; ++j)
+                        {
+                            if (loops[j].type == MIDILoop::LOOP_TYPE_FORWARD)
+                            {
+                                // Return 'forward' loop
+                                *pLoopStart = loops[j].start;
+                                *pLoopLength = loops[j].end + loops[j].start + 1;
+                                return S_OK;
+                            }
+                        }
+                    }
+                }
+            }
+
+            return S_OK;
+        }
+
+
+        //---------------------------------------------------------------------------------
+        inline HRESULT WaveFindTable(
+            const WAVChunkIndex& index,
+            const RIFFChunkSpan& tableChunk,
+            _Outptr_result_maybenull_ const uint32_t** pData,
+            _Out_ uint32_t* dataCount)
+        {
+            if (!pData || !dataCount)
+                return E_POINTER;
+
+            *pData = nullptr;
+            *dataCount = 0;
+
+            if (tableChunk.present)
+            {
+                if (!index.IsLoaded(tableChunk))
+                {
+                    return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+                }
+
+                if ((tableChunk.size % sizeof(uint32_t)) != 0)
+                {
+                    return E_FAIL;
+                }
+
+                *pData = reinterpret_cast<const uint32_t*>(tableChunk.ptr);
+                *dataCount = tableChunk.size / 4;
+            }
+
+            return S_OK;
+        }
+
+
+        //---------------------------------------------------------------------------------
+        inline HRESULT WaveParseChunks(
+            const WAVChunkIndex& index,
+            _Out_ DirectX::WAVData& result)
+        {
+            bool dpds, seek;
+            HRESULT hr = WaveFindFormatAndData(index, &result.wfx, &result.startAudio, &result.audioBytes, dpds, seek);
+            if (FAILED(hr))
+                return hr;
+
+            hr = WaveFindLoopInfo(index, &result.loopStart, &result.loopLength);
+            if (FAILED(hr))
+                return hr;
+
+            if (dpds)
+            {
+                hr = WaveFindTable(index, index.dpds, &result.seek, &result.seekCount);
+                if (FAILED(hr))
+                    return hr;
+            }
+            else if (seek)
+            {
+                hr = WaveFindTable(index, index.seek, &result.seek, &result.seekCount);
+                if (FAILED(hr))
+                    return hr;
+            }
+
+            return S_OK;
+        }
+
+
+        //---------------------------------------------------------------------------------
+        // Builds the chunk index from the chunk headers alone. The sample data is skipped, and only the
+        // small chunks the loaders parse (format, loop points and seek tables) are read into wavData.
+        // readFile(offset, dest, size) reads exactly size bytes of the file at offset.
+        //
+        // The result matches IndexChunks over the whole file: a chunk that runs past the end of the file
+        // is indexed but not loaded, so it fails the same way when a loader uses it.
+        template<typename ReadFile>
+        HRESULT IndexChunksFromFile(
+            ReadFile readFile,
+            _In_ uint32_t fileSize,
+            _Inout_ std::unique_ptr<uint8_t[]>& wavData,
+            _Out_ WAVChunkIndex& index)
+        {
+            memset(&index, 0, sizeof(index));
+
+            index.fileSize = fileSize;
+
+            // The chunk directory of most files fits in the first block, so it is read just once
+            static const DWORD DIRECTORY_BLOCK_SIZE = 4096;
+
+            // Bounds the I/O for the chunks that are loaded; real format, loop and seek chunks are far smaller
+            static const uint32_t MAX_HEADER_CHUNK_SIZE = 16 * 1024 * 1024;
+
+            uint8_t block[DIRECTORY_BLOCK_SIZE];
+            DWORD blockBytes = std::min<DWORD>(fileSize, DIRECTORY_BLOCK_SIZE);
+
+            auto readAt = [&](uint32_t offset, _Out_writes_bytes_(size) void* dest, DWORD size) -> HRESULT
+            {
+                if ((uint64_t(offset) + size) > fileSize)
+                    return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+
+                if ((uint64_t(offset) + size) <= blockBytes)
+                {
+                    memcpy(dest, block + offset, size);
+                    return S_OK;
+                }
+
+                return readFile(offset, dest, size);
+            };
+
+            HRESULT hr = readFile(0, block, blockBytes);
+            if (FAILED(hr))
+                return hr;
+
+            // Locate RIFF 'WAVE'
+            RIFFChunkHeader riffHeader = {};
+            uint32_t riffOffset = 0;
+            for (;;)
+            {
+                if ((uint64_t(riffOffset) + sizeof(RIFFChunk)) >= fileSize)
+                    return E_FAIL;
+
+                hr = readAt(riffOffset, &riffHeader, sizeof(RIFFChunk));
+                if (FAILED(hr))
+                    return hr;
+
+                if (riffHeader.tag == FOURCC_RIFF_TAG)
+                    break;
+
+                uint64_t next = uint64_t(riffOffset) + riffHeader.size + sizeof(RIFFChunk);
+                if (next >= fileSize)
+                    return E_FAIL;
+
+                riffOffset = uint32_t(next);
+            }
+
+            if (riffHeader.size < 4)
+            {
+                return E_FAIL;
+            }
+
+            hr = readAt(riffOffset, &riffHeader, sizeof(RIFFChunkHeader));
+            if (FAILED(hr))
+                return hr;
+
+            if (riffHeader.riff != FOURCC_WAVE_FILE_TAG && riffHeader.riff != FOURCC_XWMA_FILE_TAG)
+            {
+                return E_FAIL;
+            }
+
+            index.riff = riffHeader.riff;
+
+            uint64_t offset = uint64_t(riffOffset) + sizeof(RIFFChunkHeader);
+            if ((offset + sizeof(RIFFChunk)) > fileSize)
+            {
+                return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+            }
+
+            // Walk the chunk list, reading only the chunk headers
+            uint64_t end = std::min<uint64_t>(offset + riffHeader.size - sizeof(uint32_t), fileSize);
+
+            size_t loadBytes = 0;
+            while (end > (offset + sizeof(RIFFChunk)))
+            {
+                RIFFChunk header;
+                hr = readAt(uint32_t(offset), &header, sizeof(RIFFChunk));
+                if (FAILED(hr))
+                    return hr;
+
+                auto span = index.Find(header.tag);
+                if (span && !span->present)
+                {
+                    span->size = header.size;
+                    span->offset = uint32_t(offset + sizeof(RIFFChunk));
+                    span->present = true;
+
+                    if (span != &index.data && (uint64_t(span->offset) + span->size) <= fileSize)
+                    {
+                        if (span->size > MAX_HEADER_CHUNK_SIZE)
+                            return HRESULT_FROM_WIN32(ERROR_FILE_TOO_LARGE);
+
+                        // Room for a full WAVEFORMATEX, keeping the tables that follow 4-byte aligned
+                        size_t bytes = (span == &index.format) ? std::max<size_t>(span->size, sizeof(WAVEFORMATEX)) : span->size;
+                        loadBytes += (bytes + 3) & ~size_t(3);
+                    }
+                }
+
+                offset += uint64_t(header.size) + sizeof(RIFFChunk);
+            }
+
+            if (!index.format.present)
+            {
+                return E_FAIL;
+            }
+
+            // Load the small chunks
+            wavData.reset(new (std::nothrow) uint8_t[loadBytes]);
+            if (!wavData)
+            {
+                return E_OUTOFMEMORY;
+            }
+
+            memset(wavData.get(), 0, loadBytes);
+
+            index.end = wavData.get() + loadBytes;
+
+            uint8_t* dest = wavData.get();
+
+            RIFFChunkSpan* spans[] = { &index.format, &index.dls, &index.midi, &index.dpds, &index.seek };
+            for (size_t j = 0; j < _countof(spans); ++j)
+            {
+                auto span = spans[j];
+                if (!span->present || (uint64_t(span->offset) + span->size) > fileSize)
+                    continue;
+
+                if (span->size > 0)
+                {
+                    hr = readAt(span->offset, dest, span->size);
+                    if (FAILED(hr))
+                        return hr;
+                }
+
+                span->ptr = dest;
+
+                size_t bytes = (span == &index.format) ? std::max<size_t>(span->size, sizeof(WAVEFORMATEX)) : span->size;
+                dest += (bytes + 3) & ~size_t(3);
+            }
+
+            return S_OK;
+        }
+    }
+}
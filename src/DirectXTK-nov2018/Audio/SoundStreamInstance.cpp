@@ -0,0 +1,557 @@
+//--------------------------------------------------------------------------------------
+// File: SoundStreamInstance.cpp
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+// http://go.microsoft.com/fwlink/?LinkID=615561
+//--------------------------------------------------------------------------------------
+
+#include "pch.h"
+#include "SoundCommon.h"
+#include "StreamingRing.h"
+#include "WaveBankReader.h"
+
+using namespace DirectX;
+
+
+namespace
+{
+    // Reads for the ring, as overlapped reads on the bank's unbuffered handle
+    class OverlappedReader
+    {
+    public:
+        OverlappedReader() noexcept :
+            mAsync(INVALID_HANDLE_VALUE),
+            mIndex(0),
+            mRequests{}
+        {
+        }
+
+        void Initialize(HANDLE async, uint32_t index)
+        {
+            for (size_t j = 0; j < STREAMING_BUFFER_COUNT; ++j)
+            {
+                mEvents[j].reset(CreateEventEx(nullptr, nullptr, CREATE_EVENT_MANUAL_RESET, EVENT_MODIFY_STATE | SYNCHRONIZE));
+                if (!mEvents[j])
+                {
+                    throw std::exception("CreateEvent");
+                }
+            }
+
+            mAsync = async;
+            mIndex = index;
+        }
+
+        void Close() noexcept
+        {
+            mAsync = INVALID_HANDLE_VALUE;
+        }
+
+        void BeginRead(size_t buffer, _Out_writes_bytes_(bytes) uint8_t* data, uint64_t offset, uint32_t bytes)
+        {
+            auto& request = mRequests[buffer];
+
+            memset(&request, 0, sizeof(OVERLAPPED));
+            request.Offset = static_cast<DWORD>(offset & 0xFFFFFFFF);
+            request.OffsetHigh = static_cast<DWORD>(offset >> 32);
+            request.hEvent = mEvents[buffer].get();
+
+            if (!ReadFile(mAsync, data, bytes, nullptr, &request))
+            {
+                DWORD error = GetLastError();
+                if (error != ERROR_IO_PENDING)
+                {
+                    DebugTrace("ERROR: SoundStreamInstance failed (%08X) to read wave bank entry %u\n", HRESULT_FROM_WIN32(error), mIndex);
+                    throw std::exception("ReadFile");
+                }
+            }
+        }
+
+        bool IsReadComplete(size_t buffer, uint32_t& bytesRead)
+        {
+            auto& request = mRequests[buffer];
+
+            DWORD bytes = 0;
+
+        #if (_WIN32_WINNT >= _WIN32_WINNT_WIN8)
+            if (!GetOverlappedResultEx(mAsync, &request, &bytes, 0, FALSE))
+            {
+                DWORD error = GetLastError();
+                if (error == WAIT_TIMEOUT || error == ERROR_IO_INCOMPLETE)
+                    return false;
+
+                DebugTrace("ERROR: SoundStreamInstance failed (%08X) to read wave bank entry %u\n", HRESULT_FROM_WIN32(error), mIndex);
+                throw std::exception("GetOverlappedResultEx");
+            }
+        #else
+            if (!HasOverlappedIoCompleted(&request))
+                return false;
+
+            if (!GetOverlappedResult(mAsync, &request, &bytes, FALSE))
+            {
+                DebugTrace("ERROR: SoundStreamInstance failed (%08X) to read wave bank entry %u\n", HRESULT_FROM_WIN32(GetLastError()), mIndex);
+                throw std::exception("GetOverlappedResult");
+            }
+        #endif
+
+            bytesRead = bytes;
+            return true;
+        }
+
+        void CancelRead(size_t buffer)
+        {
+            if (mAsync == INVALID_HANDLE_VALUE)
+                return;
+
+            // The read must finish before its buffer is reused or freed
+            auto& request = mRequests[buffer];
+
+            (void)CancelIoEx(mAsync, &request);
+
+            DWORD bytes;
+            (void)GetOverlappedResult(mAsync, &request, &bytes, TRUE);
+        }
+
+    private:
+        HANDLE          mAsync;
+        uint32_t        mIndex;
+        ScopedHandle    mEvents[STREAMING_BUFFER_COUNT];
+        OVERLAPPED      mRequests[STREAMING_BUFFER_COUNT];
+    };
+}
+
+
+//======================================================================================
+// SoundStreamInstance
+//======================================================================================
+
+// Internal object implementation class.
+class SoundStreamInstance::Impl : public IVoiceNotify
+{
+public:
+    Impl(_In_ AudioEngine* engine, _In_ WaveBank* waveBank, uint32_t index, SOUND_EFFECT_INSTANCE_FLAGS flags) noexcept(false) :
+        mBase(),
+        mWaveBank(waveBank),
+        mIndex(index),
+        mBlockAlign(0),
+        mSeekTable(nullptr),
+        mSeekCount(0),
+        mWMA(false),
+        mWaveFormat{}
+    {
+        assert(engine != nullptr);
+        assert(mWaveBank != nullptr);
+
+        auto wfx = mWaveBank->GetFormat(index, reinterpret_cast<WAVEFORMATEX*>(mWaveFormat), sizeof(mWaveFormat));
+        if (!wfx)
+        {
+            throw std::exception("SoundStreamInstance");
+        }
+
+        WaveBankReader::Metadata metadata = {};
+        if (!mWaveBank->GetPrivateData(index, &metadata, sizeof(metadata)))
+        {
+            throw std::exception("SoundStreamInstance");
+        }
+
+        switch (GetFormatTag(wfx))
+        {
+            case WAVE_FORMAT_PCM:
+            case WAVE_FORMAT_IEEE_FLOAT:
+            case WAVE_FORMAT_ADPCM:
+                break;
+
+        #if defined(_XBOX_ONE) || (_WIN32_WINNT < _WIN32_WINNT_WIN8) || (_WIN32_WINNT >= _WIN32_WINNT_WIN10)
+            case WAVE_FORMAT_WMAUDIO2:
+            case WAVE_FORMAT_WMAUDIO3:
+            {
+                // xWMA buffers need the decoded packet sizes for the packets they contain
+                WaveBankReader::SeekData seekData = {};
+                if (!mWaveBank->GetPrivateData(index, &seekData, sizeof(seekData)) || !seekData.seekTable)
+                {
+                    DebugTrace("ERROR: SoundStreamInstance requires a seek table for xWMA wave bank entry %u\n", index);
+                    throw std::exception("SoundStreamInstance");
+                }
+
+                mSeekTable = seekData.seekTable;
+                mSeekCount = seekData.seekCount;
+                mWMA = true;
+            }
+            break;
+        #endif
+
+            default:
+                DebugTrace("ERROR: SoundStreamInstance does not support format tag %u\n", GetFormatTag(wfx));
+                throw std::exception("SoundStreamInstance");
+        }
+
+        mBlockAlign = wfx->nBlockAlign;
+        if (!mBlockAlign || (mBlockAlign > (STREAMING_BUFFER_SIZE - STREAMING_SECTOR_ALIGNMENT)))
+        {
+            DebugTrace("ERROR: SoundStreamInstance block alignment %u is too large for a streaming buffer\n", mBlockAlign);
+            throw std::exception("SoundStreamInstance");
+        }
+
+        // Only whole blocks are submitted, so a trailing partial block is never played
+        uint32_t lengthBytes = metadata.lengthBytes - (metadata.lengthBytes % mBlockAlign);
+        if (!lengthBytes)
+        {
+            DebugTrace("ERROR: SoundStreamInstance wave bank entry %u has no audio data\n", index);
+            throw std::exception("SoundStreamInstance");
+        }
+
+        HANDLE async = mWaveBank->GetAsyncHandle();
+        if (async == INVALID_HANDLE_VALUE)
+        {
+            throw std::exception("SoundStreamInstance");
+        }
+
+        mReader.Initialize(async, index);
+
+        mBufferMemory.reset(static_cast<uint8_t*>(_aligned_malloc(STREAMING_BUFFER_SIZE * STREAMING_BUFFER_COUNT, STREAMING_SECTOR_ALIGNMENT)));
+        if (!mBufferMemory)
+        {
+            throw std::bad_alloc();
+        }
+
+        if (mWMA)
+        {
+            for (size_t j = 0; j < STREAMING_BUFFER_COUNT; ++j)
+            {
+                mPackets[j].resize(STREAMING_BUFFER_SIZE / mBlockAlign + 1);
+            }
+        }
+
+        mRing = std::make_unique<Ring>(mBufferMemory.get(), metadata.offsetBytes, lengthBytes, mBlockAlign);
+
+        mBase.Initialize(engine, wfx, flags);
+
+        engine->RegisterNotify(this, true);
+    }
+
+    virtual ~Impl() override
+    {
+        mBase.DestroyVoice();
+
+        mRing->Cancel(mReader);
+
+        if (mBase.engine)
+        {
+            mBase.engine->UnregisterNotify(this, false, true);
+            mBase.engine = nullptr;
+        }
+    }
+
+    void Play(bool loop);
+
+    void Stop(bool immediate);
+
+    bool IsLooped() const { return mRing->IsLooped(); }
+
+    SoundState GetState()
+    {
+        // Until the final buffer is queued, an empty voice is a read that has not landed yet rather than the end
+        return mBase.GetState(mRing->HasStreamEnded());
+    }
+
+    void OnDestroyParent()
+    {
+        mRing->Cancel(mReader);
+
+        mBase.OnDestroy();
+        mWaveBank = nullptr;
+        mReader.Close();
+    }
+
+    const WAVEFORMATEX* GetFormat() const { return reinterpret_cast<const WAVEFORMATEX*>(mWaveFormat); }
+
+    // IVoiceNotify
+    virtual void __cdecl OnBufferEnd() override
+    {
+        // We don't register for this notification for SoundStreamInstances, so this should not be invoked
+        assert(false);
+    }
+
+    virtual void __cdecl OnCriticalError() override
+    {
+        mBase.OnCriticalError();
+    }
+
+    virtual void __cdecl OnReset() override
+    {
+        mBase.OnReset();
+    }
+
+    virtual void __cdecl OnUpdate() override;
+
+    virtual void __cdecl OnDestroyEngine() override
+    {
+        mBase.OnDestroy();
+    }
+
+    virtual void __cdecl OnTrim() override
+    {
+        mBase.OnTrim();
+    }
+
+    virtual void __cdecl GatherStatistics(AudioStatistics& stats) const override
+    {
+        mBase.GatherStatistics(stats);
+    }
+
+    // StreamingRing sink
+    size_t GetPendingBufferCount() const
+    {
+        return static_cast<size_t>(mBase.GetPendingBufferCount());
+    }
+
+    void SubmitBuffer(_In_reads_bytes_(length) const uint8_t* data, uint32_t position, uint32_t length, bool endOfStream);
+
+    void EndStream()
+    {
+        // Flags the last queued buffer as the end of the stream
+        ThrowIfFailed(mBase.voice->Discontinuity());
+    }
+
+    SoundEffectInstanceBase         mBase;
+    WaveBank*                       mWaveBank;
+    uint32_t                        mIndex;
+
+private:
+    using Ring = StreamingRing<OverlappedReader, Impl>;
+
+    uint32_t                                    mBlockAlign;
+    const uint32_t*                             mSeekTable;
+    uint32_t                                    mSeekCount;
+    bool                                        mWMA;
+
+    OverlappedReader                            mReader;
+    std::unique_ptr<uint8_t, aligned_deleter>   mBufferMemory;
+    std::unique_ptr<Ring>                       mRing;
+    std::vector<uint32_t>                       mPackets[STREAMING_BUFFER_COUNT];   // Cumulative decoded bytes per packet for xWMA
+
+    uint8_t                                     mWaveFormat[64];
+};
+
+
+void SoundStreamInstance::Impl::Play(bool loop)
+{
+    if (mBase.state == PAUSED)
+    {
+        mBase.Resume();
+        return;
+    }
+
+    if (mBase.state == PLAYING || !mWaveBank)
+        return;
+
+    // A voice stopped without a flush may still reference the ring, and destroying it waits for XAudio2 to let go
+    if (mBase.voice && mBase.GetPendingBufferCount() > 0)
+    {
+        mBase.DestroyVoice();
+    }
+
+    if (!mBase.voice)
+    {
+        mBase.AllocateVoice(GetFormat());
+    }
+
+    if (!mBase.voice)
+        return;
+
+    // Reads complete while the voice starts; AudioEngine::Update submits them as they arrive
+    mRing->Play(mReader, loop);
+
+    (void)mBase.Play();
+}
+
+
+void SoundStreamInstance::Impl::Stop(bool immediate)
+{
+    if (!immediate && mRing->IsLooped())
+    {
+        // Finish the current pass through the wave
+        mRing->ExitLoop();
+        return;
+    }
+
+    bool looped = false;
+    mBase.Stop(immediate, looped);
+    mBase.state = STOPPED;
+
+    mRing->Stop(mReader);
+}
+
+
+void SoundStreamInstance::Impl::OnUpdate()
+{
+    if (!mBase.voice || mBase.state == STOPPED)
+        return;
+
+    mRing->Update(mReader, *this);
+}
+
+
+_Use_decl_annotations_
+void SoundStreamInstance::Impl::SubmitBuffer(const uint8_t* data, uint32_t position, uint32_t length, bool endOfStream)
+{
+    XAUDIO2_BUFFER xbuffer = {};
+    xbuffer.AudioBytes = length;
+    xbuffer.pAudioData = data;
+    xbuffer.pContext = nullptr;
+
+    if (endOfStream)
+    {
+        xbuffer.Flags = XAUDIO2_END_OF_STREAM;
+    }
+
+    HRESULT hr;
+#if defined(_XBOX_ONE) || (_WIN32_WINNT < _WIN32_WINNT_WIN8) || (_WIN32_WINNT >= _WIN32_WINNT_WIN10)
+    if (mWMA)
+    {
+        // XAudio2 reads the packet table while the buffer plays, so each ring buffer has its own
+        auto& packets = mPackets[static_cast<size_t>(data - mBufferMemory.get()) / STREAMING_BUFFER_SIZE];
+
+        if (!RebaseSeekTable(mSeekTable, mSeekCount, position, length, mBlockAlign, packets.data()))
+        {
+            DebugTrace("ERROR: SoundStreamInstance seek table for wave bank entry %u is too short\n", mIndex);
+            throw std::exception("SubmitSourceBuffer");
+        }
+
+        XAUDIO2_BUFFER_WMA wmaBuffer = {};
+        wmaBuffer.pDecodedPacketCumulativeBytes = packets.data();
+        wmaBuffer.PacketCount = length / mBlockAlign;
+
+        hr = mBase.voice->SubmitSourceBuffer(&xbuffer, &wmaBuffer);
+    }
+    else
+    #endif
+    {
+        hr = mBase.voice->SubmitSourceBuffer(&xbuffer, nullptr);
+    }
+
+    if (FAILED(hr))
+    {
+    #ifdef _DEBUG
+        DebugTrace("ERROR: SoundStreamInstance failed (%08X) when submitting buffer:\n", hr);
+
+        auto wfx = GetFormat();
+        DebugTrace("\tFormat Tag %u, %u channels, %u-bit, %u Hz, %u bytes [%u offset)\n", wfx->wFormatTag,
+                   wfx->nChannels, wfx->wBitsPerSample, wfx->nSamplesPerSec, length, position);
+    #endif
+        throw std::exception("SubmitSourceBuffer");
+    }
+}
+
+
+
+//--------------------------------------------------------------------------------------
+// SoundStreamInstance
+//--------------------------------------------------------------------------------------
+
+// Private constructors
+_Use_decl_annotations_
+SoundStreamInstance::SoundStreamInstance(AudioEngine* engine, WaveBank* waveBank, int index, SOUND_EFFECT_INSTANCE_FLAGS flags) :
+    pImpl(std::make_unique<Impl>(engine, waveBank, index, flags))
+{
+}
+
+
+// Move constructor.
+SoundStreamInstance::SoundStreamInstance(SoundStreamInstance&& moveFrom) noexcept
+    : pImpl(std::move(moveFrom.pImpl))
+{
+}
+
+
+// Move assignment.
+SoundStreamInstance& SoundStreamInstance::operator= (SoundStreamInstance&& moveFrom) noexcept
+{
+    pImpl = std::move(moveFrom.pImpl);
+    return *this;
+}
+
+
+// Public destructor.
+SoundStreamInstance::~SoundStreamInstance()
+{
+    if (pImpl)
+    {
+        if (pImpl->mWaveBank)
+        {
+            pImpl->mWaveBank->UnregisterInstance(this);
+            pImpl->mWaveBank = nullptr;
+        }
+    }
+}
+
+
+// Public methods.
+void SoundStreamInstance::Play(bool loop)
+{
+    pImpl->Play(loop);
+}
+
+
+void SoundStreamInstance::Stop(bool immediate)
+{
+    pImpl->Stop(immediate);
+}
+
+
+void SoundStreamInstance::Pause()
+{
+    pImpl->mBase.Pause();
+}
+
+
+void SoundStreamInstance::Resume()
+{
+    pImpl->mBase.Resume();
+}
+
+
+void SoundStreamInstance::SetVolume(float volume)
+{
+    pImpl->mBase.SetVolume(volume);
+}
+
+
+void SoundStreamInstance::SetPitch(float pitch)
+{
+    pImpl->mBase.SetPitch(pitch);
+}
+
+
+void SoundStreamInstance::SetPan(float pan)
+{
+    pImpl->mBase.SetPan(pan);
+}
+
+
+void SoundStreamInstance::Apply3D(const AudioListener& listener, const AudioEmitter& emitter, bool rhcoords)
+{
+    pImpl->mBase.Apply3D(listener, emitter, rhcoords);
+}
+
+
+// Public accessors.
+bool SoundStreamInstance::IsLooped() const
+{
+    return pImpl->IsLooped();
+}
+
+
+SoundState SoundStreamInstance::GetState()
+{
+    return pImpl->GetState();
+}
+
+
+// Notifications.
+void SoundStreamInstance::OnDestroyParent()
+{
+    pImpl->OnDestroyParent();
+}
@@ -0,0 +1,315 @@
+//--------------------------------------------------------------------------------------
+// File: StreamingRing.h
+//
+// The read-ahead ring used by SoundStreamInstance. Reads and playback go through the reader
+// and sink it is given, so it has no XAudio2 or Win32 dependencies, and can be tested with a
+// file-backed reader and a null sink.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+// http://go.microsoft.com/fwlink/?LinkID=615561
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <exception>
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+
+namespace DirectX
+{
+    const size_t STREAMING_BUFFER_COUNT = 3;
+    const size_t STREAMING_BUFFER_SIZE = 65536;
+
+    // Streaming wave banks are opened with FILE_FLAG_NO_BUFFERING, so read offsets, read sizes, and
+    // buffer addresses must all be multiples of the volume sector size.
+    const size_t STREAMING_SECTOR_ALIGNMENT = 4096;
+
+    static_assert((STREAMING_BUFFER_SIZE % STREAMING_SECTOR_ALIGNMENT) == 0, "Streaming buffers must be whole sectors");
+
+
+    // xWMA packets are whole blocks, so a buffer's decoded packet sizes are the bank's cumulative
+    // seek table rebased onto the buffer's first packet. Returns false if the table is too short.
+    inline bool RebaseSeekTable(
+        _In_reads_(seekCount) const uint32_t* seekTable, uint32_t seekCount,
+        uint32_t position, uint32_t length, uint32_t blockAlign,
+        _Out_writes_(length / blockAlign) uint32_t* packets)
+    {
+        uint32_t firstPacket = position / blockAlign;
+        uint32_t packetCount = length / blockAlign;
+
+        if (uint64_t(firstPacket) + packetCount > seekCount)
+            return false;
+
+        uint32_t base = (firstPacket > 0) ? seekTable[firstPacket - 1] : 0;
+        for (uint32_t j = 0; j < packetCount; ++j)
+        {
+            packets[j] = seekTable[firstPacket + j] - base;
+        }
+
+        return true;
+    }
+
+
+    // Plays one wave bank entry through STREAMING_BUFFER_COUNT buffers, reading ahead of playback.
+    // Reads may complete in any order, but buffers are submitted in file order.
+    //
+    // TReader issues the reads:
+    //   void BeginRead(size_t buffer, uint8_t* data, uint64_t offset, uint32_t bytes);
+    //   bool IsReadComplete(size_t buffer, uint32_t& bytesRead);  // false while the read is in flight
+    //   void CancelRead(size_t buffer);                           // returns once the read has stopped
+    //
+    // TSink plays the buffers, and finishes them in the order they were submitted:
+    //   size_t GetPendingBufferCount();
+    //   void SubmitBuffer(const uint8_t* data, uint32_t position, uint32_t length, bool endOfStream);
+    //   void EndStream();                                         // the last buffer queued is the end
+    template<typename TReader, typename TSink>
+    class StreamingRing
+    {
+    public:
+        // memory holds STREAMING_BUFFER_COUNT sector aligned buffers of STREAMING_BUFFER_SIZE bytes. The entry
+        // is lengthBytes of whole blocks, starting offsetBytes into the file.
+        StreamingRing(_In_ uint8_t* memory, uint32_t offsetBytes, uint32_t lengthBytes, uint32_t blockAlign) noexcept :
+            mBuffers{},
+            mOffsetBytes(offsetBytes),
+            mLengthBytes(lengthBytes),
+            mBlockAlign(blockAlign),
+            mLooped(false),
+            mNextRead(0),
+            mNextSubmit(0),
+            mNextRetire(0),
+            mSubmittedCount(0),
+            mReadPosition(0),
+            mEndOfData(false),
+            mStreamEnded(false)
+        {
+            assert((reinterpret_cast<uintptr_t>(memory) % STREAMING_SECTOR_ALIGNMENT) == 0);
+            assert(mBlockAlign > 0 && mBlockAlign <= (STREAMING_BUFFER_SIZE - STREAMING_SECTOR_ALIGNMENT));
+            assert(mLengthBytes > 0 && (mLengthBytes % mBlockAlign) == 0);
+
+            for (size_t j = 0; j < STREAMING_BUFFER_COUNT; ++j)
+            {
+                mBuffers[j].data = memory + STREAMING_BUFFER_SIZE * j;
+            }
+        }
+
+        StreamingRing(StreamingRing const&) = delete;
+        StreamingRing& operator= (StreamingRing const&) = delete;
+
+        // Starts reading from the beginning of the entry. The sink must have no buffers queued.
+        void Play(TReader& reader, bool loop)
+        {
+            Cancel(reader);
+
+            for (size_t j = 0; j < STREAMING_BUFFER_COUNT; ++j)
+            {
+                mBuffers[j].state = BUFFER_FREE;
+            }
+
+            mNextRead = mNextSubmit = mNextRetire = 0;
+            mSubmittedCount = 0;
+            mReadPosition = 0;
+            mEndOfData = mStreamEnded = false;
+            mLooped = loop;
+
+            Read(reader);
+        }
+
+        // Stops looping, so the stream ends with the current pass through the entry.
+        void ExitLoop()
+        {
+            mLooped = false;
+        }
+
+        // Stops reading. Buffers already submitted are the sink's to flush.
+        void Stop(TReader& reader)
+        {
+            Cancel(reader);
+
+            mEndOfData = mStreamEnded = true;
+        }
+
+        // Waits for reads in flight, so the buffers can be reused or freed.
+        void Cancel(TReader& reader)
+        {
+            for (size_t j = 0; j < STREAMING_BUFFER_COUNT; ++j)
+            {
+                auto& buffer = mBuffers[j];
+
+                if (buffer.state == BUFFER_READING)
+                {
+                    reader.CancelRead(j);
+
+                    buffer.state = BUFFER_FREE;
+                }
+                else if (buffer.state == BUFFER_READY)
+                {
+                    buffer.state = BUFFER_FREE;
+                }
+            }
+        }
+
+        // Retires played buffers, submits completed reads in file order, and starts the next reads.
+        void Update(TReader& reader, TSink& sink)
+        {
+            // Buffers finish in the order they were queued
+            size_t queued = sink.GetPendingBufferCount();
+            while (mSubmittedCount > queued)
+            {
+                mBuffers[mNextRetire].state = BUFFER_FREE;
+                mNextRetire = (mNextRetire + 1) % STREAMING_BUFFER_COUNT;
+                --mSubmittedCount;
+            }
+
+            for (;;)
+            {
+                auto& buffer = mBuffers[mNextSubmit];
+
+                if (buffer.state == BUFFER_READING)
+                {
+                    uint32_t bytesRead = 0;
+                    if (!reader.IsReadComplete(mNextSubmit, bytesRead))
+                        break;
+
+                    if (bytesRead < (buffer.skip + buffer.length))
+                    {
+                        // The file is shorter than the bank header says
+                        throw std::exception("ReadFile");
+                    }
+
+                    buffer.state = BUFFER_READY;
+                }
+
+                if (buffer.state != BUFFER_READY)
+                    break;
+
+                Submit(sink, buffer);
+                mNextSubmit = (mNextSubmit + 1) % STREAMING_BUFFER_COUNT;
+            }
+
+            Read(reader);
+
+            if (mEndOfData && !mStreamEnded && !HasPendingReads())
+            {
+                // The loop was exited after the whole of the final pass was queued, so no buffer is left
+                // to carry the end of the stream
+                mStreamEnded = true;
+                sink.EndStream();
+            }
+        }
+
+        bool IsLooped() const { return mLooped; }
+
+        // True once the final buffer has been submitted, or the stream was stopped.
+        bool HasStreamEnded() const { return mStreamEnded; }
+
+    private:
+        enum BUFFER_STATE
+        {
+            BUFFER_FREE = 0,
+            BUFFER_READING,     // Read in flight
+            BUFFER_READY,       // Read complete, waiting for the buffers ahead of it to be submitted
+            BUFFER_SUBMITTED,   // Queued on the sink
+        };
+
+        struct StreamBuffer
+        {
+            uint8_t*        data;
+            BUFFER_STATE    state;
+            uint32_t        position;   // Offset within the entry of the first byte to play
+            uint32_t        skip;       // Bytes read ahead of position to keep the read sector aligned
+            uint32_t        length;     // Bytes to play
+        };
+
+        bool HasPendingReads() const
+        {
+            for (size_t j = 0; j < STREAMING_BUFFER_COUNT; ++j)
+            {
+                if (mBuffers[j].state == BUFFER_READING || mBuffers[j].state == BUFFER_READY)
+                    return true;
+            }
+
+            return false;
+        }
+
+        void Read(TReader& reader)
+        {
+            while (!mEndOfData && mBuffers[mNextRead].state == BUFFER_FREE)
+            {
+                if (mReadPosition >= mLengthBytes)
+                {
+                    if (!mLooped)
+                    {
+                        mEndOfData = true;
+                        break;
+                    }
+
+                    mReadPosition = 0;
+                }
+
+                auto& buffer = mBuffers[mNextRead];
+
+                uint64_t offset = uint64_t(mOffsetBytes) + mReadPosition;
+                uint64_t alignedOffset = offset & ~uint64_t(STREAMING_SECTOR_ALIGNMENT - 1);
+
+                buffer.position = mReadPosition;
+                buffer.skip = static_cast<uint32_t>(offset - alignedOffset);
+
+                uint32_t length = std::min<uint32_t>(mLengthBytes - mReadPosition, static_cast<uint32_t>(STREAMING_BUFFER_SIZE) - buffer.skip);
+                buffer.length = length - (length % mBlockAlign);
+                assert(buffer.length > 0);
+
+                auto readBytes = static_cast<uint32_t>((buffer.skip + buffer.length + STREAMING_SECTOR_ALIGNMENT - 1) & ~(STREAMING_SECTOR_ALIGNMENT - 1));
+                assert(readBytes <= STREAMING_BUFFER_SIZE);
+
+                // A failed read throws, leaving the buffer free
+                reader.BeginRead(mNextRead, buffer.data, alignedOffset, readBytes);
+
+                buffer.state = BUFFER_READING;
+
+                mReadPosition += buffer.length;
+                mNextRead = (mNextRead + 1) % STREAMING_BUFFER_COUNT;
+            }
+        }
+
+        void Submit(TSink& sink, StreamBuffer& buffer)
+        {
+            if (mStreamEnded)
+            {
+                // Read ahead into the next loop before the loop was exited
+                buffer.state = BUFFER_FREE;
+                return;
+            }
+
+            bool endOfStream = !mLooped && (buffer.position + buffer.length) >= mLengthBytes;
+            if (endOfStream)
+            {
+                mEndOfData = mStreamEnded = true;
+            }
+
+            sink.SubmitBuffer(buffer.data + buffer.skip, buffer.position, buffer.length, endOfStream);
+
+            buffer.state = BUFFER_SUBMITTED;
+            ++mSubmittedCount;
+        }
+
+        StreamBuffer    mBuffers[STREAMING_BUFFER_COUNT];
+        uint32_t        mOffsetBytes;
+        uint32_t        mLengthBytes;
+        uint32_t        mBlockAlign;
+        bool            mLooped;
+        size_t          mNextRead;
+        size_t          mNextSubmit;
+        size_t          mNextRetire;
+        size_t          mSubmittedCount;
+        uint32_t        mReadPosition;
+        bool            mEndOfData;
+        bool            mStreamEnded;
+    };
+}
@@ -54,4 +54,12 @@ namespace DirectX
         _In_z_ const wchar_t* szFileName,
         _Inout_ std::unique_ptr<uint8_t[]>& wavData,
         _Out_ WAVData& result);
+
+    // Reads the format, loop and seek chunks without the sample data. startAudio is null on return,
+    // and audioOffset receives the file offset of the 'data' chunk payload.
+    HRESULT LoadWAVAudioHeaderFromFile(
+        _In_z_ const wchar_t* szFileName,
+        _Inout_ std::unique_ptr<uint8_t[]>& wavData,
+        _Out_ WAVData& result,
+        _Out_opt_ uint32_t* audioOffset);
 }
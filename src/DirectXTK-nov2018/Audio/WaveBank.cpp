@@ -52,6 +52,19 @@ public:
             mInstances.clear();
         }
 
+        if (!mStreamInstances.empty())
+        {
+            DebugTrace("WARNING: Destroying WaveBank \"%hs\" with %zu outstanding SoundStreamInstances\n", mReader.BankName(), mStreamInstances.size());
+
+            for (auto it = mStreamInstances.begin(); it != mStreamInstances.end(); ++it)
+            {
+                assert(*it != nullptr);
+                (*it)->OnDestroyParent();
+            }
+
+            mStreamInstances.clear();
+        }
+
         if (mOneShots > 0)
         {
             DebugTrace("WARNING: Destroying WaveBank \"%hs\" with %u outstanding one shot effects\n", mReader.BankName(), mOneShots);
@@ -64,7 +77,7 @@ public:
         }
     }
 
-    HRESULT Initialize(_In_ AudioEngine* engine, _In_z_ const wchar_t* wbFileName);
+    HRESULT Initialize(_In_ AudioEngine* engine, _In_z_ const wchar_t* wbFileName, WAVE_BANK_FLAGS flags);
 
     void Play(int index, float volume, float pitch, float pan);
 
@@ -118,6 +131,7 @@ public:
 
     AudioEngine*                        mEngine;
     std::list<SoundEffectInstance*>     mInstances;
+    std::list<SoundStreamInstance*>     mStreamInstances;
     WaveBankReader                      mReader;
     uint32_t                            mOneShots;
     bool                                mPrepared;
@@ -126,12 +140,12 @@ public:
 
 
 _Use_decl_annotations_
-HRESULT WaveBank::Impl::Initialize(AudioEngine* engine, const wchar_t* wbFileName)
+HRESULT WaveBank::Impl::Initialize(AudioEngine* engine, const wchar_t* wbFileName, WAVE_BANK_FLAGS flags)
 {
     if (!engine || !wbFileName)
         return E_INVALIDARG;
 
-    HRESULT hr = mReader.Open(wbFileName);
+    HRESULT hr = (flags & WaveBank_MemoryMapped) ? mReader.OpenMapped(wbFileName) : mReader.Open(wbFileName);
     if (FAILED(hr))
         return hr;
 
@@ -249,18 +263,18 @@ void WaveBank::Impl::Play(int index, float volume, float pitch, float pan)
 
 // Public constructors.
 _Use_decl_annotations_
-WaveBank::WaveBank(AudioEngine* engine, const wchar_t* wbFileName)
+WaveBank::WaveBank(AudioEngine* engine, const wchar_t* wbFileName, WAVE_BANK_FLAGS flags)
     : pImpl(std::make_unique<Impl>(engine))
 {
-    HRESULT hr = pImpl->Initialize(engine, wbFileName);
+    HRESULT hr = pImpl->Initialize(engine, wbFileName, flags);
     if (FAILED(hr))
     {
         DebugTrace("ERROR: WaveBank failed (%08X) to intialize from .xwb file \"%ls\"\n", hr, wbFileName);
         throw std::exception("WaveBank");
     }
 
-    DebugTrace("INFO: WaveBank \"%hs\" with %u entries loaded from .xwb file \"%ls\"\n",
-               pImpl->mReader.BankName(), pImpl->mReader.Count(), wbFileName);
+    DebugTrace("INFO: WaveBank \"%hs\" with %u entries %ls from .xwb file \"%ls\"\n",
+               pImpl->mReader.BankName(), pImpl->mReader.Count(), pImpl->mReader.IsMapped() ? L"mapped" : L"loaded", wbFileName);
 }
 
 
@@ -324,6 +338,32 @@ void WaveBank::Play(_In_z_ const char* name, float volume, float pitch, float pa
 }
 
 
+void WaveBank::Play(WaveBankNameHash name)
+{
+    int index = static_cast<int>(pImpl->mReader.FindByHash(name.value));
+    if (index == -1)
+    {
+        DebugTrace("WARNING: Name hash %08X not found in wave bank, one-shot not triggered\n", name.value);
+        return;
+    }
+
+    pImpl->Play(index, 1.f, 0.f, 0.f);
+}
+
+
+void WaveBank::Play(WaveBankNameHash name, float volume, float pitch, float pan)
+{
+    int index = static_cast<int>(pImpl->mReader.FindByHash(name.value));
+    if (index == -1)
+    {
+        DebugTrace("WARNING: Name hash %08X not found in wave bank, one-shot not triggered\n", name.value);
+        return;
+    }
+
+    pImpl->Play(index, volume, pitch, pan);
+}
+
+
 std::unique_ptr<SoundEffectInstance> WaveBank::CreateInstance(int index, SOUND_EFFECT_INSTANCE_FLAGS flags)
 {
     auto& wb = pImpl->mReader;
@@ -366,6 +406,74 @@ std::unique_ptr<SoundEffectInstance> WaveBank::CreateInstance(_In_z_ const char*
 }
 
 
+std::unique_ptr<SoundEffectInstance> WaveBank::CreateInstance(WaveBankNameHash name, SOUND_EFFECT_INSTANCE_FLAGS flags)
+{
+    int index = static_cast<int>(pImpl->mReader.FindByHash(name.value));
+    if (index == -1)
+    {
+        // We don't throw an exception here as titles often simply ignore missing assets rather than fail
+        return std::unique_ptr<SoundEffectInstance>();
+    }
+
+    return CreateInstance(index, flags);
+}
+
+
+std::unique_ptr<SoundStreamInstance> WaveBank::CreateStreamInstance(int index, SOUND_EFFECT_INSTANCE_FLAGS flags)
+{
+    auto& wb = pImpl->mReader;
+
+    if (!pImpl->mStreaming)
+    {
+        DebugTrace("ERROR: SoundStreamInstances can only be created from a streaming wave bank\n");
+        throw std::exception("WaveBank::CreateStreamInstance");
+    }
+
+    if (index < 0 || uint32_t(index) >= wb.Count())
+    {
+        // We don't throw an exception here as titles often simply ignore missing assets rather than fail
+        return std::unique_ptr<SoundStreamInstance>();
+    }
+
+    if (!pImpl->mPrepared)
+    {
+        wb.WaitOnPrepare();
+        pImpl->mPrepared = true;
+    }
+
+    auto effect = new SoundStreamInstance(pImpl->mEngine, this, index, flags);
+    assert(effect != nullptr);
+    pImpl->mStreamInstances.emplace_back(effect);
+    return std::unique_ptr<SoundStreamInstance>(effect);
+}
+
+
+std::unique_ptr<SoundStreamInstance> WaveBank::CreateStreamInstance(_In_z_ const char* name, SOUND_EFFECT_INSTANCE_FLAGS flags)
+{
+    int index = static_cast<int>(pImpl->mReader.Find(name));
+    if (index == -1)
+    {
+        // We don't throw an exception here as titles often simply ignore missing assets rather than fail
+        return std::unique_ptr<SoundStreamInstance>();
+    }
+
+    return CreateStreamInstance(index, flags);
+}
+
+
+std::unique_ptr<SoundStreamInstance> WaveBank::CreateStreamInstance(WaveBankNameHash name, SOUND_EFFECT_INSTANCE_FLAGS flags)
+{
+    int index = static_cast<int>(pImpl->mReader.FindByHash(name.value));
+    if (index == -1)
+    {
+        // We don't throw an exception here as titles often simply ignore missing assets rather than fail
+        return std::unique_ptr<SoundStreamInstance>();
+    }
+
+    return CreateStreamInstance(index, flags);
+}
+
+
 void WaveBank::UnregisterInstance(_In_ SoundEffectInstance* instance)
 {
     auto it = std::find(pImpl->mInstances.begin(), pImpl->mInstances.end(), instance);
@@ -376,6 +484,51 @@ void WaveBank::UnregisterInstance(_In_ SoundEffectInstance* instance)
 }
 
 
+void WaveBank::UnregisterInstance(_In_ SoundStreamInstance* instance)
+{
+    auto it = std::find(pImpl->mStreamInstances.begin(), pImpl->mStreamInstances.end(), instance);
+    if (it == pImpl->mStreamInstances.end())
+        return;
+
+    pImpl->mStreamInstances.erase(it);
+}
+
+
+HANDLE WaveBank::GetAsyncHandle() const
+{
+    return pImpl->mReader.GetAsyncHandle();
+}
+
+
+_Use_decl_annotations_
+bool WaveBank::GetPrivateData(int index, void* data, size_t datasize) const
+{
+    if (index < 0 || uint32_t(index) >= pImpl->mReader.Count())
+        return false;
+
+    if (!data)
+        return false;
+
+    switch (datasize)
+    {
+        case sizeof(WaveBankReader::Metadata):
+        {
+            auto ptr = reinterpret_cast<WaveBankReader::Metadata*>(data);
+            return SUCCEEDED(pImpl->mReader.GetMetadata(index, *ptr));
+        }
+
+        case sizeof(WaveBankReader::SeekData):
+        {
+            auto ptr = reinterpret_cast<WaveBankReader::SeekData*>(data);
+            return SUCCEEDED(pImpl->mReader.GetSeekTable(index, &ptr->seekTable, ptr->seekCount, ptr->tag));
+        }
+
+        default:
+            return false;
+    }
+}
+
+
 // Public accessors.
 bool WaveBank::IsPrepared() const
 {
@@ -392,7 +545,7 @@ bool WaveBank::IsPrepared() const
 
 bool WaveBank::IsInUse() const
 {
-    return (pImpl->mOneShots > 0) || !pImpl->mInstances.empty();
+    return (pImpl->mOneShots > 0) || !pImpl->mInstances.empty() || !pImpl->mStreamInstances.empty();
 }
 
 
@@ -402,6 +555,38 @@ bool WaveBank::IsStreamingBank() const
 }
 
 
+void WaveBank::Prefetch(int index) const
+{
+    if (index < 0 || uint32_t(index) >= pImpl->mReader.Count())
+        return;
+
+    uint32_t entry = uint32_t(index);
+    pImpl->mReader.Prefetch(&entry, 1);
+}
+
+
+_Use_decl_annotations_
+void WaveBank::Prefetch(const int* indices, size_t count) const
+{
+    if (!indices || !count || !pImpl->mReader.IsMapped())
+        return;
+
+    std::vector<uint32_t> entries;
+    entries.reserve(count);
+
+    for (size_t j = 0; j < count; ++j)
+    {
+        if (indices[j] >= 0 && uint32_t(indices[j]) < pImpl->mReader.Count())
+            entries.push_back(uint32_t(indices[j]));
+    }
+
+    if (!entries.empty())
+    {
+        pImpl->mReader.Prefetch(entries.data(), entries.size());
+    }
+}
+
+
 size_t WaveBank::GetSampleSizeInBytes(int index) const
 {
     if (index < 0 || uint32_t(index) >= pImpl->mReader.Count())
@@ -462,6 +647,12 @@ int WaveBank::Find(const char* name) const
 }
 
 
+int WaveBank::Find(WaveBankNameHash name) const
+{
+    return static_cast<int>(pImpl->mReader.FindByHash(name.value));
+}
+
+
 #if defined(_XBOX_ONE) || (_WIN32_WINNT < _WIN32_WINNT_WIN8) || (_WIN32_WINNT >= _WIN32_WINNT_WIN10)
 
 _Use_decl_annotations_
@@ -0,0 +1,603 @@
+//--------------------------------------------------------------------------------------
+// File: WaveBankLayout.h
+//
+// The layout of XACT3 wave banks (xact3wb.h), and the checks WaveBankReader makes before
+// handing out pointers into a bank. Banks opened with OpenMapped are served straight from
+// a read-only view of the file, so entries, seek tables and names are checked against the
+// segments that hold them. This has no Win32 dependencies, so malformed banks can be
+// tested on any platform.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+// http://go.microsoft.com/fwlink/?LinkID=615561
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <objbase.h>
+#include <mmreg.h>
+
+
+namespace DirectX
+{
+    namespace WaveBankLayout
+    {
+#pragma pack(push, 1)
+
+        static const size_t DVD_SECTOR_SIZE = 2048;
+        static const size_t DVD_BLOCK_SIZE = DVD_SECTOR_SIZE * 16;
+
+        static const size_t ALIGNMENT_MIN = 4;
+        static const size_t ALIGNMENT_DVD = DVD_SECTOR_SIZE;
+
+        static const size_t MAX_DATA_SEGMENT_SIZE = 0xFFFFFFFF;
+        static const size_t MAX_COMPACT_DATA_SEGMENT_SIZE = 0x001FFFFF;
+
+        struct REGION
+        {
+            uint32_t    dwOffset;   // Region offset, in bytes.
+            uint32_t    dwLength;   // Region length, in bytes.
+
+            void BigEndian()
+            {
+                dwOffset = _byteswap_ulong(dwOffset);
+                dwLength = _byteswap_ulong(dwLength);
+            }
+        };
+
+        struct SAMPLEREGION
+        {
+            uint32_t    dwStartSample;  // Start sample for the region.
+            uint32_t    dwTotalSamples; // Region length in samples.
+
+            void BigEndian()
+            {
+                dwStartSample = _byteswap_ulong(dwStartSample);
+                dwTotalSamples = _byteswap_ulong(dwTotalSamples);
+            }
+        };
+
+        struct HEADER
+        {
+            static const uint32_t SIGNATURE = MAKEFOURCC('W', 'B', 'N', 'D');
+            static const uint32_t BE_SIGNATURE = MAKEFOURCC('D', 'N', 'B', 'W');
+            static const uint32_t VERSION = 44;
+
+            enum SEGIDX
+            {
+                SEGIDX_BANKDATA = 0,       // Bank data
+                SEGIDX_ENTRYMETADATA,      // Entry meta-data
+                SEGIDX_SEEKTABLES,         // Storage for seek tables for the encoded waves.
+                SEGIDX_ENTRYNAMES,         // Entry friendly names
+                SEGIDX_ENTRYWAVEDATA,      // Entry wave data
+                SEGIDX_COUNT
+            };
+
+            uint32_t    dwSignature;            // File signature
+            uint32_t    dwVersion;              // Version of the tool that created the file
+            uint32_t    dwHeaderVersion;        // Version of the file format
+            REGION      Segments[SEGIDX_COUNT]; // Segment lookup table
+
+            void BigEndian()
+            {
+                // Leave dwSignature alone as indicator of BE vs. LE
+
+                dwVersion = _byteswap_ulong(dwVersion);
+                dwHeaderVersion = _byteswap_ulong(dwHeaderVersion);
+                for (size_t j = 0; j < SEGIDX_COUNT; ++j)
+                {
+                    Segments[j].BigEndian();
+                }
+            }
+        };
+
+#pragma warning( disable : 4201 4203 )
+
+        union MINIWAVEFORMAT
+        {
+            static const uint32_t TAG_PCM = 0x0;
+            static const uint32_t TAG_XMA = 0x1;
+            static const uint32_t TAG_ADPCM = 0x2;
+            static const uint32_t TAG_WMA = 0x3;
+
+            static const uint32_t BITDEPTH_8 = 0x0; // PCM only
+            static const uint32_t BITDEPTH_16 = 0x1; // PCM only
+
+            static const size_t ADPCM_BLOCKALIGN_CONVERSION_OFFSET = 22;
+
+            struct
+            {
+                uint32_t       wFormatTag : 2;        // Format tag
+                uint32_t       nChannels : 3;        // Channel count (1 - 6)
+                uint32_t       nSamplesPerSec : 18;       // Sampling rate
+                uint32_t       wBlockAlign : 8;        // Block alignment.  For WMA, lower 6 bits block alignment index, upper 2 bits bytes-per-second index.
+                uint32_t       wBitsPerSample : 1;        // Bits per sample (8 vs. 16, PCM only); WMAudio2/WMAudio3 (for WMA)
+            };
+
+            uint32_t           dwValue;
+
+            void BigEndian()
+            {
+                dwValue = _byteswap_ulong(dwValue);
+            }
+
+            WORD BitsPerSample() const
+            {
+                if (wFormatTag == TAG_XMA)
+                    return 16; // XMA_OUTPUT_SAMPLE_BITS == 16
+                if (wFormatTag == TAG_WMA)
+                    return 16;
+                if (wFormatTag == TAG_ADPCM)
+                    return 4; // MSADPCM_BITS_PER_SAMPLE == 4
+
+                // wFormatTag must be TAG_PCM (2 bits can only represent 4 different values)
+                return (wBitsPerSample == BITDEPTH_16) ? 16 : 8;
+            }
+
+            DWORD BlockAlign() const
+            {
+                switch (wFormatTag)
+                {
+                    case TAG_PCM:
+                        return wBlockAlign;
+
+                    case TAG_XMA:
+                        return (nChannels * 16 / 8); // XMA_OUTPUT_SAMPLE_BITS = 16
+
+                    case TAG_ADPCM:
+                        return (wBlockAlign + ADPCM_BLOCKALIGN_CONVERSION_OFFSET) * nChannels;
+
+                    case TAG_WMA:
+                    {
+                        static const uint32_t aWMABlockAlign[] =
+                        {
+                            929,
+                            1487,
+                            1280,
+                            2230,
+                            8917,
+                            8192,
+                            4459,
+                            5945,
+                            2304,
+                            1536,
+                            1485,
+                            1008,
+                            2731,
+                            4096,
+                            6827,
+                            5462,
+                            1280
+                        };
+
+                        uint32_t dwBlockAlignIndex = wBlockAlign & 0x1F;
+                        if (dwBlockAlignIndex < _countof(aWMABlockAlign))
+                            return aWMABlockAlign[dwBlockAlignIndex];
+                    }
+                    break;
+                }
+
+                return 0;
+            }
+
+            DWORD AvgBytesPerSec() const
+            {
+                switch (wFormatTag)
+                {
+                    case TAG_PCM:
+                        return nSamplesPerSec * wBlockAlign;
+
+                    case TAG_XMA:
+                        return nSamplesPerSec * BlockAlign();
+
+                    case TAG_ADPCM:
+                    {
+                        uint32_t blockAlign = BlockAlign();
+                        uint32_t samplesPerAdpcmBlock = AdpcmSamplesPerBlock();
+                        return blockAlign * nSamplesPerSec / samplesPerAdpcmBlock;
+                    }
+
+                    case TAG_WMA:
+                    {
+                        static const uint32_t aWMAAvgBytesPerSec[] =
+                        {
+                            12000,
+                            24000,
+                            4000,
+                            6000,
+                            8000,
+                            20000,
+                            2500
+                        };
+                        // bitrate = entry * 8
+
+                        uint32_t dwBytesPerSecIndex = wBlockAlign >> 5;
+                        if (dwBytesPerSecIndex < _countof(aWMAAvgBytesPerSec))
+                            return aWMAAvgBytesPerSec[dwBytesPerSecIndex];
+                    }
+                    break;
+                }
+
+                return 0;
+            }
+
+            DWORD AdpcmSamplesPerBlock() const
+            {
+                uint32_t nBlockAlign = (wBlockAlign + ADPCM_BLOCKALIGN_CONVERSION_OFFSET) * nChannels;
+                return nBlockAlign * 2 / uint32_t(nChannels) - 12;
+            }
+
+            void AdpcmFillCoefficientTable(ADPCMWAVEFORMAT *fmt) const
+            {
+                // These are fixed since we are always using MS ADPCM
+                fmt->wNumCoef = 7 /* MSADPCM_NUM_COEFFICIENTS */;
+
+                static ADPCMCOEFSET aCoef[7] = { { 256, 0}, {512, -256}, {0,0}, {192,64}, {240,0}, {460, -208}, {392,-232} };
+                memcpy(&fmt->aCoef, aCoef, sizeof(aCoef));
+            }
+        };
+
+        struct BANKDATA
+        {
+            static const size_t BANKNAME_LENGTH = 64;
+
+            static const uint32_t TYPE_BUFFER = 0x00000000;
+            static const uint32_t TYPE_STREAMING = 0x00000001;
+            static const uint32_t TYPE_MASK = 0x00000001;
+
+            static const uint32_t FLAGS_ENTRYNAMES = 0x00010000;
+            static const uint32_t FLAGS_COMPACT = 0x00020000;
+            static const uint32_t FLAGS_SYNC_DISABLED = 0x00040000;
+            static const uint32_t FLAGS_SEEKTABLES = 0x00080000;
+            static const uint32_t FLAGS_MASK = 0x000F0000;
+
+            uint32_t        dwFlags;                        // Bank flags
+            uint32_t        dwEntryCount;                   // Number of entries in the bank
+            char            szBankName[BANKNAME_LENGTH];    // Bank friendly name
+            uint32_t        dwEntryMetaDataElementSize;     // Size of each entry meta-data element, in bytes
+            uint32_t        dwEntryNameElementSize;         // Size of each entry name element, in bytes
+            uint32_t        dwAlignment;                    // Entry alignment, in bytes
+            MINIWAVEFORMAT  CompactFormat;                  // Format data for compact bank
+            FILETIME        BuildTime;                      // Build timestamp
+
+            void BigEndian()
+            {
+                dwFlags = _byteswap_ulong(dwFlags);
+                dwEntryCount = _byteswap_ulong(dwEntryCount);
+                dwEntryMetaDataElementSize = _byteswap_ulong(dwEntryMetaDataElementSize);
+                dwEntryNameElementSize = _byteswap_ulong(dwEntryNameElementSize);
+                dwAlignment = _byteswap_ulong(dwAlignment);
+                CompactFormat.BigEndian();
+                BuildTime.dwLowDateTime = _byteswap_ulong(BuildTime.dwLowDateTime);
+                BuildTime.dwHighDateTime = _byteswap_ulong(BuildTime.dwHighDateTime);
+            }
+        };
+
+        struct ENTRY
+        {
+            static const uint32_t FLAGS_READAHEAD = 0x00000001;     // Enable stream read-ahead
+            static const uint32_t FLAGS_LOOPCACHE = 0x00000002;     // One or more looping sounds use this wave
+            static const uint32_t FLAGS_REMOVELOOPTAIL = 0x00000004;// Remove data after the end of the loop region
+            static const uint32_t FLAGS_IGNORELOOP = 0x00000008;    // Used internally when the loop region can't be used
+            static const uint32_t FLAGS_MASK = 0x00000008;
+
+            union
+            {
+                struct
+                {
+                    // Entry flags
+                    uint32_t                   dwFlags : 4;
+
+                    // Duration of the wave, in units of one sample.
+                    // For instance, a ten second long wave sampled
+                    // at 48KHz would have a duration of 480,000.
+                    // This value is not affected by the number of
+                    // channels, the number of bits per sample, or the
+                    // compression format of the wave.
+                    uint32_t                   Duration : 28;
+                };
+                uint32_t dwFlagsAndDuration;
+            };
+
+            MINIWAVEFORMAT  Format;         // Entry format.
+            REGION          PlayRegion;     // Region within the wave data segment that contains this entry.
+            SAMPLEREGION    LoopRegion;     // Region within the wave data (in samples) that should loop.
+
+            void BigEndian()
+            {
+                dwFlagsAndDuration = _byteswap_ulong(dwFlagsAndDuration);
+                Format.BigEndian();
+                PlayRegion.BigEndian();
+                LoopRegion.BigEndian();
+            }
+        };
+
+        struct ENTRYCOMPACT
+        {
+            uint32_t       dwOffset : 21;       // Data offset, in multiplies of the bank alignment
+            uint32_t       dwLengthDeviation : 11;       // Data length deviation, in bytes
+
+            void BigEndian()
+            {
+                *reinterpret_cast<uint32_t*>(this) = _byteswap_ulong(*reinterpret_cast<const uint32_t*>(this));
+            }
+
+            void ComputeLocations(DWORD& offset, DWORD& length, uint32_t index, const HEADER& header, const BANKDATA& data, const ENTRYCOMPACT* entries) const
+            {
+                offset = dwOffset * data.dwAlignment;
+
+                if (index < (data.dwEntryCount - 1))
+                {
+                    length = (entries[index + 1].dwOffset * data.dwAlignment) - offset - dwLengthDeviation;
+                }
+                else
+                {
+                    length = header.Segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwLength - offset - dwLengthDeviation;
+                }
+            }
+
+            static uint32_t GetDuration(DWORD length, const BANKDATA& data, const uint32_t* seekTable)
+            {
+                switch (data.CompactFormat.wFormatTag)
+                {
+                    case MINIWAVEFORMAT::TAG_ADPCM:
+                    {
+                        uint32_t duration = (length / data.CompactFormat.BlockAlign()) * data.CompactFormat.AdpcmSamplesPerBlock();
+                        uint32_t partial = length % data.CompactFormat.BlockAlign();
+                        if (partial)
+                        {
+                            if (partial >= (7u * data.CompactFormat.nChannels))
+                                duration += (partial * 2 / data.CompactFormat.nChannels - 12);
+                        }
+                        return duration;
+                    }
+
+                    case MINIWAVEFORMAT::TAG_WMA:
+                        if (seekTable)
+                        {
+                            uint32_t seekCount = *seekTable;
+                            if (seekCount > 0)
+                            {
+                                return seekTable[seekCount] / uint32_t(2 * data.CompactFormat.nChannels);
+                            }
+                        }
+                        return 0;
+
+                    case MINIWAVEFORMAT::TAG_XMA:
+                        if (seekTable)
+                        {
+                            uint32_t seekCount = *seekTable;
+                            if (seekCount > 0)
+                            {
+                                return seekTable[seekCount];
+                            }
+                        }
+                        return 0;
+
+                    default:
+                        return uint32_t((uint64_t(length) * 8)
+                            / (uint64_t(data.CompactFormat.BitsPerSample()) * uint64_t(data.CompactFormat.nChannels)));
+                }
+            }
+        };
+
+#pragma pack(pop)
+
+        static_assert(sizeof(REGION) == 8, "Mismatch with xact3wb.h");
+        static_assert(sizeof(SAMPLEREGION) == 8, "Mismatch with xact3wb.h");
+        static_assert(sizeof(HEADER) == 52, "Mismatch with xact3wb.h");
+        static_assert(sizeof(ENTRY) == 24, "Mismatch with xact3wb.h");
+        static_assert(sizeof(MINIWAVEFORMAT) == 4, "Mismatch with xact3wb.h");
+        static_assert(sizeof(ENTRYCOMPACT) == 4, "Mismatch with xact3wb.h");
+        static_assert(sizeof(BANKDATA) == 96, "Mismatch with xact3wb.h");
+
+
+        inline HRESULT ValidateBankData(const HEADER& header, const BANKDATA& data)
+        {
+            if (!data.dwEntryCount)
+            {
+                return HRESULT_FROM_WIN32(ERROR_NO_DATA);
+            }
+
+            if (data.dwFlags & BANKDATA::TYPE_STREAMING)
+            {
+                if (data.dwAlignment < ALIGNMENT_DVD)
+                    return E_FAIL;
+                if (data.dwAlignment % DVD_SECTOR_SIZE)
+                    return E_FAIL;
+            }
+            else if (data.dwAlignment < ALIGNMENT_MIN)
+            {
+                return E_FAIL;
+            }
+
+            if (data.dwFlags & BANKDATA::FLAGS_COMPACT)
+            {
+                if (data.dwEntryMetaDataElementSize != sizeof(ENTRYCOMPACT))
+                {
+                    return E_FAIL;
+                }
+
+                if (data.dwAlignment > ALIGNMENT_DVD)
+                {
+                    // Compact entries hold offsets in units of the alignment, which would overflow 32 bits
+                    return E_FAIL;
+                }
+
+                if (header.Segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwLength > (MAX_COMPACT_DATA_SEGMENT_SIZE * data.dwAlignment))
+                {
+                    // Data segment is too large to be valid compact wavebank
+                    return E_FAIL;
+                }
+            }
+            else
+            {
+                if (data.dwEntryMetaDataElementSize != sizeof(ENTRY))
+                {
+                    return E_FAIL;
+                }
+            }
+
+            DWORD metadataBytes = header.Segments[HEADER::SEGIDX_ENTRYMETADATA].dwLength;
+            if (metadataBytes != (uint64_t(data.dwEntryCount) * data.dwEntryMetaDataElementSize))
+            {
+                return E_FAIL;
+            }
+
+            return S_OK;
+        }
+
+
+        // Reads the header and bank data of a bank held in memory, and finds its segments, all of which must lie
+        // within the size bytes at base. Returns S_FALSE for a big-endian bank, which must be byte-swapped into
+        // buffers of its own.
+        inline HRESULT MapSegments(
+            _In_reads_bytes_(size) const uint8_t* base, uint64_t size,
+            HEADER& header, BANKDATA& data,
+            const char*& nameTable, const uint8_t*& entryTable, const uint8_t*& seekTable, const uint8_t*& waveTable)
+        {
+            nameTable = nullptr;
+            entryTable = seekTable = waveTable = nullptr;
+
+            if (size < sizeof(HEADER))
+            {
+                return E_FAIL;
+            }
+
+            memcpy(&header, base, sizeof(HEADER));
+
+            if (header.dwSignature == HEADER::BE_SIGNATURE)
+            {
+                return S_FALSE;
+            }
+
+            if (header.dwSignature != HEADER::SIGNATURE || header.dwHeaderVersion != HEADER::VERSION)
+            {
+                return E_FAIL;
+            }
+
+            for (size_t j = 0; j < HEADER::SEGIDX_COUNT; ++j)
+            {
+                if ((uint64_t(header.Segments[j].dwOffset) + header.Segments[j].dwLength) > size)
+                {
+                    return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+                }
+            }
+
+            DWORD bankOffset = header.Segments[HEADER::SEGIDX_BANKDATA].dwOffset;
+            if ((uint64_t(bankOffset) + sizeof(BANKDATA)) > size)
+            {
+                return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+            }
+
+            memcpy(&data, base + bankOffset, sizeof(BANKDATA));
+
+            HRESULT hr = ValidateBankData(header, data);
+            if (FAILED(hr))
+                return hr;
+
+            DWORD namesBytes = header.Segments[HEADER::SEGIDX_ENTRYNAMES].dwLength;
+            if (namesBytes > 0 && namesBytes >= (uint64_t(data.dwEntryNameElementSize) * data.dwEntryCount))
+            {
+                nameTable = reinterpret_cast<const char*>(base + header.Segments[HEADER::SEGIDX_ENTRYNAMES].dwOffset);
+            }
+
+            entryTable = base + header.Segments[HEADER::SEGIDX_ENTRYMETADATA].dwOffset;
+
+            if (header.Segments[HEADER::SEGIDX_SEEKTABLES].dwLength > 0)
+            {
+                seekTable = base + header.Segments[HEADER::SEGIDX_SEEKTABLES].dwOffset;
+            }
+
+            if (!header.Segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwLength)
+            {
+                return HRESULT_FROM_WIN32(ERROR_NO_DATA);
+            }
+
+            waveTable = base + header.Segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwOffset;
+
+            return S_OK;
+        }
+
+
+        // Finds where the wave data of an entry lies in the wave data segment. The sums are taken in 64 bits, so
+        // a malformed entry cannot wrap around into range.
+        inline HRESULT FindWaveData(uint32_t index, const uint8_t* entryTable, const HEADER& header, const BANKDATA& data, DWORD& offset, DWORD& length)
+        {
+            if (!entryTable || index >= data.dwEntryCount)
+                return E_FAIL;
+
+            if (data.dwFlags & BANKDATA::FLAGS_COMPACT)
+            {
+                auto entries = reinterpret_cast<const ENTRYCOMPACT*>(entryTable);
+
+                entries[index].ComputeLocations(offset, length, index, header, data, entries);
+            }
+            else
+            {
+                auto& entry = reinterpret_cast<const ENTRY*>(entryTable)[index];
+
+                offset = entry.PlayRegion.dwOffset;
+                length = entry.PlayRegion.dwLength;
+            }
+
+            if ((uint64_t(offset) + length) > header.Segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwLength)
+            {
+                return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+            }
+
+            return S_OK;
+        }
+
+
+        // Finds the seek table of an entry: its packet count, followed by the cumulative decoded size of each
+        // packet. Returns nullptr if the entry has none, or if its table runs past the seek table segment.
+        inline const uint32_t* FindSeekTable(uint32_t index, const uint8_t* seekTable, const HEADER& header, const BANKDATA& data)
+        {
+            if (!seekTable || index >= data.dwEntryCount)
+                return nullptr;
+
+            uint64_t seekSize = header.Segments[HEADER::SEGIDX_SEEKTABLES].dwLength;
+
+            // The segment starts with the offset of each entry's table
+            uint64_t tableStart = sizeof(uint32_t) * uint64_t(data.dwEntryCount);
+            if (tableStart > seekSize)
+                return nullptr;
+
+            auto table = reinterpret_cast<const uint32_t*>(seekTable);
+            uint32_t offset = table[index];
+            if (offset == uint32_t(-1))
+                return nullptr;
+
+            uint64_t start = tableStart + offset;
+            if ((start + sizeof(uint32_t)) > seekSize)
+                return nullptr;
+
+            auto entryTable = reinterpret_cast<const uint32_t*>(seekTable + start);
+            if ((start + sizeof(uint32_t) * (uint64_t(*entryTable) + 1)) > seekSize)
+                return nullptr;
+
+            return entryTable;
+        }
+
+
+        // Copies the name of an entry, which has no terminator if it fills its element.
+        inline void GetEntryName(uint32_t index, const char* nameTable, const BANKDATA& data, char (&name)[64])
+        {
+            size_t maxLength = (data.dwEntryNameElementSize < sizeof(name)) ? data.dwEntryNameElementSize : (sizeof(name) - 1);
+
+            const char* source = nameTable + size_t(data.dwEntryNameElementSize) * index;
+
+            size_t length = 0;
+            while (length < maxLength && source[length])
+                ++length;
+
+            memcpy(name, source, length);
+            name[length] = 0;
+        }
+    }
+}
@@ -12,6 +12,7 @@
 
 #include "pch.h"
 #include "WaveBankReader.h"
+#include "WaveBankLayout.h"
 #include "Audio.h"
 #include "PlatformHelpers.h"
 
@@ -23,401 +24,13 @@
 
 namespace
 {
-#pragma pack(push, 1)
+    struct view_closer { void operator()(const void* p) { if (p) UnmapViewOfFile(p); } };
 
-    static const size_t DVD_SECTOR_SIZE = 2048;
-    static const size_t DVD_BLOCK_SIZE = DVD_SECTOR_SIZE * 16;
-
-    static const size_t ALIGNMENT_MIN = 4;
-    static const size_t ALIGNMENT_DVD = DVD_SECTOR_SIZE;
-
-    static const size_t MAX_DATA_SEGMENT_SIZE = 0xFFFFFFFF;
-    static const size_t MAX_COMPACT_DATA_SEGMENT_SIZE = 0x001FFFFF;
-
-    struct REGION
-    {
-        uint32_t    dwOffset;   // Region offset, in bytes.
-        uint32_t    dwLength;   // Region length, in bytes.
-
-        void BigEndian()
-        {
-            dwOffset = _byteswap_ulong(dwOffset);
-            dwLength = _byteswap_ulong(dwLength);
-        }
-    };
-
-    struct SAMPLEREGION
-    {
-        uint32_t    dwStartSample;  // Start sample for the region.
-        uint32_t    dwTotalSamples; // Region length in samples.
-
-        void BigEndian()
-        {
-            dwStartSample = _byteswap_ulong(dwStartSample);
-            dwTotalSamples = _byteswap_ulong(dwTotalSamples);
-        }
-    };
-
-    struct HEADER
-    {
-        static const uint32_t SIGNATURE = MAKEFOURCC('W', 'B', 'N', 'D');
-        static const uint32_t BE_SIGNATURE = MAKEFOURCC('D', 'N', 'B', 'W');
-        static const uint32_t VERSION = 44;
-
-        enum SEGIDX
-        {
-            SEGIDX_BANKDATA = 0,       // Bank data
-            SEGIDX_ENTRYMETADATA,      // Entry meta-data
-            SEGIDX_SEEKTABLES,         // Storage for seek tables for the encoded waves.
-            SEGIDX_ENTRYNAMES,         // Entry friendly names
-            SEGIDX_ENTRYWAVEDATA,      // Entry wave data
-            SEGIDX_COUNT
-        };
-
-        uint32_t    dwSignature;            // File signature
-        uint32_t    dwVersion;              // Version of the tool that created the file
-        uint32_t    dwHeaderVersion;        // Version of the file format
-        REGION      Segments[SEGIDX_COUNT]; // Segment lookup table
-
-        void BigEndian()
-        {
-            // Leave dwSignature alone as indicator of BE vs. LE
-
-            dwVersion = _byteswap_ulong(dwVersion);
-            dwHeaderVersion = _byteswap_ulong(dwHeaderVersion);
-            for (size_t j = 0; j < SEGIDX_COUNT; ++j)
-            {
-                Segments[j].BigEndian();
-            }
-        }
-    };
-
-#pragma warning( disable : 4201 4203 )
-
-    union MINIWAVEFORMAT
-    {
-        static const uint32_t TAG_PCM = 0x0;
-        static const uint32_t TAG_XMA = 0x1;
-        static const uint32_t TAG_ADPCM = 0x2;
-        static const uint32_t TAG_WMA = 0x3;
-
-        static const uint32_t BITDEPTH_8 = 0x0; // PCM only
-        static const uint32_t BITDEPTH_16 = 0x1; // PCM only
-
-        static const size_t ADPCM_BLOCKALIGN_CONVERSION_OFFSET = 22;
-
-        struct
-        {
-            uint32_t       wFormatTag : 2;        // Format tag
-            uint32_t       nChannels : 3;        // Channel count (1 - 6)
-            uint32_t       nSamplesPerSec : 18;       // Sampling rate
-            uint32_t       wBlockAlign : 8;        // Block alignment.  For WMA, lower 6 bits block alignment index, upper 2 bits bytes-per-second index.
-            uint32_t       wBitsPerSample : 1;        // Bits per sample (8 vs. 16, PCM only); WMAudio2/WMAudio3 (for WMA)
-        };
-
-        uint32_t           dwValue;
-
-        void BigEndian()
-        {
-            dwValue = _byteswap_ulong(dwValue);
-        }
-
-        WORD BitsPerSample() const
-        {
-            if (wFormatTag == TAG_XMA)
-                return 16; // XMA_OUTPUT_SAMPLE_BITS == 16
-            if (wFormatTag == TAG_WMA)
-                return 16;
-            if (wFormatTag == TAG_ADPCM)
-                return 4; // MSADPCM_BITS_PER_SAMPLE == 4
-
-            // wFormatTag must be TAG_PCM (2 bits can only represent 4 different values)
-            return (wBitsPerSample == BITDEPTH_16) ? 16 : 8;
-        }
-
-        DWORD BlockAlign() const
-        {
-            switch (wFormatTag)
-            {
-                case TAG_PCM:
-                    return wBlockAlign;
-
-                case TAG_XMA:
-                    return (nChannels * 16 / 8); // XMA_OUTPUT_SAMPLE_BITS = 16
-
-                case TAG_ADPCM:
-                    return (wBlockAlign + ADPCM_BLOCKALIGN_CONVERSION_OFFSET) * nChannels;
-
-                case TAG_WMA:
-                {
-                    static const uint32_t aWMABlockAlign[] =
-                    {
-                        929,
-                        1487,
-                        1280,
-                        2230,
-                        8917,
-                        8192,
-                        4459,
-                        5945,
-                        2304,
-                        1536,
-                        1485,
-                        1008,
-                        2731,
-                        4096,
-                        6827,
-                        5462,
-                        1280
-                    };
-
-                    uint32_t dwBlockAlignIndex = wBlockAlign & 0x1F;
-                    if (dwBlockAlignIndex < _countof(aWMABlockAlign))
-                        return aWMABlockAlign[dwBlockAlignIndex];
-                }
-                break;
-            }
-
-            return 0;
-        }
-
-        DWORD AvgBytesPerSec() const
-        {
-            switch (wFormatTag)
-            {
-                case TAG_PCM:
-                    return nSamplesPerSec * wBlockAlign;
-
-                case TAG_XMA:
-                    return nSamplesPerSec * BlockAlign();
-
-                case TAG_ADPCM:
-                {
-                    uint32_t blockAlign = BlockAlign();
-                    uint32_t samplesPerAdpcmBlock = AdpcmSamplesPerBlock();
-                    return blockAlign * nSamplesPerSec / samplesPerAdpcmBlock;
-                }
-
-                case TAG_WMA:
-                {
-                    static const uint32_t aWMAAvgBytesPerSec[] =
-                    {
-                        12000,
-                        24000,
-                        4000,
-                        6000,
-                        8000,
-                        20000,
-                        2500
-                    };
-                    // bitrate = entry * 8
-
-                    uint32_t dwBytesPerSecIndex = wBlockAlign >> 5;
-                    if (dwBytesPerSecIndex < _countof(aWMAAvgBytesPerSec))
-                        return aWMAAvgBytesPerSec[dwBytesPerSecIndex];
-                }
-                break;
-            }
-
-            return 0;
-        }
-
-        DWORD AdpcmSamplesPerBlock() const
-        {
-            uint32_t nBlockAlign = (wBlockAlign + ADPCM_BLOCKALIGN_CONVERSION_OFFSET) * nChannels;
-            return nBlockAlign * 2 / uint32_t(nChannels) - 12;
-        }
-
-        void AdpcmFillCoefficientTable(ADPCMWAVEFORMAT *fmt) const
-        {
-            // These are fixed since we are always using MS ADPCM
-            fmt->wNumCoef = 7 /* MSADPCM_NUM_COEFFICIENTS */;
-
-            static ADPCMCOEFSET aCoef[7] = { { 256, 0}, {512, -256}, {0,0}, {192,64}, {240,0}, {460, -208}, {392,-232} };
-            memcpy(&fmt->aCoef, aCoef, sizeof(aCoef));
-        }
-    };
-
-    struct BANKDATA
-    {
-        static const size_t BANKNAME_LENGTH = 64;
-
-        static const uint32_t TYPE_BUFFER = 0x00000000;
-        static const uint32_t TYPE_STREAMING = 0x00000001;
-        static const uint32_t TYPE_MASK = 0x00000001;
-
-        static const uint32_t FLAGS_ENTRYNAMES = 0x00010000;
-        static const uint32_t FLAGS_COMPACT = 0x00020000;
-        static const uint32_t FLAGS_SYNC_DISABLED = 0x00040000;
-        static const uint32_t FLAGS_SEEKTABLES = 0x00080000;
-        static const uint32_t FLAGS_MASK = 0x000F0000;
-
-        uint32_t        dwFlags;                        // Bank flags
-        uint32_t        dwEntryCount;                   // Number of entries in the bank
-        char            szBankName[BANKNAME_LENGTH];    // Bank friendly name
-        uint32_t        dwEntryMetaDataElementSize;     // Size of each entry meta-data element, in bytes
-        uint32_t        dwEntryNameElementSize;         // Size of each entry name element, in bytes
-        uint32_t        dwAlignment;                    // Entry alignment, in bytes
-        MINIWAVEFORMAT  CompactFormat;                  // Format data for compact bank
-        FILETIME        BuildTime;                      // Build timestamp
-
-        void BigEndian()
-        {
-            dwFlags = _byteswap_ulong(dwFlags);
-            dwEntryCount = _byteswap_ulong(dwEntryCount);
-            dwEntryMetaDataElementSize = _byteswap_ulong(dwEntryMetaDataElementSize);
-            dwEntryNameElementSize = _byteswap_ulong(dwEntryNameElementSize);
-            dwAlignment = _byteswap_ulong(dwAlignment);
-            CompactFormat.BigEndian();
-            BuildTime.dwLowDateTime = _byteswap_ulong(BuildTime.dwLowDateTime);
-            BuildTime.dwHighDateTime = _byteswap_ulong(BuildTime.dwHighDateTime);
-        }
-    };
-
-    struct ENTRY
-    {
-        static const uint32_t FLAGS_READAHEAD = 0x00000001;     // Enable stream read-ahead
-        static const uint32_t FLAGS_LOOPCACHE = 0x00000002;     // One or more looping sounds use this wave
-        static const uint32_t FLAGS_REMOVELOOPTAIL = 0x00000004;// Remove data after the end of the loop region
-        static const uint32_t FLAGS_IGNORELOOP = 0x00000008;    // Used internally when the loop region can't be used
-        static const uint32_t FLAGS_MASK = 0x00000008;
-
-        union
-        {
-            struct
-            {
-                // Entry flags
-                uint32_t                   dwFlags : 4;
-
-                // Duration of the wave, in units of one sample.
-                // For instance, a ten second long wave sampled
-                // at 48KHz would have a duration of 480,000.
-                // This value is not affected by the number of
-                // channels, the number of bits per sample, or the
-                // compression format of the wave.
-                uint32_t                   Duration : 28;
-            };
-            uint32_t dwFlagsAndDuration;
-        };
-
-        MINIWAVEFORMAT  Format;         // Entry format.
-        REGION          PlayRegion;     // Region within the wave data segment that contains this entry.
-        SAMPLEREGION    LoopRegion;     // Region within the wave data (in samples) that should loop.
-
-        void BigEndian()
-        {
-            dwFlagsAndDuration = _byteswap_ulong(dwFlagsAndDuration);
-            Format.BigEndian();
-            PlayRegion.BigEndian();
-            LoopRegion.BigEndian();
-        }
-    };
-
-    struct ENTRYCOMPACT
-    {
-        uint32_t       dwOffset : 21;       // Data offset, in multiplies of the bank alignment
-        uint32_t       dwLengthDeviation : 11;       // Data length deviation, in bytes
-
-        void BigEndian()
-        {
-            *reinterpret_cast<uint32_t*>(this) = _byteswap_ulong(*reinterpret_cast<const uint32_t*>(this));
-        }
-
-        void ComputeLocations(DWORD& offset, DWORD& length, uint32_t index, const HEADER& header, const BANKDATA& data, const ENTRYCOMPACT* entries) const
-        {
-            offset = dwOffset * data.dwAlignment;
-
-            if (index < (data.dwEntryCount - 1))
-            {
-                length = (entries[index + 1].dwOffset * data.dwAlignment) - offset - dwLengthDeviation;
-            }
-            else
-            {
-                length = header.Segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwLength - offset - dwLengthDeviation;
-            }
-        }
-
-        static uint32_t GetDuration(DWORD length, const BANKDATA& data, const uint32_t* seekTable)
-        {
-            switch (data.CompactFormat.wFormatTag)
-            {
-                case MINIWAVEFORMAT::TAG_ADPCM:
-                {
-                    uint32_t duration = (length / data.CompactFormat.BlockAlign()) * data.CompactFormat.AdpcmSamplesPerBlock();
-                    uint32_t partial = length % data.CompactFormat.BlockAlign();
-                    if (partial)
-                    {
-                        if (partial >= (7u * data.CompactFormat.nChannels))
-                            duration += (partial * 2 / data.CompactFormat.nChannels - 12);
-                    }
-                    return duration;
-                }
-
-                case MINIWAVEFORMAT::TAG_WMA:
-                    if (seekTable)
-                    {
-                        uint32_t seekCount = *seekTable;
-                        if (seekCount > 0)
-                        {
-                            return seekTable[seekCount] / uint32_t(2 * data.CompactFormat.nChannels);
-                        }
-                    }
-                    return 0;
-
-                case MINIWAVEFORMAT::TAG_XMA:
-                    if (seekTable)
-                    {
-                        uint32_t seekCount = *seekTable;
-                        if (seekCount > 0)
-                        {
-                            return seekTable[seekCount];
-                        }
-                    }
-                    return 0;
-
-                default:
-                    return uint32_t((uint64_t(length) * 8)
-                        / (uint64_t(data.CompactFormat.BitsPerSample()) * uint64_t(data.CompactFormat.nChannels)));
-            }
-        }
-    };
-
-#pragma pack(pop)
-
-    inline const uint32_t* FindSeekTable(uint32_t index, const uint8_t* seekTable, const HEADER& header, const BANKDATA& data)
-    {
-        if (!seekTable || index >= data.dwEntryCount)
-            return nullptr;
-
-        uint32_t seekSize = header.Segments[HEADER::SEGIDX_SEEKTABLES].dwLength;
-
-        if ((index * sizeof(uint32_t)) > seekSize)
-            return nullptr;
-
-        auto table = reinterpret_cast<const uint32_t*>(seekTable);
-        uint32_t offset = table[index];
-        if (offset == uint32_t(-1))
-            return nullptr;
-
-        offset += sizeof(uint32_t) * data.dwEntryCount;
-
-        if (offset > seekSize)
-            return nullptr;
-
-        return reinterpret_cast<const uint32_t*>(seekTable + offset);
-    }
+    typedef std::unique_ptr<const void, view_closer> ScopedView;
 }
 
-static_assert(sizeof(REGION) == 8, "Mismatch with xact3wb.h");
-static_assert(sizeof(SAMPLEREGION) == 8, "Mismatch with xact3wb.h");
-static_assert(sizeof(HEADER) == 52, "Mismatch with xact3wb.h");
-static_assert(sizeof(ENTRY) == 24, "Mismatch with xact3wb.h");
-static_assert(sizeof(MINIWAVEFORMAT) == 4, "Mismatch with xact3wb.h");
-static_assert(sizeof(ENTRY) == 24, "Mismatch with xact3wb.h");
-static_assert(sizeof(ENTRYCOMPACT) == 4, "Mismatch with xact3wb.h");
-static_assert(sizeof(BANKDATA) == 96, "Mismatch with xact3wb.h");
-
 using namespace DirectX;
+using namespace DirectX::WaveBankLayout;
 
 //--------------------------------------------------------------------------------------
 class WaveBankReader::Impl
@@ -428,7 +41,11 @@ public:
         m_request{},
         m_prepared(false),
         m_header{},
-        m_data{}
+        m_data{},
+        m_nameTable(nullptr),
+        m_entryTable(nullptr),
+        m_seekTable(nullptr),
+        m_waveTable(nullptr)
     #if defined(_XBOX_ONE) && defined(_TITLE)
         , m_xmaMemory(nullptr)
     #endif
@@ -438,8 +55,13 @@ public:
     ~Impl() { Close(); }
 
     HRESULT Open(_In_z_ const wchar_t* szFileName);
+    HRESULT OpenMapped(_In_z_ const wchar_t* szFileName);
     void Close();
 
+    void Prefetch(_In_reads_(count) const uint32_t* indices, size_t count) const;
+
+    bool IsMapped() const { return m_view != nullptr; }
+
     HRESULT GetFormat(_In_ uint32_t index, _Out_writes_bytes_(maxsize) WAVEFORMATEX* pFormat, _In_ size_t maxsize) const;
 
     HRESULT GetWaveData(_In_ uint32_t index, _Outptr_ const uint8_t** pData, _Out_ uint32_t& dataSize) const;
@@ -450,16 +72,25 @@ public:
 
     bool UpdatePrepared();
 
+    uint32_t Find(_In_z_ const char* name) const;
+    uint32_t FindByHash(uint32_t hash) const;
+
     void Clear()
     {
         memset(&m_header, 0, sizeof(HEADER));
         memset(&m_data, 0, sizeof(BANKDATA));
 
         m_names.clear();
+        m_nameData.reset();
         m_entries.reset();
         m_seekData.reset();
         m_waveData.reset();
 
+        m_nameTable = nullptr;
+        m_entryTable = nullptr;
+        m_seekTable = nullptr;
+        m_waveTable = nullptr;
+
     #if defined(_XBOX_ONE) && defined(_TITLE)
         if (m_xmaMemory)
         {
@@ -476,13 +107,46 @@ public:
 
     HEADER                              m_header;
     BANKDATA                            m_data;
-    std::map<std::string, uint32_t>     m_names;
+
+    struct NameEntry
+    {
+        uint32_t    hash;
+        uint32_t    index;
+    };
+
+    std::vector<NameEntry>              m_names;
 
 private:
+    std::vector<NameEntry>::const_iterator LowerBound(uint32_t hash) const
+    {
+        return std::lower_bound(m_names.cbegin(), m_names.cend(), hash, [](const NameEntry& entry, uint32_t value)
+        {
+            return entry.hash < value;
+        });
+    }
+
+    void IndexNames();
+
+#if defined(_XBOX_ONE) && defined(_TITLE)
+    bool HasXMAEntries() const;
+#endif
+
+    // Buffers owned by banks loaded with Open
+    std::unique_ptr<char[]>             m_nameData;
     std::unique_ptr<uint8_t[]>          m_entries;
     std::unique_ptr<uint8_t[]>          m_seekData;
     std::unique_ptr<uint8_t[]>          m_waveData;
 
+    // Mapping of banks loaded with OpenMapped
+    ScopedHandle                        m_mapping;
+    ScopedView                          m_view;
+
+    // Segments of the bank, either in the buffers above or in the mapped view
+    const char*                         m_nameTable;
+    const uint8_t*                      m_entryTable;
+    const uint8_t*                      m_seekTable;
+    const uint8_t*                      m_waveTable;
+
 #if defined(_XBOX_ONE) && defined(_TITLE)
 public:
     void*                               m_xmaMemory;
@@ -604,55 +268,17 @@ HRESULT WaveBankReader::Impl::Open(const wchar_t* szFileName)
     if (be)
         m_data.BigEndian();
 
-    if (!m_data.dwEntryCount)
-    {
-        return HRESULT_FROM_WIN32(ERROR_NO_DATA);
-    }
-
-    if (m_data.dwFlags & BANKDATA::TYPE_STREAMING)
-    {
-        if (m_data.dwAlignment < ALIGNMENT_DVD)
-            return E_FAIL;
-        if (m_data.dwAlignment % DVD_SECTOR_SIZE)
-            return E_FAIL;
-    }
-    else if (m_data.dwAlignment < ALIGNMENT_MIN)
-    {
-        return E_FAIL;
-    }
-
-    if (m_data.dwFlags & BANKDATA::FLAGS_COMPACT)
-    {
-        if (m_data.dwEntryMetaDataElementSize != sizeof(ENTRYCOMPACT))
-        {
-            return E_FAIL;
-        }
-
-        if (m_header.Segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwLength > (MAX_COMPACT_DATA_SEGMENT_SIZE * m_data.dwAlignment))
-        {
-            // Data segment is too large to be valid compact wavebank
-            return E_FAIL;
-        }
-    }
-    else
-    {
-        if (m_data.dwEntryMetaDataElementSize != sizeof(ENTRY))
-        {
-            return E_FAIL;
-        }
-    }
+    HRESULT hr = ValidateBankData(m_header, m_data);
+    if (FAILED(hr))
+        return hr;
 
     DWORD metadataBytes = m_header.Segments[HEADER::SEGIDX_ENTRYMETADATA].dwLength;
-    if (metadataBytes != (m_data.dwEntryCount * m_data.dwEntryMetaDataElementSize))
-    {
-        return E_FAIL;
-    }
 
     // Load names
     DWORD namesBytes = m_header.Segments[HEADER::SEGIDX_ENTRYNAMES].dwLength;
     if (namesBytes > 0)
     {
-        if (namesBytes >= (m_data.dwEntryNameElementSize * m_data.dwEntryCount))
+        if (namesBytes >= (uint64_t(m_data.dwEntryNameElementSize) * m_data.dwEntryCount))
         {
             std::unique_ptr<char[]> temp(new (std::nothrow) char[namesBytes]);
             if (!temp)
@@ -685,15 +311,10 @@ HRESULT WaveBankReader::Impl::Open(const wchar_t* szFileName)
                 return HRESULT_FROM_WIN32(GetLastError());
             }
 
-            for (uint32_t j = 0; j < m_data.dwEntryCount; ++j)
-            {
-                DWORD n = m_data.dwEntryNameElementSize * j;
-
-                char name[64] = {};
-                strncpy_s(name, &temp[n], sizeof(name));
+            m_nameData = std::move(temp);
+            m_nameTable = m_nameData.get();
 
-                m_names[name] = j;
-            }
+            IndexNames();
         }
     }
 
@@ -736,6 +357,8 @@ HRESULT WaveBankReader::Impl::Open(const wchar_t* szFileName)
         return HRESULT_FROM_WIN32(GetLastError());
     }
 
+    m_entryTable = m_entries.get();
+
     if (be)
     {
         if (m_data.dwFlags & BANKDATA::FLAGS_COMPACT)
@@ -795,6 +418,8 @@ HRESULT WaveBankReader::Impl::Open(const wchar_t* szFileName)
                 *ptr = _byteswap_ulong(*ptr);
             }
         }
+
+        m_seekTable = m_seekData.get();
     }
 
     DWORD waveLen = m_header.Segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwLength;
@@ -840,28 +465,9 @@ HRESULT WaveBankReader::Impl::Open(const wchar_t* szFileName)
         void *dest;
 
     #if defined(_XBOX_ONE) && defined(_TITLE)
-        bool xma = false;
-        if (m_data.dwFlags & BANKDATA::FLAGS_COMPACT)
-        {
-            if (m_data.CompactFormat.wFormatTag == MINIWAVEFORMAT::TAG_XMA)
-                xma = true;
-        }
-        else
-        {
-            for (uint32_t j = 0; j < m_data.dwEntryCount; ++j)
-            {
-                auto& entry = reinterpret_cast<const ENTRY*>(m_entries.get())[j];
-                if (entry.Format.wFormatTag == MINIWAVEFORMAT::TAG_XMA)
-                {
-                    xma = true;
-                    break;
-                }
-            }
-        }
-
-        if (xma)
+        if (HasXMAEntries())
         {
-            HRESULT hr = ApuAlloc(&m_xmaMemory, nullptr, waveLen, SHAPE_XMA_INPUT_BUFFER_ALIGNMENT);
+            hr = ApuAlloc(&m_xmaMemory, nullptr, waveLen, SHAPE_XMA_INPUT_BUFFER_ALIGNMENT);
             if (FAILED(hr))
             {
                 DebugTrace("ERROR: ApuAlloc failed. Did you allocate a large enough heap with ApuCreateHeap for all your XMA wave data?\n");
@@ -880,6 +486,8 @@ HRESULT WaveBankReader::Impl::Open(const wchar_t* szFileName)
             dest = m_waveData.get();
         }
 
+        m_waveTable = static_cast<const uint8_t*>(dest);
+
         memset(&m_request, 0, sizeof(OVERLAPPED));
         m_request.Offset = m_header.Segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwOffset;
         m_request.hEvent = m_event.get();
@@ -903,6 +511,196 @@ HRESULT WaveBankReader::Impl::Open(const wchar_t* szFileName)
 }
 
 
+_Use_decl_annotations_
+HRESULT WaveBankReader::Impl::OpenMapped(const wchar_t* szFileName)
+{
+    Close();
+    Clear();
+
+    m_prepared = false;
+
+#if (_WIN32_WINNT >= _WIN32_WINNT_WIN8)
+    CREATEFILE2_EXTENDED_PARAMETERS params = { sizeof(CREATEFILE2_EXTENDED_PARAMETERS), 0, 0, 0, {}, nullptr };
+    params.dwFileAttributes = FILE_ATTRIBUTE_NORMAL;
+    params.dwFileFlags = FILE_FLAG_RANDOM_ACCESS;
+    ScopedHandle hFile(safe_handle(CreateFile2(szFileName,
+                       GENERIC_READ,
+                       FILE_SHARE_READ,
+                       OPEN_EXISTING,
+                       &params)));
+#else
+    ScopedHandle hFile(safe_handle(CreateFileW(szFileName,
+                       GENERIC_READ,
+                       FILE_SHARE_READ,
+                       nullptr,
+                       OPEN_EXISTING,
+                       FILE_FLAG_RANDOM_ACCESS,
+                       nullptr)));
+#endif
+
+    if (!hFile)
+    {
+        return HRESULT_FROM_WIN32(GetLastError());
+    }
+
+    FILE_STANDARD_INFO fileInfo;
+    if (!GetFileInformationByHandleEx(hFile.get(), FileStandardInfo, &fileInfo, sizeof(fileInfo)))
+    {
+        return HRESULT_FROM_WIN32(GetLastError());
+    }
+
+    // File is too big for a 32-bit view, or too small to be a wave bank
+    if (fileInfo.EndOfFile.HighPart > 0 || fileInfo.EndOfFile.LowPart < sizeof(HEADER))
+    {
+        return E_FAIL;
+    }
+
+    const uint64_t fileSize = fileInfo.EndOfFile.LowPart;
+
+    // Pages are only read in when first touched, so opening the bank reads little more than its metadata
+#if (_WIN32_WINNT >= _WIN32_WINNT_WIN8)
+    m_mapping.reset(CreateFileMappingFromApp(hFile.get(), nullptr, PAGE_READONLY, 0, nullptr));
+#else
+    m_mapping.reset(CreateFileMappingW(hFile.get(), nullptr, PAGE_READONLY, 0, 0, nullptr));
+#endif
+    if (!m_mapping)
+    {
+        return HRESULT_FROM_WIN32(GetLastError());
+    }
+
+#if (_WIN32_WINNT >= _WIN32_WINNT_WIN8)
+    m_view.reset(MapViewOfFileFromApp(m_mapping.get(), FILE_MAP_READ, 0, 0));
+#else
+    m_view.reset(MapViewOfFile(m_mapping.get(), FILE_MAP_READ, 0, 0, 0));
+#endif
+    if (!m_view)
+    {
+        return HRESULT_FROM_WIN32(GetLastError());
+    }
+
+    // Every segment is checked against the size of the view before any pointer into it is kept
+    HRESULT hr = MapSegments(static_cast<const uint8_t*>(m_view.get()), fileSize,
+        m_header, m_data, m_nameTable, m_entryTable, m_seekTable, m_waveTable);
+
+    if (hr == S_FALSE)
+    {
+        // Big-endian metadata has to be byte-swapped into buffers of its own
+        DebugTrace("INFO: \"%ls\" is a big-endian (Xbox 360) wave bank, loading it without a mapping\n", szFileName);
+        return Open(szFileName);
+    }
+
+    if (FAILED(hr))
+        return hr;
+
+    if (m_data.dwFlags & BANKDATA::TYPE_STREAMING)
+    {
+        // Streaming banks never load their wave data, so there is nothing to gain from a mapping
+        return Open(szFileName);
+    }
+
+    if (m_nameTable)
+    {
+        IndexNames();
+    }
+
+#if defined(_XBOX_ONE) && defined(_TITLE)
+    if (HasXMAEntries())
+    {
+        // The XMA decoder can only read wave data placed in APU memory
+        return Open(szFileName);
+    }
+#endif
+
+    m_prepared = true;
+
+    return S_OK;
+}
+
+
+_Use_decl_annotations_
+void WaveBankReader::Impl::Prefetch(const uint32_t* indices, size_t count) const
+{
+    if (!m_view || !indices || !count)
+        return;
+
+#if (_WIN32_WINNT >= _WIN32_WINNT_WIN8) && !defined(_XBOX_ONE)
+    std::vector<WIN32_MEMORY_RANGE_ENTRY> ranges;
+    ranges.reserve(count);
+
+    for (size_t j = 0; j < count; ++j)
+    {
+        const uint8_t* data = nullptr;
+        uint32_t dataSize = 0;
+        if (SUCCEEDED(GetWaveData(indices[j], &data, dataSize)) && dataSize > 0)
+        {
+            WIN32_MEMORY_RANGE_ENTRY range = { const_cast<uint8_t*>(data), dataSize };
+            ranges.push_back(range);
+        }
+    }
+
+    if (!ranges.empty())
+    {
+        // This is only a hint, so a failure here just means the pages fault in when played
+        (void)PrefetchVirtualMemory(GetCurrentProcess(), ranges.size(), ranges.data(), 0);
+    }
+#endif
+}
+
+
+void WaveBankReader::Impl::IndexNames()
+{
+    assert(m_nameTable != nullptr);
+
+    // Index the names by hash in a sorted flat table, so lookups never build or compare strings
+    m_names.reserve(m_data.dwEntryCount);
+
+    for (uint32_t j = 0; j < m_data.dwEntryCount; ++j)
+    {
+        char name[64];
+        GetEntryName(j, m_nameTable, m_data, name);
+
+        NameEntry entry = { WaveBankNameHash(name).value, j };
+        m_names.push_back(entry);
+    }
+
+    std::sort(m_names.begin(), m_names.end(), [](const NameEntry& a, const NameEntry& b)
+    {
+        return (a.hash != b.hash) ? (a.hash < b.hash) : (a.index < b.index);
+    });
+
+#if defined(_DEBUG)
+    for (size_t j = 1; j < m_names.size(); ++j)
+    {
+        if (m_names[j].hash == m_names[j - 1].hash)
+        {
+            DebugTrace("WARNING: Wave bank entries %u and %u have names with the same hash %08X\n",
+                m_names[j - 1].index, m_names[j].index, m_names[j].hash);
+        }
+    }
+#endif
+}
+
+
+#if defined(_XBOX_ONE) && defined(_TITLE)
+bool WaveBankReader::Impl::HasXMAEntries() const
+{
+    if (m_data.dwFlags & BANKDATA::FLAGS_COMPACT)
+    {
+        return (m_data.CompactFormat.wFormatTag == MINIWAVEFORMAT::TAG_XMA);
+    }
+
+    for (uint32_t j = 0; j < m_data.dwEntryCount; ++j)
+    {
+        auto& entry = reinterpret_cast<const ENTRY*>(m_entryTable)[j];
+        if (entry.Format.wFormatTag == MINIWAVEFORMAT::TAG_XMA)
+            return true;
+    }
+
+    return false;
+}
+#endif
+
+
 void WaveBankReader::Impl::Close()
 {
     if (m_async != INVALID_HANDLE_VALUE)
@@ -924,6 +722,9 @@ void WaveBankReader::Impl::Close()
     }
     m_event.reset();
 
+    m_view.reset();
+    m_mapping.reset();
+
 #if defined(_XBOX_ONE) && defined(_TITLE)
     if (m_xmaMemory)
     {
@@ -940,12 +741,12 @@ HRESULT WaveBankReader::Impl::GetFormat(uint32_t index, WAVEFORMATEX* pFormat, s
     if (!pFormat || !maxsize)
         return E_INVALIDARG;
 
-    if (index >= m_data.dwEntryCount || !m_entries)
+    if (index >= m_data.dwEntryCount || !m_entryTable)
     {
         return E_FAIL;
     }
 
-    auto& miniFmt = (m_data.dwFlags & BANKDATA::FLAGS_COMPACT) ? m_data.CompactFormat : (reinterpret_cast<const ENTRY*>(m_entries.get())[index].Format);
+    auto& miniFmt = (m_data.dwFlags & BANKDATA::FLAGS_COMPACT) ? m_data.CompactFormat : (reinterpret_cast<const ENTRY*>(m_entryTable)[index].Format);
 
     switch (miniFmt.wFormatTag)
     {
@@ -996,7 +797,7 @@ HRESULT WaveBankReader::Impl::GetFormat(uint32_t index, WAVEFORMATEX* pFormat, s
                 xmaFmt->BytesPerBlock = 65536 /* XACT_FIXED_XMA_BLOCK_SIZE */;
                 xmaFmt->EncoderVersion = 4 /* XMAENCODER_VERSION_XMA2 */;
 
-                auto seekTable = FindSeekTable(index, m_seekData.get(), m_header, m_data);
+                auto seekTable = FindSeekTable(index, m_seekTable, m_header, m_data);
                 if (seekTable)
                 {
                     xmaFmt->BlockCount = static_cast<WORD>(*seekTable);
@@ -1021,10 +822,10 @@ HRESULT WaveBankReader::Impl::GetFormat(uint32_t index, WAVEFORMATEX* pFormat, s
 
                 if (m_data.dwFlags & BANKDATA::FLAGS_COMPACT)
                 {
-                    auto& entry = reinterpret_cast<const ENTRYCOMPACT*>(m_entries.get())[index];
+                    auto& entry = reinterpret_cast<const ENTRYCOMPACT*>(m_entryTable)[index];
 
                     DWORD dwOffset, dwLength;
-                    entry.ComputeLocations(dwOffset, dwLength, index, m_header, m_data, reinterpret_cast<const ENTRYCOMPACT*>(m_entries.get()));
+                    entry.ComputeLocations(dwOffset, dwLength, index, m_header, m_data, reinterpret_cast<const ENTRYCOMPACT*>(m_entryTable));
 
                     xmaFmt->SamplesEncoded = entry.GetDuration(dwLength, m_data, seekTable);
 
@@ -1033,7 +834,7 @@ HRESULT WaveBankReader::Impl::GetFormat(uint32_t index, WAVEFORMATEX* pFormat, s
                 }
                 else
                 {
-                    auto& entry = reinterpret_cast<const ENTRY*>(m_entries.get())[index];
+                    auto& entry = reinterpret_cast<const ENTRY*>(m_entryTable)[index];
 
                     xmaFmt->SamplesEncoded = entry.Duration;
                     xmaFmt->PlayBegin = 0;
@@ -1076,16 +877,12 @@ HRESULT WaveBankReader::Impl::GetWaveData(uint32_t index, const uint8_t** pData,
     if (!pData)
         return E_INVALIDARG;
 
-    if (index >= m_data.dwEntryCount || !m_entries)
+    if (index >= m_data.dwEntryCount || !m_entryTable)
     {
         return E_FAIL;
     }
 
-#if defined(_XBOX_ONE) && defined(_TITLE)
-    const uint8_t* waveData = (m_xmaMemory) ? reinterpret_cast<uint8_t*>(m_xmaMemory) : m_waveData.get();
-#else
-    const uint8_t* waveData = m_waveData.get();
-#endif
+    const uint8_t* waveData = m_waveTable;
 
     if (!waveData)
         return E_FAIL;
@@ -1100,33 +897,13 @@ HRESULT WaveBankReader::Impl::GetWaveData(uint32_t index, const uint8_t** pData,
         return HRESULT_FROM_WIN32(ERROR_IO_INCOMPLETE);
     }
 
-    if (m_data.dwFlags & BANKDATA::FLAGS_COMPACT)
-    {
-        auto& entry = reinterpret_cast<const ENTRYCOMPACT*>(m_entries.get())[index];
-
-        DWORD dwOffset, dwLength;
-        entry.ComputeLocations(dwOffset, dwLength, index, m_header, m_data, reinterpret_cast<const ENTRYCOMPACT*>(m_entries.get()));
+    DWORD dwOffset, dwLength;
+    HRESULT hr = FindWaveData(index, m_entryTable, m_header, m_data, dwOffset, dwLength);
+    if (FAILED(hr))
+        return hr;
 
-        if ((dwOffset + dwLength) > m_header.Segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwLength)
-        {
-            return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
-        }
-
-        *pData = &waveData[dwOffset];
-        dataSize = dwLength;
-    }
-    else
-    {
-        auto& entry = reinterpret_cast<const ENTRY*>(m_entries.get())[index];
-
-        if ((entry.PlayRegion.dwOffset + entry.PlayRegion.dwLength) > m_header.Segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwLength)
-        {
-            return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
-        }
-
-        *pData = &waveData[entry.PlayRegion.dwOffset];
-        dataSize = entry.PlayRegion.dwLength;
-    }
+    *pData = &waveData[dwOffset];
+    dataSize = dwLength;
 
     return S_OK;
 }
@@ -1142,15 +919,15 @@ HRESULT WaveBankReader::Impl::GetSeekTable(uint32_t index, const uint32_t** pDat
     dataCount = 0;
     tag = 0;
 
-    if (index >= m_data.dwEntryCount || !m_entries)
+    if (index >= m_data.dwEntryCount || !m_entryTable)
     {
         return E_FAIL;
     }
 
-    if (!m_seekData)
+    if (!m_seekTable)
         return S_OK;
 
-    auto& miniFmt = (m_data.dwFlags & BANKDATA::FLAGS_COMPACT) ? m_data.CompactFormat : (reinterpret_cast<const ENTRY*>(m_entries.get())[index].Format);
+    auto& miniFmt = (m_data.dwFlags & BANKDATA::FLAGS_COMPACT) ? m_data.CompactFormat : (reinterpret_cast<const ENTRY*>(m_entryTable)[index].Format);
 
     switch (miniFmt.wFormatTag)
     {
@@ -1166,7 +943,7 @@ HRESULT WaveBankReader::Impl::GetSeekTable(uint32_t index, const uint32_t** pDat
             return S_OK;
     }
 
-    auto seekTable = FindSeekTable(index, m_seekData.get(), m_header, m_data);
+    auto seekTable = FindSeekTable(index, m_seekTable, m_header, m_data);
     if (!seekTable)
         return S_OK;
 
@@ -1180,32 +957,32 @@ HRESULT WaveBankReader::Impl::GetSeekTable(uint32_t index, const uint32_t** pDat
 _Use_decl_annotations_
 HRESULT WaveBankReader::Impl::GetMetadata(uint32_t index, Metadata& metadata) const
 {
-    if (index >= m_data.dwEntryCount || !m_entries)
+    if (index >= m_data.dwEntryCount || !m_entryTable)
     {
         return E_FAIL;
     }
 
     if (m_data.dwFlags & BANKDATA::FLAGS_COMPACT)
     {
-        auto& entry = reinterpret_cast<const ENTRYCOMPACT*>(m_entries.get())[index];
+        auto& entry = reinterpret_cast<const ENTRYCOMPACT*>(m_entryTable)[index];
 
         DWORD dwOffset, dwLength;
-        entry.ComputeLocations(dwOffset, dwLength, index, m_header, m_data, reinterpret_cast<const ENTRYCOMPACT*>(m_entries.get()));
+        entry.ComputeLocations(dwOffset, dwLength, index, m_header, m_data, reinterpret_cast<const ENTRYCOMPACT*>(m_entryTable));
 
-        auto seekTable = FindSeekTable(index, m_seekData.get(), m_header, m_data);
+        auto seekTable = FindSeekTable(index, m_seekTable, m_header, m_data);
         metadata.duration = entry.GetDuration(dwLength, m_data, seekTable);
         metadata.loopStart = metadata.loopLength = 0;
-        metadata.offsetBytes = dwOffset;
+        metadata.offsetBytes = dwOffset + m_header.Segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwOffset;
         metadata.lengthBytes = dwLength;
     }
     else
     {
-        auto& entry = reinterpret_cast<const ENTRY*>(m_entries.get())[index];
+        auto& entry = reinterpret_cast<const ENTRY*>(m_entryTable)[index];
 
         metadata.duration = entry.Duration;
         metadata.loopStart = entry.LoopRegion.dwStartSample;
         metadata.loopLength = entry.LoopRegion.dwTotalSamples;
-        metadata.offsetBytes = entry.PlayRegion.dwOffset;
+        metadata.offsetBytes = entry.PlayRegion.dwOffset + m_header.Segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwOffset;
         metadata.lengthBytes = entry.PlayRegion.dwLength;
     }
 
@@ -1242,6 +1019,48 @@ bool WaveBankReader::Impl::UpdatePrepared()
 }
 
 
+_Use_decl_annotations_
+uint32_t WaveBankReader::Impl::Find(const char* name) const
+{
+    if (!name || !m_nameTable)
+        return uint32_t(-1);
+
+    uint32_t hash = WaveBankNameHash(name).value;
+
+    // Names that share a hash sit next to each other, so confirm the match against the stored name
+    for (auto it = LowerBound(hash); it != m_names.cend() && it->hash == hash; ++it)
+    {
+        char entryName[64];
+        GetEntryName(it->index, m_nameTable, m_data, entryName);
+
+        if (!strcmp(entryName, name))
+            return it->index;
+    }
+
+    return uint32_t(-1);
+}
+
+
+uint32_t WaveBankReader::Impl::FindByHash(uint32_t hash) const
+{
+    auto it = LowerBound(hash);
+    if (it != m_names.cend() && it->hash == hash)
+    {
+        // A hash shared by several names cannot tell them apart, so fail rather than return the wrong entry
+        auto next = it + 1;
+        if (next != m_names.cend() && next->hash == hash)
+        {
+            DebugTrace("ERROR: Wave bank name hash %08X is ambiguous (entries %u and %u), look the entry up by name instead\n",
+                hash, it->index, next->index);
+            return uint32_t(-1);
+        }
+
+        return it->index;
+    }
+
+    return uint32_t(-1);
+}
+
 
 //--------------------------------------------------------------------------------------
 WaveBankReader::WaveBankReader() noexcept(false) :
@@ -1262,16 +1081,23 @@ HRESULT WaveBankReader::Open(const wchar_t* szFileName)
 }
 
 
+_Use_decl_annotations_
+HRESULT WaveBankReader::OpenMapped(const wchar_t* szFileName)
+{
+    return pImpl->OpenMapped(szFileName);
+}
+
+
 _Use_decl_annotations_
 uint32_t WaveBankReader::Find(const char* name) const
 {
-    auto it = pImpl->m_names.find(name);
-    if (it != pImpl->m_names.cend())
-    {
-        return it->second;
-    }
+    return pImpl->Find(name);
+}
 
-    return uint32_t(-1);
+
+uint32_t WaveBankReader::FindByHash(uint32_t hash) const
+{
+    return pImpl->FindByHash(hash);
 }
 
 
@@ -1310,6 +1136,19 @@ bool WaveBankReader::IsStreamingBank() const
 }
 
 
+bool WaveBankReader::IsMapped() const
+{
+    return pImpl->IsMapped();
+}
+
+
+_Use_decl_annotations_
+void WaveBankReader::Prefetch(const uint32_t* indices, size_t count) const
+{
+    pImpl->Prefetch(indices, count);
+}
+
+
 #if defined(_XBOX_ONE) && defined(_TITLE)
 bool WaveBankReader::HasXMA() const
 {
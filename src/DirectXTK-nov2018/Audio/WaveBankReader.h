@@ -35,13 +35,23 @@ namespace DirectX
 
         HRESULT Open(_In_z_ const wchar_t* szFileName);
 
+        // Maps the bank read-only instead of reading it into memory. Wave data, formats and seek tables are
+        // served straight from the mapping and paged in on first use. Streaming and big-endian banks, and
+        // XMA banks on Xbox One, fall back to Open.
+        HRESULT OpenMapped(_In_z_ const wchar_t* szFileName);
+
         uint32_t Find(_In_z_ const char* name) const;
+        uint32_t FindByHash(uint32_t hash) const;
 
         bool IsPrepared();
         void WaitOnPrepare();
 
         bool HasNames() const;
         bool IsStreamingBank() const;
+        bool IsMapped() const;
+
+        // Hints that the wave data of these entries is about to be used (mapped banks on Windows 8 or later)
+        void Prefetch(_In_reads_(count) const uint32_t* indices, size_t count) const;
 
     #if defined(_XBOX_ONE) && defined(_TITLE)
         bool HasXMA() const;
@@ -66,11 +76,18 @@ namespace DirectX
             uint32_t    duration;
             uint32_t    loopStart;
             uint32_t    loopLength;
-            uint32_t    offsetBytes;
+            uint32_t    offsetBytes;    // From the start of the file
             uint32_t    lengthBytes;
         };
         HRESULT GetMetadata(_In_ uint32_t index, _Out_ Metadata& metadata) const;
 
+        struct SeekData
+        {
+            uint32_t        seekCount;
+            const uint32_t* seekTable;
+            uint32_t        tag;
+        };
+
     private:
         // Private implementation.
         class Impl;
@@ -57,6 +57,7 @@
 namespace DirectX
 {
     class SoundEffectInstance;
+    class SoundStreamInstance;
 
     //----------------------------------------------------------------------------------
     struct AudioStatistics
@@ -142,6 +143,15 @@ namespace DirectX
 
     inline SOUND_EFFECT_INSTANCE_FLAGS operator|(SOUND_EFFECT_INSTANCE_FLAGS a, SOUND_EFFECT_INSTANCE_FLAGS b) { return static_cast<SOUND_EFFECT_INSTANCE_FLAGS>(static_cast<int>(a) | static_cast<int>(b)); }
 
+    enum WAVE_BANK_FLAGS
+    {
+        WaveBank_Default        = 0x0,
+
+        WaveBank_MemoryMapped   = 0x1,
+    };
+
+    inline WAVE_BANK_FLAGS operator|(WAVE_BANK_FLAGS a, WAVE_BANK_FLAGS b) { return static_cast<WAVE_BANK_FLAGS>(static_cast<int>(a) | static_cast<int>(b)); }
+
     enum AUDIO_ENGINE_REVERB
     {
         Reverb_Off,
@@ -286,11 +296,30 @@ namespace DirectX
     };
 
 
+    //----------------------------------------------------------------------------------
+    // FNV-1a hash of a wave bank entry's friendly name. Evaluates at compile time for string
+    // literals, and xwbtool -h writes the same values as constants. xwbtool rejects banks whose
+    // names collide, and lookups by a hash shared by several entries fail.
+    struct WaveBankNameHash
+    {
+        uint32_t value;
+
+        constexpr explicit WaveBankNameHash(uint32_t hash) noexcept : value(hash) {}
+        constexpr explicit WaveBankNameHash(_In_z_ const char* name) noexcept : value(Compute(name, 2166136261u)) {}
+
+    private:
+        static constexpr uint32_t Compute(const char* name, uint32_t hash) noexcept
+        {
+            return (*name) ? Compute(name + 1, static_cast<uint32_t>((uint64_t(hash ^ static_cast<uint8_t>(*name)) * 16777619u) & 0xFFFFFFFF)) : hash;
+        }
+    };
+
+
     //----------------------------------------------------------------------------------
     class WaveBank
     {
     public:
-        WaveBank(_In_ AudioEngine* engine, _In_z_ const wchar_t* wbFileName);
+        WaveBank(_In_ AudioEngine* engine, _In_z_ const wchar_t* wbFileName, WAVE_BANK_FLAGS flags = WaveBank_Default);
 
         WaveBank(WaveBank&& moveFrom) noexcept;
         WaveBank& operator= (WaveBank&& moveFrom) noexcept;
@@ -306,13 +335,26 @@ namespace DirectX
         void __cdecl Play(_In_z_ const char* name);
         void __cdecl Play(_In_z_ const char* name, float volume, float pitch, float pan);
 
+        void __cdecl Play(WaveBankNameHash name);
+        void __cdecl Play(WaveBankNameHash name, float volume, float pitch, float pan);
+
         std::unique_ptr<SoundEffectInstance> __cdecl CreateInstance(int index, SOUND_EFFECT_INSTANCE_FLAGS flags = SoundEffectInstance_Default);
         std::unique_ptr<SoundEffectInstance> __cdecl CreateInstance(_In_z_ const char* name, SOUND_EFFECT_INSTANCE_FLAGS flags = SoundEffectInstance_Default);
+        std::unique_ptr<SoundEffectInstance> __cdecl CreateInstance(WaveBankNameHash name, SOUND_EFFECT_INSTANCE_FLAGS flags = SoundEffectInstance_Default);
+
+        std::unique_ptr<SoundStreamInstance> __cdecl CreateStreamInstance(int index, SOUND_EFFECT_INSTANCE_FLAGS flags = SoundEffectInstance_Default);
+        std::unique_ptr<SoundStreamInstance> __cdecl CreateStreamInstance(_In_z_ const char* name, SOUND_EFFECT_INSTANCE_FLAGS flags = SoundEffectInstance_Default);
+        std::unique_ptr<SoundStreamInstance> __cdecl CreateStreamInstance(WaveBankNameHash name, SOUND_EFFECT_INSTANCE_FLAGS flags = SoundEffectInstance_Default);
 
         bool __cdecl IsPrepared() const;
         bool __cdecl IsInUse() const;
         bool __cdecl IsStreamingBank() const;
 
+        void __cdecl Prefetch(int index) const;
+        void __cdecl Prefetch(_In_reads_(count) const int* indices, size_t count) const;
+        // Hints that these entries are about to be played, so their audio can be paged in ahead of time
+        // (WaveBank_MemoryMapped banks only)
+
         size_t __cdecl GetSampleSizeInBytes(int index) const;
         // Returns size of wave audio data
 
@@ -325,6 +367,7 @@ namespace DirectX
         const WAVEFORMATEX* __cdecl GetFormat(int index, _Out_writes_bytes_(maxsize) WAVEFORMATEX* wfx, size_t maxsize) const;
 
         int __cdecl Find(_In_z_ const char* name) const;
+        int __cdecl Find(WaveBankNameHash name) const;
 
 #if defined(_XBOX_ONE) || (_WIN32_WINNT < _WIN32_WINNT_WIN8) || (_WIN32_WINNT >= 0x0A00 /*_WIN32_WINNT_WIN10*/ )
         bool __cdecl FillSubmitBuffer(int index, _Out_ XAUDIO2_BUFFER& buffer, _Out_ XAUDIO2_BUFFER_WMA& wmaBuffer) const;
@@ -340,8 +383,13 @@ namespace DirectX
 
         // Private interface
         void __cdecl UnregisterInstance(_In_ SoundEffectInstance* instance);
+        void __cdecl UnregisterInstance(_In_ SoundStreamInstance* instance);
+
+        HANDLE __cdecl GetAsyncHandle() const;
+        bool __cdecl GetPrivateData(int index, _Out_writes_bytes_(datasize) void* data, size_t datasize) const;
 
         friend class SoundEffectInstance;
+        friend class SoundStreamInstance;
     };
 
 
@@ -633,6 +681,49 @@ namespace DirectX
     };
 
 
+    //----------------------------------------------------------------------------------
+    class SoundStreamInstance
+    {
+    public:
+        SoundStreamInstance(SoundStreamInstance&& moveFrom) noexcept;
+        SoundStreamInstance& operator= (SoundStreamInstance&& moveFrom) noexcept;
+
+        SoundStreamInstance(SoundStreamInstance const&) = delete;
+        SoundStreamInstance& operator= (SoundStreamInstance const&) = delete;
+
+        virtual ~SoundStreamInstance();
+
+        void __cdecl Play(bool loop = false);
+        void __cdecl Stop(bool immediate = true);
+        void __cdecl Pause();
+        void __cdecl Resume();
+
+        void __cdecl SetVolume(float volume);
+        void __cdecl SetPitch(float pitch);
+        void __cdecl SetPan(float pan);
+
+        void __cdecl Apply3D(const AudioListener& listener, const AudioEmitter& emitter, bool rhcoords = true);
+
+        bool __cdecl IsLooped() const;
+
+        SoundState __cdecl GetState();
+
+        // Notifications.
+        void __cdecl OnDestroyParent();
+
+    private:
+        // Private implementation.
+        class Impl;
+
+        std::unique_ptr<Impl> pImpl;
+
+        // Private constructors
+        SoundStreamInstance(_In_ AudioEngine* engine, _In_ WaveBank* waveBank, int index, SOUND_EFFECT_INSTANCE_FLAGS flags);
+
+        friend std::unique_ptr<SoundStreamInstance> __cdecl WaveBank::CreateStreamInstance(int, SOUND_EFFECT_INSTANCE_FLAGS);
+    };
+
+
     //----------------------------------------------------------------------------------
     class DynamicSoundEffectInstance
     {
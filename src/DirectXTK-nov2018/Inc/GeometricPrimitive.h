@@ -45,6 +45,7 @@ namespace DirectX
         static std::unique_ptr<GeometricPrimitive> __cdecl CreateIcosahedron(_In_ ID3D11DeviceContext* deviceContext, float size = 1, bool rhcoords = true);
         static std::unique_ptr<GeometricPrimitive> __cdecl CreateTeapot(_In_ ID3D11DeviceContext* deviceContext, float size = 1, size_t tessellation = 8, bool rhcoords = true);
         static std::unique_ptr<GeometricPrimitive> __cdecl CreateCustom(_In_ ID3D11DeviceContext* deviceContext, const std::vector<VertexType>& vertices, const std::vector<uint16_t>& indices);
+        static std::unique_ptr<GeometricPrimitive> __cdecl CreateCustom(_In_ ID3D11DeviceContext* deviceContext, const std::vector<VertexType>& vertices, const std::vector<uint32_t>& indices);
 
         static void __cdecl CreateCube(std::vector<VertexType>& vertices, std::vector<uint16_t>& indices, float size = 1, bool rhcoords = true);
         static void __cdecl CreateBox(std::vector<VertexType>& vertices, std::vector<uint16_t>& indices, const XMFLOAT3& size, bool rhcoords = true, bool invertn = false);
@@ -59,6 +60,21 @@ namespace DirectX
         static void __cdecl CreateIcosahedron(std::vector<VertexType>& vertices, std::vector<uint16_t>& indices, float size = 1, bool rhcoords = true);
         static void __cdecl CreateTeapot(std::vector<VertexType>& vertices, std::vector<uint16_t>& indices, float size = 1, size_t tessellation = 8, bool rhcoords = true);
 
+        // 32-bit index variants, for tessellations beyond 65535 vertices. Their output is drawn with the 32-bit
+        // CreateCustom, which requires feature level 9.2 or later.
+        static void __cdecl CreateCube(std::vector<VertexType>& vertices, std::vector<uint32_t>& indices, float size = 1, bool rhcoords = true);
+        static void __cdecl CreateBox(std::vector<VertexType>& vertices, std::vector<uint32_t>& indices, const XMFLOAT3& size, bool rhcoords = true, bool invertn = false);
+        static void __cdecl CreateSphere(std::vector<VertexType>& vertices, std::vector<uint32_t>& indices, float diameter = 1, size_t tessellation = 16, bool rhcoords = true, bool invertn = false);
+        static void __cdecl CreateGeoSphere(std::vector<VertexType>& vertices, std::vector<uint32_t>& indices, float diameter = 1, size_t tessellation = 3, bool rhcoords = true);
+        static void __cdecl CreateCylinder(std::vector<VertexType>& vertices, std::vector<uint32_t>& indices, float height = 1, float diameter = 1, size_t tessellation = 32, bool rhcoords = true);
+        static void __cdecl CreateCone(std::vector<VertexType>& vertices, std::vector<uint32_t>& indices, float diameter = 1, float height = 1, size_t tessellation = 32, bool rhcoords = true);
+        static void __cdecl CreateTorus(std::vector<VertexType>& vertices, std::vector<uint32_t>& indices, float diameter = 1, float thickness = 0.333f, size_t tessellation = 32, bool rhcoords = true);
+        static void __cdecl CreateTetrahedron(std::vector<VertexType>& vertices, std::vector<uint32_t>& indices, float size = 1, bool rhcoords = true);
+        static void __cdecl CreateOctahedron(std::vector<VertexType>& vertices, std::vector<uint32_t>& indices, float size = 1, bool rhcoords = true);
+        static void __cdecl CreateDodecahedron(std::vector<VertexType>& vertices, std::vector<uint32_t>& indices, float size = 1, bool rhcoords = true);
+        static void __cdecl CreateIcosahedron(std::vector<VertexType>& vertices, std::vector<uint32_t>& indices, float size = 1, bool rhcoords = true);
+        static void __cdecl CreateTeapot(std::vector<VertexType>& vertices, std::vector<uint32_t>& indices, float size = 1, size_t tessellation = 8, bool rhcoords = true);
+
         // Draw the primitive.
         void XM_CALLCONV Draw(FXMMATRIX world, CXMMATRIX view, CXMMATRIX projection, FXMVECTOR color = Colors::White, _In_opt_ ID3D11ShaderResourceView* texture = nullptr, bool wireframe = false,
                               _In_opt_ std::function<void __cdecl()> setCustomState = nullptr) const;
@@ -44,6 +44,14 @@ namespace DirectX
         ModelMeshPart() noexcept;
         virtual ~ModelMeshPart();
 
+        // A simplified version of the part, drawn from lodIndexBuffer with the same vertex buffer
+        struct LevelOfDetail
+        {
+            uint32_t    indexCount;
+            uint32_t    startIndex;
+            float       error;      // Estimated root mean square distance from the full detail surface, in model units
+        };
+
         uint32_t                                                indexCount;
         uint32_t                                                startIndex;
         uint32_t                                                vertexOffset;
@@ -56,6 +64,8 @@ namespace DirectX
         std::shared_ptr<IEffect>                                effect;
         std::shared_ptr<std::vector<D3D11_INPUT_ELEMENT_DESC>>  vbDecl;
         bool                                                    isAlpha;
+        Microsoft::WRL::ComPtr<ID3D11Buffer>                    lodIndexBuffer;
+        std::vector<LevelOfDetail>                              levelsOfDetail;     // From finest to coarsest
 
         typedef std::vector<std::unique_ptr<ModelMeshPart>> Collection;
 
@@ -67,6 +77,20 @@ namespace DirectX
             uint32_t instanceCount, uint32_t startInstanceLocation = 0,
             _In_opt_ std::function<void __cdecl()> setCustomState = nullptr) const;
 
+        // Draw a level of detail with custom effect. Level 0 is the full part, and level i > 0 is levelsOfDetail[i - 1]
+        void __cdecl DrawLevelOfDetail(_In_ ID3D11DeviceContext* deviceContext, _In_ IEffect* ieffect, _In_ ID3D11InputLayout* iinputLayout,
+            size_t level, _In_opt_ std::function<void __cdecl()> setCustomState = nullptr) const;
+
+        // Returns the coarsest level of detail whose error is at most maxError, in model units
+        size_t __cdecl SelectLevelOfDetail(float maxError) const;
+
+        // Build up to levelCount levels of detail for a triangle list part, each with about half the triangles of the one before.
+        // indices are the part's indexCount indices, and positions is the position of the vertex at vertexOffset.
+        void __cdecl CreateLevelsOfDetail(_In_ ID3D11Device* d3dDevice, _In_ const uint16_t* indices,
+            _In_reads_bytes_(vertexCount * positionStride) const XMFLOAT3* positions, size_t positionStride, size_t vertexCount, size_t levelCount);
+        void __cdecl CreateLevelsOfDetail(_In_ ID3D11Device* d3dDevice, _In_ const uint32_t* indices,
+            _In_reads_bytes_(vertexCount * positionStride) const XMFLOAT3* positions, size_t positionStride, size_t vertexCount, size_t levelCount);
+
        // Create input layout for drawing with a custom effect.
         void __cdecl CreateInputLayout(_In_ ID3D11Device* d3dDevice, _In_ IEffect* ieffect, _Outptr_ ID3D11InputLayout** iinputLayout) const;
 
@@ -89,13 +113,14 @@ namespace DirectX
         std::wstring                name;
         bool                        ccw;
         bool                        pmalpha;
+        float                       lodScreenError;     // Root mean square level of detail error allowed on screen, as a fraction of the viewport height
 
         typedef std::vector<std::shared_ptr<ModelMesh>> Collection;
 
         // Setup states for drawing mesh
         void __cdecl PrepareForRendering(_In_ ID3D11DeviceContext* deviceContext, const CommonStates& states, bool alpha = false, bool wireframe = false) const;
 
-        // Draw the mesh
+        // Draw the mesh, using the coarsest level of detail of each part that keeps within lodScreenError
         void XM_CALLCONV Draw(_In_ ID3D11DeviceContext* deviceContext, FXMMATRIX world, CXMMATRIX view, CXMMATRIX projection,
                               bool alpha = false, _In_opt_ std::function<void __cdecl()> setCustomState = nullptr) const;
     };
@@ -122,16 +147,17 @@ namespace DirectX
         void __cdecl UpdateEffects(_In_ std::function<void __cdecl(IEffect*)> setEffect);
 
         // Loads a model from a Visual Studio Starter Kit .CMO file
+        // lodCount is the number of simplified levels of detail to build for each mesh part
         static std::unique_ptr<Model> __cdecl CreateFromCMO(_In_ ID3D11Device* d3dDevice, _In_reads_bytes_(dataSize) const uint8_t* meshData, size_t dataSize,
-                                                            _In_ IEffectFactory& fxFactory, bool ccw = true, bool pmalpha = false);
+                                                            _In_ IEffectFactory& fxFactory, bool ccw = true, bool pmalpha = false, size_t lodCount = 0);
         static std::unique_ptr<Model> __cdecl CreateFromCMO(_In_ ID3D11Device* d3dDevice, _In_z_ const wchar_t* szFileName,
-                                                            _In_ IEffectFactory& fxFactory, bool ccw = true, bool pmalpha = false);
+                                                            _In_ IEffectFactory& fxFactory, bool ccw = true, bool pmalpha = false, size_t lodCount = 0);
 
        // Loads a model from a DirectX SDK .SDKMESH file
         static std::unique_ptr<Model> __cdecl CreateFromSDKMESH(_In_ ID3D11Device* d3dDevice, _In_reads_bytes_(dataSize) const uint8_t* meshData, _In_ size_t dataSize,
-                                                                _In_ IEffectFactory& fxFactory, bool ccw = false, bool pmalpha = false);
+                                                                _In_ IEffectFactory& fxFactory, bool ccw = false, bool pmalpha = false, size_t lodCount = 0);
         static std::unique_ptr<Model> __cdecl CreateFromSDKMESH(_In_ ID3D11Device* d3dDevice, _In_z_ const wchar_t* szFileName,
-                                                                _In_ IEffectFactory& fxFactory, bool ccw = false, bool pmalpha = false);
+                                                                _In_ IEffectFactory& fxFactory, bool ccw = false, bool pmalpha = false, size_t lodCount = 0);
 
        // Loads a model from a .VBO file
         static std::unique_ptr<Model> __cdecl CreateFromVBO(_In_ ID3D11Device* d3dDevice, _In_reads_bytes_(dataSize) const uint8_t* meshData, _In_ size_t dataSize,
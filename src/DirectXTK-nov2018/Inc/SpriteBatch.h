@@ -42,6 +42,38 @@ namespace DirectX
     };
 
 
+    // A retained group of sprites, recorded once with SpriteBatch::BeginLayer/EndLayer
+    // and then drawn every frame without re-sorting or regenerating its vertices.
+    class SpriteLayer
+    {
+    public:
+        SpriteLayer();
+        SpriteLayer(SpriteLayer&& moveFrom) noexcept;
+        SpriteLayer& operator= (SpriteLayer&& moveFrom) noexcept;
+
+        SpriteLayer(SpriteLayer const&) = delete;
+        SpriteLayer& operator= (SpriteLayer const&) = delete;
+
+        virtual ~SpriteLayer();
+
+        // Removes all sprites and releases the cached vertex data.
+        void __cdecl Clear();
+
+        // A layer is dirty between EndLayer and the first DrawLayer, which uploads its vertices.
+        bool __cdecl IsDirty() const;
+
+        size_t __cdecl GetSpriteCount() const;
+
+    private:
+        // Private implementation.
+        class Impl;
+
+        std::unique_ptr<Impl> pImpl;
+
+        friend class SpriteBatch;
+    };
+
+
     class SpriteBatch
     {
     public:
@@ -59,6 +91,13 @@ namespace DirectX
                                _In_opt_ std::function<void __cdecl()> setCustomShaders = nullptr, FXMMATRIX transformMatrix = MatrixIdentity);
         void __cdecl End();
 
+        // Record the Draw calls between BeginLayer and EndLayer into a retained layer, instead of drawing them.
+        void __cdecl BeginLayer(SpriteLayer& layer, SpriteSortMode sortMode = SpriteSortMode_Deferred);
+        void __cdecl EndLayer();
+
+        // Draw a recorded layer inside a Begin/End pair. Sprites queued earlier in the batch are drawn first.
+        void __cdecl DrawLayer(SpriteLayer& layer);
+
         // Draw overloads specifying position, origin and scale as XMFLOAT2.
         void XM_CALLCONV Draw(_In_ ID3D11ShaderResourceView* texture, XMFLOAT2 const& position, FXMVECTOR color = Colors::White);
         void XM_CALLCONV Draw(_In_ ID3D11ShaderResourceView* texture, XMFLOAT2 const& position, _In_opt_ RECT const* sourceRectangle, FXMVECTOR color = Colors::White, float rotation = 0, XMFLOAT2 const& origin = Float2Zero, float scale = 1, SpriteEffects effects = SpriteEffects_None, float layerDepth = 0);
@@ -80,6 +119,10 @@ namespace DirectX
         // Set viewport for sprite transformation
         void __cdecl SetViewport(const D3D11_VIEWPORT& viewPort);
 
+        // Spread the vertex generation of large batches across worker threads
+        void __cdecl SetParallelVertexGeneration(bool enable);
+        bool __cdecl GetParallelVertexGeneration() const;
+
     private:
         // Private implementation.
         class Impl;
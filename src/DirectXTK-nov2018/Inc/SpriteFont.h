@@ -11,18 +11,28 @@
 
 #include "SpriteBatch.h"
 
+#include <vector>
+
 
 namespace DirectX
 {
+    class IGlyphSource;
+
     class SpriteFont
     {
     public:
         struct Glyph;
+        struct KerningPair;
+        class TextLayout;
 
         SpriteFont(_In_ ID3D11Device* device, _In_z_ wchar_t const* fileName, bool forceSRGB = false);
         SpriteFont(_In_ ID3D11Device* device, _In_reads_bytes_(dataSize) uint8_t const* dataBlob, _In_ size_t dataSize, bool forceSRGB = false);
         SpriteFont(_In_ ID3D11ShaderResourceView* texture, _In_reads_(glyphCount) Glyph const* glyphs, _In_ size_t glyphCount, _In_ float lineSpacing);
 
+        // Dynamic glyph cache, for large character sets: glyphs are rasterized by the source on first use
+        // into a fixed size atlas, evicting the least recently used ones when it is full.
+        SpriteFont(_In_ ID3D11Device* device, std::unique_ptr<IGlyphSource> glyphSource, uint32_t atlasWidth = 1024, uint32_t atlasHeight = 1024, bool forceSRGB = false);
+
         SpriteFont(SpriteFont&& moveFrom) noexcept;
         SpriteFont& operator= (SpriteFont&& moveFrom) noexcept;
 
@@ -41,6 +51,41 @@ namespace DirectX
         RECT __cdecl MeasureDrawBounds(_In_z_ wchar_t const* text, XMFLOAT2 const& position) const;
         RECT XM_CALLCONV MeasureDrawBounds(_In_z_ wchar_t const* text, FXMVECTOR position) const;
 
+        // UTF-8 text
+        void XM_CALLCONV DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ char const* text, XMFLOAT2 const& position, FXMVECTOR color = Colors::White, float rotation = 0, XMFLOAT2 const& origin = Float2Zero, float scale = 1, SpriteEffects effects = SpriteEffects_None, float layerDepth = 0) const;
+        void XM_CALLCONV DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ char const* text, XMFLOAT2 const& position, FXMVECTOR color, float rotation, XMFLOAT2 const& origin, XMFLOAT2 const& scale, SpriteEffects effects = SpriteEffects_None, float layerDepth = 0) const;
+        void XM_CALLCONV DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ char const* text, FXMVECTOR position, FXMVECTOR color = Colors::White, float rotation = 0, FXMVECTOR origin = g_XMZero, float scale = 1, SpriteEffects effects = SpriteEffects_None, float layerDepth = 0) const;
+        void XM_CALLCONV DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ char const* text, FXMVECTOR position, FXMVECTOR color, float rotation, FXMVECTOR origin, GXMVECTOR scale, SpriteEffects effects = SpriteEffects_None, float layerDepth = 0) const;
+
+        XMVECTOR XM_CALLCONV MeasureString(_In_z_ char const* text) const;
+
+        RECT __cdecl MeasureDrawBounds(_In_z_ char const* text, XMFLOAT2 const& position) const;
+        RECT XM_CALLCONV MeasureDrawBounds(_In_z_ char const* text, FXMVECTOR position) const;
+
+        // UTF-32 text
+        void XM_CALLCONV DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ char32_t const* text, XMFLOAT2 const& position, FXMVECTOR color = Colors::White, float rotation = 0, XMFLOAT2 const& origin = Float2Zero, float scale = 1, SpriteEffects effects = SpriteEffects_None, float layerDepth = 0) const;
+        void XM_CALLCONV DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ char32_t const* text, XMFLOAT2 const& position, FXMVECTOR color, float rotation, XMFLOAT2 const& origin, XMFLOAT2 const& scale, SpriteEffects effects = SpriteEffects_None, float layerDepth = 0) const;
+        void XM_CALLCONV DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ char32_t const* text, FXMVECTOR position, FXMVECTOR color = Colors::White, float rotation = 0, FXMVECTOR origin = g_XMZero, float scale = 1, SpriteEffects effects = SpriteEffects_None, float layerDepth = 0) const;
+        void XM_CALLCONV DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ char32_t const* text, FXMVECTOR position, FXMVECTOR color, float rotation, FXMVECTOR origin, GXMVECTOR scale, SpriteEffects effects = SpriteEffects_None, float layerDepth = 0) const;
+
+        XMVECTOR XM_CALLCONV MeasureString(_In_z_ char32_t const* text) const;
+
+        RECT __cdecl MeasureDrawBounds(_In_z_ char32_t const* text, XMFLOAT2 const& position) const;
+        RECT XM_CALLCONV MeasureDrawBounds(_In_z_ char32_t const* text, FXMVECTOR position) const;
+
+        // Precomputed layouts, for text that is drawn repeatedly
+        TextLayout __cdecl CreateLayout(_In_z_ wchar_t const* text) const;
+        TextLayout __cdecl CreateLayout(_In_z_ char const* text) const;
+        TextLayout __cdecl CreateLayout(_In_z_ char32_t const* text) const;
+
+        void XM_CALLCONV DrawLayout(_In_ SpriteBatch* spriteBatch, TextLayout const& layout, XMFLOAT2 const& position, FXMVECTOR color = Colors::White, float rotation = 0, XMFLOAT2 const& origin = Float2Zero, float scale = 1, SpriteEffects effects = SpriteEffects_None, float layerDepth = 0) const;
+        void XM_CALLCONV DrawLayout(_In_ SpriteBatch* spriteBatch, TextLayout const& layout, FXMVECTOR position, FXMVECTOR color, float rotation, FXMVECTOR origin, GXMVECTOR scale, SpriteEffects effects = SpriteEffects_None, float layerDepth = 0) const;
+
+        // Least recently used cache of layouts, keyed by string contents, which DrawString, MeasureString and
+        // MeasureDrawBounds consult for wchar_t text when enabled. The cache is disabled by default (size 0).
+        void __cdecl SetLayoutCacheSize(size_t count);
+        size_t __cdecl GetLayoutCacheSize() const;
+
         // Spacing properties
         float __cdecl GetLineSpacing() const;
         void __cdecl SetLineSpacing(float spacing);
@@ -51,6 +96,14 @@ namespace DirectX
 
         bool __cdecl ContainsCharacter(wchar_t character) const;
 
+        // Kerning adjustments, added to the horizontal position of the second character of each pair
+        void __cdecl SetKerningPairs(_In_reads_(count) KerningPair const* pairs, size_t count);
+        float __cdecl GetKerning(uint32_t first, uint32_t second) const;
+
+        // Glyphs drawn since the previous call are never evicted from a dynamic glyph cache, so call this once
+        // per frame after ending the SpriteBatch that draws the font. It has no effect on other fonts.
+        void __cdecl AdvanceGlyphCacheFrame();
+
         // Custom layout/rendering
         Glyph const* __cdecl FindGlyph(wchar_t character) const;
         void __cdecl GetSpriteSheet(ID3D11ShaderResourceView** texture) const;
@@ -65,6 +118,42 @@ namespace DirectX
             float XAdvance;
         };
 
+        // Describes the kerning between two characters.
+        struct KerningPair
+        {
+            uint32_t First;
+            uint32_t Second;
+            float Amount;
+        };
+
+        // Glyph positions of a string, laid out once by CreateLayout. A layout
+        // can only be drawn with the font that created it.
+        class TextLayout
+        {
+        public:
+            TextLayout() noexcept : mSize(0, 0) {}
+
+            size_t __cdecl GetGlyphCount() const { return mGlyphs.size(); }
+
+            // Same results as MeasureString and MeasureDrawBounds for the original text.
+            XMVECTOR XM_CALLCONV GetSize() const { return XMLoadFloat2(&mSize); }
+            RECT __cdecl GetDrawBounds(XMFLOAT2 const& position) const;
+
+        private:
+            struct PlacedGlyph
+            {
+                Glyph const* glyph;
+                float x;
+                float y;
+                float advance;
+            };
+
+            std::vector<PlacedGlyph> mGlyphs;
+            XMFLOAT2 mSize;
+
+            friend class SpriteFont;
+        };
+
 
     private:
         // Private implementation.
@@ -74,4 +163,30 @@ namespace DirectX
 
         static const XMFLOAT2 Float2Zero;
     };
+
+
+    // Abstract interface providing the glyphs of a SpriteFont with a dynamic glyph cache.
+    class IGlyphSource
+    {
+    public:
+        virtual ~IGlyphSource() = default;
+
+        IGlyphSource(const IGlyphSource&) = delete;
+        IGlyphSource& operator=(const IGlyphSource&) = delete;
+
+        IGlyphSource(IGlyphSource&&) = delete;
+        IGlyphSource& operator=(IGlyphSource&&) = delete;
+
+        // Fills in the metrics of a character, with the bitmap size as a Subrect at the origin.
+        // Returns false if the font has no glyph for the character.
+        virtual bool __cdecl GetGlyph(uint32_t character, _Out_ SpriteFont::Glyph* glyph) = 0;
+
+        // Writes the bitmap of a glyph as premultiplied 32-bit RGBA, the size of its Subrect.
+        virtual void __cdecl RasterizeGlyph(uint32_t character, _Out_writes_bytes_(rowPitch * height) uint8_t* pixels, size_t rowPitch, uint32_t height) = 0;
+
+        virtual float __cdecl GetLineSpacing() = 0;
+
+    protected:
+        IGlyphSource() = default;
+    };
 }
@@ -28,6 +28,8 @@ namespace MakeSpriteFont
 
         public float LineSpacing { get; private set; }
 
+        public IEnumerable<KerningPair> KerningPairs { get; private set; }
+
 
         public void Import(CommandLineOptions options)
         {
@@ -56,6 +58,7 @@ namespace MakeSpriteFont
 
             Glyphs = glyphList;
             LineSpacing = 0;
+            KerningPairs = new KerningPair[0];
 
             foreach (Rectangle rectangle in FindGlyphs(bitmap))
             {
@@ -91,5 +91,9 @@ namespace MakeSpriteFont
 
         // For large fonts, the default tightest pack is too slow
         public bool FastPack = false;
+
+
+        // Store the kerning pairs of TrueType fonts in the output file.
+        public bool Kerning = false;
     }
 }
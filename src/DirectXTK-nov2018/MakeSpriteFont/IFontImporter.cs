@@ -17,5 +17,7 @@ namespace MakeSpriteFont
         IEnumerable<Glyph> Glyphs { get; }
 
         float LineSpacing { get; }
+
+        IEnumerable<KerningPair> KerningPairs { get; }
     }
 }
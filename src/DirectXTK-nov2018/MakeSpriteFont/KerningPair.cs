@@ -0,0 +1,30 @@
+// DirectXTK MakeSpriteFont tool
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+
+namespace MakeSpriteFont
+{
+    // Horizontal adjustment between two adjacent characters.
+    public class KerningPair
+    {
+        // Constructor.
+        public KerningPair(char first, char second, float amount)
+        {
+            this.First = first;
+            this.Second = second;
+            this.Amount = amount;
+        }
+
+
+        // Unicode codepoints of the left and right characters.
+        public char First;
+        public char Second;
+
+
+        // Offset added to the position of the second character, in pixels.
+        public float Amount;
+    }
+}
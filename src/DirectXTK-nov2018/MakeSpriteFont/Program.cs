@@ -47,11 +47,17 @@ namespace MakeSpriteFont
             Console.WriteLine("Importing {0}", options.SourceFont);
 
             float lineSpacing;
+            KerningPair[] kerningPairs;
 
-            Glyph[] glyphs = ImportFont(options, out lineSpacing);
+            Glyph[] glyphs = ImportFont(options, out lineSpacing, out kerningPairs);
 
             Console.WriteLine("Captured {0} glyphs", glyphs.Length);
 
+            if (options.Kerning)
+            {
+                Console.WriteLine("Captured {0} kerning pairs", kerningPairs.Length);
+            }
+
             // Optimize.
             Console.WriteLine("Cropping glyph borders");
 
@@ -135,11 +141,11 @@ namespace MakeSpriteFont
 
             Console.WriteLine("Writing {0} ({1} format)", options.OutputFile, options.TextureFormat);
 
-            SpriteFontWriter.WriteSpriteFont(options, glyphs, lineSpacing, bitmap);
+            SpriteFontWriter.WriteSpriteFont(options, glyphs, lineSpacing, bitmap, kerningPairs);
         }
 
 
-        static Glyph[] ImportFont(CommandLineOptions options, out float lineSpacing)
+        static Glyph[] ImportFont(CommandLineOptions options, out float lineSpacing, out KerningPair[] kerningPairs)
         {
             // Which importer knows how to read this source font?
             IFontImporter importer;
@@ -162,6 +168,11 @@ namespace MakeSpriteFont
 
             lineSpacing = importer.LineSpacing;
 
+            kerningPairs = importer.KerningPairs
+                                   .OrderBy(pair => pair.First)
+                                   .ThenBy(pair => pair.Second)
+                                   .ToArray();
+
             var glyphs = importer.Glyphs
                                  .OrderBy(glyph => glyph.Character)
                                  .ToArray();
@@ -16,6 +16,7 @@ namespace MakeSpriteFont
     public static class SpriteFontWriter
     {
         const string spriteFontMagic = "DXTKfont";
+        const string spriteFontKerningMagic = "DXTKkern";
 
         const int DXGI_FORMAT_R8G8B8A8_UNORM = 28;
         const int DXGI_FORMAT_B4G4R4A4_UNORM = 115;
@@ -23,31 +24,51 @@ namespace MakeSpriteFont
 
 
         [System.Diagnostics.CodeAnalysis.SuppressMessage("Microsoft.Usage", "CA2202:Do not dispose objects multiple times")]
-        public static void WriteSpriteFont(CommandLineOptions options, Glyph[] glyphs, float lineSpacing, Bitmap bitmap)
+        public static void WriteSpriteFont(CommandLineOptions options, Glyph[] glyphs, float lineSpacing, Bitmap bitmap, KerningPair[] kerningPairs)
         {
             using (FileStream file = File.OpenWrite(options.OutputFile))
             using (BinaryWriter writer = new BinaryWriter(file))
             {
-                WriteMagic(writer);
+                WriteMagic(writer, spriteFontMagic);
                 WriteGlyphs(writer, glyphs);
 
                 writer.Write(lineSpacing);
                 writer.Write(options.DefaultCharacter);
                 
                 WriteBitmap(writer, options, bitmap);
+
+                // Kerning is an optional trailing block, so files without it can still be read by older versions of SpriteFont.
+                if (kerningPairs.Length > 0)
+                {
+                    WriteMagic(writer, spriteFontKerningMagic);
+                    WriteKerningPairs(writer, kerningPairs);
+                }
             }
         }
 
 
-        static void WriteMagic(BinaryWriter writer)
+        static void WriteMagic(BinaryWriter writer, string magicString)
         {
-            foreach (char magic in spriteFontMagic)
+            foreach (char magic in magicString)
             {
                 writer.Write((byte)magic);
             }
         }
 
 
+        static void WriteKerningPairs(BinaryWriter writer, KerningPair[] kerningPairs)
+        {
+            writer.Write(kerningPairs.Length);
+
+            foreach (KerningPair pair in kerningPairs)
+            {
+                writer.Write((int)pair.First);
+                writer.Write((int)pair.Second);
+                writer.Write(pair.Amount);
+            }
+        }
+
+
         static void WriteGlyphs(BinaryWriter writer, Glyph[] glyphs)
         {
             writer.Write(glyphs.Length);
@@ -8,6 +8,7 @@
 using System;
 using System.Collections.Generic;
 using System.Globalization;
+using System.Linq;
 using System.Drawing;
 using System.Drawing.Drawing2D;
 using System.Drawing.Imaging;
@@ -24,6 +25,8 @@ namespace MakeSpriteFont
 
         public float LineSpacing { get; private set; }
 
+        public IEnumerable<KerningPair> KerningPairs { get; private set; }
+
 
         // Size of the temp surface used for GDI+ rasterization.
         const int MaxGlyphSize = 1024;
@@ -81,6 +84,19 @@ namespace MakeSpriteFont
 
                 // Store the font height.
                 LineSpacing = font.GetHeight();
+
+                // Keep the kerning pairs between characters that are part of the font.
+                if (options.Kerning)
+                {
+                    var characterSet = new HashSet<char>(characters);
+
+                    KerningPairs = GetKerningPairs(font, graphics).Where(pair => characterSet.Contains(pair.First) && characterSet.Contains(pair.Second))
+                                                                  .ToList();
+                }
+                else
+                {
+                    KerningPairs = new KerningPair[0];
+                }
             }
         }
 
@@ -223,7 +239,55 @@ namespace MakeSpriteFont
         }
 
 
-        // Interop to the native GDI GetCharABCWidthsFloat method.
+        // Queries the kerning pairs of the font.
+        static IEnumerable<KerningPair> GetKerningPairs(Font font, Graphics graphics)
+        {
+            // Look up the native device context and font handles.
+            IntPtr hdc = graphics.GetHdc();
+
+            try
+            {
+                IntPtr hFont = font.ToHfont();
+
+                try
+                {
+                    // Select our font into the DC.
+                    IntPtr oldFont = NativeMethods.SelectObject(hdc, hFont);
+
+                    try
+                    {
+                        uint pairCount = NativeMethods.GetKerningPairs(hdc, 0, null);
+
+                        var pairs = new NativeMethods.KerningPair[pairCount];
+
+                        if (pairCount > 0)
+                        {
+                            pairCount = NativeMethods.GetKerningPairs(hdc, pairCount, pairs);
+                        }
+
+                        return pairs.Take((int)pairCount)
+                                    .Where(pair => pair.iKernAmount != 0)
+                                    .Select(pair => new KerningPair(pair.wFirst, pair.wSecond, pair.iKernAmount))
+                                    .ToList();
+                    }
+                    finally
+                    {
+                        NativeMethods.SelectObject(hdc, oldFont);
+                    }
+                }
+                finally
+                {
+                    NativeMethods.DeleteObject(hFont);
+                }
+            }
+            finally
+            {
+                graphics.ReleaseHdc(hdc);
+            }
+        }
+
+
+        // Interop to the native GDI GetCharABCWidthsFloat and GetKerningPairs methods.
         static class NativeMethods
         {
             [DllImport("gdi32.dll")]
@@ -235,6 +299,9 @@ namespace MakeSpriteFont
             [DllImport("gdi32.dll", CharSet = CharSet.Unicode)]
             public static extern bool GetCharABCWidthsFloat(IntPtr hdc, uint iFirstChar, uint iLastChar, [Out] ABCFloat[] lpABCF);
 
+            [DllImport("gdi32.dll", CharSet = CharSet.Unicode, EntryPoint = "GetKerningPairsW")]
+            public static extern uint GetKerningPairs(IntPtr hdc, uint nPairs, [Out] KerningPair[] lpkrnpair);
+
 
             [StructLayout(LayoutKind.Sequential)]
             public struct ABCFloat
@@ -243,6 +310,15 @@ namespace MakeSpriteFont
                 public float B;
                 public float C;
             }
+
+
+            [StructLayout(LayoutKind.Sequential)]
+            public struct KerningPair
+            {
+                public char wFirst;
+                public char wSecond;
+                public int iKernAmount;
+            }
         }
     }
 }
@@ -58,6 +58,13 @@ namespace DirectX
         }
 
 
+        // Number of bytes left to read.
+        size_t BytesRemaining() const
+        {
+            return static_cast<size_t>(mEnd - mPos);
+        }
+
+
         // Lower level helper reads directly from the filesystem into memory.
         static HRESULT ReadEntireFile(_In_z_ wchar_t const* fileName, _Inout_ std::unique_ptr<uint8_t[]>& data, _Out_ size_t* dataSize);
 
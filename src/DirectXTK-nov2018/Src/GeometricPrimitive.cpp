@@ -14,6 +14,7 @@
 #include "DirectXHelpers.h"
 #include "SharedResourcePool.h"
 #include "Geometry.h"
+#include "MeshOptimizer.h"
 
 using namespace DirectX;
 using Microsoft::WRL::ComPtr;
@@ -81,9 +82,10 @@ namespace
 class GeometricPrimitive::Impl
 {
 public:
-    Impl() noexcept : mIndexCount(0) {}
+    Impl() noexcept : mIndexCount(0), mIndexFormat(DXGI_FORMAT_R16_UINT) {}
 
-    void Initialize(_In_ ID3D11DeviceContext* deviceContext, const VertexCollection& vertices, const IndexCollection& indices);
+    template<typename TIndexCollection>
+    void Initialize(_In_ ID3D11DeviceContext* deviceContext, const VertexCollection& vertices, const TIndexCollection& indices);
 
     void XM_CALLCONV Draw(FXMMATRIX world, CXMMATRIX view, CXMMATRIX projection, FXMVECTOR color, _In_opt_ ID3D11ShaderResourceView* texture, bool wireframe, std::function<void()>& setCustomState) const;
 
@@ -96,6 +98,7 @@ private:
     ComPtr<ID3D11Buffer> mIndexBuffer;
 
     UINT mIndexCount;
+    DXGI_FORMAT mIndexFormat;
 
     // Only one of these helpers is allocated per D3D device context, even if there are multiple GeometricPrimitive instances.
     class SharedResources
@@ -186,12 +189,20 @@ void GeometricPrimitive::Impl::SharedResources::PrepareForRendering(bool alpha,
 
 
 // Initializes a geometric primitive instance that will draw the specified vertex and index data.
+template<typename TIndexCollection>
 _Use_decl_annotations_
-void GeometricPrimitive::Impl::Initialize(ID3D11DeviceContext* deviceContext, const VertexCollection& vertices, const IndexCollection& indices)
+void GeometricPrimitive::Impl::Initialize(ID3D11DeviceContext* deviceContext, const VertexCollection& vertices, const TIndexCollection& indices)
 {
-    if (vertices.size() >= USHRT_MAX)
+    static_assert(sizeof(typename TIndexCollection::value_type) == 2 || sizeof(typename TIndexCollection::value_type) == 4, "Expected 16-bit or 32-bit indices");
+
+    const bool is16Bit = (sizeof(typename TIndexCollection::value_type) == 2);
+
+    if (is16Bit && vertices.size() >= USHRT_MAX)
         throw std::exception("Too many vertices for 16-bit index buffer");
 
+    if (vertices.size() >= UINT32_MAX)
+        throw std::exception("Too many vertices for 32-bit index buffer");
+
     if (indices.size() > UINT32_MAX)
         throw std::exception("Too many indices");
 
@@ -204,6 +215,7 @@ void GeometricPrimitive::Impl::Initialize(ID3D11DeviceContext* deviceContext, co
     CreateBuffer(device.Get(), indices, D3D11_BIND_INDEX_BUFFER, &mIndexBuffer);
 
     mIndexCount = static_cast<UINT>(indices.size());
+    mIndexFormat = is16Bit ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
 }
 
 
@@ -278,7 +290,7 @@ void GeometricPrimitive::Impl::Draw(
 
     deviceContext->IASetVertexBuffers(0, 1, &vertexBuffer, &vertexStride, &vertexOffset);
 
-    deviceContext->IASetIndexBuffer(mIndexBuffer.Get(), DXGI_FORMAT_R16_UINT, 0);
+    deviceContext->IASetIndexBuffer(mIndexBuffer.Get(), mIndexFormat, 0);
 
     // Hook lets the caller replace our shaders or state settings with whatever else they see fit.
     if (setCustomState)
@@ -384,6 +396,7 @@ std::unique_ptr<GeometricPrimitive> GeometricPrimitive::CreateCube(
     return primitive;
 }
 
+_Use_decl_annotations_
 void GeometricPrimitive::CreateCube(
     std::vector<VertexType>& vertices,
     std::vector<uint16_t>& indices,
@@ -393,6 +406,16 @@ void GeometricPrimitive::CreateCube(
     ComputeBox(vertices, indices, XMFLOAT3(size, size, size), rhcoords, false);
 }
 
+_Use_decl_annotations_
+void GeometricPrimitive::CreateCube(
+    std::vector<VertexType>& vertices,
+    std::vector<uint32_t>& indices,
+    float size,
+    bool rhcoords)
+{
+    ComputeBox(vertices, indices, XMFLOAT3(size, size, size), rhcoords, false);
+}
+
 
 // Creates a box primitive.
 _Use_decl_annotations_
@@ -414,6 +437,7 @@ std::unique_ptr<GeometricPrimitive> GeometricPrimitive::CreateBox(
     return primitive;
 }
 
+_Use_decl_annotations_
 void GeometricPrimitive::CreateBox(
     std::vector<VertexType>& vertices,
     std::vector<uint16_t>& indices,
@@ -424,6 +448,17 @@ void GeometricPrimitive::CreateBox(
     ComputeBox(vertices, indices, size, rhcoords, invertn);
 }
 
+_Use_decl_annotations_
+void GeometricPrimitive::CreateBox(
+    std::vector<VertexType>& vertices,
+    std::vector<uint32_t>& indices,
+    const XMFLOAT3& size,
+    bool rhcoords,
+    bool invertn)
+{
+    ComputeBox(vertices, indices, size, rhcoords, invertn);
+}
+
 
 //--------------------------------------------------------------------------------------
 // Sphere
@@ -440,6 +475,7 @@ std::unique_ptr<GeometricPrimitive> GeometricPrimitive::CreateSphere(
     VertexCollection vertices;
     IndexCollection indices;
     ComputeSphere(vertices, indices, diameter, tessellation, rhcoords, invertn);
+    OptimizeMesh(vertices, indices);
 
     // Create the primitive object.
     std::unique_ptr<GeometricPrimitive> primitive(new GeometricPrimitive());
@@ -449,6 +485,7 @@ std::unique_ptr<GeometricPrimitive> GeometricPrimitive::CreateSphere(
     return primitive;
 }
 
+_Use_decl_annotations_
 void GeometricPrimitive::CreateSphere(
     std::vector<VertexType>& vertices,
     std::vector<uint16_t>& indices,
@@ -460,6 +497,18 @@ void GeometricPrimitive::CreateSphere(
     ComputeSphere(vertices, indices, diameter, tessellation, rhcoords, invertn);
 }
 
+_Use_decl_annotations_
+void GeometricPrimitive::CreateSphere(
+    std::vector<VertexType>& vertices,
+    std::vector<uint32_t>& indices,
+    float diameter,
+    size_t tessellation,
+    bool rhcoords,
+    bool invertn)
+{
+    ComputeSphere(vertices, indices, diameter, tessellation, rhcoords, invertn);
+}
+
 
 //--------------------------------------------------------------------------------------
 // Geodesic sphere
@@ -475,6 +524,7 @@ std::unique_ptr<GeometricPrimitive> GeometricPrimitive::CreateGeoSphere(
     VertexCollection vertices;
     IndexCollection indices;
     ComputeGeoSphere(vertices, indices, diameter, tessellation, rhcoords);
+    OptimizeMesh(vertices, indices);
 
     // Create the primitive object.
     std::unique_ptr<GeometricPrimitive> primitive(new GeometricPrimitive());
@@ -484,6 +534,7 @@ std::unique_ptr<GeometricPrimitive> GeometricPrimitive::CreateGeoSphere(
     return primitive;
 }
 
+_Use_decl_annotations_
 void GeometricPrimitive::CreateGeoSphere(
     std::vector<VertexType>& vertices,
     std::vector<uint16_t>& indices,
@@ -493,6 +544,16 @@ void GeometricPrimitive::CreateGeoSphere(
     ComputeGeoSphere(vertices, indices, diameter, tessellation, rhcoords);
 }
 
+_Use_decl_annotations_
+void GeometricPrimitive::CreateGeoSphere(
+    std::vector<VertexType>& vertices,
+    std::vector<uint32_t>& indices,
+    float diameter,
+    size_t tessellation, bool rhcoords)
+{
+    ComputeGeoSphere(vertices, indices, diameter, tessellation, rhcoords);
+}
+
 
 //--------------------------------------------------------------------------------------
 // Cylinder / Cone
@@ -510,6 +571,7 @@ std::unique_ptr<GeometricPrimitive> GeometricPrimitive::CreateCylinder(
     VertexCollection vertices;
     IndexCollection indices;
     ComputeCylinder(vertices, indices, height, diameter, tessellation, rhcoords);
+    OptimizeMesh(vertices, indices);
 
     // Create the primitive object.
     std::unique_ptr<GeometricPrimitive> primitive(new GeometricPrimitive());
@@ -519,6 +581,7 @@ std::unique_ptr<GeometricPrimitive> GeometricPrimitive::CreateCylinder(
     return primitive;
 }
 
+_Use_decl_annotations_
 void GeometricPrimitive::CreateCylinder(
     std::vector<VertexType>& vertices,
     std::vector<uint16_t>& indices,
@@ -530,6 +593,18 @@ void GeometricPrimitive::CreateCylinder(
     ComputeCylinder(vertices, indices, height, diameter, tessellation, rhcoords);
 }
 
+_Use_decl_annotations_
+void GeometricPrimitive::CreateCylinder(
+    std::vector<VertexType>& vertices,
+    std::vector<uint32_t>& indices,
+    float height,
+    float diameter,
+    size_t tessellation,
+    bool rhcoords)
+{
+    ComputeCylinder(vertices, indices, height, diameter, tessellation, rhcoords);
+}
+
 
 // Creates a cone primitive.
 _Use_decl_annotations_
@@ -543,6 +618,7 @@ std::unique_ptr<GeometricPrimitive> GeometricPrimitive::CreateCone(
     VertexCollection vertices;
     IndexCollection indices;
     ComputeCone(vertices, indices, diameter, height, tessellation, rhcoords);
+    OptimizeMesh(vertices, indices);
 
     // Create the primitive object.
     std::unique_ptr<GeometricPrimitive> primitive(new GeometricPrimitive());
@@ -552,6 +628,7 @@ std::unique_ptr<GeometricPrimitive> GeometricPrimitive::CreateCone(
     return primitive;
 }
 
+_Use_decl_annotations_
 void GeometricPrimitive::CreateCone(
     std::vector<VertexType>& vertices,
     std::vector<uint16_t>& indices,
@@ -563,6 +640,18 @@ void GeometricPrimitive::CreateCone(
     ComputeCone(vertices, indices, diameter, height, tessellation, rhcoords);
 }
 
+_Use_decl_annotations_
+void GeometricPrimitive::CreateCone(
+    std::vector<VertexType>& vertices,
+    std::vector<uint32_t>& indices,
+    float diameter,
+    float height,
+    size_t tessellation,
+    bool rhcoords)
+{
+    ComputeCone(vertices, indices, diameter, height, tessellation, rhcoords);
+}
+
 
 //--------------------------------------------------------------------------------------
 // Torus
@@ -579,6 +668,7 @@ std::unique_ptr<GeometricPrimitive> GeometricPrimitive::CreateTorus(
     VertexCollection vertices;
     IndexCollection indices;
     ComputeTorus(vertices, indices, diameter, thickness, tessellation, rhcoords);
+    OptimizeMesh(vertices, indices);
 
     // Create the primitive object.
     std::unique_ptr<GeometricPrimitive> primitive(new GeometricPrimitive());
@@ -588,6 +678,7 @@ std::unique_ptr<GeometricPrimitive> GeometricPrimitive::CreateTorus(
     return primitive;
 }
 
+_Use_decl_annotations_
 void GeometricPrimitive::CreateTorus(
     std::vector<VertexType>& vertices,
     std::vector<uint16_t>& indices,
@@ -599,6 +690,18 @@ void GeometricPrimitive::CreateTorus(
     ComputeTorus(vertices, indices, diameter, thickness, tessellation, rhcoords);
 }
 
+_Use_decl_annotations_
+void GeometricPrimitive::CreateTorus(
+    std::vector<VertexType>& vertices,
+    std::vector<uint32_t>& indices,
+    float diameter,
+    float thickness,
+    size_t tessellation,
+    bool rhcoords)
+{
+    ComputeTorus(vertices, indices, diameter, thickness, tessellation, rhcoords);
+}
+
 
 //--------------------------------------------------------------------------------------
 // Tetrahedron
@@ -622,6 +725,7 @@ std::unique_ptr<GeometricPrimitive> GeometricPrimitive::CreateTetrahedron(
     return primitive;
 }
 
+_Use_decl_annotations_
 void GeometricPrimitive::CreateTetrahedron(
     std::vector<VertexType>& vertices,
     std::vector<uint16_t>& indices,
@@ -631,6 +735,16 @@ void GeometricPrimitive::CreateTetrahedron(
     ComputeTetrahedron(vertices, indices, size, rhcoords);
 }
 
+_Use_decl_annotations_
+void GeometricPrimitive::CreateTetrahedron(
+    std::vector<VertexType>& vertices,
+    std::vector<uint32_t>& indices,
+    float size,
+    bool rhcoords)
+{
+    ComputeTetrahedron(vertices, indices, size, rhcoords);
+}
+
 
 //--------------------------------------------------------------------------------------
 // Octahedron
@@ -654,6 +768,7 @@ std::unique_ptr<GeometricPrimitive> GeometricPrimitive::CreateOctahedron(
     return primitive;
 }
 
+_Use_decl_annotations_
 void GeometricPrimitive::CreateOctahedron(
     std::vector<VertexType>& vertices,
     std::vector<uint16_t>& indices,
@@ -663,6 +778,16 @@ void GeometricPrimitive::CreateOctahedron(
     ComputeOctahedron(vertices, indices, size, rhcoords);
 }
 
+_Use_decl_annotations_
+void GeometricPrimitive::CreateOctahedron(
+    std::vector<VertexType>& vertices,
+    std::vector<uint32_t>& indices,
+    float size,
+    bool rhcoords)
+{
+    ComputeOctahedron(vertices, indices, size, rhcoords);
+}
+
 
 //--------------------------------------------------------------------------------------
 // Dodecahedron
@@ -686,6 +811,7 @@ std::unique_ptr<GeometricPrimitive> GeometricPrimitive::CreateDodecahedron(
     return primitive;
 }
 
+_Use_decl_annotations_
 void GeometricPrimitive::CreateDodecahedron(
     std::vector<VertexType>& vertices,
     std::vector<uint16_t>& indices,
@@ -695,6 +821,16 @@ void GeometricPrimitive::CreateDodecahedron(
     ComputeDodecahedron(vertices, indices, size, rhcoords);
 }
 
+_Use_decl_annotations_
+void GeometricPrimitive::CreateDodecahedron(
+    std::vector<VertexType>& vertices,
+    std::vector<uint32_t>& indices,
+    float size,
+    bool rhcoords)
+{
+    ComputeDodecahedron(vertices, indices, size, rhcoords);
+}
+
 
 //--------------------------------------------------------------------------------------
 // Icosahedron
@@ -718,6 +854,7 @@ std::unique_ptr<GeometricPrimitive> GeometricPrimitive::CreateIcosahedron(
     return primitive;
 }
 
+_Use_decl_annotations_
 void GeometricPrimitive::CreateIcosahedron(
     std::vector<VertexType>& vertices,
     std::vector<uint16_t>& indices,
@@ -727,6 +864,16 @@ void GeometricPrimitive::CreateIcosahedron(
     ComputeIcosahedron(vertices, indices, size, rhcoords);
 }
 
+_Use_decl_annotations_
+void GeometricPrimitive::CreateIcosahedron(
+    std::vector<VertexType>& vertices,
+    std::vector<uint32_t>& indices,
+    float size,
+    bool rhcoords)
+{
+    ComputeIcosahedron(vertices, indices, size, rhcoords);
+}
+
 
 //--------------------------------------------------------------------------------------
 // Teapot
@@ -742,6 +889,7 @@ std::unique_ptr<GeometricPrimitive> GeometricPrimitive::CreateTeapot(
     VertexCollection vertices;
     IndexCollection indices;
     ComputeTeapot(vertices, indices, size, tessellation, rhcoords);
+    OptimizeMesh(vertices, indices);
 
     // Create the primitive object.
     std::unique_ptr<GeometricPrimitive> primitive(new GeometricPrimitive());
@@ -751,6 +899,7 @@ std::unique_ptr<GeometricPrimitive> GeometricPrimitive::CreateTeapot(
     return primitive;
 }
 
+_Use_decl_annotations_
 void GeometricPrimitive::CreateTeapot(
     std::vector<VertexType>& vertices,
     std::vector<uint16_t>& indices,
@@ -761,6 +910,17 @@ void GeometricPrimitive::CreateTeapot(
     ComputeTeapot(vertices, indices, size, tessellation, rhcoords);
 }
 
+_Use_decl_annotations_
+void GeometricPrimitive::CreateTeapot(
+    std::vector<VertexType>& vertices,
+    std::vector<uint32_t>& indices,
+    float size,
+    size_t tessellation,
+    bool rhcoords)
+{
+    ComputeTeapot(vertices, indices, size, tessellation, rhcoords);
+}
+
 
 //--------------------------------------------------------------------------------------
 // Custom
@@ -798,3 +958,36 @@ std::unique_ptr<GeometricPrimitive> GeometricPrimitive::CreateCustom(
 
     return primitive;
 }
+
+_Use_decl_annotations_
+std::unique_ptr<GeometricPrimitive> GeometricPrimitive::CreateCustom(
+    ID3D11DeviceContext* deviceContext,
+    const std::vector<VertexType>& vertices,
+    const std::vector<uint32_t>& indices)
+{
+    // Extra validation
+    if (vertices.empty() || indices.empty())
+        throw std::exception("Requires both vertices and indices");
+
+    if (indices.size() % 3)
+        throw std::exception("Expected triangular faces");
+
+    size_t nVerts = vertices.size();
+    if (nVerts >= UINT32_MAX)
+        throw std::exception("Too many vertices for 32-bit index buffer");
+
+    for (auto it = indices.cbegin(); it != indices.cend(); ++it)
+    {
+        if (*it >= nVerts)
+        {
+            throw std::exception("Index not in vertices list");
+        }
+    }
+
+    // Create the primitive object.
+    std::unique_ptr<GeometricPrimitive> primitive(new GeometricPrimitive());
+
+    primitive->pImpl->Initialize(deviceContext, vertices, indices);
+
+    return primitive;
+}
@@ -12,6 +12,9 @@
 #include "Geometry.h"
 #include "Bezier.h"
 
+#include <limits>
+#include <ppl.h>
+
 using namespace DirectX;
 
 namespace
@@ -20,24 +23,52 @@ namespace
     const float SQRT3 = 1.73205080756887729352f;
     const float SQRT6 = 2.44948974278317809820f;
 
+    template<typename TIndex>
     inline void CheckIndexOverflow(size_t value)
     {
-        // Use >=, not > comparison, because some D3D level 9_x hardware does not support 0xFFFF index values.
-        if (value >= USHRT_MAX)
+        // Use >=, not > comparison, because some D3D level 9_x hardware does not support 0xFFFF index values,
+        // and 0xFFFFFFFF is the strip cut value of 32-bit indices.
+        if (value >= std::numeric_limits<TIndex>::max())
             throw std::exception("Index value out of range: cannot tesselate primitive so finely");
     }
 
 
+    // Below this many vertices, a primitive is generated faster on one thread than by scheduling parallel work.
+    const size_t MinParallelVertexCount = 16384;
+
+
+    // Calls body(i) for each i in [0, count). The slices must write disjoint parts of the output.
+    template<typename TBody>
+    void ForEachSlice(size_t count, bool parallel, TBody body)
+    {
+        if (parallel)
+        {
+            concurrency::parallel_for(size_t(0), count, body);
+        }
+        else
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                body(i);
+            }
+        }
+    }
+
+
     // Collection types used when generating the geometry.
-    inline void index_push_back(IndexCollection& indices, size_t value)
+    template<typename TIndexCollection>
+    inline void index_push_back(TIndexCollection& indices, size_t value)
     {
-        CheckIndexOverflow(value);
-        indices.push_back(static_cast<uint16_t>(value));
+        typedef typename TIndexCollection::value_type index_t;
+
+        CheckIndexOverflow<index_t>(value);
+        indices.push_back(static_cast<index_t>(value));
     }
 
 
     // Helper for flipping winding of geometric primitives for LH vs. RH coords
-    inline void ReverseWinding(IndexCollection& indices, VertexCollection& vertices)
+    template<typename TIndexCollection>
+    inline void ReverseWinding(TIndexCollection& indices, VertexCollection& vertices)
     {
         assert((indices.size() % 3) == 0);
         for (auto it = indices.begin(); it != indices.end(); it += 3)
@@ -68,7 +99,8 @@ namespace
 //--------------------------------------------------------------------------------------
 // Cube (aka a Hexahedron) or Box
 //--------------------------------------------------------------------------------------
-void DirectX::ComputeBox(VertexCollection& vertices, IndexCollection& indices, const XMFLOAT3& size, bool rhcoords, bool invertn)
+template<typename TIndexCollection>
+void DirectX::ComputeBox(VertexCollection& vertices, TIndexCollection& indices, const XMFLOAT3& size, bool rhcoords, bool invertn)
 {
     vertices.clear();
     indices.clear();
@@ -144,8 +176,11 @@ void DirectX::ComputeBox(VertexCollection& vertices, IndexCollection& indices, c
 //--------------------------------------------------------------------------------------
 // Sphere
 //--------------------------------------------------------------------------------------
-void DirectX::ComputeSphere(VertexCollection& vertices, IndexCollection& indices, float diameter, size_t tessellation, bool rhcoords, bool invertn)
+template<typename TIndexCollection>
+void DirectX::ComputeSphere(VertexCollection& vertices, TIndexCollection& indices, float diameter, size_t tessellation, bool rhcoords, bool invertn, bool parallel)
 {
+    typedef typename TIndexCollection::value_type index_t;
+
     vertices.clear();
     indices.clear();
 
@@ -157,8 +192,22 @@ void DirectX::ComputeSphere(VertexCollection& vertices, IndexCollection& indices
 
     float radius = diameter / 2;
 
+    size_t stride = horizontalSegments + 1;
+    size_t vertexCount = (verticalSegments + 1) * stride;
+
+    CheckIndexOverflow<index_t>(vertexCount - 1);
+
+    // Each ring writes its own slice of the preallocated output, so the rings can be generated in parallel.
+    vertices.resize(vertexCount);
+    indices.resize(verticalSegments * stride * 6);
+
+    auto vertexData = vertices.data();
+    auto indexData = indices.data();
+
+    parallel = parallel && vertexCount >= MinParallelVertexCount;
+
     // Create rings of vertices at progressively higher latitudes.
-    for (size_t i = 0; i <= verticalSegments; i++)
+    ForEachSlice(verticalSegments + 1, parallel, [=](size_t i)
     {
         float v = 1 - float(i) / verticalSegments;
 
@@ -168,6 +217,8 @@ void DirectX::ComputeSphere(VertexCollection& vertices, IndexCollection& indices
         XMScalarSinCos(&dy, &dxz, latitude);
 
         // Create a single ring of vertices at this latitude.
+        auto ring = vertexData + i * stride;
+
         for (size_t j = 0; j <= horizontalSegments; j++)
         {
             float u = float(j) / horizontalSegments;
@@ -183,29 +234,29 @@ void DirectX::ComputeSphere(VertexCollection& vertices, IndexCollection& indices
             XMVECTOR normal = XMVectorSet(dx, dy, dz, 0);
             XMVECTOR textureCoordinate = XMVectorSet(u, v, 0, 0);
 
-            vertices.push_back(VertexPositionNormalTexture(XMVectorScale(normal, radius), normal, textureCoordinate));
+            ring[j] = VertexPositionNormalTexture(XMVectorScale(normal, radius), normal, textureCoordinate);
         }
-    }
+    });
 
     // Fill the index buffer with triangles joining each pair of latitude rings.
-    size_t stride = horizontalSegments + 1;
-
-    for (size_t i = 0; i < verticalSegments; i++)
+    ForEachSlice(verticalSegments, parallel, [=](size_t i)
     {
+        auto output = indexData + i * stride * 6;
+
         for (size_t j = 0; j <= horizontalSegments; j++)
         {
             size_t nextI = i + 1;
             size_t nextJ = (j + 1) % stride;
 
-            index_push_back(indices, i * stride + j);
-            index_push_back(indices, nextI * stride + j);
-            index_push_back(indices, i * stride + nextJ);
+            *output++ = static_cast<index_t>(i * stride + j);
+            *output++ = static_cast<index_t>(nextI * stride + j);
+            *output++ = static_cast<index_t>(i * stride + nextJ);
 
-            index_push_back(indices, i * stride + nextJ);
-            index_push_back(indices, nextI * stride + j);
-            index_push_back(indices, nextI * stride + nextJ);
+            *output++ = static_cast<index_t>(i * stride + nextJ);
+            *output++ = static_cast<index_t>(nextI * stride + j);
+            *output++ = static_cast<index_t>(nextI * stride + nextJ);
         }
-    }
+    });
 
     // Build RH above
     if (!rhcoords)
@@ -219,27 +270,75 @@ void DirectX::ComputeSphere(VertexCollection& vertices, IndexCollection& indices
 //--------------------------------------------------------------------------------------
 // Geodesic sphere
 //--------------------------------------------------------------------------------------
-void DirectX::ComputeGeoSphere(VertexCollection& vertices, IndexCollection& indices, float diameter, size_t tessellation, bool rhcoords)
+namespace
 {
-    vertices.clear();
-    indices.clear();
-
-    // An undirected edge between two vertices, represented by a pair of indexes into a vertex array.
-    // Becuse this edge is undirected, (a,b) is the same as (b,a).
-    typedef std::pair<uint16_t, uint16_t> UndirectedEdge;
+    const uint64_t EmptyEdgeKey = ~uint64_t(0);
 
-    // Makes an undirected edge. Rather than overloading comparison operators to give us the (a,b)==(b,a) property,
-    // we'll just ensure that the larger of the two goes first. This'll simplify things greatly.
-    auto makeUndirectedEdge = [](uint16_t a, uint16_t b)
+    // Open addressing hash table from an undirected edge to the vertex at its midpoint. The number of edges of
+    // each subdivision pass is known up front, so the table is sized once and never grows or rehashes.
+    class EdgeSubdivisionMap
     {
-        return std::make_pair(std::max(a, b), std::min(a, b));
+    public:
+        explicit EdgeSubdivisionMap(size_t edgeCount)
+        {
+            // Keep the load factor at or below one half.
+            size_t capacity = 16;
+
+            while (capacity < edgeCount * 2)
+            {
+                capacity *= 2;
+            }
+
+            mMask = capacity - 1;
+            mKeys.assign(capacity, EmptyEdgeKey);
+            mValues.resize(capacity);
+        }
+
+        // Returns the midpoint vertex of the edge between a and b, or inserts value as the midpoint and returns it
+        // if the edge was not subdivided yet. The edge is undirected, so (a,b) is the same as (b,a).
+        size_t FindOrInsert(size_t a, size_t b, size_t value, bool& inserted)
+        {
+            uint64_t key = (uint64_t(std::max(a, b)) << 32) | uint64_t(std::min(a, b));
+
+            for (size_t slot = Hash(key) & mMask; ; slot = (slot + 1) & mMask)
+            {
+                if (mKeys[slot] == key)
+                {
+                    inserted = false;
+                    return mValues[slot];
+                }
+
+                if (mKeys[slot] == EmptyEdgeKey)
+                {
+                    mKeys[slot] = key;
+                    mValues[slot] = static_cast<uint32_t>(value);
+
+                    inserted = true;
+                    return value;
+                }
+            }
+        }
+
+    private:
+        static size_t Hash(uint64_t key)
+        {
+            // Fibonacci hashing, keeping the well mixed upper bits.
+            return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> 32);
+        }
+
+        size_t mMask;
+        std::vector<uint64_t> mKeys;
+        std::vector<uint32_t> mValues;
     };
+}
 
-    // Key: an edge
-    // Value: the index of the vertex which lies midway between the two vertices pointed to by the key value
-    // This map is used to avoid duplicating vertices when subdividing triangles along edges.
-    typedef std::map<UndirectedEdge, uint16_t> EdgeSubdivisionMap;
+template<typename TIndexCollection>
+void DirectX::ComputeGeoSphere(VertexCollection& vertices, TIndexCollection& indices, float diameter, size_t tessellation, bool rhcoords)
+{
+    typedef typename TIndexCollection::value_type index_t;
 
+    vertices.clear();
+    indices.clear();
 
     static const XMFLOAT3 OctahedronVertices[] =
     {
@@ -265,87 +364,89 @@ void DirectX::ComputeGeoSphere(VertexCollection& vertices, IndexCollection& indi
 
     const float radius = diameter / 2.0f;
 
+    // Each subdivision splits every triangle in four, and adds one vertex per edge. A closed mesh has one and a
+    // half edges per triangle, so the final vertex count is known before subdividing.
+    size_t finalVertexCount = _countof(OctahedronVertices);
+    size_t finalTriangleCount = _countof(OctahedronIndices) / 3;
+
+    for (size_t iSubdivision = 0; iSubdivision < tessellation; ++iSubdivision)
+    {
+        finalVertexCount += finalTriangleCount * 3 / 2;
+        finalTriangleCount *= 4;
+    }
+
+    CheckIndexOverflow<index_t>(finalVertexCount - 1);
+
     // Start with an octahedron; copy the data into the vertex/index collection.
 
-    std::vector<XMFLOAT3> vertexPositions(std::begin(OctahedronVertices), std::end(OctahedronVertices));
+    std::vector<XMFLOAT3> vertexPositions;
+    vertexPositions.reserve(finalVertexCount);
+    vertexPositions.assign(std::begin(OctahedronVertices), std::end(OctahedronVertices));
 
     indices.insert(indices.begin(), std::begin(OctahedronIndices), std::end(OctahedronIndices));
 
     // We know these values by looking at the above index list for the octahedron. Despite the subdivisions that are
     // about to go on, these values aren't ever going to change because the vertices don't move around in the array.
     // We'll need these values later on to fix the singularities that show up at the poles.
-    const uint16_t northPoleIndex = 0;
-    const uint16_t southPoleIndex = 5;
+    const size_t northPoleIndex = 0;
+    const size_t southPoleIndex = 5;
+
+    // The new index collection after subdivision.
+    TIndexCollection newIndices;
 
     for (size_t iSubdivision = 0; iSubdivision < tessellation; ++iSubdivision)
     {
         assert(indices.size() % 3 == 0); // sanity
 
+        const size_t triangleCount = indices.size() / 3;
+
         // We use this to keep track of which edges have already been subdivided.
-        EdgeSubdivisionMap subdividedEdges;
+        EdgeSubdivisionMap subdividedEdges(triangleCount * 3 / 2);
 
-        // The new index collection after subdivision.
-        IndexCollection newIndices;
+        newIndices.clear();
+        newIndices.reserve(triangleCount * 12);
+
+        // Function that, when given the index of two vertices, returns the index of a vertex at the midpoint of those
+        // vertices, creating it if it does not exist yet.
+        auto divideEdge = [&](size_t i0, size_t i1) -> index_t
+        {
+            bool inserted;
+            size_t index = subdividedEdges.FindOrInsert(i0, i1, vertexPositions.size(), inserted);
+
+            if (inserted)
+            {
+                // Haven't generated this vertex before: so add it now
+
+                // outVertex = (vertices[i0] + vertices[i1]) / 2
+                XMFLOAT3 outVertex;
+                XMStoreFloat3(
+                    &outVertex,
+                    XMVectorScale(
+                    XMVectorAdd(XMLoadFloat3(&vertexPositions[i0]), XMLoadFloat3(&vertexPositions[i1])),
+                    0.5f
+                )
+                );
+
+                vertexPositions.push_back(outVertex);
+            }
+
+            return static_cast<index_t>(index);
+        };
 
-        const size_t triangleCount = indices.size() / 3;
         for (size_t iTriangle = 0; iTriangle < triangleCount; ++iTriangle)
         {
             // For each edge on this triangle, create a new vertex in the middle of that edge.
             // The winding order of the triangles we output are the same as the winding order of the inputs.
 
             // Indices of the vertices making up this triangle
-            uint16_t iv0 = indices[iTriangle * 3 + 0];
-            uint16_t iv1 = indices[iTriangle * 3 + 1];
-            uint16_t iv2 = indices[iTriangle * 3 + 2];
-
-            // Get the new vertices
-            XMFLOAT3 v01; // vertex on the midpoint of v0 and v1
-            XMFLOAT3 v12; // ditto v1 and v2
-            XMFLOAT3 v20; // ditto v2 and v0
-            uint16_t iv01; // index of v01
-            uint16_t iv12; // index of v12
-            uint16_t iv20; // index of v20
-
-            // Function that, when given the index of two vertices, creates a new vertex at the midpoint of those vertices.
-            auto divideEdge = [&](uint16_t i0, uint16_t i1, XMFLOAT3& outVertex, uint16_t& outIndex)
-            {
-                const UndirectedEdge edge = makeUndirectedEdge(i0, i1);
-
-                // Check to see if we've already generated this vertex
-                auto it = subdividedEdges.find(edge);
-                if (it != subdividedEdges.end())
-                {
-                    // We've already generated this vertex before
-                    outIndex = it->second; // the index of this vertex
-                    outVertex = vertexPositions[outIndex]; // and the vertex itself
-                }
-                else
-                {
-                    // Haven't generated this vertex before: so add it now
-
-                    // outVertex = (vertices[i0] + vertices[i1]) / 2
-                    XMStoreFloat3(
-                        &outVertex,
-                        XMVectorScale(
-                        XMVectorAdd(XMLoadFloat3(&vertexPositions[i0]), XMLoadFloat3(&vertexPositions[i1])),
-                        0.5f
-                    )
-                    );
-
-                    outIndex = static_cast<uint16_t>(vertexPositions.size());
-                    CheckIndexOverflow(outIndex);
-                    vertexPositions.push_back(outVertex);
-
-                    // Now add it to the map.
-                    auto entry = std::make_pair(edge, outIndex);
-                    subdividedEdges.insert(entry);
-                }
-            };
+            index_t iv0 = indices[iTriangle * 3 + 0];
+            index_t iv1 = indices[iTriangle * 3 + 1];
+            index_t iv2 = indices[iTriangle * 3 + 2];
 
             // Add/get new vertices and their indices
-            divideEdge(iv0, iv1, v01, iv01);
-            divideEdge(iv1, iv2, v12, iv12);
-            divideEdge(iv0, iv2, v20, iv20);
+            index_t iv01 = divideEdge(iv0, iv1); // index of the vertex on the midpoint of v0 and v1
+            index_t iv12 = divideEdge(iv1, iv2); // ditto v1 and v2
+            index_t iv20 = divideEdge(iv0, iv2); // ditto v2 and v0
 
             // Add the new indices. We have four new triangles from our original one:
             //        v0
@@ -355,7 +456,7 @@ void DirectX::ComputeGeoSphere(VertexCollection& vertices, IndexCollection& indi
             //     /b\c/d\
             // v2 o---o---o v1
             //       v12
-            const uint16_t indicesToAdd[] =
+            const index_t indicesToAdd[] =
             {
                  iv0, iv01, iv20, // a
                 iv20, iv12,  iv2, // b
@@ -365,9 +466,11 @@ void DirectX::ComputeGeoSphere(VertexCollection& vertices, IndexCollection& indi
             newIndices.insert(newIndices.end(), std::begin(indicesToAdd), std::end(indicesToAdd));
         }
 
-        indices = std::move(newIndices);
+        indices.swap(newIndices);
     }
 
+    assert(vertexPositions.size() == finalVertexCount);
+
     // Now that we've completed subdivision, fill in the final vertex collection
     vertices.reserve(vertexPositions.size());
     for (auto it = vertexPositions.begin(); it != vertexPositions.end(); ++it)
@@ -401,7 +504,11 @@ void DirectX::ComputeGeoSphere(VertexCollection& vertices, IndexCollection& indi
     // completed sphere. If you imagine the vertices along that edge, they circumscribe a semicircular arc starting at
     // y=1 and ending at y=-1, and sweeping across the range of z=0 to z=1. x stays zero. It's along this edge that we
     // need to duplicate our vertices - and provide the correct texture coordinates.
-    size_t preFixupVertexCount = vertices.size();
+    const size_t preFixupVertexCount = vertices.size();
+
+    // For each vertex on the prime meridian, the index of its copy; zero for the other vertices, as no copy can be vertex 0.
+    std::vector<size_t> meridianCopies(preFixupVertexCount, 0);
+
     for (size_t i = 0; i < preFixupVertexCount; ++i)
     {
         // This vertex is on the prime meridian if position.x and texcoord.u are both zero (allowing for small epsilon).
@@ -413,54 +520,46 @@ void DirectX::ComputeGeoSphere(VertexCollection& vertices, IndexCollection& indi
         if (isOnPrimeMeridian)
         {
             size_t newIndex = vertices.size(); // the index of this vertex that we're about to add
-            CheckIndexOverflow(newIndex);
+            CheckIndexOverflow<index_t>(newIndex);
 
             // copy this vertex, correct the texture coordinate, and add the vertex
             VertexPositionNormalTexture v = vertices[i];
             v.textureCoordinate.x = 1.0f;
             vertices.push_back(v);
 
-            // Now find all the triangles which contain this vertex and update them if necessary
-            for (size_t j = 0; j < indices.size(); j += 3)
+            meridianCopies[i] = newIndex;
+        }
+    }
+
+    // Now update the triangles which contain one of these vertices, in a single pass over the index collection.
+    for (size_t j = 0; j < indices.size(); j += 3)
+    {
+        for (size_t k = 0; k < 3; ++k)
+        {
+            index_t* triIndex0 = &indices[j + k];
+
+            if (*triIndex0 >= preFixupVertexCount || !meridianCopies[*triIndex0])
             {
-                uint16_t* triIndex0 = &indices[j + 0];
-                uint16_t* triIndex1 = &indices[j + 1];
-                uint16_t* triIndex2 = &indices[j + 2];
+                // this corner doesn't use a vertex on the prime meridian
+                continue;
+            }
 
-                if (*triIndex0 == i)
-                {
-                    // nothing; just keep going
-                }
-                else if (*triIndex1 == i)
-                {
-                    std::swap(triIndex0, triIndex1); // swap the pointers (not the values)
-                }
-                else if (*triIndex2 == i)
-                {
-                    std::swap(triIndex0, triIndex2); // swap the pointers (not the values)
-                }
-                else
-                {
-                    // this triangle doesn't use the vertex we're interested in
-                    continue;
-                }
+            const index_t* triIndex1 = &indices[j + (k + 1) % 3];
+            const index_t* triIndex2 = &indices[j + (k + 2) % 3];
 
-                // If we got to this point then triIndex0 is the pointer to the index to the vertex we're looking at
-                assert(*triIndex0 == i);
-                assert(*triIndex1 != i && *triIndex2 != i); // assume no degenerate triangles
+            assert(*triIndex1 != *triIndex0 && *triIndex2 != *triIndex0); // assume no degenerate triangles
 
-                const VertexPositionNormalTexture& v0 = vertices[*triIndex0];
-                const VertexPositionNormalTexture& v1 = vertices[*triIndex1];
-                const VertexPositionNormalTexture& v2 = vertices[*triIndex2];
+            const VertexPositionNormalTexture& v0 = vertices[*triIndex0];
+            const VertexPositionNormalTexture& v1 = vertices[*triIndex1];
+            const VertexPositionNormalTexture& v2 = vertices[*triIndex2];
 
-                // check the other two vertices to see if we might need to fix this triangle
+            // check the other two vertices to see if we might need to fix this triangle
 
-                if (abs(v0.textureCoordinate.x - v1.textureCoordinate.x) > 0.5f ||
-                    abs(v0.textureCoordinate.x - v2.textureCoordinate.x) > 0.5f)
-                {
-                    // yep; replace the specified index to point to the new, corrected vertex
-                    *triIndex0 = static_cast<uint16_t>(newIndex);
-                }
+            if (abs(v0.textureCoordinate.x - v1.textureCoordinate.x) > 0.5f ||
+                abs(v0.textureCoordinate.x - v2.textureCoordinate.x) > 0.5f)
+            {
+                // yep; replace the specified index to point to the new, corrected vertex
+                *triIndex0 = static_cast<index_t>(meridianCopies[*triIndex0]);
             }
         }
     }
@@ -480,9 +579,9 @@ void DirectX::ComputeGeoSphere(VertexCollection& vertices, IndexCollection& indi
             // These pointers point to the three indices which make up this triangle. pPoleIndex is the pointer to the
             // entry in the index array which represents the pole index, and the other two pointers point to the other
             // two indices making up this triangle.
-            uint16_t* pPoleIndex;
-            uint16_t* pOtherIndex0;
-            uint16_t* pOtherIndex1;
+            index_t* pPoleIndex;
+            index_t* pOtherIndex0;
+            index_t* pOtherIndex1;
             if (indices[i + 0] == poleIndex)
             {
                 pPoleIndex = &indices[i + 0];
@@ -521,9 +620,9 @@ void DirectX::ComputeGeoSphere(VertexCollection& vertices, IndexCollection& indi
             }
             else
             {
-                CheckIndexOverflow(vertices.size());
+                CheckIndexOverflow<index_t>(vertices.size());
 
-                *pPoleIndex = static_cast<uint16_t>(vertices.size());
+                *pPoleIndex = static_cast<index_t>(vertices.size());
                 vertices.push_back(newPoleVertex);
             }
         }
@@ -568,7 +667,8 @@ namespace
 
 
     // Helper creates a triangle fan to close the end of a cylinder / cone
-    void CreateCylinderCap(VertexCollection& vertices, IndexCollection& indices, size_t tessellation, float height, float radius, bool isTop)
+    template<typename TIndexCollection>
+    void CreateCylinderCap(VertexCollection& vertices, TIndexCollection& indices, size_t tessellation, float height, float radius, bool isTop)
     {
         // Create cap indices.
         for (size_t i = 0; i < tessellation - 2; i++)
@@ -611,7 +711,8 @@ namespace
     }
 }
 
-void DirectX::ComputeCylinder(VertexCollection& vertices, IndexCollection& indices, float height, float diameter, size_t tessellation, bool rhcoords)
+template<typename TIndexCollection>
+void DirectX::ComputeCylinder(VertexCollection& vertices, TIndexCollection& indices, float height, float diameter, size_t tessellation, bool rhcoords)
 {
     vertices.clear();
     indices.clear();
@@ -626,6 +727,10 @@ void DirectX::ComputeCylinder(VertexCollection& vertices, IndexCollection& indic
     float radius = diameter / 2;
     size_t stride = tessellation + 1;
 
+    // The side, then a triangle fan for each cap.
+    vertices.reserve(stride * 2 + tessellation * 2);
+    indices.reserve(stride * 6 + (tessellation - 2) * 6);
+
     // Create a ring of triangles around the outside of the cylinder.
     for (size_t i = 0; i <= tessellation; i++)
     {
@@ -660,7 +765,8 @@ void DirectX::ComputeCylinder(VertexCollection& vertices, IndexCollection& indic
 
 
 // Creates a cone primitive.
-void DirectX::ComputeCone(VertexCollection& vertices, IndexCollection& indices, float diameter, float height, size_t tessellation, bool rhcoords)
+template<typename TIndexCollection>
+void DirectX::ComputeCone(VertexCollection& vertices, TIndexCollection& indices, float diameter, float height, size_t tessellation, bool rhcoords)
 {
     vertices.clear();
     indices.clear();
@@ -675,6 +781,10 @@ void DirectX::ComputeCone(VertexCollection& vertices, IndexCollection& indices,
     float radius = diameter / 2;
     size_t stride = tessellation + 1;
 
+    // The side, then a triangle fan for the bottom cap.
+    vertices.reserve(stride * 2 + tessellation);
+    indices.reserve(stride * 3 + (tessellation - 2) * 3);
+
     // Create a ring of triangles around the outside of the cone.
     for (size_t i = 0; i <= tessellation; i++)
     {
@@ -714,8 +824,11 @@ void DirectX::ComputeCone(VertexCollection& vertices, IndexCollection& indices,
 //--------------------------------------------------------------------------------------
 // Torus
 //--------------------------------------------------------------------------------------
-void DirectX::ComputeTorus(VertexCollection& vertices, IndexCollection& indices, float diameter, float thickness, size_t tessellation, bool rhcoords)
+template<typename TIndexCollection>
+void DirectX::ComputeTorus(VertexCollection& vertices, TIndexCollection& indices, float diameter, float thickness, size_t tessellation, bool rhcoords, bool parallel)
 {
+    typedef typename TIndexCollection::value_type index_t;
+
     vertices.clear();
     indices.clear();
 
@@ -723,9 +836,21 @@ void DirectX::ComputeTorus(VertexCollection& vertices, IndexCollection& indices,
         throw std::out_of_range("tesselation parameter out of range");
 
     size_t stride = tessellation + 1;
+    size_t vertexCount = stride * stride;
+
+    CheckIndexOverflow<index_t>(vertexCount - 1);
+
+    // Each ring writes its own slice of the preallocated output, so the rings can be generated in parallel.
+    vertices.resize(vertexCount);
+    indices.resize(vertexCount * 6);
+
+    auto vertexData = vertices.data();
+    auto indexData = indices.data();
+
+    parallel = parallel && vertexCount >= MinParallelVertexCount;
 
     // First we loop around the main ring of the torus.
-    for (size_t i = 0; i <= tessellation; i++)
+    ForEachSlice(stride, parallel, [=](size_t i)
     {
         float u = float(i) / tessellation;
 
@@ -735,6 +860,9 @@ void DirectX::ComputeTorus(VertexCollection& vertices, IndexCollection& indices,
         // slice perpendicularly though the current ring position.
         XMMATRIX transform = XMMatrixTranslation(diameter / 2, 0, 0) * XMMatrixRotationY(outerAngle);
 
+        auto ring = vertexData + i * stride;
+        auto output = indexData + i * stride * 6;
+
         // Now we loop along the other axis, around the side of the tube.
         for (size_t j = 0; j <= tessellation; j++)
         {
@@ -753,21 +881,21 @@ void DirectX::ComputeTorus(VertexCollection& vertices, IndexCollection& indices,
             position = XMVector3Transform(position, transform);
             normal = XMVector3TransformNormal(normal, transform);
 
-            vertices.push_back(VertexPositionNormalTexture(position, normal, textureCoordinate));
+            ring[j] = VertexPositionNormalTexture(position, normal, textureCoordinate);
 
             // And create indices for two triangles.
             size_t nextI = (i + 1) % stride;
             size_t nextJ = (j + 1) % stride;
 
-            index_push_back(indices, i * stride + j);
-            index_push_back(indices, i * stride + nextJ);
-            index_push_back(indices, nextI * stride + j);
+            *output++ = static_cast<index_t>(i * stride + j);
+            *output++ = static_cast<index_t>(i * stride + nextJ);
+            *output++ = static_cast<index_t>(nextI * stride + j);
 
-            index_push_back(indices, i * stride + nextJ);
-            index_push_back(indices, nextI * stride + nextJ);
-            index_push_back(indices, nextI * stride + j);
+            *output++ = static_cast<index_t>(i * stride + nextJ);
+            *output++ = static_cast<index_t>(nextI * stride + nextJ);
+            *output++ = static_cast<index_t>(nextI * stride + j);
         }
-    }
+    });
 
     // Build RH above
     if (!rhcoords)
@@ -778,7 +906,8 @@ void DirectX::ComputeTorus(VertexCollection& vertices, IndexCollection& indices,
 //--------------------------------------------------------------------------------------
 // Tetrahedron
 //--------------------------------------------------------------------------------------
-void DirectX::ComputeTetrahedron(VertexCollection& vertices, IndexCollection& indices, float size, bool rhcoords)
+template<typename TIndexCollection>
+void DirectX::ComputeTetrahedron(VertexCollection& vertices, TIndexCollection& indices, float size, bool rhcoords)
 {
     vertices.clear();
     indices.clear();
@@ -838,7 +967,8 @@ void DirectX::ComputeTetrahedron(VertexCollection& vertices, IndexCollection& in
 //--------------------------------------------------------------------------------------
 // Octahedron
 //--------------------------------------------------------------------------------------
-void DirectX::ComputeOctahedron(VertexCollection& vertices, IndexCollection& indices, float size, bool rhcoords)
+template<typename TIndexCollection>
+void DirectX::ComputeOctahedron(VertexCollection& vertices, TIndexCollection& indices, float size, bool rhcoords)
 {
     vertices.clear();
     indices.clear();
@@ -904,7 +1034,8 @@ void DirectX::ComputeOctahedron(VertexCollection& vertices, IndexCollection& ind
 //--------------------------------------------------------------------------------------
 // Dodecahedron
 //--------------------------------------------------------------------------------------
-void DirectX::ComputeDodecahedron(VertexCollection& vertices, IndexCollection& indices, float size, bool rhcoords)
+template<typename TIndexCollection>
+void DirectX::ComputeDodecahedron(VertexCollection& vertices, TIndexCollection& indices, float size, bool rhcoords)
 {
     vertices.clear();
     indices.clear();
@@ -1035,7 +1166,8 @@ void DirectX::ComputeDodecahedron(VertexCollection& vertices, IndexCollection& i
 //--------------------------------------------------------------------------------------
 // Icosahedron
 //--------------------------------------------------------------------------------------
-void DirectX::ComputeIcosahedron(VertexCollection& vertices, IndexCollection& indices, float size, bool rhcoords)
+template<typename TIndexCollection>
+void DirectX::ComputeIcosahedron(VertexCollection& vertices, TIndexCollection& indices, float size, bool rhcoords)
 {
     vertices.clear();
     indices.clear();
@@ -1128,8 +1260,9 @@ namespace
 {
 #include "TeapotData.inc"
 
-    // Tessellates the specified bezier patch.
-    void XM_CALLCONV TessellatePatch(VertexCollection& vertices, IndexCollection& indices, TeapotPatch const& patch, size_t tessellation, FXMVECTOR scale, bool isMirrored)
+    // Tessellates the specified bezier patch into (tessellation + 1)^2 vertices and tessellation^2 * 6 indices.
+    template<typename TIndex>
+    void XM_CALLCONV TessellatePatch(_Out_ VertexPositionNormalTexture* vertices, _Out_ TIndex* indices, size_t vbase, TeapotPatch const& patch, size_t tessellation, FXMVECTOR scale, bool isMirrored)
     {
         // Look up the 16 control points for this patch.
         XMVECTOR controlPoints[16];
@@ -1140,35 +1273,48 @@ namespace
         }
 
         // Create the index data.
-        size_t vbase = vertices.size();
         Bezier::CreatePatchIndices(tessellation, isMirrored, [&](size_t index)
                                    {
-                                       index_push_back(indices, vbase + index);
+                                       *indices++ = static_cast<TIndex>(vbase + index);
                                    });
 
                                    // Create the vertex data.
         Bezier::CreatePatchVertices(controlPoints, tessellation, isMirrored, [&](FXMVECTOR position, FXMVECTOR normal, FXMVECTOR textureCoordinate)
                                     {
-                                        vertices.push_back(VertexPositionNormalTexture(position, normal, textureCoordinate));
+                                        *vertices++ = VertexPositionNormalTexture(position, normal, textureCoordinate);
                                     });
     }
+
+
+    // One tessellated copy of a teapot patch.
+    struct TeapotPatchInstance
+    {
+        TeapotPatch const* patch;
+        XMFLOAT3 scale;
+        bool isMirrored;
+    };
 }
 
 
 // Creates a teapot primitive.
-void DirectX::ComputeTeapot(VertexCollection& vertices, IndexCollection& indices, float size, size_t tessellation, bool rhcoords)
+template<typename TIndexCollection>
+void DirectX::ComputeTeapot(VertexCollection& vertices, TIndexCollection& indices, float size, size_t tessellation, bool rhcoords, bool parallel)
 {
+    typedef typename TIndexCollection::value_type index_t;
+
     vertices.clear();
     indices.clear();
 
     if (tessellation < 1)
         throw std::out_of_range("tesselation parameter out of range");
 
-    XMVECTOR scaleVector = XMVectorReplicate(size);
+    XMFLOAT3 scale(size, size, size);
+    XMFLOAT3 scaleNegateX(-size, size, size);
+    XMFLOAT3 scaleNegateZ(size, size, -size);
+    XMFLOAT3 scaleNegateXZ(-size, size, -size);
 
-    XMVECTOR scaleNegateX = XMVectorMultiply(scaleVector, g_XMNegateX);
-    XMVECTOR scaleNegateZ = XMVectorMultiply(scaleVector, g_XMNegateZ);
-    XMVECTOR scaleNegateXZ = XMVectorMultiply(scaleVector, XMVectorMultiply(g_XMNegateX, g_XMNegateZ));
+    std::vector<TeapotPatchInstance> instances;
+    instances.reserve(_countof(TeapotPatches) * 4);
 
     for (size_t i = 0; i < _countof(TeapotPatches); i++)
     {
@@ -1176,20 +1322,69 @@ void DirectX::ComputeTeapot(VertexCollection& vertices, IndexCollection& indices
 
         // Because the teapot is symmetrical from left to right, we only store
         // data for one side, then tessellate each patch twice, mirroring in X.
-        TessellatePatch(vertices, indices, patch, tessellation, scaleVector, false);
-        TessellatePatch(vertices, indices, patch, tessellation, scaleNegateX, true);
+        instances.push_back({ &patch, scale, false });
+        instances.push_back({ &patch, scaleNegateX, true });
 
         if (patch.mirrorZ)
         {
             // Some parts of the teapot (the body, lid, and rim, but not the
             // handle or spout) are also symmetrical from front to back, so
             // we tessellate them four times, mirroring in Z as well as X.
-            TessellatePatch(vertices, indices, patch, tessellation, scaleNegateZ, true);
-            TessellatePatch(vertices, indices, patch, tessellation, scaleNegateXZ, false);
+            instances.push_back({ &patch, scaleNegateZ, true });
+            instances.push_back({ &patch, scaleNegateXZ, false });
         }
     }
 
+    // Every patch has the same number of vertices and indices, so each one writes a known slice of the output.
+    size_t patchVertexCount = (tessellation + 1) * (tessellation + 1);
+    size_t patchIndexCount = tessellation * tessellation * 6;
+
+    CheckIndexOverflow<index_t>(instances.size() * patchVertexCount - 1);
+
+    vertices.resize(instances.size() * patchVertexCount);
+    indices.resize(instances.size() * patchIndexCount);
+
+    auto vertexData = vertices.data();
+    auto indexData = indices.data();
+
+    parallel = parallel && vertices.size() >= MinParallelVertexCount;
+
+    ForEachSlice(instances.size(), parallel, [=, &instances](size_t i)
+    {
+        auto const& instance = instances[i];
+
+        TessellatePatch(vertexData + i * patchVertexCount,
+                        indexData + i * patchIndexCount,
+                        i * patchVertexCount,
+                        *instance.patch,
+                        tessellation,
+                        XMLoadFloat3(&instance.scale),
+                        instance.isMirrored);
+    });
+
     // Built RH above
     if (!rhcoords)
         ReverseWinding(indices, vertices);
 }
+
+
+//--------------------------------------------------------------------------------------
+// Instantiations for 16-bit and 32-bit indices
+//--------------------------------------------------------------------------------------
+#define INSTANTIATE_GEOMETRY(TIndexCollection) \
+    template void DirectX::ComputeBox(VertexCollection& vertices, TIndexCollection& indices, const XMFLOAT3& size, bool rhcoords, bool invertn); \
+    template void DirectX::ComputeSphere(VertexCollection& vertices, TIndexCollection& indices, float diameter, size_t tessellation, bool rhcoords, bool invertn, bool parallel); \
+    template void DirectX::ComputeGeoSphere(VertexCollection& vertices, TIndexCollection& indices, float diameter, size_t tessellation, bool rhcoords); \
+    template void DirectX::ComputeCylinder(VertexCollection& vertices, TIndexCollection& indices, float height, float diameter, size_t tessellation, bool rhcoords); \
+    template void DirectX::ComputeCone(VertexCollection& vertices, TIndexCollection& indices, float diameter, float height, size_t tessellation, bool rhcoords); \
+    template void DirectX::ComputeTorus(VertexCollection& vertices, TIndexCollection& indices, float diameter, float thickness, size_t tessellation, bool rhcoords, bool parallel); \
+    template void DirectX::ComputeTetrahedron(VertexCollection& vertices, TIndexCollection& indices, float size, bool rhcoords); \
+    template void DirectX::ComputeOctahedron(VertexCollection& vertices, TIndexCollection& indices, float size, bool rhcoords); \
+    template void DirectX::ComputeDodecahedron(VertexCollection& vertices, TIndexCollection& indices, float size, bool rhcoords); \
+    template void DirectX::ComputeIcosahedron(VertexCollection& vertices, TIndexCollection& indices, float size, bool rhcoords); \
+    template void DirectX::ComputeTeapot(VertexCollection& vertices, TIndexCollection& indices, float size, size_t tessellation, bool rhcoords, bool parallel);
+
+INSTANTIATE_GEOMETRY(IndexCollection)
+INSTANTIATE_GEOMETRY(IndexCollection32)
+
+#undef INSTANTIATE_GEOMETRY
@@ -14,16 +14,19 @@ namespace DirectX
 {
     typedef std::vector<DirectX::VertexPositionNormalTexture> VertexCollection;
     typedef std::vector<uint16_t> IndexCollection;
+    typedef std::vector<uint32_t> IndexCollection32;
 
-    void ComputeBox(VertexCollection& vertices, IndexCollection& indices, const XMFLOAT3& size, bool rhcoords, bool invertn);
-    void ComputeSphere(VertexCollection& vertices, IndexCollection& indices, float diameter, size_t tessellation, bool rhcoords, bool invertn);
-    void ComputeGeoSphere(VertexCollection& vertices, IndexCollection& indices, float diameter, size_t tessellation, bool rhcoords);
-    void ComputeCylinder(VertexCollection& vertices, IndexCollection& indices, float height, float diameter, size_t tessellation, bool rhcoords);
-    void ComputeCone(VertexCollection& vertices, IndexCollection& indices, float diameter, float height, size_t tessellation, bool rhcoords);
-    void ComputeTorus(VertexCollection& vertices, IndexCollection& indices, float diameter, float thickness, size_t tessellation, bool rhcoords);
-    void ComputeTetrahedron(VertexCollection& vertices, IndexCollection& indices, float size, bool rhcoords);
-    void ComputeOctahedron(VertexCollection& vertices, IndexCollection& indices, float size, bool rhcoords);
-    void ComputeDodecahedron(VertexCollection& vertices, IndexCollection& indices, float size, bool rhcoords);
-    void ComputeIcosahedron(VertexCollection& vertices, IndexCollection& indices, float size, bool rhcoords);
-    void ComputeTeapot(VertexCollection& vertices, IndexCollection& indices, float size, size_t tessellation, bool rhcoords);
+    // Each function is instantiated for both IndexCollection and IndexCollection32. The sphere, torus and
+    // teapot generate large tessellations in parallel, unless parallel is false.
+    template<typename TIndexCollection> void ComputeBox(VertexCollection& vertices, TIndexCollection& indices, const XMFLOAT3& size, bool rhcoords, bool invertn);
+    template<typename TIndexCollection> void ComputeSphere(VertexCollection& vertices, TIndexCollection& indices, float diameter, size_t tessellation, bool rhcoords, bool invertn, bool parallel = true);
+    template<typename TIndexCollection> void ComputeGeoSphere(VertexCollection& vertices, TIndexCollection& indices, float diameter, size_t tessellation, bool rhcoords);
+    template<typename TIndexCollection> void ComputeCylinder(VertexCollection& vertices, TIndexCollection& indices, float height, float diameter, size_t tessellation, bool rhcoords);
+    template<typename TIndexCollection> void ComputeCone(VertexCollection& vertices, TIndexCollection& indices, float diameter, float height, size_t tessellation, bool rhcoords);
+    template<typename TIndexCollection> void ComputeTorus(VertexCollection& vertices, TIndexCollection& indices, float diameter, float thickness, size_t tessellation, bool rhcoords, bool parallel = true);
+    template<typename TIndexCollection> void ComputeTetrahedron(VertexCollection& vertices, TIndexCollection& indices, float size, bool rhcoords);
+    template<typename TIndexCollection> void ComputeOctahedron(VertexCollection& vertices, TIndexCollection& indices, float size, bool rhcoords);
+    template<typename TIndexCollection> void ComputeDodecahedron(VertexCollection& vertices, TIndexCollection& indices, float size, bool rhcoords);
+    template<typename TIndexCollection> void ComputeIcosahedron(VertexCollection& vertices, TIndexCollection& indices, float size, bool rhcoords);
+    template<typename TIndexCollection> void ComputeTeapot(VertexCollection& vertices, TIndexCollection& indices, float size, size_t tessellation, bool rhcoords, bool parallel = true);
 }
@@ -0,0 +1,267 @@
+//--------------------------------------------------------------------------------------
+// File: GlyphAtlas.cpp
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "pch.h"
+
+#include <algorithm>
+
+#include "GlyphAtlas.h"
+
+using namespace DirectX;
+
+
+namespace
+{
+    // Shelf heights are rounded up to this many texels, so glyphs of similar size share shelves.
+    const uint32_t ShelfGranularity = 4;
+
+    // A shelf taller than this ratio of the requested height is only used when no new shelf fits.
+    const uint32_t MaxShelfWaste = 2;
+
+    const size_t NoShelf = size_t(-1);
+}
+
+
+GlyphAtlas::GlyphAtlas(uint32_t width, uint32_t height) :
+    mWidth(width),
+    mHeight(height),
+    mShelfTop(0),
+    mFrame(0),
+    mEvictionCount(0)
+{
+}
+
+
+bool GlyphAtlas::Touch(uint32_t key, Region& region)
+{
+    auto entry = mEntries.find(key);
+
+    if (entry == mEntries.end())
+        return false;
+
+    entry->second.frame = mFrame;
+
+    // Move the key to the front of the list.
+    mLru.splice(mLru.begin(), mLru, entry->second.lruPosition);
+
+    region = entry->second.region;
+
+    return true;
+}
+
+
+bool GlyphAtlas::Insert(uint32_t key, uint32_t width, uint32_t height, Region& region)
+{
+    if (Touch(key, region))
+        return true;
+
+    if (!width || !height || width > mWidth || height > mHeight)
+        return false;
+
+    while (!Allocate(width, height, region))
+    {
+        if (!EvictLeastRecentlyUsed())
+            return false;
+    }
+
+    mLru.push_front(key);
+
+    Entry& entry = mEntries[key];
+
+    entry.region = region;
+    entry.frame = mFrame;
+    entry.lruPosition = mLru.begin();
+
+    return true;
+}
+
+
+void GlyphAtlas::Clear()
+{
+    mShelves.clear();
+    mLru.clear();
+    mEntries.clear();
+
+    mShelfTop = 0;
+}
+
+
+// Finds room for a rectangle, without evicting anything.
+bool GlyphAtlas::Allocate(uint32_t width, uint32_t height, Region& region)
+{
+    // Look for the shortest shelf that is tall enough and has a wide enough free span.
+    size_t bestShelf = NoShelf;
+    size_t bestSpan = 0;
+
+    for (size_t i = 0; i < mShelves.size(); i++)
+    {
+        auto const& shelf = mShelves[i];
+
+        if (shelf.height < height || (bestShelf != NoShelf && shelf.height >= mShelves[bestShelf].height))
+            continue;
+
+        for (size_t j = 0; j < shelf.freeSpans.size(); j++)
+        {
+            if (shelf.freeSpans[j].width >= width)
+            {
+                bestShelf = i;
+                bestSpan = j;
+                break;
+            }
+        }
+    }
+
+    uint32_t shelfHeight = std::min((height + ShelfGranularity - 1) / ShelfGranularity * ShelfGranularity, mHeight);
+
+    // Rather than wasting most of a tall shelf, open a new one if there is space left.
+    if ((bestShelf == NoShelf || mShelves[bestShelf].height > height * MaxShelfWaste)
+        && mHeight - mShelfTop >= shelfHeight)
+    {
+        Shelf shelf;
+
+        shelf.y = mShelfTop;
+        shelf.height = shelfHeight;
+
+        ResetShelf(shelf);
+
+        mShelves.push_back(std::move(shelf));
+        mShelfTop += shelfHeight;
+
+        bestShelf = mShelves.size() - 1;
+        bestSpan = 0;
+    }
+
+    if (bestShelf == NoShelf)
+        return false;
+
+    auto& shelf = mShelves[bestShelf];
+    auto& span = shelf.freeSpans[bestSpan];
+
+    region.x = span.x;
+    region.y = shelf.y;
+    region.width = width;
+    region.height = height;
+
+    span.x += width;
+    span.width -= width;
+
+    if (!span.width)
+    {
+        shelf.freeSpans.erase(shelf.freeSpans.begin() + ptrdiff_t(bestSpan));
+    }
+
+    shelf.entryCount++;
+
+    return true;
+}
+
+
+// Evicts the least recently used entry, unless it was used in the current frame.
+bool GlyphAtlas::EvictLeastRecentlyUsed()
+{
+    if (mLru.empty())
+        return false;
+
+    auto entry = mEntries.find(mLru.back());
+
+    if (entry->second.frame == mFrame)
+        return false;
+
+    Free(entry->second.region);
+
+    mEntries.erase(entry);
+    mLru.pop_back();
+
+    mEvictionCount++;
+
+    return true;
+}
+
+
+// Returns the texels of a region to its shelf.
+void GlyphAtlas::Free(Region const& region)
+{
+    auto shelf = std::lower_bound(mShelves.begin(), mShelves.end(), region.y, [](Shelf const& shelf, uint32_t y)
+    {
+        return shelf.y < y;
+    });
+
+    assert(shelf != mShelves.end() && shelf->y == region.y);
+
+    if (--shelf->entryCount == 0)
+    {
+        ResetShelf(*shelf);
+
+        // Merge with empty neighbors, so the space can be reused for taller rectangles.
+        auto next = shelf + 1;
+
+        if (next != mShelves.end() && !next->entryCount)
+        {
+            shelf->height += next->height;
+            shelf = mShelves.erase(next) - 1;
+        }
+
+        if (shelf != mShelves.begin() && !(shelf - 1)->entryCount)
+        {
+            (shelf - 1)->height += shelf->height;
+            shelf = mShelves.erase(shelf) - 1;
+        }
+
+        // An empty last shelf goes back to the unassigned space.
+        if (shelf + 1 == mShelves.end())
+        {
+            mShelfTop = shelf->y;
+            mShelves.pop_back();
+        }
+
+        return;
+    }
+
+    // Insert the span in x order, coalescing it with adjacent free spans.
+    auto& spans = shelf->freeSpans;
+
+    auto next = std::lower_bound(spans.begin(), spans.end(), region.x, [](Span const& span, uint32_t x)
+    {
+        return span.x < x;
+    });
+
+    bool joinsPrevious = (next != spans.begin()) && ((next - 1)->x + (next - 1)->width == region.x);
+    bool joinsNext = (next != spans.end()) && (region.x + region.width == next->x);
+
+    if (joinsPrevious && joinsNext)
+    {
+        (next - 1)->width += region.width + next->width;
+        spans.erase(next);
+    }
+    else if (joinsPrevious)
+    {
+        (next - 1)->width += region.width;
+    }
+    else if (joinsNext)
+    {
+        next->x = region.x;
+        next->width += region.width;
+    }
+    else
+    {
+        Span span = { region.x, region.width };
+
+        spans.insert(next, span);
+    }
+}
+
+
+// Makes the whole width of a shelf free.
+void GlyphAtlas::ResetShelf(Shelf& shelf)
+{
+    Span span = { 0, mWidth };
+
+    shelf.entryCount = 0;
+    shelf.freeSpans.assign(1, span);
+}
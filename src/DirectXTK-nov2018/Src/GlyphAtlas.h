@@ -0,0 +1,105 @@
+//--------------------------------------------------------------------------------------
+// File: GlyphAtlas.h
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+
+namespace DirectX
+{
+    // Rectangle allocator for the texture of a dynamic glyph cache. Rectangles are packed onto
+    // horizontal shelves, and the least recently used entries are evicted when the atlas is full.
+    // This only does the bookkeeping, so it has no dependencies on Direct3D or Windows.
+    class GlyphAtlas
+    {
+    public:
+        struct Region
+        {
+            uint32_t x;
+            uint32_t y;
+            uint32_t width;
+            uint32_t height;
+        };
+
+        GlyphAtlas(uint32_t width, uint32_t height);
+
+        GlyphAtlas(GlyphAtlas const&) = delete;
+        GlyphAtlas& operator= (GlyphAtlas const&) = delete;
+
+        // Marks a resident entry as used in the current frame. Returns false if the key is not resident.
+        bool Touch(uint32_t key, Region& region);
+
+        // Allocates a region for a key that is not resident, evicting least recently used entries as
+        // needed. Entries used in the current frame are never evicted, so this fails if they fill the atlas.
+        bool Insert(uint32_t key, uint32_t width, uint32_t height, Region& region);
+
+        // Starts a new frame, which allows the entries used so far to be evicted.
+        void NextFrame() { mFrame++; }
+
+        // Removes all entries.
+        void Clear();
+
+        uint32_t GetWidth() const { return mWidth; }
+        uint32_t GetHeight() const { return mHeight; }
+
+        size_t GetEntryCount() const { return mEntries.size(); }
+        size_t GetShelfCount() const { return mShelves.size(); }
+        uint64_t GetEvictionCount() const { return mEvictionCount; }
+
+    private:
+        // Horizontal run of unused texels on a shelf.
+        struct Span
+        {
+            uint32_t x;
+            uint32_t width;
+        };
+
+        // Row of entries sharing the same height. The free spans are kept sorted by x.
+        struct Shelf
+        {
+            uint32_t y;
+            uint32_t height;
+            uint32_t entryCount;
+            std::vector<Span> freeSpans;
+        };
+
+        struct Entry
+        {
+            Region region;
+            uint64_t frame;
+            std::list<uint32_t>::iterator lruPosition;
+        };
+
+        bool Allocate(uint32_t width, uint32_t height, Region& region);
+        bool EvictLeastRecentlyUsed();
+        void Free(Region const& region);
+        void ResetShelf(Shelf& shelf);
+
+        uint32_t mWidth;
+        uint32_t mHeight;
+
+        // Top of the space below the last shelf, which is not assigned to any shelf yet.
+        uint32_t mShelfTop;
+
+        uint64_t mFrame;
+        uint64_t mEvictionCount;
+
+        // Shelves are sorted by y and cover the atlas from the top down to mShelfTop.
+        std::vector<Shelf> mShelves;
+
+        // Keys in most recently used order.
+        std::list<uint32_t> mLru;
+        std::unordered_map<uint32_t, Entry> mEntries;
+    };
+}
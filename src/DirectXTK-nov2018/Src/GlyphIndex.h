@@ -0,0 +1,133 @@
+//--------------------------------------------------------------------------------------
+// File: GlyphIndex.h
+//
+// Constant time glyph lookup for SpriteFont. This has no Direct3D dependencies, so it can
+// be tested and measured on the CPU alone.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <stdint.h>
+
+
+namespace DirectX
+{
+    // Maps characters to the glyphs of a font, which must be sorted by their Character field.
+    // Glyphs are looked up directly for the first 256 code points, and through a table of
+    // 256-entry pages for the rest of the BMP. Pages without any glyphs are not allocated.
+    // Characters outside the BMP are found by binary search.
+    template<typename TGlyph>
+    class GlyphIndex
+    {
+    public:
+        GlyphIndex()
+          : mGlyphs(nullptr),
+            mGlyphCount(0)
+        {
+            std::fill(std::begin(mLatinGlyphs), std::end(mLatinGlyphs), nullptr);
+        }
+
+        GlyphIndex(GlyphIndex const&) = delete;
+        GlyphIndex& operator= (GlyphIndex const&) = delete;
+
+
+        // Fills the lookup tables. The glyphs must stay in place for as long as the index is used.
+        void Build(_In_reads_(glyphCount) TGlyph const* glyphs, size_t glyphCount)
+        {
+            mGlyphs = glyphs;
+            mGlyphCount = glyphCount;
+
+            std::fill(std::begin(mLatinGlyphs), std::end(mLatinGlyphs), nullptr);
+
+            for (auto& page : mGlyphPages)
+            {
+                page.reset();
+            }
+
+            for (size_t i = 0; i < glyphCount; i++)
+            {
+                uint32_t character = glyphs[i].Character;
+
+                TGlyph const** entry;
+
+                if (character < PageSize)
+                {
+                    entry = &mLatinGlyphs[character];
+                }
+                else if (character < PageSize * PageCount)
+                {
+                    auto& page = mGlyphPages[character / PageSize];
+
+                    if (!page)
+                    {
+                        page.reset(new TGlyph const*[PageSize]);
+
+                        std::fill(page.get(), page.get() + PageSize, nullptr);
+                    }
+
+                    entry = &page[character % PageSize];
+                }
+                else
+                {
+                    // Characters outside the BMP are found by binary search.
+                    continue;
+                }
+
+                // Keep the first of any duplicate glyphs, as a binary search does.
+                if (!*entry)
+                {
+                    *entry = &glyphs[i];
+                }
+            }
+        }
+
+
+        // Looks up the glyph of a character, returning null if it is not in the font.
+        TGlyph const* Find(uint32_t character) const
+        {
+            if (character < PageSize)
+            {
+                return mLatinGlyphs[character];
+            }
+
+            if (character < PageSize * PageCount)
+            {
+                auto& page = mGlyphPages[character / PageSize];
+
+                return page ? page[character % PageSize] : nullptr;
+            }
+
+            auto end = mGlyphs + mGlyphCount;
+
+            auto glyph = std::lower_bound(mGlyphs, end, character, [](TGlyph const& left, uint32_t right)
+            {
+                return left.Character < right;
+            });
+
+            if (glyph != end && glyph->Character == character)
+            {
+                return glyph;
+            }
+
+            return nullptr;
+        }
+
+    private:
+        static const size_t PageSize = 256;
+        static const size_t PageCount = 256;
+
+        TGlyph const* mGlyphs;
+        size_t mGlyphCount;
+
+        TGlyph const* mLatinGlyphs[PageSize];
+        std::unique_ptr<TGlyph const*[]> mGlyphPages[PageCount];
+    };
+}
@@ -0,0 +1,293 @@
+//--------------------------------------------------------------------------------------
+// File: GlyphLayout.h
+//
+// Text decoding, kerning and the glyph layout loop used by SpriteFont. This has no Direct3D
+// dependencies, so it can be tested and measured on the CPU alone.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <wctype.h>
+#include <unordered_map>
+#include <vector>
+
+#if defined(_XM_SSE_INTRINSICS_)
+#include <emmintrin.h>
+#endif
+
+
+namespace DirectX
+{
+    // Text readers return one code point per call to Next, and zero at the end of the string.
+
+    // Reads UTF-16 text, combining surrogate pairs. Unpaired surrogates read as U+FFFD.
+    class Utf16Reader
+    {
+    public:
+        explicit Utf16Reader(_In_z_ wchar_t const* text) : mText(text) {}
+
+        uint32_t Next()
+        {
+            uint32_t character = *mText;
+
+            if (!character)
+                return 0;
+
+            mText++;
+
+            if (character >= 0xD800 && character <= 0xDFFF)
+            {
+                uint32_t low = *mText;
+
+                if (character <= 0xDBFF && low >= 0xDC00 && low <= 0xDFFF)
+                {
+                    mText++;
+
+                    return 0x10000 + ((character - 0xD800) << 10) + (low - 0xDC00);
+                }
+
+                return 0xFFFD;
+            }
+
+            return character;
+        }
+
+    private:
+        wchar_t const* mText;
+    };
+
+
+    // Reads UTF-32 text.
+    class Utf32Reader
+    {
+    public:
+        explicit Utf32Reader(_In_z_ char32_t const* text) : mText(text) {}
+
+        uint32_t Next()
+        {
+            uint32_t character = *mText;
+
+            if (character)
+                mText++;
+
+            return character;
+        }
+
+    private:
+        char32_t const* mText;
+    };
+
+
+    // Decodes UTF-8 text into UTF-32 in a single pass, widening runs of ASCII sixteen bytes at a time.
+    // Malformed sequences decode as U+FFFD. The result lives in a per-thread buffer, which is valid
+    // until the next call on the same thread.
+    inline char32_t const* DecodeUtf8(_In_z_ char const* text)
+    {
+        static thread_local std::vector<char32_t> buffer;
+
+        size_t length = strlen(text);
+
+        buffer.resize(length + 1);
+
+        auto input = reinterpret_cast<uint8_t const*>(text);
+        auto end = input + length;
+        auto output = buffer.data();
+
+        while (input < end)
+        {
+#if defined(_XM_SSE_INTRINSICS_)
+            if (end - input >= 16)
+            {
+                __m128i bytes = _mm_loadu_si128(reinterpret_cast<__m128i const*>(input));
+
+                if (!_mm_movemask_epi8(bytes))
+                {
+                    // All sixteen bytes are ASCII, so zero extend them to 32 bits.
+                    __m128i zero = _mm_setzero_si128();
+                    __m128i low = _mm_unpacklo_epi8(bytes, zero);
+                    __m128i high = _mm_unpackhi_epi8(bytes, zero);
+
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(output), _mm_unpacklo_epi16(low, zero));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 4), _mm_unpackhi_epi16(low, zero));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 8), _mm_unpacklo_epi16(high, zero));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 12), _mm_unpackhi_epi16(high, zero));
+
+                    input += 16;
+                    output += 16;
+                    continue;
+                }
+            }
+#endif
+
+            uint32_t lead = *input++;
+
+            if (lead < 0x80)
+            {
+                *output++ = lead;
+                continue;
+            }
+
+            uint32_t character;
+            uint32_t minimum;
+            size_t trailCount;
+
+            if ((lead & 0xE0) == 0xC0)
+            {
+                character = lead & 0x1F;
+                minimum = 0x80;
+                trailCount = 1;
+            }
+            else if ((lead & 0xF0) == 0xE0)
+            {
+                character = lead & 0x0F;
+                minimum = 0x800;
+                trailCount = 2;
+            }
+            else if ((lead & 0xF8) == 0xF0)
+            {
+                character = lead & 0x07;
+                minimum = 0x10000;
+                trailCount = 3;
+            }
+            else
+            {
+                *output++ = 0xFFFD;
+                continue;
+            }
+
+            size_t trail = 0;
+
+            for (; trail < trailCount && input < end && (*input & 0xC0) == 0x80; trail++, input++)
+            {
+                character = (character << 6) | (*input & 0x3F);
+            }
+
+            // Reject truncated and overlong sequences, surrogates and values beyond the Unicode range.
+            if (trail < trailCount || character < minimum || character > 0x10FFFF || (character >= 0xD800 && character <= 0xDFFF))
+            {
+                character = 0xFFFD;
+            }
+
+            *output++ = character;
+        }
+
+        *output = 0;
+
+        return buffer.data();
+    }
+
+
+    // Same result as iswspace, without a library call for ASCII.
+    inline bool IsWhitespace(uint32_t character)
+    {
+        if (character < 0x80)
+            return character == ' ' || (character >= '\t' && character <= '\r');
+
+        return character <= 0xFFFF && iswspace(static_cast<wchar_t>(character));
+    }
+
+
+    // Kerning adjustments, keyed by the first character in the upper and the second in the lower 32 bits.
+    class KerningTable
+    {
+    public:
+        void Clear()
+        {
+            mPairs.clear();
+        }
+
+        // Sets the adjustment between two characters, replacing any earlier one.
+        void Set(uint32_t first, uint32_t second, float amount)
+        {
+            mPairs[Key(first, second)] = amount;
+        }
+
+        // Looks up the adjustment between two characters, which is zero if there is none.
+        float Get(uint32_t first, uint32_t second) const
+        {
+            auto pair = mPairs.find(Key(first, second));
+
+            return (pair != mPairs.end()) ? pair->second : 0;
+        }
+
+        bool Empty() const
+        {
+            return mPairs.empty();
+        }
+
+    private:
+        static uint64_t Key(uint32_t first, uint32_t second)
+        {
+            return (static_cast<uint64_t>(first) << 32) | second;
+        }
+
+        std::unordered_map<uint64_t, float> mPairs;
+    };
+
+
+    // The core glyph layout algorithm, shared between DrawString and MeasureString. Reads the text
+    // with the given reader, finds each glyph with findGlyph, and calls action with the glyph, its
+    // position and its advance for every character that draws something.
+    template<typename TReader, typename TFindGlyph, typename TAction>
+    void LayOutGlyphs(TReader reader, TFindGlyph findGlyph, KerningTable const& kerningPairs, float lineSpacing, TAction action)
+    {
+        float x = 0;
+        float y = 0;
+
+        // Fonts without kerning never touch the kerning table.
+        bool kerning = !kerningPairs.Empty();
+        uint32_t previous = 0;
+
+        for (uint32_t character = reader.Next(); character; character = reader.Next())
+        {
+            switch (character)
+            {
+                case '\r':
+                    // Skip carriage returns.
+                    continue;
+
+                case '\n':
+                    // New line.
+                    x = 0;
+                    y += lineSpacing;
+                    previous = 0;
+                    break;
+
+                default:
+                    // Output this character.
+                    auto glyph = findGlyph(character);
+
+                    if (kerning && previous)
+                    {
+                        x += kerningPairs.Get(previous, character);
+                    }
+
+                    x += glyph->XOffset;
+
+                    if (x < 0)
+                        x = 0;
+
+                    float advance = glyph->Subrect.right - glyph->Subrect.left + glyph->XAdvance;
+
+                    if (!IsWhitespace(character)
+                        || ((glyph->Subrect.right - glyph->Subrect.left) > 1)
+                        || ((glyph->Subrect.bottom - glyph->Subrect.top) > 1))
+                    {
+                        action(glyph, x, y, advance);
+                    }
+
+                    x += advance;
+                    previous = character;
+                    break;
+            }
+        }
+    }
+}
@@ -0,0 +1,139 @@
+//--------------------------------------------------------------------------------------
+// File: LayoutCache.h
+//
+// Least recently used cache of the text layouts of SpriteFont, keyed by string contents.
+// This has no Direct3D dependencies, so it can be tested on the CPU alone.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <assert.h>
+#include <stddef.h>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+
+namespace DirectX
+{
+    // FNV-1a hash of a string.
+    struct LayoutTextHash
+    {
+        size_t operator()(_In_z_ wchar_t const* text) const
+        {
+            size_t hash = 2166136261u;
+
+            for (wchar_t const* character = text; *character; character++)
+            {
+                hash = (hash ^ static_cast<size_t>(*character)) * 16777619u;
+            }
+
+            return hash;
+        }
+    };
+
+
+    // Keeps its entries in most recently used order. The index is keyed by a hash of the text, so a
+    // lookup does not need to copy the string; collisions evict the older entry.
+    template<typename TLayout, typename THash = LayoutTextHash>
+    class LayoutCache
+    {
+    public:
+        LayoutCache() : mCapacity(0) {}
+
+        // Returns the layout of a string, calling build(layout) to lay it out if it is not cached yet.
+        // The reference is valid until the next call that changes the cache. The capacity must not be zero.
+        template<typename TBuild>
+        TLayout const& Get(_In_z_ wchar_t const* text, TBuild build)
+        {
+            assert(mCapacity > 0);
+
+            size_t hash = THash()(text);
+
+            auto indexEntry = mIndex.find(hash);
+
+            if (indexEntry != mIndex.end())
+            {
+                auto entry = indexEntry->second;
+
+                if (entry->text == text)
+                {
+                    // Move the entry to the front of the list.
+                    mEntries.splice(mEntries.begin(), mEntries, entry);
+
+                    return entry->layout;
+                }
+
+                mEntries.erase(entry);
+                mIndex.erase(indexEntry);
+            }
+
+            // Make room for the new layout.
+            Trim(mCapacity - 1);
+
+            mEntries.emplace_front();
+
+            Entry& cached = mEntries.front();
+
+            cached.text = text;
+            cached.hash = hash;
+
+            build(cached.layout);
+
+            mIndex[hash] = mEntries.begin();
+
+            return cached.layout;
+        }
+
+        // Sets the number of layouts kept, evicting the least recently used ones beyond it. Zero disables the cache.
+        void SetCapacity(size_t count)
+        {
+            mCapacity = count;
+
+            Trim(count);
+        }
+
+        size_t GetCapacity() const
+        {
+            return mCapacity;
+        }
+
+        // Evicts every layout, for when the font changes.
+        void Clear()
+        {
+            Trim(0);
+        }
+
+        size_t Size() const
+        {
+            return mEntries.size();
+        }
+
+    private:
+        struct Entry
+        {
+            std::wstring text;
+            size_t hash;
+            TLayout layout;
+        };
+
+        // Evicts the least recently used layouts until at most count remain.
+        void Trim(size_t count)
+        {
+            while (mEntries.size() > count)
+            {
+                mIndex.erase(mEntries.back().hash);
+                mEntries.pop_back();
+            }
+        }
+
+        size_t mCapacity;
+        std::list<Entry> mEntries;
+        std::unordered_map<size_t, typename std::list<Entry>::iterator> mIndex;
+    };
+}
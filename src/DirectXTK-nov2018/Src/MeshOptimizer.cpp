@@ -0,0 +1,493 @@
+//--------------------------------------------------------------------------------------
+// File: MeshOptimizer.cpp
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "pch.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "MeshOptimizer.h"
+
+#if defined(_DEBUG)
+#include "PlatformHelpers.h"
+#endif
+
+using namespace DirectX;
+
+
+namespace
+{
+    // Scoring parameters from "Linear-Speed Vertex Cache Optimisation", Tom Forsyth, 2006.
+    const size_t MaxCacheSize = 32;
+    const float CacheDecayPower = 1.5f;
+    const float LastTriangleScore = 0.75f;
+    const float ValenceBoostScale = 2.0f;
+    const float ValenceBoostPower = 0.5f;
+
+    // Valences up to this size use a lookup table for their score.
+    const size_t MaxTableValence = 32;
+
+    const uint32_t NoTriangle = uint32_t(-1);
+    const uint32_t NotInCache = uint32_t(-1);
+
+
+    // Precomputed scores for the position of a vertex in the cache and for its number of remaining triangles.
+    class VertexScoreTable
+    {
+    public:
+        VertexScoreTable()
+        {
+            for (size_t i = 0; i < MaxCacheSize; i++)
+            {
+                if (i < 3)
+                {
+                    // The vertices of the last triangle are scored the same, whatever order they were used in.
+                    mCacheScore[i] = LastTriangleScore;
+                }
+                else
+                {
+                    float scaler = 1.0f / (MaxCacheSize - 3);
+
+                    mCacheScore[i] = std::pow(1.0f - (i - 3) * scaler, CacheDecayPower);
+                }
+            }
+
+            mValenceScore[0] = 0;
+
+            for (size_t i = 1; i < MaxTableValence; i++)
+            {
+                mValenceScore[i] = ValenceScore(i);
+            }
+        }
+
+        // Vertices with few triangles left are boosted, so that lone triangles are not left behind.
+        float Score(uint32_t cachePosition, size_t valence) const
+        {
+            if (!valence)
+                return -1.0f;
+
+            float score = (cachePosition == NotInCache) ? 0 : mCacheScore[cachePosition];
+
+            score += (valence < MaxTableValence) ? mValenceScore[valence] : ValenceScore(valence);
+
+            return score;
+        }
+
+    private:
+        static float ValenceScore(size_t valence)
+        {
+            return ValenceBoostScale * std::pow(float(valence), -ValenceBoostPower);
+        }
+
+        float mCacheScore[MaxCacheSize];
+        float mValenceScore[MaxTableValence];
+    };
+
+
+    const VertexScoreTable& GetVertexScoreTable()
+    {
+        static const VertexScoreTable table;
+
+        return table;
+    }
+
+
+    template<typename TIndex>
+    void CheckIndices(_In_reads_(indexCount) TIndex const* indices, size_t indexCount, size_t vertexCount)
+    {
+        if (indexCount % 3)
+            throw std::exception("Index count must be a multiple of 3");
+
+        if (vertexCount > UINT32_MAX)
+            throw std::out_of_range("Too many vertices");
+
+        for (size_t i = 0; i < indexCount; i++)
+        {
+            if (indices[i] >= vertexCount)
+                throw std::out_of_range("Index out of range");
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+// Vertex cache optimization
+//--------------------------------------------------------------------------------------
+
+template<typename TIndex>
+void DirectX::OptimizeVertexCache(TIndex* indices, size_t indexCount, size_t vertexCount)
+{
+    CheckIndices(indices, indexCount, vertexCount);
+
+    size_t triangleCount = indexCount / 3;
+
+    if (triangleCount < 2)
+        return;
+
+    auto const& scoreTable = GetVertexScoreTable();
+
+    // Build the list of triangles using each vertex. liveCount is the number of those not emitted yet,
+    // which are kept at the front of each vertex's list.
+    std::vector<uint32_t> adjacencyOffset(vertexCount + 1);
+    std::vector<uint32_t> liveCount(vertexCount);
+
+    for (size_t i = 0; i < indexCount; i++)
+    {
+        liveCount[indices[i]]++;
+    }
+
+    for (size_t i = 0; i < vertexCount; i++)
+    {
+        adjacencyOffset[i + 1] = adjacencyOffset[i] + liveCount[i];
+    }
+
+    std::vector<uint32_t> adjacency(indexCount);
+
+    {
+        std::vector<uint32_t> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+
+        for (size_t i = 0; i < indexCount; i++)
+        {
+            adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+
+    // Initial scores.
+    std::vector<uint32_t> cachePosition(vertexCount, NotInCache);
+    std::vector<float> vertexScore(vertexCount);
+
+    for (size_t i = 0; i < vertexCount; i++)
+    {
+        vertexScore[i] = scoreTable.Score(NotInCache, liveCount[i]);
+    }
+
+    std::vector<float> triangleScore(triangleCount);
+    std::vector<bool> emitted(triangleCount);
+
+    uint32_t bestTriangle = NoTriangle;
+    float bestScore = -1.0f;
+
+    for (size_t i = 0; i < triangleCount; i++)
+    {
+        triangleScore[i] = vertexScore[indices[i * 3]] + vertexScore[indices[i * 3 + 1]] + vertexScore[indices[i * 3 + 2]];
+
+        if (triangleScore[i] > bestScore)
+        {
+            bestScore = triangleScore[i];
+            bestTriangle = static_cast<uint32_t>(i);
+        }
+    }
+
+    std::vector<TIndex> output;
+    output.reserve(indexCount);
+
+    std::vector<uint32_t> cache;
+    std::vector<uint32_t> newCache;
+
+    cache.reserve(MaxCacheSize + 3);
+    newCache.reserve(MaxCacheSize + 3);
+
+    size_t nextUnemitted = 0;
+
+    for (size_t emittedCount = 0; emittedCount < triangleCount; emittedCount++)
+    {
+        if (bestTriangle == NoTriangle)
+        {
+            // None of the cached vertices have triangles left, so restart from the first triangle not emitted yet.
+            while (emitted[nextUnemitted])
+            {
+                nextUnemitted++;
+            }
+
+            bestTriangle = static_cast<uint32_t>(nextUnemitted);
+        }
+
+        auto triangle = indices + bestTriangle * 3;
+
+        emitted[bestTriangle] = true;
+
+        output.insert(output.end(), triangle, triangle + 3);
+
+        // Remove the triangle from the lists of its vertices.
+        for (size_t i = 0; i < 3; i++)
+        {
+            uint32_t vertex = triangle[i];
+
+            auto begin = adjacency.begin() + adjacencyOffset[vertex];
+            auto end = begin + liveCount[vertex];
+
+            auto position = std::find(begin, end, bestTriangle);
+
+            assert(position != end);
+
+            std::iter_swap(position, end - 1);
+
+            liveCount[vertex]--;
+        }
+
+        // The triangle's vertices move to the front of the cache, pushing the others back.
+        newCache.clear();
+
+        for (size_t i = 0; i < 3; i++)
+        {
+            if (std::find(newCache.begin(), newCache.end(), triangle[i]) == newCache.end())
+            {
+                newCache.push_back(triangle[i]);
+            }
+        }
+
+        for (auto vertex : cache)
+        {
+            if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2])
+            {
+                newCache.push_back(vertex);
+            }
+        }
+
+        // Rescore the vertices that moved, including any that fell out of the cache.
+        for (size_t i = 0; i < newCache.size(); i++)
+        {
+            uint32_t vertex = newCache[i];
+
+            cachePosition[vertex] = (i < MaxCacheSize) ? static_cast<uint32_t>(i) : NotInCache;
+            vertexScore[vertex] = scoreTable.Score(cachePosition[vertex], liveCount[vertex]);
+        }
+
+        // Rescore their triangles, and pick the best one to emit next.
+        bestTriangle = NoTriangle;
+        bestScore = -1.0f;
+
+        for (auto vertex : newCache)
+        {
+            auto begin = adjacency.begin() + adjacencyOffset[vertex];
+            auto end = begin + liveCount[vertex];
+
+            for (auto it = begin; it != end; ++it)
+            {
+                uint32_t t = *it;
+
+                float score = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+
+                triangleScore[t] = score;
+
+                if (score > bestScore)
+                {
+                    bestScore = score;
+                    bestTriangle = t;
+                }
+            }
+        }
+
+        if (newCache.size() > MaxCacheSize)
+        {
+            newCache.resize(MaxCacheSize);
+        }
+
+        std::swap(cache, newCache);
+    }
+
+    std::copy(output.begin(), output.end(), indices);
+}
+
+
+//--------------------------------------------------------------------------------------
+// Vertex fetch optimization
+//--------------------------------------------------------------------------------------
+
+template<typename TIndex>
+size_t DirectX::OptimizeVertexFetch(TIndex* indices, size_t indexCount, size_t vertexCount, uint32_t* remap)
+{
+    CheckIndices(indices, indexCount, vertexCount);
+
+    std::fill(remap, remap + vertexCount, uint32_t(-1));
+
+    uint32_t nextVertex = 0;
+
+    for (size_t i = 0; i < indexCount; i++)
+    {
+        auto& newIndex = remap[indices[i]];
+
+        if (newIndex == uint32_t(-1))
+        {
+            newIndex = nextVertex++;
+        }
+
+        indices[i] = static_cast<TIndex>(newIndex);
+    }
+
+    size_t referencedCount = nextVertex;
+
+    for (size_t i = 0; i < vertexCount; i++)
+    {
+        if (remap[i] == uint32_t(-1))
+        {
+            remap[i] = nextVertex++;
+        }
+    }
+
+    return referencedCount;
+}
+
+
+_Use_decl_annotations_
+void DirectX::RemapVertices(void* vertices, size_t stride, size_t vertexCount, uint32_t const* remap)
+{
+    if (!vertexCount)
+        return;
+
+    auto data = static_cast<uint8_t*>(vertices);
+
+    std::unique_ptr<uint8_t[]> temp(new uint8_t[vertexCount * stride]);
+
+    for (size_t i = 0; i < vertexCount; i++)
+    {
+        assert(remap[i] < vertexCount);
+
+        memcpy(temp.get() + remap[i] * stride, data + i * stride, stride);
+    }
+
+    memcpy(data, temp.get(), vertexCount * stride);
+}
+
+
+//--------------------------------------------------------------------------------------
+// Index ranges
+//--------------------------------------------------------------------------------------
+
+template<typename TIndex>
+void DirectX::OptimizeIndexRanges(TIndex* indices, size_t indexCount, IndexRange const* ranges, size_t rangeCount)
+{
+    std::vector<IndexRange> sorted(ranges, ranges + rangeCount);
+
+    std::sort(sorted.begin(), sorted.end(), [](IndexRange const& a, IndexRange const& b)
+    {
+        return (a.startIndex != b.startIndex) ? (a.startIndex < b.startIndex) : (a.indexCount < b.indexCount);
+    });
+
+    size_t previousEnd = 0;
+
+    for (size_t i = 0; i < sorted.size(); )
+    {
+        auto const& range = sorted[i];
+
+        if (range.startIndex > indexCount || range.indexCount > indexCount - range.startIndex)
+            throw std::out_of_range("Index range out of range");
+
+        size_t end = range.startIndex + range.indexCount;
+
+        // Several parts may draw the same range, which can then be reordered once if none of them needs the original order.
+        bool optimize = true;
+        size_t next = i;
+
+        for (; next < sorted.size() && sorted[next].startIndex == range.startIndex && sorted[next].indexCount == range.indexCount; next++)
+        {
+            optimize &= sorted[next].optimize;
+        }
+
+        bool overlaps = (previousEnd > range.startIndex)
+            || (next < sorted.size() && sorted[next].startIndex < end);
+
+        if (optimize && !overlaps && range.indexCount)
+        {
+            auto first = indices + range.startIndex;
+
+            size_t vertexCount = size_t(*std::max_element(first, first + range.indexCount)) + 1;
+
+            OptimizeVertexCache(first, range.indexCount, vertexCount);
+        }
+
+        previousEnd = std::max(previousEnd, end);
+        i = next;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+// Analysis
+//--------------------------------------------------------------------------------------
+
+template<typename TIndex>
+VertexCacheStatistics DirectX::AnalyzeVertexCache(TIndex const* indices, size_t indexCount, size_t vertexCount, size_t cacheSize)
+{
+    CheckIndices(indices, indexCount, vertexCount);
+
+    if (!cacheSize)
+        throw std::out_of_range("Cache size must not be zero");
+
+    // A vertex is in the FIFO cache if fewer than cacheSize vertices were transformed since it was.
+    std::vector<size_t> transformedAt(vertexCount, 0);
+    std::vector<bool> referenced(vertexCount);
+
+    size_t transformCount = 0;
+    size_t referencedCount = 0;
+
+    for (size_t i = 0; i < indexCount; i++)
+    {
+        TIndex vertex = indices[i];
+
+        if (!referenced[vertex])
+        {
+            referenced[vertex] = true;
+            referencedCount++;
+        }
+
+        if (!transformedAt[vertex] || transformCount - transformedAt[vertex] >= cacheSize)
+        {
+            transformedAt[vertex] = ++transformCount;
+        }
+    }
+
+    VertexCacheStatistics statistics = {};
+
+    statistics.transformCount = transformCount;
+
+    if (indexCount)
+    {
+        statistics.acmr = float(transformCount) / float(indexCount / 3);
+        statistics.atvr = float(transformCount) / float(referencedCount);
+    }
+
+    return statistics;
+}
+
+
+#if defined(_DEBUG)
+template<typename TIndex>
+void DirectX::TraceVertexCacheStatistics(const char* name, TIndex const* original, TIndex const* optimized, size_t indexCount)
+{
+    if (!indexCount || (indexCount % 3))
+        return;
+
+    size_t vertexCount = size_t(*std::max_element(original, original + indexCount)) + 1;
+
+    auto before = AnalyzeVertexCache(original, indexCount, vertexCount);
+    auto after = AnalyzeVertexCache(optimized, indexCount, vertexCount);
+
+    DebugTrace("INFO: %s (%zu triangles) vertex cache ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n",
+        name, indexCount / 3, before.acmr, after.acmr, before.atvr, after.atvr);
+}
+#endif
+
+
+//--------------------------------------------------------------------------------------
+// Instantiations
+//--------------------------------------------------------------------------------------
+#define INSTANTIATE_MESH_OPTIMIZER(TIndex) \
+    template void DirectX::OptimizeVertexCache(TIndex* indices, size_t indexCount, size_t vertexCount); \
+    template size_t DirectX::OptimizeVertexFetch(TIndex* indices, size_t indexCount, size_t vertexCount, uint32_t* remap); \
+    template void DirectX::OptimizeIndexRanges(TIndex* indices, size_t indexCount, IndexRange const* ranges, size_t rangeCount); \
+    template VertexCacheStatistics DirectX::AnalyzeVertexCache(TIndex const* indices, size_t indexCount, size_t vertexCount, size_t cacheSize);
+
+INSTANTIATE_MESH_OPTIMIZER(uint16_t)
+INSTANTIATE_MESH_OPTIMIZER(uint32_t)
+
+#if defined(_DEBUG)
+template void DirectX::TraceVertexCacheStatistics(const char* name, uint16_t const* original, uint16_t const* optimized, size_t indexCount);
+template void DirectX::TraceVertexCacheStatistics(const char* name, uint32_t const* original, uint32_t const* optimized, size_t indexCount);
+#endif
@@ -0,0 +1,85 @@
+//--------------------------------------------------------------------------------------
+// File: MeshOptimizer.h
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+
+namespace DirectX
+{
+    // Size of the FIFO post-transform vertex cache assumed when measuring a mesh.
+    const size_t DefaultVertexCacheSize = 16;
+
+
+    // Results of running an index buffer through a simulated post-transform vertex cache.
+    struct VertexCacheStatistics
+    {
+        size_t transformCount;  // Vertices shaded, which is the number of cache misses.
+        float acmr;             // Average cache miss ratio: transforms per triangle. 0.5 is ideal for large meshes, 3 is the worst case.
+        float atvr;             // Average transform to vertex ratio: transforms per referenced vertex. 1 is ideal.
+    };
+
+
+    // A range of a triangle list index buffer, as drawn by one mesh part.
+    struct IndexRange
+    {
+        size_t startIndex;
+        size_t indexCount;
+        bool optimize;          // False for ranges whose triangle order matters, such as alpha blended parts.
+    };
+
+
+    // Each function is instantiated for uint16_t and uint32_t indices.
+
+    // Reorders the triangles of a triangle list for post-transform vertex cache locality, using Tom Forsyth's
+    // linear-speed algorithm. Each triangle keeps its vertex order, so the winding is unchanged.
+    template<typename TIndex>
+    void OptimizeVertexCache(_Inout_updates_(indexCount) TIndex* indices, size_t indexCount, size_t vertexCount);
+
+    // Computes a remap that orders vertices by their first use, and rewrites the indices to match. Vertices
+    // that are never referenced move to the end. remap[oldIndex] is the new index. Returns the number of referenced vertices.
+    template<typename TIndex>
+    size_t OptimizeVertexFetch(_Inout_updates_(indexCount) TIndex* indices, size_t indexCount, size_t vertexCount, _Out_writes_(vertexCount) uint32_t* remap);
+
+    // Optimizes the ranges of a shared index buffer for the vertex cache. Ranges that overlap another range are
+    // left alone, since reordering one would change the triangles drawn by the other.
+    template<typename TIndex>
+    void OptimizeIndexRanges(_Inout_updates_(indexCount) TIndex* indices, size_t indexCount, _In_reads_(rangeCount) IndexRange const* ranges, size_t rangeCount);
+
+    // Measures a triangle list with a FIFO cache simulator.
+    template<typename TIndex>
+    VertexCacheStatistics AnalyzeVertexCache(_In_reads_(indexCount) TIndex const* indices, size_t indexCount, size_t vertexCount, size_t cacheSize = DefaultVertexCacheSize);
+
+
+#if defined(_DEBUG)
+    // Traces the vertex cache statistics of an index buffer before and after the loaders optimized it.
+    template<typename TIndex>
+    void TraceVertexCacheStatistics(_In_z_ const char* name, _In_reads_(indexCount) TIndex const* original, _In_reads_(indexCount) TIndex const* optimized, size_t indexCount);
+#endif
+
+
+    // Moves vertices of the given stride to the positions computed by OptimizeVertexFetch.
+    void RemapVertices(_Inout_updates_bytes_(vertexCount * stride) void* vertices, size_t stride, size_t vertexCount, _In_reads_(vertexCount) uint32_t const* remap);
+
+
+    // Runs the vertex cache and vertex fetch passes over a vertex and index collection.
+    template<typename TVertexCollection, typename TIndexCollection>
+    void OptimizeMesh(TVertexCollection& vertices, TIndexCollection& indices)
+    {
+        OptimizeVertexCache(indices.data(), indices.size(), vertices.size());
+
+        std::vector<uint32_t> remap(vertices.size());
+
+        OptimizeVertexFetch(indices.data(), indices.size(), vertices.size(), remap.data());
+
+        RemapVertices(vertices.data(), sizeof(typename TVertexCollection::value_type), vertices.size(), remap.data());
+    }
+}
@@ -0,0 +1,518 @@
+//--------------------------------------------------------------------------------------
+// File: MeshSimplifier.cpp
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "pch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_set>
+#include <vector>
+
+#include "MeshSimplifier.h"
+
+using namespace DirectX;
+
+
+namespace
+{
+    // Border edges are constrained by a plane perpendicular to the surface, weighted this much more than the
+    // surface itself, so that open boundaries keep their shape.
+    const double BorderWeight = 10.0;
+
+    // Collapses may rotate a triangle's normal by at most acos of this.
+    const double MinNormalAlignment = 0.25;
+
+    // Each pass performs the collapses costing up to this much more than the one needed to reach the target.
+    const double PassErrorSlack = 1.5;
+
+
+    struct Vector3
+    {
+        double x, y, z;
+    };
+
+    inline Vector3 Subtract(Vector3 const& a, Vector3 const& b)
+    {
+        return { a.x - b.x, a.y - b.y, a.z - b.z };
+    }
+
+    inline Vector3 Cross(Vector3 const& a, Vector3 const& b)
+    {
+        return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+    }
+
+    inline double Dot(Vector3 const& a, Vector3 const& b)
+    {
+        return a.x * b.x + a.y * b.y + a.z * b.z;
+    }
+
+    inline double Length(Vector3 const& a)
+    {
+        return std::sqrt(Dot(a, a));
+    }
+
+
+    // Sum of squared distances to a set of weighted planes.
+    struct Quadric
+    {
+        double a2, ab, ac, ad;
+        double b2, bc, bd;
+        double c2, cd;
+        double d2;
+        double weight;
+
+        void AddPlane(Vector3 const& normal, double d, double planeWeight)
+        {
+            double a = normal.x;
+            double b = normal.y;
+            double c = normal.z;
+
+            a2 += a * a * planeWeight;
+            ab += a * b * planeWeight;
+            ac += a * c * planeWeight;
+            ad += a * d * planeWeight;
+            b2 += b * b * planeWeight;
+            bc += b * c * planeWeight;
+            bd += b * d * planeWeight;
+            c2 += c * c * planeWeight;
+            cd += c * d * planeWeight;
+            d2 += d * d * planeWeight;
+            weight += planeWeight;
+        }
+
+        void Add(Quadric const& other)
+        {
+            a2 += other.a2;
+            ab += other.ab;
+            ac += other.ac;
+            ad += other.ad;
+            b2 += other.b2;
+            bc += other.bc;
+            bd += other.bd;
+            c2 += other.c2;
+            cd += other.cd;
+            d2 += other.d2;
+            weight += other.weight;
+        }
+
+        double Evaluate(Vector3 const& p) const
+        {
+            double result = a2 * p.x * p.x + b2 * p.y * p.y + c2 * p.z * p.z + d2
+                + 2 * (ab * p.x * p.y + ac * p.x * p.z + bc * p.y * p.z)
+                + 2 * (ad * p.x + bd * p.y + cd * p.z);
+
+            // Rounding can take the result slightly below zero.
+            return std::max(result, 0.0);
+        }
+    };
+
+
+    struct Collapse
+    {
+        uint32_t from;
+        uint32_t to;
+        double cost;
+        double error;
+    };
+
+
+    inline uint64_t EdgeKey(uint32_t a, uint32_t b)
+    {
+        return (uint64_t(a) << 32) | b;
+    }
+
+
+    // Finds the vertices which share their position with another vertex. Returns, for each vertex,
+    // the lowest numbered vertex at the same position.
+    std::vector<uint32_t> WeldPositions(std::vector<Vector3> const& positions)
+    {
+        size_t vertexCount = positions.size();
+
+        std::vector<uint32_t> order(vertexCount);
+
+        for (size_t i = 0; i < vertexCount; i++)
+        {
+            order[i] = static_cast<uint32_t>(i);
+        }
+
+        auto less = [&](uint32_t a, uint32_t b)
+        {
+            auto const& pa = positions[a];
+            auto const& pb = positions[b];
+
+            if (pa.x != pb.x) return pa.x < pb.x;
+            if (pa.y != pb.y) return pa.y < pb.y;
+            if (pa.z != pb.z) return pa.z < pb.z;
+
+            return a < b;
+        };
+
+        std::sort(order.begin(), order.end(), less);
+
+        std::vector<uint32_t> welded(vertexCount);
+
+        for (size_t i = 0; i < vertexCount; )
+        {
+            auto const& p = positions[order[i]];
+
+            size_t end = i + 1;
+
+            while (end < vertexCount && positions[order[end]].x == p.x && positions[order[end]].y == p.y && positions[order[end]].z == p.z)
+            {
+                end++;
+            }
+
+            for (size_t j = i; j < end; j++)
+            {
+                welded[order[j]] = order[i];
+            }
+
+            i = end;
+        }
+
+        return welded;
+    }
+}
+
+
+template<typename TIndex>
+size_t DirectX::SimplifyMesh(TIndex* destination, TIndex const* indices, size_t indexCount,
+                             XMFLOAT3 const* positions, size_t positionStride, size_t vertexCount,
+                             size_t targetIndexCount, float* resultError)
+{
+    if (indexCount % 3)
+        throw std::exception("Index count must be a multiple of 3");
+
+    if (vertexCount > UINT32_MAX)
+        throw std::out_of_range("Too many vertices");
+
+    for (size_t i = 0; i < indexCount; i++)
+    {
+        if (indices[i] >= vertexCount)
+            throw std::out_of_range("Index out of range");
+    }
+
+    std::vector<uint32_t> current(indices, indices + indexCount);
+
+    std::vector<Vector3> points(vertexCount);
+
+    for (size_t i = 0; i < vertexCount; i++)
+    {
+        auto position = reinterpret_cast<XMFLOAT3 const*>(reinterpret_cast<uint8_t const*>(positions) + i * positionStride);
+
+        points[i] = { position->x, position->y, position->z };
+    }
+
+    // Vertices sharing a position are locked, since moving one would open a crack.
+    std::vector<uint32_t> welded = WeldPositions(points);
+    std::vector<bool> locked(vertexCount);
+
+    for (size_t i = 0; i < vertexCount; i++)
+    {
+        if (welded[i] != i)
+        {
+            locked[i] = true;
+            locked[welded[i]] = true;
+        }
+    }
+
+    // Edges used by only one triangle, looking at welded positions, are borders.
+    std::unordered_set<uint64_t> directedEdges;
+
+    directedEdges.reserve(indexCount);
+
+    for (size_t i = 0; i < indexCount; i += 3)
+    {
+        for (size_t j = 0; j < 3; j++)
+        {
+            directedEdges.insert(EdgeKey(welded[current[i + j]], welded[current[i + (j + 1) % 3]]));
+        }
+    }
+
+    auto isBorderEdge = [&](uint32_t a, uint32_t b)
+    {
+        return directedEdges.find(EdgeKey(welded[b], welded[a])) == directedEdges.end();
+    };
+
+    // Accumulate the planes of the triangles around each vertex, weighted by area.
+    std::vector<Quadric> quadrics(vertexCount, Quadric{});
+    std::vector<bool> border(vertexCount);
+
+    for (size_t i = 0; i < indexCount; i += 3)
+    {
+        auto const& p0 = points[current[i]];
+        auto const& p1 = points[current[i + 1]];
+        auto const& p2 = points[current[i + 2]];
+
+        Vector3 normal = Cross(Subtract(p1, p0), Subtract(p2, p0));
+
+        double length = Length(normal);
+
+        if (length <= 0)
+            continue;
+
+        normal = { normal.x / length, normal.y / length, normal.z / length };
+
+        double area = length * 0.5;
+
+        for (size_t j = 0; j < 3; j++)
+        {
+            quadrics[current[i + j]].AddPlane(normal, -Dot(normal, p0), area);
+        }
+
+        for (size_t j = 0; j < 3; j++)
+        {
+            uint32_t a = current[i + j];
+            uint32_t b = current[i + (j + 1) % 3];
+
+            if (!isBorderEdge(a, b))
+                continue;
+
+            border[a] = true;
+            border[b] = true;
+
+            Vector3 edge = Subtract(points[b], points[a]);
+            Vector3 borderNormal = Cross(edge, normal);
+
+            double borderLength = Length(borderNormal);
+
+            if (borderLength <= 0)
+                continue;
+
+            borderNormal = { borderNormal.x / borderLength, borderNormal.y / borderLength, borderNormal.z / borderLength };
+
+            double borderPlaneWeight = Dot(edge, edge) * BorderWeight;
+            double d = -Dot(borderNormal, points[a]);
+
+            quadrics[a].AddPlane(borderNormal, d, borderPlaneWeight);
+            quadrics[b].AddPlane(borderNormal, d, borderPlaneWeight);
+        }
+    }
+
+    size_t targetTriangleCount = targetIndexCount / 3;
+
+    double maxError = 0;
+
+    std::vector<uint32_t> adjacencyOffset(vertexCount + 1);
+    std::vector<uint32_t> adjacency;
+    std::vector<Collapse> collapses;
+    std::vector<uint32_t> remap(vertexCount);
+    std::vector<bool> touched(vertexCount);
+
+    while (current.size() / 3 > targetTriangleCount)
+    {
+        size_t triangleCount = current.size() / 3;
+
+        // Triangles around each vertex.
+        std::fill(adjacencyOffset.begin(), adjacencyOffset.end(), 0);
+
+        for (auto index : current)
+        {
+            adjacencyOffset[index + 1]++;
+        }
+
+        for (size_t i = 0; i < vertexCount; i++)
+        {
+            adjacencyOffset[i + 1] += adjacencyOffset[i];
+        }
+
+        adjacency.resize(current.size());
+
+        {
+            std::vector<uint32_t> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+
+            for (size_t i = 0; i < current.size(); i++)
+            {
+                adjacency[fill[current[i]]++] = static_cast<uint32_t>(i / 3);
+            }
+        }
+
+        // Find the cheapest collapse for each vertex that can move.
+        collapses.clear();
+
+        {
+            std::vector<Collapse> best(vertexCount, Collapse{ 0, 0, -1.0, 0 });
+
+            for (size_t i = 0; i < current.size(); i += 3)
+            {
+                for (size_t j = 0; j < 3; j++)
+                {
+                    uint32_t a = current[i + j];
+                    uint32_t b = current[i + (j + 1) % 3];
+
+                    bool borderEdge = isBorderEdge(a, b) || isBorderEdge(b, a);
+
+                    uint32_t ends[2][2] = { { a, b }, { b, a } };
+
+                    for (auto const& end : ends)
+                    {
+                        uint32_t from = end[0];
+                        uint32_t to = end[1];
+
+                        // Border vertices may only slide along the border.
+                        if (locked[from] || (border[from] && !borderEdge))
+                            continue;
+
+                        Quadric q = quadrics[from];
+                        q.Add(quadrics[to]);
+
+                        double cost = q.Evaluate(points[to]);
+
+                        auto& candidate = best[from];
+
+                        if (candidate.cost < 0 || cost < candidate.cost)
+                        {
+                            candidate.from = from;
+                            candidate.to = to;
+                            candidate.cost = cost;
+                            candidate.error = (q.weight > 0) ? std::sqrt(cost / q.weight) : 0;
+                        }
+                    }
+                }
+            }
+
+            for (auto const& candidate : best)
+            {
+                if (candidate.cost >= 0)
+                {
+                    collapses.push_back(candidate);
+                }
+            }
+        }
+
+        if (collapses.empty())
+            break;
+
+        std::sort(collapses.begin(), collapses.end(), [](Collapse const& a, Collapse const& b)
+        {
+            return a.cost < b.cost;
+        });
+
+        // An interior collapse removes two triangles, so about half as many collapses as excess triangles are needed.
+        size_t goal = std::min((triangleCount - targetTriangleCount + 1) / 2, collapses.size()) - 1;
+        double costLimit = collapses[goal].cost * PassErrorSlack;
+
+        for (size_t i = 0; i < vertexCount; i++)
+        {
+            remap[i] = static_cast<uint32_t>(i);
+        }
+
+        std::fill(touched.begin(), touched.end(), false);
+
+        size_t removedTriangles = 0;
+        size_t collapseCount = 0;
+
+        for (auto const& collapse : collapses)
+        {
+            if (collapse.cost > costLimit || triangleCount - removedTriangles <= targetTriangleCount)
+                break;
+
+            uint32_t from = collapse.from;
+            uint32_t to = collapse.to;
+
+            // Each vertex takes part in at most one collapse per pass, so the adjacency stays valid.
+            if (touched[from] || touched[to])
+                continue;
+
+            // Reject collapses that fold triangles over.
+            bool flips = false;
+            size_t removed = 0;
+
+            for (uint32_t k = adjacencyOffset[from]; k < adjacencyOffset[from + 1] && !flips; k++)
+            {
+                auto triangle = &current[adjacency[k] * 3];
+
+                uint32_t corners[3] = { remap[triangle[0]], remap[triangle[1]], remap[triangle[2]] };
+
+                if (corners[0] == to || corners[1] == to || corners[2] == to)
+                {
+                    removed++;
+                    continue;
+                }
+
+                Vector3 before[3];
+                Vector3 after[3];
+
+                for (size_t j = 0; j < 3; j++)
+                {
+                    before[j] = points[corners[j]];
+                    after[j] = (corners[j] == from) ? points[to] : points[corners[j]];
+                }
+
+                Vector3 n0 = Cross(Subtract(before[1], before[0]), Subtract(before[2], before[0]));
+                Vector3 n1 = Cross(Subtract(after[1], after[0]), Subtract(after[2], after[0]));
+
+                if (Dot(n0, n1) <= MinNormalAlignment * Length(n0) * Length(n1))
+                {
+                    flips = true;
+                }
+            }
+
+            if (flips)
+                continue;
+
+            remap[from] = to;
+            quadrics[to].Add(quadrics[from]);
+
+            touched[from] = true;
+            touched[to] = true;
+
+            maxError = std::max(maxError, collapse.error);
+
+            removedTriangles += removed;
+            collapseCount++;
+        }
+
+        if (!collapseCount)
+            break;
+
+        // Apply the collapses and drop the triangles that became degenerate.
+        size_t write = 0;
+
+        for (size_t i = 0; i < current.size(); i += 3)
+        {
+            uint32_t a = remap[current[i]];
+            uint32_t b = remap[current[i + 1]];
+            uint32_t c = remap[current[i + 2]];
+
+            if (a == b || b == c || c == a)
+                continue;
+
+            current[write++] = a;
+            current[write++] = b;
+            current[write++] = c;
+        }
+
+        current.resize(write);
+    }
+
+    for (size_t i = 0; i < current.size(); i++)
+    {
+        destination[i] = static_cast<TIndex>(current[i]);
+    }
+
+    if (resultError)
+    {
+        *resultError = static_cast<float>(maxError);
+    }
+
+    return current.size();
+}
+
+
+//--------------------------------------------------------------------------------------
+// Instantiations
+//--------------------------------------------------------------------------------------
+#define INSTANTIATE_MESH_SIMPLIFIER(TIndex) \
+    template size_t DirectX::SimplifyMesh(TIndex* destination, TIndex const* indices, size_t indexCount, \
+                                          XMFLOAT3 const* positions, size_t positionStride, size_t vertexCount, \
+                                          size_t targetIndexCount, float* resultError);
+
+INSTANTIATE_MESH_SIMPLIFIER(uint16_t)
+INSTANTIATE_MESH_SIMPLIFIER(uint32_t)
@@ -0,0 +1,34 @@
+//--------------------------------------------------------------------------------------
+// File: MeshSimplifier.h
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <DirectXMath.h>
+
+#include <stdint.h>
+
+
+namespace DirectX
+{
+    // Simplifies a triangle list by quadric error metric edge collapses (Garland and Heckbert, 1997). Each vertex is
+    // collapsed onto one of its neighbors, so the result still indexes the original vertex data. Vertices that share
+    // their position with another vertex, such as those along texture seams, stay in place so the surface does not crack.
+    //
+    // Writes at most indexCount indices to destination and returns how many were written. resultError receives the
+    // largest root mean square distance of a collapsed vertex from the planes of the triangles merged into it, weighted
+    // by area, in the units of the positions. It measures the typical deviation of the surface, and single vertices
+    // of the original mesh can lie further away.
+    //
+    // Instantiated for uint16_t and uint32_t indices.
+    template<typename TIndex>
+    size_t SimplifyMesh(_Out_writes_(indexCount) TIndex* destination,
+                        _In_reads_(indexCount) TIndex const* indices, size_t indexCount,
+                        _In_reads_bytes_(vertexCount * positionStride) XMFLOAT3 const* positions, size_t positionStride, size_t vertexCount,
+                        size_t targetIndexCount, _Out_opt_ float* resultError = nullptr);
+}
@@ -14,6 +14,8 @@
 #include "DirectXHelpers.h"
 #include "Effects.h"
 #include "PlatformHelpers.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
 
 using namespace DirectX;
 
@@ -21,6 +23,98 @@ using namespace DirectX;
 #error Model requires RTTI
 #endif
 
+namespace
+{
+    // Each level of detail aims for this fraction of the triangles of the one before.
+    const float LevelOfDetailReduction = 0.5f;
+
+    // Simplification stops once a level keeps more than this fraction of the triangles of the one before.
+    const float MinLevelOfDetailReduction = 0.9f;
+
+
+    template<typename TIndex>
+    void BuildLevelsOfDetail(
+        _In_ ID3D11Device* d3dDevice,
+        ModelMeshPart& part,
+        _In_ TIndex const* indices,
+        _In_reads_bytes_(vertexCount * positionStride) XMFLOAT3 const* positions,
+        size_t positionStride,
+        size_t vertexCount,
+        size_t levelCount)
+    {
+        if (!d3dDevice || !indices || !positions)
+            throw std::exception("Device, indices, and positions cannot be null");
+
+        if (part.primitiveType != D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST)
+            throw std::exception("Levels of detail require a triangle list");
+
+        if (part.indexFormat != ((sizeof(TIndex) == sizeof(uint32_t)) ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT))
+            throw std::exception("Index type does not match the mesh part index format");
+
+        part.lodIndexBuffer.Reset();
+        part.levelsOfDetail.clear();
+
+        // Each level is simplified from the one before, so its error is estimated by the sum of the errors so far.
+        std::vector<TIndex> lodIndices;
+        std::vector<TIndex> previous(indices, indices + part.indexCount);
+        std::vector<TIndex> next;
+
+        float error = 0;
+
+        for (size_t level = 0; level < levelCount; ++level)
+        {
+            size_t targetIndexCount = static_cast<size_t>(float(previous.size() / 3) * LevelOfDetailReduction) * 3;
+
+            next.resize(previous.size());
+
+            float levelError;
+            size_t count = SimplifyMesh(next.data(), previous.data(), previous.size(), positions, positionStride, vertexCount, targetIndexCount, &levelError);
+
+            if (!count || float(count) > float(previous.size()) * MinLevelOfDetailReduction)
+                break;
+
+            next.resize(count);
+
+            OptimizeVertexCache(next.data(), next.size(), vertexCount);
+
+            error += levelError;
+
+            ModelMeshPart::LevelOfDetail lod;
+            lod.indexCount = static_cast<uint32_t>(count);
+            lod.startIndex = static_cast<uint32_t>(lodIndices.size());
+            lod.error = error;
+
+            part.levelsOfDetail.push_back(lod);
+
+            lodIndices.insert(lodIndices.end(), next.begin(), next.end());
+
+            std::swap(previous, next);
+        }
+
+        if (lodIndices.empty())
+            return;
+
+        uint64_t sizeInBytes = uint64_t(lodIndices.size()) * sizeof(TIndex);
+
+        if (sizeInBytes > uint64_t(D3D11_REQ_RESOURCE_SIZE_IN_MEGABYTES_EXPRESSION_A_TERM * 1024u * 1024u))
+            throw std::exception("IB too large for DirectX 11");
+
+        D3D11_BUFFER_DESC desc = {};
+        desc.Usage = D3D11_USAGE_DEFAULT;
+        desc.ByteWidth = static_cast<UINT>(sizeInBytes);
+        desc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+
+        D3D11_SUBRESOURCE_DATA initData = {};
+        initData.pSysMem = lodIndices.data();
+
+        ThrowIfFailed(
+            d3dDevice->CreateBuffer(&desc, &initData, part.lodIndexBuffer.ReleaseAndGetAddressOf())
+        );
+
+        SetDebugObjectName(part.lodIndexBuffer.Get(), "ModelLOD");
+    }
+}
+
 //--------------------------------------------------------------------------------------
 // ModelMeshPart
 //--------------------------------------------------------------------------------------
@@ -49,6 +143,21 @@ void ModelMeshPart::Draw(
     ID3D11InputLayout* iinputLayout,
     std::function<void()> setCustomState) const
 {
+    DrawLevelOfDetail(deviceContext, ieffect, iinputLayout, 0, setCustomState);
+}
+
+
+_Use_decl_annotations_
+void ModelMeshPart::DrawLevelOfDetail(
+    ID3D11DeviceContext* deviceContext,
+    IEffect* ieffect,
+    ID3D11InputLayout* iinputLayout,
+    size_t level,
+    std::function<void()> setCustomState) const
+{
+    if (level > levelsOfDetail.size())
+        throw std::out_of_range("Level of detail out of range");
+
     deviceContext->IASetInputLayout(iinputLayout);
 
     auto vb = vertexBuffer.Get();
@@ -56,8 +165,22 @@ void ModelMeshPart::Draw(
     UINT vbOffset = 0;
     deviceContext->IASetVertexBuffers(0, 1, &vb, &vbStride, &vbOffset);
 
+    // Levels of detail index the same vertex buffer from their own index buffer.
+    UINT drawIndexCount = indexCount;
+    UINT drawStartIndex = startIndex;
+    ID3D11Buffer* ib = indexBuffer.Get();
+
+    if (level > 0)
+    {
+        auto& lod = levelsOfDetail[level - 1];
+
+        drawIndexCount = lod.indexCount;
+        drawStartIndex = lod.startIndex;
+        ib = lodIndexBuffer.Get();
+    }
+
     // Note that if indexFormat is DXGI_FORMAT_R32_UINT, this model mesh part requires a Feature Level 9.2 or greater device
-    deviceContext->IASetIndexBuffer(indexBuffer.Get(), indexFormat, 0);
+    deviceContext->IASetIndexBuffer(ib, indexFormat, 0);
 
     assert(ieffect != nullptr);
     ieffect->Apply(deviceContext);
@@ -71,7 +194,36 @@ void ModelMeshPart::Draw(
     // Draw the primitive.
     deviceContext->IASetPrimitiveTopology(primitiveType);
 
-    deviceContext->DrawIndexed(indexCount, startIndex, vertexOffset);
+    deviceContext->DrawIndexed(drawIndexCount, drawStartIndex, vertexOffset);
+}
+
+
+size_t ModelMeshPart::SelectLevelOfDetail(float maxError) const
+{
+    size_t level = 0;
+
+    while (level < levelsOfDetail.size() && levelsOfDetail[level].error <= maxError)
+    {
+        ++level;
+    }
+
+    return level;
+}
+
+
+_Use_decl_annotations_
+void ModelMeshPart::CreateLevelsOfDetail(ID3D11Device* d3dDevice, const uint16_t* indices,
+    const XMFLOAT3* positions, size_t positionStride, size_t vertexCount, size_t levelCount)
+{
+    BuildLevelsOfDetail(d3dDevice, *this, indices, positions, positionStride, vertexCount, levelCount);
+}
+
+
+_Use_decl_annotations_
+void ModelMeshPart::CreateLevelsOfDetail(ID3D11Device* d3dDevice, const uint32_t* indices,
+    const XMFLOAT3* positions, size_t positionStride, size_t vertexCount, size_t levelCount)
+{
+    BuildLevelsOfDetail(d3dDevice, *this, indices, positions, positionStride, vertexCount, levelCount);
 }
 
 
@@ -172,7 +324,8 @@ void ModelMeshPart::ModifyEffect(ID3D11Device* d3dDevice, std::shared_ptr<IEffec
 
 ModelMesh::ModelMesh() noexcept :
     ccw(true),
-    pmalpha(true)
+    pmalpha(true),
+    lodScreenError(0.001f)
 {
 }
 
@@ -245,6 +398,39 @@ void XM_CALLCONV ModelMesh::Draw(
 {
     assert(deviceContext != nullptr);
 
+    // Convert the allowed screen error into model units, at the point of the bounding sphere nearest the camera.
+    float maxError = 0;
+
+    if (lodScreenError > 0)
+    {
+        XMMATRIX worldView = XMMatrixMultiply(world, view);
+
+        float scaleSq = std::max(std::max(
+            XMVectorGetX(XMVector3LengthSq(worldView.r[0])),
+            XMVectorGetX(XMVector3LengthSq(worldView.r[1]))),
+            XMVectorGetX(XMVector3LengthSq(worldView.r[2])));
+
+        float scale = sqrtf(scaleSq);
+
+        // The viewport is two units high after projection.
+        float viewportScale = 0.5f * XMVectorGetY(projection.r[1]) * scale;
+
+        if (XMVectorGetW(projection.r[2]) != 0)
+        {
+            // Perspective projection, which divides by distance.
+            XMVECTOR center = XMVector3Transform(XMLoadFloat3(&boundingSphere.Center), worldView);
+
+            float distance = fabsf(XMVectorGetZ(center)) - boundingSphere.Radius * scale;
+
+            viewportScale = (distance > 0) ? viewportScale / distance : 0;
+        }
+
+        if (viewportScale > 0)
+        {
+            maxError = lodScreenError / viewportScale;
+        }
+    }
+
     for (auto it = meshParts.cbegin(); it != meshParts.cend(); ++it)
     {
         auto part = (*it).get();
@@ -262,7 +448,9 @@ void XM_CALLCONV ModelMesh::Draw(
             imatrices->SetMatrices(world, view, projection);
         }
 
-        part->Draw(deviceContext, part->effect.get(), part->inputLayout.Get(), setCustomState);
+        size_t level = part->SelectLevelOfDetail(maxError);
+
+        part->DrawLevelOfDetail(deviceContext, part->effect.get(), part->inputLayout.Get(), level, setCustomState);
     }
 }
 
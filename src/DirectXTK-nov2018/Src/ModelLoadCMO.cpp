@@ -17,6 +17,7 @@
 #include "DirectXHelpers.h"
 #include "PlatformHelpers.h"
 #include "BinaryReader.h"
+#include "MeshOptimizer.h"
 
 using namespace DirectX;
 using Microsoft::WRL::ComPtr;
@@ -254,7 +255,7 @@ namespace
 //======================================================================================
 
 _Use_decl_annotations_
-std::unique_ptr<Model> DirectX::Model::CreateFromCMO(ID3D11Device* d3dDevice, const uint8_t* meshData, size_t dataSize, IEffectFactory& fxFactory, bool ccw, bool pmalpha)
+std::unique_ptr<Model> DirectX::Model::CreateFromCMO(ID3D11Device* d3dDevice, const uint8_t* meshData, size_t dataSize, IEffectFactory& fxFactory, bool ccw, bool pmalpha, size_t lodCount)
 {
     if (!InitOnceExecuteOnce(&g_InitOnce, InitializeDecl, nullptr, nullptr))
         throw std::exception("One-time initialization failed");
@@ -439,14 +440,54 @@ std::unique_ptr<Model> DirectX::Model::CreateFromCMO(ID3D11Device* d3dDevice, co
             ib.nIndices = *nIndexes;
             ib.ptr = indexes;
             ibData.emplace_back(ib);
+        }
+
+        assert(ibData.size() == *nIBs);
+
+        // Reorder the triangles of opaque submeshes for the post-transform vertex cache. Alpha blended
+        // submeshes keep their authored order, which affects how they blend.
+        std::vector<std::vector<USHORT>> optimizedIBs;
+        optimizedIBs.resize(*nIBs);
+
+        for (UINT j = 0; j < *nIBs; ++j)
+        {
+            std::vector<IndexRange> ranges;
+
+            for (UINT k = 0; k < *nSubmesh; ++k)
+            {
+                auto& sm = subMesh[k];
+
+                if (sm.IndexBufferIndex != j)
+                    continue;
+
+                if (sm.MaterialIndex >= materials.size())
+                    throw std::exception("Invalid submesh found\n");
+
+                IndexRange range;
+                range.startIndex = sm.StartIndex;
+                range.indexCount = size_t(sm.PrimCount) * 3;
+                range.optimize = !(materials[sm.MaterialIndex].pMaterial->Diffuse.w < 1);
+                ranges.emplace_back(range);
+            }
+
+            auto& indices = optimizedIBs[j];
+            indices.assign(ibData[j].ptr, ibData[j].ptr + ibData[j].nIndices);
+
+            OptimizeIndexRanges(indices.data(), indices.size(), ranges.data(), ranges.size());
+
+        #ifdef _DEBUG
+            TraceVertexCacheStatistics("CMO index buffer", ibData[j].ptr, indices.data(), indices.size());
+        #endif
+
+            ibData[j].ptr = indices.data();
 
             D3D11_BUFFER_DESC desc = {};
             desc.Usage = D3D11_USAGE_DEFAULT;
-            desc.ByteWidth = static_cast<UINT>(ibBytes);
+            desc.ByteWidth = static_cast<UINT>(indices.size() * sizeof(USHORT));
             desc.BindFlags = D3D11_BIND_INDEX_BUFFER;
 
             D3D11_SUBRESOURCE_DATA initData = {};
-            initData.pSysMem = indexes;
+            initData.pSysMem = indices.data();
 
             ThrowIfFailed(
                 d3dDevice->CreateBuffer(&desc, &initData, &ibs[j])
@@ -455,7 +496,6 @@ std::unique_ptr<Model> DirectX::Model::CreateFromCMO(ID3D11Device* d3dDevice, co
             SetDebugObjectName(ibs[j].Get(), "ModelCMO");
         }
 
-        assert(ibData.size() == *nIBs);
         assert(ibs.size() == *nIBs);
 
         // Vertex buffers
@@ -857,6 +897,18 @@ std::unique_ptr<Model> DirectX::Model::CreateFromCMO(ID3D11Device* d3dDevice, co
             part->vbDecl = enableSkinning ? g_vbdeclSkinning : g_vbdecl;
 
             mesh->meshParts.emplace_back(part);
+
+            if (lodCount > 0)
+            {
+                auto& ib = ibData[sm.IndexBufferIndex];
+                auto& vb = vbData[sm.VertexBufferIndex];
+
+                if (sm.StartIndex > ib.nIndices || part->indexCount > ib.nIndices - sm.StartIndex)
+                    throw std::exception("Invalid submesh found\n");
+
+                part->CreateLevelsOfDetail(d3dDevice, ib.ptr + sm.StartIndex,
+                    &vb.ptr->position, sizeof(VertexPositionNormalTangentColorTexture), vb.nVerts, lodCount);
+            }
         }
 
         model->meshes.emplace_back(mesh);
@@ -868,7 +920,7 @@ std::unique_ptr<Model> DirectX::Model::CreateFromCMO(ID3D11Device* d3dDevice, co
 
 //--------------------------------------------------------------------------------------
 _Use_decl_annotations_
-std::unique_ptr<Model> DirectX::Model::CreateFromCMO(ID3D11Device* d3dDevice, const wchar_t* szFileName, IEffectFactory& fxFactory, bool ccw, bool pmalpha)
+std::unique_ptr<Model> DirectX::Model::CreateFromCMO(ID3D11Device* d3dDevice, const wchar_t* szFileName, IEffectFactory& fxFactory, bool ccw, bool pmalpha, size_t lodCount)
 {
     size_t dataSize = 0;
     std::unique_ptr<uint8_t[]> data;
@@ -879,7 +931,7 @@ std::unique_ptr<Model> DirectX::Model::CreateFromCMO(ID3D11Device* d3dDevice, co
         throw std::exception("CreateFromCMO");
     }
 
-    auto model = CreateFromCMO(d3dDevice, data.get(), dataSize, fxFactory, ccw, pmalpha);
+    auto model = CreateFromCMO(d3dDevice, data.get(), dataSize, fxFactory, ccw, pmalpha, lodCount);
 
     model->name = szFileName;
 
@@ -16,6 +16,7 @@
 #include "DirectXHelpers.h"
 #include "PlatformHelpers.h"
 #include "BinaryReader.h"
+#include "MeshOptimizer.h"
 
 #include "SDKMesh.h"
 
@@ -309,6 +310,21 @@ namespace
         return flags;
     }
 
+    // Byte offset of the position within a vertex
+    size_t GetPositionOffset(_In_reads_(32) const DXUT::D3DVERTEXELEMENT9 decl[])
+    {
+        for (uint32_t index = 0; index < DXUT::MAX_VERTEX_ELEMENTS; ++index)
+        {
+            if (decl[index].Usage == 0xFF || decl[index].Type == DXUT::D3DDECLTYPE_UNUSED)
+                break;
+
+            if (decl[index].Usage == DXUT::D3DDECLUSAGE_POSITION && decl[index].Type == DXUT::D3DDECLTYPE_FLOAT3)
+                return decl[index].Offset;
+        }
+
+        throw std::exception("SV_Position is required");
+    }
+
     // Helper for creating a D3D input layout.
     void CreateInputLayout(_In_ ID3D11Device* device, _In_ IEffect* effect, std::vector<D3D11_INPUT_ELEMENT_DESC>& inputDesc, _Out_ ID3D11InputLayout** pInputLayout)
     {
@@ -336,7 +352,7 @@ namespace
 //======================================================================================
 
 _Use_decl_annotations_
-std::unique_ptr<Model> DirectX::Model::CreateFromSDKMESH(ID3D11Device* d3dDevice, const uint8_t* meshData, size_t dataSize, IEffectFactory& fxFactory, bool ccw, bool pmalpha)
+std::unique_ptr<Model> DirectX::Model::CreateFromSDKMESH(ID3D11Device* d3dDevice, const uint8_t* meshData, size_t dataSize, IEffectFactory& fxFactory, bool ccw, bool pmalpha, size_t lodCount)
 {
     if (!d3dDevice || !meshData)
         throw std::exception("Device and meshData cannot be null");
@@ -478,6 +494,51 @@ std::unique_ptr<Model> DirectX::Model::CreateFromSDKMESH(ID3D11Device* d3dDevice
                    "         (treating as DXGI_FORMAT_R10G10B10A2_UNORM which is not a signed format)\n");
     }
 
+    // Collect the ranges each subset draws from the index buffers. Opaque triangle list subsets are reordered
+    // for the post-transform vertex cache, while alpha blended ones keep the authored order they blend in.
+    // Invalid meshes are skipped here, and reported when the meshes are created.
+    std::vector<std::vector<IndexRange>> ibRanges;
+    ibRanges.resize(header->NumIndexBuffers);
+
+    for (UINT meshIndex = 0; meshIndex < header->NumMeshes; ++meshIndex)
+    {
+        auto& mh = meshArray[meshIndex];
+
+        if (mh.IndexBuffer >= header->NumIndexBuffers
+            || dataSize < mh.SubsetOffset
+            || (dataSize < mh.SubsetOffset + uint64_t(mh.NumSubsets) * sizeof(UINT)))
+            continue;
+
+        auto& ih = ibArray[mh.IndexBuffer];
+        uint64_t ibIndexCount = ih.SizeBytes / ((ih.IndexType == DXUT::IT_32BIT) ? sizeof(uint32_t) : sizeof(uint16_t));
+
+        auto subsets = reinterpret_cast<const UINT*>(meshData + mh.SubsetOffset);
+
+        for (UINT j = 0; j < mh.NumSubsets; ++j)
+        {
+            if (subsets[j] >= header->NumTotalSubsets)
+                continue;
+
+            auto& subset = subsetArray[subsets[j]];
+
+            if (subset.MaterialID >= header->NumMaterials
+                || subset.IndexStart > ibIndexCount
+                || subset.IndexCount > ibIndexCount - subset.IndexStart)
+                continue;
+
+            float alpha = materialArray[subset.MaterialID].Diffuse.w;
+
+            IndexRange range;
+            range.startIndex = static_cast<size_t>(subset.IndexStart);
+            range.indexCount = static_cast<size_t>(subset.IndexCount);
+            range.optimize = (subset.PrimitiveType == DXUT::PT_TRIANGLE_LIST)
+                && !(subset.IndexCount % 3)
+                && !(alpha > 0.f && alpha < 1.f);
+
+            ibRanges[mh.IndexBuffer].emplace_back(range);
+        }
+    }
+
     // Create index buffers
     std::vector<ComPtr<ID3D11Buffer>> ibs;
     ibs.resize(header->NumIndexBuffers);
@@ -498,6 +559,37 @@ std::unique_ptr<Model> DirectX::Model::CreateFromSDKMESH(ID3D11Device* d3dDevice
 
         auto indices = bufferData + (ih.DataOffset - bufferDataOffset);
 
+        auto& ranges = ibRanges[j];
+
+        std::unique_ptr<uint8_t[]> optimized;
+
+        if (std::any_of(ranges.cbegin(), ranges.cend(), [](IndexRange const& range) { return range.optimize; }))
+        {
+            auto ibBytes = static_cast<size_t>(ih.SizeBytes);
+
+            optimized.reset(new uint8_t[ibBytes]);
+            memcpy(optimized.get(), indices, ibBytes);
+
+            if (ih.IndexType == DXUT::IT_32BIT)
+            {
+                OptimizeIndexRanges(reinterpret_cast<uint32_t*>(optimized.get()), ibBytes / sizeof(uint32_t), ranges.data(), ranges.size());
+
+            #ifdef _DEBUG
+                TraceVertexCacheStatistics("SDKMESH index buffer", reinterpret_cast<const uint32_t*>(indices), reinterpret_cast<const uint32_t*>(optimized.get()), ibBytes / sizeof(uint32_t));
+            #endif
+            }
+            else
+            {
+                OptimizeIndexRanges(reinterpret_cast<uint16_t*>(optimized.get()), ibBytes / sizeof(uint16_t), ranges.data(), ranges.size());
+
+            #ifdef _DEBUG
+                TraceVertexCacheStatistics("SDKMESH index buffer", reinterpret_cast<const uint16_t*>(indices), reinterpret_cast<const uint16_t*>(optimized.get()), ibBytes / sizeof(uint16_t));
+            #endif
+            }
+
+            indices = optimized.get();
+        }
+
         D3D11_BUFFER_DESC desc = {};
         desc.Usage = D3D11_USAGE_DEFAULT;
         desc.ByteWidth = static_cast<UINT>(ih.SizeBytes);
@@ -624,6 +716,38 @@ std::unique_ptr<Model> DirectX::Model::CreateFromSDKMESH(ID3D11Device* d3dDevice
             part->vbDecl = vbDecls[mh.VertexBuffers[0]];
 
             mesh->meshParts.emplace_back(part);
+
+            if (lodCount > 0 && subset.PrimitiveType == DXUT::PT_TRIANGLE_LIST)
+            {
+                auto& vh = vbArray[mh.VertexBuffers[0]];
+                auto& ih = ibArray[mh.IndexBuffer];
+
+                size_t indexSize = (ih.IndexType == DXUT::IT_32BIT) ? sizeof(uint32_t) : sizeof(uint16_t);
+
+                if (vh.NumVertices > vh.SizeBytes / std::max<uint64_t>(vh.StrideBytes, 1)
+                    || ih.NumIndices > ih.SizeBytes / indexSize
+                    || subset.VertexStart > vh.NumVertices
+                    || subset.IndexStart > ih.NumIndices
+                    || subset.IndexCount > ih.NumIndices - subset.IndexStart)
+                    throw std::exception("Invalid mesh found");
+
+                // Subset indices are relative to its first vertex.
+                auto verts = bufferData + (vh.DataOffset - bufferDataOffset) + subset.VertexStart * vh.StrideBytes;
+                auto positions = reinterpret_cast<const XMFLOAT3*>(verts + GetPositionOffset(vh.Decl));
+                auto vertexCount = static_cast<size_t>(vh.NumVertices - subset.VertexStart);
+                auto indices = bufferData + (ih.DataOffset - bufferDataOffset) + subset.IndexStart * indexSize;
+
+                if (ih.IndexType == DXUT::IT_32BIT)
+                {
+                    part->CreateLevelsOfDetail(d3dDevice, reinterpret_cast<const uint32_t*>(indices),
+                        positions, static_cast<size_t>(vh.StrideBytes), vertexCount, lodCount);
+                }
+                else
+                {
+                    part->CreateLevelsOfDetail(d3dDevice, reinterpret_cast<const uint16_t*>(indices),
+                        positions, static_cast<size_t>(vh.StrideBytes), vertexCount, lodCount);
+                }
+            }
         }
 
         model->meshes.emplace_back(mesh);
@@ -635,7 +759,7 @@ std::unique_ptr<Model> DirectX::Model::CreateFromSDKMESH(ID3D11Device* d3dDevice
 
 //--------------------------------------------------------------------------------------
 _Use_decl_annotations_
-std::unique_ptr<Model> DirectX::Model::CreateFromSDKMESH(ID3D11Device* d3dDevice, const wchar_t* szFileName, IEffectFactory& fxFactory, bool ccw, bool pmalpha)
+std::unique_ptr<Model> DirectX::Model::CreateFromSDKMESH(ID3D11Device* d3dDevice, const wchar_t* szFileName, IEffectFactory& fxFactory, bool ccw, bool pmalpha, size_t lodCount)
 {
     size_t dataSize = 0;
     std::unique_ptr<uint8_t[]> data;
@@ -646,7 +770,7 @@ std::unique_ptr<Model> DirectX::Model::CreateFromSDKMESH(ID3D11Device* d3dDevice
         throw std::exception("CreateFromSDKMESH");
     }
 
-    auto model = CreateFromSDKMESH(d3dDevice, data.get(), dataSize, fxFactory, ccw, pmalpha);
+    auto model = CreateFromSDKMESH(d3dDevice, data.get(), dataSize, fxFactory, ccw, pmalpha, lodCount);
 
     model->name = szFileName;
 
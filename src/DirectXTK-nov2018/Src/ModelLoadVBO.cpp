@@ -16,6 +16,7 @@
 #include "DirectXHelpers.h"
 #include "PlatformHelpers.h"
 #include "BinaryReader.h"
+#include "MeshOptimizer.h"
 
 #include "vbo.h"
 
@@ -85,6 +86,19 @@ std::unique_ptr<Model> DirectX::Model::CreateFromVBO(ID3D11Device* d3dDevice, co
         throw std::exception("End of file");
     auto indices = reinterpret_cast<const uint16_t*>(meshData + sizeof(VBO::header_t) + vertSize);
 
+    if (header->numIndices % 3)
+        throw std::exception("Expected triangular faces");
+
+    // Reorder the copies for the post-transform vertex cache and for vertex fetch before uploading them.
+    std::vector<VertexPositionNormalTexture> optimizedVerts(verts, verts + header->numVertices);
+    std::vector<uint16_t> optimizedIndices(indices, indices + header->numIndices);
+
+    OptimizeMesh(optimizedVerts, optimizedIndices);
+
+#ifdef _DEBUG
+    TraceVertexCacheStatistics("VBO mesh", indices, optimizedIndices.data(), optimizedIndices.size());
+#endif
+
     // Create vertex buffer
     ComPtr<ID3D11Buffer> vb;
     {
@@ -94,7 +108,7 @@ std::unique_ptr<Model> DirectX::Model::CreateFromVBO(ID3D11Device* d3dDevice, co
         desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
 
         D3D11_SUBRESOURCE_DATA initData = {};
-        initData.pSysMem = verts;
+        initData.pSysMem = optimizedVerts.data();
 
         ThrowIfFailed(
             d3dDevice->CreateBuffer(&desc, &initData, vb.GetAddressOf())
@@ -112,7 +126,7 @@ std::unique_ptr<Model> DirectX::Model::CreateFromVBO(ID3D11Device* d3dDevice, co
         desc.BindFlags = D3D11_BIND_INDEX_BUFFER;
 
         D3D11_SUBRESOURCE_DATA initData = {};
-        initData.pSysMem = indices;
+        initData.pSysMem = optimizedIndices.data();
 
         ThrowIfFailed(
             d3dDevice->CreateBuffer(&desc, &initData, ib.GetAddressOf())
@@ -15,6 +15,10 @@
 #include "VertexTypes.h"
 #include "SharedResourcePool.h"
 #include "AlignedNew.h"
+#include "SpriteSort.h"
+#include "SpriteVertices.h"
+
+#include <unordered_map>
 
 using namespace DirectX;
 using Microsoft::WRL::ComPtr;
@@ -57,6 +61,74 @@ namespace
 }
 
 
+// Internal SpriteLayer implementation class.
+class SpriteLayer::Impl
+{
+public:
+    Impl()
+      : mDirty(false)
+    {
+    }
+
+    void Clear();
+    void CreateVertexBuffer(_In_ ID3D11Device* device);
+
+
+    // Adjacent sprites that share a texture, in the order they are drawn.
+    struct TextureRun
+    {
+        ComPtr<ID3D11ShaderResourceView> texture;
+        size_t firstSprite;
+        size_t count;
+    };
+
+    std::vector<TextureRun> mTextureRuns;
+
+
+    // The expanded vertices of all sprites, kept so the buffer can be recreated on another device.
+    std::vector<VertexPositionColorTexture> mVertices;
+
+    ComPtr<ID3D11Buffer> mVertexBuffer;
+
+    bool mDirty;
+};
+
+
+// Removes all sprites from the layer.
+void SpriteLayer::Impl::Clear()
+{
+    mTextureRuns.clear();
+    mVertices.clear();
+    mVertexBuffer.Reset();
+    mDirty = false;
+}
+
+
+// Uploads the vertices of the layer into an immutable vertex buffer.
+void SpriteLayer::Impl::CreateVertexBuffer(_In_ ID3D11Device* device)
+{
+    D3D11_BUFFER_DESC vertexBufferDesc = {};
+
+    vertexBufferDesc.ByteWidth = static_cast<UINT>(sizeof(VertexPositionColorTexture) * mVertices.size());
+    vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+    vertexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
+
+    D3D11_SUBRESOURCE_DATA vertexDataDesc = {};
+
+    vertexDataDesc.pSysMem = mVertices.data();
+
+    mVertexBuffer.Reset();
+
+    ThrowIfFailed(
+        device->CreateBuffer(&vertexBufferDesc, &vertexDataDesc, &mVertexBuffer)
+    );
+
+    SetDebugObjectName(mVertexBuffer.Get(), "DirectXTK:SpriteLayer");
+
+    mDirty = false;
+}
+
+
 // Internal SpriteBatch implementation class.
 __declspec(align(16)) class SpriteBatch::Impl : public AlignedNew<SpriteBatch::Impl>
 {
@@ -79,30 +151,25 @@ public:
         FXMVECTOR originRotationDepth,
         int flags);
 
-
-    // Info about a single sprite that is waiting to be drawn.
-    __declspec(align(16)) struct SpriteInfo : public AlignedNew<SpriteInfo>
-    {
-        XMFLOAT4A source;
-        XMFLOAT4A destination;
-        XMFLOAT4A color;
-        XMFLOAT4A originRotationDepth;
-        ID3D11ShaderResourceView* texture;
-        int flags;
+    void BeginLayer(_In_ SpriteLayer::Impl* layer, SpriteSortMode sortMode);
+    void EndLayer();
+    void DrawLayer(_In_ SpriteLayer::Impl* layer);
 
 
-        // Combine values from the public SpriteEffects enum with these internal-only flags.
-        static const int SourceInTexels = 4;
-        static const int DestSizeInPixels = 8;
-
-        static_assert((SpriteEffects_FlipBoth & (SourceInTexels | DestSizeInPixels)) == 0, "Flag bits must not overlap");
-    };
-
     DXGI_MODE_ROTATION mRotation;
 
     bool mSetViewport;
     D3D11_VIEWPORT mViewPort;
 
+    bool mParallelVertexGeneration;
+
+
+    // Queued sprites are SpriteInfo records, which mix the public SpriteEffects with internal flags.
+    static_assert((SpriteEffects_FlipBoth & (SpriteInfo::SourceInTexels | SpriteInfo::DestSizeInPixels)) == 0, "Flag bits must not overlap");
+
+    static_assert(SpriteEffects_FlipHorizontally == 1 &&
+                  SpriteEffects_FlipVertically == 2, "If you change these enum values, the mirroring implementation in RenderSprite must be updated to match");
+
 private:
     // Implementation helper methods.
     void GrowSpriteQueue();
@@ -110,13 +177,10 @@ private:
     void FlushBatch();
     void SortSprites();
     void GrowSortedSprites();
+    void BuildSortKeys();
 
     void RenderBatch(_In_ ID3D11ShaderResourceView* texture, _In_reads_(count) SpriteInfo const* const* sprites, size_t count);
-
-    static void XM_CALLCONV RenderSprite(_In_ SpriteInfo const* sprite,
-        _Out_writes_(VerticesPerSprite) VertexPositionColorTexture* vertices,
-        FXMVECTOR textureSize,
-        FXMVECTOR inverseTextureSize);
+    void ResetSpriteQueue();
 
     static XMVECTOR GetTextureSize(_In_ ID3D11ShaderResourceView* texture);
     XMMATRIX GetViewportTransform(_In_ ID3D11DeviceContext* deviceContext, DXGI_MODE_ROTATION rotation );
@@ -126,7 +190,6 @@ private:
     static const size_t MaxBatchSize = 2048;
     static const size_t MinBatchSize = 128;
     static const size_t InitialQueueSize = 64;
-    static const size_t VerticesPerSprite = 4;
     static const size_t IndicesPerSprite = 6;
 
 
@@ -144,6 +207,16 @@ private:
     std::vector<SpriteInfo const*> mSortedSprites;
 
 
+    // Rather than sorting the pointers with a comparison that chases into the SpriteInfo structures,
+    // the sorting modes pack everything they compare into a single 64-bit key per sprite. The upper
+    // half holds the depth (or the texture when sorting by texture), the lower half a dense texture ID,
+    // which groups sprites of equal depth by texture. Sprites with equal keys keep their submission
+    // order, as the radix sort is stable.
+    std::vector<SpriteSortKey> mSortKeys;
+    std::vector<SpriteSortKey> mSortScratch;
+    std::unordered_map<ID3D11ShaderResourceView*, uint32_t> mTextureIDs;
+
+
     // If each SpriteInfo instance held a refcount on its texture, could end up with
     // many redundant AddRef/Release calls on the same object, so instead we use
     // this separate list to hold just a single refcount each time we change texture.
@@ -162,6 +235,10 @@ private:
     XMMATRIX mTransformMatrix;
 
 
+    // The layer that Draw calls are recorded into, between BeginLayer and EndLayer.
+    SpriteLayer::Impl* mRecordingLayer;
+
+
     // Only one of these helpers is allocated per D3D device, even if there are multiple SpriteBatch instances.
     struct DeviceResources
     {
@@ -372,11 +449,13 @@ SpriteBatch::Impl::Impl(_In_ ID3D11DeviceContext* deviceContext)
   : mRotation(DXGI_MODE_ROTATION_IDENTITY),
     mSetViewport(false),
     mViewPort{},
+    mParallelVertexGeneration(false),
     mSpriteQueueCount(0),
     mSpriteQueueArraySize(0),
     mInBeginEndPair(false),
     mSortMode(SpriteSortMode_Deferred),
     mTransformMatrix(MatrixIdentity),
+    mRecordingLayer(nullptr),
     mDeviceResources(deviceResourcesPool.DemandCreate(GetDevice(deviceContext).Get())),
     mContextResources(contextResourcesPool.DemandCreate(deviceContext))
 {
@@ -425,6 +504,9 @@ void SpriteBatch::Impl::End()
     if (!mInBeginEndPair)
         throw std::exception("Begin must be called before End");
 
+    if (mRecordingLayer)
+        throw std::exception("EndLayer must be used to finish recording a layer");
+
     if (mSortMode == SpriteSortMode_Immediate)
     {
         // If we are in immediate mode, sprites have already been drawn.
@@ -448,6 +530,147 @@ void SpriteBatch::Impl::End()
 }
 
 
+// Starts recording Draw calls into a retained layer.
+_Use_decl_annotations_
+void SpriteBatch::Impl::BeginLayer(SpriteLayer::Impl* layer, SpriteSortMode sortMode)
+{
+    if (mInBeginEndPair)
+        throw std::exception("Cannot record a layer inside a Begin/End pair");
+
+    if (sortMode == SpriteSortMode_Immediate)
+        throw std::exception("Layers cannot use SpriteSortMode_Immediate");
+
+    layer->Clear();
+
+    mSortMode = sortMode;
+    mRecordingLayer = layer;
+
+    // Draw queues the sprites exactly as it does for a regular batch.
+    mInBeginEndPair = true;
+}
+
+
+// Sorts the recorded sprites and expands them into the vertices of the layer.
+void SpriteBatch::Impl::EndLayer()
+{
+    if (!mRecordingLayer)
+        throw std::exception("BeginLayer must be called before EndLayer");
+
+    SpriteLayer::Impl* layer = mRecordingLayer;
+
+    if (mSpriteQueueCount > 0)
+    {
+        SortSprites();
+
+        layer->mVertices.resize(mSpriteQueueCount * VerticesPerSprite);
+
+        // Walk through the sorted sprite list, expanding each run of sprites that share a texture.
+        size_t batchStart = 0;
+
+        for (size_t pos = 1; pos <= mSpriteQueueCount; pos++)
+        {
+            ID3D11ShaderResourceView* texture = mSortedSprites[batchStart]->texture;
+
+            if (pos < mSpriteQueueCount && mSortedSprites[pos]->texture == texture)
+                continue;
+
+            XMVECTOR textureSize = GetTextureSize(texture);
+            XMVECTOR inverseTextureSize = XMVectorReciprocal(textureSize);
+
+            RenderSprites(&mSortedSprites[batchStart], pos - batchStart, &layer->mVertices[batchStart * VerticesPerSprite], textureSize, inverseTextureSize, mParallelVertexGeneration);
+
+            SpriteLayer::Impl::TextureRun run;
+
+            run.texture = texture;
+            run.firstSprite = batchStart;
+            run.count = pos - batchStart;
+
+            layer->mTextureRuns.push_back(std::move(run));
+
+            batchStart = pos;
+        }
+
+        ResetSpriteQueue();
+
+        layer->mDirty = true;
+    }
+
+    mRecordingLayer = nullptr;
+    mInBeginEndPair = false;
+}
+
+
+// Draws a retained layer straight from its own vertex buffer.
+_Use_decl_annotations_
+void SpriteBatch::Impl::DrawLayer(SpriteLayer::Impl* layer)
+{
+    if (!mInBeginEndPair || mRecordingLayer)
+        throw std::exception("Begin must be called before DrawLayer");
+
+    if (layer->mTextureRuns.empty())
+        return;
+
+    auto deviceContext = mContextResources->deviceContext.Get();
+
+    if (mSortMode != SpriteSortMode_Immediate)
+    {
+        // Draw the sprites queued so far, so the layer keeps its place in the batch.
+        if (mContextResources->inImmediateMode)
+            throw std::exception("Cannot draw a layer while another SpriteBatch is using SpriteSortMode_Immediate");
+
+        PrepareForRendering();
+        FlushBatch();
+    }
+
+    // The vertex buffer is only created again if the layer was re-recorded, or is drawn on another device.
+    auto device = GetDevice(deviceContext);
+
+    if (layer->mVertexBuffer)
+    {
+        ComPtr<ID3D11Device> bufferDevice;
+        layer->mVertexBuffer->GetDevice(&bufferDevice);
+
+        if (bufferDevice != device)
+        {
+            layer->mDirty = true;
+        }
+    }
+
+    if (layer->mDirty || !layer->mVertexBuffer)
+    {
+        layer->CreateVertexBuffer(device.Get());
+    }
+
+    auto vertexBuffer = layer->mVertexBuffer.Get();
+    UINT vertexStride = sizeof(VertexPositionColorTexture);
+    UINT vertexOffset = 0;
+
+    deviceContext->IASetVertexBuffers(0, 1, &vertexBuffer, &vertexStride, &vertexOffset);
+
+    // The shared index buffer covers MaxBatchSize sprites, so longer runs are drawn in several calls.
+    for (auto const& run : layer->mTextureRuns)
+    {
+        ID3D11ShaderResourceView* texture = run.texture.Get();
+
+        deviceContext->PSSetShaderResources(0, 1, &texture);
+
+        for (size_t drawn = 0; drawn < run.count; drawn += MaxBatchSize)
+        {
+            size_t batchSize = std::min(run.count - drawn, MaxBatchSize);
+
+            deviceContext->DrawIndexed(static_cast<UINT>(batchSize * IndicesPerSprite), 0, static_cast<INT>((run.firstSprite + drawn) * VerticesPerSprite));
+        }
+    }
+
+#if !defined(_XBOX_ONE) || !defined(_TITLE)
+    // Restore the dynamic vertex buffer for the sprites that follow.
+    vertexBuffer = mContextResources->vertexBuffer.Get();
+
+    deviceContext->IASetVertexBuffers(0, 1, &vertexBuffer, &vertexStride, &vertexOffset);
+#endif
+}
+
+
 // Adds a single sprite to the queue.
 _Use_decl_annotations_
 void XM_CALLCONV SpriteBatch::Impl::Draw(ID3D11ShaderResourceView* texture,
@@ -649,7 +872,13 @@ void SpriteBatch::Impl::FlushBatch()
     // Flush the final batch.
     RenderBatch(batchTexture, &mSortedSprites[batchStart], mSpriteQueueCount - batchStart);
 
-    // Reset the queue.
+    ResetSpriteQueue();
+}
+
+
+// Empties the sprite queue once its contents have been drawn or recorded.
+void SpriteBatch::Impl::ResetSpriteQueue()
+{
     mSpriteQueueCount = 0;
     mSpriteTextureReferences.clear();
 
@@ -666,41 +895,68 @@ void SpriteBatch::Impl::FlushBatch()
 // Sorts the array of queued sprites.
 void SpriteBatch::Impl::SortSprites()
 {
-    // Fill the mSortedSprites vector.
-    if (mSortedSprites.size() < mSpriteQueueCount)
-    {
-        GrowSortedSprites();
-    }
-
     switch (mSortMode)
     {
         case SpriteSortMode_Texture:
-            // Sort by texture.
-            std::sort(mSortedSprites.begin(), mSortedSprites.begin() + mSpriteQueueCount, [](SpriteInfo const* x, SpriteInfo const* y) -> bool
+        case SpriteSortMode_BackToFront:
+        case SpriteSortMode_FrontToBack:
+        {
+            // Sort the packed keys, then look up the sprites in their sorted order.
+            BuildSortKeys();
+
+            if (mSortScratch.size() < mSpriteQueueCount)
+            {
+                mSortScratch.resize(mSpriteQueueCount);
+            }
+
+            RadixSortSpriteKeys(mSortKeys.data(), mSortScratch.data(), mSpriteQueueCount);
+
+            mSortedSprites.resize(mSpriteQueueCount);
+
+            for (size_t i = 0; i < mSpriteQueueCount; i++)
+            {
+                mSortedSprites[i] = &mSpriteQueue[mSortKeys[i].index];
+            }
+            break;
+        }
+
+        default:
+            // Fill the mSortedSprites vector.
+            if (mSortedSprites.size() < mSpriteQueueCount)
             {
-                return x->texture < y->texture;
-            });
+                GrowSortedSprites();
+            }
             break;
+    }
+}
 
+
+// Computes the sort keys of all queued sprites in a single pass over the sprite queue.
+void SpriteBatch::Impl::BuildSortKeys()
+{
+    if (mSortKeys.size() < mSpriteQueueCount)
+    {
+        mSortKeys.resize(mSpriteQueueCount);
+    }
+
+    SpriteKeyOrder order;
+
+    switch (mSortMode)
+    {
         case SpriteSortMode_BackToFront:
-            // Sort back to front.
-            std::sort(mSortedSprites.begin(), mSortedSprites.begin() + mSpriteQueueCount, [](SpriteInfo const* x, SpriteInfo const* y) -> bool
-            {
-                return x->originRotationDepth.w > y->originRotationDepth.w;
-            });
+            order = SpriteKeyOrder_BackToFront;
             break;
 
         case SpriteSortMode_FrontToBack:
-            // Sort front to back.
-            std::sort(mSortedSprites.begin(), mSortedSprites.begin() + mSpriteQueueCount, [](SpriteInfo const* x, SpriteInfo const* y) -> bool
-            {
-                return x->originRotationDepth.w < y->originRotationDepth.w;
-            });
+            order = SpriteKeyOrder_FrontToBack;
             break;
 
         default:
+            order = SpriteKeyOrder_Texture;
             break;
     }
+
+    BuildSpriteSortKeys(mSpriteQueue.get(), mSpriteQueueCount, order, mSortKeys.data(), mTextureIDs);
 }
 
 
@@ -772,14 +1028,9 @@ void SpriteBatch::Impl::RenderBatch(ID3D11ShaderResourceView* texture, SpriteInf
 #endif
 
         // Generate sprite vertex data.
-        for (size_t i = 0; i < batchSize; i++)
-        {
-            assert(i < count);
-            _Analysis_assume_(i < count);
-            RenderSprite(sprites[i], vertices, textureSize, inverseTextureSize);
-
-            vertices += VerticesPerSprite;
-        }
+        assert(batchSize <= count);
+        _Analysis_assume_(batchSize <= count);
+        RenderSprites(sprites, batchSize, vertices, textureSize, inverseTextureSize, mParallelVertexGeneration);
 
 #if defined(_XBOX_ONE) && defined(_TITLE)
         deviceContext->IASetPlacementVertexBuffer(0, mContextResources->vertexBuffer.Get(), grfxMemory, sizeof(VertexPositionColorTexture));
@@ -804,121 +1055,6 @@ void SpriteBatch::Impl::RenderBatch(ID3D11ShaderResourceView* texture, SpriteInf
 }
 
 
-// Generates vertex data for drawing a single sprite.
-_Use_decl_annotations_
-void XM_CALLCONV SpriteBatch::Impl::RenderSprite(SpriteInfo const* sprite,
-    VertexPositionColorTexture* vertices,
-    FXMVECTOR textureSize,
-    FXMVECTOR inverseTextureSize)
-{
-    // Load sprite parameters into SIMD registers.
-    XMVECTOR source = XMLoadFloat4A(&sprite->source);
-    XMVECTOR destination = XMLoadFloat4A(&sprite->destination);
-    XMVECTOR color = XMLoadFloat4A(&sprite->color);
-    XMVECTOR originRotationDepth = XMLoadFloat4A(&sprite->originRotationDepth);
-
-    float rotation = sprite->originRotationDepth.z;
-    int flags = sprite->flags;
-
-    // Extract the source and destination sizes into separate vectors.
-    XMVECTOR sourceSize = XMVectorSwizzle<2, 3, 2, 3>(source);
-    XMVECTOR destinationSize = XMVectorSwizzle<2, 3, 2, 3>(destination);
-
-    // Scale the origin offset by source size, taking care to avoid overflow if the source region is zero.
-    XMVECTOR isZeroMask = XMVectorEqual(sourceSize, XMVectorZero());
-    XMVECTOR nonZeroSourceSize = XMVectorSelect(sourceSize, g_XMEpsilon, isZeroMask);
-
-    XMVECTOR origin = XMVectorDivide(originRotationDepth, nonZeroSourceSize);
-
-    // Convert the source region from texels to mod-1 texture coordinate format.
-    if (flags & SpriteInfo::SourceInTexels)
-    {
-        source = XMVectorMultiply(source, inverseTextureSize);
-        sourceSize = XMVectorMultiply(sourceSize, inverseTextureSize);
-    }
-    else
-    {
-        origin = XMVectorMultiply(origin, inverseTextureSize);
-    }
-
-    // If the destination size is relative to the source region, convert it to pixels.
-    if (!(flags & SpriteInfo::DestSizeInPixels))
-    {
-        destinationSize = XMVectorMultiply(destinationSize, textureSize);
-    }
-
-    // Compute a 2x2 rotation matrix.
-    XMVECTOR rotationMatrix1;
-    XMVECTOR rotationMatrix2;
-
-    if (rotation != 0)
-    {
-        float sin, cos;
-
-        XMScalarSinCos(&sin, &cos, rotation);
-
-        XMVECTOR sinV = XMLoadFloat(&sin);
-        XMVECTOR cosV = XMLoadFloat(&cos);
-
-        rotationMatrix1 = XMVectorMergeXY(cosV, sinV);
-        rotationMatrix2 = XMVectorMergeXY(XMVectorNegate(sinV), cosV);
-    }
-    else
-    {
-        rotationMatrix1 = g_XMIdentityR0;
-        rotationMatrix2 = g_XMIdentityR1;
-    }
-    
-    // The four corner vertices are computed by transforming these unit-square positions.
-    static XMVECTORF32 cornerOffsets[VerticesPerSprite] =
-    {
-        { { { 0, 0, 0, 0 } } },
-        { { { 1, 0, 0, 0 } } },
-        { { { 0, 1, 0, 0 } } },
-        { { { 1, 1, 0, 0 } } },
-    };
-
-    // Tricksy alert! Texture coordinates are computed from the same cornerOffsets
-    // table as vertex positions, but if the sprite is mirrored, this table
-    // must be indexed in a different order. This is done as follows:
-    //
-    //    position = cornerOffsets[i]
-    //    texcoord = cornerOffsets[i ^ SpriteEffects]
-
-    static_assert(SpriteEffects_FlipHorizontally == 1 &&
-                  SpriteEffects_FlipVertically == 2, "If you change these enum values, the mirroring implementation must be updated to match");
-
-    const unsigned int mirrorBits = flags & 3;
-
-    // Generate the four output vertices.
-    for (size_t i = 0; i < VerticesPerSprite; i++)
-    {
-        // Calculate position.
-        XMVECTOR cornerOffset = XMVectorMultiply(XMVectorSubtract(cornerOffsets[i], origin), destinationSize);
-        
-        // Apply 2x2 rotation matrix.
-        XMVECTOR position1 = XMVectorMultiplyAdd(XMVectorSplatX(cornerOffset), rotationMatrix1, destination);
-        XMVECTOR position2 = XMVectorMultiplyAdd(XMVectorSplatY(cornerOffset), rotationMatrix2, position1);
-
-        // Set z = depth.
-        XMVECTOR position = XMVectorPermute<0, 1, 7, 6>(position2, originRotationDepth);
-
-        // Write position as a Float4, even though VertexPositionColor::position is an XMFLOAT3.
-        // This is faster, and harmless as we are just clobbering the first element of the
-        // following color field, which will immediately be overwritten with its correct value.
-        XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&vertices[i].position), position);
-
-        // Write the color.
-        XMStoreFloat4(&vertices[i].color, color);
-
-        // Compute and write the texture coordinate.
-        XMVECTOR textureCoordinate = XMVectorMultiplyAdd(cornerOffsets[static_cast<unsigned int>(i) ^ mirrorBits], sourceSize, source);
-
-        XMStoreFloat2(&vertices[i].textureCoordinate, textureCoordinate);
-    }
-}
-
-
 // Helper looks up the size of the specified texture.
 XMVECTOR SpriteBatch::Impl::GetTextureSize(_In_ ID3D11ShaderResourceView* texture)
 {
@@ -1054,6 +1190,24 @@ void SpriteBatch::End()
 }
 
 
+void SpriteBatch::BeginLayer(SpriteLayer& layer, SpriteSortMode sortMode)
+{
+    pImpl->BeginLayer(layer.pImpl.get(), sortMode);
+}
+
+
+void SpriteBatch::EndLayer()
+{
+    pImpl->EndLayer();
+}
+
+
+void SpriteBatch::DrawLayer(SpriteLayer& layer)
+{
+    pImpl->DrawLayer(layer.pImpl.get());
+}
+
+
 _Use_decl_annotations_
 void XM_CALLCONV SpriteBatch::Draw(ID3D11ShaderResourceView* texture, XMFLOAT2 const& position, FXMVECTOR color)
 {
@@ -1157,7 +1311,7 @@ void XM_CALLCONV SpriteBatch::Draw(ID3D11ShaderResourceView* texture, RECT const
 {
     XMVECTOR destination = LoadRect(&destinationRectangle); // x, y, w, h
 
-    pImpl->Draw(texture, destination, nullptr, color, g_XMZero, Impl::SpriteInfo::DestSizeInPixels);
+    pImpl->Draw(texture, destination, nullptr, color, g_XMZero, SpriteInfo::DestSizeInPixels);
 }
 
 
@@ -1175,7 +1329,7 @@ void XM_CALLCONV SpriteBatch::Draw(ID3D11ShaderResourceView* texture,
 
     XMVECTOR originRotationDepth = XMVectorSet(origin.x, origin.y, rotation, layerDepth);
     
-    pImpl->Draw(texture, destination, sourceRectangle, color, originRotationDepth, effects | Impl::SpriteInfo::DestSizeInPixels);
+    pImpl->Draw(texture, destination, sourceRectangle, color, originRotationDepth, effects | SpriteInfo::DestSizeInPixels);
 }
 
 
@@ -1196,3 +1350,61 @@ void SpriteBatch::SetViewport(const D3D11_VIEWPORT& viewPort)
     pImpl->mSetViewport = true;
     pImpl->mViewPort = viewPort;
 }
+
+
+void SpriteBatch::SetParallelVertexGeneration(bool enable)
+{
+    pImpl->mParallelVertexGeneration = enable;
+}
+
+
+bool SpriteBatch::GetParallelVertexGeneration() const
+{
+    return pImpl->mParallelVertexGeneration;
+}
+
+
+// Public SpriteLayer constructor.
+SpriteLayer::SpriteLayer()
+  : pImpl(std::make_unique<Impl>())
+{
+}
+
+
+// Move constructor.
+SpriteLayer::SpriteLayer(SpriteLayer&& moveFrom) noexcept
+  : pImpl(std::move(moveFrom.pImpl))
+{
+}
+
+
+// Move assignment.
+SpriteLayer& SpriteLayer::operator= (SpriteLayer&& moveFrom) noexcept
+{
+    pImpl = std::move(moveFrom.pImpl);
+    return *this;
+}
+
+
+// Public destructor.
+SpriteLayer::~SpriteLayer()
+{
+}
+
+
+void SpriteLayer::Clear()
+{
+    pImpl->Clear();
+}
+
+
+bool SpriteLayer::IsDirty() const
+{
+    return pImpl->mDirty;
+}
+
+
+size_t SpriteLayer::GetSpriteCount() const
+{
+    return pImpl->mVertices.size() / VerticesPerSprite;
+}
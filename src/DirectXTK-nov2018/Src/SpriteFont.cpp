@@ -10,11 +10,16 @@
 #include "pch.h"
 
 #include <algorithm>
+#include <unordered_map>
 #include <vector>
 
 #include "SpriteFont.h"
 #include "DirectXHelpers.h"
 #include "BinaryReader.h"
+#include "GlyphAtlas.h"
+#include "GlyphIndex.h"
+#include "GlyphLayout.h"
+#include "LayoutCache.h"
 #include "LoaderHelpers.h"
 
 using namespace DirectX;
@@ -27,13 +32,33 @@ class SpriteFont::Impl
 public:
     Impl(_In_ ID3D11Device* device, _In_ BinaryReader* reader, bool forceSRGB);
     Impl(_In_ ID3D11ShaderResourceView* texture, _In_reads_(glyphCount) Glyph const* glyphs, _In_ size_t glyphCount, _In_ float lineSpacing);
+    Impl(_In_ ID3D11Device* device, std::unique_ptr<IGlyphSource> glyphSource, uint32_t atlasWidth, uint32_t atlasHeight, bool forceSRGB);
 
-    Glyph const* FindGlyph(wchar_t character) const;
+    Glyph const* FindGlyph(uint32_t character) const;
+    Glyph const* LookupGlyph(uint32_t character) const;
+
+    void MakeResident(_In_ Glyph const* glyph) const;
 
     void SetDefaultCharacter(wchar_t character);
+    void SetKerningPairs(_In_reads_(count) KerningPair const* pairs, size_t count);
+    float GetKerning(uint32_t first, uint32_t second) const;
+
+    template<typename TReader, typename TAction>
+    void ForEachGlyph(TReader reader, TAction action) const;
+
+    template<typename TReader>
+    void XM_CALLCONV DrawGlyphs(_In_ SpriteBatch* spriteBatch, TReader reader, FXMVECTOR position, FXMVECTOR color, float rotation, FXMVECTOR origin, GXMVECTOR scale, SpriteEffects effects, float layerDepth) const;
+
+    template<typename TReader>
+    XMVECTOR MeasureGlyphs(TReader reader) const;
+
+    template<typename TReader>
+    RECT MeasureGlyphBounds(TReader reader, XMFLOAT2 const& position) const;
+
+    template<typename TReader>
+    void BuildLayout(TReader reader, TextLayout& layout) const;
 
-    template<typename TAction>
-    void ForEachGlyph(_In_z_ wchar_t const* text, TAction action) const;
+    TextLayout const& GetCachedLayout(_In_z_ wchar_t const* text) const;
 
 
     // Fields.
@@ -41,6 +66,29 @@ public:
     std::vector<Glyph> glyphs;
     Glyph const* defaultGlyph;
     float lineSpacing;
+
+    KerningTable kerningPairs;
+
+    // Layouts of recently drawn or measured wchar_t strings, when enabled.
+    mutable LayoutCache<TextLayout> layoutCache;
+
+    // Dynamic glyph cache. The metrics of every character asked for are kept (null if it is not in the font),
+    // so glyph pointers stay valid; only the atlas texels are evicted, and reloaded when a glyph is drawn.
+    std::unique_ptr<IGlyphSource> glyphSource;
+    std::unique_ptr<GlyphAtlas> glyphAtlas;
+    ComPtr<ID3D11DeviceContext> deviceContext;
+    ComPtr<ID3D11Texture2D> atlasTexture;
+
+private:
+    Glyph const* LookupSourceGlyph(uint32_t character) const;
+
+    // Empty border around each atlas glyph, so texture filtering does not pick up its neighbors.
+    static const uint32_t AtlasGlyphPadding = 1;
+
+    mutable std::unordered_map<uint32_t, std::unique_ptr<Glyph>> sourceGlyphs;
+    mutable std::vector<uint8_t> rasterBuffer;
+
+    GlyphIndex<Glyph> glyphIndex;
 };
 
 
@@ -48,24 +96,120 @@ public:
 const XMFLOAT2 SpriteFont::Float2Zero(0, 0);
 
 static const char spriteFontMagic[] = "DXTKfont";
+static const char spriteFontKerningMagic[] = "DXTKkern";
 
 
-// Comparison operators make our sorted glyph vector work with std::binary_search and lower_bound.
+// Comparison operator makes our sorted glyph vector work with std::is_sorted.
 namespace DirectX
 {
     static inline bool operator< (SpriteFont::Glyph const& left, SpriteFont::Glyph const& right)
     {
         return left.Character < right.Character;
     }
+}
+
 
-    static inline bool operator< (wchar_t left, SpriteFont::Glyph const& right)
+// Measurement helpers shared by the string and layout code paths. The forEach argument
+// calls the given action for each glyph, with the same arguments as ForEachGlyph.
+namespace
+{
+    template<typename TForEach>
+    XMVECTOR MeasureSize(TForEach forEach, float lineSpacing)
     {
-        return left < right.Character;
+        XMVECTOR result = XMVectorZero();
+
+        forEach([&](SpriteFont::Glyph const* glyph, float x, float y, float advance)
+        {
+            UNREFERENCED_PARAMETER(advance);
+
+            auto w = static_cast<float>(glyph->Subrect.right - glyph->Subrect.left);
+            auto h = static_cast<float>(glyph->Subrect.bottom - glyph->Subrect.top) + glyph->YOffset;
+
+            h = std::max(h, lineSpacing);
+
+            result = XMVectorMax(result, XMVectorSet(x + w, y + h, 0, 0));
+        });
+
+        return result;
     }
 
-    static inline bool operator< (SpriteFont::Glyph const& left, wchar_t right)
+    template<typename TForEach>
+    RECT MeasureBounds(TForEach forEach, XMFLOAT2 const& position)
+    {
+        RECT result = { LONG_MAX, LONG_MAX, 0, 0 };
+
+        forEach([&](SpriteFont::Glyph const* glyph, float x, float y, float advance)
+        {
+            auto w = static_cast<float>(glyph->Subrect.right - glyph->Subrect.left);
+            auto h = static_cast<float>(glyph->Subrect.bottom - glyph->Subrect.top);
+
+            float minX = position.x + x;
+            float minY = position.y + y + glyph->YOffset;
+
+            float maxX = std::max(minX + advance, minX + w);
+            float maxY = minY + h;
+
+            if (minX < result.left)
+                result.left = long(minX);
+
+            if (minY < result.top)
+                result.top = long(minY);
+
+            if (result.right < maxX)
+                result.right = long(maxX);
+
+            if (result.bottom < maxY)
+                result.bottom = long(maxY);
+        });
+
+        if (result.left == LONG_MAX)
+        {
+            result.left = 0;
+            result.top = 0;
+        }
+
+        return result;
+    }
+
+
+    static_assert(SpriteEffects_FlipHorizontally == 1 &&
+                  SpriteEffects_FlipVertically == 2, "If you change these enum values, the following tables must be updated to match");
+
+    // Lookup table indicates which way to move along each axis per SpriteEffects enum value.
+    const XMVECTORF32 axisDirectionTable[4] =
+    {
+        { { { -1, -1, 0, 0 } } },
+        { { {  1, -1, 0, 0 } } },
+        { { { -1,  1, 0, 0 } } },
+        { { {  1,  1, 0, 0 } } },
+    };
+
+    // Lookup table indicates which axes are mirrored for each SpriteEffects enum value.
+    const XMVECTORF32 axisIsMirroredTable[4] =
+    {
+        { { { 0, 0, 0, 0 } } },
+        { { { 1, 0, 0, 0 } } },
+        { { { 0, 1, 0, 0 } } },
+        { { { 1, 1, 0, 0 } } },
+    };
+
+    // Computes the origin of a single glyph, relative to the position of the string.
+    XMVECTOR XM_CALLCONV GetGlyphOffset(SpriteFont::Glyph const* glyph, float x, float y, FXMVECTOR baseOffset, SpriteEffects effects)
     {
-        return left.Character < right;
+        XMVECTOR offset = XMVectorMultiplyAdd(XMVectorSet(x, y + glyph->YOffset, 0, 0), axisDirectionTable[effects & 3], baseOffset);
+
+        if (effects)
+        {
+            // For mirrored characters, specify bottom and/or right instead of top left.
+            XMVECTOR glyphRect = XMConvertVectorIntToFloat(XMLoadInt4(reinterpret_cast<uint32_t const*>(&glyph->Subrect)), 0);
+
+            // xy = glyph width/height.
+            glyphRect = XMVectorSubtract(XMVectorSwizzle<2, 3, 0, 1>(glyphRect), glyphRect);
+
+            offset = XMVectorMultiplyAdd(glyphRect, axisIsMirroredTable[effects & 3], offset);
+        }
+
+        return offset;
     }
 }
 
@@ -90,6 +234,8 @@ SpriteFont::Impl::Impl(_In_ ID3D11Device* device, _In_ BinaryReader* reader, boo
 
     glyphs.assign(glyphData, glyphData + glyphCount);
 
+    glyphIndex.Build(glyphs.data(), glyphs.size());
+
     // Read font properties.
     lineSpacing = reader->Read<float>();
 
@@ -124,6 +270,16 @@ SpriteFont::Impl::Impl(_In_ ID3D11Device* device, _In_ BinaryReader* reader, boo
 
     SetDebugObjectName(texture.Get(), "DirectXTK:SpriteFont");
     SetDebugObjectName(texture2D.Get(), "DirectXTK:SpriteFont");
+
+    // Read the optional kerning pairs, which older files do not have.
+    if (reader->BytesRemaining() >= sizeof(spriteFontKerningMagic) - 1
+        && memcmp(reader->ReadArray<char>(sizeof(spriteFontKerningMagic) - 1), spriteFontKerningMagic, sizeof(spriteFontKerningMagic) - 1) == 0)
+    {
+        auto pairCount = reader->Read<uint32_t>();
+        auto pairData = reader->ReadArray<KerningPair>(pairCount);
+
+        SetKerningPairs(pairData, pairCount);
+    }
 }
 
 
@@ -139,17 +295,141 @@ SpriteFont::Impl::Impl(ID3D11ShaderResourceView* texture, Glyph const* glyphs, s
     {
         throw std::exception("Glyphs must be in ascending codepoint order");
     }
+
+    glyphIndex.Build(glyphs.data(), glyphs.size());
+}
+
+
+// Constructs a SpriteFont with a dynamic glyph cache.
+_Use_decl_annotations_
+SpriteFont::Impl::Impl(ID3D11Device* device, std::unique_ptr<IGlyphSource> glyphSource, uint32_t atlasWidth, uint32_t atlasHeight, bool forceSRGB)
+    : defaultGlyph(nullptr),
+    glyphSource(std::move(glyphSource))
+{
+    if (!this->glyphSource)
+    {
+        throw std::exception("Glyph source is required");
+    }
+
+    if (!atlasWidth || !atlasHeight || atlasWidth > D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION || atlasHeight > D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION)
+    {
+        throw std::out_of_range("Invalid glyph cache atlas size");
+    }
+
+    lineSpacing = this->glyphSource->GetLineSpacing();
+
+    glyphAtlas = std::make_unique<GlyphAtlas>(atlasWidth, atlasHeight);
+
+    glyphIndex.Build(glyphs.data(), glyphs.size());
+
+    // Create the atlas texture, which is updated as glyphs are added.
+    DXGI_FORMAT textureFormat = forceSRGB ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
+
+    CD3D11_TEXTURE2D_DESC textureDesc(textureFormat, atlasWidth, atlasHeight, 1, 1, D3D11_BIND_SHADER_RESOURCE, D3D11_USAGE_DEFAULT);
+    CD3D11_SHADER_RESOURCE_VIEW_DESC viewDesc(D3D11_SRV_DIMENSION_TEXTURE2D, textureFormat);
+
+    ThrowIfFailed(
+        device->CreateTexture2D(&textureDesc, nullptr, &atlasTexture)
+    );
+
+    ThrowIfFailed(
+        device->CreateShaderResourceView(atlasTexture.Get(), &viewDesc, &texture)
+    );
+
+    SetDebugObjectName(texture.Get(), "DirectXTK:SpriteFont");
+    SetDebugObjectName(atlasTexture.Get(), "DirectXTK:SpriteFont");
+
+    device->GetImmediateContext(&deviceContext);
+}
+
+
+// Looks up the requested glyph, returning null if it is not in the font.
+SpriteFont::Glyph const* SpriteFont::Impl::LookupGlyph(uint32_t character) const
+{
+    if (glyphSource)
+    {
+        return LookupSourceGlyph(character);
+    }
+
+    return glyphIndex.Find(character);
+}
+
+
+// Looks up a glyph of a dynamic glyph cache, asking the source for its metrics on first use.
+SpriteFont::Glyph const* SpriteFont::Impl::LookupSourceGlyph(uint32_t character) const
+{
+    auto entry = sourceGlyphs.find(character);
+
+    if (entry != sourceGlyphs.end())
+    {
+        return entry->second.get();
+    }
+
+    auto glyph = std::make_unique<Glyph>();
+
+    if (!glyphSource->GetGlyph(character, glyph.get()))
+    {
+        glyph.reset();
+    }
+    else
+    {
+        glyph->Character = character;
+    }
+
+    return (sourceGlyphs[character] = std::move(glyph)).get();
+}
+
+
+// Makes sure a glyph of a dynamic glyph cache is in the atlas, rasterizing it if it was never loaded or was evicted.
+_Use_decl_annotations_
+void SpriteFont::Impl::MakeResident(Glyph const* glyph) const
+{
+    GlyphAtlas::Region region;
+
+    if (glyphAtlas->Touch(glyph->Character, region))
+        return;
+
+    auto width = static_cast<uint32_t>(glyph->Subrect.right - glyph->Subrect.left);
+    auto height = static_cast<uint32_t>(glyph->Subrect.bottom - glyph->Subrect.top);
+
+    if (!width || !height)
+        return;
+
+    if (!glyphAtlas->Insert(glyph->Character, width + 2 * AtlasGlyphPadding, height + 2 * AtlasGlyphPadding, region))
+    {
+        DebugTrace("ERROR: SpriteFont glyph cache atlas is too small for the glyphs used in a single frame (U+%04X)\n", glyph->Character);
+        throw std::exception("Glyph cache atlas is full");
+    }
+
+    // Rasterize inside a cleared border, and upload the border along with the glyph.
+    size_t rowPitch = size_t(region.width) * 4;
+
+    rasterBuffer.assign(rowPitch * region.height, 0);
+
+    glyphSource->RasterizeGlyph(glyph->Character, rasterBuffer.data() + rowPitch * AtlasGlyphPadding + 4 * AtlasGlyphPadding, rowPitch, height);
+
+    D3D11_BOX box = { region.x, region.y, 0, region.x + region.width, region.y + region.height, 1 };
+
+    deviceContext->UpdateSubresource(atlasTexture.Get(), 0, &box, rasterBuffer.data(), static_cast<UINT>(rowPitch), 0);
+
+    // The stored glyph is the only one with this character, so update its position in place.
+    auto& stored = sourceGlyphs[glyph->Character];
+
+    stored->Subrect.left = static_cast<LONG>(region.x + AtlasGlyphPadding);
+    stored->Subrect.top = static_cast<LONG>(region.y + AtlasGlyphPadding);
+    stored->Subrect.right = stored->Subrect.left + static_cast<LONG>(width);
+    stored->Subrect.bottom = stored->Subrect.top + static_cast<LONG>(height);
 }
 
 
 // Looks up the requested glyph, falling back to the default character if it is not in the font.
-SpriteFont::Glyph const* SpriteFont::Impl::FindGlyph(wchar_t character) const
+SpriteFont::Glyph const* SpriteFont::Impl::FindGlyph(uint32_t character) const
 {
-    auto glyph = std::lower_bound(glyphs.begin(), glyphs.end(), character);
+    auto glyph = LookupGlyph(character);
 
-    if (glyph != glyphs.end() && glyph->Character == character)
+    if (glyph)
     {
-        return &*glyph;
+        return glyph;
     }
 
     if (defaultGlyph)
@@ -157,7 +437,7 @@ SpriteFont::Glyph const* SpriteFont::Impl::FindGlyph(wchar_t character) const
         return defaultGlyph;
     }
 
-    DebugTrace("ERROR: SpriteFont encountered a character not in the font (%u, %C), and no default glyph was provided\n", character, character);
+    DebugTrace("ERROR: SpriteFont encountered a character not in the font (U+%04X), and no default glyph was provided\n", character);
     throw std::exception("Character not in font");
 }
 
@@ -165,6 +445,9 @@ SpriteFont::Glyph const* SpriteFont::Impl::FindGlyph(wchar_t character) const
 // Sets the missing-character fallback glyph.
 void SpriteFont::Impl::SetDefaultCharacter(wchar_t character)
 {
+    // Cached layouts may refer to the previous default glyph.
+    layoutCache.Clear();
+
     defaultGlyph = nullptr;
 
     if (character)
@@ -174,51 +457,121 @@ void SpriteFont::Impl::SetDefaultCharacter(wchar_t character)
 }
 
 
-// The core glyph layout algorithm, shared between DrawString and MeasureString.
-template<typename TAction>
-void SpriteFont::Impl::ForEachGlyph(_In_z_ wchar_t const* text, TAction action) const
+// Replaces the kerning adjustments of the font.
+_Use_decl_annotations_
+void SpriteFont::Impl::SetKerningPairs(KerningPair const* pairs, size_t count)
 {
-    float x = 0;
-    float y = 0;
+    // Cached layouts were computed with the previous kerning.
+    layoutCache.Clear();
 
-    for (; *text; text++)
+    kerningPairs.Clear();
+
+    for (size_t i = 0; i < count; i++)
     {
-        wchar_t character = *text;
+        kerningPairs.Set(pairs[i].First, pairs[i].Second, pairs[i].Amount);
+    }
+}
+
+
+// Looks up the kerning adjustment between two characters.
+float SpriteFont::Impl::GetKerning(uint32_t first, uint32_t second) const
+{
+    return kerningPairs.Get(first, second);
+}
+
+
+// Lays out the glyphs of a string with the glyphs and kerning of this font.
+template<typename TReader, typename TAction>
+void SpriteFont::Impl::ForEachGlyph(TReader reader, TAction action) const
+{
+    LayOutGlyphs(reader, [this](uint32_t character) { return FindGlyph(character); }, kerningPairs, lineSpacing, action);
+}
+
+
+// Draws each character in turn.
+template<typename TReader>
+void XM_CALLCONV SpriteFont::Impl::DrawGlyphs(_In_ SpriteBatch* spriteBatch, TReader reader, FXMVECTOR position, FXMVECTOR color, float rotation, FXMVECTOR origin, GXMVECTOR scale, SpriteEffects effects, float layerDepth) const
+{
+    XMVECTOR baseOffset = origin;
 
-        switch (character)
+    // If the text is mirrored, offset the start position accordingly.
+    if (effects)
+    {
+        baseOffset = XMVectorNegativeMultiplySubtract(
+            MeasureGlyphs(reader),
+            axisIsMirroredTable[effects & 3],
+            baseOffset);
+    }
+
+    ForEachGlyph(reader, [&](Glyph const* glyph, float x, float y, float advance)
+    {
+        UNREFERENCED_PARAMETER(advance);
+
+        if (glyphAtlas)
         {
-            case '\r':
-                // Skip carriage returns.
-                continue;
+            MakeResident(glyph);
+        }
 
-            case '\n':
-                // New line.
-                x = 0;
-                y += lineSpacing;
-                break;
+        XMVECTOR offset = GetGlyphOffset(glyph, x, y, baseOffset, effects);
 
-            default:
-                // Output this character.
-                auto glyph = FindGlyph(character);
+        spriteBatch->Draw(texture.Get(), position, &glyph->Subrect, color, rotation, offset, scale, effects, layerDepth);
+    });
+}
 
-                x += glyph->XOffset;
 
-                if (x < 0)
-                    x = 0;
+// Measures the size of the text.
+template<typename TReader>
+XMVECTOR SpriteFont::Impl::MeasureGlyphs(TReader reader) const
+{
+    return MeasureSize([&](auto action)
+    {
+        ForEachGlyph(reader, action);
+    }, lineSpacing);
+}
 
-                float advance = glyph->Subrect.right - glyph->Subrect.left + glyph->XAdvance;
 
-                if (!iswspace(character)
-                    || ((glyph->Subrect.right - glyph->Subrect.left) > 1)
-                    || ((glyph->Subrect.bottom - glyph->Subrect.top) > 1))
-                {
-                    action(glyph, x, y, advance);
-                }
+// Measures the bounding rectangle of the text, drawn at the given position.
+template<typename TReader>
+RECT SpriteFont::Impl::MeasureGlyphBounds(TReader reader, XMFLOAT2 const& position) const
+{
+    return MeasureBounds([&](auto action)
+    {
+        ForEachGlyph(reader, action);
+    }, position);
+}
+
 
-                x += advance;
-                break;
+// Records the glyph positions of a string, and measures it the same way as MeasureString.
+template<typename TReader>
+void SpriteFont::Impl::BuildLayout(TReader reader, TextLayout& layout) const
+{
+    layout.mGlyphs.clear();
+
+    ForEachGlyph(reader, [&](Glyph const* glyph, float x, float y, float advance)
+    {
+        TextLayout::PlacedGlyph placed = { glyph, x, y, advance };
+
+        layout.mGlyphs.push_back(placed);
+    });
+
+    XMStoreFloat2(&layout.mSize, MeasureSize([&](auto action)
+    {
+        for (auto const& placed : layout.mGlyphs)
+        {
+            action(placed.glyph, placed.x, placed.y, placed.advance);
         }
-    }
+    }, lineSpacing));
+}
+
+
+// Returns the layout of a string from the cache, laying it out if it is not cached yet.
+_Use_decl_annotations_
+SpriteFont::TextLayout const& SpriteFont::Impl::GetCachedLayout(wchar_t const* text) const
+{
+    return layoutCache.Get(text, [&](TextLayout& layout)
+    {
+        BuildLayout(Utf16Reader(text), layout);
+    });
 }
 
 
@@ -249,6 +602,14 @@ SpriteFont::SpriteFont(ID3D11ShaderResourceView* texture, Glyph const* glyphs, s
 }
 
 
+// Construct with a dynamic glyph cache, rasterizing glyphs from the source as they are used.
+_Use_decl_annotations_
+SpriteFont::SpriteFont(ID3D11Device* device, std::unique_ptr<IGlyphSource> glyphSource, uint32_t atlasWidth, uint32_t atlasHeight, bool forceSRGB)
+    : pImpl(std::make_unique<Impl>(device, std::move(glyphSource), atlasWidth, atlasHeight, forceSRGB))
+{
+}
+
+
 // Move constructor.
 SpriteFont::SpriteFont(SpriteFont&& moveFrom) noexcept
     : pImpl(std::move(moveFrom.pImpl))
@@ -290,120 +651,131 @@ void XM_CALLCONV SpriteFont::DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ wc
 
 void XM_CALLCONV SpriteFont::DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ wchar_t const* text, FXMVECTOR position, FXMVECTOR color, float rotation, FXMVECTOR origin, GXMVECTOR scale, SpriteEffects effects, float layerDepth) const
 {
-    static_assert(SpriteEffects_FlipHorizontally == 1 &&
-                  SpriteEffects_FlipVertically == 2, "If you change these enum values, the following tables must be updated to match");
-
-    // Lookup table indicates which way to move along each axis per SpriteEffects enum value.
-    static XMVECTORF32 axisDirectionTable[4] =
+    if (pImpl->layoutCache.GetCapacity())
     {
-        { { { -1, -1, 0, 0 } } },
-        { { {  1, -1, 0, 0 } } },
-        { { { -1,  1, 0, 0 } } },
-        { { {  1,  1, 0, 0 } } },
-    };
+        DrawLayout(spriteBatch, pImpl->GetCachedLayout(text), position, color, rotation, origin, scale, effects, layerDepth);
+        return;
+    }
 
-    // Lookup table indicates which axes are mirrored for each SpriteEffects enum value.
-    static XMVECTORF32 axisIsMirroredTable[4] =
-    {
-        { { { 0, 0, 0, 0 } } },
-        { { { 1, 0, 0, 0 } } },
-        { { { 0, 1, 0, 0 } } },
-        { { { 1, 1, 0, 0 } } },
-    };
+    pImpl->DrawGlyphs(spriteBatch, Utf16Reader(text), position, color, rotation, origin, scale, effects, layerDepth);
+}
 
-    XMVECTOR baseOffset = origin;
 
-    // If the text is mirrored, offset the start position accordingly.
-    if (effects)
+XMVECTOR XM_CALLCONV SpriteFont::MeasureString(_In_z_ wchar_t const* text) const
+{
+    if (pImpl->layoutCache.GetCapacity())
     {
-        baseOffset = XMVectorNegativeMultiplySubtract(
-            MeasureString(text),
-            axisIsMirroredTable[effects & 3],
-            baseOffset);
+        return pImpl->GetCachedLayout(text).GetSize();
     }
 
-    // Draw each character in turn.
-    pImpl->ForEachGlyph(text, [&](Glyph const* glyph, float x, float y, float advance)
+    return pImpl->MeasureGlyphs(Utf16Reader(text));
+}
+
+
+RECT SpriteFont::MeasureDrawBounds(_In_z_ wchar_t const* text, XMFLOAT2 const& position) const
+{
+    if (pImpl->layoutCache.GetCapacity())
     {
-        UNREFERENCED_PARAMETER(advance);
+        return pImpl->GetCachedLayout(text).GetDrawBounds(position);
+    }
 
-        XMVECTOR offset = XMVectorMultiplyAdd(XMVectorSet(x, y + glyph->YOffset, 0, 0), axisDirectionTable[effects & 3], baseOffset);
+    return pImpl->MeasureGlyphBounds(Utf16Reader(text), position);
+}
 
-        if (effects)
-        {
-            // For mirrored characters, specify bottom and/or right instead of top left.
-            XMVECTOR glyphRect = XMConvertVectorIntToFloat(XMLoadInt4(reinterpret_cast<uint32_t const*>(&glyph->Subrect)), 0);
 
-            // xy = glyph width/height.
-            glyphRect = XMVectorSubtract(XMVectorSwizzle<2, 3, 0, 1>(glyphRect), glyphRect);
+RECT XM_CALLCONV SpriteFont::MeasureDrawBounds(_In_z_ wchar_t const* text, FXMVECTOR position) const
+{
+    XMFLOAT2 pos;
+    XMStoreFloat2(&pos, position);
 
-            offset = XMVectorMultiplyAdd(glyphRect, axisIsMirroredTable[effects & 3], offset);
-        }
+    return MeasureDrawBounds(text, pos);
+}
 
-        spriteBatch->Draw(pImpl->texture.Get(), position, &glyph->Subrect, color, rotation, offset, scale, effects, layerDepth);
-    });
+
+// UTF-8 text
+void XM_CALLCONV SpriteFont::DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ char const* text, XMFLOAT2 const& position, FXMVECTOR color, float rotation, XMFLOAT2 const& origin, float scale, SpriteEffects effects, float layerDepth) const
+{
+    DrawString(spriteBatch, text, XMLoadFloat2(&position), color, rotation, XMLoadFloat2(&origin), XMVectorReplicate(scale), effects, layerDepth);
 }
 
 
-XMVECTOR XM_CALLCONV SpriteFont::MeasureString(_In_z_ wchar_t const* text) const
+void XM_CALLCONV SpriteFont::DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ char const* text, XMFLOAT2 const& position, FXMVECTOR color, float rotation, XMFLOAT2 const& origin, XMFLOAT2 const& scale, SpriteEffects effects, float layerDepth) const
 {
-    XMVECTOR result = XMVectorZero();
+    DrawString(spriteBatch, text, XMLoadFloat2(&position), color, rotation, XMLoadFloat2(&origin), XMLoadFloat2(&scale), effects, layerDepth);
+}
 
-    pImpl->ForEachGlyph(text, [&](Glyph const* glyph, float x, float y, float advance)
-    {
-        UNREFERENCED_PARAMETER(advance);
 
-        auto w = static_cast<float>(glyph->Subrect.right - glyph->Subrect.left);
-        auto h = static_cast<float>(glyph->Subrect.bottom - glyph->Subrect.top) + glyph->YOffset;
+void XM_CALLCONV SpriteFont::DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ char const* text, FXMVECTOR position, FXMVECTOR color, float rotation, FXMVECTOR origin, float scale, SpriteEffects effects, float layerDepth) const
+{
+    DrawString(spriteBatch, text, position, color, rotation, origin, XMVectorReplicate(scale), effects, layerDepth);
+}
 
-        h = std::max(h, pImpl->lineSpacing);
 
-        result = XMVectorMax(result, XMVectorSet(x + w, y + h, 0, 0));
-    });
+void XM_CALLCONV SpriteFont::DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ char const* text, FXMVECTOR position, FXMVECTOR color, float rotation, FXMVECTOR origin, GXMVECTOR scale, SpriteEffects effects, float layerDepth) const
+{
+    pImpl->DrawGlyphs(spriteBatch, Utf32Reader(DecodeUtf8(text)), position, color, rotation, origin, scale, effects, layerDepth);
+}
+
 
-    return result;
+XMVECTOR XM_CALLCONV SpriteFont::MeasureString(_In_z_ char const* text) const
+{
+    return pImpl->MeasureGlyphs(Utf32Reader(DecodeUtf8(text)));
 }
 
 
-RECT SpriteFont::MeasureDrawBounds(_In_z_ wchar_t const* text, XMFLOAT2 const& position) const
+RECT SpriteFont::MeasureDrawBounds(_In_z_ char const* text, XMFLOAT2 const& position) const
 {
-    RECT result = { LONG_MAX, LONG_MAX, 0, 0 };
+    return pImpl->MeasureGlyphBounds(Utf32Reader(DecodeUtf8(text)), position);
+}
 
-    pImpl->ForEachGlyph(text, [&](Glyph const* glyph, float x, float y, float advance)
-    {
-        auto w = static_cast<float>(glyph->Subrect.right - glyph->Subrect.left);
-        auto h = static_cast<float>(glyph->Subrect.bottom - glyph->Subrect.top);
 
-        float minX = position.x + x;
-        float minY = position.y + y + glyph->YOffset;
+RECT XM_CALLCONV SpriteFont::MeasureDrawBounds(_In_z_ char const* text, FXMVECTOR position) const
+{
+    XMFLOAT2 pos;
+    XMStoreFloat2(&pos, position);
 
-        float maxX = std::max(minX + advance, minX + w);
-        float maxY = minY + h;
+    return MeasureDrawBounds(text, pos);
+}
 
-        if (minX < result.left)
-            result.left = long(minX);
 
-        if (minY < result.top)
-            result.top = long(minY);
+// UTF-32 text
+void XM_CALLCONV SpriteFont::DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ char32_t const* text, XMFLOAT2 const& position, FXMVECTOR color, float rotation, XMFLOAT2 const& origin, float scale, SpriteEffects effects, float layerDepth) const
+{
+    DrawString(spriteBatch, text, XMLoadFloat2(&position), color, rotation, XMLoadFloat2(&origin), XMVectorReplicate(scale), effects, layerDepth);
+}
 
-        if (result.right < maxX)
-            result.right = long(maxX);
 
-        if (result.bottom < maxY)
-            result.bottom = long(maxY);
-    });
+void XM_CALLCONV SpriteFont::DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ char32_t const* text, XMFLOAT2 const& position, FXMVECTOR color, float rotation, XMFLOAT2 const& origin, XMFLOAT2 const& scale, SpriteEffects effects, float layerDepth) const
+{
+    DrawString(spriteBatch, text, XMLoadFloat2(&position), color, rotation, XMLoadFloat2(&origin), XMLoadFloat2(&scale), effects, layerDepth);
+}
 
-    if (result.left == LONG_MAX)
-    {
-        result.left = 0;
-        result.top = 0;
-    }
 
-    return result;
+void XM_CALLCONV SpriteFont::DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ char32_t const* text, FXMVECTOR position, FXMVECTOR color, float rotation, FXMVECTOR origin, float scale, SpriteEffects effects, float layerDepth) const
+{
+    DrawString(spriteBatch, text, position, color, rotation, origin, XMVectorReplicate(scale), effects, layerDepth);
 }
 
 
-RECT XM_CALLCONV SpriteFont::MeasureDrawBounds(_In_z_ wchar_t const* text, FXMVECTOR position) const
+void XM_CALLCONV SpriteFont::DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ char32_t const* text, FXMVECTOR position, FXMVECTOR color, float rotation, FXMVECTOR origin, GXMVECTOR scale, SpriteEffects effects, float layerDepth) const
+{
+    pImpl->DrawGlyphs(spriteBatch, Utf32Reader(text), position, color, rotation, origin, scale, effects, layerDepth);
+}
+
+
+XMVECTOR XM_CALLCONV SpriteFont::MeasureString(_In_z_ char32_t const* text) const
+{
+    return pImpl->MeasureGlyphs(Utf32Reader(text));
+}
+
+
+RECT SpriteFont::MeasureDrawBounds(_In_z_ char32_t const* text, XMFLOAT2 const& position) const
+{
+    return pImpl->MeasureGlyphBounds(Utf32Reader(text), position);
+}
+
+
+RECT XM_CALLCONV SpriteFont::MeasureDrawBounds(_In_z_ char32_t const* text, FXMVECTOR position) const
 {
     XMFLOAT2 pos;
     XMStoreFloat2(&pos, position);
@@ -412,6 +784,94 @@ RECT XM_CALLCONV SpriteFont::MeasureDrawBounds(_In_z_ wchar_t const* text, FXMVE
 }
 
 
+// Precomputed layouts
+SpriteFont::TextLayout SpriteFont::CreateLayout(_In_z_ wchar_t const* text) const
+{
+    TextLayout layout;
+
+    pImpl->BuildLayout(Utf16Reader(text), layout);
+
+    return layout;
+}
+
+
+SpriteFont::TextLayout SpriteFont::CreateLayout(_In_z_ char const* text) const
+{
+    TextLayout layout;
+
+    pImpl->BuildLayout(Utf32Reader(DecodeUtf8(text)), layout);
+
+    return layout;
+}
+
+
+SpriteFont::TextLayout SpriteFont::CreateLayout(_In_z_ char32_t const* text) const
+{
+    TextLayout layout;
+
+    pImpl->BuildLayout(Utf32Reader(text), layout);
+
+    return layout;
+}
+
+
+void XM_CALLCONV SpriteFont::DrawLayout(_In_ SpriteBatch* spriteBatch, TextLayout const& layout, XMFLOAT2 const& position, FXMVECTOR color, float rotation, XMFLOAT2 const& origin, float scale, SpriteEffects effects, float layerDepth) const
+{
+    DrawLayout(spriteBatch, layout, XMLoadFloat2(&position), color, rotation, XMLoadFloat2(&origin), XMVectorReplicate(scale), effects, layerDepth);
+}
+
+
+void XM_CALLCONV SpriteFont::DrawLayout(_In_ SpriteBatch* spriteBatch, TextLayout const& layout, FXMVECTOR position, FXMVECTOR color, float rotation, FXMVECTOR origin, GXMVECTOR scale, SpriteEffects effects, float layerDepth) const
+{
+    XMVECTOR baseOffset = origin;
+
+    // If the text is mirrored, offset the start position by the size measured when the layout was created.
+    if (effects)
+    {
+        baseOffset = XMVectorNegativeMultiplySubtract(
+            layout.GetSize(),
+            axisIsMirroredTable[effects & 3],
+            baseOffset);
+    }
+
+    for (auto const& placed : layout.mGlyphs)
+    {
+        if (pImpl->glyphAtlas)
+        {
+            pImpl->MakeResident(placed.glyph);
+        }
+
+        XMVECTOR offset = GetGlyphOffset(placed.glyph, placed.x, placed.y, baseOffset, effects);
+
+        spriteBatch->Draw(pImpl->texture.Get(), position, &placed.glyph->Subrect, color, rotation, offset, scale, effects, layerDepth);
+    }
+}
+
+
+RECT SpriteFont::TextLayout::GetDrawBounds(XMFLOAT2 const& position) const
+{
+    return MeasureBounds([&](auto action)
+    {
+        for (auto const& placed : mGlyphs)
+        {
+            action(placed.glyph, placed.x, placed.y, placed.advance);
+        }
+    }, position);
+}
+
+
+void SpriteFont::SetLayoutCacheSize(size_t count)
+{
+    pImpl->layoutCache.SetCapacity(count);
+}
+
+
+size_t SpriteFont::GetLayoutCacheSize() const
+{
+    return pImpl->layoutCache.GetCapacity();
+}
+
+
 // Spacing properties
 float SpriteFont::GetLineSpacing() const
 {
@@ -422,6 +882,9 @@ float SpriteFont::GetLineSpacing() const
 void SpriteFont::SetLineSpacing(float spacing)
 {
     pImpl->lineSpacing = spacing;
+
+    // Cached layouts were computed with the previous line spacing.
+    pImpl->layoutCache.Clear();
 }
 
 
@@ -440,14 +903,46 @@ void SpriteFont::SetDefaultCharacter(wchar_t character)
 
 bool SpriteFont::ContainsCharacter(wchar_t character) const
 {
-    return std::binary_search(pImpl->glyphs.begin(), pImpl->glyphs.end(), character);
+    return pImpl->LookupGlyph(character) != nullptr;
+}
+
+
+// Kerning
+_Use_decl_annotations_
+void SpriteFont::SetKerningPairs(KerningPair const* pairs, size_t count)
+{
+    pImpl->SetKerningPairs(pairs, count);
+}
+
+
+float SpriteFont::GetKerning(uint32_t first, uint32_t second) const
+{
+    return pImpl->GetKerning(first, second);
+}
+
+
+// Dynamic glyph cache
+void SpriteFont::AdvanceGlyphCacheFrame()
+{
+    if (pImpl->glyphAtlas)
+    {
+        pImpl->glyphAtlas->NextFrame();
+    }
 }
 
 
 // Custom layout/rendering
 SpriteFont::Glyph const* SpriteFont::FindGlyph(wchar_t character) const
 {
-    return pImpl->FindGlyph(character);
+    auto glyph = pImpl->FindGlyph(character);
+
+    // The caller draws from the sprite sheet, so the glyph must be in the atlas.
+    if (pImpl->glyphAtlas)
+    {
+        pImpl->MakeResident(glyph);
+    }
+
+    return glyph;
 }
 
 
@@ -0,0 +1,163 @@
+//--------------------------------------------------------------------------------------
+// File: SpriteSort.h
+//
+// Sorts the sprites queued by SpriteBatch on packed 64-bit keys. This has no Direct3D
+// dependencies, so the sort can be tested and measured on the CPU alone.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpriteVertices.h"
+
+#include <string.h>
+#include <unordered_map>
+#include <utility>
+
+
+namespace DirectX
+{
+    // Sort key for a single queued sprite. The key is sorted, the index refers back into the sprite queue.
+    struct SpriteSortKey
+    {
+        uint64_t key;
+        uint32_t index;
+    };
+
+
+    // The orders the keys can express, one for each sorting SpriteSortMode.
+    enum SpriteKeyOrder
+    {
+        SpriteKeyOrder_Texture,
+        SpriteKeyOrder_BackToFront,
+        SpriteKeyOrder_FrontToBack,
+    };
+
+
+    // Helper maps a float to an unsigned integer with the same ordering.
+    inline uint32_t FloatToSortableBits(float value)
+    {
+        // Treat -0 and +0 as equal.
+        if (value == 0)
+            value = 0;
+
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+
+        // Negative values have their order reversed, positive values are moved above them.
+        return (bits & 0x80000000) ? ~bits : (bits | 0x80000000);
+    }
+
+
+    // Computes the sort keys of a range of sprites in a single pass:
+    // - upper half: the depth, as order-preserving bits (inverted for back to front); zero when sorting by texture
+    // - lower half: a dense texture ID, assigned in order of first use
+    // The index of each key is the position of its sprite in the range, so equal keys keep their submission order.
+    inline void BuildSpriteSortKeys(_In_reads_(count) SpriteInfo const* sprites,
+        size_t count,
+        SpriteKeyOrder order,
+        _Out_writes_(count) SpriteSortKey* keys,
+        std::unordered_map<ID3D11ShaderResourceView*, uint32_t>& textureIDs)
+    {
+        // The map is only consulted when the texture changes.
+        textureIDs.clear();
+
+        ID3D11ShaderResourceView* lastTexture = nullptr;
+        uint32_t textureID = 0;
+
+        for (size_t i = 0; i < count; i++)
+        {
+            SpriteInfo const& sprite = sprites[i];
+
+            if (sprite.texture != lastTexture)
+            {
+                textureID = textureIDs.emplace(sprite.texture, static_cast<uint32_t>(textureIDs.size())).first->second;
+                lastTexture = sprite.texture;
+            }
+
+            uint64_t key;
+
+            switch (order)
+            {
+                case SpriteKeyOrder_BackToFront:
+                    key = (static_cast<uint64_t>(~FloatToSortableBits(sprite.originRotationDepth.w)) << 32) | textureID;
+                    break;
+
+                case SpriteKeyOrder_FrontToBack:
+                    key = (static_cast<uint64_t>(FloatToSortableBits(sprite.originRotationDepth.w)) << 32) | textureID;
+                    break;
+
+                default:
+                    key = textureID;
+                    break;
+            }
+
+            keys[i].key = key;
+            keys[i].index = static_cast<uint32_t>(i);
+        }
+    }
+
+
+    // Stable least significant digit radix sort on 8-bit digits, in linear time.
+    // Digits that are identical for all keys are skipped, so narrow keys only pay for the bytes they use.
+    inline void RadixSortSpriteKeys(_Inout_updates_(count) SpriteSortKey* keys, _Out_writes_(count) SpriteSortKey* scratch, size_t count)
+    {
+        if (count == 0)
+            return;
+
+        const size_t DigitCount = sizeof(uint64_t);
+
+        // Build the histograms of all digits in a single pass.
+        uint32_t histograms[DigitCount][256] = {};
+
+        for (size_t i = 0; i < count; i++)
+        {
+            uint64_t key = keys[i].key;
+
+            for (size_t digit = 0; digit < DigitCount; digit++)
+            {
+                histograms[digit][(key >> (digit * 8)) & 0xFF]++;
+            }
+        }
+
+        SpriteSortKey* source = keys;
+        SpriteSortKey* destination = scratch;
+
+        for (size_t digit = 0; digit < DigitCount; digit++)
+        {
+            uint32_t* histogram = histograms[digit];
+            const unsigned int shift = static_cast<unsigned int>(digit * 8);
+
+            // Skip this digit if all keys share the same value.
+            if (histogram[(source[0].key >> shift) & 0xFF] == count)
+                continue;
+
+            // Turn the histogram into the starting offsets of each bucket.
+            uint32_t offset = 0;
+
+            for (size_t bucket = 0; bucket < 256; bucket++)
+            {
+                uint32_t bucketSize = histogram[bucket];
+                histogram[bucket] = offset;
+                offset += bucketSize;
+            }
+
+            // Scatter the keys into their buckets, preserving the order of equal digits.
+            for (size_t i = 0; i < count; i++)
+            {
+                destination[histogram[(source[i].key >> shift) & 0xFF]++] = source[i];
+            }
+
+            std::swap(source, destination);
+        }
+
+        if (source != keys)
+        {
+            memcpy(keys, source, sizeof(SpriteSortKey) * count);
+        }
+    }
+}
@@ -0,0 +1,472 @@
+//--------------------------------------------------------------------------------------
+// File: SpriteVertices.cpp
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "pch.h"
+#include "SpriteVertices.h"
+
+#include <ppl.h>
+
+#if defined(_M_IX86) || defined(_M_X64)
+#include <intrin.h>
+#define SPRITEBATCH_AVX2
+#endif
+
+using namespace DirectX;
+
+namespace
+{
+    // Ranges of at least this many sprites are split into chunks for the worker pool.
+    const size_t MinParallelBatchSize = 512;
+    const size_t ParallelChunkSize = 128;
+
+
+#ifdef SPRITEBATCH_AVX2
+    // Helper checks whether the CPU and the operating system support AVX2.
+    bool DetectAVX2()
+    {
+        int info[4];
+
+        __cpuid(info, 0);
+        if (info[0] < 7)
+            return false;
+
+        // The CPU must support AVX and XSAVE, and the OS must save the YMM registers.
+        __cpuid(info, 1);
+        if ((info[2] & 0x18000000) != 0x18000000)
+            return false;
+
+        if ((_xgetbv(0) & 0x6) != 0x6)
+            return false;
+
+        __cpuidex(info, 7, 0);
+        return (info[1] & 0x20) != 0;
+    }
+
+
+    // The CPU features are only queried once.
+    bool CanUseAVX2()
+    {
+        static const bool avx2 = DetectAVX2();
+        return avx2;
+    }
+
+
+    // Computes the sine and cosine of eight angles, using the same range reduction
+    // and minimax polynomials as XMScalarSinCos.
+    inline void SinCosAVX2(__m256 const& value, __m256& sin, __m256& cos)
+    {
+        // Map value to y in [-pi,pi], x = 2*pi*quotient + remainder, rounding the quotient away from zero.
+        __m256 positive = _mm256_cmp_ps(value, _mm256_setzero_ps(), _CMP_GE_OQ);
+        __m256 half = _mm256_blendv_ps(_mm256_set1_ps(-0.5f), _mm256_set1_ps(0.5f), positive);
+        __m256 quotient = _mm256_round_ps(_mm256_add_ps(_mm256_mul_ps(value, _mm256_set1_ps(XM_1DIV2PI)), half), _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+        __m256 y = _mm256_sub_ps(value, _mm256_mul_ps(quotient, _mm256_set1_ps(XM_2PI)));
+
+        // Map y to [-pi/2,pi/2] with sin(y) = sin(value).
+        __m256 above = _mm256_cmp_ps(y, _mm256_set1_ps(XM_PIDIV2), _CMP_GT_OQ);
+        __m256 below = _mm256_cmp_ps(y, _mm256_set1_ps(-XM_PIDIV2), _CMP_LT_OQ);
+        y = _mm256_blendv_ps(y, _mm256_sub_ps(_mm256_set1_ps(XM_PI), y), above);
+        y = _mm256_blendv_ps(y, _mm256_sub_ps(_mm256_set1_ps(-XM_PI), y), below);
+        __m256 sign = _mm256_blendv_ps(_mm256_set1_ps(1.0f), _mm256_set1_ps(-1.0f), _mm256_or_ps(above, below));
+
+        __m256 y2 = _mm256_mul_ps(y, y);
+
+        // 11-degree minimax approximation
+        __m256 s = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(-2.3889859e-08f), y2), _mm256_set1_ps(2.7525562e-06f));
+        s = _mm256_add_ps(_mm256_mul_ps(s, y2), _mm256_set1_ps(-0.00019840874f));
+        s = _mm256_add_ps(_mm256_mul_ps(s, y2), _mm256_set1_ps(0.0083333310f));
+        s = _mm256_add_ps(_mm256_mul_ps(s, y2), _mm256_set1_ps(-0.16666667f));
+        s = _mm256_add_ps(_mm256_mul_ps(s, y2), _mm256_set1_ps(1.0f));
+        sin = _mm256_mul_ps(s, y);
+
+        // 10-degree minimax approximation
+        __m256 c = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(-2.6051615e-07f), y2), _mm256_set1_ps(2.4760495e-05f));
+        c = _mm256_add_ps(_mm256_mul_ps(c, y2), _mm256_set1_ps(-0.0013888378f));
+        c = _mm256_add_ps(_mm256_mul_ps(c, y2), _mm256_set1_ps(0.041666638f));
+        c = _mm256_add_ps(_mm256_mul_ps(c, y2), _mm256_set1_ps(-0.5f));
+        c = _mm256_add_ps(_mm256_mul_ps(c, y2), _mm256_set1_ps(1.0f));
+        cos = _mm256_mul_ps(sign, c);
+    }
+
+
+    // The same information for eight sprites, as a structure of arrays, so that
+    // the vertex expansion can process one sprite per SIMD lane.
+    struct __declspec(align(32)) SpriteInfoSoA
+    {
+        static const size_t Width = 8;
+
+        float sourceX[Width];
+        float sourceY[Width];
+        float sourceWidth[Width];
+        float sourceHeight[Width];
+        float destinationX[Width];
+        float destinationY[Width];
+        float destinationWidth[Width];
+        float destinationHeight[Width];
+        float colorR[Width];
+        float colorG[Width];
+        float colorB[Width];
+        float colorA[Width];
+        float originX[Width];
+        float originY[Width];
+        float rotation[Width];
+        float depth[Width];
+        int flags[Width];
+
+        void Load(_In_reads_(Width) SpriteInfo const* const* sprites);
+    };
+
+
+    // Transposes eight queued sprites into structure of arrays form.
+    _Use_decl_annotations_
+    void SpriteInfoSoA::Load(SpriteInfo const* const* sprites)
+    {
+        for (size_t lane = 0; lane < Width; lane++)
+        {
+            SpriteInfo const* sprite = sprites[lane];
+
+            sourceX[lane] = sprite->source.x;
+            sourceY[lane] = sprite->source.y;
+            sourceWidth[lane] = sprite->source.z;
+            sourceHeight[lane] = sprite->source.w;
+            destinationX[lane] = sprite->destination.x;
+            destinationY[lane] = sprite->destination.y;
+            destinationWidth[lane] = sprite->destination.z;
+            destinationHeight[lane] = sprite->destination.w;
+            colorR[lane] = sprite->color.x;
+            colorG[lane] = sprite->color.y;
+            colorB[lane] = sprite->color.z;
+            colorA[lane] = sprite->color.w;
+            originX[lane] = sprite->originRotationDepth.x;
+            originY[lane] = sprite->originRotationDepth.y;
+            rotation[lane] = sprite->originRotationDepth.z;
+            depth[lane] = sprite->originRotationDepth.w;
+            flags[lane] = sprite->flags;
+        }
+    }
+
+
+    // Generates vertex data for eight sprites per iteration, one sprite per AVX2 lane. This mirrors RenderSprite
+    // operation by operation, so both routines produce the same vertices. The count must be a multiple of eight.
+    void XM_CALLCONV RenderSpritesAVX2(_In_reads_(count) SpriteInfo const* const* sprites,
+        size_t count,
+        _Out_writes_(count * VerticesPerSprite) VertexPositionColorTexture* vertices,
+        FXMVECTOR textureSize,
+        FXMVECTOR inverseTextureSize)
+    {
+        const size_t Width = SpriteInfoSoA::Width;
+
+        assert((count % Width) == 0);
+
+        SpriteInfoSoA soa;
+
+        // Results for each corner, one sprite per lane.
+        __declspec(align(32)) float positionX[VerticesPerSprite][Width];
+        __declspec(align(32)) float positionY[VerticesPerSprite][Width];
+        __declspec(align(32)) float textureU[VerticesPerSprite][Width];
+        __declspec(align(32)) float textureV[VerticesPerSprite][Width];
+
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256 one = _mm256_set1_ps(1.0f);
+        const __m256 epsilon = _mm256_set1_ps(g_XMEpsilon.f[0]);
+        const __m256i zeroInt = _mm256_setzero_si256();
+        const __m256 textureWidth = _mm256_set1_ps(XMVectorGetX(textureSize));
+        const __m256 textureHeight = _mm256_set1_ps(XMVectorGetY(textureSize));
+        const __m256 inverseTextureWidth = _mm256_set1_ps(XMVectorGetX(inverseTextureSize));
+        const __m256 inverseTextureHeight = _mm256_set1_ps(XMVectorGetY(inverseTextureSize));
+
+        for (size_t base = 0; base < count; base += Width)
+        {
+            soa.Load(sprites + base);
+
+            __m256 sourceX = _mm256_load_ps(soa.sourceX);
+            __m256 sourceY = _mm256_load_ps(soa.sourceY);
+            __m256 sourceWidth = _mm256_load_ps(soa.sourceWidth);
+            __m256 sourceHeight = _mm256_load_ps(soa.sourceHeight);
+            __m256 destinationX = _mm256_load_ps(soa.destinationX);
+            __m256 destinationY = _mm256_load_ps(soa.destinationY);
+            __m256 destinationWidth = _mm256_load_ps(soa.destinationWidth);
+            __m256 destinationHeight = _mm256_load_ps(soa.destinationHeight);
+            __m256 rotation = _mm256_load_ps(soa.rotation);
+            __m256i flags = _mm256_load_si256(reinterpret_cast<__m256i const*>(soa.flags));
+
+            // Scale the origin offset by source size, taking care to avoid overflow if the source region is zero.
+            __m256 nonZeroSourceWidth = _mm256_blendv_ps(sourceWidth, epsilon, _mm256_cmp_ps(sourceWidth, zero, _CMP_EQ_OQ));
+            __m256 nonZeroSourceHeight = _mm256_blendv_ps(sourceHeight, epsilon, _mm256_cmp_ps(sourceHeight, zero, _CMP_EQ_OQ));
+
+            __m256 originX = _mm256_div_ps(_mm256_load_ps(soa.originX), nonZeroSourceWidth);
+            __m256 originY = _mm256_div_ps(_mm256_load_ps(soa.originY), nonZeroSourceHeight);
+
+            // Convert the source region from texels to mod-1 texture coordinate format.
+            __m256 sourceInTexels = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_and_si256(flags, _mm256_set1_epi32(SpriteInfo::SourceInTexels)), zeroInt));
+
+            sourceX = _mm256_blendv_ps(sourceX, _mm256_mul_ps(sourceX, inverseTextureWidth), sourceInTexels);
+            sourceY = _mm256_blendv_ps(sourceY, _mm256_mul_ps(sourceY, inverseTextureHeight), sourceInTexels);
+            sourceWidth = _mm256_blendv_ps(sourceWidth, _mm256_mul_ps(sourceWidth, inverseTextureWidth), sourceInTexels);
+            sourceHeight = _mm256_blendv_ps(sourceHeight, _mm256_mul_ps(sourceHeight, inverseTextureHeight), sourceInTexels);
+            originX = _mm256_blendv_ps(_mm256_mul_ps(originX, inverseTextureWidth), originX, sourceInTexels);
+            originY = _mm256_blendv_ps(_mm256_mul_ps(originY, inverseTextureHeight), originY, sourceInTexels);
+
+            // If the destination size is relative to the source region, convert it to pixels.
+            __m256 destSizeInPixels = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_and_si256(flags, _mm256_set1_epi32(SpriteInfo::DestSizeInPixels)), zeroInt));
+
+            destinationWidth = _mm256_blendv_ps(_mm256_mul_ps(destinationWidth, textureWidth), destinationWidth, destSizeInPixels);
+            destinationHeight = _mm256_blendv_ps(_mm256_mul_ps(destinationHeight, textureHeight), destinationHeight, destSizeInPixels);
+
+            // Compute the 2x2 rotation matrices, using the identity for sprites that are not rotated.
+            __m256 sin, cos;
+
+            SinCosAVX2(rotation, sin, cos);
+
+            __m256 unrotated = _mm256_cmp_ps(rotation, zero, _CMP_EQ_OQ);
+
+            __m256 negativeSin = _mm256_blendv_ps(_mm256_xor_ps(sin, _mm256_set1_ps(-0.0f)), zero, unrotated);
+            sin = _mm256_blendv_ps(sin, zero, unrotated);
+            cos = _mm256_blendv_ps(cos, one, unrotated);
+
+            // Texture coordinates index the corners in a different order if the sprite is mirrored.
+            __m256i mirrorBits = _mm256_and_si256(flags, _mm256_set1_epi32(3));
+
+            // Generate the four output corners.
+            for (size_t i = 0; i < VerticesPerSprite; i++)
+            {
+                // Calculate position.
+                __m256 cornerX = _mm256_set1_ps(static_cast<float>(i & 1));
+                __m256 cornerY = _mm256_set1_ps(static_cast<float>(i >> 1));
+
+                __m256 offsetX = _mm256_mul_ps(_mm256_sub_ps(cornerX, originX), destinationWidth);
+                __m256 offsetY = _mm256_mul_ps(_mm256_sub_ps(cornerY, originY), destinationHeight);
+
+                // Apply 2x2 rotation matrix.
+                __m256 position1X = _mm256_add_ps(_mm256_mul_ps(offsetX, cos), destinationX);
+                __m256 position1Y = _mm256_add_ps(_mm256_mul_ps(offsetX, sin), destinationY);
+
+                _mm256_store_ps(positionX[i], _mm256_add_ps(_mm256_mul_ps(offsetY, negativeSin), position1X));
+                _mm256_store_ps(positionY[i], _mm256_add_ps(_mm256_mul_ps(offsetY, cos), position1Y));
+
+                // Compute the texture coordinate.
+                __m256i textureCorner = _mm256_xor_si256(mirrorBits, _mm256_set1_epi32(static_cast<int>(i)));
+                __m256 textureCornerX = _mm256_cvtepi32_ps(_mm256_and_si256(textureCorner, _mm256_set1_epi32(1)));
+                __m256 textureCornerY = _mm256_cvtepi32_ps(_mm256_srli_epi32(textureCorner, 1));
+
+                _mm256_store_ps(textureU[i], _mm256_add_ps(_mm256_mul_ps(textureCornerX, sourceWidth), sourceX));
+                _mm256_store_ps(textureV[i], _mm256_add_ps(_mm256_mul_ps(textureCornerY, sourceHeight), sourceY));
+            }
+
+            // Write the interleaved vertices.
+            for (size_t lane = 0; lane < Width; lane++)
+            {
+                XMFLOAT4 color(soa.colorR[lane], soa.colorG[lane], soa.colorB[lane], soa.colorA[lane]);
+
+                for (size_t i = 0; i < VerticesPerSprite; i++)
+                {
+                    vertices[i].position = XMFLOAT3(positionX[i][lane], positionY[i][lane], soa.depth[lane]);
+                    vertices[i].color = color;
+                    vertices[i].textureCoordinate = XMFLOAT2(textureU[i][lane], textureV[i][lane]);
+                }
+
+                vertices += VerticesPerSprite;
+            }
+        }
+
+        // Avoid AVX to SSE transition penalties in the code that follows.
+        _mm256_zeroupper();
+    }
+#endif
+}
+
+
+// Generates vertex data for drawing a range of sprites.
+_Use_decl_annotations_
+void XM_CALLCONV DirectX::RenderSprites(SpriteInfo const* const* sprites,
+    size_t count,
+    VertexPositionColorTexture* vertices,
+    FXMVECTOR textureSize,
+    FXMVECTOR inverseTextureSize,
+    bool parallel)
+{
+    if (parallel && count >= MinParallelBatchSize)
+    {
+        // Each sprite only writes its own four vertices, so the chunks can be expanded
+        // concurrently, straight into disjoint ranges of the mapped vertex buffer.
+        XMFLOAT4A size, inverseSize;
+        XMStoreFloat4A(&size, textureSize);
+        XMStoreFloat4A(&inverseSize, inverseTextureSize);
+
+        size_t chunkCount = (count + ParallelChunkSize - 1) / ParallelChunkSize;
+
+        concurrency::parallel_for(size_t(0), chunkCount, [=, &size, &inverseSize](size_t chunk)
+        {
+            XMVECTOR chunkTextureSize = XMLoadFloat4A(&size);
+            XMVECTOR chunkInverseTextureSize = XMLoadFloat4A(&inverseSize);
+
+            size_t begin = chunk * ParallelChunkSize;
+            size_t end = std::min(begin + ParallelChunkSize, count);
+
+            RenderSpriteRange(sprites + begin, end - begin, vertices + begin * VerticesPerSprite, chunkTextureSize, chunkInverseTextureSize);
+        });
+    }
+    else
+    {
+        RenderSpriteRange(sprites, count, vertices, textureSize, inverseTextureSize);
+    }
+}
+
+
+// Generates vertex data for a range of sprites on the current thread, eight at a time if the CPU supports AVX2.
+_Use_decl_annotations_
+void XM_CALLCONV DirectX::RenderSpriteRange(SpriteInfo const* const* sprites,
+    size_t count,
+    VertexPositionColorTexture* vertices,
+    FXMVECTOR textureSize,
+    FXMVECTOR inverseTextureSize)
+{
+#ifdef SPRITEBATCH_AVX2
+    if (count >= SpriteInfoSoA::Width && CanUseAVX2())
+    {
+        size_t wideCount = count - (count % SpriteInfoSoA::Width);
+
+        RenderSpritesAVX2(sprites, wideCount, vertices, textureSize, inverseTextureSize);
+
+        sprites += wideCount;
+        vertices += wideCount * VerticesPerSprite;
+        count -= wideCount;
+    }
+#endif
+
+    // Any remaining sprites are expanded one at a time.
+    for (size_t i = 0; i < count; i++)
+    {
+        RenderSprite(sprites[i], vertices, textureSize, inverseTextureSize);
+
+        vertices += VerticesPerSprite;
+    }
+}
+
+
+// Reports whether RenderSpriteRange takes the eight-wide path on this CPU.
+bool DirectX::CanRenderSpritesWithAVX2()
+{
+#ifdef SPRITEBATCH_AVX2
+    return CanUseAVX2();
+#else
+    return false;
+#endif
+}
+
+
+// Generates vertex data for drawing a single sprite.
+_Use_decl_annotations_
+void XM_CALLCONV DirectX::RenderSprite(SpriteInfo const* sprite,
+    VertexPositionColorTexture* vertices,
+    FXMVECTOR textureSize,
+    FXMVECTOR inverseTextureSize)
+{
+    // Load sprite parameters into SIMD registers.
+    XMVECTOR source = XMLoadFloat4A(&sprite->source);
+    XMVECTOR destination = XMLoadFloat4A(&sprite->destination);
+    XMVECTOR color = XMLoadFloat4A(&sprite->color);
+    XMVECTOR originRotationDepth = XMLoadFloat4A(&sprite->originRotationDepth);
+
+    float rotation = sprite->originRotationDepth.z;
+    int flags = sprite->flags;
+
+    // Extract the source and destination sizes into separate vectors.
+    XMVECTOR sourceSize = XMVectorSwizzle<2, 3, 2, 3>(source);
+    XMVECTOR destinationSize = XMVectorSwizzle<2, 3, 2, 3>(destination);
+
+    // Scale the origin offset by source size, taking care to avoid overflow if the source region is zero.
+    XMVECTOR isZeroMask = XMVectorEqual(sourceSize, XMVectorZero());
+    XMVECTOR nonZeroSourceSize = XMVectorSelect(sourceSize, g_XMEpsilon, isZeroMask);
+
+    XMVECTOR origin = XMVectorDivide(originRotationDepth, nonZeroSourceSize);
+
+    // Convert the source region from texels to mod-1 texture coordinate format.
+    if (flags & SpriteInfo::SourceInTexels)
+    {
+        source = XMVectorMultiply(source, inverseTextureSize);
+        sourceSize = XMVectorMultiply(sourceSize, inverseTextureSize);
+    }
+    else
+    {
+        origin = XMVectorMultiply(origin, inverseTextureSize);
+    }
+
+    // If the destination size is relative to the source region, convert it to pixels.
+    if (!(flags & SpriteInfo::DestSizeInPixels))
+    {
+        destinationSize = XMVectorMultiply(destinationSize, textureSize);
+    }
+
+    // Compute a 2x2 rotation matrix.
+    XMVECTOR rotationMatrix1;
+    XMVECTOR rotationMatrix2;
+
+    if (rotation != 0)
+    {
+        float sin, cos;
+
+        XMScalarSinCos(&sin, &cos, rotation);
+
+        XMVECTOR sinV = XMLoadFloat(&sin);
+        XMVECTOR cosV = XMLoadFloat(&cos);
+
+        rotationMatrix1 = XMVectorMergeXY(cosV, sinV);
+        rotationMatrix2 = XMVectorMergeXY(XMVectorNegate(sinV), cosV);
+    }
+    else
+    {
+        rotationMatrix1 = g_XMIdentityR0;
+        rotationMatrix2 = g_XMIdentityR1;
+    }
+    
+    // The four corner vertices are computed by transforming these unit-square positions.
+    static XMVECTORF32 cornerOffsets[VerticesPerSprite] =
+    {
+        { { { 0, 0, 0, 0 } } },
+        { { { 1, 0, 0, 0 } } },
+        { { { 0, 1, 0, 0 } } },
+        { { { 1, 1, 0, 0 } } },
+    };
+
+    // Tricksy alert! Texture coordinates are computed from the same cornerOffsets
+    // table as vertex positions, but if the sprite is mirrored, this table
+    // must be indexed in a different order. This is done as follows:
+    //
+    //    position = cornerOffsets[i]
+    //    texcoord = cornerOffsets[i ^ SpriteEffects]
+
+    const unsigned int mirrorBits = flags & 3;
+
+    // Generate the four output vertices.
+    for (size_t i = 0; i < VerticesPerSprite; i++)
+    {
+        // Calculate position.
+        XMVECTOR cornerOffset = XMVectorMultiply(XMVectorSubtract(cornerOffsets[i], origin), destinationSize);
+        
+        // Apply 2x2 rotation matrix.
+        XMVECTOR position1 = XMVectorMultiplyAdd(XMVectorSplatX(cornerOffset), rotationMatrix1, destination);
+        XMVECTOR position2 = XMVectorMultiplyAdd(XMVectorSplatY(cornerOffset), rotationMatrix2, position1);
+
+        // Set z = depth.
+        XMVECTOR position = XMVectorPermute<0, 1, 7, 6>(position2, originRotationDepth);
+
+        // Write position as a Float4, even though VertexPositionColor::position is an XMFLOAT3.
+        // This is faster, and harmless as we are just clobbering the first element of the
+        // following color field, which will immediately be overwritten with its correct value.
+        XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&vertices[i].position), position);
+
+        // Write the color.
+        XMStoreFloat4(&vertices[i].color, color);
+
+        // Compute and write the texture coordinate.
+        XMVECTOR textureCoordinate = XMVectorMultiplyAdd(cornerOffsets[static_cast<unsigned int>(i) ^ mirrorBits], sourceSize, source);
+
+        XMStoreFloat2(&vertices[i].textureCoordinate, textureCoordinate);
+    }
+}
@@ -0,0 +1,67 @@
+//--------------------------------------------------------------------------------------
+// File: SpriteVertices.h
+//
+// Expands the sprites queued by SpriteBatch into their vertices. This has no Direct3D
+// dependencies, so the different code paths can be compared on the CPU alone.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "VertexTypes.h"
+#include "AlignedNew.h"
+
+struct ID3D11ShaderResourceView;
+
+
+namespace DirectX
+{
+    // Info about a single sprite that is waiting to be drawn.
+    struct __declspec(align(16)) SpriteInfo : public AlignedNew<SpriteInfo>
+    {
+        XMFLOAT4A source;
+        XMFLOAT4A destination;
+        XMFLOAT4A color;
+        XMFLOAT4A originRotationDepth;
+        ID3D11ShaderResourceView* texture;
+        int flags;
+
+
+        // Combine values from the public SpriteEffects enum, which use the two low bits, with these internal-only flags.
+        static const int SourceInTexels = 4;
+        static const int DestSizeInPixels = 8;
+    };
+
+
+    // Each sprite is drawn as a quad of four vertices.
+    const size_t VerticesPerSprite = 4;
+
+
+    // Generates the vertices of a single sprite.
+    void XM_CALLCONV RenderSprite(_In_ SpriteInfo const* sprite,
+        _Out_writes_(VerticesPerSprite) VertexPositionColorTexture* vertices,
+        FXMVECTOR textureSize,
+        FXMVECTOR inverseTextureSize);
+
+    // Generates the vertices of a range of sprites on the current thread, eight at a time if the CPU supports AVX2.
+    void XM_CALLCONV RenderSpriteRange(_In_reads_(count) SpriteInfo const* const* sprites,
+        size_t count,
+        _Out_writes_(count * VerticesPerSprite) VertexPositionColorTexture* vertices,
+        FXMVECTOR textureSize,
+        FXMVECTOR inverseTextureSize);
+
+    // Whether RenderSpriteRange expands eight sprites at a time with AVX2 on this CPU.
+    bool CanRenderSpritesWithAVX2();
+
+    // Generates the vertices of a range of sprites. Large ranges are split across the worker pool if parallel is true.
+    void XM_CALLCONV RenderSprites(_In_reads_(count) SpriteInfo const* const* sprites,
+        size_t count,
+        _Out_writes_(count * VerticesPerSprite) VertexPositionColorTexture* vertices,
+        FXMVECTOR textureSize,
+        FXMVECTOR inverseTextureSize,
+        bool parallel);
+}
@@ -0,0 +1,381 @@
+//--------------------------------------------------------------------------------------
+// File: ADPCMCodecTest.cpp
+//
+// Tests for the Microsoft ADPCM encoder and decoder. The decoder is checked against a
+// reference decoder written from the format description, and the encoder against a
+// golden hash of its output, which the scalar and SSE2 builds must both match. Reports
+// the compression ratio, the signal-to-noise ratio and the throughput.
+//
+// Build and run from the DirectXTK folder with g++ (-I- keeps the library sources from using Audio/pch.h,
+// and UnitTests/Linux also stands in for objbase.h and mmreg.h):
+//   g++ -std=c++14 -O2 -I UnitTests/Linux -I- -I UnitTests/Linux -I Audio UnitTests/ADPCMCodecTest.cpp Audio/ADPCMCodec.cpp -o ADPCMCodecTest
+//   ./ADPCMCodecTest
+// and again with -msse2 -D_XM_SSE_INTRINSICS_ added for the SSE2 encoder.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+// http://go.microsoft.com/fwlink/?LinkID=615561
+//--------------------------------------------------------------------------------------
+
+#include "pch.h"
+
+#include "ADPCMCodec.h"
+
+using namespace DirectX;
+
+namespace
+{
+    int g_failures = 0;
+
+    void Check(bool condition, const char* message, const char* clip)
+    {
+        if (!condition)
+        {
+            if (g_failures < 20)
+                printf("FAILED (%s): %s\n", clip, message);
+            g_failures++;
+        }
+    }
+
+    // FNV-1a hash of every encoded stream of the corpus. Update it only for an intended change to the encoder.
+    const uint64_t c_goldenEncoding = 0x2a9006815a07acdcull;
+
+    const uint32_t c_sampleRate = 44100;
+
+    enum class Signal
+    {
+        Sine,
+        Chord,
+        Noise,
+        Square,
+        Silence,
+        FullScale,
+    };
+
+    const char* SignalName(Signal signal)
+    {
+        switch (signal)
+        {
+        case Signal::Sine:      return "sine";
+        case Signal::Chord:     return "chord";
+        case Signal::Noise:     return "noise";
+        case Signal::Square:    return "square";
+        case Signal::Silence:   return "silence";
+        default:                return "full scale";
+        }
+    }
+
+    std::vector<int16_t> MakeClip(Signal signal, uint32_t channels, size_t frames, std::mt19937& rng)
+    {
+        std::vector<int16_t> pcm(frames * channels);
+
+        for (size_t j = 0; j < frames; ++j)
+        {
+            for (uint32_t ch = 0; ch < channels; ++ch)
+            {
+                double t = double(j) / c_sampleRate;
+                double value = 0;
+
+                switch (signal)
+                {
+                case Signal::Sine:      value = 20000 * sin(2 * 3.14159265358979 * (440 + 110 * ch) * t); break;
+                case Signal::Chord:     value = 8000 * sin(2 * 3.14159265358979 * 262 * t) + 6000 * sin(2 * 3.14159265358979 * 330 * t) + 4000 * sin(2 * 3.14159265358979 * 3920 * t); break;
+                case Signal::Noise:     value = double(int(rng() % 65536) - 32768); break;
+                case Signal::Square:    value = ((j / 50) % 2) ? 32767 : -32768; break;
+                case Signal::Silence:   value = 0; break;
+                case Signal::FullScale: value = (j % 2) ? 32767 : -32768; break;
+                }
+
+                pcm[j * channels + ch] = int16_t(std::min(std::max(value, -32768.0), 32767.0));
+            }
+        }
+
+        return pcm;
+    }
+
+    //----------------------------------------------------------------------------------
+    // Reference decoder, following the format description: a block holds the predictor
+    // index, step size and two oldest-first samples of each channel, then a stream of
+    // 4-bit codes, high nibble first, alternating between the channels.
+    //----------------------------------------------------------------------------------
+    std::vector<int16_t> ReferenceDecode(const WAVEFORMATEX* wfx, const uint8_t* data, size_t bytes)
+    {
+        static const int coef1[] = { 256, 512, 0, 192, 240, 460, 392 };
+        static const int coef2[] = { 0, -256, 0, 64, 0, -208, -232 };
+        static const int adaptation[] = { 230, 230, 230, 230, 307, 409, 512, 614, 768, 614, 512, 409, 307, 230, 230, 230 };
+
+        const size_t channels = wfx->nChannels;
+        const size_t samplesPerBlock = reinterpret_cast<const ADPCMWAVEFORMAT*>(wfx)->wSamplesPerBlock;
+        const size_t headerBytes = 7 * channels;
+
+        std::vector<int16_t> pcm;
+
+        for (size_t offset = 0; offset + headerBytes <= bytes; offset += wfx->nBlockAlign)
+        {
+            const uint8_t* block = data + offset;
+            size_t blockBytes = std::min<size_t>(wfx->nBlockAlign, bytes - offset);
+
+            int c1[2], c2[2], delta[2], sample1[2], sample2[2];
+            for (size_t ch = 0; ch < channels; ++ch)
+            {
+                auto read = [&](size_t field) { return int(int16_t(block[channels + (field * channels + ch) * 2] | (block[channels + (field * channels + ch) * 2 + 1] << 8))); };
+
+                c1[ch] = coef1[block[ch]];
+                c2[ch] = coef2[block[ch]];
+                delta[ch] = read(0);
+                sample1[ch] = read(1);
+                sample2[ch] = read(2);
+            }
+
+            for (size_t ch = 0; ch < channels; ++ch)
+                pcm.push_back(int16_t(sample2[ch]));
+            for (size_t ch = 0; ch < channels; ++ch)
+                pcm.push_back(int16_t(sample1[ch]));
+
+            size_t codes = std::min((samplesPerBlock - 2) * channels, (blockBytes - headerBytes) * 2);
+            codes -= codes % channels;
+
+            for (size_t n = 0; n < codes; ++n)
+            {
+                uint8_t byte = block[headerBytes + n / 2];
+                int code = (n % 2) ? (byte & 0xF) : (byte >> 4);
+                size_t ch = n % channels;
+
+                int predicted = (sample1[ch] * c1[ch] + sample2[ch] * c2[ch]) >> 8;
+                int sample = std::min(std::max(predicted + ((code >= 8) ? code - 16 : code) * delta[ch], -32768), 32767);
+
+                sample2[ch] = sample1[ch];
+                sample1[ch] = sample;
+                delta[ch] = std::max((adaptation[code] * delta[ch]) >> 8, 16);
+
+                pcm.push_back(int16_t(sample));
+            }
+        }
+
+        return pcm;
+    }
+
+    uint64_t HashBytes(uint64_t hash, const uint8_t* data, size_t bytes)
+    {
+        for (size_t j = 0; j < bytes; ++j)
+            hash = (hash ^ data[j]) * 1099511628211ull;
+        return hash;
+    }
+
+    double SignalToNoise(std::vector<int16_t> const& original, const int16_t* decoded)
+    {
+        double signal = 0;
+        double noise = 0;
+        for (size_t j = 0; j < original.size(); ++j)
+        {
+            double error = double(original[j]) - decoded[j];
+            signal += double(original[j]) * original[j];
+            noise += error * error;
+        }
+
+        return (noise > 0) ? 10 * log10(signal / noise) : 99.0;
+    }
+
+    struct Result
+    {
+        size_t pcmBytes;
+        size_t adpcmBytes;
+        double snr;
+    };
+
+    // Encodes and decodes one clip, checking the decoder against the reference and the bounds of both buffers
+    Result RoundTrip(const char* name, std::vector<int16_t> const& pcm, uint32_t channels, uint32_t samplesPerBlock, uint64_t& hash)
+    {
+        Result result = {};
+
+        uint8_t format[sizeof(ADPCMWAVEFORMAT)] = {};
+        auto wfx = reinterpret_cast<WAVEFORMATEX*>(format);
+
+        Check(SUCCEEDED(ADPCMCreateFormat(wfx, sizeof(format), c_sampleRate, channels, samplesPerBlock)), "ADPCMCreateFormat failed", name);
+
+        size_t frames = pcm.size() / channels;
+        size_t adpcmBytes = ADPCMGetEncodedSize(wfx, frames);
+        Check(adpcmBytes == (frames + samplesPerBlock - 1) / samplesPerBlock * wfx->nBlockAlign, "encoded size is not a whole number of blocks", name);
+
+        // One guard byte past each buffer catches overruns
+        const uint8_t guardByte = 0xA5;
+        const int16_t guardSample = 0x7A5A;
+
+        std::vector<uint8_t> adpcm(adpcmBytes + 1, guardByte);
+        Check(SUCCEEDED(ADPCMEncode(wfx, pcm.data(), frames, adpcm.data(), adpcmBytes)), "ADPCMEncode failed", name);
+        Check(adpcm[adpcmBytes] == guardByte, "ADPCMEncode wrote past the buffer", name);
+
+        hash = HashBytes(hash, adpcm.data(), adpcmBytes);
+
+        size_t decodedFrames = ADPCMGetDecodedFrames(wfx, adpcmBytes);
+        Check(decodedFrames >= frames && decodedFrames - frames < samplesPerBlock, "decoded frame count does not cover the clip", name);
+
+        std::vector<int16_t> decoded(decodedFrames * channels + 1, guardSample);
+        Check(SUCCEEDED(ADPCMDecode(wfx, adpcm.data(), adpcmBytes, decoded.data(), decodedFrames)), "ADPCMDecode failed", name);
+        Check(decoded[decodedFrames * channels] == guardSample, "ADPCMDecode wrote past the buffer", name);
+
+        auto reference = ReferenceDecode(wfx, adpcm.data(), adpcmBytes);
+        Check(reference.size() == decodedFrames * channels && std::equal(reference.begin(), reference.end(), decoded.begin()),
+            "decoder does not match the reference decoder", name);
+
+        // A stream cut in the middle of a block decodes the whole frames it still holds
+        size_t cut = adpcmBytes - wfx->nBlockAlign / 2;
+        size_t cutFrames = ADPCMGetDecodedFrames(wfx, cut);
+        if (adpcmBytes > 0 && cutFrames > 0)
+        {
+
+            std::vector<int16_t> partial(cutFrames * channels + 1, guardSample);
+            Check(SUCCEEDED(ADPCMDecode(wfx, adpcm.data(), cut, partial.data(), cutFrames)), "ADPCMDecode failed on a partial block", name);
+            Check(partial[cutFrames * channels] == guardSample, "ADPCMDecode wrote past the buffer on a partial block", name);
+
+            auto partialReference = ReferenceDecode(wfx, adpcm.data(), cut);
+            Check(partialReference.size() == cutFrames * channels && std::equal(partialReference.begin(), partialReference.end(), partial.begin()),
+                "partial block does not match the reference decoder", name);
+
+            Check(ADPCMDecode(wfx, adpcm.data(), cut, partial.data(), cutFrames - 1) == HRESULT_FROM_WIN32(ERROR_INSUFFICIENT_BUFFER),
+                "ADPCMDecode accepted a short buffer", name);
+        }
+
+        result.pcmBytes = pcm.size() * sizeof(int16_t);
+        result.adpcmBytes = adpcmBytes;
+        result.snr = SignalToNoise(pcm, decoded.data());
+        return result;
+    }
+
+    void TestInvalid()
+    {
+        uint8_t format[sizeof(ADPCMWAVEFORMAT)] = {};
+        auto wfx = reinterpret_cast<WAVEFORMATEX*>(format);
+
+        Check(FAILED(ADPCMCreateFormat(wfx, sizeof(WAVEFORMATEX), c_sampleRate, 1, 128)), "accepted a format buffer that is too small", "invalid");
+        Check(FAILED(ADPCMCreateFormat(wfx, sizeof(format), c_sampleRate, 3, 128)), "accepted three channels", "invalid");
+        Check(FAILED(ADPCMCreateFormat(wfx, sizeof(format), c_sampleRate, 1, 127)), "accepted an odd block length for mono", "invalid");
+        Check(FAILED(ADPCMCreateFormat(wfx, sizeof(format), c_sampleRate, 1, 2)), "accepted a block without codes", "invalid");
+
+        Check(SUCCEEDED(ADPCMCreateFormat(wfx, sizeof(format), c_sampleRate, 1, 32)), "ADPCMCreateFormat failed", "invalid");
+
+        std::vector<uint8_t> adpcm(wfx->nBlockAlign, 0);
+        std::vector<int16_t> pcm(32);
+
+        // Predictor indices past the 7 standard coefficient sets are rejected
+        adpcm[0] = 7;
+        Check(ADPCMDecode(wfx, adpcm.data(), adpcm.size(), pcm.data(), pcm.size()) == HRESULT_FROM_WIN32(ERROR_INVALID_DATA), "accepted a bad predictor", "invalid");
+
+        // A corrupt step size must not overflow (UBSan reports it)
+        std::fill(adpcm.begin(), adpcm.end(), uint8_t(0x77));
+        adpcm[0] = 6;
+        Check(SUCCEEDED(ADPCMDecode(wfx, adpcm.data(), adpcm.size(), pcm.data(), pcm.size())), "failed on a large step size", "invalid");
+
+        // Formats with other coefficients are not supported
+        reinterpret_cast<ADPCMWAVEFORMAT*>(wfx)->aCoef[3].iCoef1 = 100;
+        Check(ADPCMDecode(wfx, adpcm.data(), adpcm.size(), pcm.data(), pcm.size()) == E_INVALIDARG, "accepted non-standard coefficients", "invalid");
+    }
+
+    // Megabytes of 16-bit PCM processed per second
+    template<typename TFunc>
+    double Throughput(size_t pcmBytes, TFunc func)
+    {
+        auto start = std::chrono::steady_clock::now();
+        int passes = 0;
+        double seconds = 0;
+        do
+        {
+            func();
+            ++passes;
+            seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        } while (seconds < 0.5);
+
+        return double(pcmBytes) * passes / seconds / (1024 * 1024);
+    }
+}
+
+
+int main()
+{
+    std::mt19937 rng(1);
+    uint64_t hash = 14695981039346656037ull;
+
+    const Signal signals[] = { Signal::Sine, Signal::Chord, Signal::Noise, Signal::Square, Signal::Silence, Signal::FullScale };
+    const uint32_t blockLengths[] = { 4, 32, 128, 512, 2048 };
+
+    printf("%-12s %-8s %-6s %10s %8s\n", "signal", "channels", "block", "ratio", "SNR");
+
+    for (auto signal : signals)
+    {
+        for (uint32_t channels = 1; channels <= 2; ++channels)
+        {
+            for (auto samplesPerBlock : blockLengths)
+            {
+                // A clip of exact blocks plus a partial one
+                auto pcm = MakeClip(signal, channels, 8 * samplesPerBlock + samplesPerBlock / 3 + 1, rng);
+                auto result = RoundTrip(SignalName(signal), pcm, channels, samplesPerBlock, hash);
+
+                if (samplesPerBlock == 512)
+                {
+                    printf("%-12s %-8u %-6u %9.2f:1 %5.1f dB\n", SignalName(signal), channels, samplesPerBlock,
+                        double(result.pcmBytes) / double(result.adpcmBytes), result.snr);
+                }
+
+                if (signal == Signal::Sine || signal == Signal::Chord)
+                    Check(result.snr > 25.0, "signal-to-noise ratio is too low", SignalName(signal));
+            }
+        }
+    }
+
+    // Odd block lengths are allowed for stereo, and short clips give a single partial block
+    for (uint32_t samplesPerBlock = 5; samplesPerBlock < 40; samplesPerBlock += 2)
+    {
+        for (size_t frames = 0; frames < 3 * samplesPerBlock; frames += 7)
+        {
+            auto pcm = MakeClip(Signal::Chord, 2, frames, rng);
+            (void)RoundTrip("odd stereo block", pcm, 2, samplesPerBlock, hash);
+        }
+    }
+
+    TestInvalid();
+
+#if defined(_XM_SSE_INTRINSICS_)
+    const char* encoder = "SSE2";
+#else
+    const char* encoder = "scalar";
+#endif
+
+    Check(hash == c_goldenEncoding, "encoder output differs from the golden hash", encoder);
+    printf("encoder output hash (%s) %016llx\n", encoder, static_cast<unsigned long long>(hash));
+
+    // Ten seconds of stereo music-like content with the block length used by xwbtool
+    {
+        auto pcm = MakeClip(Signal::Chord, 2, 10 * c_sampleRate, rng);
+
+        uint8_t format[sizeof(ADPCMWAVEFORMAT)] = {};
+        auto wfx = reinterpret_cast<WAVEFORMATEX*>(format);
+        (void)ADPCMCreateFormat(wfx, sizeof(format), c_sampleRate, 2, 128);
+
+        size_t frames = pcm.size() / 2;
+        std::vector<uint8_t> adpcm(ADPCMGetEncodedSize(wfx, frames));
+        std::vector<int16_t> decoded(ADPCMGetDecodedFrames(wfx, adpcm.size()) * 2);
+
+        double encodeRate = Throughput(pcm.size() * sizeof(int16_t), [&]()
+        {
+            (void)ADPCMEncode(wfx, pcm.data(), frames, adpcm.data(), adpcm.size());
+        });
+
+        double decodeRate = Throughput(pcm.size() * sizeof(int16_t), [&]()
+        {
+            (void)ADPCMDecode(wfx, adpcm.data(), adpcm.size(), decoded.data(), decoded.size() / 2);
+        });
+
+        printf("%s encoder %.1f MB/s, decoder %.1f MB/s of 16-bit PCM\n", encoder, encodeRate, decodeRate);
+    }
+
+    if (g_failures)
+    {
+        printf("%d checks failed\n", g_failures);
+        return 1;
+    }
+
+    printf("ADPCMCodec tests passed\n");
+    return 0;
+}
@@ -0,0 +1,451 @@
+//--------------------------------------------------------------------------------------
+// File: GeometryTest.cpp
+//
+// Tests for the procedural geometry: the geodesic sphere must subdivide into the same
+// vertices as the std::map edge lookup it used before, every primitive must generate the
+// same mesh with 16-bit and 32-bit indices, and 16-bit indices must refuse meshes they
+// cannot address. The sphere, torus and teapot must generate the same bytes on one thread
+// as in parallel, and preallocated primitives must size their output exactly. Also reports
+// geodesic sphere generation time for tessellation 0 to 8, and the generation time of the
+// other primitives at the tessellations of a typical level of detail chain.
+//
+// Build and run from the DirectXTK folder with g++ (-I- keeps the library sources from using Src/pch.h,
+// and UnitTests/Linux also stands in for DirectXMath.h, VertexTypes.h and ppl.h):
+//   g++ -std=c++14 -O2 -pthread -I UnitTests/Linux -I- -I UnitTests/Linux -I Src UnitTests/GeometryTest.cpp Src/Geometry.cpp -o GeometryTest
+//   ./GeometryTest
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "pch.h"
+
+#include "Geometry.h"
+
+using namespace DirectX;
+
+namespace
+{
+    int g_failures = 0;
+
+    void Check(bool condition, const char* message, const char* test)
+    {
+        if (!condition)
+        {
+            if (g_failures < 20)
+                printf("FAILED (%s): %s\n", test, message);
+            g_failures++;
+        }
+    }
+
+    bool SameVertices(VertexCollection const& a, VertexCollection const& b)
+    {
+        return a.size() == b.size() && memcmp(a.data(), b.data(), a.size() * sizeof(VertexPositionNormalTexture)) == 0;
+    }
+
+    template<typename TIndexA, typename TIndexB>
+    bool SameIndices(std::vector<TIndexA> const& a, std::vector<TIndexB> const& b)
+    {
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+    }
+
+    // Every index addresses a vertex, and the indices form whole triangles.
+    template<typename TIndexCollection>
+    bool IsValidMesh(VertexCollection const& vertices, TIndexCollection const& indices)
+    {
+        if (vertices.empty() || indices.empty() || indices.size() % 3)
+            return false;
+
+        for (auto index : indices)
+        {
+            if (index >= vertices.size())
+                return false;
+        }
+
+        return true;
+    }
+
+    // Calls generate with 16-bit and 32-bit indices, and checks that both give the same mesh.
+    template<typename TGenerate>
+    void CheckIndexSizes(TGenerate generate, const char* test)
+    {
+        VertexCollection vertices16;
+        VertexCollection vertices32;
+        IndexCollection indices16;
+        IndexCollection32 indices32;
+
+        generate(vertices16, indices16);
+        generate(vertices32, indices32);
+
+        Check(IsValidMesh(vertices16, indices16), "16-bit mesh is not valid", test);
+        Check(SameVertices(vertices16, vertices32), "vertices differ between 16-bit and 32-bit indices", test);
+        Check(SameIndices(indices16, indices32), "indices differ between 16-bit and 32-bit", test);
+    }
+
+    template<typename TGenerate>
+    bool Throws(TGenerate generate)
+    {
+        try
+        {
+            generate();
+        }
+        catch (std::exception const&)
+        {
+            return true;
+        }
+
+        return false;
+    }
+
+
+    // Positions of a geodesic sphere subdivided with the std::map edge lookup ComputeGeoSphere used
+    // before, before the seam and pole fixups, normalized and scaled the same way.
+    std::vector<XMFLOAT3> ReferenceGeoSpherePositions(float diameter, size_t tessellation)
+    {
+        std::vector<XMFLOAT3> positions =
+        {
+            XMFLOAT3(0, 1, 0), XMFLOAT3(0, 0, -1), XMFLOAT3(1, 0, 0), XMFLOAT3(0, 0, 1), XMFLOAT3(-1, 0, 0), XMFLOAT3(0, -1, 0),
+        };
+
+        std::vector<uint32_t> indices = { 0, 1, 2, 0, 2, 3, 0, 3, 4, 0, 4, 1, 5, 1, 4, 5, 4, 3, 5, 3, 2, 5, 2, 1 };
+
+        for (size_t iSubdivision = 0; iSubdivision < tessellation; ++iSubdivision)
+        {
+            std::map<std::pair<uint32_t, uint32_t>, uint32_t> subdividedEdges;
+            std::vector<uint32_t> newIndices;
+
+            auto divideEdge = [&](uint32_t i0, uint32_t i1)
+            {
+                auto edge = std::make_pair(std::min(i0, i1), std::max(i0, i1));
+                auto it = subdividedEdges.find(edge);
+
+                if (it != subdividedEdges.end())
+                    return it->second;
+
+                XMFLOAT3 midpoint;
+                XMStoreFloat3(&midpoint, XMVectorScale(XMVectorAdd(XMLoadFloat3(&positions[i0]), XMLoadFloat3(&positions[i1])), 0.5f));
+
+                auto index = static_cast<uint32_t>(positions.size());
+                positions.push_back(midpoint);
+                subdividedEdges[edge] = index;
+                return index;
+            };
+
+            for (size_t i = 0; i < indices.size(); i += 3)
+            {
+                uint32_t iv0 = indices[i], iv1 = indices[i + 1], iv2 = indices[i + 2];
+                uint32_t iv01 = divideEdge(iv0, iv1);
+                uint32_t iv12 = divideEdge(iv1, iv2);
+                uint32_t iv20 = divideEdge(iv0, iv2);
+
+                uint32_t add[] = { iv0, iv01, iv20, iv20, iv12, iv2, iv20, iv01, iv12, iv01, iv1, iv12 };
+                newIndices.insert(newIndices.end(), std::begin(add), std::end(add));
+            }
+
+            indices.swap(newIndices);
+        }
+
+        for (auto& position : positions)
+        {
+            XMStoreFloat3(&position, XMVectorScale(XMVector3Normalize(XMLoadFloat3(&position)), diameter / 2));
+        }
+
+        return positions;
+    }
+
+    bool Less(XMFLOAT3 const& a, XMFLOAT3 const& b)
+    {
+        if (a.x != b.x) return a.x < b.x;
+        if (a.y != b.y) return a.y < b.y;
+        return a.z < b.z;
+    }
+
+    bool Equal(XMFLOAT3 const& a, XMFLOAT3 const& b)
+    {
+        return a.x == b.x && a.y == b.y && a.z == b.z;
+    }
+
+    std::vector<XMFLOAT3> DistinctPositions(std::vector<XMFLOAT3> positions)
+    {
+        std::sort(positions.begin(), positions.end(), Less);
+        positions.erase(std::unique(positions.begin(), positions.end(), Equal), positions.end());
+        return positions;
+    }
+
+
+    void TestGeoSphere()
+    {
+        const char* test = "GeoSphere";
+
+        for (size_t tessellation = 0; tessellation <= 6; tessellation++)
+        {
+            for (int rhcoords = 0; rhcoords < 2; rhcoords++)
+            {
+                CheckIndexSizes([&](VertexCollection& vertices, auto& indices)
+                {
+                    ComputeGeoSphere(vertices, indices, 3.0f, tessellation, rhcoords != 0);
+                }, test);
+            }
+
+            VertexCollection vertices;
+            IndexCollection32 indices;
+            ComputeGeoSphere(vertices, indices, 3.0f, tessellation, true);
+
+            // Each subdivision splits every triangle in four, adding one vertex per edge.
+            size_t triangleCount = size_t(8) << (2 * tessellation);
+
+            Check(indices.size() == triangleCount * 3, "triangle count", test);
+
+            // The same distinct positions as the std::map subdivision; the seam and pole copies only repeat them.
+            std::vector<XMFLOAT3> positions;
+            for (auto const& vertex : vertices)
+                positions.push_back(vertex.position);
+
+            auto reference = ReferenceGeoSpherePositions(3.0f, tessellation);
+
+            Check(reference.size() == 6 + triangleCount / 2 - 4, "reference vertex count", test);
+            Check(DistinctPositions(reference).size() == reference.size(), "reference has duplicate vertices", test);
+            Check(DistinctPositions(positions).size() == reference.size(), "distinct vertex count", test);
+            Check(std::equal(reference.begin(), reference.end(), positions.begin(), Equal), "subdivided vertices differ from the std::map edge lookup", test);
+
+            // No triangle is degenerate.
+            bool degenerate = false;
+            for (size_t i = 0; i < indices.size(); i += 3)
+            {
+                degenerate |= Equal(vertices[indices[i]].position, vertices[indices[i + 1]].position)
+                    || Equal(vertices[indices[i + 1]].position, vertices[indices[i + 2]].position)
+                    || Equal(vertices[indices[i]].position, vertices[indices[i + 2]].position);
+            }
+
+            Check(!degenerate, "degenerate triangle", test);
+        }
+
+        // Tessellation 7 has more vertices than 16-bit indices can address, but 32-bit indices can.
+        VertexCollection vertices;
+        IndexCollection indices16;
+        IndexCollection32 indices32;
+
+        Check(Throws([&] { ComputeGeoSphere(vertices, indices16, 1.0f, 7, true); }), "16-bit indices did not overflow", test);
+
+        for (size_t tessellation = 7; tessellation <= 8; tessellation++)
+        {
+            ComputeGeoSphere(vertices, indices32, 1.0f, tessellation, true);
+
+            Check(vertices.size() > 65536 && IsValidMesh(vertices, indices32), "32-bit mesh", test);
+            Check(indices32.size() == (size_t(8) << (2 * tessellation)) * 3, "32-bit triangle count", test);
+        }
+    }
+
+
+    // The other primitives generate the same mesh with either index size.
+    void TestIndexSizes()
+    {
+        const char* test = "IndexSizes";
+
+        CheckIndexSizes([](VertexCollection& v, auto& i) { ComputeBox(v, i, XMFLOAT3(1, 2, 3), false, true); }, test);
+        CheckIndexSizes([](VertexCollection& v, auto& i) { ComputeSphere(v, i, 2.0f, 16, true, false); }, test);
+        CheckIndexSizes([](VertexCollection& v, auto& i) { ComputeCylinder(v, i, 1.0f, 2.0f, 32, false); }, test);
+        CheckIndexSizes([](VertexCollection& v, auto& i) { ComputeCone(v, i, 1.0f, 2.0f, 32, true); }, test);
+        CheckIndexSizes([](VertexCollection& v, auto& i) { ComputeTorus(v, i, 1.0f, 0.33f, 32, false); }, test);
+        CheckIndexSizes([](VertexCollection& v, auto& i) { ComputeTetrahedron(v, i, 1.0f, true); }, test);
+        CheckIndexSizes([](VertexCollection& v, auto& i) { ComputeOctahedron(v, i, 1.0f, false); }, test);
+        CheckIndexSizes([](VertexCollection& v, auto& i) { ComputeDodecahedron(v, i, 1.0f, true); }, test);
+        CheckIndexSizes([](VertexCollection& v, auto& i) { ComputeIcosahedron(v, i, 1.0f, false); }, test);
+        CheckIndexSizes([](VertexCollection& v, auto& i) { ComputeTeapot(v, i, 1.0f, 8, true); }, test);
+
+        // A sphere of tessellation 181 has 66066 vertices.
+        VertexCollection vertices;
+        IndexCollection indices16;
+        IndexCollection32 indices32;
+
+        Check(Throws([&] { ComputeSphere(vertices, indices16, 1.0f, 181, true, false); }), "16-bit sphere did not overflow", test);
+        Check(!Throws([&] { ComputeSphere(vertices, indices32, 1.0f, 181, true, false); }) && vertices.size() == 66066 && IsValidMesh(vertices, indices32), "32-bit sphere", test);
+    }
+
+
+    // Calls generate serially and in parallel, and checks that both give the same bytes.
+    template<typename TGenerate>
+    void CheckParallel(TGenerate generate, const char* test)
+    {
+        VertexCollection serialVertices;
+        VertexCollection parallelVertices;
+        IndexCollection32 serialIndices;
+        IndexCollection32 parallelIndices;
+
+        generate(serialVertices, serialIndices, false);
+        generate(parallelVertices, parallelIndices, true);
+
+        Check(IsValidMesh(serialVertices, serialIndices), "mesh is not valid", test);
+        Check(SameVertices(serialVertices, parallelVertices), "vertices differ between serial and parallel", test);
+        Check(SameIndices(serialIndices, parallelIndices), "indices differ between serial and parallel", test);
+    }
+
+    void TestParallel()
+    {
+        const char* test = "Parallel";
+
+        // Tessellations on both sides of the size below which a primitive is generated on one thread.
+        for (size_t tessellation : { 3, 16, 89, 90, 300 })
+        {
+            for (int rhcoords = 0; rhcoords < 2; rhcoords++)
+            {
+                CheckParallel([&](VertexCollection& v, IndexCollection32& i, bool parallel) { ComputeSphere(v, i, 2.0f, tessellation, rhcoords != 0, rhcoords == 0, parallel); }, test);
+            }
+        }
+
+        for (size_t tessellation : { 3, 16, 126, 127, 300 })
+        {
+            for (int rhcoords = 0; rhcoords < 2; rhcoords++)
+            {
+                CheckParallel([&](VertexCollection& v, IndexCollection32& i, bool parallel) { ComputeTorus(v, i, 2.0f, 0.5f, tessellation, rhcoords != 0, parallel); }, test);
+            }
+        }
+
+        for (size_t tessellation : { 1, 8, 21, 22, 64 })
+        {
+            for (int rhcoords = 0; rhcoords < 2; rhcoords++)
+            {
+                CheckParallel([&](VertexCollection& v, IndexCollection32& i, bool parallel) { ComputeTeapot(v, i, 1.0f, tessellation, rhcoords != 0, parallel); }, test);
+            }
+        }
+    }
+
+
+    // Generates into empty collections, and checks that they were sized once, to the exact output size.
+    template<typename TGenerate>
+    void CheckPreallocated(TGenerate generate, size_t vertexCount, size_t indexCount, const char* test)
+    {
+        VertexCollection vertices;
+        IndexCollection indices;
+
+        generate(vertices, indices);
+
+        Check(vertices.size() == vertexCount && indices.size() == indexCount, "output size", test);
+        Check(vertices.capacity() == vertices.size(), "vertices were not preallocated exactly", test);
+        Check(indices.capacity() == indices.size(), "indices were not preallocated exactly", test);
+    }
+
+    void TestPreallocation()
+    {
+        const char* test = "Preallocation";
+
+        for (size_t t : { 3, 7, 32, 100 })
+        {
+            size_t stride = t + 1;
+
+            CheckPreallocated([&](VertexCollection& v, IndexCollection& i) { ComputeSphere(v, i, 1.0f, t, true, false); }, stride * (2 * t + 1), t * (2 * t + 1) * 6, test);
+            CheckPreallocated([&](VertexCollection& v, IndexCollection& i) { ComputeTorus(v, i, 1.0f, 0.25f, t, true); }, stride * stride, stride * stride * 6, test);
+            CheckPreallocated([&](VertexCollection& v, IndexCollection& i) { ComputeCylinder(v, i, 1.0f, 1.0f, t, true); }, stride * 2 + t * 2, stride * 6 + (t - 2) * 6, test);
+            CheckPreallocated([&](VertexCollection& v, IndexCollection& i) { ComputeCone(v, i, 1.0f, 1.0f, t, false); }, stride * 2 + t, stride * 3 + (t - 2) * 3, test);
+        }
+
+        // The teapot is 32 patch instances.
+        for (size_t t : { 1, 4, 16 })
+        {
+            CheckPreallocated([&](VertexCollection& v, IndexCollection& i) { ComputeTeapot(v, i, 1.0f, t, true); }, 32 * (t + 1) * (t + 1), 32 * t * t * 6, test);
+        }
+    }
+
+
+    template<typename TGenerate>
+    double SecondsPerCall(TGenerate generate, size_t vertexCount)
+    {
+        VertexCollection vertices;
+        IndexCollection indices;
+
+        // Repeat small meshes enough to time them.
+        int repeats = int(std::max(size_t(1), size_t(4000000) / vertexCount));
+
+        auto start = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < repeats; i++)
+            generate(vertices, indices);
+
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / repeats;
+    }
+
+    template<typename TGenerate>
+    void ReportPrimitive(const char* name, size_t tessellation, TGenerate generate)
+    {
+        VertexCollection vertices;
+        IndexCollection indices;
+        generate(vertices, indices, false);
+
+        double serial = SecondsPerCall([&](VertexCollection& v, IndexCollection& i) { generate(v, i, false); }, vertices.size());
+        double parallel = SecondsPerCall([&](VertexCollection& v, IndexCollection& i) { generate(v, i, true); }, vertices.size());
+
+        printf("%-8s %3zu %7zu vertices: serial %8.3f ms %6.1f M vertices/s, parallel %8.3f ms %6.1f M vertices/s\n",
+            name, tessellation, vertices.size(), serial * 1e3, vertices.size() / serial / 1e6, parallel * 1e3, vertices.size() / parallel / 1e6);
+    }
+
+    template<typename TIndexCollection>
+    void ReportGeoSphere(size_t tessellation)
+    {
+        VertexCollection vertices;
+        TIndexCollection indices;
+
+        // Repeat small spheres enough to time them.
+        int repeats = std::max(1, int(20000 >> (2 * tessellation)));
+
+        auto start = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < repeats; i++)
+            ComputeGeoSphere(vertices, indices, 1.0f, tessellation, true);
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / repeats;
+
+        printf("%2zu %-6s %8zu vertices %9zu indices %10.3f ms %7.1f M vertices/s\n",
+            tessellation, sizeof(typename TIndexCollection::value_type) == 2 ? "16-bit" : "32-bit",
+            vertices.size(), indices.size(), seconds * 1e3, vertices.size() / seconds / 1e6);
+    }
+
+    void ReportThroughput()
+    {
+        printf("ComputeGeoSphere:\n");
+
+        for (size_t tessellation = 0; tessellation <= 8; tessellation++)
+        {
+            if (tessellation <= 6)
+                ReportGeoSphere<IndexCollection>(tessellation);
+
+            ReportGeoSphere<IndexCollection32>(tessellation);
+        }
+
+        printf("%u hardware threads\n", std::thread::hardware_concurrency());
+
+        for (size_t t : { 8, 16, 32, 64, 128 })
+        {
+            ReportPrimitive("Sphere", t, [&](VertexCollection& v, IndexCollection& i, bool parallel) { ComputeSphere(v, i, 1.0f, t, true, false, parallel); });
+            ReportPrimitive("Torus", t, [&](VertexCollection& v, IndexCollection& i, bool parallel) { ComputeTorus(v, i, 1.0f, 0.33f, t, true, parallel); });
+            ReportPrimitive("Cylinder", t, [&](VertexCollection& v, IndexCollection& i, bool) { ComputeCylinder(v, i, 1.0f, 1.0f, t, true); });
+            ReportPrimitive("Cone", t, [&](VertexCollection& v, IndexCollection& i, bool) { ComputeCone(v, i, 1.0f, 1.0f, t, true); });
+        }
+
+        for (size_t t : { 2, 4, 8, 16, 32 })
+        {
+            ReportPrimitive("Teapot", t, [&](VertexCollection& v, IndexCollection& i, bool parallel) { ComputeTeapot(v, i, 1.0f, t, true, parallel); });
+        }
+    }
+}
+
+
+int main()
+{
+    TestGeoSphere();
+    TestIndexSizes();
+    TestParallel();
+    TestPreallocation();
+
+    ReportThroughput();
+
+    if (g_failures)
+    {
+        printf("%d checks failed\n", g_failures);
+        return 1;
+    }
+
+    printf("Geometry tests passed\n");
+    return 0;
+}
@@ -0,0 +1,207 @@
+//--------------------------------------------------------------------------------------
+// File: GlyphAtlasTest.cpp
+//
+// Tests for the shelf packer and the least recently used eviction of the dynamic glyph cache.
+//
+// Build and run from the DirectXTK folder with g++ (-I- keeps the library sources from using Src/pch.h):
+//   g++ -std=c++14 -O2 -I UnitTests/Linux -I- -I Src UnitTests/GlyphAtlasTest.cpp Src/GlyphAtlas.cpp -o GlyphAtlasTest
+//   ./GlyphAtlasTest
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "pch.h"
+
+#include "GlyphAtlas.h"
+
+using namespace DirectX;
+
+namespace
+{
+    int g_failures = 0;
+
+    void Check(bool condition, const char* message, int seed)
+    {
+        if (!condition)
+        {
+            if (g_failures < 20)
+                printf("FAILED (seed %d): %s\n", seed, message);
+            g_failures++;
+        }
+    }
+
+    // Mirrors the entries the atlas should hold, in most recently used order, with the frame they were last used in.
+    struct ModelEntry
+    {
+        uint32_t key;
+        uint64_t frame;
+        GlyphAtlas::Region region;
+    };
+
+    // Every resident region lies inside the atlas and no two of them share a texel.
+    void CheckRegions(GlyphAtlas const& atlas, std::list<ModelEntry> const& entries, int seed)
+    {
+        std::vector<uint8_t> texels(size_t(atlas.GetWidth()) * atlas.GetHeight(), 0);
+
+        for (auto const& entry : entries)
+        {
+            auto const& r = entry.region;
+
+            if (r.x + r.width > atlas.GetWidth() || r.y + r.height > atlas.GetHeight())
+            {
+                Check(false, "region outside the atlas", seed);
+                continue;
+            }
+
+            for (uint32_t y = r.y; y < r.y + r.height; ++y)
+            {
+                for (uint32_t x = r.x; x < r.x + r.width; ++x)
+                {
+                    uint8_t& texel = texels[size_t(y) * atlas.GetWidth() + x];
+                    Check(texel == 0, "regions overlap", seed);
+                    texel = 1;
+                }
+            }
+        }
+    }
+
+    // Inserts random glyph sets, mostly reusing keys, and checks the packer and eviction policy against a model.
+    void TestRandomGlyphs(int seed)
+    {
+        std::mt19937 rng(static_cast<uint32_t>(seed));
+
+        const uint32_t width = 64 + 32 * uint32_t(rng() % 7);
+        const uint32_t height = 64 + 32 * uint32_t(rng() % 7);
+        const uint32_t keyCount = 100 + uint32_t(rng() % 1000);
+        const uint32_t maxGlyphSize = 8 + uint32_t(rng() % 40);
+
+        GlyphAtlas atlas(width, height);
+
+        std::list<ModelEntry> entries;
+        uint64_t frame = 0;
+
+        for (int step = 0; step < 20000; ++step)
+        {
+            if (rng() % 40 == 0)
+            {
+                atlas.NextFrame();
+                frame++;
+            }
+
+            // Each glyph keeps its size, as it would with a real font
+            uint32_t key = uint32_t(rng() % keyCount);
+            uint32_t glyphWidth = 1 + (key * 2654435761u >> 8) % maxGlyphSize;
+            uint32_t glyphHeight = 1 + (key * 40503u >> 4) % maxGlyphSize;
+
+            auto resident = std::find_if(entries.begin(), entries.end(), [key](ModelEntry const& entry) { return entry.key == key; });
+
+            size_t countBefore = atlas.GetEntryCount();
+
+            GlyphAtlas::Region region = {};
+            bool inserted = atlas.Insert(key, glyphWidth, glyphHeight, region);
+
+            if (resident != entries.end())
+            {
+                Check(inserted, "resident glyph was not found", seed);
+                Check(memcmp(&region, &resident->region, sizeof(region)) == 0, "resident glyph moved", seed);
+
+                resident->frame = frame;
+                entries.splice(entries.begin(), entries, resident);
+                continue;
+            }
+
+            // The atlas evicts from the least recently used end, one entry at a time
+            size_t evicted = countBefore + (inserted ? 1 : 0) - atlas.GetEntryCount();
+            Check(evicted <= entries.size(), "more entries evicted than resident", seed);
+
+            for (size_t j = 0; j < evicted && !entries.empty(); ++j)
+            {
+                Check(entries.back().frame != frame, "glyph used in the current frame was evicted", seed);
+                entries.pop_back();
+            }
+
+            if (inserted)
+            {
+                Check(region.width == glyphWidth && region.height == glyphHeight, "region has the wrong size", seed);
+
+                ModelEntry entry = { key, frame, region };
+                entries.push_front(entry);
+            }
+            else
+            {
+                // Only fails once everything left was used in this frame
+                Check(entries.empty() || entries.back().frame == frame, "insert failed although glyphs could be evicted", seed);
+            }
+
+            Check(atlas.GetEntryCount() == entries.size(), "entry count does not match", seed);
+
+            if (step % 250 == 0)
+                CheckRegions(atlas, entries, seed);
+        }
+
+        CheckRegions(atlas, entries, seed);
+
+        // The regions reported by the atlas agree with the model
+        atlas.NextFrame();
+        for (auto const& entry : entries)
+        {
+            GlyphAtlas::Region region = {};
+            Check(atlas.Touch(entry.key, region) && memcmp(&region, &entry.region, sizeof(region)) == 0, "touched region does not match", seed);
+        }
+    }
+
+    // Four glyphs fill the atlas; the one not used for the longest time makes room for the next.
+    void TestEvictionOrder()
+    {
+        GlyphAtlas atlas(32, 8);
+        GlyphAtlas::Region region;
+
+        for (uint32_t key = 0; key < 4; ++key)
+            Check(atlas.Insert(key, 8, 8, region), "initial insert failed", -1);
+
+        // Everything was used in this frame, so nothing can be evicted
+        Check(!atlas.Insert(4, 8, 8, region), "evicted a glyph used in the current frame", -1);
+
+        atlas.NextFrame();
+        Check(atlas.Touch(0, region), "glyph 0 is not resident", -1);
+
+        Check(atlas.Insert(4, 8, 8, region), "insert after a new frame failed", -1);
+        Check(region.x == 8 && region.y == 0, "glyph 4 did not replace glyph 1", -1);
+        Check(!atlas.Touch(1, region), "glyph 1 was not evicted", -1);
+        Check(atlas.Touch(0, region) && atlas.Touch(2, region) && atlas.Touch(3, region), "wrong glyph was evicted", -1);
+        Check(atlas.GetEvictionCount() == 1, "eviction count is wrong", -1);
+
+        // A glyph larger than the atlas never fits
+        atlas.NextFrame();
+        Check(!atlas.Insert(5, 33, 8, region), "glyph wider than the atlas was inserted", -1);
+        Check(!atlas.Insert(5, 8, 9, region), "glyph taller than the atlas was inserted", -1);
+
+        // Emptied shelves are merged, so a taller glyph fits once the short ones are gone
+        GlyphAtlas tall(16, 16);
+        Check(tall.Insert(10, 16, 4, region) && tall.Insert(11, 16, 4, region) && tall.Insert(12, 16, 8, region), "shelf inserts failed", -1);
+        tall.NextFrame();
+        Check(tall.Insert(13, 16, 16, region), "full height glyph did not fit after eviction", -1);
+        Check(tall.GetEntryCount() == 1 && tall.GetShelfCount() == 1, "shelves were not merged", -1);
+    }
+}
+
+
+int main()
+{
+    TestEvictionOrder();
+
+    for (int seed = 0; seed < 50; ++seed)
+        TestRandomGlyphs(seed);
+
+    if (g_failures)
+    {
+        printf("%d checks failed\n", g_failures);
+        return 1;
+    }
+
+    printf("GlyphAtlas tests passed\n");
+    return 0;
+}
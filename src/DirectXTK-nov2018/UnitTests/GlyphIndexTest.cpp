@@ -0,0 +1,312 @@
+//--------------------------------------------------------------------------------------
+// File: GlyphIndexTest.cpp
+//
+// Tests for the SpriteFont glyph index: every code point must find the same glyph as the
+// binary search SpriteFont used before, for the bundled Arial font and for synthetic fonts
+// with Latin, CJK, non-BMP and duplicate glyphs. Also reports lookups per second for both.
+//
+// Build and run from the DirectXTK folder with g++ (-I- keeps GlyphIndex.h from using Src/pch.h).
+// The font defaults to the bundled assets/Arial.spritefont; another may be given as an argument:
+//   g++ -std=c++14 -O2 -I UnitTests/Linux -I- -I UnitTests/Linux -I Src UnitTests/GlyphIndexTest.cpp -o GlyphIndexTest
+//   ./GlyphIndexTest [font.spritefont]
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "pch.h"
+
+#include "GlyphIndex.h"
+
+using namespace DirectX;
+
+namespace
+{
+    int g_failures = 0;
+
+    void Check(bool condition, const char* message, const char* test)
+    {
+        if (!condition)
+        {
+            if (g_failures < 20)
+                printf("FAILED (%s): %s\n", test, message);
+            g_failures++;
+        }
+    }
+
+    // Same layout as SpriteFont::Glyph, which is how glyphs are stored in .spritefont files.
+    struct Glyph
+    {
+        uint32_t Character;
+        int32_t Subrect[4];
+        float XOffset;
+        float YOffset;
+        float XAdvance;
+    };
+
+    static_assert(sizeof(Glyph) == 32, "Glyph does not match the .spritefont layout");
+
+    // The lookup SpriteFont used before the index.
+    Glyph const* BinarySearch(std::vector<Glyph> const& glyphs, uint32_t character)
+    {
+        auto glyph = std::lower_bound(glyphs.begin(), glyphs.end(), character, [](Glyph const& left, uint32_t right)
+        {
+            return left.Character < right;
+        });
+
+        if (glyph != glyphs.end() && glyph->Character == character)
+        {
+            return &*glyph;
+        }
+
+        return nullptr;
+    }
+
+    // Reads the glyphs of a MakeSpriteFont output binary, which start after the magic and a glyph count.
+    bool LoadGlyphs(const char* fileName, std::vector<Glyph>& glyphs)
+    {
+        FILE* file = fopen(fileName, "rb");
+        if (!file)
+            return false;
+
+        char magic[8];
+        uint32_t glyphCount = 0;
+
+        bool ok = fread(magic, sizeof(magic), 1, file) == 1
+            && memcmp(magic, "DXTKfont", sizeof(magic)) == 0
+            && fread(&glyphCount, sizeof(glyphCount), 1, file) == 1;
+
+        if (ok)
+        {
+            glyphs.resize(glyphCount);
+            ok = fread(glyphs.data(), sizeof(Glyph), glyphCount, file) == glyphCount;
+        }
+
+        fclose(file);
+        return ok;
+    }
+
+    Glyph MakeGlyph(uint32_t character, float xAdvance)
+    {
+        Glyph glyph = {};
+        glyph.Character = character;
+        glyph.XAdvance = xAdvance;
+        return glyph;
+    }
+
+    // Every code point up to past the end of the BMP, plus everything the font has.
+    void CheckAgainstBinarySearch(std::vector<Glyph> const& glyphs, const char* test)
+    {
+        GlyphIndex<Glyph> index;
+        index.Build(glyphs.data(), glyphs.size());
+
+        bool same = true;
+
+        for (uint32_t character = 0; character < 0x20000; character++)
+        {
+            same &= index.Find(character) == BinarySearch(glyphs, character);
+        }
+
+        for (auto const& glyph : glyphs)
+        {
+            same &= index.Find(glyph.Character) == BinarySearch(glyphs, glyph.Character);
+            same &= index.Find(glyph.Character + 1) == BinarySearch(glyphs, glyph.Character + 1);
+        }
+
+        same &= index.Find(0xFFFFFFFF) == BinarySearch(glyphs, 0xFFFFFFFF);
+
+        Check(same, "index does not match binary search", test);
+    }
+
+
+    void TestFont(std::vector<Glyph> const& glyphs)
+    {
+        Check(!glyphs.empty(), "font has no glyphs", "Font");
+
+        CheckAgainstBinarySearch(glyphs, "Font");
+
+        GlyphIndex<Glyph> index;
+        index.Build(glyphs.data(), glyphs.size());
+
+        auto glyph = index.Find('A');
+        Check(glyph && glyph->Character == 'A', "A not found", "Font");
+    }
+
+
+    void TestSynthetic()
+    {
+        std::vector<Glyph> glyphs;
+
+        // Latin-1, Cyrillic, a page boundary, CJK, the last BMP code point and a few emoji.
+        for (uint32_t c = 32; c < 256; c++)
+            glyphs.push_back(MakeGlyph(c, 1));
+        for (uint32_t c = 0x400; c < 0x460; c++)
+            glyphs.push_back(MakeGlyph(c, 2));
+        glyphs.push_back(MakeGlyph(0x4FF, 3));
+        glyphs.push_back(MakeGlyph(0x500, 3));
+        for (uint32_t c = 0x4E00; c < 0x5200; c += 3)
+            glyphs.push_back(MakeGlyph(c, 4));
+        glyphs.push_back(MakeGlyph(0xFFFF, 5));
+        glyphs.push_back(MakeGlyph(0x10000, 6));
+        glyphs.push_back(MakeGlyph(0x1F600, 6));
+        glyphs.push_back(MakeGlyph(0x1F601, 6));
+
+        CheckAgainstBinarySearch(glyphs, "Synthetic");
+
+        GlyphIndex<Glyph> index;
+        index.Build(glyphs.data(), glyphs.size());
+
+        Check(index.Find(31) == nullptr, "control character found", "Synthetic");
+        Check(index.Find(0x460) == nullptr, "missing Cyrillic found", "Synthetic");
+        Check(index.Find(0x4E01) == nullptr, "missing CJK found", "Synthetic");
+        Check(index.Find(0xFFFF) && index.Find(0xFFFF)->XAdvance == 5, "last BMP glyph", "Synthetic");
+        Check(index.Find(0x1F600) && index.Find(0x1F600)->Character == 0x1F600, "emoji", "Synthetic");
+        Check(index.Find(0x1F602) == nullptr, "missing emoji found", "Synthetic");
+
+        // Rebuilding must forget the old glyphs.
+        std::vector<Glyph> other = { MakeGlyph('x', 7) };
+        index.Build(other.data(), other.size());
+
+        Check(index.Find('A') == nullptr, "stale Latin glyph", "Synthetic");
+        Check(index.Find(0x4E00) == nullptr, "stale page glyph", "Synthetic");
+        Check(index.Find(0x1F600) == nullptr, "stale non-BMP glyph", "Synthetic");
+        Check(index.Find('x') && index.Find('x')->XAdvance == 7, "rebuilt glyph", "Synthetic");
+
+        // An empty font finds nothing.
+        index.Build(nullptr, 0);
+
+        Check(index.Find('x') == nullptr && index.Find(0x4E00) == nullptr && index.Find(0x1F600) == nullptr, "empty font", "Synthetic");
+    }
+
+
+    // SpriteFont only checks that glyphs are sorted, so duplicates are possible. Like the
+    // binary search, the index must return the first of them.
+    void TestDuplicates()
+    {
+        std::vector<Glyph> glyphs =
+        {
+            MakeGlyph('a', 1), MakeGlyph('a', 2), MakeGlyph('a', 3),
+            MakeGlyph(0x3042, 1), MakeGlyph(0x3042, 2),
+            MakeGlyph(0x1F600, 1), MakeGlyph(0x1F600, 2),
+        };
+
+        CheckAgainstBinarySearch(glyphs, "Duplicates");
+
+        GlyphIndex<Glyph> index;
+        index.Build(glyphs.data(), glyphs.size());
+
+        Check(index.Find('a') == &glyphs[0], "first Latin duplicate", "Duplicates");
+        Check(index.Find(0x3042) == &glyphs[3], "first BMP duplicate", "Duplicates");
+        Check(index.Find(0x1F600) == &glyphs[5], "first non-BMP duplicate", "Duplicates");
+    }
+
+
+    // Looks up every character of some HUD text, as SpriteFont does when drawing it.
+    template<typename TFind>
+    double LookupsPerSecond(std::vector<uint32_t> const& text, TFind find, uintptr_t& checksum)
+    {
+        const int repeats = 2000;
+
+        auto start = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < repeats; i++)
+        {
+            for (auto character : text)
+            {
+                checksum += reinterpret_cast<uintptr_t>(find(character));
+            }
+        }
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        return double(text.size()) * repeats / seconds;
+    }
+
+    void ReportThroughput(std::vector<Glyph> const& glyphs, const char* name, std::vector<uint32_t> const& text)
+    {
+        GlyphIndex<Glyph> index;
+        index.Build(glyphs.data(), glyphs.size());
+
+        uintptr_t checksum = 0;
+
+        double search = LookupsPerSecond(text, [&](uint32_t c) { return BinarySearch(glyphs, c); }, checksum);
+        double indexed = LookupsPerSecond(text, [&](uint32_t c) { return index.Find(c); }, checksum);
+
+        printf("%-10s %4zu glyphs: binary search %6.1f M/s, index %6.1f M/s (%.1fx)\n",
+            name, glyphs.size(), search / 1e6, indexed / 1e6, indexed / search);
+
+        // Keep the lookups from being optimized away.
+        if (checksum == 1)
+            printf("\n");
+    }
+
+    std::vector<uint32_t> HudText()
+    {
+        const char* lines[] =
+        {
+            "Score: 1234567   Lives: 3   Level 12 - The Sunken Keep",
+            "Ammo 24/120   Health 87%   Shield 42%   [F] Interact",
+            "FPS: 144.2   Frame 6.94 ms   Draw calls: 312   Sprites: 4096",
+        };
+
+        std::vector<uint32_t> text;
+        for (auto line : lines)
+        {
+            for (auto p = line; *p; p++)
+                text.push_back(static_cast<unsigned char>(*p));
+        }
+
+        return text;
+    }
+}
+
+
+int main(int argc, char* argv[])
+{
+    const char* fontName = (argc > 1) ? argv[1] : "../../assets/Arial.spritefont";
+
+    std::vector<Glyph> font;
+
+    if (!LoadGlyphs(fontName, font))
+    {
+        printf("FAILED: cannot read glyphs from %s\n", fontName);
+        return 1;
+    }
+
+    TestFont(font);
+    TestSynthetic();
+    TestDuplicates();
+
+    // The bundled font with ASCII text, and a large CJK font with mixed text.
+    auto text = HudText();
+
+    ReportThroughput(font, "Arial", text);
+
+    std::vector<Glyph> cjk;
+    for (uint32_t c = 32; c < 127; c++)
+        cjk.push_back(MakeGlyph(c, 1));
+    for (uint32_t c = 0x3000; c < 0x3100; c++)
+        cjk.push_back(MakeGlyph(c, 1));
+    for (uint32_t c = 0x4E00; c < 0x9FA6; c++)
+        cjk.push_back(MakeGlyph(c, 1));
+
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<uint32_t> ideograph(0x4E00, 0x9FA5);
+
+    auto mixed = text;
+    for (size_t i = 0; i < mixed.size(); i += 2)
+        mixed[i] = ideograph(rng);
+
+    ReportThroughput(cjk, "CJK", mixed);
+
+    if (g_failures)
+    {
+        printf("%d checks failed\n", g_failures);
+        return 1;
+    }
+
+    printf("GlyphIndex tests passed\n");
+    return 0;
+}
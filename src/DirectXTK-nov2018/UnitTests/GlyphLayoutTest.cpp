@@ -0,0 +1,566 @@
+//--------------------------------------------------------------------------------------
+// File: GlyphLayoutTest.cpp
+//
+// Tests for the SpriteFont text decoding and layout: malformed, overlong, surrogate and
+// truncated UTF-8, surrogate pairs in UTF-16, kerning and whitespace. Also reports layout
+// speed for ASCII text against the wchar_t and iswspace loop SpriteFont used before kerning
+// and UTF-8 support, and UTF-8 decoding speed.
+//
+// Build and run from the DirectXTK folder with g++ (-I- keeps the library headers from using Src/pch.h).
+// Build it a second time with -D_XM_SSE_INTRINSICS_ to test the SSE2 path of DecodeUtf8, which must
+// decode random text the same as the byte at a time rules. The font defaults to the bundled
+// assets/Arial.spritefont; another may be given as an argument:
+//   g++ -std=c++14 -O2 -I UnitTests/Linux -I- -I UnitTests/Linux -I Src UnitTests/GlyphLayoutTest.cpp -o GlyphLayoutTest
+//   g++ -std=c++14 -O2 -D_XM_SSE_INTRINSICS_ -I UnitTests/Linux -I- -I UnitTests/Linux -I Src UnitTests/GlyphLayoutTest.cpp -o GlyphLayoutTestSSE
+//   ./GlyphLayoutTest [font.spritefont] && ./GlyphLayoutTestSSE [font.spritefont]
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "pch.h"
+
+#include "GlyphIndex.h"
+#include "GlyphLayout.h"
+
+using namespace DirectX;
+
+namespace
+{
+    int g_failures = 0;
+
+    void Check(bool condition, const char* message, const char* test)
+    {
+        if (!condition)
+        {
+            if (g_failures < 20)
+                printf("FAILED (%s): %s\n", test, message);
+            g_failures++;
+        }
+    }
+
+    // Same layout as SpriteFont::Glyph, which is how glyphs are stored in .spritefont files.
+    struct Glyph
+    {
+        uint32_t Character;
+        struct
+        {
+            int32_t left;
+            int32_t top;
+            int32_t right;
+            int32_t bottom;
+        } Subrect;
+        float XOffset;
+        float YOffset;
+        float XAdvance;
+    };
+
+    static_assert(sizeof(Glyph) == 32, "Glyph does not match the .spritefont layout");
+
+    // Reads the glyphs of a MakeSpriteFont output binary, which start after the magic and a glyph count.
+    bool LoadGlyphs(const char* fileName, std::vector<Glyph>& glyphs)
+    {
+        FILE* file = fopen(fileName, "rb");
+        if (!file)
+            return false;
+
+        char magic[8];
+        uint32_t glyphCount = 0;
+
+        bool ok = fread(magic, sizeof(magic), 1, file) == 1
+            && memcmp(magic, "DXTKfont", sizeof(magic)) == 0
+            && fread(&glyphCount, sizeof(glyphCount), 1, file) == 1;
+
+        if (ok)
+        {
+            glyphs.resize(glyphCount);
+            ok = fread(glyphs.data(), sizeof(Glyph), glyphCount, file) == glyphCount;
+        }
+
+        fclose(file);
+        return ok;
+    }
+
+    Glyph MakeGlyph(uint32_t character, int32_t width, float xAdvance)
+    {
+        Glyph glyph = {};
+        glyph.Character = character;
+        glyph.Subrect.right = width;
+        glyph.Subrect.bottom = 10;
+        glyph.XAdvance = xAdvance;
+        return glyph;
+    }
+
+    std::u32string Decode(std::string const& text)
+    {
+        return DecodeUtf8(text.c_str());
+    }
+
+    // Encodes code points as UTF-8, without checking them.
+    std::string Encode(std::u32string const& text)
+    {
+        std::string result;
+
+        for (uint32_t c : text)
+        {
+            if (c < 0x80)
+            {
+                result += char(c);
+            }
+            else if (c < 0x800)
+            {
+                result += char(0xC0 | (c >> 6));
+                result += char(0x80 | (c & 0x3F));
+            }
+            else if (c < 0x10000)
+            {
+                result += char(0xE0 | (c >> 12));
+                result += char(0x80 | ((c >> 6) & 0x3F));
+                result += char(0x80 | (c & 0x3F));
+            }
+            else
+            {
+                result += char(0xF0 | (c >> 18));
+                result += char(0x80 | ((c >> 12) & 0x3F));
+                result += char(0x80 | ((c >> 6) & 0x3F));
+                result += char(0x80 | (c & 0x3F));
+            }
+        }
+
+        return result;
+    }
+
+    // Decodes a single position of UTF-8 text by the rules DecodeUtf8 follows: a bad lead byte is one
+    // U+FFFD, and a sequence stops at the first byte that is not a continuation byte.
+    std::u32string ReferenceDecode(std::string const& text)
+    {
+        std::u32string result;
+
+        for (size_t i = 0; i < text.size();)
+        {
+            uint8_t lead = uint8_t(text[i++]);
+
+            size_t length = (lead < 0x80) ? 1 : ((lead >> 5) == 6) ? 2 : ((lead >> 4) == 14) ? 3 : ((lead >> 3) == 30) ? 4 : 0;
+
+            if (length == 1)
+            {
+                result += char32_t(lead);
+                continue;
+            }
+
+            if (!length)
+            {
+                result += char32_t(0xFFFD);
+                continue;
+            }
+
+            uint32_t c = lead & (0x7F >> length);
+            size_t trail = 1;
+
+            for (; trail < length && i < text.size() && (uint8_t(text[i]) >> 6) == 2; trail++, i++)
+                c = (c << 6) | (uint8_t(text[i]) & 0x3F);
+
+            static const uint32_t minimum[5] = { 0, 0, 0x80, 0x800, 0x10000 };
+
+            bool valid = trail == length && c >= minimum[length] && c <= 0x10FFFF && (c < 0xD800 || c > 0xDFFF);
+
+            result += char32_t(valid ? c : 0xFFFD);
+        }
+
+        return result;
+    }
+
+
+    void TestUtf8()
+    {
+        const char* test = "Utf8";
+
+        Check(Decode("") == U"", "empty", test);
+        Check(Decode("Hello") == U"Hello", "ASCII", test);
+        Check(Decode("\xC3\xA9t\xC3\xA9") == U"\u00E9t\u00E9", "two byte", test);
+        Check(Decode("\xE2\x82\xAC") == U"\u20AC", "three byte", test);
+        Check(Decode("\xF0\x9F\x98\x80!") == U"\U0001F600!", "four byte", test);
+        Check(Decode("\xF4\x8F\xBF\xBF") == U"\U0010FFFF", "last code point", test);
+
+        // Overlong encodings of '/' and U+20AC, and the smallest of each length.
+        Check(Decode("\xC0\xAF") == U"\uFFFD", "overlong two byte", test);
+        Check(Decode("\xE0\x80\xAF") == U"\uFFFD", "overlong three byte", test);
+        Check(Decode("\xF0\x82\x82\xAC") == U"\uFFFD", "overlong four byte", test);
+        Check(Decode("\xC2\x80\xE0\xA0\x80\xF0\x90\x80\x80") == U"\u0080\u0800\U00010000", "smallest of each length", test);
+
+        // Surrogates and values past the Unicode range.
+        Check(Decode("\xED\xA0\x80") == U"\uFFFD", "high surrogate", test);
+        Check(Decode("\xED\xBF\xBF") == U"\uFFFD", "low surrogate", test);
+        Check(Decode("\xED\x9F\xBF") == U"\uD7FF", "before the surrogates", test);
+        Check(Decode("\xF4\x90\x80\x80") == U"\uFFFD", "past U+10FFFF", test);
+
+        // Bad lead bytes.
+        Check(Decode("a\x80z") == U"a\uFFFDz", "continuation byte", test);
+        Check(Decode("\xF8\x88\x80\x80\x80") == U"\uFFFD\uFFFD\uFFFD\uFFFD\uFFFD", "five byte", test);
+        Check(Decode("\xFF\xFE") == U"\uFFFD\uFFFD", "FF FE", test);
+
+        // Truncated sequences stop at the next lead byte, or at the end of the string.
+        Check(Decode("\xE2\x82") == U"\uFFFD", "truncated at end", test);
+        Check(Decode("\xE2\x82z") == U"\uFFFDz", "truncated by ASCII", test);
+        Check(Decode("\xF0\x9F\xC3\xA9") == U"\uFFFD\u00E9", "truncated by a lead byte", test);
+
+        // Multi-byte characters either side of a sixteen byte ASCII run.
+        std::string mixed = "\xC3\xA9" "0123456789abcdefghij" "\xE2\x82\xAC" "0123456789abcdef";
+        Check(Decode(mixed) == U"\u00E9" U"0123456789abcdefghij" U"\u20AC" U"0123456789abcdef", "ASCII runs", test);
+
+        // Random text, mostly runs of ASCII with multi-byte and malformed bytes in between.
+        std::mt19937 rng(1);
+        std::uniform_int_distribution<int> kind(0, 9);
+        std::uniform_int_distribution<int> ascii(1, 127);
+        std::uniform_int_distribution<int> byte(1, 255);
+        std::uniform_int_distribution<uint32_t> codePoint(0x80, 0x10FFFF);
+
+        bool same = true;
+        bool roundTrip = true;
+
+        for (int i = 0; i < 2000; i++)
+        {
+            std::string text;
+            std::u32string valid;
+
+            for (int j = 0; j < 64; j++)
+            {
+                int k = kind(rng);
+
+                if (k < 6)
+                {
+                    int run = ascii(rng) % 24;
+                    for (int n = 0; n < run; n++)
+                        text += char(ascii(rng));
+                }
+                else if (k < 9)
+                {
+                    uint32_t c = codePoint(rng);
+                    if (c >= 0xD800 && c <= 0xDFFF)
+                        c = 0xFFFD;
+                    text += Encode(std::u32string(1, char32_t(c)));
+                }
+                else
+                {
+                    text += char(byte(rng));
+                }
+            }
+
+            same &= Decode(text) == ReferenceDecode(text);
+
+            // Well formed text decodes to the code points it was encoded from.
+            valid.clear();
+            for (int j = 0; j < 40; j++)
+            {
+                uint32_t c = (j % 3) ? uint32_t(ascii(rng)) : codePoint(rng);
+                if (c >= 0xD800 && c <= 0xDFFF)
+                    c = 0xFFFD;
+                valid += char32_t(c);
+            }
+
+            roundTrip &= Decode(Encode(valid)) == valid;
+        }
+
+        Check(same, "random text does not match the byte at a time rules", test);
+        Check(roundTrip, "well formed text does not round trip", test);
+    }
+
+
+    std::u32string ReadAll(Utf16Reader reader)
+    {
+        std::u32string result;
+        for (uint32_t c = reader.Next(); c; c = reader.Next())
+            result += char32_t(c);
+        return result;
+    }
+
+    void TestUtf16()
+    {
+        const char* test = "Utf16";
+
+        // wchar_t is 32 bits here, but the reader only looks at the values of the code units.
+        const wchar_t pair[] = { 'a', 0xD83D, 0xDE00, 'b', 0 };
+        const wchar_t highAlone[] = { 'a', 0xD83D, 'b', 0 };
+        const wchar_t highAtEnd[] = { 'a', 0xD83D, 0 };
+        const wchar_t lowAlone[] = { 0xDE00, 'b', 0 };
+        const wchar_t reversed[] = { 0xDE00, 0xD83D, 0 };
+        const wchar_t bounds[] = { 0xD800, 0xDC00, 0xDBFF, 0xDFFF, 0 };
+
+        Check(ReadAll(Utf16Reader(pair)) == U"a\U0001F600b", "surrogate pair", test);
+        Check(ReadAll(Utf16Reader(highAlone)) == U"a\uFFFDb", "unpaired high surrogate", test);
+        Check(ReadAll(Utf16Reader(highAtEnd)) == U"a\uFFFD", "high surrogate at the end", test);
+        Check(ReadAll(Utf16Reader(lowAlone)) == U"\uFFFDb", "unpaired low surrogate", test);
+        Check(ReadAll(Utf16Reader(reversed)) == U"\uFFFD\uFFFD", "reversed pair", test);
+        Check(ReadAll(Utf16Reader(bounds)) == U"\U00010000\U0010FFFF", "first and last pair", test);
+        Check(ReadAll(Utf16Reader(L"")) == U"", "empty", test);
+
+        auto text = U"x\U0001F600y";
+        Utf32Reader reader(text);
+        Check(reader.Next() == 'x' && reader.Next() == 0x1F600 && reader.Next() == 'y' && reader.Next() == 0 && reader.Next() == 0, "UTF-32", test);
+    }
+
+
+    void TestWhitespace()
+    {
+        bool same = true;
+
+        for (uint32_t c = 0; c < 0x80; c++)
+            same &= IsWhitespace(c) == (iswspace(wint_t(c)) != 0);
+
+        Check(same, "ASCII does not match iswspace", "Whitespace");
+        Check(!IsWhitespace(0x1F600) && !IsWhitespace(0x20000), "non-BMP", "Whitespace");
+    }
+
+
+    struct Placed
+    {
+        uint32_t character;
+        float x;
+        float y;
+        float advance;
+    };
+
+    // Lays out text in a small synthetic font: glyphs are 4 by 10 with an advance of 1, except
+    // the space, which is 1 by 1, the ideographic space, which is 1 by 10, and U+1F600, which is 8 wide.
+    std::vector<Placed> LayOut(std::u32string const& text, KerningTable const& kerning)
+    {
+        static std::vector<Glyph> glyphs;
+
+        if (glyphs.empty())
+        {
+            glyphs.push_back(MakeGlyph(' ', 1, 2));
+            glyphs.back().Subrect.bottom = 1;
+            for (uint32_t c = 'A'; c <= 'Z'; c++)
+                glyphs.push_back(MakeGlyph(c, 4, 1));
+            glyphs.push_back(MakeGlyph(0x3000, 1, 9));
+            glyphs.push_back(MakeGlyph(0xFFFD, 4, 1));
+            glyphs.push_back(MakeGlyph(0x1F600, 8, 1));
+        }
+
+        GlyphIndex<Glyph> index;
+        index.Build(glyphs.data(), glyphs.size());
+
+        std::vector<Placed> placed;
+
+        LayOutGlyphs(Utf32Reader(text.c_str()), [&](uint32_t c) { return index.Find(c); }, kerning, 20.0f,
+            [&](Glyph const* glyph, float x, float y, float advance)
+        {
+            placed.push_back({ glyph->Character, x, y, advance });
+        });
+
+        return placed;
+    }
+
+    bool Is(Placed const& placed, uint32_t character, float x, float y)
+    {
+        return placed.character == character && placed.x == x && placed.y == y;
+    }
+
+    void TestLayout()
+    {
+        const char* test = "Layout";
+
+        KerningTable none;
+        KerningTable kerning;
+        kerning.Set('A', 'V', -2);
+        kerning.Set('V', 'A', -1.5f);
+        kerning.Set('A', 'V', -3);
+        kerning.Set(0x1F600, 'A', 2);
+
+        Check(kerning.Get('A', 'V') == -3 && kerning.Get('V', 'A') == -1.5f && kerning.Get('A', 'A') == 0, "kerning table", test);
+        Check(none.Empty() && !kerning.Empty(), "empty kerning table", test);
+
+        auto plain = LayOut(U"AVA", none);
+        Check(plain.size() == 3 && Is(plain[0], 'A', 0, 0) && Is(plain[1], 'V', 5, 0) && Is(plain[2], 'A', 10, 0), "without kerning", test);
+        Check(plain.size() == 3 && plain[0].advance == 5, "advance", test);
+
+        auto kerned = LayOut(U"AVA", kerning);
+        Check(kerned.size() == 3 && Is(kerned[0], 'A', 0, 0) && Is(kerned[1], 'V', 2, 0) && Is(kerned[2], 'A', 5.5f, 0), "with kerning", test);
+
+        // Kerning does not apply across a new line, and carriage returns are skipped.
+        auto lines = LayOut(U"A\r\nVA", kerning);
+        Check(lines.size() == 3 && Is(lines[1], 'V', 0, 20) && Is(lines[2], 'A', 3.5f, 20), "new line", test);
+
+        // Whitespace with an empty glyph is not drawn, but still advances; a larger glyph is drawn.
+        auto spaced = LayOut(U"A B\u3000C", none);
+        Check(spaced.size() == 4 && Is(spaced[1], 'B', 8, 0) && Is(spaced[2], 0x3000, 13, 0) && Is(spaced[3], 'C', 23, 0), "whitespace", test);
+
+        // Non-BMP characters are kerned like any other.
+        auto emoji = LayOut(U"\U0001F600A", kerning);
+        Check(emoji.size() == 2 && Is(emoji[0], 0x1F600, 0, 0) && Is(emoji[1], 'A', 11, 0), "non-BMP", test);
+
+        // Kerning never moves a glyph left of the start of the line.
+        KerningTable negative;
+        negative.Set('A', 'B', -100);
+        auto clamped = LayOut(U"AB", negative);
+        Check(clamped.size() == 2 && Is(clamped[1], 'B', 0, 0), "clamped", test);
+
+        // Decoded UTF-8 and UTF-16 surrogate pairs lay out the same.
+        const wchar_t pair[] = { 'A', 0xD83D, 0xDE00, 'A', 0 };
+        std::u32string fromUtf16 = ReadAll(Utf16Reader(pair));
+        std::u32string fromUtf8 = Decode("A\xF0\x9F\x98\x80" "A");
+        Check(fromUtf16 == fromUtf8 && LayOut(fromUtf8, kerning).size() == 3, "UTF-8 and UTF-16", test);
+    }
+
+
+    // The layout loop SpriteFont used before kerning and UTF-8 support.
+    template<typename TFindGlyph, typename TAction>
+    void PreviousForEachGlyph(_In_z_ wchar_t const* text, TFindGlyph findGlyph, float lineSpacing, TAction action)
+    {
+        float x = 0;
+        float y = 0;
+
+        for (; *text; text++)
+        {
+            wchar_t character = *text;
+
+            switch (character)
+            {
+                case '\r':
+                    // Skip carriage returns.
+                    continue;
+
+                case '\n':
+                    // New line.
+                    x = 0;
+                    y += lineSpacing;
+                    break;
+
+                default:
+                    // Output this character.
+                    auto glyph = findGlyph(character);
+
+                    x += glyph->XOffset;
+
+                    if (x < 0)
+                        x = 0;
+
+                    float advance = glyph->Subrect.right - glyph->Subrect.left + glyph->XAdvance;
+
+                    if (!iswspace(character)
+                        || ((glyph->Subrect.right - glyph->Subrect.left) > 1)
+                        || ((glyph->Subrect.bottom - glyph->Subrect.top) > 1))
+                    {
+                        action(glyph, x, y, advance);
+                    }
+
+                    x += advance;
+                    break;
+            }
+        }
+    }
+
+    template<typename TLayOut>
+    double CharactersPerSecond(size_t length, TLayOut layOut)
+    {
+        const int repeats = 20000;
+
+        auto start = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < repeats; i++)
+            layOut();
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        return double(length) * repeats / seconds;
+    }
+
+    void ReportThroughput(std::vector<Glyph> const& glyphs)
+    {
+        const char hud[] =
+            "Score: 1234567   Lives: 3   Level 12 - The Sunken Keep\n"
+            "Ammo 24/120   Health 87%   Shield 42%   [F] Interact\n"
+            "FPS: 144.2   Frame 6.94 ms   Draw calls: 312   Sprites: 4096\n";
+
+        std::wstring wide(hud, hud + sizeof(hud) - 1);
+        std::string utf8 = hud;
+        size_t length = utf8.size();
+
+        GlyphIndex<Glyph> index;
+        index.Build(glyphs.data(), glyphs.size());
+
+        auto findGlyph = [&](uint32_t c) { return index.Find(c); };
+
+        float sum = 0;
+        auto action = [&](Glyph const*, float x, float y, float advance) { sum += x + y + advance; };
+
+        KerningTable none;
+        KerningTable kerning;
+        for (auto const& first : glyphs)
+        {
+            for (auto const& second : glyphs)
+            {
+                if ((first.Character + second.Character) % 7 == 0)
+                    kerning.Set(first.Character, second.Character, -0.5f);
+            }
+        }
+
+        // Each is measured twice, and the faster run kept, to smooth out the first run warming up.
+        double previous = 0, utf16 = 0, kerned = 0, decoded = 0;
+
+        for (int pass = 0; pass < 2; pass++)
+        {
+            previous = std::max(previous, CharactersPerSecond(length, [&] { PreviousForEachGlyph(wide.c_str(), findGlyph, 20.0f, action); }));
+            utf16 = std::max(utf16, CharactersPerSecond(length, [&] { LayOutGlyphs(Utf16Reader(wide.c_str()), findGlyph, none, 20.0f, action); }));
+            kerned = std::max(kerned, CharactersPerSecond(length, [&] { LayOutGlyphs(Utf16Reader(wide.c_str()), findGlyph, kerning, 20.0f, action); }));
+            decoded = std::max(decoded, CharactersPerSecond(length, [&] { LayOutGlyphs(Utf32Reader(DecodeUtf8(utf8.c_str())), findGlyph, none, 20.0f, action); }));
+        }
+
+        printf("ASCII layout: previous loop %6.1f M chars/s, UTF-16 %6.1f M/s (%.2fx), kerned %6.1f M/s, UTF-8 %6.1f M/s\n",
+            previous / 1e6, utf16 / 1e6, utf16 / previous, kerned / 1e6, decoded / 1e6);
+
+        // Decoding alone, for ASCII and for text that is mostly CJK.
+        std::string cjk;
+        for (int i = 0; i < 60; i++)
+            cjk += (i % 4) ? "\xE6\xBC\xA2" : " ";
+
+        size_t checksum = 0;
+
+        double asciiDecode = CharactersPerSecond(length, [&] { checksum += DecodeUtf8(utf8.c_str())[0]; });
+        double cjkDecode = CharactersPerSecond(60, [&] { checksum += DecodeUtf8(cjk.c_str())[0]; });
+
+        printf("UTF-8 decode%s: ASCII %6.1f M chars/s, CJK %6.1f M chars/s\n",
+#if defined(_XM_SSE_INTRINSICS_)
+            " (SSE2)",
+#else
+            "",
+#endif
+            asciiDecode / 1e6, cjkDecode / 1e6);
+
+        // Keep the layout from being optimized away.
+        if (sum == 1 || checksum == 1)
+            printf("\n");
+    }
+}
+
+
+int main(int argc, char* argv[])
+{
+    const char* fontName = (argc > 1) ? argv[1] : "../../assets/Arial.spritefont";
+
+    std::vector<Glyph> font;
+
+    if (!LoadGlyphs(fontName, font))
+    {
+        printf("FAILED: cannot read glyphs from %s\n", fontName);
+        return 1;
+    }
+
+    TestUtf8();
+    TestUtf16();
+    TestWhitespace();
+    TestLayout();
+
+    ReportThroughput(font);
+
+    if (g_failures)
+    {
+        printf("%d checks failed\n", g_failures);
+        return 1;
+    }
+
+    printf("GlyphLayout tests passed\n");
+    return 0;
+}
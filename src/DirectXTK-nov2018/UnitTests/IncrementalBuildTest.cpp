@@ -0,0 +1,557 @@
+//--------------------------------------------------------------------------------------
+// File: IncrementalBuildTest.cpp
+//
+// Tests for the incremental wave bank builds of xwbtool (-inc). Each build follows the
+// manifest decisions and write plan of xwbtool, applied to the previous bank file, and the
+// bank must match a clean build byte for byte. Covers patching in place, copying from the
+// previous bank, inserted, removed, reordered and duplicate waves, format, alignment and
+// metadata changes, and random edit sequences. Also reports the bytes an incremental
+// build writes and copies, against a clean build of a large bank.
+//
+// Build and run from the DirectXTK folder with g++ (-I- keeps the tool headers from using a pch.h):
+//   g++ -std=c++14 -O2 -I UnitTests/Linux -I- -I UnitTests/Linux -I XWBTool UnitTests/IncrementalBuildTest.cpp -o IncrementalBuildTest
+//   ./IncrementalBuildTest
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "pch.h"
+
+#include "IncrementalBuild.h"
+
+using namespace XWBTool;
+
+namespace
+{
+    int g_failures = 0;
+
+    void Check(bool condition, const char* message, const char* test)
+    {
+        if (!condition)
+        {
+            if (g_failures < 20)
+                printf("FAILED (%s): %s\n", test, message);
+            g_failures++;
+        }
+    }
+
+    const uint64_t FNV64_OFFSET_BASIS = 14695981039346656037ull;
+    const uint64_t FNV64_PRIME = 1099511628211ull;
+
+    uint64_t HashBytes(const uint8_t* data, size_t size)
+    {
+        uint64_t hash = FNV64_OFFSET_BASIS;
+        for (size_t j = 0; j < size; ++j)
+        {
+            hash ^= data[j];
+            hash *= FNV64_PRIME;
+        }
+        return hash;
+    }
+
+    // A .wav input of the bank, reduced to what the manifest records about it.
+    struct Source
+    {
+        uint64_t path;
+        uint64_t writeTime;
+        uint32_t format;
+        std::vector<uint8_t> audio;
+    };
+
+    // The payload stored for a source. The content hash is of the source's audio, so formats must store it
+    // differently: format 2 in the same length, format 3 in half of it, like -adpcm.
+    std::vector<uint8_t> Payload(const Source& source)
+    {
+        std::vector<uint8_t> payload;
+        switch (source.format)
+        {
+            case 2:
+                for (auto value : source.audio)
+                    payload.push_back(static_cast<uint8_t>(value ^ 0x5A));
+                break;
+
+            case 3:
+                for (size_t j = 0; j < source.audio.size(); j += 2)
+                    payload.push_back(static_cast<uint8_t>(source.audio[j] + 1));
+                break;
+
+            default:
+                payload = source.audio;
+                break;
+        }
+        return payload;
+    }
+
+    // What is passed on the command line, besides the sources.
+    struct Options
+    {
+        uint32_t alignment;
+        bool friendlyNames;     // -f adds a name per entry to the metadata, moving the wave data segment
+    };
+
+    // A built wave bank: its manifest and file.
+    struct Bank
+    {
+        MANIFESTHEADER header;
+        std::vector<MANIFESTENTRY> entries;
+        std::vector<uint8_t> file;
+    };
+
+    // Counts what a build did.
+    struct BuildStats
+    {
+        bool inPlace = false;
+        size_t reused = 0;
+        size_t hashed = 0;
+        size_t copies = 0;
+        uint64_t bytesWritten = 0;
+        uint64_t bytesCopied = 0;
+        double planMs = 0;      // Matching against the manifest and planning the writes, without hashing
+    };
+
+    // The metadata grows with the entry count, which moves the wave data segment as xwbtool's does.
+    uint32_t DataOffset(size_t entryCount, const Options& options)
+    {
+        uint64_t metadataBytes = 52 + 96 + 24 * uint64_t(entryCount);
+        if (options.friendlyNames)
+            metadataBytes += 64 * uint64_t(entryCount);
+
+        return uint32_t(AlignedLength(metadataBytes, options.alignment));
+    }
+
+    // The manifest entries as xwbtool fills them in before matching, with the payloads they describe.
+    std::vector<MANIFESTENTRY> LayOut(const std::vector<Source>& sources, uint32_t alignment, std::vector<std::vector<uint8_t>>& payloads)
+    {
+        std::vector<MANIFESTENTRY> entries(sources.size());
+        payloads.resize(sources.size());
+
+        uint32_t offset = 0;
+        for (size_t j = 0; j < sources.size(); ++j)
+        {
+            payloads[j] = Payload(sources[j]);
+
+            auto& entry = entries[j];
+            memset(&entry, 0, sizeof(MANIFESTENTRY));
+
+            entry.dwFormat = sources[j].format;
+            entry.dwOffset = offset;
+            entry.dwLength = uint32_t(payloads[j].size());
+            entry.pathHash = sources[j].path;
+            entry.sourceSize = sources[j].audio.size() + 44;
+            entry.SourceWriteTime = sources[j].writeTime;
+
+            offset += uint32_t(AlignedLength(payloads[j].size(), alignment));
+        }
+
+        return entries;
+    }
+
+    // Every build rewrites the header and entry metadata ahead of the wave data segment.
+    void WriteMetadata(std::vector<uint8_t>& file, const std::vector<MANIFESTENTRY>& entries, uint32_t dataOffset)
+    {
+        uint8_t value = static_cast<uint8_t>(0x80 | entries.size());
+        for (uint32_t j = 0; j < dataOffset; ++j)
+        {
+            file[j] = value++;
+        }
+    }
+
+    // A build without -inc: the metadata, then every payload at its aligned offset, with zeros between them.
+    std::vector<uint8_t> CleanBank(const std::vector<Source>& sources, const Options& options)
+    {
+        std::vector<std::vector<uint8_t>> payloads;
+        auto entries = LayOut(sources, options.alignment, payloads);
+        uint32_t dataOffset = DataOffset(sources.size(), options);
+
+        std::vector<uint8_t> file(size_t(dataOffset + WaveDataLength(entries, options.alignment)), 0);
+        WriteMetadata(file, entries, dataOffset);
+
+        for (size_t j = 0; j < sources.size(); ++j)
+        {
+            std::copy(payloads[j].begin(), payloads[j].end(), file.begin() + dataOffset + entries[j].dwOffset);
+        }
+
+        return file;
+    }
+
+    // An -inc build over the previous bank, if any, making the decisions xwbtool makes.
+    Bank Build(const std::vector<Source>& sources, const Options& options, const Bank* previous, BuildStats& stats)
+    {
+        std::vector<std::vector<uint8_t>> payloads;
+
+        Bank bank = {};
+        bank.entries = LayOut(sources, options.alignment, payloads);
+        bank.header.dwAlignment = options.alignment;
+        bank.header.dwDataOffset = DataOffset(sources.size(), options);
+
+        std::vector<MANIFESTENTRY> oldEntries;
+        MANIFESTHEADER oldHeader = {};
+        if (previous)
+        {
+            oldEntries = previous->entries;
+            oldHeader = previous->header;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+
+        auto rehash = CarryContentHashes(oldEntries, bank.entries);
+
+        auto hashStart = std::chrono::steady_clock::now();
+        for (auto j : rehash)
+        {
+            bank.entries[j].contentHash = HashBytes(sources[j].audio.data(), sources[j].audio.size());
+        }
+        auto hashEnd = std::chrono::steady_clock::now();
+
+        std::vector<size_t> reuse;
+        stats.reused = MatchPayloads(oldHeader, oldEntries, bank.header, bank.entries, reuse, stats.inPlace);
+        stats.hashed = rehash.size();
+
+        auto writes = PlanWaveData(bank.entries, oldEntries, reuse, stats.inPlace, options.alignment);
+
+        stats.planMs = std::chrono::duration<double, std::milli>((hashStart - start) + (std::chrono::steady_clock::now() - hashEnd)).count();
+
+        uint64_t waveDataLength = WaveDataLength(bank.entries, options.alignment);
+        uint32_t dataOffset = bank.header.dwDataOffset;
+
+        // Patching in place starts from the previous bank, the other builds from a new file
+        if (stats.inPlace)
+        {
+            bank.file = previous->file;
+        }
+        else
+        {
+            bank.file.assign(size_t(dataOffset + waveDataLength), 0);
+        }
+
+        WriteMetadata(bank.file, bank.entries, dataOffset);
+
+        for (const auto& write : writes)
+        {
+            switch (write.source)
+            {
+                case WAVEDATA_NEW:
+                {
+                    const auto& payload = payloads[write.entry];
+                    std::copy(payload.begin(), payload.end(), bank.file.begin() + ptrdiff_t(dataOffset + write.offset));
+                    stats.bytesWritten += payload.size();
+                    break;
+                }
+
+                case WAVEDATA_COPY:
+                {
+                    auto from = previous->file.begin() + ptrdiff_t(oldHeader.dwDataOffset + write.oldOffset);
+                    std::copy(from, from + ptrdiff_t(write.length), bank.file.begin() + ptrdiff_t(dataOffset + write.offset));
+                    stats.bytesCopied += write.length;
+                    stats.copies++;
+                    break;
+                }
+
+                case WAVEDATA_KEEP:
+                    break;
+            }
+        }
+
+        // SetEndOfFile
+        bank.file.resize(size_t(dataOffset + waveDataLength), 0);
+
+        bank.header.dwBankSize = uint32_t(bank.file.size());
+        return bank;
+    }
+
+    Bank Build(const std::vector<Source>& sources, const Options& options, const Bank* previous)
+    {
+        BuildStats stats;
+        return Build(sources, options, previous, stats);
+    }
+
+    void CheckClean(const Bank& bank, const std::vector<Source>& sources, const Options& options, const char* test)
+    {
+        Check(bank.file == CleanBank(sources, options), "bank differs from a clean build", test);
+    }
+
+
+    class SourceFactory
+    {
+    public:
+        explicit SourceFactory(uint32_t seed) : mRng(seed), mNextPath(1), mTime(1000) {}
+
+        Source Make(size_t length, uint32_t format = 1)
+        {
+            Source source;
+            source.path = mNextPath++ * 0x9E3779B97F4A7C15ull;
+            source.writeTime = mTime++;
+            source.format = format;
+            Fill(source, length);
+            return source;
+        }
+
+        // Saves new audio to the same file.
+        void Edit(Source& source, size_t length)
+        {
+            source.writeTime = mTime++;
+            Fill(source, length);
+        }
+
+        // Copies another file over it, keeping its write time, as a copy that preserves timestamps does.
+        void Replace(Source& source, size_t length)
+        {
+            Fill(source, length);
+        }
+
+        // Saves the file again without changing it.
+        void Touch(Source& source)
+        {
+            source.writeTime = mTime++;
+        }
+
+        size_t Length(size_t low, size_t high)
+        {
+            return std::uniform_int_distribution<size_t>(low, high)(mRng);
+        }
+
+        std::mt19937& Rng() { return mRng; }
+
+    private:
+        void Fill(Source& source, size_t length)
+        {
+            source.audio.resize(length);
+            for (auto& value : source.audio)
+                value = static_cast<uint8_t>(mRng() | 1);
+        }
+
+        std::mt19937 mRng;
+        uint64_t mNextPath;
+        uint64_t mTime;
+    };
+
+
+    void TestScenarios(uint32_t alignment)
+    {
+        const char* test = (alignment == 4) ? "Scenarios 4" : "Scenarios 2048";
+
+        Options options = { alignment, false };
+        SourceFactory factory(alignment);
+
+        std::vector<Source> sources;
+        for (int j = 0; j < 12; j++)
+            sources.push_back(factory.Make(factory.Length(1, 9000)));
+
+        BuildStats stats;
+        Bank bank = Build(sources, options, nullptr, stats);
+        CheckClean(bank, sources, options, test);
+        Check(stats.reused == 0 && stats.hashed == sources.size(), "first build reused payloads", test);
+
+        // Nothing changed: nothing is hashed or written
+        stats = BuildStats();
+        bank = Build(sources, options, &bank, stats);
+        CheckClean(bank, sources, options, test);
+        Check(stats.inPlace && stats.reused == sources.size() && stats.hashed == 0 && stats.bytesWritten == 0 && stats.copies == 0,
+            "unchanged bank was modified", test);
+
+        // Saved again without changes: hashed, but not written
+        factory.Touch(sources[3]);
+        stats = BuildStats();
+        bank = Build(sources, options, &bank, stats);
+        CheckClean(bank, sources, options, test);
+        Check(stats.inPlace && stats.hashed == 1 && stats.bytesWritten == 0, "touched source rewritten", test);
+
+        // Replaced by a file of another size with the same write time: hashed again
+        factory.Replace(sources[8], sources[8].audio.size() + 1);
+        stats = BuildStats();
+        bank = Build(sources, options, &bank, stats);
+        CheckClean(bank, sources, options, test);
+        Check(stats.hashed == 1 && stats.reused == sources.size() - 1, "replaced source not hashed", test);
+
+        // New audio of the same length: patched in place
+        factory.Edit(sources[5], sources[5].audio.size());
+        stats = BuildStats();
+        bank = Build(sources, options, &bank, stats);
+        CheckClean(bank, sources, options, test);
+        Check(stats.inPlace && stats.reused == sources.size() - 1 && stats.bytesWritten == sources[5].audio.size(),
+            "same length edit not patched in place", test);
+
+        // New audio of another length: the payloads after it move, so they are copied in two runs
+        factory.Edit(sources[5], sources[5].audio.size() + 3 * alignment + 1);
+        stats = BuildStats();
+        bank = Build(sources, options, &bank, stats);
+        CheckClean(bank, sources, options, test);
+        Check(!stats.inPlace && stats.reused == sources.size() - 1 && stats.copies == 2, "length change not copied in two runs", test);
+
+        // A wave inserted in the middle, then one removed
+        sources.insert(sources.begin() + 7, factory.Make(5000));
+        stats = BuildStats();
+        bank = Build(sources, options, &bank, stats);
+        CheckClean(bank, sources, options, test);
+        Check(!stats.inPlace && stats.copies == 2 && stats.bytesWritten == 5000, "insertion", test);
+
+        sources.erase(sources.begin() + 2);
+        stats = BuildStats();
+        bank = Build(sources, options, &bank, stats);
+        CheckClean(bank, sources, options, test);
+        Check(!stats.inPlace && stats.copies == 2 && stats.bytesWritten == 0, "removal", test);
+
+        // Reversed, so every payload is copied on its own
+        std::reverse(sources.begin(), sources.end());
+        stats = BuildStats();
+        bank = Build(sources, options, &bank, stats);
+        CheckClean(bank, sources, options, test);
+        Check(stats.copies == sources.size() && stats.bytesWritten == 0, "reorder", test);
+
+        // Two files with the same audio
+        sources.push_back(sources[0]);
+        sources.back().path = 42;
+        stats = BuildStats();
+        bank = Build(sources, options, &bank, stats);
+        CheckClean(bank, sources, options, test);
+        Check(stats.reused == sources.size() && stats.bytesWritten == 0, "duplicate audio not reused", test);
+
+        // The same audio stored in another format, both in place and in a bank that moved
+        sources[4].format = 2;
+        stats = BuildStats();
+        bank = Build(sources, options, &bank, stats);
+        CheckClean(bank, sources, options, test);
+        Check(stats.inPlace && stats.reused == sources.size() - 1, "format change patched in place", test);
+
+        sources.insert(sources.begin(), factory.Make(100));
+        sources[7].format = 2;
+        stats = BuildStats();
+        bank = Build(sources, options, &bank, stats);
+        CheckClean(bank, sources, options, test);
+        Check(!stats.inPlace && stats.reused == sources.size() - 2, "format change copied", test);
+
+        sources[9].format = 3;
+        stats = BuildStats();
+        bank = Build(sources, options, &bank, stats);
+        CheckClean(bank, sources, options, test);
+        Check(!stats.inPlace && stats.reused == sources.size() - 1, "compressed format copied", test);
+
+        // Friendly names grow the metadata. With 4 byte alignment that moves the wave data segment, so it is
+        // copied in one run, except for the duplicate at the end, which is copied from the first wave with
+        // the same audio. With 2048 byte alignment the names fit in the padding, and nothing moves.
+        options.friendlyNames = true;
+        bool moved = DataOffset(sources.size(), options) != bank.header.dwDataOffset;
+        Check(moved == (alignment == 4), "friendly names", test);
+
+        stats = BuildStats();
+        bank = Build(sources, options, &bank, stats);
+        CheckClean(bank, sources, options, test);
+        Check(stats.reused == sources.size() && stats.inPlace == !moved && stats.copies == (moved ? 2u : 0u), "moved segment not copied", test);
+
+        // Another alignment moves every payload, so none are kept
+        options.alignment = (alignment == 4) ? 2048 : 4;
+        stats = BuildStats();
+        bank = Build(sources, options, &bank, stats);
+        CheckClean(bank, sources, options, test);
+        Check(!stats.inPlace && stats.reused == 0 && stats.copies == 0, "alignment change reused payloads", test);
+    }
+
+
+    // Chains random edits, checking every build against a clean one.
+    void TestRandomEdits(uint32_t alignment)
+    {
+        Options options = { alignment, false };
+        SourceFactory factory(alignment * 7);
+        auto& rng = factory.Rng();
+
+        std::vector<Source> sources;
+        for (int j = 0; j < 200; j++)
+            sources.push_back(factory.Make(factory.Length(1, 3000)));
+
+        Bank bank = Build(sources, options, nullptr);
+
+        bool same = true;
+        size_t inPlace = 0;
+
+        for (int build = 0; build < 300; build++)
+        {
+            int edits = std::uniform_int_distribution<int>(0, 4)(rng);
+            for (int e = 0; e < edits; e++)
+            {
+                size_t j = std::uniform_int_distribution<size_t>(0, sources.size() - 1)(rng);
+
+                switch (std::uniform_int_distribution<int>(0, 8)(rng))
+                {
+                    case 0: factory.Edit(sources[j], sources[j].audio.size()); break;
+                    case 1: factory.Edit(sources[j], factory.Length(1, 3000)); break;
+                    case 2: factory.Touch(sources[j]); break;
+                    case 3: sources[j].format = sources[j].format % 3 + 1; break;
+                    case 4: sources.insert(sources.begin() + ptrdiff_t(j), factory.Make(factory.Length(1, 3000))); break;
+                    case 5: if (sources.size() > 1) sources.erase(sources.begin() + ptrdiff_t(j)); break;
+                    case 6: std::swap(sources[j], sources[std::uniform_int_distribution<size_t>(0, sources.size() - 1)(rng)]); break;
+                    case 7: sources.push_back(sources[j]); sources.back().path = factory.Make(0).path; break;
+                    case 8: options.friendlyNames = !options.friendlyNames; break;
+                }
+            }
+
+            BuildStats stats;
+            bank = Build(sources, options, &bank, stats);
+
+            same &= bank.file == CleanBank(sources, options);
+            inPlace += stats.inPlace ? 1 : 0;
+        }
+
+        Check(same, "bank differs from a clean build", "Random edits");
+        Check(inPlace > 0, "never patched in place", "Random edits");
+    }
+
+
+    // A bank of 2,000 waves, with one of them edited.
+    void ReportBuild()
+    {
+        const Options options = { 2048, false };
+
+        SourceFactory factory(99);
+
+        std::vector<Source> sources;
+        for (int j = 0; j < 2000; j++)
+            sources.push_back(factory.Make(factory.Length(4000, 60000)));
+
+        Bank bank = Build(sources, options, nullptr);
+        double megabytes = double(bank.file.size()) / (1024 * 1024);
+
+        printf("%zu waves, %.1f MB bank, one wave edited:\n", sources.size(), megabytes);
+
+        const char* names[] = { "same length", "new length" };
+        for (int pass = 0; pass < 2; pass++)
+        {
+            auto& edited = sources[1000];
+            factory.Edit(edited, (pass == 0) ? edited.audio.size() : edited.audio.size() + 5000);
+
+            BuildStats stats;
+            bank = Build(sources, options, &bank, stats);
+
+            CheckClean(bank, sources, options, "Report");
+
+            printf("  %-11s %s: %zu hashed, %7.3f MB written, %6.1f MB copied in %zu copies, %.2f ms planning\n",
+                names[pass], stats.inPlace ? "in place  " : "copied    ", stats.hashed,
+                double(stats.bytesWritten) / (1024 * 1024), double(stats.bytesCopied) / (1024 * 1024), stats.copies, stats.planMs);
+        }
+
+        printf("  a clean build writes %.1f MB\n", megabytes);
+    }
+}
+
+
+int main()
+{
+    TestScenarios(4);
+    TestScenarios(2048);
+
+    TestRandomEdits(4);
+    TestRandomEdits(2048);
+
+    ReportBuild();
+
+    if (g_failures)
+    {
+        printf("%d checks failed\n", g_failures);
+        return 1;
+    }
+
+    printf("IncrementalBuild tests passed\n");
+    return 0;
+}
@@ -0,0 +1,424 @@
+//--------------------------------------------------------------------------------------
+// File: LayoutCacheTest.cpp
+//
+// Tests for the SpriteFont layout cache: hits and misses, least recently used order,
+// eviction at capacity, hash collisions, resizing, clearing, and that a cached layout
+// places its glyphs the same as laying the text out directly.
+//
+// Build and run from the DirectXTK folder with g++ (-I- keeps the library headers from using Src/pch.h).
+// The font defaults to the bundled assets/Arial.spritefont; another may be given as an argument:
+//   g++ -std=c++14 -O2 -I UnitTests/Linux -I- -I UnitTests/Linux -I Src UnitTests/LayoutCacheTest.cpp -o LayoutCacheTest
+//   ./LayoutCacheTest [font.spritefont]
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "pch.h"
+
+#include "GlyphIndex.h"
+#include "GlyphLayout.h"
+#include "LayoutCache.h"
+
+using namespace DirectX;
+
+namespace
+{
+    int g_failures = 0;
+
+    void Check(bool condition, const char* message, const char* test)
+    {
+        if (!condition)
+        {
+            if (g_failures < 20)
+                printf("FAILED (%s): %s\n", test, message);
+            g_failures++;
+        }
+    }
+
+    // Same layout as SpriteFont::Glyph, which is how glyphs are stored in .spritefont files.
+    struct Glyph
+    {
+        uint32_t Character;
+        struct
+        {
+            int32_t left;
+            int32_t top;
+            int32_t right;
+            int32_t bottom;
+        } Subrect;
+        float XOffset;
+        float YOffset;
+        float XAdvance;
+    };
+
+    static_assert(sizeof(Glyph) == 32, "Glyph does not match the .spritefont layout");
+
+    // Reads the glyphs of a MakeSpriteFont output binary, which start after the magic and a glyph count.
+    bool LoadGlyphs(const char* fileName, std::vector<Glyph>& glyphs)
+    {
+        FILE* file = fopen(fileName, "rb");
+        if (!file)
+            return false;
+
+        char magic[8];
+        uint32_t glyphCount = 0;
+
+        bool ok = fread(magic, sizeof(magic), 1, file) == 1
+            && memcmp(magic, "DXTKfont", sizeof(magic)) == 0
+            && fread(&glyphCount, sizeof(glyphCount), 1, file) == 1;
+
+        if (ok)
+        {
+            glyphs.resize(glyphCount);
+            ok = fread(glyphs.data(), sizeof(Glyph), glyphCount, file) == glyphCount;
+        }
+
+        fclose(file);
+        return ok;
+    }
+
+    // Stands in for SpriteFont::TextLayout: the glyphs as placed by LayOutGlyphs, and the text they came from.
+    struct PlacedGlyph
+    {
+        Glyph const* glyph;
+        float x;
+        float y;
+        float advance;
+
+        bool operator== (PlacedGlyph const& other) const
+        {
+            return glyph == other.glyph && x == other.x && y == other.y && advance == other.advance;
+        }
+    };
+
+    struct Layout
+    {
+        std::wstring text;
+        std::vector<PlacedGlyph> glyphs;
+    };
+
+    // A cache that counts how often it lays out text, with the text it was asked for recorded in each layout.
+    template<typename THash = LayoutTextHash>
+    class CountingCache
+    {
+    public:
+        CountingCache() : builds(0) {}
+
+        Layout const& Get(_In_z_ wchar_t const* text)
+        {
+            return cache.Get(text, [&](Layout& layout)
+            {
+                builds++;
+                layout.text = text;
+                layout.glyphs.clear();
+            });
+        }
+
+        // True iff getting the text lays it out again.
+        bool Misses(_In_z_ wchar_t const* text)
+        {
+            size_t before = builds;
+            bool correct = Get(text).text == text;
+            return correct && builds == before + 1;
+        }
+
+        // True iff getting the text returns the cached layout.
+        bool Hits(_In_z_ wchar_t const* text)
+        {
+            size_t before = builds;
+            bool correct = Get(text).text == text;
+            return correct && builds == before;
+        }
+
+        LayoutCache<Layout, THash> cache;
+        size_t builds;
+    };
+
+    // Makes every string of the same length collide.
+    struct LengthHash
+    {
+        size_t operator()(_In_z_ wchar_t const* text) const
+        {
+            return wcslen(text);
+        }
+    };
+
+
+    void TestHitsAndMisses()
+    {
+        const char* test = "HitsAndMisses";
+
+        CountingCache<> counting;
+        counting.cache.SetCapacity(4);
+
+        Check(counting.cache.GetCapacity() == 4 && counting.cache.Size() == 0, "empty cache", test);
+        Check(counting.Misses(L"Score"), "first lookup", test);
+        Check(counting.Hits(L"Score"), "second lookup", test);
+        Check(counting.Misses(L"score"), "strings differing in case", test);
+        Check(counting.Misses(L""), "empty string", test);
+        Check(counting.Hits(L""), "empty string again", test);
+
+        // A hit returns the same layout object, not a copy.
+        Layout const* first = &counting.Get(L"Score");
+        Check(first == &counting.Get(L"Score"), "same layout object", test);
+
+        // The cache compares the contents, not the pointer.
+        std::wstring copy(L"Score");
+        Check(counting.Hits(copy.c_str()), "equal string at another address", test);
+
+        Check(counting.cache.Size() == 3, "size", test);
+    }
+
+
+    void TestLruOrder()
+    {
+        const char* test = "LruOrder";
+
+        CountingCache<> counting;
+        counting.cache.SetCapacity(3);
+
+        counting.Get(L"a");
+        counting.Get(L"b");
+        counting.Get(L"c");
+
+        // Using "a" makes "b" the least recently used, so "d" evicts it.
+        counting.Get(L"a");
+        counting.Get(L"d");
+
+        Check(counting.cache.Size() == 3, "size at capacity", test);
+        Check(counting.Hits(L"a"), "recently used entry kept", test);
+        Check(counting.Hits(L"c"), "entry kept", test);
+        Check(counting.Hits(L"d"), "new entry kept", test);
+        Check(counting.Misses(L"b"), "least recently used entry evicted", test);
+
+        // Laying out "b" again evicted "a", the least recently used after the hits above.
+        Check(counting.Misses(L"a"), "order follows the hits", test);
+    }
+
+
+    void TestEviction()
+    {
+        const char* test = "Eviction";
+
+        for (size_t capacity : { 1u, 2u, 7u, 64u })
+        {
+            CountingCache<> counting;
+            counting.cache.SetCapacity(capacity);
+
+            std::mt19937 rng(static_cast<uint32_t>(capacity));
+            bool bounded = true;
+
+            for (int i = 0; i < 2000; i++)
+            {
+                std::wstring text = L"Frame " + std::to_wstring(rng() % (2 * capacity + 3));
+                counting.Get(text.c_str());
+                bounded &= counting.cache.Size() <= capacity;
+            }
+
+            Check(bounded, "size exceeded the capacity", test);
+            Check(counting.cache.Size() == capacity, "cache not full after many strings", test);
+
+            // Cycling through one string more than fits misses every time.
+            counting.cache.Clear();
+            bool missed = true;
+
+            for (int round = 0; round < 3; round++)
+            {
+                for (size_t i = 0; i <= capacity; i++)
+                {
+                    std::wstring text = L"Line " + std::to_wstring(i);
+                    missed &= counting.Misses(text.c_str());
+                }
+            }
+
+            Check(missed, "cycle over capacity hit the cache", test);
+        }
+    }
+
+
+    void TestCollisions()
+    {
+        const char* test = "Collisions";
+
+        CountingCache<LengthHash> counting;
+        counting.cache.SetCapacity(8);
+
+        Check(counting.Misses(L"ab"), "first string", test);
+        Check(counting.Misses(L"xyz"), "other hash", test);
+
+        // A colliding string replaces the older entry rather than returning its layout.
+        Check(counting.Misses(L"cd"), "colliding string", test);
+        Check(counting.cache.Size() == 2, "colliding entry replaced", test);
+        Check(counting.Hits(L"cd"), "colliding string cached", test);
+        Check(counting.Hits(L"xyz"), "other entry kept", test);
+        Check(counting.Misses(L"ab"), "replaced string laid out again", test);
+        Check(counting.Misses(L"cd"), "strings that collide alternate", test);
+
+        // The replaced entry leaves the eviction order consistent.
+        counting.cache.SetCapacity(1);
+        Check(counting.cache.Size() == 1 && counting.Hits(L"cd"), "trim after a collision", test);
+        Check(counting.Misses(L"xyz") && counting.cache.Size() == 1, "evict after a collision", test);
+    }
+
+
+    void TestResize()
+    {
+        const char* test = "Resize";
+
+        CountingCache<> counting;
+        counting.cache.SetCapacity(4);
+
+        counting.Get(L"1");
+        counting.Get(L"2");
+        counting.Get(L"3");
+        counting.Get(L"4");
+
+        // Shrinking keeps the most recently used entries.
+        counting.cache.SetCapacity(2);
+        Check(counting.cache.GetCapacity() == 2 && counting.cache.Size() == 2, "shrink", test);
+        Check(counting.Hits(L"4") && counting.Hits(L"3"), "shrink keeps the most recent", test);
+        Check(counting.Misses(L"2"), "shrink evicts the oldest", test);
+
+        // A capacity of 1 keeps only the last string.
+        counting.cache.SetCapacity(1);
+        Check(counting.cache.Size() == 1 && counting.Hits(L"2"), "resize to 1", test);
+        Check(counting.Misses(L"5") && counting.cache.Size() == 1, "capacity 1 replaces", test);
+        Check(counting.Hits(L"5"), "capacity 1 hits", test);
+        Check(counting.Misses(L"2"), "capacity 1 evicts", test);
+
+        // A capacity of 0 disables the cache and empties it.
+        counting.cache.SetCapacity(0);
+        Check(counting.cache.GetCapacity() == 0 && counting.cache.Size() == 0, "resize to 0", test);
+
+        // Growing again starts from an empty cache.
+        counting.cache.SetCapacity(3);
+        Check(counting.cache.Size() == 0 && counting.Misses(L"2"), "grow after 0", test);
+
+        // Growing keeps the entries.
+        counting.cache.SetCapacity(10);
+        Check(counting.Hits(L"2"), "grow keeps entries", test);
+
+        // Clearing, as when the default character, kerning or line spacing changes, keeps the capacity.
+        counting.cache.Clear();
+        Check(counting.cache.Size() == 0 && counting.cache.GetCapacity() == 10, "clear", test);
+        Check(counting.Misses(L"2"), "lookup after clear", test);
+    }
+
+
+    // Lays out text directly, the way SpriteFont draws it without the cache.
+    template<typename TFindGlyph>
+    std::vector<PlacedGlyph> LayOut(_In_z_ wchar_t const* text, TFindGlyph findGlyph, KerningTable const& kerning, float lineSpacing)
+    {
+        std::vector<PlacedGlyph> placed;
+
+        LayOutGlyphs(Utf16Reader(text), findGlyph, kerning, lineSpacing, [&](Glyph const* glyph, float x, float y, float advance)
+        {
+            PlacedGlyph p = { glyph, x, y, advance };
+            placed.push_back(p);
+        });
+
+        return placed;
+    }
+
+
+    void TestGlyphPositions(std::vector<Glyph> const& font)
+    {
+        const char* test = "GlyphPositions";
+
+        GlyphIndex<Glyph> index;
+        index.Build(font.data(), font.size());
+
+        Glyph const* defaultGlyph = index.Find('?');
+        auto findGlyph = [&](uint32_t c)
+        {
+            auto glyph = index.Find(c);
+            return glyph ? glyph : defaultGlyph;
+        };
+
+        KerningTable kerning;
+        kerning.Set('A', 'V', -2);
+        kerning.Set('V', 'A', -1.5f);
+        kerning.Set('T', 'o', -1);
+
+        const float lineSpacing = 20;
+
+        LayoutCache<Layout> cache;
+        cache.SetCapacity(4);
+
+        auto getCached = [&](_In_z_ wchar_t const* text) -> Layout const&
+        {
+            return cache.Get(text, [&](Layout& layout)
+            {
+                layout.text = text;
+                layout.glyphs = LayOut(text, findGlyph, kerning, lineSpacing);
+            });
+        };
+
+        const wchar_t* texts[] =
+        {
+            L"Score: 12450",
+            L"AVATAR Tokyo",
+            L"Line one\r\nLine two\n\tTabbed",
+            L"  leading and trailing spaces  ",
+            L"Unknown \x2603 character",
+            L"",
+        };
+
+        // Cycle through more strings than fit, so the layouts are built, hit and evicted.
+        for (int round = 0; round < 3; round++)
+        {
+            for (auto text : texts)
+            {
+                auto direct = LayOut(text, findGlyph, kerning, lineSpacing);
+                Layout const& cached = getCached(text);
+
+                Check(cached.text == text && cached.glyphs == direct, "cached layout differs from the direct layout", test);
+                Check(getCached(text).glyphs == direct, "cache hit differs from the direct layout", test);
+            }
+        }
+
+        Check(!getCached(L"AVATAR Tokyo").glyphs.empty(), "layout is empty", test);
+
+        // After the kerning changes, clearing the cache gives the new positions.
+        auto before = getCached(L"AVATAR Tokyo").glyphs;
+        kerning.Set('A', 'V', -4);
+        cache.Clear();
+
+        auto after = getCached(L"AVATAR Tokyo").glyphs;
+        Check(after == LayOut(L"AVATAR Tokyo", findGlyph, kerning, lineSpacing), "layout after clear uses the new kerning", test);
+        Check(!(after == before), "kerning change did not move the glyphs", test);
+    }
+}
+
+
+int main(int argc, char* argv[])
+{
+    const char* fontName = (argc > 1) ? argv[1] : "../../assets/Arial.spritefont";
+
+    std::vector<Glyph> font;
+
+    if (!LoadGlyphs(fontName, font))
+    {
+        printf("FAILED: cannot read glyphs from %s\n", fontName);
+        return 1;
+    }
+
+    TestHitsAndMisses();
+    TestLruOrder();
+    TestEviction();
+    TestCollisions();
+    TestResize();
+    TestGlyphPositions(font);
+
+    if (g_failures)
+    {
+        printf("%d checks failed\n", g_failures);
+        return 1;
+    }
+
+    printf("LayoutCache tests passed\n");
+    return 0;
+}
@@ -0,0 +1,428 @@
+//--------------------------------------------------------------------------------------
+// File: DirectXMath.h
+//
+// Stand-in for the parts of DirectXMath used by the portable parts of the library. The
+// storage types match the real ones; the vector and matrix functions are written like the
+// _XM_NO_INTRINSICS_ path of DirectXMath, one component at a time.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+
+#define XM_CALLCONV
+
+namespace DirectX
+{
+    const float XM_PI = 3.141592654f;
+    const float XM_2PI = 6.283185307f;
+    const float XM_1DIV2PI = 0.159154943f;
+    const float XM_PIDIV2 = 1.570796327f;
+
+    struct XMFLOAT2
+    {
+        float x;
+        float y;
+
+        XMFLOAT2() = default;
+        constexpr XMFLOAT2(float _x, float _y) : x(_x), y(_y) {}
+    };
+
+    struct XMFLOAT3
+    {
+        float x;
+        float y;
+        float z;
+
+        XMFLOAT3() = default;
+        constexpr XMFLOAT3(float _x, float _y, float _z) : x(_x), y(_y), z(_z) {}
+    };
+
+    struct XMFLOAT4
+    {
+        float x;
+        float y;
+        float z;
+        float w;
+
+        XMFLOAT4() = default;
+        constexpr XMFLOAT4(float _x, float _y, float _z, float _w) : x(_x), y(_y), z(_z), w(_w) {}
+    };
+
+    struct alignas(16) XMFLOAT4A : public XMFLOAT4
+    {
+        XMFLOAT4A() = default;
+        constexpr XMFLOAT4A(float _x, float _y, float _z, float _w) : XMFLOAT4(_x, _y, _z, _w) {}
+    };
+
+
+    // Vectors, as laid out by the _XM_NO_INTRINSICS_ path.
+    struct __vector4
+    {
+        union
+        {
+            float vector4_f32[4];
+            uint32_t vector4_u32[4];
+        };
+    };
+
+    typedef __vector4 XMVECTOR;
+    typedef const XMVECTOR FXMVECTOR;
+    typedef const XMVECTOR GXMVECTOR;
+
+    struct alignas(16) XMVECTORF32
+    {
+        union
+        {
+            float f[4];
+            XMVECTOR v;
+        };
+
+        operator XMVECTOR() const { return v; }
+    };
+
+    const XMVECTORF32 g_XMZero = { { { 0.0f, 0.0f, 0.0f, 0.0f } } };
+    const XMVECTORF32 g_XMIdentityR0 = { { { 1.0f, 0.0f, 0.0f, 0.0f } } };
+    const XMVECTORF32 g_XMIdentityR1 = { { { 0.0f, 1.0f, 0.0f, 0.0f } } };
+    const XMVECTORF32 g_XMIdentityR2 = { { { 0.0f, 0.0f, 1.0f, 0.0f } } };
+    const XMVECTORF32 g_XMIdentityR3 = { { { 0.0f, 0.0f, 0.0f, 1.0f } } };
+    const XMVECTORF32 g_XMNegIdentityR1 = { { { 0.0f, -1.0f, 0.0f, 0.0f } } };
+    const XMVECTORF32 g_XMEpsilon = { { { 1.192092896e-7f, 1.192092896e-7f, 1.192092896e-7f, 1.192092896e-7f } } };
+    const XMVECTORF32 g_XMOneHalf = { { { 0.5f, 0.5f, 0.5f, 0.5f } } };
+    const XMVECTORF32 g_XMNegativeOneHalf = { { { -0.5f, -0.5f, -0.5f, -0.5f } } };
+    const XMVECTORF32 g_XMTwo = { { { 2.0f, 2.0f, 2.0f, 2.0f } } };
+    const XMVECTORF32 g_XMNegateX = { { { -1.0f, 1.0f, 1.0f, 1.0f } } };
+
+
+    // Matrices are four row vectors.
+    struct XMMATRIX
+    {
+        XMVECTOR r[4];
+    };
+
+
+    inline XMVECTOR XM_CALLCONV XMVectorSet(float x, float y, float z, float w)
+    {
+        XMVECTOR result = { { { x, y, z, w } } };
+        return result;
+    }
+
+    inline XMVECTOR XM_CALLCONV XMVectorZero()
+    {
+        return g_XMZero.v;
+    }
+
+    inline XMVECTOR XM_CALLCONV XMVectorReplicate(float Value)
+    {
+        return XMVectorSet(Value, Value, Value, Value);
+    }
+
+    inline XMVECTOR XM_CALLCONV XMVectorSplatEpsilon()
+    {
+        return g_XMEpsilon.v;
+    }
+
+    inline float XM_CALLCONV XMVectorGetX(FXMVECTOR V) { return V.vector4_f32[0]; }
+    inline float XM_CALLCONV XMVectorGetY(FXMVECTOR V) { return V.vector4_f32[1]; }
+
+    inline XMVECTOR XM_CALLCONV XMLoadFloat(const float* pSource)
+    {
+        return XMVectorSet(*pSource, 0.0f, 0.0f, 0.0f);
+    }
+
+    inline XMVECTOR XM_CALLCONV XMLoadFloat3(const XMFLOAT3* pSource)
+    {
+        return XMVectorSet(pSource->x, pSource->y, pSource->z, 0.0f);
+    }
+
+    inline XMVECTOR XM_CALLCONV XMLoadFloat4A(const XMFLOAT4A* pSource)
+    {
+        return XMVectorSet(pSource->x, pSource->y, pSource->z, pSource->w);
+    }
+
+    inline void XM_CALLCONV XMStoreFloat2(XMFLOAT2* pDestination, FXMVECTOR V)
+    {
+        pDestination->x = V.vector4_f32[0];
+        pDestination->y = V.vector4_f32[1];
+    }
+
+    inline void XM_CALLCONV XMStoreFloat3(XMFLOAT3* pDestination, FXMVECTOR V)
+    {
+        pDestination->x = V.vector4_f32[0];
+        pDestination->y = V.vector4_f32[1];
+        pDestination->z = V.vector4_f32[2];
+    }
+
+    inline void XM_CALLCONV XMStoreFloat4(XMFLOAT4* pDestination, FXMVECTOR V)
+    {
+        pDestination->x = V.vector4_f32[0];
+        pDestination->y = V.vector4_f32[1];
+        pDestination->z = V.vector4_f32[2];
+        pDestination->w = V.vector4_f32[3];
+    }
+
+    inline void XM_CALLCONV XMStoreFloat4A(XMFLOAT4A* pDestination, FXMVECTOR V)
+    {
+        XMStoreFloat4(pDestination, V);
+    }
+
+    template<uint32_t SwizzleX, uint32_t SwizzleY, uint32_t SwizzleZ, uint32_t SwizzleW>
+    inline XMVECTOR XM_CALLCONV XMVectorSwizzle(FXMVECTOR V)
+    {
+        return XMVectorSet(V.vector4_f32[SwizzleX], V.vector4_f32[SwizzleY], V.vector4_f32[SwizzleZ], V.vector4_f32[SwizzleW]);
+    }
+
+    template<uint32_t PermuteX, uint32_t PermuteY, uint32_t PermuteZ, uint32_t PermuteW>
+    inline XMVECTOR XM_CALLCONV XMVectorPermute(FXMVECTOR V1, FXMVECTOR V2)
+    {
+        const XMVECTOR* source[2] = { &V1, &V2 };
+        const uint32_t index[4] = { PermuteX, PermuteY, PermuteZ, PermuteW };
+
+        XMVECTOR result;
+        for (int i = 0; i < 4; i++)
+            result.vector4_u32[i] = source[index[i] >> 2]->vector4_u32[index[i] & 3];
+        return result;
+    }
+
+    inline XMVECTOR XM_CALLCONV XMVectorSplatX(FXMVECTOR V) { return XMVectorSwizzle<0, 0, 0, 0>(V); }
+    inline XMVECTOR XM_CALLCONV XMVectorSplatY(FXMVECTOR V) { return XMVectorSwizzle<1, 1, 1, 1>(V); }
+
+    inline XMVECTOR XM_CALLCONV XMVectorMergeXY(FXMVECTOR V1, FXMVECTOR V2)
+    {
+        return XMVectorSet(V1.vector4_f32[0], V2.vector4_f32[0], V1.vector4_f32[1], V2.vector4_f32[1]);
+    }
+
+    inline XMVECTOR XM_CALLCONV XMVectorEqual(FXMVECTOR V1, FXMVECTOR V2)
+    {
+        XMVECTOR control;
+        for (int i = 0; i < 4; i++)
+            control.vector4_u32[i] = (V1.vector4_f32[i] == V2.vector4_f32[i]) ? 0xFFFFFFFF : 0;
+        return control;
+    }
+
+    inline XMVECTOR XM_CALLCONV XMVectorLess(FXMVECTOR V1, FXMVECTOR V2)
+    {
+        XMVECTOR control;
+        for (int i = 0; i < 4; i++)
+            control.vector4_u32[i] = (V1.vector4_f32[i] < V2.vector4_f32[i]) ? 0xFFFFFFFF : 0;
+        return control;
+    }
+
+    inline XMVECTOR XM_CALLCONV XMVectorSelect(FXMVECTOR V1, FXMVECTOR V2, FXMVECTOR Control)
+    {
+        XMVECTOR result;
+        for (int i = 0; i < 4; i++)
+            result.vector4_u32[i] = (V1.vector4_u32[i] & ~Control.vector4_u32[i]) | (V2.vector4_u32[i] & Control.vector4_u32[i]);
+        return result;
+    }
+
+    inline XMVECTOR XM_CALLCONV XMVectorNegate(FXMVECTOR V)
+    {
+        return XMVectorSet(-V.vector4_f32[0], -V.vector4_f32[1], -V.vector4_f32[2], -V.vector4_f32[3]);
+    }
+
+    // The arithmetic is written out per component rather than as loops, so that g++ inlines it the way
+    // compilers inline the single SSE instructions of the real functions, and timings do not depend on it.
+    inline XMVECTOR XM_CALLCONV XMVectorAdd(FXMVECTOR V1, FXMVECTOR V2)
+    {
+        return XMVectorSet(
+            V1.vector4_f32[0] + V2.vector4_f32[0],
+            V1.vector4_f32[1] + V2.vector4_f32[1],
+            V1.vector4_f32[2] + V2.vector4_f32[2],
+            V1.vector4_f32[3] + V2.vector4_f32[3]);
+    }
+
+    inline XMVECTOR XM_CALLCONV XMVectorSubtract(FXMVECTOR V1, FXMVECTOR V2)
+    {
+        return XMVectorSet(
+            V1.vector4_f32[0] - V2.vector4_f32[0],
+            V1.vector4_f32[1] - V2.vector4_f32[1],
+            V1.vector4_f32[2] - V2.vector4_f32[2],
+            V1.vector4_f32[3] - V2.vector4_f32[3]);
+    }
+
+    inline XMVECTOR XM_CALLCONV XMVectorMultiply(FXMVECTOR V1, FXMVECTOR V2)
+    {
+        return XMVectorSet(
+            V1.vector4_f32[0] * V2.vector4_f32[0],
+            V1.vector4_f32[1] * V2.vector4_f32[1],
+            V1.vector4_f32[2] * V2.vector4_f32[2],
+            V1.vector4_f32[3] * V2.vector4_f32[3]);
+    }
+
+    inline XMVECTOR XM_CALLCONV XMVectorDivide(FXMVECTOR V1, FXMVECTOR V2)
+    {
+        return XMVectorSet(
+            V1.vector4_f32[0] / V2.vector4_f32[0],
+            V1.vector4_f32[1] / V2.vector4_f32[1],
+            V1.vector4_f32[2] / V2.vector4_f32[2],
+            V1.vector4_f32[3] / V2.vector4_f32[3]);
+    }
+
+    inline XMVECTOR XM_CALLCONV XMVectorScale(FXMVECTOR V, float ScaleFactor)
+    {
+        return XMVectorSet(V.vector4_f32[0] * ScaleFactor, V.vector4_f32[1] * ScaleFactor, V.vector4_f32[2] * ScaleFactor, V.vector4_f32[3] * ScaleFactor);
+    }
+
+    inline XMVECTOR XM_CALLCONV XMVectorReciprocal(FXMVECTOR V)
+    {
+        XMVECTOR result;
+        for (int i = 0; i < 4; i++)
+            result.vector4_f32[i] = 1.0f / V.vector4_f32[i];
+        return result;
+    }
+
+    // Multiplies and adds separately, as the SSE path does, so no fused multiply-add is used.
+    inline XMVECTOR XM_CALLCONV XMVectorMultiplyAdd(FXMVECTOR V1, FXMVECTOR V2, FXMVECTOR V3)
+    {
+        return XMVectorSet(
+            V1.vector4_f32[0] * V2.vector4_f32[0] + V3.vector4_f32[0],
+            V1.vector4_f32[1] * V2.vector4_f32[1] + V3.vector4_f32[1],
+            V1.vector4_f32[2] * V2.vector4_f32[2] + V3.vector4_f32[2],
+            V1.vector4_f32[3] * V2.vector4_f32[3] + V3.vector4_f32[3]);
+    }
+
+    inline bool XM_CALLCONV XMVector2NearEqual(FXMVECTOR V1, FXMVECTOR V2, FXMVECTOR Epsilon)
+    {
+        float dx = fabsf(V1.vector4_f32[0] - V2.vector4_f32[0]);
+        float dy = fabsf(V1.vector4_f32[1] - V2.vector4_f32[1]);
+        return (dx <= Epsilon.vector4_f32[0]) && (dy <= Epsilon.vector4_f32[1]);
+    }
+
+    inline bool XM_CALLCONV XMVector3NearEqual(FXMVECTOR V1, FXMVECTOR V2, FXMVECTOR Epsilon)
+    {
+        float dx = fabsf(V1.vector4_f32[0] - V2.vector4_f32[0]);
+        float dy = fabsf(V1.vector4_f32[1] - V2.vector4_f32[1]);
+        float dz = fabsf(V1.vector4_f32[2] - V2.vector4_f32[2]);
+        return (dx <= Epsilon.vector4_f32[0]) && (dy <= Epsilon.vector4_f32[1]) && (dz <= Epsilon.vector4_f32[2]);
+    }
+
+    inline XMVECTOR XM_CALLCONV XMVector3Cross(FXMVECTOR V1, FXMVECTOR V2)
+    {
+        return XMVectorSet(
+            (V1.vector4_f32[1] * V2.vector4_f32[2]) - (V1.vector4_f32[2] * V2.vector4_f32[1]),
+            (V1.vector4_f32[2] * V2.vector4_f32[0]) - (V1.vector4_f32[0] * V2.vector4_f32[2]),
+            (V1.vector4_f32[0] * V2.vector4_f32[1]) - (V1.vector4_f32[1] * V2.vector4_f32[0]),
+            0.0f);
+    }
+
+    inline XMVECTOR XM_CALLCONV XMVector3Normalize(FXMVECTOR V)
+    {
+        float fLength = sqrtf(V.vector4_f32[0] * V.vector4_f32[0] + V.vector4_f32[1] * V.vector4_f32[1] + V.vector4_f32[2] * V.vector4_f32[2]);
+
+        // Prevent divide by zero
+        if (fLength > 0)
+        {
+            fLength = 1.0f / fLength;
+        }
+
+        return XMVectorScale(V, fLength);
+    }
+
+    inline XMVECTOR XM_CALLCONV XMVector3Transform(FXMVECTOR V, XMMATRIX const& M)
+    {
+        XMVECTOR Result = XMVectorMultiplyAdd(XMVectorSwizzle<2, 2, 2, 2>(V), M.r[2], M.r[3]);
+        Result = XMVectorMultiplyAdd(XMVectorSwizzle<1, 1, 1, 1>(V), M.r[1], Result);
+        return XMVectorMultiplyAdd(XMVectorSwizzle<0, 0, 0, 0>(V), M.r[0], Result);
+    }
+
+    inline XMVECTOR XM_CALLCONV XMVector3TransformNormal(FXMVECTOR V, XMMATRIX const& M)
+    {
+        XMVECTOR Result = XMVectorMultiply(XMVectorSwizzle<2, 2, 2, 2>(V), M.r[2]);
+        Result = XMVectorMultiplyAdd(XMVectorSwizzle<1, 1, 1, 1>(V), M.r[1], Result);
+        return XMVectorMultiplyAdd(XMVectorSwizzle<0, 0, 0, 0>(V), M.r[0], Result);
+    }
+
+    inline XMMATRIX XM_CALLCONV XMMatrixMultiply(XMMATRIX const& M1, XMMATRIX const& M2)
+    {
+        XMMATRIX mResult;
+        for (int i = 0; i < 4; i++)
+        {
+            XMVECTOR row = XMVectorMultiply(XMVectorSwizzle<3, 3, 3, 3>(M1.r[i]), M2.r[3]);
+            row = XMVectorMultiplyAdd(XMVectorSwizzle<2, 2, 2, 2>(M1.r[i]), M2.r[2], row);
+            row = XMVectorMultiplyAdd(XMVectorSwizzle<1, 1, 1, 1>(M1.r[i]), M2.r[1], row);
+            mResult.r[i] = XMVectorMultiplyAdd(XMVectorSwizzle<0, 0, 0, 0>(M1.r[i]), M2.r[0], row);
+        }
+        return mResult;
+    }
+
+    inline XMMATRIX XM_CALLCONV XMMatrixTranslation(float OffsetX, float OffsetY, float OffsetZ)
+    {
+        XMMATRIX M;
+        M.r[0] = g_XMIdentityR0.v;
+        M.r[1] = g_XMIdentityR1.v;
+        M.r[2] = g_XMIdentityR2.v;
+        M.r[3] = XMVectorSet(OffsetX, OffsetY, OffsetZ, 1.0f);
+        return M;
+    }
+
+
+    // Operators, which Bezier.h names in its generic templates.
+    inline XMVECTOR XM_CALLCONV operator+ (FXMVECTOR V1, FXMVECTOR V2) { return XMVectorAdd(V1, V2); }
+    inline XMVECTOR XM_CALLCONV operator* (FXMVECTOR V1, FXMVECTOR V2) { return XMVectorMultiply(V1, V2); }
+    inline XMVECTOR XM_CALLCONV operator* (FXMVECTOR V, float S) { return XMVectorScale(V, S); }
+    inline XMMATRIX XM_CALLCONV operator* (XMMATRIX const& M1, XMMATRIX const& M2) { return XMMatrixMultiply(M1, M2); }
+
+
+    // Same range reduction and minimax polynomials as DirectXMath.
+    inline void XMScalarSinCos(float* pSin, float* pCos, float Value)
+    {
+        // Map Value to y in [-pi,pi], x = 2*pi*quotient + remainder.
+        float quotient = XM_1DIV2PI*Value;
+        if (Value >= 0.0f)
+        {
+            quotient = static_cast<float>(static_cast<int>(quotient + 0.5f));
+        }
+        else
+        {
+            quotient = static_cast<float>(static_cast<int>(quotient - 0.5f));
+        }
+        float y = Value - XM_2PI*quotient;
+
+        // Map y to [-pi/2,pi/2] with sin(y) = sin(Value).
+        float sign;
+        if (y > XM_PIDIV2)
+        {
+            y = XM_PI - y;
+            sign = -1.0f;
+        }
+        else if (y < -XM_PIDIV2)
+        {
+            y = -XM_PI - y;
+            sign = -1.0f;
+        }
+        else
+        {
+            sign = +1.0f;
+        }
+
+        float y2 = y * y;
+
+        // 11-degree minimax approximation
+        *pSin = (((((-2.3889859e-08f * y2 + 2.7525562e-06f) * y2 - 0.00019840874f) * y2 + 0.0083333310f) * y2 - 0.16666667f) * y2 + 1.0f) * y;
+
+        // 10-degree minimax approximation
+        float p = ((((-2.6051615e-07f * y2 + 2.4760495e-05f) * y2 - 0.0013888378f) * y2 + 0.041666638f) * y2 - 0.5f) * y2 + 1.0f;
+        *pCos = sign*p;
+    }
+
+    inline XMMATRIX XM_CALLCONV XMMatrixRotationY(float Angle)
+    {
+        float fSinAngle;
+        float fCosAngle;
+        XMScalarSinCos(&fSinAngle, &fCosAngle, Angle);
+
+        XMMATRIX M;
+        M.r[0] = XMVectorSet(fCosAngle, 0.0f, -fSinAngle, 0.0f);
+        M.r[1] = g_XMIdentityR1.v;
+        M.r[2] = XMVectorSet(fSinAngle, 0.0f, fCosAngle, 0.0f);
+        M.r[3] = g_XMIdentityR3.v;
+        return M;
+    }
+}
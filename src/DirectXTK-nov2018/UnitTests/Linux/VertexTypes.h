@@ -0,0 +1,58 @@
+//--------------------------------------------------------------------------------------
+// File: VertexTypes.h
+//
+// Stand-in for the vertex structures used by the portable parts of the library, with the
+// same layout as Inc/VertexTypes.h but without the Direct3D input layouts.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <DirectXMath.h>
+
+namespace DirectX
+{
+    // Vertex struct holding position, color, and texture mapping information.
+    struct VertexPositionColorTexture
+    {
+        VertexPositionColorTexture() = default;
+
+        VertexPositionColorTexture(XMFLOAT3 const& position, XMFLOAT4 const& color, XMFLOAT2 const& textureCoordinate)
+            : position(position),
+            color(color),
+            textureCoordinate(textureCoordinate)
+        { }
+
+        XMFLOAT3 position;
+        XMFLOAT4 color;
+        XMFLOAT2 textureCoordinate;
+    };
+
+
+    // Vertex struct holding position, normal vector, and texture mapping information.
+    struct VertexPositionNormalTexture
+    {
+        VertexPositionNormalTexture() = default;
+
+        VertexPositionNormalTexture(XMFLOAT3 const& position, XMFLOAT3 const& normal, XMFLOAT2 const& textureCoordinate)
+            : position(position),
+            normal(normal),
+            textureCoordinate(textureCoordinate)
+        { }
+
+        VertexPositionNormalTexture(FXMVECTOR position, FXMVECTOR normal, FXMVECTOR textureCoordinate)
+        {
+            XMStoreFloat3(&this->position, position);
+            XMStoreFloat3(&this->normal, normal);
+            XMStoreFloat2(&this->textureCoordinate, textureCoordinate);
+        }
+
+        XMFLOAT3 position;
+        XMFLOAT3 normal;
+        XMFLOAT2 textureCoordinate;
+    };
+}
@@ -0,0 +1,38 @@
+//--------------------------------------------------------------------------------------
+// File: intrin.h
+//
+// Stand-in for the Microsoft compiler intrinsics used by the portable parts of the
+// library: the SIMD intrinsics, plus __cpuid and __cpuidex with their Microsoft signatures.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <immintrin.h>
+#include <cpuid.h>
+
+// cpuid.h has a __cpuid macro with a different signature, and newer versions also declare
+// __cpuidex, so both names are mapped to the functions below.
+inline void CpuidEx(int info[4], int function, int subfunction)
+{
+    unsigned int a, b, c, d;
+    __cpuid_count(function, subfunction, a, b, c, d);
+
+    info[0] = static_cast<int>(a);
+    info[1] = static_cast<int>(b);
+    info[2] = static_cast<int>(c);
+    info[3] = static_cast<int>(d);
+}
+
+inline void Cpuid(int info[4], int function)
+{
+    CpuidEx(info, function, 0);
+}
+
+#undef __cpuid
+#define __cpuid Cpuid
+#define __cpuidex CpuidEx
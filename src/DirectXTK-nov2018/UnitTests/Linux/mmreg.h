@@ -0,0 +1,82 @@
+//--------------------------------------------------------------------------------------
+// File: mmreg.h
+//
+// Stand-in for the wave format structures used by the portable parts of the audio
+// library, laid out as in the Windows SDK.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "objbase.h"
+
+#define MAKEFOURCC(ch0, ch1, ch2, ch3) \
+    ((DWORD)(BYTE)(ch0) | ((DWORD)(BYTE)(ch1) << 8) | ((DWORD)(BYTE)(ch2) << 16) | ((DWORD)(BYTE)(ch3) << 24))
+
+#define WAVE_FORMAT_PCM             1
+#define WAVE_FORMAT_ADPCM           2
+#define WAVE_FORMAT_IEEE_FLOAT      3
+#define WAVE_FORMAT_WMAUDIO2        0x0161
+#define WAVE_FORMAT_WMAUDIO3        0x0162
+#define WAVE_FORMAT_EXTENSIBLE      0xFFFE
+
+#pragma pack(push, 1)
+
+typedef struct waveformat_tag
+{
+    WORD    wFormatTag;
+    WORD    nChannels;
+    DWORD   nSamplesPerSec;
+    DWORD   nAvgBytesPerSec;
+    WORD    nBlockAlign;
+} WAVEFORMAT;
+
+typedef struct pcmwaveformat_tag
+{
+    WAVEFORMAT  wf;
+    WORD        wBitsPerSample;
+} PCMWAVEFORMAT;
+
+typedef struct tWAVEFORMATEX
+{
+    WORD    wFormatTag;
+    WORD    nChannels;
+    DWORD   nSamplesPerSec;
+    DWORD   nAvgBytesPerSec;
+    WORD    nBlockAlign;
+    WORD    wBitsPerSample;
+    WORD    cbSize;
+} WAVEFORMATEX;
+
+typedef struct
+{
+    WAVEFORMATEX    Format;
+    union
+    {
+        WORD    wValidBitsPerSample;
+        WORD    wSamplesPerBlock;
+        WORD    wReserved;
+    } Samples;
+    DWORD           dwChannelMask;
+    GUID            SubFormat;
+} WAVEFORMATEXTENSIBLE;
+
+typedef struct adpcmcoef_tag
+{
+    int16_t iCoef1;
+    int16_t iCoef2;
+} ADPCMCOEFSET;
+
+typedef struct adpcmwaveformat_tag
+{
+    WAVEFORMATEX    wfx;
+    WORD            wSamplesPerBlock;
+    WORD            wNumCoef;
+    ADPCMCOEFSET    aCoef[7];
+} ADPCMWAVEFORMAT;
+
+#pragma pack(pop)
@@ -0,0 +1,53 @@
+//--------------------------------------------------------------------------------------
+// File: objbase.h
+//
+// Stand-in for the COM result codes the portable parts of the library return, and the
+// Windows types they use, so the tests can build them with g++ or clang.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+
+typedef int32_t HRESULT;
+typedef uint8_t BYTE;
+typedef uint16_t WORD;
+typedef uint32_t DWORD;
+
+typedef struct _FILETIME
+{
+    DWORD   dwLowDateTime;
+    DWORD   dwHighDateTime;
+} FILETIME;
+
+typedef struct _GUID
+{
+    uint32_t    Data1;
+    uint16_t    Data2;
+    uint16_t    Data3;
+    uint8_t     Data4[8];
+} GUID;
+
+#define S_OK                        ((HRESULT)0)
+#define S_FALSE                     ((HRESULT)1)
+#define E_POINTER                   ((HRESULT)0x80004003L)
+#define E_FAIL                      ((HRESULT)0x80004005L)
+#define E_INVALIDARG                ((HRESULT)0x80070057L)
+#define E_OUTOFMEMORY               ((HRESULT)0x8007000EL)
+
+#define ERROR_INVALID_DATA          13L
+#define ERROR_HANDLE_EOF            38L
+#define ERROR_NOT_SUPPORTED         50L
+#define ERROR_INSUFFICIENT_BUFFER   122L
+#define ERROR_FILE_TOO_LARGE        223L
+#define ERROR_NO_DATA               232L
+
+#define HRESULT_FROM_WIN32(x)       ((HRESULT)(x) <= 0 ? ((HRESULT)(x)) : ((HRESULT)(((x) & 0x0000FFFF) | 0x80070000)))
+
+#define SUCCEEDED(hr)               (((HRESULT)(hr)) >= 0)
+#define FAILED(hr)                  (((HRESULT)(hr)) < 0)
@@ -0,0 +1,106 @@
+//--------------------------------------------------------------------------------------
+// File: pch.h
+//
+// Stand-in for the precompiled header of the library, so the parts of it that do not
+// depend on Direct3D or the Windows API can be built by the tests with g++ or clang.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <new>
+#include <numeric>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_XM_SSE_INTRINSICS_)
+#include <emmintrin.h>
+#endif
+
+// The library checks the Microsoft names of the target architectures.
+#if defined(__x86_64__)
+#define _M_X64 100
+#elif defined(__i386__)
+#define _M_IX86 600
+#endif
+
+// Source annotations are only checked by the Microsoft compiler
+#define _In_
+#define _In_z_
+#define _In_opt_
+#define _Out_
+#define _Out_opt_
+#define _Outptr_
+#define _Outptr_result_maybenull_
+#define _Inout_
+#define _In_reads_(x)
+#define _In_reads_bytes_(x)
+#define _Out_writes_(x)
+#define _Out_writes_bytes_(x)
+#define _Inout_updates_(x)
+#define _Inout_updates_bytes_(x)
+#define _Use_decl_annotations_
+
+#define _countof(a) (sizeof(a) / sizeof(a[0]))
+
+// Alignment as spelled by the Microsoft compiler. On a type, __declspec(align) has to follow the struct keyword.
+#define __declspec(x) __declspec_##x
+#define __declspec_align(n) __attribute__((aligned(n)))
+
+inline void* _aligned_malloc(size_t size, size_t alignment)
+{
+    void* ptr;
+    return (posix_memalign(&ptr, alignment, size) == 0) ? ptr : nullptr;
+}
+
+inline void _aligned_free(void* ptr)
+{
+    free(ptr);
+}
+
+inline uint32_t _byteswap_ulong(uint32_t value)
+{
+    return __builtin_bswap32(value);
+}
+
+// The Microsoft library has an std::exception constructor taking the message, which the library uses.
+// Every standard header the tests need is included above, so the macro cannot reach into them.
+namespace std
+{
+    class msvc_exception : public runtime_error
+    {
+    public:
+        explicit msvc_exception(const char* message) : runtime_error(message) {}
+    };
+}
+
+#define exception msvc_exception
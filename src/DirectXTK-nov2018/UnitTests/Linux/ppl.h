@@ -0,0 +1,45 @@
+//--------------------------------------------------------------------------------------
+// File: ppl.h
+//
+// Stand-in for the Parallel Patterns Library. parallel_for hands out the indices to a few
+// std::thread workers, and the calling thread takes part like it does with PPL.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace concurrency
+{
+    template<typename TIndex, typename TFunction>
+    void parallel_for(TIndex first, TIndex last, TFunction const& function)
+    {
+        std::atomic<TIndex> next(first);
+
+        auto worker = [&]()
+        {
+            for (TIndex index = next++; index < last; index = next++)
+                function(index);
+        };
+
+        // At least two threads, so the tests interleave the work even on a single core.
+        unsigned int threadCount = std::max(2u, std::thread::hardware_concurrency());
+
+        std::vector<std::thread> threads;
+        for (unsigned int i = 1; i < threadCount; i++)
+            threads.emplace_back(worker);
+
+        worker();
+
+        for (auto& thread : threads)
+            thread.join();
+    }
+}
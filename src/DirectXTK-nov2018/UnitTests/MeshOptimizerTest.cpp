@@ -0,0 +1,233 @@
+//--------------------------------------------------------------------------------------
+// File: MeshOptimizerTest.cpp
+//
+// Tests for the vertex cache and vertex fetch passes, reporting ACMR and ATVR from the
+// FIFO cache simulator before and after optimization.
+//
+// Build and run from the DirectXTK folder with g++ (-I- keeps the library sources from using Src/pch.h):
+//   g++ -std=c++14 -O2 -I UnitTests/Linux -I- -I Src UnitTests/MeshOptimizerTest.cpp Src/MeshOptimizer.cpp -o MeshOptimizerTest
+//   ./MeshOptimizerTest
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "pch.h"
+
+#include "MeshOptimizer.h"
+
+using namespace DirectX;
+
+namespace
+{
+    int g_failures = 0;
+
+    void Check(bool condition, const char* message, const char* mesh)
+    {
+        if (!condition)
+        {
+            if (g_failures < 20)
+                printf("FAILED (%s): %s\n", mesh, message);
+            g_failures++;
+        }
+    }
+
+    typedef std::array<uint32_t, 3> Triangle;
+
+    // The triangles of a list, each rotated to start with its smallest index, so the winding is kept.
+    template<typename TIndex>
+    std::multiset<Triangle> Triangles(std::vector<TIndex> const& indices, uint32_t const* remap = nullptr)
+    {
+        std::multiset<Triangle> triangles;
+
+        for (size_t j = 0; j < indices.size(); j += 3)
+        {
+            Triangle t = { uint32_t(indices[j]), uint32_t(indices[j + 1]), uint32_t(indices[j + 2]) };
+
+            if (remap)
+            {
+                for (auto& index : t)
+                    index = remap[index];
+            }
+
+            while (t[0] > t[1] || t[0] > t[2])
+                t = { t[1], t[2], t[0] };
+
+            triangles.insert(t);
+        }
+
+        return triangles;
+    }
+
+    // A regular grid, as produced by terrain and by the sphere and torus generators.
+    template<typename TIndex>
+    std::vector<TIndex> Grid(size_t width, size_t height)
+    {
+        std::vector<TIndex> indices;
+
+        for (size_t y = 0; y < height; ++y)
+        {
+            for (size_t x = 0; x < width; ++x)
+            {
+                auto a = TIndex(y * (width + 1) + x);
+                auto b = TIndex(a + 1);
+                auto c = TIndex(a + width + 1);
+                auto d = TIndex(c + 1);
+
+                indices.insert(indices.end(), { a, c, b, b, c, d });
+            }
+        }
+
+        return indices;
+    }
+
+    // Triangles in random order, as exported by some tools.
+    template<typename TIndex>
+    void ShuffleTriangles(std::vector<TIndex>& indices, std::mt19937& rng)
+    {
+        std::vector<size_t> order(indices.size() / 3);
+        std::iota(order.begin(), order.end(), size_t(0));
+        std::shuffle(order.begin(), order.end(), rng);
+
+        std::vector<TIndex> shuffled;
+        shuffled.reserve(indices.size());
+
+        for (auto t : order)
+            shuffled.insert(shuffled.end(), indices.begin() + ptrdiff_t(t * 3), indices.begin() + ptrdiff_t(t * 3 + 3));
+
+        indices.swap(shuffled);
+    }
+
+    template<typename TIndex>
+    void TestMesh(const char* name, std::vector<TIndex> indices, size_t vertexCount, bool report)
+    {
+        auto triangles = Triangles(indices);
+        auto before = AnalyzeVertexCache(indices.data(), indices.size(), vertexCount);
+
+        OptimizeVertexCache(indices.data(), indices.size(), vertexCount);
+
+        Check(Triangles(indices) == triangles, "vertex cache pass changed the triangles", name);
+
+        auto after = AnalyzeVertexCache(indices.data(), indices.size(), vertexCount);
+
+        // Narrow grids in authored order are already close to ideal, so those only have to stay good
+        Check(after.acmr <= std::max(before.acmr, 0.75f), "ACMR got worse", name);
+        Check(after.atvr >= 1.0f, "a referenced vertex was never transformed", name);
+
+        // The fetch pass renumbers the vertices by first use
+        auto reordered = indices;
+        std::vector<uint32_t> remap(vertexCount);
+
+        size_t referenced = OptimizeVertexFetch(reordered.data(), reordered.size(), vertexCount, remap.data());
+
+        std::vector<bool> seen(vertexCount, false);
+        bool permutation = true;
+        for (auto index : remap)
+        {
+            permutation &= (index < vertexCount) && !seen[index];
+            if (index < vertexCount)
+                seen[index] = true;
+        }
+
+        Check(permutation, "vertex remap is not a permutation", name);
+        Check(Triangles(reordered) == Triangles(indices, remap.data()), "vertex fetch pass changed the triangles", name);
+
+        uint32_t next = 0;
+        bool firstUseOrder = true;
+        for (auto index : reordered)
+        {
+            firstUseOrder &= (index <= next);
+            if (index == next)
+                next++;
+        }
+
+        Check(firstUseOrder && next == referenced, "vertices are not ordered by first use", name);
+
+        auto fetched = AnalyzeVertexCache(reordered.data(), reordered.size(), vertexCount);
+        Check(fetched.transformCount == after.transformCount, "vertex fetch pass changed the cache behavior", name);
+
+        if (report)
+        {
+            printf("%-28s %7zu triangles  ACMR %.3f -> %.3f  ATVR %.3f -> %.3f\n",
+                name, indices.size() / 3, before.acmr, after.acmr, before.atvr, after.atvr);
+        }
+    }
+
+    // Only non-overlapping ranges that may be reordered are changed.
+    void TestIndexRanges(std::mt19937& rng)
+    {
+        auto indices = Grid<uint16_t>(30, 30);
+        ShuffleTriangles(indices, rng);
+
+        size_t half = indices.size() / 6 * 3;
+
+        auto first = std::vector<uint16_t>(indices.begin(), indices.begin() + ptrdiff_t(half));
+        auto second = std::vector<uint16_t>(indices.begin() + ptrdiff_t(half), indices.end());
+
+        IndexRange ranges[] =
+        {
+            { 0, half, true },
+            { half, indices.size() - half, false },
+        };
+
+        OptimizeIndexRanges(indices.data(), indices.size(), ranges, _countof(ranges));
+
+        Check(Triangles(std::vector<uint16_t>(indices.begin(), indices.begin() + ptrdiff_t(half))) == Triangles(first), "optimized range changed its triangles", "ranges");
+        Check(std::equal(second.begin(), second.end(), indices.begin() + ptrdiff_t(half)), "range that keeps its order was reordered", "ranges");
+
+        // Overlapping ranges are left alone
+        auto overlapped = indices;
+        IndexRange overlapping[] =
+        {
+            { 0, half + 3, true },
+            { half, indices.size() - half, true },
+        };
+
+        OptimizeIndexRanges(overlapped.data(), overlapped.size(), overlapping, _countof(overlapping));
+
+        Check(overlapped == indices, "overlapping ranges were reordered", "ranges");
+    }
+}
+
+
+int main()
+{
+    std::mt19937 rng(1);
+
+    // Grid in authored and in random triangle order
+    auto grid = Grid<uint16_t>(100, 100);
+    TestMesh("grid 100x100", grid, 101 * 101, true);
+
+    ShuffleTriangles(grid, rng);
+    TestMesh("shuffled grid 100x100", grid, 101 * 101, true);
+
+    auto large = Grid<uint32_t>(400, 400);
+    ShuffleTriangles(large, rng);
+    TestMesh("shuffled grid 400x400", large, 401 * 401, true);
+
+    // Random sizes, including degenerate strips one quad wide
+    for (int j = 0; j < 200; ++j)
+    {
+        size_t width = 1 + rng() % 40;
+        size_t height = 1 + rng() % 40;
+
+        auto indices = Grid<uint32_t>(width, height);
+        if (j % 2)
+            ShuffleTriangles(indices, rng);
+
+        TestMesh("random grid", indices, (width + 1) * (height + 1), false);
+    }
+
+    TestIndexRanges(rng);
+
+    if (g_failures)
+    {
+        printf("%d checks failed\n", g_failures);
+        return 1;
+    }
+
+    printf("MeshOptimizer tests passed\n");
+    return 0;
+}
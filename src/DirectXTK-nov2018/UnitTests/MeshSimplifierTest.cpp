@@ -0,0 +1,467 @@
+//--------------------------------------------------------------------------------------
+// File: MeshSimplifierTest.cpp
+//
+// Tests for the quadric error metric simplifier used for model levels of detail. Reports
+// the triangle reduction, the error estimate returned by SimplifyMesh and the deviation
+// of the original vertices from the simplified surface, measured by brute force.
+//
+// Build and run from the DirectXTK folder with g++ (-I- keeps the library sources from using Src/pch.h,
+// and UnitTests/Linux also stands in for DirectXMath.h):
+//   g++ -std=c++14 -O2 -I UnitTests/Linux -I- -I UnitTests/Linux -I Src UnitTests/MeshSimplifierTest.cpp Src/MeshSimplifier.cpp -o MeshSimplifierTest
+//   ./MeshSimplifierTest
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "pch.h"
+
+#include "MeshSimplifier.h"
+
+#include <limits>
+
+using namespace DirectX;
+
+namespace
+{
+    int g_failures = 0;
+
+    void Check(bool condition, const char* message, const char* mesh)
+    {
+        if (!condition)
+        {
+            if (g_failures < 20)
+                printf("FAILED (%s): %s\n", mesh, message);
+            g_failures++;
+        }
+    }
+
+    struct Mesh
+    {
+        std::vector<XMFLOAT3> positions;
+        std::vector<uint32_t> indices;
+    };
+
+    struct Vector
+    {
+        double x, y, z;
+
+        Vector(XMFLOAT3 const& p) : x(p.x), y(p.y), z(p.z) {}
+        Vector(double _x, double _y, double _z) : x(_x), y(_y), z(_z) {}
+
+        Vector operator- (Vector const& v) const { return { x - v.x, y - v.y, z - v.z }; }
+        Vector operator+ (Vector const& v) const { return { x + v.x, y + v.y, z + v.z }; }
+        Vector operator* (double s) const { return { x * s, y * s, z * s }; }
+    };
+
+    double Dot(Vector const& a, Vector const& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+    Vector Cross(Vector const& a, Vector const& b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+
+    // Distance from p to the closest point of triangle abc (Ericson, Real-Time Collision Detection, 5.1.5)
+    double PointTriangleDistance(Vector const& p, Vector const& a, Vector const& b, Vector const& c)
+    {
+        Vector ab = b - a;
+        Vector ac = c - a;
+        Vector ap = p - a;
+
+        double d1 = Dot(ab, ap);
+        double d2 = Dot(ac, ap);
+        auto distance = [&](Vector const& q) { Vector d = p - q; return std::sqrt(Dot(d, d)); };
+
+        if (d1 <= 0 && d2 <= 0)
+            return distance(a);
+
+        Vector bp = p - b;
+        double d3 = Dot(ab, bp);
+        double d4 = Dot(ac, bp);
+        if (d3 >= 0 && d4 <= d3)
+            return distance(b);
+
+        double vc = d1 * d4 - d3 * d2;
+        if (vc <= 0 && d1 >= 0 && d3 <= 0)
+            return distance(a + ab * (d1 / (d1 - d3)));
+
+        Vector cp = p - c;
+        double d5 = Dot(ab, cp);
+        double d6 = Dot(ac, cp);
+        if (d6 >= 0 && d5 <= d6)
+            return distance(c);
+
+        double vb = d5 * d2 - d1 * d6;
+        if (vb <= 0 && d2 >= 0 && d6 <= 0)
+            return distance(a + ac * (d2 / (d2 - d6)));
+
+        double va = d3 * d6 - d5 * d4;
+        if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0)
+            return distance(b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6))));
+
+        double denom = 1 / (va + vb + vc);
+        return distance(a + ab * (vb * denom) + ac * (vc * denom));
+    }
+
+    struct Deviation
+    {
+        double max;
+        double rms;
+    };
+
+    // How far the vertices of the original mesh lie from the simplified surface
+    Deviation MeasureDeviation(Mesh const& mesh, std::vector<uint32_t> const& simplified)
+    {
+        Deviation result = {};
+
+        std::vector<bool> used(mesh.positions.size(), false);
+        for (auto index : mesh.indices)
+            used[index] = true;
+
+        size_t count = 0;
+        for (size_t v = 0; v < mesh.positions.size(); ++v)
+        {
+            if (!used[v])
+                continue;
+
+            double nearest = std::numeric_limits<double>::max();
+            for (size_t j = 0; j < simplified.size(); j += 3)
+            {
+                nearest = std::min(nearest, PointTriangleDistance(mesh.positions[v],
+                    mesh.positions[simplified[j]], mesh.positions[simplified[j + 1]], mesh.positions[simplified[j + 2]]));
+            }
+
+            result.max = std::max(result.max, nearest);
+            result.rms += nearest * nearest;
+            ++count;
+        }
+
+        result.rms = count ? std::sqrt(result.rms / double(count)) : 0;
+        return result;
+    }
+
+    double SurfaceArea(Mesh const& mesh, std::vector<uint32_t> const& indices)
+    {
+        double area = 0;
+        for (size_t j = 0; j < indices.size(); j += 3)
+        {
+            Vector a = mesh.positions[indices[j]];
+            Vector n = Cross(Vector(mesh.positions[indices[j + 1]]) - a, Vector(mesh.positions[indices[j + 2]]) - a);
+            area += std::sqrt(Dot(n, n)) / 2;
+        }
+        return area;
+    }
+
+    // Subdivided icosahedron of unit radius
+    Mesh Icosphere(int subdivisions)
+    {
+        const float t = (1.0f + std::sqrt(5.0f)) / 2.0f;
+
+        Mesh mesh;
+        mesh.positions = {
+            { -1, t, 0 }, { 1, t, 0 }, { -1, -t, 0 }, { 1, -t, 0 },
+            { 0, -1, t }, { 0, 1, t }, { 0, -1, -t }, { 0, 1, -t },
+            { t, 0, -1 }, { t, 0, 1 }, { -t, 0, -1 }, { -t, 0, 1 },
+        };
+        mesh.indices = {
+            0, 11, 5, 0, 5, 1, 0, 1, 7, 0, 7, 10, 0, 10, 11,
+            1, 5, 9, 5, 11, 4, 11, 10, 2, 10, 7, 6, 7, 1, 8,
+            3, 9, 4, 3, 4, 2, 3, 2, 6, 3, 6, 8, 3, 8, 9,
+            4, 9, 5, 2, 4, 11, 6, 2, 10, 8, 6, 7, 9, 8, 1,
+        };
+
+        auto normalize = [](XMFLOAT3 p)
+        {
+            float length = std::sqrt(p.x * p.x + p.y * p.y + p.z * p.z);
+            return XMFLOAT3(p.x / length, p.y / length, p.z / length);
+        };
+
+        for (auto& p : mesh.positions)
+            p = normalize(p);
+
+        for (int s = 0; s < subdivisions; ++s)
+        {
+            std::map<std::pair<uint32_t, uint32_t>, uint32_t> midpoints;
+            auto midpoint = [&](uint32_t a, uint32_t b)
+            {
+                auto key = std::make_pair(std::min(a, b), std::max(a, b));
+                auto it = midpoints.find(key);
+                if (it != midpoints.end())
+                    return it->second;
+
+                auto const& pa = mesh.positions[a];
+                auto const& pb = mesh.positions[b];
+                mesh.positions.push_back(normalize(XMFLOAT3((pa.x + pb.x) / 2, (pa.y + pb.y) / 2, (pa.z + pb.z) / 2)));
+
+                auto index = uint32_t(mesh.positions.size() - 1);
+                midpoints[key] = index;
+                return index;
+            };
+
+            std::vector<uint32_t> indices;
+            for (size_t j = 0; j < mesh.indices.size(); j += 3)
+            {
+                uint32_t a = mesh.indices[j];
+                uint32_t b = mesh.indices[j + 1];
+                uint32_t c = mesh.indices[j + 2];
+                uint32_t ab = midpoint(a, b);
+                uint32_t bc = midpoint(b, c);
+                uint32_t ca = midpoint(c, a);
+
+                indices.insert(indices.end(), { a, ab, ca, b, bc, ab, c, ca, bc, ab, bc, ca });
+            }
+
+            mesh.indices.swap(indices);
+        }
+
+        return mesh;
+    }
+
+    // Open grid in the xy plane, with optional noise in z. With seam set, the middle column
+    // of vertices is duplicated, as a texture seam would be.
+    Mesh Grid(size_t size, float noise, bool seam, std::mt19937& rng)
+    {
+        Mesh mesh;
+
+        std::uniform_real_distribution<float> distribution(-noise, noise);
+
+        for (size_t y = 0; y <= size; ++y)
+        {
+            for (size_t x = 0; x <= size; ++x)
+                mesh.positions.push_back(XMFLOAT3(float(x), float(y), noise > 0 ? distribution(rng) : 0.0f));
+        }
+
+        size_t half = size / 2;
+        std::vector<uint32_t> seamCopy(size + 1);
+        for (size_t y = 0; y <= size && seam; ++y)
+        {
+            seamCopy[y] = uint32_t(mesh.positions.size());
+            mesh.positions.push_back(mesh.positions[y * (size + 1) + half]);
+        }
+
+        for (size_t y = 0; y < size; ++y)
+        {
+            for (size_t x = 0; x < size; ++x)
+            {
+                auto a = uint32_t(y * (size + 1) + x);
+                uint32_t b = a + 1;
+                auto c = uint32_t(a + size + 1);
+                uint32_t d = c + 1;
+
+                // Right of the seam, the quads use the copies of the seam vertices
+                if (seam && x == half)
+                {
+                    a = seamCopy[y];
+                    c = seamCopy[y + 1];
+                }
+
+                mesh.indices.insert(mesh.indices.end(), { a, c, b, b, c, d });
+            }
+        }
+
+        return mesh;
+    }
+
+    // Simplifies to the target, checks the result and reports the reduction and errors
+    std::vector<uint32_t> TestSimplify(const char* name, Mesh const& mesh, size_t targetTriangles, bool report, float* estimate = nullptr)
+    {
+        std::vector<uint32_t> simplified(mesh.indices.size());
+
+        float error = -1;
+        size_t count = SimplifyMesh(simplified.data(), mesh.indices.data(), mesh.indices.size(),
+            mesh.positions.data(), sizeof(XMFLOAT3), mesh.positions.size(), targetTriangles * 3, &error);
+
+        simplified.resize(count);
+
+        Check(count % 3 == 0, "index count is not a multiple of 3", name);
+        Check(count <= mesh.indices.size(), "more indices than the input", name);
+        Check(error >= 0, "no error estimate", name);
+
+        bool inRange = true;
+        bool degenerate = false;
+        for (size_t j = 0; j < count; j += 3)
+        {
+            for (size_t k = 0; k < 3; ++k)
+                inRange &= simplified[j + k] < mesh.positions.size();
+
+            degenerate |= simplified[j] == simplified[j + 1] || simplified[j + 1] == simplified[j + 2] || simplified[j + 2] == simplified[j];
+        }
+
+        Check(inRange, "index out of range", name);
+        Check(!degenerate, "degenerate triangle", name);
+
+        // Every vertex used by the result was used by the input
+        std::set<uint32_t> original(mesh.indices.begin(), mesh.indices.end());
+        Check(std::all_of(simplified.begin(), simplified.end(), [&](uint32_t index) { return original.count(index) != 0; }), "result uses a vertex the input did not", name);
+
+        auto deviation = MeasureDeviation(mesh, simplified);
+
+        // The estimate is a root mean square, so it can be below the largest deviation, but it must be of the same order
+        Check(deviation.rms <= 2 * double(error) + 1e-4, "measured deviation is far above the estimate", name);
+
+        if (report)
+        {
+            printf("%-26s %6zu -> %6zu triangles (%5.1f%%)  estimate %.5f  measured rms %.5f max %.5f\n",
+                name, mesh.indices.size() / 3, count / 3, 100.0 * double(count) / double(mesh.indices.size()),
+                error, deviation.rms, deviation.max);
+        }
+
+        if (estimate)
+            *estimate = error;
+
+        return simplified;
+    }
+
+    void TestSphere()
+    {
+        auto sphere = Icosphere(4);
+        size_t triangles = sphere.indices.size() / 3;
+
+        float previousError = 0;
+
+        for (size_t percent : { 50, 25, 10, 5 })
+        {
+            char name[64];
+            snprintf(name, sizeof(name), "icosphere at %zu%%", percent);
+
+            float error;
+            auto simplified = TestSimplify(name, sphere, triangles * percent / 100, true, &error);
+
+            Check(simplified.size() / 3 <= triangles * percent / 100 + 2, "target triangle count was not reached", name);
+            Check(error >= previousError, "error did not grow with the reduction", name);
+            previousError = error;
+
+            // A closed convex mesh must keep all its triangles facing the same way as the original ones
+            bool outward = true;
+            for (size_t j = 0; j < simplified.size(); j += 3)
+            {
+                Vector a = sphere.positions[simplified[j]];
+                Vector b = sphere.positions[simplified[j + 1]];
+                Vector c = sphere.positions[simplified[j + 2]];
+
+                outward &= Dot(Cross(b - a, c - a), a + b + c) > 0;
+            }
+
+            Check(outward, "triangle folded over", name);
+        }
+    }
+
+    void TestGrids(std::mt19937& rng)
+    {
+        // A flat grid simplifies without error and keeps its outline, so its area
+        auto flat = Grid(32, 0, false, rng);
+        auto simplified = TestSimplify("flat grid", flat, flat.indices.size() / 12, true);
+        Check(std::abs(SurfaceArea(flat, simplified) - 32.0 * 32.0) < 1e-3, "area of the flat grid changed", "flat grid");
+
+        auto noisy = Grid(32, 0.05f, false, rng);
+        (void)TestSimplify("noisy grid", noisy, noisy.indices.size() / 12, true);
+
+        // Vertices on a seam cannot move, so the two sides keep meeting
+        auto seam = Grid(32, 0, true, rng);
+        simplified = TestSimplify("grid with seam", seam, seam.indices.size() / 12, true);
+
+        std::set<uint32_t> used(simplified.begin(), simplified.end());
+        bool seamKept = true;
+        for (size_t y = 0; y <= 32; ++y)
+            seamKept &= used.count(uint32_t(y * 33 + 16)) && used.count(uint32_t(33 * 33 + y));
+        Check(seamKept, "a seam vertex was collapsed", "grid with seam");
+
+        // The 16-bit instantiation gives the same result
+        std::vector<uint16_t> indices16(noisy.indices.begin(), noisy.indices.end());
+        std::vector<uint16_t> simplified16(indices16.size());
+        std::vector<uint32_t> simplified32(noisy.indices.size());
+
+        size_t count16 = SimplifyMesh(simplified16.data(), indices16.data(), indices16.size(), noisy.positions.data(), sizeof(XMFLOAT3), noisy.positions.size(), indices16.size() / 4);
+        size_t count32 = SimplifyMesh(simplified32.data(), noisy.indices.data(), noisy.indices.size(), noisy.positions.data(), sizeof(XMFLOAT3), noisy.positions.size(), indices16.size() / 4);
+
+        Check(count16 == count32 && std::equal(simplified16.begin(), simplified16.begin() + ptrdiff_t(count16), simplified32.begin()), "16-bit and 32-bit results differ", "noisy grid");
+
+        // Random sizes and targets
+        for (int j = 0; j < 50; ++j)
+        {
+            auto grid = Grid(2 + rng() % 24, (j % 2) ? 0.1f : 0.0f, (j % 3) == 0, rng);
+            (void)TestSimplify("random grid", grid, grid.indices.size() / 3 / (2 + rng() % 6), false);
+        }
+    }
+
+    // Chain of levels, each simplified from the one before, as ModelMeshPart::CreateLevelsOfDetail builds it
+    void TestChain()
+    {
+        auto sphere = Icosphere(5);
+
+        Mesh level = sphere;
+        float accumulated = 0;
+
+        for (int j = 1; j <= 8; ++j)
+        {
+            std::vector<uint32_t> next(level.indices.size());
+
+            float error;
+            size_t count = SimplifyMesh(next.data(), level.indices.data(), level.indices.size(), level.positions.data(), sizeof(XMFLOAT3), level.positions.size(), level.indices.size() / 6 * 3, &error);
+
+            // The model stops the chain once a level no longer removes a tenth of the triangles
+            if (!count || float(count) > float(level.indices.size()) * 0.9f)
+                break;
+
+            next.resize(count);
+
+            accumulated += error;
+
+            auto deviation = MeasureDeviation(sphere, next);
+            printf("icosphere chain level %d    %6zu triangles  accumulated estimate %.5f  measured rms %.5f max %.5f\n",
+                j, count / 3, accumulated, deviation.rms, deviation.max);
+
+            Check(deviation.rms <= 2 * double(accumulated) + 1e-4, "measured deviation is far above the accumulated estimate", "chain");
+
+            level.indices.swap(next);
+        }
+    }
+
+    void TestInvalid()
+    {
+        std::vector<XMFLOAT3> positions(3, XMFLOAT3(0, 0, 0));
+        uint32_t indices[] = { 0, 1, 2, 0 };
+        uint32_t destination[4];
+
+        bool threw = false;
+        try
+        {
+            (void)SimplifyMesh(destination, indices, 4, positions.data(), sizeof(XMFLOAT3), positions.size(), 0);
+        }
+        catch (std::exception const&)
+        {
+            threw = true;
+        }
+        Check(threw, "accepted an index count that is not a multiple of 3", "invalid");
+
+        indices[2] = 3;
+        threw = false;
+        try
+        {
+            (void)SimplifyMesh(destination, indices, 3, positions.data(), sizeof(XMFLOAT3), positions.size(), 0);
+        }
+        catch (std::out_of_range const&)
+        {
+            threw = true;
+        }
+        Check(threw, "accepted an index out of range", "invalid");
+    }
+}
+
+
+int main()
+{
+    std::mt19937 rng(1);
+
+    TestSphere();
+    TestGrids(rng);
+    TestChain();
+    TestInvalid();
+
+    if (g_failures)
+    {
+        printf("%d checks failed\n", g_failures);
+        return 1;
+    }
+
+    printf("MeshSimplifier tests passed\n");
+    return 0;
+}
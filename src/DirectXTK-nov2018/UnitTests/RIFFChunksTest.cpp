@@ -0,0 +1,779 @@
+//--------------------------------------------------------------------------------------
+// File: RIFFChunksTest.cpp
+//
+// Tests for the single-pass RIFF chunk index behind the WAV loaders. Parsing a file held
+// in memory (LoadWAVAudioInMemoryEx) and reading only its chunk headers
+// (LoadWAVAudioHeaderFromFile) must give the same result, and the chunks indexed must be
+// those FindChunk finds by rescanning the chunk list. Files with corrupt chunk headers
+// are parsed from memory that ends at an unreadable page, so a read past the end of the
+// file faults. Also reports the time and I/O to scan a directory of files with each loader.
+//
+// Build and run from the DirectXTK folder with g++ (-I- keeps RIFFChunks.h from using Audio/pch.h):
+//   g++ -std=c++14 -O2 -I UnitTests/Linux -I- -I UnitTests/Linux -I Audio UnitTests/RIFFChunksTest.cpp -o RIFFChunksTest
+//   ./RIFFChunksTest
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+// http://go.microsoft.com/fwlink/?LinkID=615561
+//--------------------------------------------------------------------------------------
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "pch.h"
+
+#include "RIFFChunks.h"
+
+using namespace DirectX;
+using namespace DirectX::RIFFChunks;
+
+static_assert(sizeof(WAVEFORMAT) == 14, "WAVEFORMAT layout differs from the Windows SDK");
+static_assert(sizeof(WAVEFORMATEXTENSIBLE) == 40, "WAVEFORMATEXTENSIBLE layout differs from the Windows SDK");
+
+namespace
+{
+    int g_failures = 0;
+
+    void Check(bool condition, const char* message, const char* test)
+    {
+        if (!condition)
+        {
+            if (g_failures < 20)
+                printf("FAILED (%s): %s\n", test, message);
+            g_failures++;
+        }
+    }
+
+    // The smallest file the loaders accept
+    const size_t MIN_WAV_SIZE = sizeof(RIFFChunk) * 2 + sizeof(DWORD) + sizeof(WAVEFORMAT);
+
+
+    //----------------------------------------------------------------------------------
+    // Writing RIFF files
+
+    struct Chunk
+    {
+        uint32_t tag;
+        std::vector<uint8_t> payload;
+    };
+
+    template<typename T>
+    void Append(std::vector<uint8_t>& bytes, const T& value)
+    {
+        auto ptr = reinterpret_cast<const uint8_t*>(&value);
+        bytes.insert(bytes.end(), ptr, ptr + sizeof(T));
+    }
+
+    std::vector<uint8_t> WriteRiff(uint32_t form, const std::vector<Chunk>& chunks)
+    {
+        std::vector<uint8_t> file;
+        Append(file, FOURCC_RIFF_TAG);
+        Append(file, uint32_t(0));
+        Append(file, form);
+
+        for (const auto& chunk : chunks)
+        {
+            Append(file, chunk.tag);
+            Append(file, static_cast<uint32_t>(chunk.payload.size()));
+            file.insert(file.end(), chunk.payload.begin(), chunk.payload.end());
+        }
+
+        uint32_t riffSize = static_cast<uint32_t>(file.size() - sizeof(RIFFChunk));
+        memcpy(file.data() + sizeof(uint32_t), &riffSize, sizeof(riffSize));
+        return file;
+    }
+
+    Chunk PcmFormat(WORD channels, WORD bitsPerSample)
+    {
+        PCMWAVEFORMAT format = {};
+        format.wf.wFormatTag = WAVE_FORMAT_PCM;
+        format.wf.nChannels = channels;
+        format.wf.nSamplesPerSec = 44100;
+        format.wf.nBlockAlign = WORD(channels * bitsPerSample / 8);
+        format.wf.nAvgBytesPerSec = 44100 * format.wf.nBlockAlign;
+        format.wBitsPerSample = bitsPerSample;
+
+        Chunk chunk = { FOURCC_FORMAT_TAG, {} };
+        Append(chunk.payload, format);
+        return chunk;
+    }
+
+    // A WAVEFORMATEX with cbSize bytes of zeros following it
+    Chunk ExFormat(WORD formatTag, WORD cbSize)
+    {
+        WAVEFORMATEX format = {};
+        format.wFormatTag = formatTag;
+        format.nChannels = 2;
+        format.nSamplesPerSec = 44100;
+        format.cbSize = cbSize;
+
+        Chunk chunk = { FOURCC_FORMAT_TAG, {} };
+        Append(chunk.payload, format);
+        chunk.payload.resize(chunk.payload.size() + cbSize, 0);
+        return chunk;
+    }
+
+    Chunk ExtensibleFormat(uint32_t subFormat)
+    {
+        WAVEFORMATEXTENSIBLE format = {};
+        format.Format.wFormatTag = WAVE_FORMAT_EXTENSIBLE;
+        format.Format.nChannels = 2;
+        format.Format.nSamplesPerSec = 48000;
+        format.Format.wBitsPerSample = 32;
+        format.Format.cbSize = sizeof(WAVEFORMATEXTENSIBLE) - sizeof(WAVEFORMATEX);
+        format.Samples.wValidBitsPerSample = 32;
+        format.SubFormat = { subFormat, 0x0000, 0x0010, { 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71 } };
+
+        Chunk chunk = { FOURCC_FORMAT_TAG, {} };
+        Append(chunk.payload, format);
+        return chunk;
+    }
+
+    Chunk MidiLoopChunk(uint32_t loopCount, uint32_t start, uint32_t end)
+    {
+        RIFFMIDISample sample = {};
+        sample.loopCount = loopCount;
+
+        MIDILoop loop = {};
+        loop.type = MIDILoop::LOOP_TYPE_FORWARD;
+        loop.start = start;
+        loop.end = end;
+
+        Chunk chunk = { FOURCC_MIDI_SAMPLE, {} };
+        Append(chunk.payload, sample);
+        Append(chunk.payload, loop);
+        return chunk;
+    }
+
+    Chunk DlsLoopChunk(uint32_t start, uint32_t length)
+    {
+        RIFFDLSSample sample = {};
+        sample.size = sizeof(RIFFDLSSample);
+        sample.loopCount = 1;
+
+        DLSLoop loop = {};
+        loop.size = sizeof(DLSLoop);
+        loop.loopType = DLSLoop::LOOP_TYPE_FORWARD;
+        loop.loopStart = start;
+        loop.loopLength = length;
+
+        Chunk chunk = { FOURCC_DLS_SAMPLE, {} };
+        Append(chunk.payload, sample);
+        Append(chunk.payload, loop);
+        return chunk;
+    }
+
+    Chunk TableChunk(uint32_t tag, uint32_t count)
+    {
+        Chunk chunk = { tag, {} };
+        for (uint32_t j = 1; j <= count; ++j)
+            Append(chunk.payload, j * 4096);
+        return chunk;
+    }
+
+    Chunk DataChunk(size_t size, uint8_t seed)
+    {
+        Chunk chunk = { FOURCC_DATA_TAG, std::vector<uint8_t>(size) };
+        for (size_t j = 0; j < size; ++j)
+            chunk.payload[j] = static_cast<uint8_t>(seed + j * 7);
+        return chunk;
+    }
+
+    Chunk JunkChunk(size_t size)
+    {
+        return { MAKEFOURCC('J', 'U', 'N', 'K'), std::vector<uint8_t>(size, 0xCD) };
+    }
+
+
+    //----------------------------------------------------------------------------------
+    // The loaders, as the WAVFileReader entry points call them
+
+    struct Loaded
+    {
+        HRESULT hr;
+        WAVData result;
+        WAVChunkIndex index;
+        std::unique_ptr<uint8_t[]> wavData;     // Chunks read by the header-only loader
+        uint64_t bytesRead;
+        int reads;
+    };
+
+    // LoadWAVAudioInMemoryEx
+    void LoadInMemory(const uint8_t* file, size_t size, Loaded& loaded)
+    {
+        memset(&loaded.result, 0, sizeof(loaded.result));
+        memset(&loaded.index, 0, sizeof(loaded.index));
+
+        if (size < MIN_WAV_SIZE)
+        {
+            loaded.hr = E_FAIL;
+            return;
+        }
+
+        loaded.hr = IndexChunks(file, size, loaded.index);
+        if (SUCCEEDED(loaded.hr))
+            loaded.hr = WaveParseChunks(loaded.index, loaded.result);
+    }
+
+    // LoadWAVAudioHeaderFromFile, reading the file through readFile(offset, dest, size)
+    template<typename ReadFile>
+    void LoadHeader(ReadFile readFile, uint32_t size, Loaded& loaded)
+    {
+        memset(&loaded.result, 0, sizeof(loaded.result));
+        memset(&loaded.index, 0, sizeof(loaded.index));
+
+        if (size < MIN_WAV_SIZE)
+        {
+            loaded.hr = E_FAIL;
+            return;
+        }
+
+        loaded.hr = IndexChunksFromFile(readFile, size, loaded.wavData, loaded.index);
+        if (SUCCEEDED(loaded.hr))
+            loaded.hr = WaveParseChunks(loaded.index, loaded.result);
+    }
+
+    // Reads a file held in memory, counting the I/O. Reads outside the file are recorded as a failure.
+    void LoadHeader(const uint8_t* file, size_t size, Loaded& loaded, bool& outside)
+    {
+        loaded.bytesRead = 0;
+        loaded.reads = 0;
+
+        auto readFile = [&](uint32_t offset, void* dest, DWORD bytes) -> HRESULT
+        {
+            if (uint64_t(offset) + bytes > size)
+            {
+                outside = true;
+                return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+            }
+
+            memcpy(dest, file + offset, bytes);
+            loaded.bytesRead += bytes;
+            ++loaded.reads;
+            return S_OK;
+        };
+
+        LoadHeader(readFile, static_cast<uint32_t>(size), loaded);
+    }
+
+    bool Inside(const void* first, uint64_t bytes, const void* begin, uint64_t size)
+    {
+        auto p = static_cast<const uint8_t*>(first);
+        auto b = static_cast<const uint8_t*>(begin);
+        return p >= b && uint64_t(p - b) + bytes <= size;
+    }
+
+    // The chunks FindChunk finds by rescanning the chunk list for each tag, as the loaders did before the index.
+    bool MatchesRescan(const uint8_t* file, size_t size, const WAVChunkIndex& index)
+    {
+        auto riffChunk = FindChunk(file, size, FOURCC_RIFF_TAG);
+        if (!riffChunk || riffChunk->size < 4)
+            return true;
+
+        auto ptr = reinterpret_cast<const uint8_t*>(riffChunk) + sizeof(RIFFChunkHeader);
+        if (ptr + sizeof(RIFFChunk) > file + size)
+            return true;
+
+        uint64_t length = std::min<uint64_t>(riffChunk->size - sizeof(uint32_t), uint64_t(file + size - ptr));
+
+        const uint32_t tags[] = { FOURCC_FORMAT_TAG, FOURCC_DATA_TAG, FOURCC_DLS_SAMPLE, FOURCC_MIDI_SAMPLE, FOURCC_XWMA_DPDS, FOURCC_XMA_SEEK };
+        for (auto tag : tags)
+        {
+            auto chunk = FindChunk(ptr, size_t(length), tag);
+            auto span = const_cast<WAVChunkIndex&>(index).Find(tag);
+
+            if (span->present != (chunk != nullptr))
+                return false;
+
+            if (chunk && (span->offset != uint64_t(reinterpret_cast<const uint8_t*>(chunk) - file) + sizeof(RIFFChunk) || span->size != chunk->size))
+                return false;
+        }
+
+        return true;
+    }
+
+    // Both loaders give the same result, and the header-only loader finds the payload where the other does.
+    bool SameResult(const uint8_t* file, const Loaded& memory, const Loaded& header)
+    {
+        if (memory.hr != header.hr)
+            return false;
+
+        if (FAILED(memory.hr))
+            return true;
+
+        const auto& a = memory.result;
+        const auto& b = header.result;
+
+        return memory.index.format.size == header.index.format.size
+            && !memcmp(a.wfx, b.wfx, memory.index.format.size)
+            && a.audioBytes == b.audioBytes
+            && !b.startAudio && a.startAudio == file + header.index.data.offset
+            && a.loopStart == b.loopStart && a.loopLength == b.loopLength
+            && a.seekCount == b.seekCount
+            && (!a.seekCount || !memcmp(a.seek, b.seek, a.seekCount * sizeof(uint32_t)));
+    }
+
+    // Loads the file both ways and checks the results agree.
+    void LoadBoth(const std::vector<uint8_t>& file, Loaded& memory, Loaded& header, const char* test)
+    {
+        bool outside = false;
+        LoadInMemory(file.data(), file.size(), memory);
+        LoadHeader(file.data(), file.size(), header, outside);
+
+        Check(!outside, "header-only read outside the file", test);
+        Check(SameResult(file.data(), memory, header), "loaders disagree", test);
+        Check(FAILED(memory.hr) || MatchesRescan(file.data(), file.size(), memory.index), "index differs from FindChunk", test);
+    }
+
+
+    //----------------------------------------------------------------------------------
+    void TestFormats()
+    {
+        const char* test = "Formats";
+
+        Loaded memory, header;
+
+        {
+            // Format, sample data, and a loop from the 'smpl' chunk
+            auto data = DataChunk(1000, 1);
+            auto file = WriteRiff(FOURCC_WAVE_FILE_TAG, { PcmFormat(2, 16), data, MidiLoopChunk(1, 0, 99) });
+            LoadBoth(file, memory, header, test);
+
+            Check(memory.hr == S_OK, "PCM", test);
+            Check(memory.hr == S_OK && memory.result.wfx->wFormatTag == WAVE_FORMAT_PCM && memory.result.wfx->nChannels == 2, "PCM format", test);
+            Check(memory.result.audioBytes == 1000 && memory.result.startAudio && !memcmp(memory.result.startAudio, data.payload.data(), 1000), "PCM data", test);
+            Check(memory.result.loopStart == 0 && memory.result.loopLength == 100, "smpl loop", test);
+            Check(!memory.result.seek, "PCM seek table", test);
+        }
+
+        {
+            auto file = WriteRiff(FOURCC_WAVE_FILE_TAG, { PcmFormat(1, 8), DlsLoopChunk(10, 50), DataChunk(64, 2) });
+            LoadBoth(file, memory, header, test);
+
+            Check(memory.hr == S_OK && memory.result.loopStart == 10 && memory.result.loopLength == 50, "wsmp loop", test);
+        }
+
+        {
+            // xWMA: the seek table is in 'dpds', and there are no loop points
+            auto file = WriteRiff(FOURCC_XWMA_FILE_TAG, { ExFormat(WAVE_FORMAT_WMAUDIO2, 0), TableChunk(FOURCC_XWMA_DPDS, 12), DataChunk(4000, 3), MidiLoopChunk(1, 0, 9) });
+            LoadBoth(file, memory, header, test);
+
+            Check(memory.hr == S_OK && memory.result.seekCount == 12 && memory.result.seek[11] == 12 * 4096, "xWMA seek table", test);
+            Check(memory.result.loopLength == 0, "xWMA loop", test);
+        }
+
+        {
+            // XMA2: the seek table is in 'seek'
+            auto file = WriteRiff(FOURCC_WAVE_FILE_TAG, { ExFormat(0x166, 34), TableChunk(FOURCC_XMA_SEEK, 5), DataChunk(2048, 4) });
+            LoadBoth(file, memory, header, test);
+
+            Check(memory.hr == S_OK && memory.result.seekCount == 5, "XMA2 seek table", test);
+
+            file = WriteRiff(FOURCC_WAVE_FILE_TAG, { ExFormat(0x166, 33), TableChunk(FOURCC_XMA_SEEK, 5), DataChunk(2048, 4) });
+            LoadBoth(file, memory, header, test);
+
+            Check(memory.hr == E_FAIL, "XMA2 format too short", test);
+        }
+
+        {
+            auto file = WriteRiff(FOURCC_WAVE_FILE_TAG, { ExFormat(WAVE_FORMAT_ADPCM, 32), DataChunk(512, 5) });
+            LoadBoth(file, memory, header, test);
+
+            Check(memory.hr == S_OK && memory.result.wfx->wFormatTag == WAVE_FORMAT_ADPCM, "ADPCM", test);
+
+            file = WriteRiff(FOURCC_WAVE_FILE_TAG, { ExtensibleFormat(WAVE_FORMAT_IEEE_FLOAT), DataChunk(512, 6) });
+            LoadBoth(file, memory, header, test);
+
+            Check(memory.hr == S_OK && memory.result.wfx->wFormatTag == WAVE_FORMAT_EXTENSIBLE, "WAVEFORMATEXTENSIBLE", test);
+
+            file = WriteRiff(FOURCC_WAVE_FILE_TAG, { ExtensibleFormat(WAVE_FORMAT_ADPCM), DataChunk(512, 6) });
+            LoadBoth(file, memory, header, test);
+
+            Check(memory.hr == HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED), "MS-ADPCM as WAVEFORMATEXTENSIBLE", test);
+        }
+
+        {
+            // Chunks in any order, past the first block read, and only the first chunk of each kind is used
+            auto data = DataChunk(3000, 7);
+            auto file = WriteRiff(FOURCC_WAVE_FILE_TAG, { JunkChunk(6000), data, JunkChunk(10), PcmFormat(2, 16), PcmFormat(1, 8),
+                MidiLoopChunk(1, 0, 499), MidiLoopChunk(1, 0, 9), DataChunk(10, 8) });
+            LoadBoth(file, memory, header, test);
+
+            Check(memory.hr == S_OK && memory.result.wfx->nChannels == 2, "first format chunk", test);
+            Check(memory.result.audioBytes == 3000 && !memcmp(memory.result.startAudio, data.payload.data(), 3000), "first data chunk", test);
+            Check(memory.result.loopLength == 500, "first loop chunk", test);
+        }
+    }
+
+
+    // The header-only loader reads the chunk directory, not the sample data.
+    void TestHeaderOnlyIO()
+    {
+        const char* test = "Header-only I/O";
+
+        Loaded memory, header;
+
+        auto file = WriteRiff(FOURCC_WAVE_FILE_TAG, { PcmFormat(2, 16), DataChunk(8 * 1024 * 1024, 9), MidiLoopChunk(1, 0, 99) });
+        LoadBoth(file, memory, header, test);
+
+        // The first block, then the 'smpl' chunk header and payload after the sample data
+        Check(header.hr == S_OK && header.reads == 3 && header.bytesRead == 4096 + sizeof(RIFFChunk) + 60, "bytes read with the directory in the first block", test);
+
+        file = WriteRiff(FOURCC_WAVE_FILE_TAG, { JunkChunk(100000), DataChunk(8 * 1024 * 1024, 9), PcmFormat(2, 16) });
+        LoadBoth(file, memory, header, test);
+
+        Check(header.hr == S_OK && header.reads == 4 && header.bytesRead == 4096 + 2 * sizeof(RIFFChunk) + sizeof(PCMWAVEFORMAT), "bytes read with the directory past the first block", test);
+
+        // A file smaller than the first block is read once
+        file = WriteRiff(FOURCC_WAVE_FILE_TAG, { PcmFormat(2, 16), DataChunk(100, 9) });
+        LoadBoth(file, memory, header, test);
+
+        Check(header.hr == S_OK && header.reads == 1 && header.bytesRead == file.size(), "small file", test);
+    }
+
+
+    // Holds a file so that it ends at an unreadable page.
+    class GuardedBuffer
+    {
+    public:
+        explicit GuardedBuffer(size_t capacity)
+        {
+            mPage = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+            mCapacity = (capacity + mPage - 1) / mPage * mPage;
+
+            void* memory = mmap(nullptr, mCapacity + mPage, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (memory == MAP_FAILED || mprotect(static_cast<uint8_t*>(memory) + mCapacity, mPage, PROT_NONE) != 0)
+            {
+                printf("FAILED: cannot map the guarded buffer\n");
+                exit(1);
+            }
+
+            mMemory = static_cast<uint8_t*>(memory);
+        }
+
+        ~GuardedBuffer() { munmap(mMemory, mCapacity + mPage); }
+
+        const uint8_t* Place(const std::vector<uint8_t>& file)
+        {
+            uint8_t* base = mMemory + mCapacity - file.size();
+            memcpy(base, file.data(), file.size());
+            return base;
+        }
+
+    private:
+        size_t mPage;
+        size_t mCapacity;
+        uint8_t* mMemory;
+    };
+
+    // Loads a file from memory ending at an unreadable page, and through the header-only loader.
+    HRESULT LoadGuarded(GuardedBuffer& buffer, const std::vector<uint8_t>& file, const char* test)
+    {
+        const uint8_t* base = buffer.Place(file);
+
+        Loaded memory, header;
+        bool outside = false;
+        LoadInMemory(base, file.size(), memory);
+        LoadHeader(base, file.size(), header, outside);
+
+        Check(!outside, "header-only read outside the file", test);
+        Check(SameResult(base, memory, header), "loaders disagree", test);
+        return memory.hr;
+    }
+
+
+    void TestMalformed()
+    {
+        const char* test = "Malformed";
+
+        GuardedBuffer buffer(64 * 1024);
+
+        auto valid = WriteRiff(FOURCC_WAVE_FILE_TAG, { PcmFormat(2, 16), DataChunk(100, 1), MidiLoopChunk(1, 0, 9) });
+        const uint32_t smplOffset = sizeof(RIFFChunkHeader) + sizeof(RIFFChunk) + sizeof(PCMWAVEFORMAT) + sizeof(RIFFChunk) + 100;
+
+        {
+            // A RIFF chunk header in the last 9 bytes of the file, without room for its form type
+            std::vector<uint8_t> file;
+            Append(file, MAKEFOURCC('J', 'U', 'N', 'K'));
+            Append(file, uint32_t(30));
+            file.resize(file.size() + 30, 0);
+            Append(file, FOURCC_RIFF_TAG);
+            Append(file, uint32_t(100));
+            file.push_back('W');
+
+            Check(LoadGuarded(buffer, file, test) == HRESULT_FROM_WIN32(ERROR_HANDLE_EOF), "RIFF form type past the end", test);
+
+            // No room for a chunk after the RIFF header
+            file.pop_back();
+            Append(file, FOURCC_WAVE_FILE_TAG);
+            file.resize(file.size() + 7, 0);
+            Check(LoadGuarded(buffer, file, test) == HRESULT_FROM_WIN32(ERROR_HANDLE_EOF), "RIFF header at the end", test);
+        }
+
+        {
+            auto file = valid;
+            file.resize(smplOffset - 10);
+            Check(LoadGuarded(buffer, file, test) == HRESULT_FROM_WIN32(ERROR_HANDLE_EOF), "truncated data chunk", test);
+
+            file = valid;
+            file.resize(file.size() - 1);
+            Check(LoadGuarded(buffer, file, test) == HRESULT_FROM_WIN32(ERROR_HANDLE_EOF), "truncated smpl chunk", test);
+
+            // A truncated chunk the loaders do not use is not an error
+            file = WriteRiff(FOURCC_WAVE_FILE_TAG, { PcmFormat(2, 16), DataChunk(100, 1), TableChunk(FOURCC_XMA_SEEK, 4) });
+            file.resize(file.size() - 4);
+            Check(LoadGuarded(buffer, file, test) == S_OK, "truncated unused seek chunk", test);
+        }
+
+        {
+            // Loop tables larger than their chunk are ignored
+            auto file = valid;
+            uint32_t loopCount = 0x10000000;
+            memcpy(file.data() + smplOffset + sizeof(RIFFChunk) + offsetof(RIFFMIDISample, loopCount), &loopCount, sizeof(loopCount));
+            Check(LoadGuarded(buffer, file, test) == S_OK, "smpl loop count", test);
+
+            file = WriteRiff(FOURCC_WAVE_FILE_TAG, { PcmFormat(2, 16), DataChunk(100, 1), DlsLoopChunk(1, 2) });
+            uint32_t dlsSize = 0xFFFFFFF0;
+            memcpy(file.data() + smplOffset + sizeof(RIFFChunk), &dlsSize, sizeof(dlsSize));
+            Check(LoadGuarded(buffer, file, test) == S_OK, "wsmp header size", test);
+        }
+
+        {
+            auto file = WriteRiff(FOURCC_WAVE_FILE_TAG, { PcmFormat(2, 16), DataChunk(0, 1) });
+            Check(LoadGuarded(buffer, file, test) == HRESULT_FROM_WIN32(ERROR_INVALID_DATA), "empty data chunk", test);
+
+            file = WriteRiff(FOURCC_WAVE_FILE_TAG, { ExFormat(WAVE_FORMAT_ADPCM, 32), DataChunk(100, 1) });
+            file[sizeof(RIFFChunkHeader) + sizeof(RIFFChunk) + offsetof(WAVEFORMATEX, cbSize)] = 33;
+            Check(LoadGuarded(buffer, file, test) == E_FAIL, "cbSize past the format chunk", test);
+
+            file = WriteRiff(FOURCC_WAVE_FILE_TAG, { TableChunk(FOURCC_XMA_SEEK, 2), PcmFormat(2, 16), DataChunk(100, 1) });
+            uint32_t size = 0xFFFFFFF8;
+            memcpy(file.data() + sizeof(RIFFChunkHeader) + sizeof(uint32_t), &size, sizeof(size));
+            Check(LoadGuarded(buffer, file, test) == E_FAIL, "chunk size skipping the format", test);
+
+            file = WriteRiff(FOURCC_WAVE_FILE_TAG, { TableChunk(FOURCC_XMA_SEEK, 2), PcmFormat(2, 16), DataChunk(100, 1) });
+            memcpy(file.data() + sizeof(uint32_t), &size, sizeof(size));
+            Check(LoadGuarded(buffer, file, test) == S_OK, "RIFF size past the end", test);
+        }
+    }
+
+
+    // Reads every range a loaded file returns, checking each lies in the file or in the header-only chunks.
+    bool ReadResult(const Loaded& loaded, const void* begin, uint64_t size, uint32_t& checksum)
+    {
+        if (FAILED(loaded.hr))
+            return true;
+
+        const auto& result = loaded.result;
+
+        bool inside = Inside(result.wfx, loaded.index.format.size, begin, size)
+            && (!result.startAudio || Inside(result.startAudio, result.audioBytes, begin, size))
+            && (!result.seek || Inside(result.seek, uint64_t(result.seekCount) * sizeof(uint32_t), begin, size));
+
+        auto wfx = reinterpret_cast<const uint8_t*>(result.wfx);
+        for (uint32_t j = 0; j < loaded.index.format.size; ++j)
+            checksum += wfx[j];
+
+        if (result.startAudio && result.audioBytes)
+            checksum += result.startAudio[0] + result.startAudio[result.audioBytes - 1];
+
+        for (uint32_t j = 0; j < result.seekCount; ++j)
+            checksum += result.seek[j];
+
+        return inside;
+    }
+
+    // Corrupts the chunk headers of valid files at random.
+    void TestCorruptChunks()
+    {
+        const char* test = "Corrupt chunks";
+
+        const std::vector<uint8_t> files[] =
+        {
+            WriteRiff(FOURCC_WAVE_FILE_TAG, { PcmFormat(2, 16), DataChunk(200, 1), MidiLoopChunk(2, 0, 99), DlsLoopChunk(5, 10) }),
+            WriteRiff(FOURCC_XWMA_FILE_TAG, { ExFormat(WAVE_FORMAT_WMAUDIO3, 0), TableChunk(FOURCC_XWMA_DPDS, 8), DataChunk(300, 2) }),
+            WriteRiff(FOURCC_WAVE_FILE_TAG, { JunkChunk(20), ExFormat(0x166, 34), DataChunk(100, 3), TableChunk(FOURCC_XMA_SEEK, 6) }),
+            WriteRiff(FOURCC_WAVE_FILE_TAG, { ExtensibleFormat(WAVE_FORMAT_PCM), DataChunk(64, 4), ExFormat(WAVE_FORMAT_ADPCM, 32) }),
+            WriteRiff(FOURCC_WAVE_FILE_TAG, { JunkChunk(5000), PcmFormat(1, 8), DataChunk(100, 5), MidiLoopChunk(1, 0, 9) }),
+        };
+
+        std::mt19937 rng(24);
+        GuardedBuffer buffer(8192);
+
+        size_t accepted = 0;
+        bool inside = true;
+        bool outside = false;
+        bool same = true;
+        bool rescan = true;
+        uint32_t checksum = 0;
+
+        for (int iteration = 0; iteration < 40000; ++iteration)
+        {
+            auto file = files[iteration % _countof(files)];
+            auto size = static_cast<uint32_t>(file.size());
+
+            const uint32_t special[] = { 0, 1, 3, 4, 0x7FFFFFFF, 0x80000000, 0xFFFFFFF8, 0xFFFFFFFC, 0xFFFFFFFF, size, size - 8, size - 12 };
+
+            for (int mutations = std::uniform_int_distribution<int>(1, 4)(rng); mutations > 0 && file.size() >= 4; --mutations)
+            {
+                switch (rng() % 4)
+                {
+                    case 0:
+                        file[rng() % file.size()] = static_cast<uint8_t>(rng());
+                        break;
+
+                    case 1:
+                    {
+                        // Chunk sizes and format fields are 32-bit words at 4-byte offsets in these files
+                        uint32_t value = special[rng() % _countof(special)];
+                        memcpy(file.data() + (rng() % (file.size() / 4)) * 4, &value, sizeof(value));
+                        break;
+                    }
+
+                    case 2:
+                    {
+                        uint16_t value = (rng() % 2) ? 0xFFFF : static_cast<uint16_t>(rng() % 64);
+                        memcpy(file.data() + (rng() % (file.size() / 2)) * 2, &value, sizeof(value));
+                        break;
+                    }
+
+                    default:
+                        file.resize(std::uniform_int_distribution<size_t>(1, file.size())(rng));
+                        break;
+                }
+            }
+
+            const uint8_t* base = buffer.Place(file);
+
+            Loaded memory, header;
+            LoadInMemory(base, file.size(), memory);
+            LoadHeader(base, file.size(), header, outside);
+
+            same &= SameResult(base, memory, header);
+            rescan &= FAILED(memory.hr) || MatchesRescan(base, file.size(), memory.index);
+            inside &= ReadResult(memory, base, file.size(), checksum);
+            inside &= ReadResult(header, header.wavData.get(), header.index.end - header.wavData.get(), checksum);
+
+            if (SUCCEEDED(memory.hr))
+                ++accepted;
+        }
+
+        Check(inside, "result read outside the file", test);
+        Check(!outside, "header-only read outside the file", test);
+        Check(same, "loaders disagree", test);
+        Check(rescan, "index differs from FindChunk", test);
+        Check(accepted > 4000, "too few corrupt files accepted to exercise the parsers", test);
+
+        if (checksum == 1)
+            printf("\n");
+    }
+
+
+    //----------------------------------------------------------------------------------
+    // Scans a directory of 1,000 files of 256 KB each, loading each whole or reading its chunk headers alone.
+    void ReportScan()
+    {
+        char directory[] = "/tmp/RIFFChunksTestXXXXXX";
+        if (!mkdtemp(directory))
+        {
+            Check(false, "cannot create the scan directory", "Report");
+            return;
+        }
+
+        const int fileCount = 1000;
+
+        std::vector<std::string> paths;
+        for (int j = 0; j < fileCount; ++j)
+        {
+            auto file = WriteRiff(FOURCC_WAVE_FILE_TAG, { PcmFormat(2, 16), DataChunk(256 * 1024, uint8_t(j)), MidiLoopChunk(1, 0, 999) });
+
+            paths.push_back(std::string(directory) + "/" + std::to_string(j) + ".wav");
+            FILE* stream = fopen(paths.back().c_str(), "wb");
+            if (!stream || fwrite(file.data(), 1, file.size(), stream) != file.size())
+            {
+                Check(false, "cannot write the scan files", "Report");
+                return;
+            }
+            fclose(stream);
+        }
+
+        uint64_t durations[2] = {};
+        uint64_t bytesRead[2] = {};
+        int loaded[2] = {};
+
+        for (int header = 0; header < 2; ++header)
+        {
+            auto start = std::chrono::steady_clock::now();
+
+            for (const auto& path : paths)
+            {
+                int fd = open(path.c_str(), O_RDONLY);
+                if (fd < 0)
+                    continue;
+
+                uint32_t size = static_cast<uint32_t>(lseek(fd, 0, SEEK_END));
+
+                Loaded result;
+                if (header)
+                {
+                    auto readFile = [&](uint32_t offset, void* dest, DWORD bytes) -> HRESULT
+                    {
+                        bytesRead[1] += bytes;
+                        return (pread(fd, dest, bytes, offset) == ssize_t(bytes)) ? S_OK : HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+                    };
+
+                    LoadHeader(readFile, size, result);
+                }
+                else
+                {
+                    // LoadWAVAudioFromFileEx reads the whole file
+                    result.wavData.reset(new uint8_t[size]);
+                    if (pread(fd, result.wavData.get(), size, 0) == ssize_t(size))
+                        bytesRead[0] += size;
+
+                    LoadInMemory(result.wavData.get(), size, result);
+                }
+
+                if (result.hr == S_OK && result.result.loopLength == 1000)
+                    ++loaded[header];
+
+                close(fd);
+            }
+
+            durations[header] = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        for (const auto& path : paths)
+            unlink(path.c_str());
+        rmdir(directory);
+
+        Check(loaded[0] == fileCount && loaded[1] == fileCount, "scan", "Report");
+
+        printf("Scanning %d files of 256 KB from the page cache for format and loop points:\n", fileCount);
+        printf("  whole file   %8.1f ms, %8.1f MB read\n", durations[0] / 1000.0, bytesRead[0] / (1024.0 * 1024.0));
+        printf("  header only  %8.1f ms, %8.1f MB read\n", durations[1] / 1000.0, bytesRead[1] / (1024.0 * 1024.0));
+    }
+}
+
+
+int main()
+{
+    TestFormats();
+    TestHeaderOnlyIO();
+    TestMalformed();
+    TestCorruptChunks();
+
+    ReportScan();
+
+    if (g_failures)
+    {
+        printf("%d checks failed\n", g_failures);
+        return 1;
+    }
+
+    printf("RIFFChunks tests passed\n");
+    return 0;
+}
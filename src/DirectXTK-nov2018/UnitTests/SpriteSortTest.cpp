@@ -0,0 +1,430 @@
+//--------------------------------------------------------------------------------------
+// File: SpriteSortTest.cpp
+//
+// Tests for the SpriteBatch sort keys and radix sort: the packed keys must hold the depth,
+// texture ID and queue index of each sprite, and the radix sort must put them in the same
+// order as std::stable_sort for the Texture, BackToFront and FrontToBack modes. Also reports
+// the time to sort 1k, 10k and 100k sprites, against the std::sort comparisons SpriteBatch
+// used before.
+//
+// Build and run from the DirectXTK folder with g++ (-I- keeps the library sources from using Src/pch.h,
+// and UnitTests/Linux also stands in for DirectXMath.h and VertexTypes.h):
+//   g++ -std=c++14 -O2 -I UnitTests/Linux -I- -I UnitTests/Linux -I Src UnitTests/SpriteSortTest.cpp -o SpriteSortTest
+//   ./SpriteSortTest
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "pch.h"
+
+#include <float.h>
+#include <limits>
+
+#include "SpriteSort.h"
+
+using namespace DirectX;
+
+namespace
+{
+    int g_failures = 0;
+
+    void Check(bool condition, const char* message, const char* test)
+    {
+        if (!condition)
+        {
+            if (g_failures < 20)
+                printf("FAILED (%s): %s\n", test, message);
+            g_failures++;
+        }
+    }
+
+    const float Denormal = std::numeric_limits<float>::denorm_min();
+
+    const SpriteKeyOrder Orders[] = { SpriteKeyOrder_Texture, SpriteKeyOrder_BackToFront, SpriteKeyOrder_FrontToBack };
+    const char* const OrderNames[] = { "Texture", "BackToFront", "FrontToBack" };
+
+    // Textures are only compared, never dereferenced.
+    ID3D11ShaderResourceView* Texture(size_t id)
+    {
+        return reinterpret_cast<ID3D11ShaderResourceView*>(static_cast<uintptr_t>(0x10000 + id * 64));
+    }
+
+    typedef std::vector<SpriteInfo> SpriteQueue;
+
+    SpriteInfo MakeSprite(ID3D11ShaderResourceView* texture, float depth)
+    {
+        SpriteInfo sprite = {};
+        sprite.texture = texture;
+        sprite.originRotationDepth.w = depth;
+        return sprite;
+    }
+
+    std::vector<SpriteSortKey> BuildKeys(SpriteQueue const& sprites, SpriteKeyOrder order)
+    {
+        std::vector<SpriteSortKey> keys(sprites.size());
+        std::unordered_map<ID3D11ShaderResourceView*, uint32_t> textureIDs;
+        BuildSpriteSortKeys(sprites.data(), sprites.size(), order, keys.data(), textureIDs);
+        return keys;
+    }
+
+    std::vector<SpriteSortKey> RadixSorted(std::vector<SpriteSortKey> keys)
+    {
+        std::vector<SpriteSortKey> scratch(keys.size());
+        RadixSortSpriteKeys(keys.data(), scratch.data(), keys.size());
+        return keys;
+    }
+
+    std::vector<SpriteSortKey> StableSorted(std::vector<SpriteSortKey> keys)
+    {
+        std::stable_sort(keys.begin(), keys.end(), [](SpriteSortKey const& x, SpriteSortKey const& y)
+        {
+            return x.key < y.key;
+        });
+        return keys;
+    }
+
+    bool SameKeys(std::vector<SpriteSortKey> const& x, std::vector<SpriteSortKey> const& y)
+    {
+        return x.size() == y.size() && std::equal(x.begin(), x.end(), y.begin(), [](SpriteSortKey const& a, SpriteSortKey const& b)
+        {
+            return a.key == b.key && a.index == b.index;
+        });
+    }
+
+
+    //----------------------------------------------------------------------------------
+    // Depths must map to bits in the same order, with -0 equal to +0.
+    void TestSortableBits()
+    {
+        const float ascending[] =
+        {
+            -INFINITY, -FLT_MAX, -1e10f, -1.0f, -FLT_MIN, -FLT_MIN / 2, -Denormal,
+            0.0f, Denormal, FLT_MIN / 2, FLT_MIN, 0.5f, 1.0f, 1.0000001f, 1e10f, FLT_MAX, INFINITY,
+        };
+
+        for (size_t i = 1; i < _countof(ascending); i++)
+        {
+            Check(FloatToSortableBits(ascending[i - 1]) < FloatToSortableBits(ascending[i]), "bits are not in the order of the floats", "SortableBits");
+        }
+
+        Check(FloatToSortableBits(-0.0f) == FloatToSortableBits(0.0f), "-0 and +0 differ", "SortableBits");
+
+        // Random pairs of every sign and exponent, without NaNs.
+        std::mt19937 rng(1);
+
+        for (int i = 0; i < 1000000; i++)
+        {
+            uint32_t bits[2] = { static_cast<uint32_t>(rng()), static_cast<uint32_t>(rng()) };
+            float values[2];
+            memcpy(values, bits, sizeof(values));
+
+            if (std::isnan(values[0]) || std::isnan(values[1]))
+                continue;
+
+            uint32_t x = FloatToSortableBits(values[0]);
+            uint32_t y = FloatToSortableBits(values[1]);
+
+            Check((values[0] < values[1]) == (x < y) && (values[0] == values[1]) == (x == y), "bits are not in the order of the floats", "SortableBits");
+        }
+    }
+
+
+    //----------------------------------------------------------------------------------
+    // The depth, texture ID and queue index of each key, worked out by hand.
+    void TestKeyPacking()
+    {
+        SpriteQueue sprites =
+        {
+            MakeSprite(Texture(7), 0.5f),
+            MakeSprite(Texture(3), -2.0f),
+            MakeSprite(Texture(7), 0.5f),
+            MakeSprite(Texture(9), 0.0f),
+            MakeSprite(Texture(3), 1.0f),
+        };
+
+        // Texture IDs are assigned in order of first use, not in the order of the texture pointers.
+        const uint32_t textureIDs[] = { 0, 1, 0, 2, 1 };
+
+        for (size_t o = 0; o < _countof(Orders); o++)
+        {
+            auto keys = BuildKeys(sprites, Orders[o]);
+
+            for (size_t i = 0; i < sprites.size(); i++)
+            {
+                uint32_t depth = FloatToSortableBits(sprites[i].originRotationDepth.w);
+                uint32_t upper = (Orders[o] == SpriteKeyOrder_Texture) ? 0 : (Orders[o] == SpriteKeyOrder_BackToFront) ? ~depth : depth;
+
+                Check(static_cast<uint32_t>(keys[i].key >> 32) == upper, "the upper half is not the depth", OrderNames[o]);
+                Check(static_cast<uint32_t>(keys[i].key) == textureIDs[i], "the lower half is not the texture ID", OrderNames[o]);
+                Check(keys[i].index == i, "the index is not the queue position", OrderNames[o]);
+            }
+        }
+
+        // The sorted queue positions, with ties kept in submission order.
+        const uint32_t texture[] = { 0, 2, 1, 4, 3 };
+        const uint32_t backToFront[] = { 4, 0, 2, 3, 1 };
+        const uint32_t frontToBack[] = { 1, 3, 0, 2, 4 };
+        const uint32_t* expected[] = { texture, backToFront, frontToBack };
+
+        for (size_t o = 0; o < _countof(Orders); o++)
+        {
+            auto keys = RadixSorted(BuildKeys(sprites, Orders[o]));
+
+            for (size_t i = 0; i < keys.size(); i++)
+            {
+                Check(keys[i].index == expected[o][i], "the sprites are not in the expected order", OrderNames[o]);
+            }
+        }
+    }
+
+
+    //----------------------------------------------------------------------------------
+    // Queues of random sprites, with depths drawn from a few distributions.
+    enum Depths
+    {
+        Depths_Random,          // Distinct depths of either sign
+        Depths_Layers,          // A few depths shared by many sprites
+        Depths_Equal,           // One depth for every sprite
+        Depths_Tiny,            // Denormals and zeros of both signs
+    };
+
+    const char* const DepthNames[] = { "random", "layers", "equal", "tiny" };
+
+    SpriteQueue RandomSprites(std::mt19937& rng, size_t count, Depths depths, size_t textureCount)
+    {
+        SpriteQueue sprites(count);
+
+        // Sprites come in runs that share a texture, as they do when a game draws a tile map or some text.
+        size_t texture = 0;
+
+        for (size_t i = 0; i < count; i++)
+        {
+            if (rng() % 8 == 0)
+                texture = rng() % textureCount;
+
+            float depth;
+
+            switch (depths)
+            {
+                case Depths_Random: depth = std::uniform_real_distribution<float>(-100, 100)(rng); break;
+                case Depths_Layers: depth = static_cast<float>(rng() % 4) / 4; break;
+                case Depths_Equal:  depth = 0.25f; break;
+                default:            depth = (rng() % 2 ? -1.0f : 1.0f) * Denormal * static_cast<float>(rng() % 3); break;
+            }
+
+            sprites[i] = MakeSprite(Texture(texture), depth);
+        }
+
+        return sprites;
+    }
+
+    // The radix sort must give the same keys in the same order as std::stable_sort.
+    void TestAgainstStableSort()
+    {
+        std::mt19937 rng(2);
+
+        const size_t counts[] = { 1, 2, 3, 255, 256, 257, 1000, 10000, 100000 };
+
+        // Up to 2, 300 and 70000 textures, so texture IDs use one, two and three bytes.
+        const size_t textureCounts[] = { 2, 300, 70000 };
+
+        for (size_t count : counts)
+        {
+            for (size_t d = 0; d < _countof(DepthNames); d++)
+            {
+                for (size_t textureCount : textureCounts)
+                {
+                    auto sprites = RandomSprites(rng, count, static_cast<Depths>(d), textureCount);
+
+                    for (size_t o = 0; o < _countof(Orders); o++)
+                    {
+                        auto keys = BuildKeys(sprites, Orders[o]);
+                        Check(SameKeys(RadixSorted(keys), StableSorted(keys)), DepthNames[d], OrderNames[o]);
+                    }
+                }
+            }
+        }
+
+        // Keys that differ only in their highest byte, or not at all.
+        std::vector<SpriteSortKey> keys(5000);
+
+        for (size_t i = 0; i < keys.size(); i++)
+        {
+            keys[i].key = static_cast<uint64_t>(rng() % 3) << 56;
+            keys[i].index = static_cast<uint32_t>(i);
+        }
+
+        Check(SameKeys(RadixSorted(keys), StableSorted(keys)), "keys differing in the highest byte", "Keys");
+
+        for (auto& key : keys)
+            key.key = 0x0123456789ABCDEF;
+
+        Check(SameKeys(RadixSorted(keys), keys), "equal keys were reordered", "Keys");
+        Check(RadixSorted(std::vector<SpriteSortKey>()).empty(), "an empty queue", "Keys");
+    }
+
+
+    //----------------------------------------------------------------------------------
+    // The sorted sprites must be in the order the std::sort comparisons gave before: by depth, and
+    // grouped by texture. Ties are now broken by texture, then by submission order.
+    void TestSpriteOrder()
+    {
+        std::mt19937 rng(3);
+
+        for (size_t d = 0; d < _countof(DepthNames); d++)
+        {
+            auto sprites = RandomSprites(rng, 20000, static_cast<Depths>(d), 50);
+
+            for (size_t o = 0; o < _countof(Orders); o++)
+            {
+                auto keys = RadixSorted(BuildKeys(sprites, Orders[o]));
+
+                // The depths follow the comparison the sort mode used before.
+                std::vector<SpriteInfo const*> previous(sprites.size());
+
+                for (size_t i = 0; i < sprites.size(); i++)
+                    previous[i] = &sprites[i];
+
+                std::stable_sort(previous.begin(), previous.end(), [&](SpriteInfo const* x, SpriteInfo const* y)
+                {
+                    switch (Orders[o])
+                    {
+                        case SpriteKeyOrder_BackToFront: return x->originRotationDepth.w > y->originRotationDepth.w;
+                        case SpriteKeyOrder_FrontToBack: return x->originRotationDepth.w < y->originRotationDepth.w;
+                        default:                         return x->texture < y->texture;
+                    }
+                });
+
+                bool sameDepths = true, grouped = true, stable = true;
+                std::set<ID3D11ShaderResourceView*> closedTextures;
+
+                for (size_t i = 0; i < keys.size(); i++)
+                {
+                    SpriteInfo const& sprite = sprites[keys[i].index];
+                    sameDepths &= (Orders[o] == SpriteKeyOrder_Texture) || (FloatToSortableBits(sprite.originRotationDepth.w) == FloatToSortableBits(previous[i]->originRotationDepth.w));
+
+                    if (i == 0)
+                        continue;
+
+                    SpriteInfo const& last = sprites[keys[i - 1].index];
+                    bool sameGroup = (sprite.texture == last.texture) && (FloatToSortableBits(sprite.originRotationDepth.w) == FloatToSortableBits(last.originRotationDepth.w) || Orders[o] == SpriteKeyOrder_Texture);
+
+                    // Within a run of equal depth, each texture appears as one group, in submission order.
+                    if (sameGroup)
+                    {
+                        stable &= keys[i - 1].index < keys[i].index;
+                    }
+                    else
+                    {
+                        if (Orders[o] != SpriteKeyOrder_Texture && FloatToSortableBits(sprite.originRotationDepth.w) != FloatToSortableBits(last.originRotationDepth.w))
+                            closedTextures.clear();
+                        else
+                            closedTextures.insert(last.texture);
+
+                        grouped &= closedTextures.count(sprite.texture) == 0;
+                    }
+                }
+
+                Check(sameDepths, "the depths are not in the order of the previous comparison", OrderNames[o]);
+                Check(grouped, "a texture is split within a run of equal depth", OrderNames[o]);
+                Check(stable, "sprites with equal keys are not in submission order", OrderNames[o]);
+            }
+        }
+    }
+
+
+    //----------------------------------------------------------------------------------
+    // Time to sort a queue each way, as SortSprites does it each batch, the best of several runs.
+    typedef std::chrono::high_resolution_clock Clock;
+
+    template<typename Sort>
+    double BestTime(Sort sort, int runs)
+    {
+        double best = 1e30;
+
+        for (int run = 0; run < runs; run++)
+        {
+            auto start = Clock::now();
+            sort();
+            best = std::min(best, std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+        }
+
+        return best;
+    }
+
+    void ReportSortTimes()
+    {
+        std::mt19937 rng(4);
+
+        printf("Sorting the sprite queue, best of 10 runs (64 textures, random depths):\n");
+        printf("%8s  %-12s  %10s  %10s  %8s\n", "sprites", "mode", "std::sort", "radix", "speedup");
+
+        for (size_t count : { size_t(1000), size_t(10000), size_t(100000) })
+        {
+            auto sprites = RandomSprites(rng, count, Depths_Random, 64);
+
+            std::vector<SpriteInfo const*> sorted(count);
+            std::vector<SpriteSortKey> keys(count), scratch(count);
+            std::unordered_map<ID3D11ShaderResourceView*, uint32_t> textureIDs;
+
+            for (size_t o = 0; o < _countof(Orders); o++)
+            {
+                SpriteKeyOrder order = Orders[o];
+
+                // Before: GrowSortedSprites refills the pointers, which std::sort orders by reading each sprite.
+                double before = BestTime([&]
+                {
+                    for (size_t i = 0; i < count; i++)
+                        sorted[i] = &sprites[i];
+
+                    std::sort(sorted.begin(), sorted.end(), [order](SpriteInfo const* x, SpriteInfo const* y) -> bool
+                    {
+                        switch (order)
+                        {
+                            case SpriteKeyOrder_BackToFront: return x->originRotationDepth.w > y->originRotationDepth.w;
+                            case SpriteKeyOrder_FrontToBack: return x->originRotationDepth.w < y->originRotationDepth.w;
+                            default:                         return x->texture < y->texture;
+                        }
+                    });
+                }, 10);
+
+                // Now: the keys are built in one pass and radix sorted, then the pointers looked up in sorted order.
+                double after = BestTime([&]
+                {
+                    BuildSpriteSortKeys(sprites.data(), count, order, keys.data(), textureIDs);
+                    RadixSortSpriteKeys(keys.data(), scratch.data(), count);
+
+                    for (size_t i = 0; i < count; i++)
+                        sorted[i] = &sprites[keys[i].index];
+                }, 10);
+
+                printf("%8zu  %-12s  %7.1f us  %7.1f us  %7.2fx\n", count, OrderNames[o], before, after, before / after);
+            }
+        }
+
+        printf("\n");
+    }
+}
+
+
+int main()
+{
+    TestSortableBits();
+    TestKeyPacking();
+    TestAgainstStableSort();
+    TestSpriteOrder();
+
+    ReportSortTimes();
+
+    if (g_failures)
+    {
+        printf("%d checks failed\n", g_failures);
+        return 1;
+    }
+
+    printf("SpriteSort tests passed\n");
+    return 0;
+}
@@ -0,0 +1,296 @@
+//--------------------------------------------------------------------------------------
+// File: SpriteVerticesTest.cpp
+//
+// Tests for the SpriteBatch vertex expansion: a few sprites are checked against vertices
+// worked out by hand, and the parallel path and the eight-wide AVX2 path must write the same
+// bytes as RenderSprite. Also reports vertices per second for each path.
+//
+// Build and run from the DirectXTK folder with g++ (-I- keeps the library sources from using Src/pch.h,
+// and UnitTests/Linux also stands in for DirectXMath.h, VertexTypes.h, ppl.h and intrin.h). Unlike the
+// Microsoft compiler, g++ only builds the AVX2 intrinsics for an AVX2 target, so the test needs such a CPU:
+//   g++ -std=c++14 -O2 -mavx2 -pthread -I UnitTests/Linux -I- -I UnitTests/Linux -I Src UnitTests/SpriteVerticesTest.cpp Src/SpriteVertices.cpp -o SpriteVerticesTest
+//   ./SpriteVerticesTest
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "pch.h"
+
+#include "SpriteVertices.h"
+
+using namespace DirectX;
+
+namespace
+{
+    int g_failures = 0;
+
+    void Check(bool condition, const char* message, const char* test)
+    {
+        if (!condition)
+        {
+            if (g_failures < 20)
+                printf("FAILED (%s): %s\n", test, message);
+            g_failures++;
+        }
+    }
+
+    // Same values as SpriteEffects in SpriteBatch.h.
+    const int FlipHorizontally = 1;
+    const int FlipVertically = 2;
+
+    const float TextureWidth = 256;
+    const float TextureHeight = 128;
+
+    bool Near(float a, float b)
+    {
+        return fabsf(a - b) <= 1e-4f * std::max(1.0f, fabsf(b));
+    }
+
+    bool Near(XMFLOAT3 const& a, float x, float y, float z)
+    {
+        return Near(a.x, x) && Near(a.y, y) && Near(a.z, z);
+    }
+
+    bool Near(XMFLOAT2 const& a, float x, float y)
+    {
+        return Near(a.x, x) && Near(a.y, y);
+    }
+
+    // Expands the sprites like SpriteBatch does for a texture of TextureWidth x TextureHeight.
+    std::vector<VertexPositionColorTexture> Render(std::vector<SpriteInfo const*> const& sprites, bool parallel, uint8_t fill)
+    {
+        std::vector<VertexPositionColorTexture> vertices(sprites.size() * VerticesPerSprite);
+        memset(vertices.data(), fill, vertices.size() * sizeof(VertexPositionColorTexture));
+
+        XMVECTOR textureSize = XMVectorSet(TextureWidth, TextureHeight, 0, 0);
+        XMVECTOR inverseTextureSize = XMVectorReciprocal(textureSize);
+
+        RenderSprites(sprites.data(), sprites.size(), vertices.data(), textureSize, inverseTextureSize, parallel);
+
+        return vertices;
+    }
+
+    // A sprite as queued by SpriteBatch::Draw with a source rectangle in texels and a destination rectangle in pixels.
+    SpriteInfo MakeSprite(float x, float y, float width, float height, float rotation, int effects)
+    {
+        SpriteInfo sprite = {};
+
+        sprite.source = XMFLOAT4A(64, 32, 32, 16);
+        sprite.destination = XMFLOAT4A(x, y, width, height);
+        sprite.color = XMFLOAT4A(1, 0.5f, 0.25f, 1);
+        sprite.originRotationDepth = XMFLOAT4A(0, 0, rotation, 0.5f);
+        sprite.flags = effects | SpriteInfo::SourceInTexels | SpriteInfo::DestSizeInPixels;
+
+        return sprite;
+    }
+
+    // Sprites checked against vertices worked out by hand.
+    void TestKnownSprites()
+    {
+        std::vector<SpriteInfo> sprites;
+        sprites.push_back(MakeSprite(10, 20, 40, 30, 0, 0));
+        sprites.push_back(MakeSprite(10, 20, 40, 30, 0, FlipHorizontally | FlipVertically));
+        sprites.push_back(MakeSprite(10, 20, 40, 30, XM_PIDIV2, 0));
+
+        // Origin in the middle of the source region, and a destination scaled relative to the source size.
+        SpriteInfo centered = MakeSprite(100, 50, 2, 2, 0, 0);
+        centered.originRotationDepth = XMFLOAT4A(16, 8, 0, 0);
+        centered.destination = XMFLOAT4A(100, 50, 2 / TextureWidth, 2 / TextureHeight);
+        centered.flags = SpriteInfo::SourceInTexels;
+        sprites.push_back(centered);
+
+        std::vector<SpriteInfo const*> pointers;
+        for (auto& sprite : sprites)
+            pointers.push_back(&sprite);
+
+        auto vertices = Render(pointers, false, 0);
+
+        // Corners are written in the order top left, top right, bottom left, bottom right.
+        auto plain = &vertices[0];
+        Check(Near(plain[0].position, 10, 20, 0.5f) && Near(plain[1].position, 50, 20, 0.5f) &&
+              Near(plain[2].position, 10, 50, 0.5f) && Near(plain[3].position, 50, 50, 0.5f), "unrotated positions", "known");
+        Check(Near(plain[0].textureCoordinate, 0.25f, 0.25f) && Near(plain[3].textureCoordinate, 0.375f, 0.375f), "texture coordinates", "known");
+        Check(plain[2].color.x == 1 && plain[2].color.y == 0.5f && plain[2].color.z == 0.25f && plain[2].color.w == 1, "color", "known");
+
+        auto flipped = &vertices[4];
+        Check(Near(flipped[0].position, 10, 20, 0.5f), "mirroring moved the position", "known");
+        Check(Near(flipped[0].textureCoordinate, 0.375f, 0.375f) && Near(flipped[3].textureCoordinate, 0.25f, 0.25f), "mirrored texture coordinates", "known");
+
+        // A quarter turn clockwise in y-down screen space maps +x onto +y.
+        auto rotated = &vertices[8];
+        Check(Near(rotated[0].position, 10, 20, 0.5f) && Near(rotated[1].position, 10, 60, 0.5f) &&
+              Near(rotated[2].position, -20, 20, 0.5f), "rotated positions", "known");
+
+        auto middle = &vertices[12];
+        Check(Near(middle[0].position, 99, 49, 0) && Near(middle[3].position, 101, 51, 0), "origin and relative destination size", "known");
+    }
+
+    // Random sprites, covering every flag combination, zero-sized sources and rotated sprites.
+    std::vector<SpriteInfo> RandomSprites(size_t count, std::mt19937& rng)
+    {
+        std::uniform_real_distribution<float> position(-500, 2000);
+        std::uniform_real_distribution<float> size(0, 300);
+        std::uniform_real_distribution<float> unit(0, 1);
+        std::uniform_real_distribution<float> angle(-20, 20);
+
+        std::vector<SpriteInfo> sprites(count);
+
+        for (auto& sprite : sprites)
+        {
+            int flags = static_cast<int>(rng() & 15);
+
+            float sourceWidth = (rng() % 8) ? size(rng) : 0;
+            float sourceHeight = (rng() % 8) ? size(rng) : 0;
+
+            if (!(flags & SpriteInfo::SourceInTexels))
+            {
+                sourceWidth /= TextureWidth;
+                sourceHeight /= TextureHeight;
+            }
+
+            sprite.source = XMFLOAT4A(unit(rng), unit(rng), sourceWidth, sourceHeight);
+            sprite.destination = XMFLOAT4A(position(rng), position(rng), size(rng), size(rng));
+            sprite.color = XMFLOAT4A(unit(rng), unit(rng), unit(rng), unit(rng));
+            sprite.originRotationDepth = XMFLOAT4A(size(rng), size(rng), (rng() % 3) ? angle(rng) : 0, unit(rng));
+            sprite.texture = nullptr;
+            sprite.flags = flags;
+        }
+
+        return sprites;
+    }
+
+    // The AVX2 path expands blocks of eight sprites, and hands the rest to RenderSprite.
+    void TestAVX2(std::mt19937& rng)
+    {
+        const size_t counts[] = { 7, 8, 9, 15, 16, 100, 2053 };
+
+        XMVECTOR textureSize = XMVectorSet(TextureWidth, TextureHeight, 0, 0);
+        XMVECTOR inverseTextureSize = XMVectorReciprocal(textureSize);
+
+        for (size_t count : counts)
+        {
+            auto sprites = RandomSprites(count, rng);
+
+            // Large angles exercise the range reduction of the sine and cosine.
+            for (size_t i = 0; i < count; i += 5)
+                sprites[i].originRotationDepth.z *= 50;
+
+            // Both zeros count as unrotated.
+            sprites[0].originRotationDepth.z = -0.0f;
+
+            std::vector<SpriteInfo const*> pointers;
+            for (auto& sprite : sprites)
+                pointers.push_back(&sprite);
+
+            std::vector<VertexPositionColorTexture> expected(count * VerticesPerSprite);
+            std::vector<VertexPositionColorTexture> vertices(count * VerticesPerSprite);
+            memset(expected.data(), 0xCD, expected.size() * sizeof(VertexPositionColorTexture));
+            memset(vertices.data(), 0x5A, vertices.size() * sizeof(VertexPositionColorTexture));
+
+            for (size_t i = 0; i < count; i++)
+                RenderSprite(pointers[i], &expected[i * VerticesPerSprite], textureSize, inverseTextureSize);
+
+            RenderSpriteRange(pointers.data(), count, vertices.data(), textureSize, inverseTextureSize);
+
+            Check(memcmp(expected.data(), vertices.data(), expected.size() * sizeof(VertexPositionColorTexture)) == 0, "vertices differ from RenderSprite", "avx2");
+        }
+    }
+
+
+    // The parallel path splits large ranges into chunks, each of which must land in its own part of the output.
+    void TestParallel(std::mt19937& rng)
+    {
+        const size_t counts[] = { 1, 7, 127, 511, 512, 513, 1000, 2048, 4099, 20000 };
+
+        for (size_t count : counts)
+        {
+            auto sprites = RandomSprites(count, rng);
+
+            // Sorting hands the sprites over in any order.
+            std::vector<SpriteInfo const*> pointers;
+            for (auto& sprite : sprites)
+                pointers.push_back(&sprite);
+
+            std::shuffle(pointers.begin(), pointers.end(), rng);
+
+            // Different fill patterns, so a vertex that is not written shows up as a difference.
+            auto serial = Render(pointers, false, 0xCD);
+            auto parallel = Render(pointers, true, 0x5A);
+
+            Check(memcmp(serial.data(), parallel.data(), serial.size() * sizeof(VertexPositionColorTexture)) == 0, "parallel vertices differ from the serial ones", "parallel");
+        }
+    }
+
+    // Vertices per second of RenderSprite alone, of RenderSpriteRange, which uses AVX2 if it can, and of the parallel path.
+    void ReportThroughput(std::mt19937& rng)
+    {
+        const size_t count = 100000;
+        const int repeats = 20;
+
+        auto sprites = RandomSprites(count, rng);
+
+        std::vector<SpriteInfo const*> pointers;
+        for (auto& sprite : sprites)
+            pointers.push_back(&sprite);
+
+        std::vector<VertexPositionColorTexture> vertices(count * VerticesPerSprite);
+
+        XMVECTOR textureSize = XMVectorSet(TextureWidth, TextureHeight, 0, 0);
+        XMVECTOR inverseTextureSize = XMVectorReciprocal(textureSize);
+
+        const char* names[] = { "single", "range", "parallel" };
+
+        for (int path = 0; path < 3; path++)
+        {
+            auto start = std::chrono::steady_clock::now();
+
+            for (int i = 0; i < repeats; i++)
+            {
+                switch (path)
+                {
+                case 0:
+                    for (size_t j = 0; j < count; j++)
+                        RenderSprite(pointers[j], &vertices[j * VerticesPerSprite], textureSize, inverseTextureSize);
+                    break;
+
+                case 1:
+                    RenderSpriteRange(pointers.data(), count, vertices.data(), textureSize, inverseTextureSize);
+                    break;
+
+                default:
+                    RenderSprites(pointers.data(), count, vertices.data(), textureSize, inverseTextureSize, true);
+                    break;
+                }
+            }
+
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            printf("%-8s %7.1f M vertices/s\n", names[path], double(count * VerticesPerSprite * repeats) / seconds / 1e6);
+        }
+    }
+}
+
+
+int main()
+{
+    std::mt19937 rng(1);
+
+    TestKnownSprites();
+    TestAVX2(rng);
+    TestParallel(rng);
+
+    printf("%u hardware threads, AVX2 %s\n", std::thread::hardware_concurrency(), CanRenderSpritesWithAVX2() ? "used" : "not used");
+    ReportThroughput(rng);
+
+    if (g_failures)
+    {
+        printf("%d checks failed\n", g_failures);
+        return 1;
+    }
+
+    printf("SpriteVertices tests passed\n");
+    return 0;
+}
@@ -0,0 +1,644 @@
+//--------------------------------------------------------------------------------------
+// File: StreamingRingTest.cpp
+//
+// Tests for the read-ahead ring of SoundStreamInstance, streaming wave bank entries from a
+// file through a null audio sink. The sink checks each buffer against the file when it is
+// played, so a buffer reused while still queued is caught, as are out of order or missing
+// data, misaligned reads, and a wrong end of stream. Runs with a reader that completes
+// requests out of order, and with one that reads on threads. Also reports the streaming
+// throughput and the memory it keeps resident, against loading the whole entry.
+//
+// Build and run from the DirectXTK folder with g++ (-I- keeps StreamingRing.h from using Audio/pch.h):
+//   g++ -std=c++14 -O2 -pthread -I UnitTests/Linux -I- -I UnitTests/Linux -I Audio UnitTests/StreamingRingTest.cpp -o StreamingRingTest
+//   ./StreamingRingTest
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+// http://go.microsoft.com/fwlink/?LinkID=615561
+//--------------------------------------------------------------------------------------
+
+#include <unistd.h>
+
+#include "pch.h"
+
+#include "StreamingRing.h"
+
+using namespace DirectX;
+
+namespace
+{
+    int g_failures = 0;
+
+    void Check(bool condition, const char* message, const char* test)
+    {
+        if (!condition)
+        {
+            if (g_failures < 20)
+                printf("FAILED (%s): %s\n", test, message);
+            g_failures++;
+        }
+    }
+
+    bool IsAligned(uint64_t value)
+    {
+        return (value % STREAMING_SECTOR_ALIGNMENT) == 0;
+    }
+
+    // Holds the bank in a temporary file. Every byte is a function of its offset.
+    class BankFile
+    {
+    public:
+        explicit BankFile(size_t size) : mFile(tmpfile()), mContents(size)
+        {
+            std::mt19937 rng(static_cast<uint32_t>(size));
+            for (auto& value : mContents)
+                value = static_cast<uint8_t>(rng());
+
+            if (!mFile || fwrite(mContents.data(), 1, size, mFile) != size || fflush(mFile) != 0)
+            {
+                printf("FAILED: cannot write the test bank\n");
+                exit(1);
+            }
+        }
+
+        ~BankFile() { fclose(mFile); }
+
+        int Descriptor() const { return fileno(mFile); }
+        const uint8_t* Contents() const { return mContents.data(); }
+        size_t Size() const { return mContents.size(); }
+
+    private:
+        FILE* mFile;
+        std::vector<uint8_t> mContents;
+    };
+
+    // Checks the requests the ring makes of any reader.
+    struct ReadChecks
+    {
+        bool inFlight[STREAMING_BUFFER_COUNT] = {};
+        bool aligned = true;
+        bool oneReadPerBuffer = true;
+        bool cancelledIdle = false;
+        size_t reads = 0;
+
+        void Begin(size_t buffer, const uint8_t* data, uint64_t offset, uint32_t bytes)
+        {
+            aligned &= IsAligned(reinterpret_cast<uintptr_t>(data)) && IsAligned(offset) && IsAligned(bytes)
+                && bytes > 0 && bytes <= STREAMING_BUFFER_SIZE;
+            oneReadPerBuffer &= !inFlight[buffer];
+            inFlight[buffer] = true;
+            reads++;
+        }
+
+        void Report(const char* test) const
+        {
+            Check(aligned, "read not sector aligned", test);
+            Check(oneReadPerBuffer, "second read into a buffer", test);
+            Check(!cancelledIdle, "cancelled a buffer with no read", test);
+        }
+    };
+
+    // Completes each read after a random number of polls, so reads finish out of order. The data
+    // is read from the file when the read completes.
+    class DeferredReader
+    {
+    public:
+        DeferredReader(int file, uint32_t seed) : mFile(file), mRng(seed), mRequests{} {}
+
+        void BeginRead(size_t buffer, uint8_t* data, uint64_t offset, uint32_t bytes)
+        {
+            checks.Begin(buffer, data, offset, bytes);
+
+            auto& request = mRequests[buffer];
+            request.data = data;
+            request.offset = offset;
+            request.bytes = bytes;
+            request.polls = std::uniform_int_distribution<int>(0, 4)(mRng);
+        }
+
+        bool IsReadComplete(size_t buffer, uint32_t& bytesRead)
+        {
+            auto& request = mRequests[buffer];
+
+            if (request.polls-- > 0)
+                return false;
+
+            ssize_t result = pread(mFile, request.data, request.bytes, static_cast<off_t>(request.offset));
+
+            bytesRead = (result > 0) ? static_cast<uint32_t>(result) : 0;
+            checks.inFlight[buffer] = false;
+            return true;
+        }
+
+        void CancelRead(size_t buffer)
+        {
+            checks.cancelledIdle |= !checks.inFlight[buffer];
+            checks.inFlight[buffer] = false;
+        }
+
+        ReadChecks checks;
+
+    private:
+        struct Request
+        {
+            uint8_t* data;
+            uint64_t offset;
+            uint32_t bytes;
+            int polls;
+        };
+
+        int mFile;
+        std::mt19937 mRng;
+        Request mRequests[STREAMING_BUFFER_COUNT];
+    };
+
+    // Reads on a thread per request, the way overlapped reads complete on Windows.
+    class ThreadReader
+    {
+    public:
+        explicit ThreadReader(int file) : mFile(file), mRequests{} {}
+
+        ~ThreadReader()
+        {
+            for (auto& request : mRequests)
+            {
+                if (request.thread.joinable())
+                    request.thread.join();
+            }
+        }
+
+        void BeginRead(size_t buffer, uint8_t* data, uint64_t offset, uint32_t bytes)
+        {
+            checks.Begin(buffer, data, offset, bytes);
+
+            auto& request = mRequests[buffer];
+            request.done = false;
+            request.thread = std::thread([this, &request, data, offset, bytes]()
+            {
+                ssize_t result = pread(mFile, data, bytes, static_cast<off_t>(offset));
+                request.bytesRead = (result > 0) ? static_cast<uint32_t>(result) : 0;
+                request.done = true;
+            });
+        }
+
+        bool IsReadComplete(size_t buffer, uint32_t& bytesRead)
+        {
+            auto& request = mRequests[buffer];
+
+            if (!request.done)
+                return false;
+
+            request.thread.join();
+            bytesRead = request.bytesRead;
+            checks.inFlight[buffer] = false;
+            return true;
+        }
+
+        void CancelRead(size_t buffer)
+        {
+            checks.cancelledIdle |= !checks.inFlight[buffer];
+            checks.inFlight[buffer] = false;
+
+            mRequests[buffer].thread.join();
+        }
+
+        ReadChecks checks;
+
+    private:
+        struct Request
+        {
+            std::thread thread;
+            std::atomic<bool> done;
+            uint32_t bytesRead;
+        };
+
+        int mFile;
+        Request mRequests[STREAMING_BUFFER_COUNT];
+    };
+
+    // Queues buffers like a source voice, and checks each against the entry when it is played.
+    class NullSink
+    {
+    public:
+        NullSink(const uint8_t* entry, uint32_t lengthBytes, const char* test) :
+            mEntry(entry), mLengthBytes(lengthBytes), mTest(test), mNextPosition(0), mEnded(false), mPlayedBytes(0), mPasses(0) {}
+
+        size_t GetPendingBufferCount() { return mQueue.size(); }
+
+        void SubmitBuffer(const uint8_t* data, uint32_t position, uint32_t length, bool endOfStream)
+        {
+            Check(!mEnded, "buffer submitted after the end of stream", mTest);
+            Check(position == mNextPosition, "buffer submitted out of order", mTest);
+            Check(length > 0 && position + length <= mLengthBytes, "buffer outside the entry", mTest);
+            Check(!endOfStream || position + length == mLengthBytes, "end of stream before the end of the entry", mTest);
+
+            mQueue.push_back(Queued{ data, position, length });
+
+            mNextPosition = position + length;
+            if (mNextPosition >= mLengthBytes)
+            {
+                mNextPosition = 0;
+                mPasses++;
+            }
+
+            mEnded |= endOfStream;
+        }
+
+        void EndStream()
+        {
+            Check(!mEnded, "stream ended twice", mTest);
+            Check(mNextPosition == 0, "stream ended within a pass", mTest);
+
+            mEnded = true;
+        }
+
+        // Plays the oldest buffers.
+        void Play(size_t count)
+        {
+            for (; count > 0 && !mQueue.empty(); count--)
+            {
+                auto& buffer = mQueue.front();
+
+                Check(memcmp(buffer.data, mEntry + buffer.position, buffer.length) == 0, "buffer does not match the file when played", mTest);
+
+                mPlayedBytes += buffer.length;
+                mQueue.pop_front();
+            }
+        }
+
+        // What XAudio2 does on a stop with a flush.
+        void Flush() { mQueue.clear(); }
+
+        // Starts a new stream.
+        void Restart() { Flush(); mNextPosition = 0; mEnded = false; mPasses = 0; }
+
+        bool HasEnded() const { return mEnded; }
+        uint64_t PlayedBytes() const { return mPlayedBytes; }
+        uint32_t Passes() const { return mPasses; }
+
+    private:
+        struct Queued
+        {
+            const uint8_t* data;
+            uint32_t position;
+            uint32_t length;
+        };
+
+        const uint8_t* mEntry;
+        uint32_t mLengthBytes;
+        const char* mTest;
+        std::deque<Queued> mQueue;
+        uint32_t mNextPosition;
+        bool mEnded;
+        uint64_t mPlayedBytes;
+        uint32_t mPasses;
+    };
+
+    struct AlignedBuffers
+    {
+        AlignedBuffers() : memory(static_cast<uint8_t*>(_aligned_malloc(STREAMING_BUFFER_SIZE * STREAMING_BUFFER_COUNT, STREAMING_SECTOR_ALIGNMENT))) {}
+        ~AlignedBuffers() { _aligned_free(memory); }
+
+        uint8_t* memory;
+    };
+
+    // Updates until the sink has the end of stream and has played it, playing one buffer every other update.
+    // Each update yields, as a game does between frames, so reader threads run even on one core.
+    template<typename TReader>
+    bool RunToEnd(StreamingRing<TReader, NullSink>& ring, TReader& reader, NullSink& sink)
+    {
+        for (int update = 0; update < 1000000; update++)
+        {
+            ring.Update(reader, sink);
+            std::this_thread::yield();
+
+            if (update & 1)
+                sink.Play(1);
+
+            if (sink.HasEnded() && !sink.GetPendingBufferCount())
+                return true;
+        }
+
+        return false;
+    }
+
+    template<typename TReader>
+    void StreamEntry(BankFile const& bank, TReader& reader, uint32_t offsetBytes, uint32_t lengthBytes, uint32_t blockAlign, const char* test)
+    {
+        AlignedBuffers buffers;
+        StreamingRing<TReader, NullSink> ring(buffers.memory, offsetBytes, lengthBytes, blockAlign);
+        NullSink sink(bank.Contents() + offsetBytes, lengthBytes, test);
+
+        ring.Play(reader, false);
+
+        Check(RunToEnd(ring, reader, sink), "stream did not end", test);
+        Check(sink.PlayedBytes() == lengthBytes, "wrong number of bytes played", test);
+        Check(ring.HasStreamEnded(), "ring does not report the end", test);
+
+        // Further updates neither read nor submit
+        size_t reads = reader.checks.reads;
+        for (int j = 0; j < 10; j++)
+            ring.Update(reader, sink);
+        Check(reader.checks.reads == reads, "read after the end", test);
+
+        reader.checks.Report(test);
+    }
+
+
+    // PCM, ADPCM and xWMA block sizes, at aligned and unaligned offsets, from one block to many buffers.
+    void TestStream()
+    {
+        BankFile bank(3 * 1024 * 1024);
+
+        const uint32_t blockAligns[] = { 2, 4, 36, 1024, 2230, 8192 };
+        const uint32_t offsets[] = { 0, 4096, 4095, 12345 };
+
+        for (auto blockAlign : blockAligns)
+        {
+            const uint32_t lengths[] =
+            {
+                blockAlign,
+                (static_cast<uint32_t>(STREAMING_BUFFER_SIZE) / blockAlign) * blockAlign,
+                (static_cast<uint32_t>(STREAMING_BUFFER_SIZE) / blockAlign + 1) * blockAlign,
+                (2 * 1024 * 1024 / blockAlign) * blockAlign,
+            };
+
+            for (auto offset : offsets)
+            {
+                for (auto length : lengths)
+                {
+                    DeferredReader deferred(bank.Descriptor(), offset + length);
+                    StreamEntry(bank, deferred, offset, length, blockAlign, "Deferred");
+
+                    ThreadReader threaded(bank.Descriptor());
+                    StreamEntry(bank, threaded, offset, length, blockAlign, "Threaded");
+                }
+            }
+        }
+    }
+
+
+    // Looping replays the entry until the loop is exited, then ends with that pass. The loop is exited
+    // at every point of the first few passes, including with the next pass already read ahead.
+    template<typename TReader>
+    void TestLoop(BankFile const& bank, TReader& reader, const char* test)
+    {
+        const uint32_t offset = 777;
+        const uint32_t length = 150000 - (150000 % 4);
+
+        AlignedBuffers buffers;
+        StreamingRing<TReader, NullSink> ring(buffers.memory, offset, length, 4);
+        NullSink sink(bank.Contents() + offset, length, test);
+
+        for (int exitAfter = 0; exitAfter < 40; exitAfter++)
+        {
+            sink.Restart();
+            ring.Play(reader, true);
+            Check(ring.IsLooped(), "not looped", test);
+
+            uint64_t before = sink.PlayedBytes();
+
+            for (int update = 0; update < exitAfter; update++)
+            {
+                ring.Update(reader, sink);
+                std::this_thread::yield();
+
+                if (update & 1)
+                    sink.Play(1);
+            }
+
+            Check(!sink.HasEnded(), "looping stream ended", test);
+
+            ring.ExitLoop();
+            Check(!ring.IsLooped(), "still looped", test);
+
+            Check(RunToEnd(ring, reader, sink), "stream did not end after the loop", test);
+            Check((sink.PlayedBytes() - before) % length == 0, "did not end with a whole pass", test);
+            Check(sink.PlayedBytes() > before, "nothing played", test);
+        }
+
+        Check(sink.PlayedBytes() >= 4 * uint64_t(length), "too few passes", test);
+
+        reader.checks.Report(test);
+    }
+
+
+    // Stopping cancels reads in flight, and playing again restarts from the beginning.
+    template<typename TReader>
+    void TestStop(BankFile const& bank, TReader& reader, const char* test)
+    {
+        const uint32_t offset = 8192;
+        const uint32_t length = 1000000;
+
+        AlignedBuffers buffers;
+        StreamingRing<TReader, NullSink> ring(buffers.memory, offset, length, 4);
+        NullSink sink(bank.Contents() + offset, length, test);
+
+        for (int pass = 0; pass < 3; pass++)
+        {
+            sink.Restart();
+            ring.Play(reader, pass == 1);
+
+            for (int update = 0; update < 20; update++)
+            {
+                ring.Update(reader, sink);
+                sink.Play(1);
+            }
+
+            ring.Stop(reader);
+            sink.Flush();
+
+            Check(ring.HasStreamEnded(), "stopped stream not ended", test);
+
+            bool idle = true;
+            for (auto inFlight : reader.checks.inFlight)
+                idle &= !inFlight;
+            Check(idle, "read still in flight after stop", test);
+
+            size_t reads = reader.checks.reads;
+            ring.Update(reader, sink);
+            Check(reader.checks.reads == reads && !sink.GetPendingBufferCount(), "activity after stop", test);
+        }
+
+        // Playing from a stop reads the whole entry again
+        sink.Restart();
+        ring.Play(reader, false);
+
+        uint64_t before = sink.PlayedBytes();
+        Check(RunToEnd(ring, reader, sink), "stream did not end after a restart", test);
+        Check(sink.PlayedBytes() - before == length, "restart did not play the whole entry", test);
+
+        reader.checks.Report(test);
+    }
+
+
+    // A bank whose entry runs past the end of the file is an error, not silence.
+    void TestTruncated()
+    {
+        BankFile bank(200000);
+
+        AlignedBuffers buffers;
+        DeferredReader reader(bank.Descriptor(), 1);
+        StreamingRing<DeferredReader, NullSink> ring(buffers.memory, 4096, 400000, 4);
+        NullSink sink(bank.Contents() + 4096, 400000, "Truncated");
+
+        bool threw = false;
+
+        try
+        {
+            ring.Play(reader, false);
+            for (int update = 0; update < 1000; update++)
+            {
+                ring.Update(reader, sink);
+                sink.Play(1);
+            }
+        }
+        catch (std::exception&)
+        {
+            threw = true;
+        }
+
+        Check(threw, "short read not reported", "Truncated");
+    }
+
+
+    // The rebased tables of consecutive buffers must add up to the bank's table.
+    void TestRebaseSeekTable()
+    {
+        const uint32_t blockAlign = 2230;
+        const uint32_t packetCount = 500;
+
+        std::mt19937 rng(5);
+        std::vector<uint32_t> seekTable(packetCount);
+        uint32_t total = 0;
+        for (auto& entry : seekTable)
+        {
+            total += 2048 * std::uniform_int_distribution<uint32_t>(1, 4)(rng);
+            entry = total;
+        }
+
+        const uint32_t lengthBytes = packetCount * blockAlign;
+
+        std::vector<uint32_t> packets(STREAMING_BUFFER_SIZE / blockAlign + 1);
+        uint64_t decoded = 0;
+        bool same = true;
+
+        for (uint32_t position = 0; position < lengthBytes; )
+        {
+            uint32_t length = std::min<uint32_t>(lengthBytes - position, 29 * blockAlign);
+
+            bool ok = RebaseSeekTable(seekTable.data(), packetCount, position, length, blockAlign, packets.data());
+            Check(ok, "seek table reported short", "RebaseSeekTable");
+
+            uint32_t first = position / blockAlign;
+            uint32_t base = first ? seekTable[first - 1] : 0;
+            for (uint32_t j = 0; j < length / blockAlign; j++)
+            {
+                same &= packets[j] == seekTable[first + j] - base;
+            }
+
+            decoded += packets[length / blockAlign - 1];
+            position += length;
+        }
+
+        Check(same, "rebased table does not match", "RebaseSeekTable");
+        Check(decoded == total, "rebased tables do not add up", "RebaseSeekTable");
+
+        Check(!RebaseSeekTable(seekTable.data(), packetCount - 1, (packetCount - 2) * blockAlign, 2 * blockAlign, blockAlign, packets.data()),
+            "short table accepted", "RebaseSeekTable");
+    }
+
+
+    // Streams an entry with threaded reads as fast as the sink takes it, against one read of the whole entry.
+    void ReportThroughput()
+    {
+        const uint32_t length = 64 * 1024 * 1024;
+        const uint32_t offset = 4096;
+
+        BankFile bank(offset + length);
+
+        const int repeats = 5;
+        double streamed = 0;
+        double loaded = 0;
+
+        for (int j = 0; j < repeats; j++)
+        {
+            {
+                auto start = std::chrono::steady_clock::now();
+
+                AlignedBuffers buffers;
+                ThreadReader reader(bank.Descriptor());
+                StreamingRing<ThreadReader, NullSink> ring(buffers.memory, offset, length, 4);
+                NullSink sink(bank.Contents() + offset, length, "Throughput");
+
+                ring.Play(reader, false);
+                while (!(sink.HasEnded() && !sink.GetPendingBufferCount()))
+                {
+                    ring.Update(reader, sink);
+                    std::this_thread::yield();
+                    sink.Play(1);
+                }
+
+                streamed += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            }
+
+            {
+                auto start = std::chrono::steady_clock::now();
+
+                std::unique_ptr<uint8_t[]> data(new uint8_t[length]);
+                ssize_t result = pread(bank.Descriptor(), data.get(), length, offset);
+                Check(result == ssize_t(length) && memcmp(data.get(), bank.Contents() + offset, length) == 0, "whole entry read", "Throughput");
+
+                loaded += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            }
+        }
+
+        double megabytes = double(length) * repeats / (1024 * 1024);
+
+        printf("%u MB entry from the page cache, %u hardware threads:\n", length / (1024 * 1024), std::thread::hardware_concurrency());
+        printf("  streamed %7.1f MB/s, %4zu KB resident\n", megabytes / streamed, STREAMING_BUFFER_SIZE * STREAMING_BUFFER_COUNT / 1024);
+        printf("  loaded   %7.1f MB/s, %4u KB resident\n", megabytes / loaded, length / 1024);
+    }
+}
+
+
+int main()
+{
+    TestStream();
+
+    {
+        BankFile bank(1024 * 1024);
+
+        DeferredReader deferred(bank.Descriptor(), 3);
+        TestLoop(bank, deferred, "Loop deferred");
+
+        ThreadReader threaded(bank.Descriptor());
+        TestLoop(bank, threaded, "Loop threaded");
+    }
+
+    {
+        BankFile bank(2 * 1024 * 1024);
+
+        DeferredReader deferred(bank.Descriptor(), 4);
+        TestStop(bank, deferred, "Stop deferred");
+
+        ThreadReader threaded(bank.Descriptor());
+        TestStop(bank, threaded, "Stop threaded");
+    }
+
+    TestTruncated();
+    TestRebaseSeekTable();
+
+    ReportThroughput();
+
+    if (g_failures)
+    {
+        printf("%d checks failed\n", g_failures);
+        return 1;
+    }
+
+    printf("StreamingRing tests passed\n");
+    return 0;
+}
@@ -0,0 +1,874 @@
+//--------------------------------------------------------------------------------------
+// File: WaveBankLayoutTest.cpp
+//
+// Tests for serving in-memory wave banks from a read-only mapping (WaveBankReader::OpenMapped).
+// Wave data, seek tables and names read through a mapping of the bank file must match the
+// buffers Open reads, and point into the mapping rather than a copy. Malformed banks must
+// never yield a pointer outside the segment that holds it: banks with corrupt metadata are
+// served from memory that ends at an unreadable page, as a view ends at the end of the file.
+// Also reports the time to open a large bank and the memory it keeps resident, mapped
+// against read into a buffer.
+//
+// Build and run from the DirectXTK folder with g++ (-I- keeps WaveBankLayout.h from using Audio/pch.h):
+//   g++ -std=c++14 -O2 -I UnitTests/Linux -I- -I UnitTests/Linux -I Audio UnitTests/WaveBankLayoutTest.cpp -o WaveBankLayoutTest
+//   ./WaveBankLayoutTest
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+// http://go.microsoft.com/fwlink/?LinkID=615561
+//--------------------------------------------------------------------------------------
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "pch.h"
+
+#include "WaveBankLayout.h"
+
+using namespace DirectX::WaveBankLayout;
+
+namespace
+{
+    int g_failures = 0;
+
+    void Check(bool condition, const char* message, const char* test)
+    {
+        if (!condition)
+        {
+            if (g_failures < 20)
+                printf("FAILED (%s): %s\n", test, message);
+            g_failures++;
+        }
+    }
+
+    uint32_t Align(size_t length, uint32_t alignment)
+    {
+        return uint32_t((length + alignment - 1) / alignment * alignment);
+    }
+
+
+    //----------------------------------------------------------------------------------
+    // Banks laid out as xwbtool writes them
+
+    struct Wave
+    {
+        std::vector<uint8_t> data;
+        std::vector<uint32_t> seekTable;    // Cumulative decoded bytes per xWMA packet, empty for PCM
+        std::string name;
+    };
+
+    struct BankOptions
+    {
+        uint32_t alignment;
+        bool compact;                       // Compact banks share one format, so every wave is xWMA
+        bool names;
+    };
+
+    MINIWAVEFORMAT Format(bool wma)
+    {
+        MINIWAVEFORMAT format;
+        format.dwValue = 0;
+        format.wFormatTag = wma ? MINIWAVEFORMAT::TAG_WMA : MINIWAVEFORMAT::TAG_PCM;
+        format.nChannels = 2;
+        format.nSamplesPerSec = 44100;
+        format.wBlockAlign = wma ? 0 : 4;
+        format.wBitsPerSample = wma ? 0 : MINIWAVEFORMAT::BITDEPTH_16;
+        return format;
+    }
+
+    std::vector<uint8_t> WriteBank(const std::vector<Wave>& waves, const BankOptions& options)
+    {
+        auto count = static_cast<uint32_t>(waves.size());
+
+        // The seek table segment starts with the offset of each table, following those offsets
+        std::vector<uint32_t> seekTables;
+        bool hasSeekTables = false;
+        for (const auto& wave : waves)
+            hasSeekTables |= !wave.seekTable.empty();
+
+        if (hasSeekTables)
+        {
+            seekTables.resize(count, uint32_t(-1));
+            for (uint32_t j = 0; j < count; ++j)
+            {
+                if (waves[j].seekTable.empty())
+                    continue;
+
+                seekTables[j] = static_cast<uint32_t>((seekTables.size() - count) * sizeof(uint32_t));
+                seekTables.push_back(static_cast<uint32_t>(waves[j].seekTable.size()));
+                seekTables.insert(seekTables.end(), waves[j].seekTable.begin(), waves[j].seekTable.end());
+            }
+        }
+
+        std::vector<uint32_t> offsets;
+        uint32_t waveLength = 0;
+        for (const auto& wave : waves)
+        {
+            offsets.push_back(waveLength);
+            waveLength += Align(wave.data.size(), options.alignment);
+        }
+
+        HEADER header = {};
+        header.dwSignature = HEADER::SIGNATURE;
+        header.dwVersion = HEADER::VERSION;
+        header.dwHeaderVersion = HEADER::VERSION;
+
+        BANKDATA data = {};
+        data.dwFlags = BANKDATA::TYPE_BUFFER;
+        data.dwEntryCount = count;
+        strcpy(data.szBankName, "Test");
+        data.dwEntryMetaDataElementSize = options.compact ? sizeof(ENTRYCOMPACT) : sizeof(ENTRY);
+        data.dwEntryNameElementSize = options.names ? 64 : 0;
+        data.dwAlignment = options.alignment;
+
+        if (options.compact)
+        {
+            data.dwFlags |= BANKDATA::FLAGS_COMPACT;
+            data.CompactFormat = Format(true);
+        }
+        if (options.names)
+            data.dwFlags |= BANKDATA::FLAGS_ENTRYNAMES;
+        if (hasSeekTables)
+            data.dwFlags |= BANKDATA::FLAGS_SEEKTABLES;
+
+        auto& segments = header.Segments;
+        segments[HEADER::SEGIDX_BANKDATA] = { sizeof(HEADER), sizeof(BANKDATA) };
+        segments[HEADER::SEGIDX_ENTRYMETADATA] = { sizeof(HEADER) + sizeof(BANKDATA), count * data.dwEntryMetaDataElementSize };
+        segments[HEADER::SEGIDX_SEEKTABLES] = { segments[1].dwOffset + segments[1].dwLength, static_cast<uint32_t>(seekTables.size() * sizeof(uint32_t)) };
+        segments[HEADER::SEGIDX_ENTRYNAMES] = { segments[2].dwOffset + segments[2].dwLength, count * data.dwEntryNameElementSize };
+        segments[HEADER::SEGIDX_ENTRYWAVEDATA] = { Align(segments[3].dwOffset + segments[3].dwLength, options.alignment), waveLength };
+
+        std::vector<uint8_t> file(segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwOffset + waveLength, 0);
+        memcpy(file.data(), &header, sizeof(HEADER));
+        memcpy(file.data() + segments[HEADER::SEGIDX_BANKDATA].dwOffset, &data, sizeof(BANKDATA));
+
+        for (uint32_t j = 0; j < count; ++j)
+        {
+            const auto& wave = waves[j];
+            auto length = static_cast<uint32_t>(wave.data.size());
+            uint8_t* metadata = file.data() + segments[HEADER::SEGIDX_ENTRYMETADATA].dwOffset + j * data.dwEntryMetaDataElementSize;
+
+            if (options.compact)
+            {
+                ENTRYCOMPACT entry;
+                entry.dwOffset = offsets[j] / options.alignment;
+                entry.dwLengthDeviation = Align(length, options.alignment) - length;
+                memcpy(metadata, &entry, sizeof(entry));
+            }
+            else
+            {
+                ENTRY entry = {};
+                entry.Duration = length / 4;
+                entry.Format = Format(!wave.seekTable.empty());
+                entry.PlayRegion = { offsets[j], length };
+                memcpy(metadata, &entry, sizeof(entry));
+            }
+
+            if (options.names)
+            {
+                strncpy(reinterpret_cast<char*>(file.data()) + segments[HEADER::SEGIDX_ENTRYNAMES].dwOffset + j * 64, wave.name.c_str(), 64);
+            }
+
+            memcpy(file.data() + segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwOffset + offsets[j], wave.data.data(), length);
+        }
+
+        if (hasSeekTables)
+        {
+            memcpy(file.data() + segments[HEADER::SEGIDX_SEEKTABLES].dwOffset, seekTables.data(), seekTables.size() * sizeof(uint32_t));
+        }
+
+        return file;
+    }
+
+    std::vector<Wave> MakeWaves(std::mt19937& rng, size_t count, size_t maxLength, bool allSeekTables)
+    {
+        std::vector<Wave> waves(count);
+        for (size_t j = 0; j < count; ++j)
+        {
+            auto& wave = waves[j];
+
+            wave.data.resize(std::uniform_int_distribution<size_t>(1, maxLength)(rng));
+            for (auto& value : wave.data)
+                value = static_cast<uint8_t>(rng());
+
+            if (allSeekTables || (j % 2))
+            {
+                uint32_t total = 0;
+                for (int packet = std::uniform_int_distribution<int>(1, 8)(rng); packet > 0; --packet)
+                {
+                    total += 4096;
+                    wave.seekTable.push_back(total);
+                }
+            }
+
+            wave.name = "wave" + std::to_string(j);
+            if (j % 5 == 4)
+                wave.name.append(60, 'x');      // Fills its element, with no terminator
+        }
+        return waves;
+    }
+
+
+    //----------------------------------------------------------------------------------
+    // Banks as WaveBankReader holds them
+
+    struct LoadedBank
+    {
+        HEADER          header;
+        BANKDATA        data;
+        const char*     nameTable = nullptr;
+        const uint8_t*  entryTable = nullptr;
+        const uint8_t*  seekTable = nullptr;
+        const uint8_t*  waveTable = nullptr;
+
+        // Buffers of a bank loaded as Open does
+        std::vector<uint8_t> names, entries, seekTables, waveData;
+    };
+
+    // Reads each segment into a buffer of its own, as WaveBankReader::Open does.
+    HRESULT LoadBuffered(const uint8_t* file, size_t size, LoadedBank& bank)
+    {
+        auto read = [&](uint32_t offset, uint32_t length, std::vector<uint8_t>& buffer)
+        {
+            if (uint64_t(offset) + length > size)
+                return false;
+
+            buffer.assign(file + offset, file + offset + length);
+            return true;
+        };
+
+        if (size < sizeof(HEADER))
+            return E_FAIL;
+
+        memcpy(&bank.header, file, sizeof(HEADER));
+        if (bank.header.dwSignature != HEADER::SIGNATURE || bank.header.dwHeaderVersion != HEADER::VERSION)
+            return E_FAIL;
+
+        const auto& segments = bank.header.Segments;
+
+        std::vector<uint8_t> data;
+        if (!read(segments[HEADER::SEGIDX_BANKDATA].dwOffset, sizeof(BANKDATA), data))
+            return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+
+        memcpy(&bank.data, data.data(), sizeof(BANKDATA));
+
+        HRESULT hr = ValidateBankData(bank.header, bank.data);
+        if (FAILED(hr))
+            return hr;
+
+        DWORD namesBytes = segments[HEADER::SEGIDX_ENTRYNAMES].dwLength;
+        if (namesBytes > 0 && namesBytes >= (uint64_t(bank.data.dwEntryNameElementSize) * bank.data.dwEntryCount))
+        {
+            if (!read(segments[HEADER::SEGIDX_ENTRYNAMES].dwOffset, namesBytes, bank.names))
+                return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+
+            bank.nameTable = reinterpret_cast<const char*>(bank.names.data());
+        }
+
+        if (!read(segments[HEADER::SEGIDX_ENTRYMETADATA].dwOffset, segments[HEADER::SEGIDX_ENTRYMETADATA].dwLength, bank.entries))
+            return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+
+        bank.entryTable = bank.entries.data();
+
+        if (segments[HEADER::SEGIDX_SEEKTABLES].dwLength > 0)
+        {
+            if (!read(segments[HEADER::SEGIDX_SEEKTABLES].dwOffset, segments[HEADER::SEGIDX_SEEKTABLES].dwLength, bank.seekTables))
+                return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+
+            bank.seekTable = bank.seekTables.data();
+        }
+
+        if (!segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwLength)
+            return HRESULT_FROM_WIN32(ERROR_NO_DATA);
+
+        if (!read(segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwOffset, segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwLength, bank.waveData))
+            return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+
+        bank.waveTable = bank.waveData.data();
+
+        return S_OK;
+    }
+
+    // Finds the segments in place, as WaveBankReader::OpenMapped does.
+    HRESULT LoadMapped(const uint8_t* base, size_t size, LoadedBank& bank)
+    {
+        return MapSegments(base, size, bank.header, bank.data, bank.nameTable, bank.entryTable, bank.seekTable, bank.waveTable);
+    }
+
+    // WaveBankReader::GetWaveData
+    bool GetWaveData(const LoadedBank& bank, uint32_t index, const uint8_t*& data, uint32_t& size)
+    {
+        DWORD offset, length;
+        if (FAILED(FindWaveData(index, bank.entryTable, bank.header, bank.data, offset, length)))
+            return false;
+
+        data = bank.waveTable + offset;
+        size = length;
+        return true;
+    }
+
+    bool Inside(const void* first, uint64_t bytes, const void* begin, uint64_t size)
+    {
+        auto p = static_cast<const uint8_t*>(first);
+        auto b = static_cast<const uint8_t*>(begin);
+        return p >= b && uint64_t(p - b) + bytes <= size;
+    }
+
+
+    //----------------------------------------------------------------------------------
+    // Holds the bank in a temporary file, and maps it read-only.
+    class MappedFile
+    {
+    public:
+        explicit MappedFile(const std::vector<uint8_t>& contents) : mFile(tmpfile()), mView(nullptr), mSize(contents.size())
+        {
+            if (!mFile || fwrite(contents.data(), 1, mSize, mFile) != mSize || fflush(mFile) != 0)
+            {
+                printf("FAILED: cannot write the test bank\n");
+                exit(1);
+            }
+        }
+
+        ~MappedFile()
+        {
+            Unmap();
+            fclose(mFile);
+        }
+
+        const uint8_t* Map()
+        {
+            void* view = mmap(nullptr, mSize, PROT_READ, MAP_SHARED, fileno(mFile), 0);
+            mView = (view == MAP_FAILED) ? nullptr : static_cast<const uint8_t*>(view);
+            return mView;
+        }
+
+        void Unmap()
+        {
+            if (mView)
+                munmap(const_cast<uint8_t*>(mView), mSize);
+            mView = nullptr;
+        }
+
+        int Descriptor() const { return fileno(mFile); }
+        size_t Size() const { return mSize; }
+
+    private:
+        FILE* mFile;
+        const uint8_t* mView;
+        size_t mSize;
+    };
+
+    // Holds a bank so that it ends at an unreadable page, as a mapped view ends at the end of the file.
+    class GuardedView
+    {
+    public:
+        explicit GuardedView(const std::vector<uint8_t>& contents)
+        {
+            mPage = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+            mCapacity = (contents.size() + mPage - 1) / mPage * mPage;
+
+            void* memory = mmap(nullptr, mCapacity + mPage, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (memory == MAP_FAILED || mprotect(static_cast<uint8_t*>(memory) + mCapacity, mPage, PROT_NONE) != 0)
+            {
+                printf("FAILED: cannot map the guarded view\n");
+                exit(1);
+            }
+
+            mMemory = static_cast<uint8_t*>(memory);
+            mBase = mMemory + mCapacity - contents.size();
+            memcpy(mBase, contents.data(), contents.size());
+        }
+
+        ~GuardedView() { munmap(mMemory, mCapacity + mPage); }
+
+        uint8_t* Base() const { return mBase; }
+
+    private:
+        size_t mPage;
+        size_t mCapacity;
+        uint8_t* mMemory;
+        uint8_t* mBase;
+    };
+
+
+    //----------------------------------------------------------------------------------
+    void TestMappedMatchesBuffered()
+    {
+        const BankOptions banks[] =
+        {
+            { 4, false, true },
+            { 2048, false, false },
+            { 4, true, true },
+            { 2048, true, false },
+        };
+
+        std::mt19937 rng(2018);
+
+        for (const auto& options : banks)
+        {
+            const char* test = options.compact ? "Mapped compact" : "Mapped";
+
+            auto waves = MakeWaves(rng, 40, 20000, options.compact);
+            auto contents = WriteBank(waves, options);
+
+            MappedFile file(contents);
+            const uint8_t* view = file.Map();
+            if (!view)
+            {
+                Check(false, "cannot map the bank", test);
+                continue;
+            }
+
+            LoadedBank mapped;
+            LoadedBank buffered;
+            Check(LoadMapped(view, file.Size(), mapped) == S_OK, "mapped load failed", test);
+            Check(LoadBuffered(contents.data(), contents.size(), buffered) == S_OK, "buffered load failed", test);
+            Check((mapped.nameTable != nullptr) == options.names, "names", test);
+
+            bool same = true;
+            bool inView = true;
+            bool namesMatch = true;
+
+            for (uint32_t j = 0; j < waves.size(); ++j)
+            {
+                const uint8_t* mappedData = nullptr;
+                const uint8_t* bufferedData = nullptr;
+                uint32_t mappedSize = 0, bufferedSize = 0;
+
+                same &= GetWaveData(mapped, j, mappedData, mappedSize) && GetWaveData(buffered, j, bufferedData, bufferedSize);
+                same &= mappedSize == waves[j].data.size() && bufferedSize == waves[j].data.size()
+                    && !memcmp(mappedData, waves[j].data.data(), mappedSize) && !memcmp(bufferedData, waves[j].data.data(), bufferedSize);
+
+                // Zero copy: the wave data is the file's own bytes
+                inView &= mappedData == view + mapped.header.Segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwOffset + (mappedData - mapped.waveTable)
+                    && Inside(mappedData, mappedSize, view, file.Size());
+
+                auto mappedSeek = FindSeekTable(j, mapped.seekTable, mapped.header, mapped.data);
+                auto bufferedSeek = FindSeekTable(j, buffered.seekTable, buffered.header, buffered.data);
+                const auto& expected = waves[j].seekTable;
+                if (expected.empty())
+                {
+                    same &= !mappedSeek && !bufferedSeek;
+                }
+                else
+                {
+                    same &= mappedSeek && bufferedSeek && mappedSeek[0] == expected.size() && bufferedSeek[0] == expected.size()
+                        && std::equal(expected.begin(), expected.end(), mappedSeek + 1)
+                        && std::equal(expected.begin(), expected.end(), bufferedSeek + 1);
+                    inView &= Inside(mappedSeek, sizeof(uint32_t) * (expected.size() + 1), view, file.Size());
+                }
+
+                if (options.names)
+                {
+                    char mappedName[64];
+                    char bufferedName[64];
+                    GetEntryName(j, mapped.nameTable, mapped.data, mappedName);
+                    GetEntryName(j, buffered.nameTable, buffered.data, bufferedName);
+                    namesMatch &= waves[j].name.compare(0, 63, mappedName) == 0 && !strcmp(mappedName, bufferedName);
+                }
+            }
+
+            Check(same, "wave data or seek tables differ", test);
+            Check(inView, "data served from outside the mapping", test);
+            Check(namesMatch, "names differ", test);
+        }
+    }
+
+
+    // Banks that OpenMapped must reject, or whose entries must be refused, rather than hand out a pointer past
+    // the end of a segment.
+    void TestMalformed()
+    {
+        const char* test = "Malformed";
+
+        std::mt19937 rng(7);
+        auto waves = MakeWaves(rng, 6, 3000, false);
+        auto valid = WriteBank(waves, { 4, false, true });
+        auto compact = WriteBank(waves, { 2048, true, false });
+
+        auto header = [](std::vector<uint8_t>& bank) { return reinterpret_cast<HEADER*>(bank.data()); };
+        auto data = [&](std::vector<uint8_t>& bank) { return reinterpret_cast<BANKDATA*>(bank.data() + header(bank)->Segments[HEADER::SEGIDX_BANKDATA].dwOffset); };
+        auto entry = [&](std::vector<uint8_t>& bank, uint32_t index) { return reinterpret_cast<ENTRY*>(bank.data() + header(bank)->Segments[HEADER::SEGIDX_ENTRYMETADATA].dwOffset) + index; };
+        auto compactEntry = [&](std::vector<uint8_t>& bank, uint32_t index) { return reinterpret_cast<ENTRYCOMPACT*>(bank.data() + header(bank)->Segments[HEADER::SEGIDX_ENTRYMETADATA].dwOffset) + index; };
+        auto seekOffsets = [&](std::vector<uint8_t>& bank) { return reinterpret_cast<uint32_t*>(bank.data() + header(bank)->Segments[HEADER::SEGIDX_SEEKTABLES].dwOffset); };
+
+        auto load = [](const std::vector<uint8_t>& bank, LoadedBank& loaded)
+        {
+            return LoadMapped(bank.data(), bank.size(), loaded);
+        };
+
+        auto waveDataFails = [&](const std::vector<uint8_t>& bank, uint32_t index)
+        {
+            LoadedBank loaded;
+            DWORD offset, length;
+            return load(bank, loaded) == S_OK
+                && FindWaveData(index, loaded.entryTable, loaded.header, loaded.data, offset, length) == HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+        };
+
+        // Reads past the seek tables fault when they end the file
+        auto seekTableMissing = [&](const std::vector<uint8_t>& bank, uint32_t index)
+        {
+            GuardedView view(bank);
+            LoadedBank loaded;
+            return LoadMapped(view.Base(), bank.size(), loaded) == S_OK && FindSeekTable(index, loaded.seekTable, loaded.header, loaded.data) == nullptr;
+        };
+
+        auto seekLast = valid;
+        {
+            uint32_t offset = header(seekLast)->Segments[HEADER::SEGIDX_SEEKTABLES].dwOffset;
+            uint32_t length = header(seekLast)->Segments[HEADER::SEGIDX_SEEKTABLES].dwLength;
+            seekLast.insert(seekLast.end(), valid.begin() + offset, valid.begin() + offset + length);
+            header(seekLast)->Segments[HEADER::SEGIDX_SEEKTABLES].dwOffset = uint32_t(valid.size());
+        }
+
+        LoadedBank loaded;
+
+        {
+            auto bank = valid;
+            header(bank)->dwSignature = HEADER::BE_SIGNATURE;
+            Check(load(bank, loaded) == S_FALSE, "big-endian bank not left to Open", test);
+        }
+
+        {
+            auto bank = valid;
+            bank.pop_back();
+            Check(load(bank, loaded) == HRESULT_FROM_WIN32(ERROR_HANDLE_EOF), "truncated bank", test);
+
+            bank.resize(sizeof(HEADER) - 1);
+            Check(load(bank, loaded) == E_FAIL, "bank shorter than its header", test);
+        }
+
+        {
+            // The sum wraps around in 32 bits
+            auto bank = valid;
+            entry(bank, 2)->PlayRegion = { 0xFFFFFF00, 0x200 };
+            Check(waveDataFails(bank, 2), "play region wrapping around", test);
+
+            bank = valid;
+            entry(bank, 5)->PlayRegion.dwLength = header(bank)->Segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwLength - entry(bank, 5)->PlayRegion.dwOffset + 1;
+            Check(waveDataFails(bank, 5), "play region past the segment", test);
+        }
+
+        {
+            // Offsets out of order make the length underflow
+            auto bank = compact;
+            compactEntry(bank, 3)->dwOffset = compactEntry(bank, 4)->dwOffset + 1;
+            Check(waveDataFails(bank, 3), "compact entry past the next", test);
+
+            bank = compact;
+            compactEntry(bank, 5)->dwLengthDeviation = 2047;
+            compactEntry(bank, 5)->dwOffset = header(bank)->Segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwLength / 2048;
+            Check(waveDataFails(bank, 5), "last compact entry past the segment", test);
+
+            // Offsets in units of 4096 bytes could overflow 32 bits
+            bank = compact;
+            data(bank)->dwAlignment = 4096;
+            Check(load(bank, loaded) == E_FAIL, "compact alignment over 2048", test);
+        }
+
+        {
+            // 0x40000001 entries of 4 bytes wrap around to one entry in 32 bits
+            auto bank = compact;
+            data(bank)->dwEntryCount = 0x40000001;
+            header(bank)->Segments[HEADER::SEGIDX_ENTRYMETADATA].dwLength = 4;
+            Check(load(bank, loaded) == E_FAIL, "entry count overflowing the metadata size", test);
+        }
+
+        {
+            // The last table in the segment
+            auto bank = seekLast;
+            auto seekTable = reinterpret_cast<uint32_t*>(reinterpret_cast<uint8_t*>(seekOffsets(bank)) + sizeof(uint32_t) * waves.size() + seekOffsets(bank)[5]);
+            *seekTable += 1;
+            Check(seekTableMissing(bank, 5), "seek table running past the segment", test);
+
+            bank = seekLast;
+            seekOffsets(bank)[3] = header(bank)->Segments[HEADER::SEGIDX_SEEKTABLES].dwLength - sizeof(uint32_t) * uint32_t(waves.size());
+            Check(seekTableMissing(bank, 3), "seek table at the end of the segment", test);
+
+            // Wraps around in 32 bits onto the offset of entry 3's table, which reads as a short table
+            bank = seekLast;
+            seekOffsets(bank)[5] = sizeof(uint32_t) * 3 - sizeof(uint32_t) * uint32_t(waves.size());
+            Check(seekTableMissing(bank, 5), "seek table offset wrapping around", test);
+
+            // Too short for the offsets of the tables
+            bank = seekLast;
+            header(bank)->Segments[HEADER::SEGIDX_SEEKTABLES].dwLength = sizeof(uint32_t) * 3;
+            bank.resize(header(bank)->Segments[HEADER::SEGIDX_SEEKTABLES].dwOffset + sizeof(uint32_t) * 3);
+            Check(seekTableMissing(bank, 5), "seek table segment shorter than its offsets", test);
+        }
+
+        {
+            // A name that fills its element is cut at the element, not read on into the next segment
+            auto bank = valid;
+            data(bank)->dwEntryNameElementSize = 8;
+            memset(bank.data() + header(bank)->Segments[HEADER::SEGIDX_ENTRYNAMES].dwOffset, 'x', header(bank)->Segments[HEADER::SEGIDX_ENTRYNAMES].dwLength);
+            Check(load(bank, loaded) == S_OK && loaded.nameTable, "narrow names", test);
+
+            char name[64];
+            GetEntryName(5, loaded.nameTable, loaded.data, name);
+            Check(strlen(name) == 8, "name read past its element", test);
+
+            bank = valid;
+            header(bank)->Segments[HEADER::SEGIDX_ENTRYNAMES].dwLength = 64 * uint32_t(waves.size()) - 1;
+            Check(load(bank, loaded) == S_OK && !loaded.nameTable, "names segment too short for its names", test);
+        }
+
+        {
+            auto bank = valid;
+            header(bank)->Segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwLength += 1;
+            Check(load(bank, loaded) == HRESULT_FROM_WIN32(ERROR_HANDLE_EOF), "wave data past the end of the file", test);
+
+            bank = valid;
+            header(bank)->Segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwLength = 0;
+            Check(load(bank, loaded) == HRESULT_FROM_WIN32(ERROR_NO_DATA), "bank without wave data", test);
+
+            bank = valid;
+            header(bank)->Segments[HEADER::SEGIDX_BANKDATA].dwOffset = uint32_t(bank.size()) - 8;
+            header(bank)->Segments[HEADER::SEGIDX_BANKDATA].dwLength = 8;
+            Check(load(bank, loaded) == HRESULT_FROM_WIN32(ERROR_HANDLE_EOF), "bank data past the end of the file", test);
+        }
+    }
+
+
+    // Reads every entry of a loaded bank as WaveBankReader would, checking each range lies in its segment.
+    // Returns false if a range does not.
+    bool ReadEntries(const LoadedBank& bank, const void* file, uint64_t fileSize, uint32_t& checksum)
+    {
+        bool inside = true;
+
+        const auto& segments = bank.header.Segments;
+        const void* waveBegin = bank.waveTable;
+        const void* seekBegin = bank.seekTable;
+        if (!bank.waveData.empty() || !bank.seekTables.empty() || !bank.entries.empty())
+        {
+            file = nullptr;
+        }
+
+        for (uint32_t j = 0; j < bank.data.dwEntryCount; ++j)
+        {
+            const uint8_t* data;
+            uint32_t size;
+            if (GetWaveData(bank, j, data, size))
+            {
+                inside &= Inside(data, size, waveBegin, segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwLength);
+                if (file)
+                    inside &= Inside(data, size, file, fileSize);
+
+                for (uint32_t k = 0; k < size; k += 97)
+                    checksum += data[k];
+                if (size)
+                    checksum += data[size - 1];
+            }
+
+            auto seekTable = FindSeekTable(j, bank.seekTable, bank.header, bank.data);
+            if (seekTable)
+            {
+                inside &= Inside(seekTable, sizeof(uint32_t) * (uint64_t(seekTable[0]) + 1), seekBegin, segments[HEADER::SEGIDX_SEEKTABLES].dwLength);
+
+                for (uint32_t k = 0; k <= seekTable[0]; ++k)
+                    checksum += seekTable[k];
+            }
+
+            if (bank.nameTable)
+            {
+                char name[64];
+                GetEntryName(j, bank.nameTable, bank.data, name);
+                checksum += static_cast<uint32_t>(strlen(name));
+            }
+        }
+
+        return inside;
+    }
+
+    // Corrupts the metadata of valid banks at random. Any read outside the guarded view faults.
+    void TestCorruptMetadata()
+    {
+        const char* test = "Corrupt metadata";
+
+        std::mt19937 rng(44);
+
+        const BankOptions banks[] = { { 4, false, true }, { 2048, true, true } };
+        for (const auto& options : banks)
+        {
+            auto original = WriteBank(MakeWaves(rng, 16, 2000, options.compact), options);
+            auto metadataEnd = reinterpret_cast<const HEADER*>(original.data())->Segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwOffset;
+
+            GuardedView view(original);
+            auto bank = original;
+
+            const uint32_t special[] = { 0, 1, 4, 0x7FFFFFFF, 0x80000000, 0xFFFFFF00, 0xFFFFFFFF, uint32_t(original.size()), uint32_t(original.size() - 4) };
+
+            size_t accepted = 0;
+            bool inside = true;
+            uint32_t checksum = 0;
+
+            for (int iteration = 0; iteration < 20000; ++iteration)
+            {
+                memcpy(bank.data(), original.data(), metadataEnd);
+
+                for (int mutations = std::uniform_int_distribution<int>(1, 4)(rng); mutations > 0; --mutations)
+                {
+                    if (rng() % 2)
+                    {
+                        bank[std::uniform_int_distribution<uint32_t>(0, metadataEnd - 1)(rng)] = static_cast<uint8_t>(rng());
+                    }
+                    else
+                    {
+                        uint32_t value = (rng() % 4) ? special[rng() % _countof(special)] : static_cast<uint32_t>(rng());
+                        memcpy(bank.data() + std::uniform_int_distribution<uint32_t>(0, metadataEnd / 4 - 1)(rng) * 4, &value, sizeof(value));
+                    }
+                }
+
+                memcpy(view.Base(), bank.data(), metadataEnd);
+
+                LoadedBank mapped;
+                if (LoadMapped(view.Base(), bank.size(), mapped) == S_OK)
+                {
+                    inside &= ReadEntries(mapped, view.Base(), bank.size(), checksum);
+                    ++accepted;
+                }
+
+                LoadedBank buffered;
+                if (LoadBuffered(bank.data(), bank.size(), buffered) == S_OK)
+                {
+                    inside &= ReadEntries(buffered, nullptr, 0, checksum);
+                }
+            }
+
+            Check(inside, "entry read outside its segment", test);
+            Check(accepted > 1000, "too few corrupt banks accepted to exercise the lookups", test);
+        }
+    }
+
+
+    //----------------------------------------------------------------------------------
+    // Resident memory of the process, in bytes.
+    struct Resident
+    {
+        uint64_t anonymous;     // Private memory, such as buffers read into
+        uint64_t file;          // Pages of mapped files, shared with the page cache
+    };
+
+    Resident GetResident()
+    {
+        Resident resident = {};
+
+        FILE* status = fopen("/proc/self/status", "r");
+        if (status)
+        {
+            char line[256];
+            while (fgets(line, sizeof(line), status))
+            {
+                unsigned long long kb;
+                if (sscanf(line, "RssAnon: %llu kB", &kb) == 1)
+                    resident.anonymous = kb * 1024;
+                else if (sscanf(line, "RssFile: %llu kB", &kb) == 1)
+                    resident.file = kb * 1024;
+            }
+            fclose(status);
+        }
+
+        return resident;
+    }
+
+    double Megabytes(uint64_t bytes)
+    {
+        return double(bytes) / (1024 * 1024);
+    }
+
+    // A 256 MB bank of 1,000 waves, opened and then 10 of its waves played.
+    void ReportLoad()
+    {
+        std::mt19937 rng(1);
+        auto contents = WriteBank(MakeWaves(rng, 1000, 2 * 256 * 1024, false), { 4, false, true });
+
+        MappedFile file(contents);
+        contents.clear();
+        contents.shrink_to_fit();
+
+        const uint32_t played[] = { 3, 101, 202, 303, 404, 505, 606, 707, 808, 909 };
+        uint32_t checksum = 0;
+
+        auto play = [&](const LoadedBank& bank)
+        {
+            for (auto index : played)
+            {
+                const uint8_t* data;
+                uint32_t size;
+                if (GetWaveData(bank, index, data, size))
+                {
+                    for (uint32_t k = 0; k < size; k += 64)
+                        checksum += data[k];
+                }
+            }
+        };
+
+        // Open reads the metadata segments, then the whole wave data segment into a buffer
+        Resident before = GetResident();
+        auto start = std::chrono::steady_clock::now();
+
+        std::vector<uint8_t> image(file.Size());
+        if (pread(file.Descriptor(), image.data(), image.size(), 0) != ssize_t(image.size()))
+        {
+            Check(false, "cannot read the bank", "Report");
+            return;
+        }
+
+        LoadedBank buffered;
+        Check(LoadBuffered(image.data(), image.size(), buffered) == S_OK, "buffered load failed", "Report");
+        image.clear();
+        image.shrink_to_fit();
+
+        double bufferedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        play(buffered);
+        Resident afterBuffered = GetResident();
+
+        buffered = LoadedBank();
+
+        // OpenMapped
+        Resident beforeMapped = GetResident();
+        start = std::chrono::steady_clock::now();
+
+        const uint8_t* view = file.Map();
+        LoadedBank mapped;
+        Check(view && LoadMapped(view, file.Size(), mapped) == S_OK, "mapped load failed", "Report");
+
+        double mappedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        Resident afterOpen = GetResident();
+        play(mapped);
+        Resident afterPlay = GetResident();
+
+        printf("%.0f MB bank from the page cache, 1000 waves, 10 of them played:\n", Megabytes(file.Size()));
+        printf("  buffered open %8.3f ms, %6.1f MB private\n",
+            bufferedMs, Megabytes(afterBuffered.anonymous - before.anonymous));
+        printf("  mapped open   %8.3f ms, %6.1f MB private, %5.1f MB of the file resident after open, %5.1f MB after playing\n",
+            mappedMs, Megabytes(afterPlay.anonymous > beforeMapped.anonymous ? afterPlay.anonymous - beforeMapped.anonymous : 0),
+            Megabytes(afterOpen.file - beforeMapped.file), Megabytes(afterPlay.file - beforeMapped.file));
+
+        file.Unmap();
+
+        if (checksum == 1)
+            printf("\n");
+    }
+}
+
+
+int main()
+{
+    TestMappedMatchesBuffered();
+    TestMalformed();
+    TestCorruptMetadata();
+
+    ReportLoad();
+
+    if (g_failures)
+    {
+        printf("%d checks failed\n", g_failures);
+        return 1;
+    }
+
+    printf("WaveBankLayout tests passed\n");
+    return 0;
+}
@@ -0,0 +1,233 @@
+//--------------------------------------------------------------------------------------
+// File: IncrementalBuild.h
+//
+// The sidecar manifest of incremental xwbtool builds (-inc), and the decisions made from
+// it: which payloads of the existing wave bank are kept, whether the bank is patched in
+// place, and which writes and copies produce the wave data segment. This has no Win32
+// dependencies, so the result can be checked against a clean build on any platform.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <unordered_map>
+#include <vector>
+
+
+namespace XWBTool
+{
+    struct MANIFESTHEADER
+    {
+        static const uint32_t SIGNATURE = 0x4D425758; // 'XWBM'
+        static const uint32_t VERSION = 1;
+
+        uint32_t    dwSignature;
+        uint32_t    dwVersion;
+        uint32_t    dwEntryCount;
+        uint32_t    dwAlignment;
+        uint32_t    dwDataOffset;       // Offset of the wave data segment in the bank
+        uint32_t    dwBankSize;         // Size of the bank file when the manifest was written
+        uint64_t    BankWriteTime;      // Last write time of the bank when the manifest was written (a FILETIME)
+    };
+
+    struct MANIFESTENTRY
+    {
+        uint64_t    pathHash;           // FNV-1a of the upper-cased source path
+        uint64_t    contentHash;        // FNV-1a of the wave payload
+        uint64_t    sourceSize;
+        uint64_t    SourceWriteTime;    // A FILETIME
+        uint32_t    dwFormat;           // MINIWAVEFORMAT
+        uint32_t    dwOffset;           // Offset of the payload within the wave data segment
+        uint32_t    dwLength;           // Length of the payload, not including alignment padding
+        uint32_t    dwReserved;
+    };
+
+    static_assert(sizeof(MANIFESTHEADER) == 32, "Manifest header size changed");
+    static_assert(sizeof(MANIFESTENTRY) == 48, "Manifest entry size changed");
+
+    const size_t NO_REUSE = SIZE_MAX;
+
+    inline uint64_t AlignedLength(uint64_t length, uint32_t alignment)
+    {
+        return ((length + alignment - 1) / alignment) * alignment;
+    }
+
+    // Size of the wave data segment the entries describe.
+    inline uint64_t WaveDataLength(const std::vector<MANIFESTENTRY>& entries, uint32_t alignment)
+    {
+        return entries.empty() ? 0 : entries.back().dwOffset + AlignedLength(entries.back().dwLength, alignment);
+    }
+
+
+    // Sources whose path, size, write time and payload length are unchanged keep the content hash of the
+    // previous build. Returns the entries whose sources must be hashed again.
+    inline std::vector<size_t> CarryContentHashes(const std::vector<MANIFESTENTRY>& oldEntries, std::vector<MANIFESTENTRY>& newEntries)
+    {
+        std::unordered_map<uint64_t, size_t> oldByPath;
+        for (size_t j = 0; j < oldEntries.size(); ++j)
+        {
+            oldByPath.emplace(oldEntries[j].pathHash, j);
+        }
+
+        std::vector<size_t> rehash;
+
+        for (size_t j = 0; j < newEntries.size(); ++j)
+        {
+            auto& entry = newEntries[j];
+
+            auto pit = oldByPath.find(entry.pathHash);
+            if (pit != oldByPath.end()
+                && oldEntries[pit->second].sourceSize == entry.sourceSize
+                && oldEntries[pit->second].dwLength == entry.dwLength
+                && oldEntries[pit->second].SourceWriteTime == entry.SourceWriteTime)
+            {
+                entry.contentHash = oldEntries[pit->second].contentHash;
+            }
+            else
+            {
+                rehash.push_back(j);
+            }
+        }
+
+        return rehash;
+    }
+
+
+    // Finds the payloads of the existing bank that the new one can keep: reuse[j] is the old entry holding
+    // the payload of new entry j, or NO_REUSE. When no payload moves and the data segment stays put, the
+    // bank is patched in place. The format is compared too, since -adpcm stores the same source differently.
+    // Returns the number of payloads kept.
+    inline size_t MatchPayloads(
+        const MANIFESTHEADER& oldHeader, const std::vector<MANIFESTENTRY>& oldEntries,
+        const MANIFESTHEADER& newHeader, const std::vector<MANIFESTENTRY>& newEntries,
+        std::vector<size_t>& reuse, bool& inPlace)
+    {
+        reuse.assign(newEntries.size(), NO_REUSE);
+        inPlace = false;
+
+        if (oldEntries.empty() || oldHeader.dwAlignment != newHeader.dwAlignment)
+            return 0;
+
+        size_t reused = 0;
+
+        inPlace = (oldEntries.size() == newEntries.size())
+            && (oldHeader.dwDataOffset == newHeader.dwDataOffset)
+            && (uint64_t(oldHeader.dwBankSize) == newHeader.dwDataOffset + WaveDataLength(newEntries, newHeader.dwAlignment));
+
+        for (size_t j = 0; inPlace && j < newEntries.size(); ++j)
+        {
+            inPlace = (oldEntries[j].dwOffset == newEntries[j].dwOffset)
+                && (oldEntries[j].dwLength == newEntries[j].dwLength);
+        }
+
+        if (inPlace)
+        {
+            for (size_t j = 0; j < newEntries.size(); ++j)
+            {
+                if (oldEntries[j].contentHash == newEntries[j].contentHash
+                    && oldEntries[j].dwFormat == newEntries[j].dwFormat)
+                {
+                    reuse[j] = j;
+                    ++reused;
+                }
+            }
+        }
+        else
+        {
+            // Otherwise unchanged payloads are copied from the existing bank into a new one
+            std::unordered_map<uint64_t, size_t> oldByContent;
+            for (size_t j = 0; j < oldEntries.size(); ++j)
+            {
+                oldByContent.emplace(oldEntries[j].contentHash, j);
+            }
+
+            for (size_t j = 0; j < newEntries.size(); ++j)
+            {
+                auto cit = oldByContent.find(newEntries[j].contentHash);
+                if (cit != oldByContent.end()
+                    && oldEntries[cit->second].dwLength == newEntries[j].dwLength
+                    && oldEntries[cit->second].dwFormat == newEntries[j].dwFormat)
+                {
+                    reuse[j] = cit->second;
+                    ++reused;
+                }
+            }
+        }
+
+        return reused;
+    }
+
+
+    enum WAVEDATA_SOURCE
+    {
+        WAVEDATA_NEW = 0,   // Written from the source file, or its -adpcm or -pcm conversion
+        WAVEDATA_COPY,      // Copied from the existing bank
+        WAVEDATA_KEEP,      // Already in place in the existing bank
+    };
+
+    // One write of the wave data segment, covering count entries from entry on. Offsets are relative to the
+    // start of the segment, and lengths include the alignment padding.
+    struct WAVEDATAWRITE
+    {
+        WAVEDATA_SOURCE source;
+        size_t          entry;
+        size_t          count;
+        uint64_t        offset;
+        uint64_t        oldOffset;      // Where a copy comes from in the existing bank's segment
+        uint64_t        length;
+    };
+
+    // Plans the writes of the wave data segment. Payloads stored back to back in the existing bank are copied
+    // with a single sequential copy. reuse is empty for a build that is not incremental.
+    inline std::vector<WAVEDATAWRITE> PlanWaveData(
+        const std::vector<MANIFESTENTRY>& newEntries, const std::vector<MANIFESTENTRY>& oldEntries,
+        const std::vector<size_t>& reuse, bool inPlace, uint32_t alignment)
+    {
+        std::vector<WAVEDATAWRITE> writes;
+
+        for (size_t j = 0; j < newEntries.size(); )
+        {
+            WAVEDATAWRITE write = {};
+            write.entry = j;
+            write.count = 1;
+            write.offset = newEntries[j].dwOffset;
+            write.length = AlignedLength(newEntries[j].dwLength, alignment);
+
+            if (reuse.empty() || reuse[j] == NO_REUSE)
+            {
+                write.source = WAVEDATA_NEW;
+            }
+            else if (inPlace)
+            {
+                write.source = WAVEDATA_KEEP;
+            }
+            else
+            {
+                write.source = WAVEDATA_COPY;
+                write.oldOffset = oldEntries[reuse[j]].dwOffset;
+
+                while (j + write.count < newEntries.size() && reuse[j + write.count] != NO_REUSE)
+                {
+                    const auto& next = oldEntries[reuse[j + write.count]];
+                    if (next.dwOffset != write.oldOffset + write.length)
+                        break;
+
+                    write.length += AlignedLength(next.dwLength, alignment);
+                    ++write.count;
+                }
+            }
+
+            writes.push_back(write);
+            j += write.count;
+        }
+
+        return writes;
+    }
+}
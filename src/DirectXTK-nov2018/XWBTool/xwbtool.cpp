@@ -3,7 +3,8 @@
 //
 // Simple command-line tool for building wave banks from 1 or more .WAV files. This
 // generates binary wave banks compliant with XACT 3's Wave Bank .XWB format. The
-// .WAV files are not format converted or compressed.
+// .WAV files are not format converted, except that -adpcm compresses 16-bit PCM
+// to MS-ADPCM and -pcm decompresses MS-ADPCM to 16-bit PCM.
 //
 // For a more full-featured builder, see XACT 3 and the XACTBLD tool in the legacy
 // DirectX SDK (June 2010) release.
@@ -36,10 +37,17 @@
 #include <fstream>
 #include <list>
 #include <memory>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include <ppl.h>
+
+#include "ADPCMCodec.h"
 #include "WAVFileReader.h"
 
+#include "IncrementalBuild.h"
+
 #ifdef __INTEL_COMPILER
 #pragma warning(disable : 161)
 // warning #161: unrecognized #pragma
@@ -125,6 +133,9 @@ namespace
 
     static const size_t ENTRYNAME_LENGTH = 64;
 
+    // Block size used by -adpcm; the miniformat can describe 32 to 542 samples per block
+    static const uint32_t ADPCM_SAMPLES_PER_BLOCK = 128;
+
     struct REGION
     {
         uint32_t    dwOffset;   // Region offset, in bytes.
@@ -269,6 +280,8 @@ namespace
     static_assert(sizeof(ENTRYCOMPACT) == 4, "Mismatch with xact3wb.h");
     static_assert(sizeof(BANKDATA) == 96, "Mismatch with xact3wb.h");
 
+    static_assert(sizeof(MINIWAVEFORMAT) == sizeof(XWBTool::MANIFESTENTRY::dwFormat), "Manifest format size changed");
+
     template <typename T> WORD ChannelsSpecifiedInMask(T x)
     {
         WORD bitCount = 0;
@@ -798,6 +811,10 @@ enum OPTIONS
     OPT_FRIENDLY_NAMES,
     OPT_NOLOGO,
     OPT_FILELIST,
+    OPT_TIMING,
+    OPT_INCREMENTAL,
+    OPT_ADPCM,
+    OPT_PCM,
     OPT_MAX
 };
 
@@ -816,15 +833,30 @@ struct SValue
 
 struct WaveFile
 {
-    DirectX::WAVData data;
+    DirectX::WAVData data;              // startAudio is null; the payload stays in the source file
     size_t conv;
     MINIWAVEFORMAT miniFmt;
-    std::unique_ptr<uint8_t[]> waveData;
+    uint64_t audioOffset;               // Location of the payload in the source file
+    uint32_t sourceBytes;               // Length of the payload in the source file
+    size_t adpcmFrames;                 // PCM frames compressed by -adpcm, or zero when stored as is
+    size_t pcmFrames;                   // PCM frames decompressed by -pcm, or zero when stored as is
+    uint64_t sourceSize;
+    FILETIME sourceWriteTime;
+    std::unique_ptr<uint8_t[]> format;
+    std::unique_ptr<uint8_t[]> sourceFormat; // Format of the source payload when -pcm decompresses it
+    std::vector<uint32_t> seekTable;
+    std::unique_ptr<uint8_t[]> encoded; // Converted payload, written instead of the source data and released once written
 
     WaveFile() noexcept :
         data{},
         conv(0),
-        miniFmt{}
+        miniFmt{},
+        audioOffset(0),
+        sourceBytes(0),
+        adpcmFrames(0),
+        pcmFrames(0),
+        sourceSize(0),
+        sourceWriteTime{}
         {}
 
     WaveFile(WaveFile&&) = default;
@@ -833,6 +865,18 @@ struct WaveFile
 
 namespace
 {
+    // Must match DirectX::WaveBankNameHash in Audio.h (FNV-1a)
+    uint32_t EntryNameHash(_In_z_ const char* name)
+    {
+        uint32_t hash = 2166136261u;
+        for (const char* c = name; *c != 0; ++c)
+        {
+            hash ^= static_cast<uint8_t>(*c);
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
     void FileNameToIdentifier(_Inout_updates_all_(count) wchar_t* str, size_t count)
     {
         size_t j = 0;
@@ -862,6 +906,10 @@ const SValue g_pOptions [] =
     { L"f",         OPT_FRIENDLY_NAMES },
     { L"nologo",    OPT_NOLOGO },
     { L"flist",     OPT_FILELIST },
+    { L"timing",    OPT_TIMING },
+    { L"inc",       OPT_INCREMENTAL },
+    { L"adpcm",     OPT_ADPCM },
+    { L"pcm",       OPT_PCM },
     { nullptr,      0 }
 };
 
@@ -993,13 +1041,19 @@ namespace
         wprintf(L"   -s                  creates a streaming wave bank,\n");
         wprintf(L"                       otherwise an in-memory bank is created\n");
         wprintf(L"   -o <filename>       output filename\n");
-        wprintf(L"   -h <h-filename>     output C/C++ header\n");
+        wprintf(L"   -h <h-filename>     output C/C++ header,\n");
+        wprintf(L"                       with entry name hashes when used with -f\n");
         wprintf(L"   -n                  do not overwrite output\n");
         wprintf(L"   -c                  force creation of compact wavebank\n");
         wprintf(L"   -nc                 force creation of non-compact wavebank\n");
         wprintf(L"   -f                  include entry friendly names\n");
         wprintf(L"   -nologo             suppress copyright message\n");
         wprintf(L"   -flist <filename>   use text file with a list of input files (one per line)\n");
+        wprintf(L"   -timing             report the time spent in each build phase\n");
+        wprintf(L"   -inc                incremental build, reusing unchanged audio from the\n");
+        wprintf(L"                       existing output (tracked in <filename>.manifest)\n");
+        wprintf(L"   -adpcm              compress 16-bit PCM waves to MS-ADPCM\n");
+        wprintf(L"   -pcm                decompress MS-ADPCM waves to 16-bit PCM\n");
     }
 
     const char* GetFormatTagName(WORD wFormatTag)
@@ -1057,6 +1111,377 @@ namespace
 
         return false;
     }
+
+    // Parses a .wav from its RIFF chunk headers. The audio payload is skipped, and is not read until the bank is written.
+    HRESULT LoadWaveHeaders(_In_z_ const wchar_t* szFile, WaveFile& wave)
+    {
+        WIN32_FILE_ATTRIBUTE_DATA fileAttr = {};
+        if (!GetFileAttributesExW(szFile, GetFileExInfoStandard, &fileAttr))
+            return HRESULT_FROM_WIN32(GetLastError());
+
+        wave.sourceSize = (uint64_t(fileAttr.nFileSizeHigh) << 32) | fileAttr.nFileSizeLow;
+        wave.sourceWriteTime = fileAttr.ftLastWriteTime;
+
+        std::unique_ptr<uint8_t[]> wavData;
+        DirectX::WAVData data = {};
+        uint32_t audioOffset = 0;
+        HRESULT hr = DirectX::LoadWAVAudioHeaderFromFile(szFile, wavData, data, &audioOffset);
+        if (FAILED(hr))
+            return hr;
+
+        // Copy the format and seek table out of the header buffer, which is released on return.
+        // The loader checks cbSize against the 'fmt ' chunk for every tag except PCM and IEEE float, which
+        // carry no extra bytes; their cbSize is not trusted, as the buffer only holds a WAVEFORMATEX.
+        bool plainFormat = (data.wfx->wFormatTag == WAVE_FORMAT_PCM || data.wfx->wFormatTag == WAVE_FORMAT_IEEE_FLOAT);
+
+        size_t formatBytes = sizeof(WAVEFORMATEX);
+        if (!plainFormat)
+            formatBytes += data.wfx->cbSize;
+
+        wave.format.reset(new uint8_t[formatBytes]);
+        memcpy(wave.format.get(), data.wfx, formatBytes);
+
+        auto wfx = reinterpret_cast<WAVEFORMATEX*>(wave.format.get());
+        if (plainFormat)
+            wfx->cbSize = 0;
+
+        if (data.seek && data.seekCount > 0)
+            wave.seekTable.assign(data.seek, data.seek + data.seekCount);
+
+        wave.audioOffset = audioOffset;
+        wave.sourceBytes = data.audioBytes;
+
+        wave.data = data;
+        wave.data.wfx = wfx;
+        wave.data.startAudio = nullptr;
+        wave.data.seek = wave.seekTable.empty() ? nullptr : wave.seekTable.data();
+
+        return S_OK;
+    }
+
+    // Streams a wave's payload from its source file to the current position of the output file.
+    bool CopyWaveData(HANDLE hOutput, const WaveFile& wave, _In_z_ const wchar_t* szSource, _Out_writes_bytes_(bufferSize) uint8_t* buffer, DWORD bufferSize)
+    {
+        ScopedHandle hSource(safe_handle(CreateFileW(szSource, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr)));
+        if (!hSource)
+            return false;
+
+        LARGE_INTEGER offset;
+        offset.QuadPart = static_cast<LONGLONG>(wave.audioOffset);
+        if (!SetFilePointerEx(hSource.get(), offset, nullptr, FILE_BEGIN))
+            return false;
+
+        DWORD remaining = wave.sourceBytes;
+        while (remaining > 0)
+        {
+            DWORD chunk = std::min(remaining, bufferSize);
+
+            DWORD bytesRead;
+            if (!ReadFile(hSource.get(), buffer, chunk, &bytesRead, nullptr) || bytesRead != chunk)
+                return false;
+
+            DWORD bytesWritten;
+            if (!WriteFile(hOutput, buffer, chunk, &bytesWritten, nullptr) || bytesWritten != chunk)
+                return false;
+
+            remaining -= chunk;
+        }
+
+        return true;
+    }
+
+    //----------------------------------------------------------------------------------
+    // Incremental build support
+    //----------------------------------------------------------------------------------
+    const uint64_t FNV64_OFFSET_BASIS = 14695981039346656037ull;
+    const uint64_t FNV64_PRIME = 1099511628211ull;
+
+    uint64_t HashBytes(_In_reads_bytes_(size) const uint8_t* data, size_t size, uint64_t hash)
+    {
+        for (size_t j = 0; j < size; ++j)
+        {
+            hash ^= data[j];
+            hash *= FNV64_PRIME;
+        }
+        return hash;
+    }
+
+    uint64_t HashPath(_In_z_ const wchar_t* path)
+    {
+        uint64_t hash = FNV64_OFFSET_BASIS;
+        for (const wchar_t* c = path; *c != 0; ++c)
+        {
+            wchar_t t = towupper(*c);
+            if (t == L'/')
+                t = L'\\';
+
+            hash = HashBytes(reinterpret_cast<const uint8_t*>(&t), sizeof(wchar_t), hash);
+        }
+        return hash;
+    }
+
+    // Hashes a wave's payload in its source file.
+    bool HashWaveData(const WaveFile& wave, _In_z_ const wchar_t* szSource, _Out_writes_bytes_(bufferSize) uint8_t* buffer, DWORD bufferSize, uint64_t& hash)
+    {
+        ScopedHandle hSource(safe_handle(CreateFileW(szSource, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr)));
+        if (!hSource)
+            return false;
+
+        LARGE_INTEGER offset;
+        offset.QuadPart = static_cast<LONGLONG>(wave.audioOffset);
+        if (!SetFilePointerEx(hSource.get(), offset, nullptr, FILE_BEGIN))
+            return false;
+
+        hash = FNV64_OFFSET_BASIS;
+
+        DWORD remaining = wave.sourceBytes;
+        while (remaining > 0)
+        {
+            DWORD chunk = std::min(remaining, bufferSize);
+
+            DWORD bytesRead;
+            if (!ReadFile(hSource.get(), buffer, chunk, &bytesRead, nullptr) || bytesRead != chunk)
+                return false;
+
+            hash = HashBytes(buffer, chunk, hash);
+
+            remaining -= chunk;
+        }
+
+        return true;
+    }
+
+    // Switches a 16-bit PCM wave to MS-ADPCM. The payload is encoded later, once it is known to be needed.
+    bool ConvertToADPCM(WaveFile& wave)
+    {
+        auto pcmFormat = wave.data.wfx;
+        size_t frames = wave.sourceBytes / pcmFormat->nBlockAlign;
+
+        std::unique_ptr<uint8_t[]> format(new uint8_t[sizeof(WAVEFORMATEX) + 32 /*MSADPCM_FORMAT_EXTRA_BYTES*/]);
+        auto wfx = reinterpret_cast<WAVEFORMATEX*>(format.get());
+
+        if (FAILED(DirectX::ADPCMCreateFormat(wfx, sizeof(WAVEFORMATEX) + 32, pcmFormat->nSamplesPerSec, pcmFormat->nChannels, ADPCM_SAMPLES_PER_BLOCK)))
+            return false;
+
+        size_t encodedBytes = DirectX::ADPCMGetEncodedSize(wfx, frames);
+        if (encodedBytes > UINT32_MAX)
+            return false;
+
+        wave.format = std::move(format);
+        wave.data.wfx = wfx;
+        wave.data.audioBytes = uint32_t(encodedBytes);
+        wave.adpcmFrames = frames;
+
+        return true;
+    }
+
+    // Reads a wave's PCM payload from its source file and compresses it into wave.encoded.
+    HRESULT EncodeWaveADPCM(WaveFile& wave, _In_z_ const wchar_t* szSource)
+    {
+        ScopedHandle hSource(safe_handle(CreateFileW(szSource, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr)));
+        if (!hSource)
+            return HRESULT_FROM_WIN32(GetLastError());
+
+        LARGE_INTEGER offset;
+        offset.QuadPart = static_cast<LONGLONG>(wave.audioOffset);
+        if (!SetFilePointerEx(hSource.get(), offset, nullptr, FILE_BEGIN))
+            return HRESULT_FROM_WIN32(GetLastError());
+
+        size_t samples = wave.adpcmFrames * wave.data.wfx->nChannels;
+
+        std::unique_ptr<int16_t[]> pcm(new (std::nothrow) int16_t[samples]);
+        std::unique_ptr<uint8_t[]> encoded(new (std::nothrow) uint8_t[wave.data.audioBytes]);
+        if (!pcm || !encoded)
+            return E_OUTOFMEMORY;
+
+        DWORD pcmBytes = DWORD(samples * sizeof(int16_t));
+
+        DWORD bytesRead;
+        if (!ReadFile(hSource.get(), pcm.get(), pcmBytes, &bytesRead, nullptr))
+            return HRESULT_FROM_WIN32(GetLastError());
+
+        if (bytesRead != pcmBytes)
+            return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+
+        HRESULT hr = DirectX::ADPCMEncode(wave.data.wfx, pcm.get(), wave.adpcmFrames, encoded.get(), wave.data.audioBytes);
+        if (FAILED(hr))
+            return hr;
+
+        wave.encoded = std::move(encoded);
+
+        return S_OK;
+    }
+
+    // Switches an MS-ADPCM wave to 16-bit PCM. The payload is decoded later, once it is known to be needed.
+    bool ConvertToPCM(WaveFile& wave)
+    {
+        auto adpcmFormat = wave.data.wfx;
+        size_t frames = DirectX::ADPCMGetDecodedFrames(adpcmFormat, wave.sourceBytes);
+
+        std::unique_ptr<uint8_t[]> format(new uint8_t[sizeof(WAVEFORMATEX)]);
+        auto wfx = reinterpret_cast<WAVEFORMATEX*>(format.get());
+
+        wfx->wFormatTag = WAVE_FORMAT_PCM;
+        wfx->nChannels = adpcmFormat->nChannels;
+        wfx->nSamplesPerSec = adpcmFormat->nSamplesPerSec;
+        wfx->wBitsPerSample = 16;
+        wfx->nBlockAlign = WORD(wfx->nChannels * sizeof(int16_t));
+        wfx->nAvgBytesPerSec = wfx->nSamplesPerSec * wfx->nBlockAlign;
+        wfx->cbSize = 0;
+
+        uint64_t decodedBytes = uint64_t(frames) * wfx->nBlockAlign;
+        if (!frames || decodedBytes > UINT32_MAX)
+            return false;
+
+        wave.sourceFormat = std::move(wave.format);
+        wave.format = std::move(format);
+        wave.data.wfx = wfx;
+        wave.data.audioBytes = uint32_t(decodedBytes);
+        wave.pcmFrames = frames;
+
+        return true;
+    }
+
+    // Reads a wave's MS-ADPCM payload from its source file and decompresses it into wave.encoded.
+    HRESULT DecodeWaveADPCM(WaveFile& wave, _In_z_ const wchar_t* szSource)
+    {
+        ScopedHandle hSource(safe_handle(CreateFileW(szSource, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr)));
+        if (!hSource)
+            return HRESULT_FROM_WIN32(GetLastError());
+
+        LARGE_INTEGER offset;
+        offset.QuadPart = static_cast<LONGLONG>(wave.audioOffset);
+        if (!SetFilePointerEx(hSource.get(), offset, nullptr, FILE_BEGIN))
+            return HRESULT_FROM_WIN32(GetLastError());
+
+        std::unique_ptr<uint8_t[]> adpcm(new (std::nothrow) uint8_t[wave.sourceBytes]);
+        std::unique_ptr<uint8_t[]> decoded(new (std::nothrow) uint8_t[wave.data.audioBytes]);
+        if (!adpcm || !decoded)
+            return E_OUTOFMEMORY;
+
+        DWORD bytesRead;
+        if (!ReadFile(hSource.get(), adpcm.get(), wave.sourceBytes, &bytesRead, nullptr))
+            return HRESULT_FROM_WIN32(GetLastError());
+
+        if (bytesRead != wave.sourceBytes)
+            return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+
+        auto sourceFormat = reinterpret_cast<const WAVEFORMATEX*>(wave.sourceFormat.get());
+
+        HRESULT hr = DirectX::ADPCMDecode(sourceFormat, adpcm.get(), wave.sourceBytes, reinterpret_cast<int16_t*>(decoded.get()), wave.pcmFrames);
+        if (FAILED(hr))
+            return hr;
+
+        wave.encoded = std::move(decoded);
+
+        return S_OK;
+    }
+
+    uint64_t FileTimeValue(const FILETIME& time)
+    {
+        return (uint64_t(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+    }
+
+    // Copies a range of a previously built bank to the current position of the output file.
+    bool CopyBankData(HANDLE hOutput, HANDLE hBank, uint64_t bankOffset, uint64_t length, _Out_writes_bytes_(bufferSize) uint8_t* buffer, DWORD bufferSize)
+    {
+        LARGE_INTEGER offset;
+        offset.QuadPart = static_cast<LONGLONG>(bankOffset);
+        if (!SetFilePointerEx(hBank, offset, nullptr, FILE_BEGIN))
+            return false;
+
+        while (length > 0)
+        {
+            DWORD chunk = DWORD(std::min<uint64_t>(length, bufferSize));
+
+            DWORD bytesRead;
+            if (!ReadFile(hBank, buffer, chunk, &bytesRead, nullptr) || bytesRead != chunk)
+                return false;
+
+            DWORD bytesWritten;
+            if (!WriteFile(hOutput, buffer, chunk, &bytesWritten, nullptr) || bytesWritten != chunk)
+                return false;
+
+            length -= chunk;
+        }
+
+        return true;
+    }
+
+    // Reads the manifest of a previous build, failing if it does not describe the bank currently on disk.
+    bool LoadManifest(_In_z_ const wchar_t* szManifestFile, _In_z_ const wchar_t* szBankFile, XWBTool::MANIFESTHEADER& header, std::vector<XWBTool::MANIFESTENTRY>& entries)
+    {
+        WIN32_FILE_ATTRIBUTE_DATA bankInfo = {};
+        if (!GetFileAttributesExW(szBankFile, GetFileExInfoStandard, &bankInfo))
+            return false;
+
+        ScopedHandle hFile(safe_handle(CreateFileW(szManifestFile, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr)));
+        if (!hFile)
+            return false;
+
+        LARGE_INTEGER fileSize = {};
+        if (!GetFileSizeEx(hFile.get(), &fileSize))
+            return false;
+
+        DWORD bytesRead;
+        if (!ReadFile(hFile.get(), &header, sizeof(header), &bytesRead, nullptr) || bytesRead != sizeof(header))
+            return false;
+
+        if (header.dwSignature != XWBTool::MANIFESTHEADER::SIGNATURE
+            || header.dwVersion != XWBTool::MANIFESTHEADER::VERSION
+            || !header.dwEntryCount
+            || uint64_t(fileSize.QuadPart) != sizeof(XWBTool::MANIFESTHEADER) + uint64_t(header.dwEntryCount) * sizeof(XWBTool::MANIFESTENTRY))
+            return false;
+
+        if (bankInfo.nFileSizeHigh != 0
+            || bankInfo.nFileSizeLow != header.dwBankSize
+            || FileTimeValue(bankInfo.ftLastWriteTime) != header.BankWriteTime)
+            return false;
+
+        entries.resize(header.dwEntryCount);
+
+        DWORD entryBytes = DWORD(header.dwEntryCount * sizeof(XWBTool::MANIFESTENTRY));
+        if (!ReadFile(hFile.get(), entries.data(), entryBytes, &bytesRead, nullptr) || bytesRead != entryBytes)
+            return false;
+
+        return true;
+    }
+
+    bool SaveManifest(_In_z_ const wchar_t* szManifestFile, _In_z_ const wchar_t* szBankFile, XWBTool::MANIFESTHEADER& header, const std::vector<XWBTool::MANIFESTENTRY>& entries)
+    {
+        WIN32_FILE_ATTRIBUTE_DATA bankInfo = {};
+        if (!GetFileAttributesExW(szBankFile, GetFileExInfoStandard, &bankInfo) || bankInfo.nFileSizeHigh != 0)
+            return false;
+
+        header.dwSignature = XWBTool::MANIFESTHEADER::SIGNATURE;
+        header.dwVersion = XWBTool::MANIFESTHEADER::VERSION;
+        header.dwEntryCount = uint32_t(entries.size());
+        header.dwBankSize = bankInfo.nFileSizeLow;
+        header.BankWriteTime = FileTimeValue(bankInfo.ftLastWriteTime);
+
+        ScopedHandle hFile(safe_handle(CreateFileW(szManifestFile, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr)));
+        if (!hFile)
+            return false;
+
+        DWORD bytesWritten;
+        if (!WriteFile(hFile.get(), &header, sizeof(header), &bytesWritten, nullptr) || bytesWritten != sizeof(header))
+            return false;
+
+        DWORD entryBytes = DWORD(entries.size() * sizeof(XWBTool::MANIFESTENTRY));
+        if (!WriteFile(hFile.get(), entries.data(), entryBytes, &bytesWritten, nullptr) || bytesWritten != entryBytes)
+            return false;
+
+        return true;
+    }
+
+    double ElapsedMilliseconds(const LARGE_INTEGER& start)
+    {
+        LARGE_INTEGER frequency, now;
+        QueryPerformanceFrequency(&frequency);
+        QueryPerformanceCounter(&now);
+
+        return double(now.QuadPart - start.QuadPart) * 1000.0 / double(frequency.QuadPart);
+    }
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -1150,6 +1575,15 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 }
                 break;
 
+            case OPT_ADPCM:
+            case OPT_PCM:
+                if ((dwOptions & (1 << OPT_ADPCM)) && (dwOptions & (1 << OPT_PCM)))
+                {
+                    wprintf(L"-adpcm and -pcm are mutually exclusive options\n");
+                    return 1;
+                }
+                break;
+
             case OPT_FILELIST:
                 {
                     std::wifstream inFile(pValue);
@@ -1222,6 +1656,18 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
     if (~dwOptions & (1 << OPT_NOLOGO))
         PrintLogo();
 
+    // Per-phase timing report
+    std::vector<std::pair<const wchar_t*, double>> timings;
+
+    LARGE_INTEGER phaseStart;
+    QueryPerformanceCounter(&phaseStart);
+
+    auto endPhase = [&](const wchar_t* name)
+    {
+        timings.emplace_back(name, ElapsedMilliseconds(phaseStart));
+        QueryPerformanceCounter(&phaseStart);
+    };
+
     // Gather wave files
     std::unique_ptr<uint8_t[]> entries;
     std::unique_ptr<char[]> entryNames;
@@ -1230,53 +1676,94 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
 
     bool xma = false;
 
-    size_t index = 0;
-    for (auto pConv = conversion.begin(); pConv != conversion.end(); ++pConv, ++index)
+    if (!*szOutputFile)
     {
         wchar_t ext[_MAX_EXT];
         wchar_t fname[_MAX_FNAME];
-        _wsplitpath_s(pConv->szSrc, nullptr, 0, nullptr, 0, fname, _MAX_FNAME, ext, _MAX_EXT);
+        _wsplitpath_s(conversion.front().szSrc, nullptr, 0, nullptr, 0, fname, _MAX_FNAME, ext, _MAX_EXT);
 
-        // Load source image
-        if (pConv != conversion.begin())
-            wprintf(L"\n");
-        else if (!*szOutputFile)
+        if (_wcsicmp(ext, L".xwb") == 0)
         {
-            if (_wcsicmp(ext, L".xwb") == 0)
-            {
-                wprintf(L"ERROR: Need to specify output file via -o\n");
-                return 1;
-            }
-
-            _wmakepath_s(szOutputFile, nullptr, nullptr, fname, L".xwb");
+            wprintf(L"ERROR: Need to specify output file via -o\n");
+            return 1;
         }
 
-        wprintf(L"reading %ls", pConv->szSrc);
-        fflush(stdout);
+        _wmakepath_s(szOutputFile, nullptr, nullptr, fname, L".xwb");
+    }
 
-        WaveFile wave;
-        wave.conv = index;
-        std::unique_ptr<uint8_t[]> waveData;
+    // Parse the source headers in parallel; payloads are streamed from the sources when the bank is written
+    std::vector<const SConversion*> sources;
+    sources.reserve(conversion.size());
+    for (auto pConv = conversion.cbegin(); pConv != conversion.cend(); ++pConv)
+    {
+        sources.push_back(&*pConv);
+    }
 
-        HRESULT hr = DirectX::LoadWAVAudioFromFileEx(pConv->szSrc, waveData, wave.data);
-        if (FAILED(hr))
+    waves.resize(sources.size());
+    std::vector<HRESULT> results(sources.size(), S_OK);
+
+    concurrency::parallel_for(size_t(0), sources.size(), [&](size_t index)
+    {
+        waves[index].conv = index;
+        results[index] = LoadWaveHeaders(sources[index]->szSrc, waves[index]);
+    });
+
+    for (size_t index = 0; index < waves.size(); ++index)
+    {
+        if (index > 0)
+            wprintf(L"\n");
+
+        wprintf(L"reading %ls", sources[index]->szSrc);
+
+        if (FAILED(results[index]))
         {
-            wprintf(L"\nERROR: Failed to load file (%08X)\n", hr);
+            wprintf(L"\nERROR: Failed to load file (%08X)\n", results[index]);
             return 1;
         }
 
-        wave.waveData = std::move(waveData);
+        PrintInfo(waves[index]);
 
-        PrintInfo(wave);
-
-        if (wave.data.wfx->wFormatTag == WAVE_FORMAT_XMA2)
+        if (waves[index].data.wfx->wFormatTag == WAVE_FORMAT_XMA2)
             xma = true;
-
-        waves.emplace_back(std::move(wave));
     }
 
     wprintf(L"\n");
 
+    if (dwOptions & (1 << OPT_ADPCM))
+    {
+        for (auto it = waves.begin(); it != waves.end(); ++it)
+        {
+            auto wfx = it->data.wfx;
+            if (wfx->wFormatTag != WAVE_FORMAT_PCM || wfx->wBitsPerSample != 16 || wfx->nChannels > 2)
+            {
+                wprintf(L"WARNING: %ls is not 16-bit mono or stereo PCM, so it is not compressed\n", sources[it->conv]->szSrc);
+                continue;
+            }
+
+            if (!ConvertToADPCM(*it))
+            {
+                wprintf(L"ERROR: Failed converting %ls to ADPCM\n", sources[it->conv]->szSrc);
+                return 1;
+            }
+        }
+    }
+    else if (dwOptions & (1 << OPT_PCM))
+    {
+        for (auto it = waves.begin(); it != waves.end(); ++it)
+        {
+            if (it->data.wfx->wFormatTag != WAVE_FORMAT_ADPCM)
+                continue;
+
+            if (!ConvertToPCM(*it))
+            {
+                wprintf(L"ERROR: Failed converting %ls to PCM\n", sources[it->conv]->szSrc);
+                return 1;
+            }
+        }
+    }
+
+    endPhase(L"scan");
+
     DWORD dwAlignment = ALIGNMENT_MIN;
     if (dwOptions & (1 << OPT_STREAMING))
         dwAlignment = ALIGNMENT_DVD;
@@ -1458,10 +1945,142 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
 
     assert(count > 0 && count == waves.size());
 
+    // WaveBank::Find and Play look entries up by name hash, so every name must hash uniquely
+    if (entryNames)
+    {
+        std::vector<std::pair<uint32_t, size_t>> nameHashes;
+        nameHashes.reserve(count);
+        for (size_t j = 0; j < count; ++j)
+        {
+            const char* entryName = &entryNames[j * ENTRYNAME_LENGTH];
+            if (*entryName)
+                nameHashes.emplace_back(EntryNameHash(entryName), j);
+        }
+
+        std::sort(nameHashes.begin(), nameHashes.end());
+
+        bool collision = false;
+        for (size_t j = 1; j < nameHashes.size(); ++j)
+        {
+            if (nameHashes[j].first == nameHashes[j - 1].first)
+            {
+                wprintf(L"ERROR: Entry names \"%hs\" (%zu) and \"%hs\" (%zu) have the same hash %08X\n",
+                    &entryNames[nameHashes[j - 1].second * ENTRYNAME_LENGTH], nameHashes[j - 1].second,
+                    &entryNames[nameHashes[j].second * ENTRYNAME_LENGTH], nameHashes[j].second,
+                    nameHashes[j].first);
+                collision = true;
+            }
+        }
+
+        if (collision)
+        {
+            wprintf(L"ERROR: Rename the entries above so each name hashes uniquely\n");
+            return 1;
+        }
+    }
+
+    endPhase(L"layout");
+
+    // Payload layout of the wave data segment, which incremental builds record in the manifest
+    std::vector<XWBTool::MANIFESTENTRY> newEntries(waves.size());
+    {
+        uint32_t offset = 0;
+        for (size_t j = 0; j < waves.size(); ++j)
+        {
+            auto& entry = newEntries[j];
+            memset(&entry, 0, sizeof(XWBTool::MANIFESTENTRY));
+
+            entry.dwFormat = waves[j].miniFmt.dwValue;
+            entry.dwOffset = offset;
+            entry.dwLength = waves[j].data.audioBytes;
+
+            offset += BLOCKALIGNPAD(waves[j].data.audioBytes, dwAlignment);
+        }
+    }
+
+    // Match the waves against the manifest of the previous incremental build
+    wchar_t szManifestFile[MAX_PATH] = {};
+    wchar_t szTempFile[MAX_PATH] = {};
+    XWBTool::MANIFESTHEADER manifest = {};
+    XWBTool::MANIFESTHEADER newManifest = {};
+    std::vector<XWBTool::MANIFESTENTRY> oldEntries;
+    std::vector<size_t> reuse;          // Entry of the previous bank holding the same payload, or NO_REUSE
+    size_t reused = 0;
+    bool inPlace = false;
+
+    if (dwOptions & (1 << OPT_INCREMENTAL))
+    {
+        if (swprintf_s(szManifestFile, L"%ls.manifest", szOutputFile) < 0
+            || swprintf_s(szTempFile, L"%ls.tmp", szOutputFile) < 0)
+        {
+            wprintf(L"ERROR: Output filename %ls is too long for an incremental build\n", szOutputFile);
+            return 1;
+        }
+
+        if (!LoadManifest(szManifestFile, szOutputFile, manifest, oldEntries)
+            || manifest.dwAlignment != dwAlignment)
+        {
+            oldEntries.clear();
+        }
+
+        // Must match the segment layout written below
+        uint64_t metadataBytes = sizeof(HEADER) + sizeof(BANKDATA) + waves.size() * (compact ? sizeof(ENTRYCOMPACT) : sizeof(ENTRY));
+        if (seekEntries > 0)
+            metadataBytes += (seekEntries + waves.size()) * sizeof(uint32_t);
+        if (dwOptions & (1 << OPT_FRIENDLY_NAMES))
+            metadataBytes += waves.size() * ENTRYNAME_LENGTH;
+
+        newManifest.dwAlignment = dwAlignment;
+        newManifest.dwDataOffset = uint32_t(BLOCKALIGNPAD(metadataBytes, dwAlignment));
+
+        for (size_t j = 0; j < waves.size(); ++j)
+        {
+            auto& entry = newEntries[j];
+
+            entry.pathHash = HashPath(sources[waves[j].conv]->szSrc);
+            entry.sourceSize = waves[j].sourceSize;
+            entry.SourceWriteTime = FileTimeValue(waves[j].sourceWriteTime);
+        }
+
+        // Sources whose size and timestamp are unchanged keep their content hash, the rest are hashed again
+        auto rehash = XWBTool::CarryContentHashes(oldEntries, newEntries);
+
+        std::vector<uint8_t> hashed(rehash.size(), 0);
+
+        concurrency::parallel_for(size_t(0), rehash.size(), [&](size_t index)
+        {
+            const DWORD hashBufferSize = 256 * 1024;
+            std::unique_ptr<uint8_t[]> hashBuffer(new uint8_t[hashBufferSize]);
+
+            size_t j = rehash[index];
+            hashed[index] = HashWaveData(waves[j], sources[waves[j].conv]->szSrc, hashBuffer.get(), hashBufferSize, newEntries[j].contentHash) ? 1 : 0;
+        });
+
+        for (size_t index = 0; index < rehash.size(); ++index)
+        {
+            if (!hashed[index])
+            {
+                wprintf(L"ERROR: Failed reading audio data from %ls\n", sources[waves[rehash[index]].conv]->szSrc);
+                return 1;
+            }
+        }
+
+        reused = XWBTool::MatchPayloads(manifest, oldEntries, newManifest, newEntries, reuse, inPlace);
+
+        endPhase(L"manifest");
+    }
+
     // Create wave bank
     assert(*szOutputFile != 0);
 
     wprintf(L"writing %ls%ls wavebank %ls w/ %zu entries\n", (compact) ? L"compact " : L"", (dwOptions & (1 << OPT_STREAMING)) ? L"streaming" : L"in-memory", szOutputFile, waves.size());
+
+    if (dwOptions & (1 << OPT_INCREMENTAL))
+    {
+        wprintf(L"incremental build: %zu of %zu waves unchanged, %ls\n", reused, waves.size(),
+            inPlace ? L"patching in place" : (reused > 0) ? L"copying from existing wavebank" : L"full rebuild");
+    }
+
     fflush(stdout);
 
     if (dwOptions & (1 << OPT_NOOVERWRITE))
@@ -1482,13 +2101,39 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
         }
     }
 
-    hFile.reset(safe_handle(CreateFileW(szOutputFile, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr)));
+    // Copies from the existing wave bank go to a temporary file that replaces it once complete
+    ScopedHandle hOldBank;
+    if (!inPlace && reused > 0)
+    {
+        hOldBank.reset(safe_handle(CreateFileW(szOutputFile, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr)));
+        if (!hOldBank)
+        {
+            wprintf(L"ERROR: Failed opening existing wavebank %ls, %u\n", szOutputFile, GetLastError());
+            return 1;
+        }
+    }
+
+    if (inPlace)
+    {
+        hFile.reset(safe_handle(CreateFileW(szOutputFile, GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr)));
+    }
+    else
+    {
+        hFile.reset(safe_handle(CreateFileW(hOldBank ? szTempFile : szOutputFile, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr)));
+    }
+
     if (!hFile)
     {
         wprintf(L"ERROR: Failed opening output file %ls, %u\n", szOutputFile, GetLastError());
         return 1;
     }
 
+    // The manifest no longer describes the bank once it is modified, so only a completed build writes it back
+    if (*szManifestFile)
+    {
+        (void)DeleteFileW(szManifestFile);
+    }
+
     // Setup wave bank header
     HEADER header = {};
     header.dwSignature = HEADER::SIGNATURE;
@@ -1675,38 +2320,132 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
         segmentOffset += entryNamesBytes;
     }
 
+    endPhase(L"metadata");
+
     // Write wave data
     segmentOffset = BLOCKALIGNPAD(segmentOffset, dwAlignment);
 
     header.Segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwOffset = segmentOffset;
     header.Segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwLength = uint32_t(waveOffset);
 
-    for (auto it = waves.begin(); it != waves.end(); ++it)
+    assert(!(dwOptions & (1 << OPT_INCREMENTAL)) || segmentOffset == newManifest.dwDataOffset);
+
+    if ((uint64_t(segmentOffset) + waveOffset) > UINT32_MAX)
     {
-        if (SetFilePointer(hFile.get(), segmentOffset, 0, FILE_BEGIN) == INVALID_SET_FILE_POINTER)
+        wprintf(L"ERROR: Data exceeds maximum size for wavebank\n");
+        return 1;
+    }
+
+    const DWORD copyBufferSize = 1024 * 1024;
+    std::unique_ptr<uint8_t[]> copyBuffer(new uint8_t[copyBufferSize]);
+
+    auto writes = XWBTool::PlanWaveData(newEntries, oldEntries, reuse, inPlace, dwAlignment);
+
+    // The -adpcm waves are compressed, and the -pcm waves decompressed, in parallel batches just ahead of
+    // their writes. Each payload is released once written, so memory is bounded by the batch, not the bank.
+    const uint64_t convertBatchBytes = 64 * 1024 * 1024;
+
+    auto needsConversion = [&](const XWBTool::WAVEDATAWRITE& write)
+    {
+        return write.source == XWBTool::WAVEDATA_NEW && (waves[write.entry].adpcmFrames > 0 || waves[write.entry].pcmFrames > 0);
+    };
+
+    std::vector<size_t> batch;
+    std::vector<HRESULT> convertResults;
+    double convertMilliseconds = 0;
+
+    for (size_t w = 0; w < writes.size(); ++w)
+    {
+        const auto& write = writes[w];
+
+        if (write.source == XWBTool::WAVEDATA_KEEP)
+            continue;
+
+        if (needsConversion(write) && !waves[write.entry].encoded)
         {
-            wprintf(L"ERROR: Failed writing audio data to %ls, SFP %u\n", szOutputFile, GetLastError());
-            return 1;
+            // Each conversion holds its source and converted payloads at once; a wave larger than the budget goes alone
+            batch.clear();
+            uint64_t batchBytes = 0;
+
+            for (size_t next = w; next < writes.size(); ++next)
+            {
+                if (!needsConversion(writes[next]))
+                    continue;
+
+                const auto& nextWave = waves[writes[next].entry];
+                uint64_t waveBytes = uint64_t(nextWave.sourceBytes) + nextWave.data.audioBytes;
+                if (!batch.empty() && batchBytes + waveBytes > convertBatchBytes)
+                    break;
+
+                batch.push_back(writes[next].entry);
+                batchBytes += waveBytes;
+            }
+
+            LARGE_INTEGER convertStart;
+            QueryPerformanceCounter(&convertStart);
+
+            convertResults.assign(batch.size(), S_OK);
+
+            concurrency::parallel_for(size_t(0), batch.size(), [&](size_t index)
+            {
+                size_t j = batch[index];
+                convertResults[index] = (waves[j].pcmFrames > 0)
+                    ? DecodeWaveADPCM(waves[j], sources[waves[j].conv]->szSrc)
+                    : EncodeWaveADPCM(waves[j], sources[waves[j].conv]->szSrc);
+            });
+
+            convertMilliseconds += ElapsedMilliseconds(convertStart);
+
+            for (size_t index = 0; index < batch.size(); ++index)
+            {
+                if (FAILED(convertResults[index]))
+                {
+                    wprintf(L"ERROR: Failed %ls %ls (%08X)\n",
+                        (waves[batch[index]].pcmFrames > 0) ? L"decoding ADPCM from" : L"encoding ADPCM from",
+                        sources[waves[batch[index]].conv]->szSrc, convertResults[index]);
+                    return 1;
+                }
+            }
         }
 
-        if (!WriteFile(hFile.get(), it->data.startAudio, it->data.audioBytes, &bytesWritten, nullptr)
-            || bytesWritten != it->data.audioBytes)
+        DWORD writeOffset = segmentOffset + DWORD(write.offset);
+
+        if (SetFilePointer(hFile.get(), writeOffset, 0, FILE_BEGIN) == INVALID_SET_FILE_POINTER)
         {
-            wprintf(L"ERROR: Failed writing audio data to %ls, %u\n", szOutputFile, GetLastError());
+            wprintf(L"ERROR: Failed writing audio data to %ls, SFP %u\n", szOutputFile, GetLastError());
             return 1;
         }
 
-        DWORD alignedSize = BLOCKALIGNPAD(it->data.audioBytes, dwAlignment);
+        auto& wave = waves[write.entry];
 
-        if ((uint64_t(segmentOffset) + alignedSize) > UINT32_MAX)
+        if (write.source == XWBTool::WAVEDATA_COPY)
         {
-            wprintf(L"ERROR: Data exceeds maximum size for wavebank\n");
-            return 1;
+            if (!CopyBankData(hFile.get(), hOldBank.get(), uint64_t(manifest.dwDataOffset) + write.oldOffset, write.length, copyBuffer.get(), copyBufferSize))
+            {
+                wprintf(L"ERROR: Failed copying audio data from existing wavebank %ls, %u\n", szOutputFile, GetLastError());
+                return 1;
+            }
         }
+        else if (wave.encoded)
+        {
+            if (!WriteFile(hFile.get(), wave.encoded.get(), wave.data.audioBytes, &bytesWritten, nullptr)
+                || bytesWritten != wave.data.audioBytes)
+            {
+                wprintf(L"ERROR: Failed writing audio data to %ls, %u\n", szOutputFile, GetLastError());
+                return 1;
+            }
 
-        segmentOffset += alignedSize;
+            wave.encoded.reset();
+        }
+        else if (!CopyWaveData(hFile.get(), wave, sources[wave.conv]->szSrc, copyBuffer.get(), copyBufferSize))
+        {
+            wprintf(L"ERROR: Failed writing audio data from %ls to %ls, %u\n", sources[wave.conv]->szSrc, szOutputFile, GetLastError());
+            return 1;
+        }
     }
 
+    segmentOffset += DWORD(waveOffset);
+
     assert(segmentOffset == (header.Segments[HEADER::SEGIDX_ENTRYWAVEDATA].dwOffset + waveOffset));
 
     // Commit wave bank
@@ -1735,6 +2474,37 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
         return 1;
     }
 
+    hFile.reset();
+
+    if (hOldBank)
+    {
+        hOldBank.reset();
+
+        if (!MoveFileExW(szTempFile, szOutputFile, MOVEFILE_REPLACE_EXISTING))
+        {
+            wprintf(L"ERROR: Failed replacing existing wavebank %ls, %u\n", szOutputFile, GetLastError());
+            return 1;
+        }
+    }
+
+    endPhase(L"wave data");
+
+    // Report the conversions as a phase of their own, apart from the writes
+    if (convertMilliseconds > 0)
+    {
+        timings.back().second -= convertMilliseconds;
+        timings.insert(timings.end() - 1, std::make_pair(L"encode", convertMilliseconds));
+    }
+
+    if (dwOptions & (1 << OPT_INCREMENTAL))
+    {
+        if (!SaveManifest(szManifestFile, szOutputFile, newManifest, newEntries))
+        {
+            wprintf(L"WARNING: Failed writing manifest %ls, the next build will not be incremental\n", szManifestFile);
+            (void)DeleteFileW(szManifestFile);
+        }
+    }
+
     // Write C header if requested
     if (*szHeaderFile)
     {
@@ -1767,6 +2537,31 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
 
             fprintf_s(file, "};\n\n#define XACT_WAVEBANK_%ls_ENTRY_COUNT %zu\n", wBankName, count);
 
+            if (entryNames)
+            {
+                // Precomputed name hashes let WaveBank::Play and Find skip string handling at runtime
+                fprintf_s(file, "\n#ifdef __cplusplus\n");
+
+                windex = 0;
+                for (auto it = waves.begin(); it != waves.end(); ++it, ++windex)
+                {
+                    auto cit = conversion.cbegin();
+                    advance(cit, it->conv);
+
+                    wchar_t wEntryName[_MAX_FNAME];
+                    _wsplitpath_s(cit->szSrc, nullptr, 0, nullptr, 0, wEntryName, _MAX_FNAME, nullptr, 0);
+
+                    FileNameToIdentifier(wEntryName, _MAX_FNAME);
+
+                    char entryName[ENTRYNAME_LENGTH] = {};
+                    strncpy_s(entryName, &entryNames[windex * ENTRYNAME_LENGTH], _TRUNCATE);
+
+                    fprintf_s(file, "constexpr unsigned int XACT_WAVEBANK_%ls_%ls_HASH = 0x%08Xu; // \"%s\"\n", wBankName, wEntryName, EntryNameHash(entryName), entryName);
+                }
+
+                fprintf_s(file, "#endif\n");
+            }
+
             fclose(file);
         }
         else
@@ -1774,6 +2569,20 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             wprintf(L"ERROR: Failed writing wave bank C header %ls\n", szHeaderFile);
             return 1;
         }
+
+        endPhase(L"C header");
+    }
+
+    if (dwOptions & (1 << OPT_TIMING))
+    {
+        double total = 0;
+        wprintf(L"\ntiming:\n");
+        for (auto it = timings.cbegin(); it != timings.cend(); ++it)
+        {
+            wprintf(L"   %-12ls %10.1f ms\n", it->first, it->second);
+            total += it->second;
+        }
+        wprintf(L"   %-12ls %10.1f ms (%zu waves, %llu bytes of audio)\n", L"total", total, waves.size(), waveOffset);
     }
 
     return 0;
@@ -346,6 +346,13 @@ namespace audio
 			buf.pAudioData = buffers[currentStreamBuffer].get();
 			sourceVoice->SubmitSourceBuffer(&buf);
 
+			// log the submitted buffer - cheap enough to keep in the streaming loop
+			if (util::BinaryLogger* binaryLogger = util::ServiceLocator::getBinaryLogger())
+			{
+				static const util::BinaryLogFormat submittedBuffer("Submitted {} bytes of streamed audio to buffer {} ({} buffers queued).");
+				binaryLogger->print<util::SeverityType::debug>(submittedBuffer, sampleBufferLength, currentStreamBuffer, state.BuffersQueued);
+			}
+
 			currentStreamBuffer++;
 			currentStreamBuffer %= maxBufferCount;
 		}
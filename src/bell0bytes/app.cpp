@@ -3,6 +3,11 @@
 // the header
 #include "app.h"
 
+// c++ includes
+#include <algorithm>
+#include <functional>
+#include <numeric>
+
 // bell0bytes core
 #include "coreComponent.h"
 #include "timer.h"
@@ -34,7 +39,17 @@ namespace core
 	/////////////////////////////////////////////////////////////////////////////////////////
 	////////////////////////////// Constructors /////////////////////////////////////////////
 	/////////////////////////////////////////////////////////////////////////////////////////
-	DirectXApp::DirectXApp() : applicationIsPaused(true), fps(0), mspf(0.0), dt(1000.0f/6000.0f), maxSkipFrames(10), applicationStarted(false), showFPS(true), stateStackChanged(false) { }
+	DirectXApp::DirectXApp() : eventQueue(4096), eventQueueOverflowed(false), dispatchBuffer(), dispatchOrder(), batchBuffer(), dispatchMode(DispatchModes::Sequential), dispatchStatistics(), millisecondsPerCount(0.0), applicationIsPaused(true), fps(0), mspf(0.0), dt(1000.0f/6000.0f), maxSkipFrames(10), applicationStarted(false), showFPS(true), stateStackChanged(false)
+	{
+		dispatchBuffer.reserve(eventQueue.getCapacity());
+		dispatchOrder.reserve(eventQueue.getCapacity());
+		batchBuffer.reserve(eventQueue.getCapacity());
+
+		// get the frequency of the performance counter to time the message handlers
+		long long int frequency = 0;
+		if (QueryPerformanceFrequency((LARGE_INTEGER*)&frequency))
+			millisecondsPerCount = 1000.0 / (double)frequency;
+	}
 	DirectXApp::~DirectXApp()
 	{
 		shutdown();
@@ -308,6 +323,7 @@ namespace core
 				outFPS << "Mode #" << graphicsComponent->get3DComponent().getCurrentModeIndex() + 1 << " of " << graphicsComponent->get3DComponent().getNumberOfSupportedModes() << std::endl;
 				outFPS << "FPS: " << DirectXApp::fps << std::endl;
 				outFPS << "mSPF: " << DirectXApp::mspf << std::endl;
+				outFPS << "Depesches: " << dispatchStatistics.getTotalMessages() << " in " << dispatchStatistics.getTotalMilliseconds() << " ms" << std::endl;
 
 				if (!(graphicsComponent->getWriteComponent().createTextLayoutFPS(outFPS, (float)graphicsComponent->getCurrentWidth(), (float)graphicsComponent->getCurrentHeight())).wasSuccessful())
 					return std::runtime_error("Critical error: Failed to create the text layout for FPS information!");
@@ -422,26 +438,155 @@ namespace core
 		// error handling
 		util::Expected<void> result;
 
-		while (!eventQueue.isEmpty())
+		// reset the statistics of the previous frame
+		std::fill(std::begin(dispatchStatistics.nMessages), std::end(dispatchStatistics.nMessages), 0);
+		std::fill(std::begin(dispatchStatistics.milliseconds), std::end(dispatchStatistics.milliseconds), 0.0);
+
+		// grab all messages at once; messages sent while dispatching are handled in the next pass
+		// the messages a failed handler did not get to in the last frame are still in the buffer, and go first
+		eventQueue.drainInto(dispatchBuffer);
+		while (!dispatchBuffer.empty())
+		{
+			// on failure, the dispatch functions leave the undelivered messages in the buffer
+			if (dispatchMode == DispatchModes::Batched)
+				result = dispatchBatched();
+			else
+				result = dispatchSequential();
+
+			if (!result.isValid())
+				return result;
+
+			dispatchBuffer.clear();
+			eventQueue.drainInto(dispatchBuffer);
+		}
+
+		return { };
+	}
+
+	util::Expected<void> DirectXApp::dispatchSequential()
+	{
+		// error handling
+		util::Expected<void> result;
+
+		long long int startCount = 0, endCount = 0;
+		for (size_t i = 0; i < dispatchBuffer.size(); i++)
 		{
-			// get the front message
-			Depesche depesche = eventQueue.dequeue();
+			const Depesche& depesche = dispatchBuffer[i];
 
 			// check whether the receiver actually exists
 			DepescheDestination* destination = depesche.destination;
-			if (destination)
-				// the destination is valid
-				result = destination->onMessage(depesche);
+			if (!destination)
+				continue;
+
+			// the destination is valid
+			QueryPerformanceCounter((LARGE_INTEGER*)&startCount);
+			result = destination->handleMessage(depesche);
+			QueryPerformanceCounter((LARGE_INTEGER*)&endCount);
+
+			dispatchStatistics.nMessages[depesche.type]++;
+			dispatchStatistics.milliseconds[depesche.type] += (endCount - startCount) * millisecondsPerCount;
 
 			if (!result.isValid())
+			{
+				// keep the messages after the failed one queued
+				dispatchBuffer.erase(dispatchBuffer.begin(), dispatchBuffer.begin() + i + 1);
 				return result;
+			}
+		}
+
+		return { };
+	}
+
+	util::Expected<void> DirectXApp::dispatchBatched()
+	{
+		// error handling
+		util::Expected<void> result;
+
+		// group the messages by destination; the order in which the messages were sent to a destination is kept
+		const std::vector<Depesche>& messages = dispatchBuffer;
+		dispatchOrder.resize(messages.size());
+		std::iota(dispatchOrder.begin(), dispatchOrder.end(), (size_t)0);
+		std::stable_sort(dispatchOrder.begin(), dispatchOrder.end(), [&messages](const size_t a, const size_t b)
+		{
+			return std::less<DepescheDestination*>()(messages[a].destination, messages[b].destination);
+		});
+
+		// destinations that do not care about the order may receive all their messages of the same type at once
+		size_t group = 0;
+		while (group < dispatchOrder.size())
+		{
+			DepescheDestination* destination = messages[dispatchOrder[group]].destination;
+
+			size_t groupEnd = group + 1;
+			while (groupEnd < dispatchOrder.size() && messages[dispatchOrder[groupEnd]].destination == destination)
+				groupEnd++;
+
+			if (destination && destination->isOrderInsensitive())
+				std::stable_sort(dispatchOrder.begin() + group, dispatchOrder.begin() + groupEnd, [&messages](const size_t a, const size_t b)
+				{
+					return messages[a].type < messages[b].type;
+				});
+
+			group = groupEnd;
+		}
+
+		// the destinations expect each batch to be contiguous
+		batchBuffer.clear();
+		for (size_t index : dispatchOrder)
+			batchBuffer.push_back(messages[index]);
+
+		// hand each run of messages of the same type to its destination
+		long long int startCount = 0, endCount = 0;
+		size_t begin = 0;
+		while (begin < batchBuffer.size())
+		{
+			DepescheDestination* destination = batchBuffer[begin].destination;
+			const DepescheTypes type = batchBuffer[begin].type;
+
+			size_t end = begin + 1;
+			while (end < batchBuffer.size() && batchBuffer[end].destination == destination && batchBuffer[end].type == type)
+				end++;
+
+			// check whether the receiver actually exists
+			if (destination)
+			{
+				QueryPerformanceCounter((LARGE_INTEGER*)&startCount);
+				result = destination->onMessages(&batchBuffer[begin], end - begin);
+				QueryPerformanceCounter((LARGE_INTEGER*)&endCount);
+
+				dispatchStatistics.nMessages[type] += (unsigned int)(end - begin);
+				dispatchStatistics.milliseconds[type] += (endCount - startCount) * millisecondsPerCount;
+
+				if (!result.isValid())
+				{
+					// keep the messages after the failed run queued; the next pass groups them again
+					dispatchBuffer.assign(batchBuffer.begin() + end, batchBuffer.end());
+					batchBuffer.clear();
+					return result;
+				}
+			}
+
+			begin = end;
 		}
 
+		batchBuffer.clear();
 		return { };
 	}
 
+	const unsigned int DispatchStatistics::getTotalMessages() const
+	{
+		return std::accumulate(std::begin(nMessages), std::end(nMessages), 0u);
+	}
+
+	const double DispatchStatistics::getTotalMilliseconds() const
+	{
+		return std::accumulate(std::begin(milliseconds), std::end(milliseconds), 0.0);
+	}
+
 	void DirectXApp::addMessage(Depesche& depesche)
 	{
-		eventQueue.enqueue(depesche);
+		// if the ring is full, the message is kept in the overflow vector of the queue; the first overflow is logged, to tune the capacity
+		if (!eventQueue.enqueue(depesche) && !eventQueueOverflowed.exchange(true))
+			util::ServiceLocator::getFileLogger()->print<util::SeverityType::warning>("The event queue is full! Messages are kept in its overflow vector until they are dispatched.");
 	}
 }
\ No newline at end of file
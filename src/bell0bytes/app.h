@@ -10,19 +10,26 @@
 *			- 03/06/18: now observes events from the Window and Direct3D classes
 *			- 21/06/18: changed the state stack to allow overlays
 *			- 27/06/18: sliced the app class into several components
+*			- 16/10/26: the event queue is now a lock-free ring buffer
+*			- 16/10/26: messages can be dispatched in batches; added dispatch statistics
+*			- 17/10/26: a full event queue keeps messages in an overflow vector instead of dropping them
 ****************************************************************************************/
 
 // INCLUDES /////////////////////////////////////////////////////////////////////////////
 
+// c++ includes
+#include <atomic>			// the overflow warning flag
+
 // c++ containers
 #include <deque>			// deque for the stack of game states
+#include <vector>			// vector of messages to dispatch
 
 // Windows includes
 #include <Windows.h>		// Windows definitions
 
 // bell0bytes utilities
 #include "observer.h"		// the observer pattern
-#include "safeQueue.h"		// a thread-safe queue
+#include "ringBuffer.h"		// a lock-free multi-producer single-consumer queue, with an overflow
 
 // bell0bytes core
 #include "depesche.h"		// event queue data
@@ -56,12 +63,36 @@ namespace core
 	class CoreComponent;
 	class GameState;
 
+	// the modes to dispatch the messages in the event queue
+	enum DispatchModes
+	{
+		Sequential,		// dispatch the messages one at a time, in the order they were sent
+		Batched			// group the messages by destination, keeping the order they were sent in, and hand each run of the same type to the destination at once
+	};
+
+	// statistics about the messages dispatched during the last frame
+	struct DispatchStatistics
+	{
+		unsigned int nMessages[NumberOfDepescheTypes];		// the number of messages dispatched, per type
+		double milliseconds[NumberOfDepescheTypes];			// the time spent handling the messages, per type
+
+		const unsigned int getTotalMessages() const;
+		const double getTotalMilliseconds() const;
+	};
+
 	// the main DirectX application class
 	class DirectXApp : public util::Observer
 	{
 	private:
 		// the main message queue
-		util::ThreadSafeQueue<Depesche> eventQueue;	// thread-safe message queue
+		util::OverflowingRingBuffer<Depesche> eventQueue;	// lock-free message queue; bursts that do not fit are kept in its overflow vector
+		std::atomic<bool> eventQueueOverflowed;		// true iff the event queue overflowed; only the first overflow is logged
+		std::vector<Depesche> dispatchBuffer;		// the messages drained from the queue, to be dispatched this frame; after a failed handler, the messages it did not get to
+		std::vector<size_t> dispatchOrder;			// batched mode: the order in which to dispatch the messages
+		std::vector<Depesche> batchBuffer;			// batched mode: the messages grouped by destination
+		DispatchModes dispatchMode;					// the current dispatch mode
+		DispatchStatistics dispatchStatistics;		// statistics about the last frame
+		double millisecondsPerCount;				// to convert performance counter ticks to milliseconds
 		
 		// game update variables
 		const double dt;						// constant game update rate for better physics simulation (less rounding errors in mathematical computations)
@@ -84,6 +115,8 @@ namespace core
 		
 		// dispatch the messages in the event queue
 		util::Expected<void> dispatchMessages();
+		util::Expected<void> dispatchSequential();
+		util::Expected<void> dispatchBatched();
 
 		// pause and resume the application
 		void pauseApplication();
@@ -131,6 +164,9 @@ namespace core
 
 		// event queue
 		void addMessage(Depesche&);		// add a message to the queue
+		void setDispatchMode(const DispatchModes mode) { dispatchMode = mode; };
+		const DispatchModes getDispatchMode() const { return dispatchMode; };
+		const DispatchStatistics& getDispatchStatistics() const { return dispatchStatistics; };
 
 		// manage the game states
 		util::Expected<void> changeGameState(GameState* const gameState);	// change game state (deletes all previous states)
@@ -14,16 +14,6 @@
 #include "serviceLocator.h"
 #include "stringConverter.h"
 
-// Lua and Sol
-
-// warning supression no longer needed with C++-17
-//#pragma warning( push )
-//#pragma warning( disable : 4127)	// disable constant if expr warning
-//#pragma warning( disable : 4702)	// disable unreachable code warning
-#include <sol.hpp>
-//#pragma warning( pop ) 
-#pragma comment(lib, "liblua53.a")
-
 namespace audio
 {
 	/////////////////////////////////////////////////////////////////////////////////////////
@@ -53,6 +43,12 @@ namespace audio
 		loadVolume();
 		soundsSubmix->SetVolume(soundEffectsVolume);
 		musicSubmix->SetVolume(musicVolume);
+
+		// register the message handlers
+		registerHandler<core::DepescheTypes::PlaySoundEvent, AudioComponent, &AudioComponent::onPlaySoundEvent>();
+		registerHandler<core::DepescheTypes::StopSoundEvent, AudioComponent, &AudioComponent::onStopSoundEvent>();
+		registerHandler<core::DepescheTypes::BeginStream, AudioComponent, &AudioComponent::onBeginStream>();
+		registerHandler<core::DepescheTypes::EndStream, AudioComponent, &AudioComponent::onEndStream>();
 	}
 
 	AudioComponent::~AudioComponent()
@@ -190,45 +186,54 @@ namespace audio
 	/////////////////////////////////////////////////////////////////////////////////////////
 	///////////////////////////////////// Messages //////////////////////////////////////////
 	/////////////////////////////////////////////////////////////////////////////////////////
-	util::Expected<void> AudioComponent::onMessage(const core::Depesche& depesche)
+	util::Expected<void> AudioComponent::onPlaySoundEvent(const core::Depesche& depesche)
 	{
-		if (depesche.type == core::DepescheTypes::PlaySoundEvent)
-		{
-			// handle errors
-			HRESULT hr = S_OK;
+		// handle errors
+		HRESULT hr = S_OK;
 
-			if (depesche.message == nullptr)
-				return std::runtime_error("Critical error: depesche was empty!");
+		const SoundEvent* soundEvent = depesche.getMessage<core::DepescheTypes::PlaySoundEvent>();
+		if (soundEvent == nullptr)
+			return std::runtime_error("Critical error: depesche was empty!");
 
-			// submit the audio buffer to the source voice
-			hr = ((SoundEvent*)depesche.message)->sourceVoice->SubmitSourceBuffer(&((SoundEvent*)depesche.message)->audioBuffer);
-			if (FAILED(hr))
-				return std::runtime_error("Critical error: Unable to submit source buffer!");
+		// submit the audio buffer to the source voice
+		hr = soundEvent->sourceVoice->SubmitSourceBuffer(&soundEvent->audioBuffer);
+		if (FAILED(hr))
+			return std::runtime_error("Critical error: Unable to submit source buffer!");
 
-			// start the source voice
-			((SoundEvent*)depesche.message)->sourceVoice->Start();
-		}
-		else if (depesche.type == core::DepescheTypes::StopSoundEvent)
-		{
-			if (depesche.message == nullptr)
-				return std::runtime_error("Critical error: depesche was empty!");
-			
-			// simply stop the source voice
-			((SoundEvent*)depesche.message)->sourceVoice->Stop();
-		}
-		else if (depesche.type == core::DepescheTypes::BeginStream)
-		{
-			// begin streaming music
-			if (depesche.message == nullptr)
-				return std::runtime_error("Critical error: depesche was empty!");
+		// start the source voice
+		soundEvent->sourceVoice->Start();
+
+		// return success
+		return { };
+	}
+
+	util::Expected<void> AudioComponent::onStopSoundEvent(const core::Depesche& depesche)
+	{
+		const SoundEvent* soundEvent = depesche.getMessage<core::DepescheTypes::StopSoundEvent>();
+		if (soundEvent == nullptr)
+			return std::runtime_error("Critical error: depesche was empty!");
+
+		// simply stop the source voice
+		soundEvent->sourceVoice->Stop();
+
+		// return success
+		return { };
+	}
+
+	util::Expected<void> AudioComponent::onBeginStream(const core::Depesche& depesche)
+	{
+		// begin streaming music
+		const StreamEvent* streamEvent = depesche.getMessage<core::DepescheTypes::BeginStream>();
+		if (streamEvent == nullptr)
+			return std::runtime_error("Critical error: depesche was empty!");
+
+		return streamFile(streamEvent->filename, streamEvent->type, streamEvent->loop);
+	}
+
+	util::Expected<void> AudioComponent::onEndStream(const core::Depesche& /*depesche*/)
+	{
+		endStream();
 
-			util::Expected<void> result = streamFile(((StreamEvent*)depesche.message)->filename, ((StreamEvent*)depesche.message)->type, ((StreamEvent*)depesche.message)->loop);
-			if (!result.isValid())
-				return result;
-		}
-		else if (depesche.type == core::DepescheTypes::EndStream)
-			endStream();
-		
 		// return success
 		return { };
 	}
@@ -265,27 +270,15 @@ namespace audio
 	{
 		if (dxApp.getFileSystemComponent().hasValidConfigurationFile())
 		{
-			// configuration file exists, try to read from it
-			std::wstring pathToPrefFile = dxApp.getFileSystemComponent().getPathToConfigurationFiles() + L"\\bell0prefs.lua";
-
-			try
-			{
-				sol::state lua;
-				lua.script_file(util::StringConverter::ws2s(pathToPrefFile));
-
-				// read from the configuration file, default to 1920 x 1080
-				musicVolume = lua["config"]["musicVolume"].get_or(1.0f);
-				soundEffectsVolume = lua["config"]["soundEffectsVolume"].get_or(1.0f);
+			// read from the cached configuration
+			const fileSystem::UserConfiguration& configuration = dxApp.getFileSystemComponent().getConfiguration();
+			musicVolume = configuration.musicVolume;
+			soundEffectsVolume = configuration.soundEffectsVolume;
 #ifndef NDEBUG
-				std::stringstream res;
-				res << "The volume was read from the Lua configuration file: " << musicVolume << " x " << soundEffectsVolume << ".";
-				util::ServiceLocator::getFileLogger()->print<util::SeverityType::info>(res.str());
+			std::stringstream res;
+			res << "The volume was read from the Lua configuration file: " << musicVolume << " x " << soundEffectsVolume << ".";
+			util::ServiceLocator::getFileLogger()->print<util::SeverityType::info>(res.str());
 #endif
-			}
-			catch (std::exception)
-			{
-				util::ServiceLocator::getFileLogger()->print<util::SeverityType::warning>("Unable to read configuration file. Starting with default volume: 1.0f");
-			}
 		}
 
 		// return success
@@ -98,8 +98,11 @@ namespace audio
 		float soundEffectsVolume = 1.0f;
 		float musicVolume = 1.0f;
 		
-		// handle message
-		util::Expected<void> onMessage(const core::Depesche& depesche);
+		// handle messages
+		util::Expected<void> onPlaySoundEvent(const core::Depesche& depesche);
+		util::Expected<void> onStopSoundEvent(const core::Depesche& depesche);
+		util::Expected<void> onBeginStream(const core::Depesche& depesche);
+		util::Expected<void> onEndStream(const core::Depesche& depesche);
 
 		// load volume from prev file
 		util::Expected<void> loadVolume();
@@ -0,0 +1,392 @@
+/****************************************************************************************
+* Author:	Gilles Bellot
+* Date:		17/10/2026
+*
+* Desc:		writes binary logs and turns them back into text with the binaryLogDecoder tool
+*			- messages printed by 4 threads, with each type of argument, must all be decoded,
+*			  in the order each thread printed them
+*			- records reserved but never committed (torn records, as a crash leaves them)
+*			  must be skipped, and the committed records around them decoded
+*			- the file left by a process killed while its threads print must decode without
+*			  a single corrupted record, with the first lines of each thread in order
+*			- messages whose format string could not be written are dropped rather than
+*			  left undecodable
+*			- also reports the time a print call takes
+*
+*			build and run from this folder:
+*				g++ -std=c++14 -O2 ../../binaryLogDecoder/binaryLogDecoder.cpp -o binaryLogDecoder
+*				g++ -std=c++14 -O2 -DNDEBUG -pthread -Wno-unknown-pragmas -I linux -I .. binaryLogBenchmark.cpp ../binaryLog.cpp -o binaryLogBenchmark
+*				./binaryLogBenchmark [path to binaryLogDecoder]
+*
+* History:
+****************************************************************************************/
+
+// INCLUDES /////////////////////////////////////////////////////////////////////////////
+
+// c++ includes
+#include <algorithm>			// sort
+#include <atomic>				// start signal
+#include <chrono>				// timing
+#include <cstdio>				// printf
+#include <cstdlib>				// system
+#include <fstream>				// decoded files
+#include <iterator>				// stream iterators
+#include <random>				// crash times
+#include <sstream>				// expected lines
+#include <string>				// strings
+#include <thread>				// printing threads
+#include <vector>				// containers
+
+// c includes
+#include <signal.h>				// killing the writer
+#include <sys/wait.h>			// waiting for the writer
+
+// bell0bytes util
+#include "binaryLog.h"
+
+// DEFINITIONS //////////////////////////////////////////////////////////////////////////
+namespace
+{
+	typedef std::chrono::steady_clock Clock;
+
+	std::string decoderPath = "./binaryLogDecoder";
+	const std::string logFile = "binaryLogBenchmark.blog";
+	const std::string cutFile = "binaryLogBenchmark.cut.blog";
+	const std::string textFile = "binaryLogBenchmark.log";
+	const std::string summaryFile = "binaryLogBenchmark.summary";
+
+	unsigned int nFailures = 0;
+
+	void check(const bool condition, const char* const message, const char* const test)
+	{
+		if (!condition)
+		{
+			if (nFailures < 20)
+				std::printf("FAILED (%s): %s\n", test, message);
+			nFailures++;
+		}
+	}
+
+	std::wstring widen(const std::string& string)
+	{
+		return std::wstring(string.begin(), string.end());
+	}
+
+	std::string readFile(const std::string& name)
+	{
+		std::ifstream stream(name, std::ios_base::binary);
+		return std::string((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+	}
+
+	// the output of the decoder: the text of each message, and the summary it printed
+	struct Decoded
+	{
+		bool valid;								// the decoder succeeded
+		std::vector<std::string> messages;		// the text after the severity and thread of each line
+		std::vector<std::string> severities;
+		std::string summary;
+	};
+
+	Decoded decode(const std::string& file)
+	{
+		Decoded decoded;
+		std::remove(textFile.c_str());
+		const std::string command = "\"" + decoderPath + "\" \"" + file + "\" \"" + textFile + "\" 2> \"" + summaryFile + "\"";
+		decoded.valid = std::system(command.c_str()) == 0;
+		decoded.summary = readFile(summaryFile);
+		while (!decoded.summary.empty() && decoded.summary.back() == '\n')
+			decoded.summary.pop_back();
+
+		// lines are separated by "\r\n", each is "number: date time\tSEVERITY: thread id:\tmessage"
+		const std::string text = readFile(textFile);
+		for (size_t position = 0; decoded.valid && position < text.size(); )
+		{
+			size_t endOfLine = text.find("\r\n", position);
+			if (endOfLine == std::string::npos)
+				endOfLine = text.size();
+
+			const std::string line = text.substr(position, endOfLine - position);
+			const size_t firstTab = line.find('\t'), secondTab = line.find('\t', firstTab + 1);
+			if (secondTab == std::string::npos)
+				decoded.valid = false;
+			else
+			{
+				decoded.severities.push_back(line.substr(firstTab + 1, 9));
+				decoded.messages.push_back(line.substr(secondTab + 1));
+			}
+			position = endOfLine + 2;
+		}
+		return decoded;
+	}
+
+	// the summary the decoder prints
+	std::string summary(const size_t nMessages, const unsigned int nCorrupted, const unsigned int nIncomplete)
+	{
+		std::string text = "Decoded " + std::to_string(nMessages) + " messages";
+		if (nCorrupted)
+			text += ", skipped " + std::to_string(nCorrupted) + " corrupted records";
+		if (nIncomplete)
+			text += ", skipped " + std::to_string(nIncomplete) + " incomplete records";
+		return text + ".";
+	}
+
+	enum class CatState { Idle, Hunting, Sleeping };
+
+	const util::BinaryLogFormat damageFormat("Cat {} took {} damage, {} hit points left.");
+	const util::BinaryLogFormat streamFormat("Streamed {} bytes from {} at {}x.");
+	const util::BinaryLogFormat stateFormat("Worker {}: cat {} changed to state {} ({}).");
+
+	// the message printed as the i-th line of a thread, as the decoder writes it - the lines of all threads differ
+	std::string expectedLine(const unsigned int thread, const int i)
+	{
+		std::ostringstream line;
+		switch (i % 3)
+		{
+		case 0: line << "Cat " << thread * 100000 + i << " took " << -i % 7 << " damage, " << (unsigned long long)i * 1000000007ull << " hit points left."; break;
+		case 1: line << "Streamed " << i * 4096u << " bytes from music" << thread << ".ogg at 0.5x."; break;
+		default: line << "Worker " << thread << ": cat " << i << " changed to state " << i % 3 << " (" << (i % 2 ? "awake" : "") << ")."; break;
+		}
+		return line.str();
+	}
+
+	void printLine(util::BinaryLogger& logger, const unsigned int thread, const int i)
+	{
+		switch (i % 3)
+		{
+		case 0: logger.print<util::SeverityType::info>(damageFormat, thread * 100000 + i, -i % 7, (unsigned long long)i * 1000000007ull); break;
+		case 1: logger.print<util::SeverityType::debug>(streamFormat, i * 4096u, std::string("music") + std::to_string(thread) + ".ogg", 0.5f); break;
+		default: logger.print<util::SeverityType::warning>(stateFormat, (short)thread, (long long)i, CatState(i % 3), i % 2 ? "awake" : ""); break;
+		}
+	}
+
+	// the lines printed by each thread must be decoded in order - all of them, or the first lines of each thread if the writer crashed
+	void checkLines(const Decoded& decoded, const unsigned int nThreads, const int linesPerThread, const bool complete, const char* const test)
+	{
+		std::vector<int> nextLine(nThreads, 0);
+		bool inOrder = true;
+		for (const std::string& message : decoded.messages)
+		{
+			bool found = false;
+			for (unsigned int t = 0; t < nThreads && !found; t++)
+				if (nextLine[t] < linesPerThread && message == expectedLine(t, nextLine[t]))
+				{
+					nextLine[t]++;
+					found = true;
+				}
+			inOrder &= found;
+		}
+
+		check(inOrder, "a line was garbled, or decoded out of order", test);
+		check(!complete || std::all_of(nextLine.begin(), nextLine.end(), [=](int n) { return n == linesPerThread; }), "a line was lost", test);
+	}
+
+	// 4 threads print with every type of argument; each line must be decoded as the text logger would write it
+	void testDecode()
+	{
+		const unsigned int nThreads = 4;
+		const int linesPerThread = 3000;
+		{
+			util::BinaryLogger logger(widen(logFile), 4 * 1024 * 1024);
+			std::vector<std::thread> threads;
+			for (unsigned int t = 0; t < nThreads; t++)
+				threads.emplace_back([&logger, t]()
+				{
+					for (int i = 0; i < linesPerThread; i++)
+						printLine(logger, t, i);
+				});
+			for (auto& thread : threads)
+				thread.join();
+			check(logger.getNumberOfDroppedRecords() == 0, "records were dropped", "Decode");
+		}
+
+		const Decoded decoded = decode(logFile);
+		check(decoded.valid, "the decoder failed", "Decode");
+		check(decoded.summary == summary(nThreads * linesPerThread, 0, 0), decoded.summary.c_str(), "Decode");
+		checkLines(decoded, nThreads, linesPerThread, true, "Decode");
+		check((unsigned int)std::count(decoded.severities.begin(), decoded.severities.end(), "WARNING: ") == nThreads * (linesPerThread / 3), "severities differ", "Decode");
+	}
+
+	// write a record directly through the policy; the record is left torn if it is not committed
+	char* writeRecord(util::BinaryLogPolicy& policy, const util::binaryLog::RecordTypes type, const uint32_t formatID, const std::string& payload, const bool commit)
+	{
+		using namespace util::binaryLog;
+
+		const size_t headerSize = type == FormatRecord ? sizeof(RecordHeader) : sizeof(MessageHeader);
+		const size_t size = alignedRecordSize(headerSize + payload.size());
+		char* record = policy.reserve(size);
+		if (!record)
+			return nullptr;
+
+		MessageHeader header = { };
+		header.record.type = Uncommitted;
+		header.record.size = (uint16_t)size;
+		header.record.formatID = formatID;
+		header.nArguments = 0;
+		std::memcpy(record, &header, headerSize);
+		std::memcpy(record + headerSize, payload.data(), payload.size());
+		std::memset(record + headerSize + payload.size(), 0, size - headerSize - payload.size());
+
+		if (commit)
+			policy.commit(record, type);
+		return record;
+	}
+
+	// records reserved but never committed are skipped, whether their size was written or not
+	void testTornRecords()
+	{
+		using namespace util::binaryLog;
+		{
+			util::BinaryLogPolicy policy;
+			check(policy.openOutputStream(widen(logFile), 64 * 1024), "unable to open the file", "TornRecords");
+
+			writeRecord(policy, FormatRecord, 1, "first", true);
+			writeRecord(policy, MessageRecord, 1, "", true);
+			writeRecord(policy, FormatRecord, 2, "second", false);					// torn format record
+			writeRecord(policy, MessageRecord, 1, "", false);						// torn message, its size intact
+			writeRecord(policy, FormatRecord, 3, "third", true);
+
+			// a torn message whose size was damaged as well: the decoder searches for the next record
+			char* damaged = writeRecord(policy, MessageRecord, 3, std::string(40, '\0'), false);
+			const uint16_t damagedSize = 0xFFFF;
+			std::memcpy(damaged + offsetof(RecordHeader, size), &damagedSize, sizeof(damagedSize));
+
+			writeRecord(policy, MessageRecord, 3, "", true);
+			writeRecord(policy, MessageRecord, 2, "", true);						// its format was never committed
+			writeRecord(policy, MessageRecord, 1, "", false);						// torn, at the end of the file
+			policy.closeOutputStream();
+		}
+
+		Decoded decoded = decode(logFile);
+		check(decoded.valid, "the decoder failed", "TornRecords");
+		check(decoded.summary == summary(2, 1, 3), decoded.summary.c_str(), "TornRecords");
+		check(decoded.messages == std::vector<std::string>({ "first", "third" }), "the committed messages were not decoded", "TornRecords");
+
+		// the file cut in the middle of one of the last two records, as a crash can leave a file
+		std::string file = readFile(logFile);
+		for (size_t cut = 1; cut < 2 * sizeof(MessageHeader); cut++)
+		{
+			std::ofstream(cutFile, std::ios_base::binary).write(file.data(), file.size() - cut);
+			decoded = decode(cutFile);
+			check(decoded.valid && decoded.messages == std::vector<std::string>({ "first", "third" }), "a cut file was not decoded", "TornRecords");
+		}
+	}
+
+	// a writer process killed while its threads print leaves records reserved but not yet committed
+	void testCrash()
+	{
+		const unsigned int nThreads = 4, nCrashes = 20;
+		const int linesPerThread = 40000;
+		unsigned int nWithIncomplete = 0, nStarted = 0;
+		std::mt19937 generator(5);
+
+		for (unsigned int crash = 0; crash < nCrashes; crash++)
+		{
+			std::remove(logFile.c_str());
+			const pid_t writer = fork();
+			if (writer == 0)
+			{
+				util::BinaryLogger logger(widen(logFile), 16 * 1024 * 1024);
+				std::vector<std::thread> threads;
+				for (unsigned int t = 0; t < nThreads; t++)
+					threads.emplace_back([&logger, t]()
+					{
+						for (int i = 0; i < linesPerThread; i++)
+							printLine(logger, t, i);
+					});
+				for (auto& thread : threads)
+					thread.join();
+				_exit(0);
+			}
+
+			std::this_thread::sleep_for(std::chrono::microseconds(std::uniform_int_distribution<int>(0, 20000)(generator)));
+			kill(writer, SIGKILL);
+			waitpid(writer, nullptr, 0);
+
+			// the writer may have been killed before the file header was written
+			const Decoded decoded = decode(logFile);
+			if (!decoded.valid)
+				continue;
+			nStarted++;
+
+			check(decoded.summary.find("corrupted") == std::string::npos, decoded.summary.c_str(), "Crash");
+			nWithIncomplete += decoded.summary.find("incomplete") != std::string::npos;
+			checkLines(decoded, nThreads, linesPerThread, false, "Crash");
+		}
+
+		std::printf("%u writers killed while printing, %u of them left incomplete records\n", nStarted, nWithIncomplete);
+	}
+
+	// a message is dropped if its format string can not be written, instead of being left undecodable
+	void testUndefinedFormats()
+	{
+		const std::string longFormat(util::binaryLog::maxRecordSize, 'x');
+		const util::BinaryLogFormat tooLarge(longFormat.c_str());
+		const util::BinaryLogFormat late("Late message {}.");
+		unsigned int nPrinted = 0, nDropped = 0;
+		{
+			util::BinaryLogger logger(widen(logFile), 4096);
+
+			// the record of the format is too large: it is not marked as defined, thus no message of it is written
+			logger.print<util::SeverityType::info>(tooLarge, 1);
+			logger.print<util::SeverityType::info>(tooLarge, 2);
+
+			// fill the file with messages of a format that was defined while there was room
+			while (logger.getNumberOfDroppedRecords() == 0)
+			{
+				logger.print<util::SeverityType::info>(damageFormat, 0, 0, 0ull);
+				nPrinted++;
+			}
+			logger.print<util::SeverityType::info>(late, 1);
+			logger.print<util::SeverityType::info>(late, 2);
+			nDropped = logger.getNumberOfDroppedRecords();
+		}
+
+		const Decoded decoded = decode(logFile);
+		check(decoded.valid, "the decoder failed", "UndefinedFormats");
+		check(decoded.summary == summary(nPrinted - 1, 0, 0), decoded.summary.c_str(), "UndefinedFormats");
+		check(nDropped == 3, "the messages of a format that could not be written were not dropped", "UndefinedFormats");
+	}
+
+	// the time a print call blocks the thread
+	void reportPrintTime()
+	{
+		const int nLines = 200000;
+		std::vector<float> times;
+		times.reserve(nLines);
+		{
+			util::BinaryLogger logger(widen(logFile), 32 * 1024 * 1024);
+			for (int i = 0; i < nLines; i++)
+			{
+				const auto before = Clock::now();
+				logger.print<util::SeverityType::info>(damageFormat, i, -i % 7, (unsigned long long)i);
+				times.push_back(std::chrono::duration<float, std::nano>(Clock::now() - before).count());
+			}
+		}
+
+		std::sort(times.begin(), times.end());
+		std::printf("print with 3 arguments: %.0f ns median, %.0f ns p99\n", times[times.size() / 2], times[times.size() * 99 / 100]);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc > 1)
+		decoderPath = argv[1];
+
+	testDecode();
+	testTornRecords();
+	testCrash();
+	testUndefinedFormats();
+	reportPrintTime();
+
+	for (const std::string& file : { logFile, cutFile, textFile, summaryFile })
+		std::remove(file.c_str());
+
+	if (nFailures)
+	{
+		std::printf("%u checks failed\n", nFailures);
+		return 1;
+	}
+	std::printf("all checks passed\n");
+	return 0;
+}
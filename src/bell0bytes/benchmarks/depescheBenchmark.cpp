@@ -0,0 +1,234 @@
+/****************************************************************************************
+* Author:	Gilles Bellot
+* Date:		16/10/2026
+*
+* Desc:		measures the depesches sent and dispatched per second with the inline typed
+*			payloads and per-type handler tables, against the previous depesches
+*			- the previous depesches carried a void pointer to a payload the sender had to
+*			  keep alive (here: allocated on the heap and freed after dispatch) and were
+*			  dispatched through a virtual onMessage with a chain of type checks
+*			- both paths must agree on a checksum of all received payloads
+*
+*			build and run from this folder:
+*				g++ -std=c++14 -O2 -I .. depescheBenchmark.cpp ../depesche.cpp -o depescheBenchmark
+*				./depescheBenchmark
+*
+* History:
+****************************************************************************************/
+
+// INCLUDES /////////////////////////////////////////////////////////////////////////////
+
+// c++ includes
+#include <chrono>				// timing
+#include <cstdio>				// printf
+#include <vector>				// the queue of depesches
+
+// bell0bytes core
+#include "depesche.h"
+
+// DEFINITIONS //////////////////////////////////////////////////////////////////////////
+namespace previous
+{
+	// the depesche as it was before the payloads were stored inline
+	class DepescheSender { };
+	class DepescheDestination;
+
+	struct Depesche
+	{
+		DepescheSender* const sender;
+		DepescheDestination* const destination;
+		const core::DepescheTypes type;
+		void* const message;
+
+		Depesche(DepescheSender& sender, DepescheDestination& destination, const core::DepescheTypes type, void* const message) : sender(&sender), destination(&destination), type(type), message(message) {};
+	};
+
+	class DepescheDestination
+	{
+	public:
+		virtual ~DepescheDestination() {};
+		virtual util::Expected<void> onMessage(const Depesche&) = 0;
+	};
+
+	// a destination handling several types, as the audio component and the heads-up display did
+	class Destination : public DepescheDestination
+	{
+	public:
+		double checksum = 0;
+
+		util::Expected<void> onMessage(const Depesche& depesche) override
+		{
+			if (depesche.type == core::DepescheTypes::ActiveKeyMap)
+			{
+				if (depesche.message == nullptr)
+					return std::runtime_error("Critical error: depesche was empty!");
+				checksum += *(bool*)depesche.message ? 1 : 0;
+			}
+			else if (depesche.type == core::DepescheTypes::Gamepad)
+			{
+				if (depesche.message == nullptr)
+					return std::runtime_error("Critical error: depesche was empty!");
+				checksum += *(float*)depesche.message;
+			}
+			else if (depesche.type == core::DepescheTypes::Damage)
+			{
+				if (depesche.message == nullptr)
+					return std::runtime_error("Critical error: depesche was empty!");
+				checksum += *(unsigned int*)depesche.message;
+			}
+			else if (depesche.type == core::DepescheTypes::EndStream)
+				checksum += 1000;
+
+			return { };
+		}
+	};
+}
+
+namespace
+{
+	const unsigned int nFrames = 2000;					// the number of frames simulated per run
+	const unsigned int depeschesPerFrame = 1024;		// the depesches sent per frame
+	const unsigned int nRuns = 3;						// the best run is reported
+
+	// the same destination, with a handler registered for each type
+	class Destination : public core::DepescheDestination
+	{
+	public:
+		double checksum = 0;
+
+		Destination()
+		{
+			registerHandler<core::DepescheTypes::ActiveKeyMap, Destination, &Destination::onActiveKeyMap>();
+			registerHandler<core::DepescheTypes::Gamepad, Destination, &Destination::onGamepad>();
+			registerHandler<core::DepescheTypes::Damage, Destination, &Destination::onDamage>();
+			registerHandler<core::DepescheTypes::EndStream, Destination, &Destination::onEndStream>();
+		}
+
+		util::Expected<void> onActiveKeyMap(const core::Depesche& depesche) { checksum += depesche.getMessage<core::ActiveKeyMap>() ? 1 : 0; return { }; }
+		util::Expected<void> onGamepad(const core::Depesche& depesche) { checksum += depesche.getMessage<core::Gamepad>(); return { }; }
+		util::Expected<void> onDamage(const core::Depesche& depesche) { checksum += depesche.getMessage<core::Damage>(); return { }; }
+		util::Expected<void> onEndStream(const core::Depesche&) { checksum += 1000; return { }; }
+	};
+
+	// the mix of types sent in a frame: mostly damage, as in the play state
+	core::DepescheTypes typeOf(const unsigned int i)
+	{
+		switch (i % 8)
+		{
+		case 0: return core::DepescheTypes::Gamepad;
+		case 1: return core::DepescheTypes::ActiveKeyMap;
+		case 2: return core::DepescheTypes::EndStream;
+		default: return core::DepescheTypes::Damage;
+		}
+	}
+
+	double runPrevious(double& checksum)
+	{
+		previous::DepescheSender sender;
+		previous::Destination destinations[4];
+		std::vector<previous::Depesche> queue;
+		queue.reserve(depeschesPerFrame);
+
+		const auto startTime = std::chrono::steady_clock::now();
+		for (unsigned int frame = 0; frame < nFrames; frame++)
+		{
+			// send: the payloads have to outlive the frame, thus they are allocated
+			for (unsigned int i = 0; i < depeschesPerFrame; i++)
+			{
+				void* message = nullptr;
+				switch (typeOf(i))
+				{
+				case core::DepescheTypes::Gamepad: message = new float(0.5f); break;
+				case core::DepescheTypes::ActiveKeyMap: message = new bool((i & 16) != 0); break;
+				case core::DepescheTypes::Damage: message = new unsigned int(i); break;
+				default: break;
+				}
+				queue.emplace_back(sender, destinations[i % 4], typeOf(i), message);
+			}
+
+			// dispatch and free the payloads
+			for (const previous::Depesche& depesche : queue)
+			{
+				if (!depesche.destination->onMessage(depesche).isValid())
+					return 0;
+
+				switch (depesche.type)
+				{
+				case core::DepescheTypes::Gamepad: delete (float*)depesche.message; break;
+				case core::DepescheTypes::ActiveKeyMap: delete (bool*)depesche.message; break;
+				case core::DepescheTypes::Damage: delete (unsigned int*)depesche.message; break;
+				default: break;
+				}
+			}
+			queue.clear();
+		}
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+		checksum = 0;
+		for (const auto& destination : destinations)
+			checksum += destination.checksum;
+		return double(nFrames) * depeschesPerFrame / seconds;
+	}
+
+	double runCurrent(double& checksum)
+	{
+		core::DepescheSender sender;
+		Destination destinations[4];
+		std::vector<core::Depesche> queue;
+		queue.reserve(depeschesPerFrame);
+
+		const auto startTime = std::chrono::steady_clock::now();
+		for (unsigned int frame = 0; frame < nFrames; frame++)
+		{
+			for (unsigned int i = 0; i < depeschesPerFrame; i++)
+			{
+				switch (typeOf(i))
+				{
+				case core::DepescheTypes::Gamepad: queue.push_back(core::Depesche::create<core::Gamepad>(sender, destinations[i % 4], 0.5f)); break;
+				case core::DepescheTypes::ActiveKeyMap: queue.push_back(core::Depesche::create<core::ActiveKeyMap>(sender, destinations[i % 4], (i & 16) != 0)); break;
+				case core::DepescheTypes::Damage: queue.push_back(core::Depesche::create<core::Damage>(sender, destinations[i % 4], i)); break;
+				default: queue.push_back(core::Depesche::create<core::EndStream>(sender, destinations[i % 4])); break;
+				}
+			}
+
+			for (const core::Depesche& depesche : queue)
+				if (!depesche.destination->handleMessage(depesche).isValid())
+					return 0;
+			queue.clear();
+		}
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+		checksum = 0;
+		for (const auto& destination : destinations)
+			checksum += destination.checksum;
+		return double(nFrames) * depeschesPerFrame / seconds;
+	}
+}
+
+int main()
+{
+	double previousRate = 0, currentRate = 0;
+	double previousChecksum = 0, currentChecksum = 0;
+
+	for (unsigned int run = 0; run < nRuns; run++)
+	{
+		double rate = runPrevious(previousChecksum);
+		if (rate > previousRate)
+			previousRate = rate;
+
+		rate = runCurrent(currentChecksum);
+		if (rate > currentRate)
+			currentRate = rate;
+	}
+
+	std::printf("%u frames of %u depesches, send and dispatch\n", nFrames, depeschesPerFrame);
+	std::printf("void* payload, virtual onMessage:     %7.2f M/s\n", previousRate / 1e6);
+	std::printf("inline payload, handler table:        %7.2f M/s   (%.2fx)\n", currentRate / 1e6, currentRate / previousRate);
+
+	if (previousRate == 0 || currentRate == 0 || previousChecksum != currentChecksum)
+	{
+		std::printf("the dispatch failed or the payloads differ (%f, %f)\n", previousChecksum, currentChecksum);
+		return 1;
+	}
+	return 0;
+}
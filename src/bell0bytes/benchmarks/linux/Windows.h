@@ -0,0 +1,176 @@
+#pragma once
+
+/****************************************************************************************
+* Author:	Gilles Bellot
+* Date:		16/10/2026
+*
+* Desc:		the few Windows definitions the benchmarks need, so that they can be built
+*			with g++ or clang
+*
+* History:
+****************************************************************************************/
+
+// INCLUDES /////////////////////////////////////////////////////////////////////////////
+
+// c++ includes
+#include <map>					// mapped views
+
+// c includes
+#include <fcntl.h>				// files
+#include <stdint.h>				// fixed-size integers
+#include <stdlib.h>				// wide strings
+#include <sys/mman.h>			// file mappings
+#include <sys/syscall.h>		// thread IDs
+#include <time.h>				// local time
+#include <unistd.h>				// files
+
+// DEFINITIONS //////////////////////////////////////////////////////////////////////////
+typedef unsigned short WORD;
+typedef unsigned long DWORD;
+typedef int BOOL;
+typedef long long LONGLONG;
+typedef void* HANDLE;
+
+typedef union _LARGE_INTEGER
+{
+	LONGLONG QuadPart;
+} LARGE_INTEGER;
+
+#define INVALID_HANDLE_VALUE ((HANDLE)(intptr_t)-1)
+#define GENERIC_READ 0x80000000
+#define GENERIC_WRITE 0x40000000
+#define FILE_SHARE_READ 0x00000001
+#define CREATE_ALWAYS 2
+#define FILE_ATTRIBUTE_NORMAL 0x00000080
+#define FILE_BEGIN 0
+#define PAGE_READWRITE 0x04
+#define FILE_MAP_WRITE 0x0002
+
+typedef struct _SYSTEMTIME
+{
+	WORD wYear;
+	WORD wMonth;
+	WORD wDayOfWeek;
+	WORD wDay;
+	WORD wHour;
+	WORD wMinute;
+	WORD wSecond;
+	WORD wMilliseconds;
+} SYSTEMTIME;
+
+inline void GetLocalTime(SYSTEMTIME* localTime)
+{
+	timespec now;
+	clock_gettime(CLOCK_REALTIME, &now);
+
+	tm local;
+	localtime_r(&now.tv_sec, &local);
+
+	localTime->wYear = (WORD)(local.tm_year + 1900);
+	localTime->wMonth = (WORD)(local.tm_mon + 1);
+	localTime->wDayOfWeek = (WORD)local.tm_wday;
+	localTime->wDay = (WORD)local.tm_mday;
+	localTime->wHour = (WORD)local.tm_hour;
+	localTime->wMinute = (WORD)local.tm_min;
+	localTime->wSecond = (WORD)local.tm_sec;
+	localTime->wMilliseconds = (WORD)(now.tv_nsec / 1000000);
+}
+
+// timestamps in nanoseconds
+inline BOOL QueryPerformanceFrequency(LARGE_INTEGER* frequency)
+{
+	frequency->QuadPart = 1000000000;
+	return 1;
+}
+
+inline BOOL QueryPerformanceCounter(LARGE_INTEGER* counter)
+{
+	timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	counter->QuadPart = (LONGLONG)now.tv_sec * 1000000000 + now.tv_nsec;
+	return 1;
+}
+
+inline DWORD GetCurrentThreadId()
+{
+	return (DWORD)syscall(SYS_gettid);
+}
+
+// files and file mappings - a handle holds the file descriptor, and the size of the mapping for mappings
+struct LinuxHandle
+{
+	int file;
+	size_t mappingSize;
+};
+
+inline HANDLE CreateFileW(const wchar_t* fileName, DWORD, DWORD, void*, DWORD, DWORD, HANDLE)
+{
+	char name[4096];
+	if (wcstombs(name, fileName, sizeof(name)) >= sizeof(name))
+		return INVALID_HANDLE_VALUE;
+
+	const int file = open(name, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (file < 0)
+		return INVALID_HANDLE_VALUE;
+	return new LinuxHandle{ file, 0 };
+}
+
+inline HANDLE CreateFileMappingW(HANDLE file, void*, DWORD, DWORD sizeHigh, DWORD sizeLow, const wchar_t*)
+{
+	const size_t size = ((size_t)sizeHigh << 32) | sizeLow;
+	if (ftruncate(((LinuxHandle*)file)->file, (off_t)size) != 0)
+		return NULL;
+	return new LinuxHandle{ ((LinuxHandle*)file)->file, size };
+}
+
+// views cover the entire mapping; their sizes are kept to unmap them
+inline std::map<const void*, size_t>& MappedViews()
+{
+	static std::map<const void*, size_t> views;
+	return views;
+}
+
+inline void* MapViewOfFile(HANDLE fileMapping, DWORD, DWORD, DWORD, size_t size)
+{
+	void* view = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, ((LinuxHandle*)fileMapping)->file, 0);
+	if (view == MAP_FAILED)
+		return NULL;
+	MappedViews()[view] = size;
+	return view;
+}
+
+// the view is written back when it is unmapped
+inline BOOL FlushViewOfFile(const void*, size_t)
+{
+	return 1;
+}
+
+inline BOOL UnmapViewOfFile(const void* view)
+{
+	auto mappedView = MappedViews().find(view);
+	if (mappedView == MappedViews().end())
+		return 0;
+	munmap((void*)view, mappedView->second);
+	MappedViews().erase(mappedView);
+	return 1;
+}
+
+inline BOOL CloseHandle(HANDLE handle)
+{
+	LinuxHandle* linuxHandle = (LinuxHandle*)handle;
+	if (!linuxHandle->mappingSize)
+		close(linuxHandle->file);
+	delete linuxHandle;
+	return 1;
+}
+
+inline BOOL SetFilePointerEx(HANDLE file, LARGE_INTEGER distance, LARGE_INTEGER*, DWORD)
+{
+	return lseek(((LinuxHandle*)file)->file, (off_t)distance.QuadPart, SEEK_SET) >= 0;
+}
+
+inline BOOL SetEndOfFile(HANDLE file)
+{
+	const int descriptor = ((LinuxHandle*)file)->file;
+	return ftruncate(descriptor, lseek(descriptor, 0, SEEK_CUR)) == 0;
+}
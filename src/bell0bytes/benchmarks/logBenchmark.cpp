@@ -0,0 +1,315 @@
+/****************************************************************************************
+* Author:	Gilles Bellot
+* Date:		16/10/2026
+*
+* Desc:		throughput and latency of the logger, against the logger it replaced
+*			- throughput: 1, 4 and 16 threads print info lines as fast as they can; the
+*			  time until the last line reached the log policy is measured, as well as
+*			  how long a print call blocks the calling thread
+*			- latency: a single line is printed and the time until it is written is
+*			  measured
+*			- the log policy counts the lines it receives, thus the benchmark fails if
+*			  a line is lost
+*			- the previous logger is reproduced below, without the service locator
+*
+*			build and run from this folder:
+*				g++ -std=c++14 -O2 -DNDEBUG -pthread -Wno-unknown-pragmas -I linux -I .. logBenchmark.cpp -o logBenchmark
+*				./logBenchmark
+*			add -DLOG_SEVERITY_MASK=0x1D to compile the debug severity out and see the
+*			cost of a disabled print
+*
+* History:
+****************************************************************************************/
+
+// INCLUDES /////////////////////////////////////////////////////////////////////////////
+
+// c++ includes
+#include <algorithm>			// sort
+#include <atomic>				// counters
+#include <chrono>				// timing
+#include <cstdio>				// printf
+#include <string>				// strings
+#include <thread>				// printing threads
+#include <vector>				// containers
+
+// bell0bytes util
+#include "log.h"
+
+// DEFINITIONS //////////////////////////////////////////////////////////////////////////
+namespace
+{
+	typedef std::chrono::steady_clock Clock;
+
+	// a log policy that counts the lines it is given instead of writing them to disk
+	class CountingLogPolicy : public util::LogPolicyInterface
+	{
+	public:
+		static std::atomic<std::size_t> nLines;
+		static std::atomic<std::size_t> nBytes;
+
+		bool openOutputStream(const std::wstring&) override { return true; }
+		void closeOutputStream() override { }
+		void write(const std::string& msg) override
+		{
+			std::size_t lines = 0;
+			for (std::size_t position = msg.find("INFO:"); position != std::string::npos; position = msg.find("INFO:", position + 5))
+				lines++;
+			nBytes += msg.size();
+			nLines += lines;
+		}
+	};
+
+	std::atomic<std::size_t> CountingLogPolicy::nLines(0);
+	std::atomic<std::size_t> CountingLogPolicy::nBytes(0);
+}
+
+namespace previous
+{
+	// the logger before the rework: each print formats through string streams under a timed mutex,
+	// and the daemon polls the shared buffer every 50 milliseconds
+	template<typename LogPolicy>
+	class Logger;
+
+	template<typename LogPolicy>
+	void loggingDaemon(Logger<LogPolicy>* logger)
+	{
+		std::unique_lock<std::timed_mutex> lock(logger->writeMutex, std::defer_lock);
+		do
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds{ 50 });
+			if (logger->logBuffer.size())
+			{
+				if (!lock.try_lock_for(std::chrono::milliseconds{ 50 }))
+					continue;
+				for (auto& x : logger->logBuffer)
+					logger->policy.write(x);
+				logger->logBuffer.clear();
+				lock.unlock();
+			}
+		} while (logger->isStillRunning.test_and_set() || logger->logBuffer.size());
+	}
+
+	template<typename LogPolicy>
+	class Logger
+	{
+	private:
+		unsigned int logLineNumber;
+		std::map<std::thread::id, std::string> threadName;
+		LogPolicy policy;
+		std::timed_mutex writeMutex;
+		std::vector<std::string> logBuffer;
+		std::thread daemon;
+		std::atomic_flag isStillRunning{ ATOMIC_FLAG_INIT };
+
+	public:
+		Logger(const std::wstring& name) : logLineNumber(0), threadName(), policy(), writeMutex(), logBuffer()
+		{
+			if (policy.openOutputStream(name))
+			{
+				isStillRunning.test_and_set();
+				daemon = std::thread{ loggingDaemon<LogPolicy>, this };
+			}
+			else
+				throw std::runtime_error("Unable to open the log file!");
+		}
+		~Logger()
+		{
+			isStillRunning.clear();
+			daemon.join();
+			policy.closeOutputStream();
+		}
+
+		void setThreadName(const std::string& name) { threadName[std::this_thread::get_id()] = name; }
+
+		template<util::SeverityType severity>
+		void print(std::stringstream stream)
+		{
+			std::stringstream logStream;
+			if (!(severity == util::SeverityType::config))
+			{
+				SYSTEMTIME localTime;
+				GetLocalTime(&localTime);
+
+				if (logLineNumber != 0)
+					logStream << "\r\n";
+				logStream << logLineNumber++ << ": " << localTime.wDay << "/" << localTime.wMonth << "/" << localTime.wYear << " " << localTime.wHour << ":" << localTime.wMinute << ":" << localTime.wSecond << "\t";
+
+				switch (severity)
+				{
+				case util::SeverityType::info:
+					logStream << "INFO:    ";
+					break;
+				case util::SeverityType::debug:
+					logStream << "DEBUG:   ";
+					break;
+				case util::SeverityType::warning:
+					logStream << "WARNING: ";
+					break;
+				case util::SeverityType::error:
+					logStream << "ERROR:   ";
+					break;
+				default:
+					break;
+				};
+
+				logStream << threadName[std::this_thread::get_id()] << ":\t";
+			}
+
+			logStream << stream.str();
+			std::lock_guard<std::timed_mutex> lock(writeMutex);
+			logBuffer.push_back(logStream.str());
+		}
+
+		template<util::SeverityType severity>
+		void print(std::string msg)
+		{
+			std::stringstream stream;
+			stream << msg.c_str();
+			this->print<severity>(std::stringstream(stream.str()));
+		}
+
+		template<typename Policy>
+		friend void loggingDaemon(Logger<Policy>* logger);
+	};
+}
+
+namespace
+{
+	const std::size_t linesPerRun = 200000;				// the lines printed per throughput run, split between the threads
+
+	struct Throughput
+	{
+		double linesPerSecond;							// until the last line was handed to the log policy
+		double medianPrint;								// the time a print call blocks its thread, in microseconds
+		double p99Print;
+		bool valid;
+	};
+
+	// wait until the policy received the given number of lines, or give up after 10 seconds
+	bool waitForLines(const std::size_t nLines)
+	{
+		const auto deadline = Clock::now() + std::chrono::seconds(10);
+		while (CountingLogPolicy::nLines.load() < nLines)
+		{
+			if (Clock::now() > deadline)
+				return false;
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+		}
+		return true;
+	}
+
+	template<class Logger, util::SeverityType severity = util::SeverityType::info>
+	Throughput measureThroughput(const unsigned int nThreads)
+	{
+		CountingLogPolicy::nLines = 0;
+		Logger logger(L"benchmark.log");
+
+		const std::size_t linesPerThread = linesPerRun / nThreads;
+		std::atomic<unsigned int> nReady(0);
+		std::atomic<bool> start(false);
+		std::mutex nameMutex;
+		std::vector<std::vector<float> > printTimes(nThreads);
+
+		std::vector<std::thread> threads;
+		for (unsigned int t = 0; t < nThreads; t++)
+		{
+			threads.emplace_back([&, t]()
+			{
+				{
+					// the previous logger does not protect its thread name map
+					std::lock_guard<std::mutex> lock(nameMutex);
+					logger.setThreadName("Worker " + std::to_string(t));
+				}
+				printTimes[t].reserve(linesPerThread);
+				nReady++;
+				while (!start.load())
+					std::this_thread::yield();
+
+				for (std::size_t i = 0; i < linesPerThread; i++)
+				{
+					const auto before = Clock::now();
+					logger.template print<severity>("Cat " + std::to_string(i % 100) + " took " + std::to_string(i % 7) + " damage.");
+					printTimes[t].push_back(std::chrono::duration<float, std::micro>(Clock::now() - before).count());
+				}
+			});
+		}
+
+		while (nReady.load() < nThreads)
+			std::this_thread::yield();
+
+		const auto startTime = Clock::now();
+		start.store(true);
+		for (auto& thread : threads)
+			thread.join();
+
+		Throughput result;
+		const std::size_t nExpected = (severity == util::SeverityType::info) ? linesPerThread * nThreads : 0;
+		result.valid = waitForLines(nExpected);
+		result.linesPerSecond = linesPerThread * nThreads / std::chrono::duration<double>(Clock::now() - startTime).count();
+
+		std::vector<float> times;
+		for (const auto& threadTimes : printTimes)
+			times.insert(times.end(), threadTimes.begin(), threadTimes.end());
+		std::sort(times.begin(), times.end());
+		result.medianPrint = times[times.size() / 2];
+		result.p99Print = times[times.size() * 99 / 100];
+		return result;
+	}
+
+	// the median time from a print call until the line reaches the log policy, in microseconds
+	template<class Logger>
+	double measureLatency()
+	{
+		CountingLogPolicy::nLines = 0;
+		Logger logger(L"benchmark.log");
+		logger.setThreadName("Main");
+
+		std::vector<double> latencies;
+		for (std::size_t i = 1; i <= 40; i++)
+		{
+			const auto before = Clock::now();
+			logger.template print<util::SeverityType::info>("Single line.");
+			while (CountingLogPolicy::nLines.load() < i)
+				std::this_thread::yield();
+			latencies.push_back(std::chrono::duration<double, std::micro>(Clock::now() - before).count());
+
+			// let the daemon fall asleep again
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		std::sort(latencies.begin(), latencies.end());
+		return latencies[latencies.size() / 2];
+	}
+}
+
+int main()
+{
+	typedef previous::Logger<CountingLogPolicy> PreviousLogger;
+	typedef util::Logger<CountingLogPolicy> CurrentLogger;
+
+	bool valid = true;
+
+	std::printf("%zu lines per run, %u hardware threads\n\n", linesPerRun, std::thread::hardware_concurrency());
+	std::printf("threads   logger     lines/s    print median    print p99\n");
+	for (unsigned int nThreads : { 1u, 4u, 16u })
+	{
+		const Throughput previousResult = measureThroughput<PreviousLogger>(nThreads);
+		const Throughput currentResult = measureThroughput<CurrentLogger>(nThreads);
+		valid &= previousResult.valid && currentResult.valid;
+
+		std::printf("%7u   previous   %7.2f M   %9.3f us   %9.3f us\n", nThreads, previousResult.linesPerSecond / 1e6, previousResult.medianPrint, previousResult.p99Print);
+		std::printf("%7u   current    %7.2f M   %9.3f us   %9.3f us\n", nThreads, currentResult.linesPerSecond / 1e6, currentResult.medianPrint, currentResult.p99Print);
+	}
+
+	const Throughput disabled = measureThroughput<CurrentLogger, util::SeverityType::debug>(1);
+	std::printf("\ndebug lines, %s at compile time: %.3f us per print, median\n", util::SeverityFilter<util::SeverityType::debug>::enabled ? "enabled" : "disabled", disabled.medianPrint);
+
+	std::printf("\nlatency until a single line is written: previous %.0f us, current %.0f us (median)\n", measureLatency<PreviousLogger>(), measureLatency<CurrentLogger>());
+
+	if (!valid)
+	{
+		std::printf("lines were lost\n");
+		return 1;
+	}
+	return 0;
+}
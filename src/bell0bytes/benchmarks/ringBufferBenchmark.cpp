@@ -0,0 +1,250 @@
+/****************************************************************************************
+* Author:	Gilles Bellot
+* Date:		16/10/2026
+*
+* Desc:		compares the lock-free ring buffer of the event queue with the mutex-based
+*			thread-safe queue it replaced, at 1, 4 and 16 producer threads
+*			- each producer sends damage depesches with increasing numbers to its own
+*			  destination, while the main thread drains the queue, as dispatchMessages does
+*			- the order of the depesches of each producer is checked, thus the benchmark
+*			  fails if a message is lost, duplicated or reordered
+*			- the overflowing ring buffer the DirectXApp uses never makes a producer wait;
+*			  it is also run with a ring of 8 slots, where most depesches overflow
+*
+*			build and run from this folder:
+*				g++ -std=c++14 -O2 -pthread -I .. ringBufferBenchmark.cpp ../depesche.cpp -o ringBufferBenchmark
+*				./ringBufferBenchmark
+*
+* History:
+****************************************************************************************/
+
+// INCLUDES /////////////////////////////////////////////////////////////////////////////
+
+// c++ includes
+#include <atomic>				// start signal
+#include <chrono>				// timing
+#include <cstdio>				// printf
+#include <memory>				// unique pointers
+#include <thread>				// producer threads
+#include <vector>				// containers
+
+// bell0bytes util
+#include "ringBuffer.h"
+#include "safeQueue.h"
+
+// bell0bytes core
+#include "depesche.h"
+
+// DEFINITIONS //////////////////////////////////////////////////////////////////////////
+namespace
+{
+	const std::size_t queueCapacity = 4096;				// the capacity of the event queue of the DirectXApp
+	const std::size_t messagesPerRun = 1 << 21;			// the messages sent per run, split between the producers
+	const unsigned int nRuns = 3;						// the best run is reported
+
+	class Destination : public core::DepescheDestination
+	{
+	public:
+		unsigned int nextMessage = 0;					// the number the next depesche must carry
+		bool inOrder = true;							// false iff a depesche was lost, duplicated or reordered
+	};
+
+	struct Result
+	{
+		double messagesPerSecond;
+		std::size_t nFullRetries;						// the number of times a producer found the queue full
+		bool valid;
+	};
+
+	// adapters to give both queues the same surface
+	struct RingQueue
+	{
+		util::RingBuffer<core::Depesche> queue;
+		std::vector<core::Depesche> drained;
+
+		RingQueue() : queue(queueCapacity), drained() { drained.reserve(queueCapacity); }
+
+		bool tryEnqueue(const core::Depesche& depesche) { return queue.enqueue(depesche); }
+		bool retries() const { return true; }
+
+		template<class Function>
+		std::size_t drain(Function&& onDepesche)
+		{
+			std::size_t nDrained = queue.drainInto(drained);
+			for (const core::Depesche& depesche : drained)
+				onDepesche(depesche);
+			drained.clear();
+			return nDrained;
+		}
+	};
+
+	// the producers never retry; nFullRetries counts the depesches kept in the overflow vector instead
+	template<std::size_t capacity>
+	struct OverflowQueue
+	{
+		util::OverflowingRingBuffer<core::Depesche> queue;
+		std::vector<core::Depesche> drained;
+
+		OverflowQueue() : queue(capacity), drained() { drained.reserve(capacity); }
+
+		bool tryEnqueue(const core::Depesche& depesche) { return queue.enqueue(depesche); }
+		bool retries() const { return false; }
+
+		template<class Function>
+		std::size_t drain(Function&& onDepesche)
+		{
+			std::size_t nDrained = queue.drainInto(drained);
+			for (const core::Depesche& depesche : drained)
+				onDepesche(depesche);
+			drained.clear();
+			return nDrained;
+		}
+	};
+
+	struct MutexQueue
+	{
+		util::ThreadSafeQueue<core::Depesche> queue;
+
+		bool tryEnqueue(const core::Depesche& depesche) { core::Depesche copy(depesche); queue.enqueue(copy); return true; }
+		bool retries() const { return true; }
+
+		template<class Function>
+		std::size_t drain(Function&& onDepesche)
+		{
+			// isEmpty does not take the lock, so dequeue until the empty depesche is returned
+			std::size_t nDrained = 0;
+			for (;;)
+			{
+				const core::Depesche depesche = queue.dequeue();
+				if (!depesche.destination)
+					return nDrained;
+				onDepesche(depesche);
+				nDrained++;
+			}
+		}
+	};
+
+	template<class Queue>
+	Result run(const unsigned int nProducers)
+	{
+		std::unique_ptr<Queue> queue(new Queue());
+		std::vector<Destination> destinations(nProducers);
+		core::DepescheSender sender;
+
+		const std::size_t messagesPerProducer = messagesPerRun / nProducers;
+		std::atomic<bool> start(false);
+		std::atomic<std::size_t> nFullRetries(0);
+
+		std::vector<std::thread> producers;
+		for (unsigned int p = 0; p < nProducers; p++)
+		{
+			producers.emplace_back([&, p]()
+			{
+				while (!start.load(std::memory_order_acquire))
+					std::this_thread::yield();
+
+				std::size_t nRetries = 0;
+				for (std::size_t i = 0; i < messagesPerProducer; i++)
+				{
+					const core::Depesche depesche = core::Depesche::create<core::Damage>(sender, destinations[p], (unsigned int)i);
+					while (!queue->tryEnqueue(depesche))
+					{
+						nRetries++;
+						if (!queue->retries())
+							break;
+						std::this_thread::yield();
+					}
+				}
+				nFullRetries += nRetries;
+			});
+		}
+
+		const auto startTime = std::chrono::steady_clock::now();
+		start.store(true, std::memory_order_release);
+
+		// the consumer
+		std::size_t nReceived = 0;
+		const std::size_t nExpected = messagesPerProducer * nProducers;
+		while (nReceived < nExpected)
+		{
+			const std::size_t nDrained = queue->drain([](const core::Depesche& depesche)
+			{
+				Destination& destination = static_cast<Destination&>(*depesche.destination);
+				destination.inOrder &= depesche.getMessage<core::Damage>() == destination.nextMessage;
+				destination.nextMessage++;
+			});
+
+			if (nDrained == 0)
+				std::this_thread::yield();
+			nReceived += nDrained;
+		}
+
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+		for (auto& producer : producers)
+			producer.join();
+
+		Result result;
+		result.messagesPerSecond = nExpected / seconds;
+		result.nFullRetries = nFullRetries.load();
+		result.valid = queue->drain([](const core::Depesche&) {}) == 0;
+		for (const Destination& destination : destinations)
+			result.valid &= destination.inOrder && destination.nextMessage == messagesPerProducer;
+		return result;
+	}
+
+	template<class Queue>
+	Result best(const unsigned int nProducers)
+	{
+		Result bestResult = run<Queue>(nProducers);
+		for (unsigned int i = 1; i < nRuns; i++)
+		{
+			Result result = run<Queue>(nProducers);
+			if (result.messagesPerSecond > bestResult.messagesPerSecond)
+				bestResult.messagesPerSecond = result.messagesPerSecond, bestResult.nFullRetries = result.nFullRetries;
+			bestResult.valid &= result.valid;
+		}
+		return bestResult;
+	}
+}
+
+int main()
+{
+	std::printf("%u depesches per run, ring capacity %zu, %u hardware threads\n\n", (unsigned int)messagesPerRun, queueCapacity, std::thread::hardware_concurrency());
+	std::printf("producers   ThreadSafeQueue      RingBuffer   speedup   full ring retries   OverflowingRingBuffer   overflowed\n");
+
+	bool valid = true;
+	for (unsigned int nProducers : { 1u, 4u, 16u })
+	{
+		const Result mutexQueue = best<MutexQueue>(nProducers);
+		const Result ringBuffer = best<RingQueue>(nProducers);
+		const Result overflowBuffer = best<OverflowQueue<queueCapacity>>(nProducers);
+
+		std::printf("%9u   %9.2f M/s   %9.2f M/s   %6.2fx   %17zu   %17.2f M/s   %10zu\n", nProducers, mutexQueue.messagesPerSecond / 1e6, ringBuffer.messagesPerSecond / 1e6, ringBuffer.messagesPerSecond / mutexQueue.messagesPerSecond, ringBuffer.nFullRetries,
+			overflowBuffer.messagesPerSecond / 1e6, overflowBuffer.nFullRetries);
+
+		if (!mutexQueue.valid || !ringBuffer.valid || !overflowBuffer.valid)
+		{
+			std::printf("depesches were lost, duplicated or reordered with %u producers\n", nProducers);
+			valid = false;
+		}
+	}
+
+	// a tiny ring: most depesches go through the overflow vector, and must still arrive in order
+	std::printf("\nOverflowingRingBuffer with 8 slots\n");
+	std::printf("producers   OverflowingRingBuffer   overflowed\n");
+	for (unsigned int nProducers : { 1u, 4u, 16u })
+	{
+		const Result overflowBuffer = best<OverflowQueue<8>>(nProducers);
+
+		std::printf("%9u   %17.2f M/s   %10zu\n", nProducers, overflowBuffer.messagesPerSecond / 1e6, overflowBuffer.nFullRetries);
+
+		if (!overflowBuffer.valid)
+		{
+			std::printf("depesches were lost, duplicated or reordered with %u producers and 8 slots\n", nProducers);
+			valid = false;
+		}
+	}
+
+	return valid ? 0 : 1;
+}
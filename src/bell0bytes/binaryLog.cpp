@@ -0,0 +1,198 @@
+// INCLUDES /////////////////////////////////////////////////////////////////////////////
+
+// c++ includes
+#include <cstddef>
+#include <stdexcept>
+
+// bell0bytes
+#include "binaryLog.h"
+
+namespace util
+{
+	// FUNCTIONS ////////////////////////////////////////////////////////////////////////
+
+	/////////////////////////////////////////////////////////////////////////////////////////
+	/////////////////////////////////// Format Strings //////////////////////////////////////
+	/////////////////////////////////////////////////////////////////////////////////////////
+	BinaryLogFormat::BinaryLogFormat(const char* const format) : format(format), formatID(createFormatID()), definedInLogger(0)
+	{ }
+
+	uint32_t BinaryLogFormat::createFormatID()
+	{
+		// each format string gets a unique identifier
+		static std::atomic<uint32_t> nFormats(0);
+		return ++nFormats;
+	}
+
+	/////////////////////////////////////////////////////////////////////////////////////////
+	/////////////////////////////////// Binary Log Policy ///////////////////////////////////
+	/////////////////////////////////////////////////////////////////////////////////////////
+	BinaryLogPolicy::BinaryLogPolicy() : file(INVALID_HANDLE_VALUE), fileMapping(NULL), view(nullptr), capacity(0), writeOffset(0), nDroppedRecords(0)
+	{ }
+
+	BinaryLogPolicy::~BinaryLogPolicy()
+	{
+		closeOutputStream();
+	}
+
+	// the openOutputStream function creates the file on the hard drive and maps it into memory
+	bool BinaryLogPolicy::openOutputStream(const std::wstring& filename, const size_t capacity)
+	{
+		if (capacity <= sizeof(binaryLog::FileHeader))
+			return false;
+
+		// create the file
+		file = CreateFileW(filename.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (file == INVALID_HANDLE_VALUE)
+			return false;
+
+		// map the entire capacity; the file is truncated to its actual size when the stream is closed
+		const unsigned long long mappingSize = capacity;
+		fileMapping = CreateFileMappingW(file, NULL, PAGE_READWRITE, (DWORD)(mappingSize >> 32), (DWORD)(mappingSize & 0xFFFFFFFF), NULL);
+		if (!fileMapping)
+		{
+			closeOutputStream();
+			return false;
+		}
+
+		view = (char*)MapViewOfFile(fileMapping, FILE_MAP_WRITE, 0, 0, capacity);
+		if (!view)
+		{
+			closeOutputStream();
+			return false;
+		}
+		this->capacity = capacity;
+
+		// write the file header
+		binaryLog::FileHeader header = { };
+		header.magic = binaryLog::fileMagic;
+		header.version = binaryLog::fileVersion;
+		QueryPerformanceFrequency((LARGE_INTEGER*)&header.ticksPerSecond);
+		QueryPerformanceCounter((LARGE_INTEGER*)&header.startTicks);
+
+		SYSTEMTIME localTime;
+		GetLocalTime(&localTime);
+		header.year = localTime.wYear;
+		header.month = localTime.wMonth;
+		header.day = localTime.wDay;
+		header.hour = localTime.wHour;
+		header.minute = localTime.wMinute;
+		header.second = localTime.wSecond;
+
+		std::memcpy(view, &header, sizeof(header));
+		writeOffset.store(sizeof(header));
+
+		// return success
+		return true;
+	}
+
+	// the closeOutputStream function unmaps the file and cuts it to the size actually written
+	void BinaryLogPolicy::closeOutputStream()
+	{
+		if (view)
+		{
+			FlushViewOfFile(view, 0);
+			UnmapViewOfFile(view);
+			view = nullptr;
+		}
+
+		if (fileMapping)
+		{
+			CloseHandle(fileMapping);
+			fileMapping = NULL;
+		}
+
+		if (file != INVALID_HANDLE_VALUE)
+		{
+			const size_t offset = writeOffset.load();
+			LARGE_INTEGER size;
+			size.QuadPart = (LONGLONG)(offset < capacity ? offset : capacity);
+			if (SetFilePointerEx(file, size, NULL, FILE_BEGIN))
+				SetEndOfFile(file);
+
+			CloseHandle(file);
+			file = INVALID_HANDLE_VALUE;
+		}
+
+		capacity = 0;
+	}
+
+	// the reserve function claims the next bytes of the file
+	char* BinaryLogPolicy::reserve(const size_t size)
+	{
+		if (!view)
+			return nullptr;
+
+		const size_t offset = writeOffset.fetch_add(size);
+		if (offset + size > capacity)
+		{
+			// the file is full - never move the offset back, so that the records written so far stay intact
+			nDroppedRecords++;
+			return nullptr;
+		}
+
+		// write the size at once, so that the decoder can skip the record should it never be completed
+		char* const record = view + offset;
+		const uint16_t recordSize = (uint16_t)size;
+		std::memcpy(record + offsetof(binaryLog::RecordHeader, size), &recordSize, sizeof(recordSize));
+		return record;
+	}
+
+	// the commit function publishes the record; all previous writes to the record become visible first
+	void BinaryLogPolicy::commit(char* const record, const binaryLog::RecordTypes type)
+	{
+		static_assert(sizeof(std::atomic<uint16_t>) == sizeof(uint16_t), "The record type can not be written atomically!");
+		reinterpret_cast<std::atomic<uint16_t>*>(record + offsetof(binaryLog::RecordHeader, type))->store(type, std::memory_order_release);
+	}
+
+	/////////////////////////////////////////////////////////////////////////////////////////
+	/////////////////////////////////// Binary Logger ///////////////////////////////////////
+	/////////////////////////////////////////////////////////////////////////////////////////
+	BinaryLogger::BinaryLogger(const std::wstring& name, const size_t capacity) : policy(), loggerID(createLoggerID())
+	{
+		if (!policy.openOutputStream(name, capacity))
+			throw std::runtime_error("Unable to open the binary log file!");
+	}
+
+	BinaryLogger::~BinaryLogger()
+	{
+		policy.closeOutputStream();
+	}
+
+	unsigned int BinaryLogger::createLoggerID()
+	{
+		// each logger gets a unique identifier
+		static std::atomic<unsigned int> nLoggers(0);
+		return ++nLoggers;
+	}
+
+	bool BinaryLogger::defineFormat(const BinaryLogFormat& format)
+	{
+		// the format is marked as defined once its record is committed; threads using it for the first time
+		// at the same moment may each write the record, which the decoder accepts
+		if (format.definedInLogger.load(std::memory_order_acquire) == loggerID)
+			return true;
+
+		const size_t length = strlen(format.format);
+		const size_t size = binaryLog::alignedRecordSize(sizeof(binaryLog::RecordHeader) + length);
+		if (size > binaryLog::maxRecordSize)
+			return false;
+
+		char* record = policy.reserve(size);
+		if (!record)
+			return false;
+
+		binaryLog::RecordHeader header;
+		header.type = binaryLog::Uncommitted;
+		header.size = (uint16_t)size;
+		header.formatID = format.formatID;
+		std::memcpy(record + sizeof(header), format.format, length);
+		std::memset(record + sizeof(header) + length, 0, size - sizeof(header) - length);
+		std::memcpy(record, &header, sizeof(header));
+
+		// the record is complete
+		policy.commit(record, binaryLog::FormatRecord);
+		format.definedInLogger.store(loggerID, std::memory_order_release);
+		return true;
+	}
+}
\ No newline at end of file
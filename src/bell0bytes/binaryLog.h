@@ -0,0 +1,189 @@
+#pragma once
+
+/****************************************************************************************
+* Author:	Gilles Bellot
+* Date:		16/10/2026
+*
+* Desc:		binary event logger for hot code paths
+*			instead of formatting text, each message is recorded as the identifier of its
+*			format string, a timestamp, the thread ID and the raw arguments
+*			the records are appended to a memory-mapped file without any locks
+*			use the binaryLogDecoder tool to turn the file back into text
+*
+*			usage:	static const util::BinaryLogFormat format("Streamed {} bytes from {}.");
+*					binaryLogger->print<util::SeverityType::debug>(format, nBytes, fileName);
+*
+* History:
+****************************************************************************************/
+
+// INCLUDES /////////////////////////////////////////////////////////////////////////////
+
+// windows includes
+#include <Windows.h>
+
+// c++ includes
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+// bell0bytes util
+#include "log.h"							// severity types
+#include "binaryLogFormat.h"				// the file layout
+
+namespace util
+{
+	// CLASSES //////////////////////////////////////////////////////////////////////////////
+
+	// a format string - create one static instance per call site
+	class BinaryLogFormat
+	{
+	private:
+		const char* const format;								// the format string, "{}" is replaced by the next argument
+		const uint32_t formatID;								// unique identifier of the format string
+		mutable std::atomic<unsigned int> definedInLogger;		// the last logger the format was written to
+
+		static uint32_t createFormatID();						// returns a unique identifier for each format string
+
+	public:
+		BinaryLogFormat(const char* const format);
+
+		friend class BinaryLogger;
+	};
+
+	// policy to append records to a memory-mapped file
+	class BinaryLogPolicy
+	{
+	private:
+		HANDLE file;								// the log file
+		HANDLE fileMapping;							// the file mapping object
+		char* view;									// the mapped view of the file
+		size_t capacity;							// the size of the mapped view
+		std::atomic<size_t> writeOffset;			// the offset of the next record
+		std::atomic<unsigned int> nDroppedRecords;	// the number of records that did not fit into the file
+
+	public:
+		BinaryLogPolicy();
+		~BinaryLogPolicy();
+
+		bool openOutputStream(const std::wstring& filename, const size_t capacity);
+		void closeOutputStream();
+
+		// reserve space for a record - lock-free, can be called from any thread
+		// returns nullptr if the file is full
+		char* reserve(const size_t size);
+
+		// publish a record written to the reserved space - the type is stored last, with release semantics
+		void commit(char* const record, const binaryLog::RecordTypes type);
+
+		const unsigned int getNumberOfDroppedRecords() const { return nDroppedRecords.load(); };
+	};
+
+	// the binary logger
+	class BinaryLogger
+	{
+	private:
+		BinaryLogPolicy policy;						// the memory-mapped file
+		const unsigned int loggerID;				// unique identifier of this logger
+
+		// write the format string to the file, the first time it is used by this logger
+		// returns false if the format string could not be written
+		bool defineFormat(const BinaryLogFormat& format);
+
+		// returns a unique identifier for each logger
+		static unsigned int createLoggerID();
+
+		// encode the arguments
+		template<typename T>
+		static typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value, size_t>::type encodedSize(const T&) { return 1 + (sizeof(T) <= 4 ? 4 : 8); }
+		template<typename T>
+		static typename std::enable_if<std::is_floating_point<T>::value, size_t>::type encodedSize(const T&) { return 1 + sizeof(double); }
+		static size_t encodedSize(const char* const string) { return 1 + sizeof(uint16_t) + stringLength(string, string ? strlen(string) : 0); }
+		static size_t encodedSize(const std::string& string) { return 1 + sizeof(uint16_t) + stringLength(string.c_str(), string.size()); }
+
+		template<typename T>
+		static typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type encode(char*& out, const T& value)
+		{
+			if (sizeof(T) <= 4)
+				encodeValue(out, std::is_signed<T>::value ? binaryLog::Int32 : binaryLog::UInt32, (uint32_t)value);
+			else
+				encodeValue(out, std::is_signed<T>::value ? binaryLog::Int64 : binaryLog::UInt64, (uint64_t)value);
+		}
+		template<typename T>
+		static typename std::enable_if<std::is_floating_point<T>::value>::type encode(char*& out, const T& value) { encodeValue(out, binaryLog::Double, (double)value); }
+		static void encode(char*& out, const char* const string) { encodeString(out, string ? string : "", string ? strlen(string) : 0); }
+		static void encode(char*& out, const std::string& string) { encodeString(out, string.c_str(), string.size()); }
+
+		static size_t stringLength(const char* const, const size_t length) { return length < binaryLog::maxStringLength ? length : binaryLog::maxStringLength; }
+		template<typename T>
+		static void encodeValue(char*& out, const binaryLog::ArgumentTypes type, const T value)
+		{
+			*out++ = (char)type;
+			std::memcpy(out, &value, sizeof(T));
+			out += sizeof(T);
+		}
+		static void encodeString(char*& out, const char* const string, const size_t length)
+		{
+			const uint16_t truncatedLength = (uint16_t)stringLength(string, length);
+			*out++ = (char)binaryLog::String;
+			std::memcpy(out, &truncatedLength, sizeof(truncatedLength));
+			out += sizeof(truncatedLength);
+			std::memcpy(out, string, truncatedLength);
+			out += truncatedLength;
+		}
+
+	public:
+		// constructor and destructor
+		BinaryLogger(const std::wstring& name, const size_t capacity = 16 * 1024 * 1024);
+		~BinaryLogger();
+
+		template<SeverityType severity, typename... Arguments>
+		void print(const BinaryLogFormat& format, const Arguments&... arguments);	// record a message
+
+		const unsigned int getNumberOfDroppedRecords() const { return policy.getNumberOfDroppedRecords(); };
+	};
+
+	template<SeverityType severity, typename... Arguments>
+	void BinaryLogger::print(const BinaryLogFormat& format, const Arguments&... arguments)
+	{
+		if (!SeverityFilter<severity>::enabled)
+			return;
+
+		// make sure the decoder knows the format string - the message could not be decoded without it
+		if (!defineFormat(format))
+			return;
+
+		// compute the size of the record
+		size_t size = sizeof(binaryLog::MessageHeader);
+		int expandSize[] = { 0, ((size += encodedSize(arguments)), 0)... };
+		(void)expandSize;
+		size = binaryLog::alignedRecordSize(size);
+		if (size > binaryLog::maxRecordSize)
+			return;
+
+		// reserve space in the file
+		char* record = policy.reserve(size);
+		if (!record)
+			return;
+
+		// write the arguments
+		char* out = record + sizeof(binaryLog::MessageHeader);
+		int expandEncode[] = { 0, (encode(out, arguments), 0)... };
+		(void)expandEncode;
+
+		// write the header
+		binaryLog::MessageHeader header;
+		header.record.type = binaryLog::Uncommitted;
+		header.record.size = (uint16_t)size;
+		header.record.formatID = format.formatID;
+		header.threadID = GetCurrentThreadId();
+		header.severity = (uint8_t)severity;
+		header.nArguments = (uint8_t)sizeof...(Arguments);
+		header.reserved = 0;
+		QueryPerformanceCounter((LARGE_INTEGER*)&header.ticks);
+		std::memcpy(record, &header, sizeof(header));
+
+		// the record is complete
+		policy.commit(record, binaryLog::MessageRecord);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,89 @@
+#pragma once
+
+/****************************************************************************************
+* Author:	Gilles Bellot
+* Date:		16/10/2026
+*
+* Desc:		layout of the binary log files written by the binary logger
+*			shared between the game and the offline decoder - standard C++ only
+*
+*			file:		FileHeader, followed by records until the end of the file
+*			records:	FormatRecord:	RecordHeader + the format string (padded with zeros)
+*						MessageRecord:	MessageHeader + the arguments
+*						each record starts at a multiple of recordAlignment
+*						the size is written when the record is reserved, the type is written
+*						last, thus a record of type Uncommitted was reserved but never completed
+*			arguments:	one ArgumentTypes byte, followed by the raw value
+*						strings: uint16_t length, followed by the characters
+*
+*			format strings use "{}" as placeholder for the next argument
+*
+* History:
+****************************************************************************************/
+
+// INCLUDES /////////////////////////////////////////////////////////////////////////////
+
+// c++ includes
+#include <cstddef>
+#include <cstdint>
+
+// DEFINITIONS //////////////////////////////////////////////////////////////////////////
+namespace util
+{
+	namespace binaryLog
+	{
+		const uint32_t fileMagic = 0x474F4C42;		// "BLOG"
+		const uint32_t fileVersion = 2;
+
+		// the header at the start of each file
+		struct FileHeader
+		{
+			uint32_t magic;					// fileMagic
+			uint32_t version;				// fileVersion
+			uint64_t ticksPerSecond;		// the frequency of the timestamps
+			uint64_t startTicks;			// the timestamp at the moment the file was created
+			uint16_t year, month, day;		// the local time at the moment the file was created
+			uint16_t hour, minute, second;
+			uint32_t reserved;
+		};
+
+		// the high byte of the committed record types is a marker, to resynchronize after damaged records
+		const uint16_t recordMarker = 0xB100;
+		enum RecordTypes : uint16_t { Uncommitted = 0, FormatRecord = recordMarker | 1, MessageRecord = recordMarker | 2 };
+
+		// the header of each record
+		struct RecordHeader
+		{
+			uint16_t type;					// RecordTypes - written last, with release semantics
+			uint16_t size;					// size of the entire record, in bytes
+			uint32_t formatID;				// the format string defined (FormatRecord) or used (MessageRecord)
+		};
+
+		// the header of a message record
+		struct MessageHeader
+		{
+			RecordHeader record;
+			uint32_t threadID;				// the thread that printed the message
+			uint8_t severity;				// util::SeverityType
+			uint8_t nArguments;				// the number of arguments following the header
+			uint16_t reserved;
+			uint64_t ticks;					// the timestamp
+		};
+
+		enum ArgumentTypes : uint8_t { Int32 = 1, UInt32, Int64, UInt64, Double, String };
+
+		const uint16_t maxStringLength = 1024;		// longer strings are truncated
+		const uint32_t recordAlignment = 8;
+		const uint32_t maxRecordSize = 0xFFF8;		// records larger than this are dropped
+
+		// the size of a record, including the padding to the next record
+		inline size_t alignedRecordSize(const size_t size) { return (size + recordAlignment - 1) & ~(size_t)(recordAlignment - 1); }
+
+		// a record is complete iff its type is one of the committed types
+		inline bool isCommitted(const uint16_t type) { return type == FormatRecord || type == MessageRecord; }
+
+		static_assert(sizeof(FileHeader) == 40, "Binary log file header size mismatch!");
+		static_assert(sizeof(RecordHeader) == 8, "Binary log record header size mismatch!");
+		static_assert(sizeof(MessageHeader) == 24, "Binary log message header size mismatch!");
+	}
+}
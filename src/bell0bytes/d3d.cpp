@@ -1,11 +1,3 @@
-// Lua and Sol
-//#pragma warning( push )
-//#pragma warning( disable : 4127)	// disable constant if expr warning
-//#pragma warning( disable : 4702)	// disable unreachable code warning
-#include <sol.hpp>
-//#pragma warning( pop ) 
-#pragma comment(lib, "liblua53.a")
-
 // the header
 #include "d3d.h"
 
@@ -527,74 +519,31 @@ namespace graphics
 	/////////////////////////////////////////////////////////////////////////////////////////
 	util::Expected<void> Direct3D::writeCurrentModeDescriptionToConfigurationFile() const
 	{
-		// create the string to print
-		std::string resolution = "\tresolution = { width = " + std::to_string(currentModeDescription.Width) + ", height = " + std::to_string(currentModeDescription.Height) + " }";
-		// append name of the log file to the path
-		std::wstring pathToPrefFile = dxApp.getFileSystemComponent().getPathToConfigurationFiles() + L"\\" + dxApp.getFileSystemComponent().getPrefsFile();
-
-		// read the file
-		std::vector<std::string> data;
-		std::string input;
-
-		std::ifstream prefFileStreamIn(pathToPrefFile.c_str());
-		if (prefFileStreamIn.good())
-		{
-			while (std::getline(prefFileStreamIn, input))
-				data.push_back(input);
-			prefFileStreamIn.close();
-
-			// modify the stream
-			for (auto& line : data)
-			{
-				if (line.find("resolution") != std::string::npos)
-				{
-					line.replace(0, resolution.size(), resolution);
-					break;
-				}
-			}
-		}
-		else
-			return std::runtime_error("Unable to read the configuration file!");
-
-		// write the modified stream back to the file
-		std::ofstream prefFileStreamOut(pathToPrefFile.c_str());
-		if (prefFileStreamOut.good())
-		{
-			for (auto const& line : data)
-				prefFileStreamOut << line << std::endl;
-		}
-		else
-			return std::runtime_error("Unable to write to the configuration file!");
+		// update the resolution in the cached configuration and write it back to the file
+		fileSystem::UserConfiguration configuration = dxApp.getFileSystemComponent().getConfiguration();
+		configuration.width = currentModeDescription.Width;
+		configuration.height = currentModeDescription.Height;
+		configuration.index = (int)currentModeIndex;
 
-		return {};
+		return dxApp.getFileSystemComponent().saveConfiguration(configuration);
 	}
 	util::Expected<void> Direct3D::readConfigurationFile()
 	{
 		if (dxApp.getFileSystemComponent().hasValidConfigurationFile())
 		{
-			// configuration file exists, try to read from it
-			std::wstring pathToPrefFile = dxApp.getFileSystemComponent().getPathToConfigurationFiles() + L"\\" + dxApp.getFileSystemComponent().getPrefsFile();
+			// read from the cached configuration
+			const fileSystem::UserConfiguration& configuration = dxApp.getFileSystemComponent().getConfiguration();
 
-			try
-			{
-				sol::state lua;
-				lua.script_file(util::StringConverter::ws2s(pathToPrefFile));
-
-				// read fullscreen
-				startInFullscreen = lua["config"]["fullscreen"].get_or(false);
+			// read fullscreen
+			startInFullscreen = configuration.fullscreen;
 
-				// read index
-				currentModeIndex = lua["config"]["resolution"]["index"].get_or(-1);
+			// read index
+			currentModeIndex = configuration.index;
 #ifndef NDEBUG
-				std::stringstream res;
-				res << "The fullscreen mode was read from the LUA configuration file: " << std::boolalpha << startInFullscreen << ".";
-				util::ServiceLocator::getFileLogger()->print<util::SeverityType::info>(res.str());
+			std::stringstream res;
+			res << "The fullscreen mode was read from the LUA configuration file: " << std::boolalpha << startInFullscreen << ".";
+			util::ServiceLocator::getFileLogger()->print<util::SeverityType::info>(res.str());
 #endif
-			}
-			catch (std::exception)
-			{
-				util::ServiceLocator::getFileLogger()->print<util::SeverityType::warning>("Unable to read configuration file. Starting in windowed mode!");
-			}
 		}
 
 		return { };
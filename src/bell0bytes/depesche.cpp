@@ -6,16 +6,41 @@ namespace core
 	/////////////////////////////////////////////////////////////////////////////////////////
 	///////////////////////////// Constructor and Destructor ////////////////////////////////
 	/////////////////////////////////////////////////////////////////////////////////////////
-	Depesche::Depesche() : sender(nullptr), destination(nullptr), type((DepescheTypes)0), message(nullptr)
+	Depesche::Depesche() : sender(nullptr), destination(nullptr), type((DepescheTypes)0), payload()
 	{
 
 	}
 
-	Depesche::Depesche(DepescheSender& sender, DepescheDestination& destination, const DepescheTypes type, void* const msg) : sender(&sender), destination(&destination), type(type), message(msg)
+	Depesche::Depesche(DepescheSender& sender, DepescheDestination& destination, const DepescheTypes type) : sender(&sender), destination(&destination), type(type), payload()
 	{
 
 	}
 
 	Depesche::~Depesche()
 	{ }
+
+	DepescheDestination::DepescheDestination()
+	{
+		for (unsigned int i = 0; i < NumberOfDepescheTypes; i++)
+			handlers[i] = &forwardToOnMessage;
+	}
+
+	/////////////////////////////////////////////////////////////////////////////////////////
+	//////////////////////////////////// Messages ///////////////////////////////////////////
+	/////////////////////////////////////////////////////////////////////////////////////////
+	util::Expected<void> DepescheDestination::onMessages(const Depesche* const depesches, const size_t nDepesches)
+	{
+		// error handling
+		util::Expected<void> result;
+
+		for (size_t i = 0; i < nDepesches; i++)
+		{
+			result = handleMessage(depesches[i]);
+			if (!result.isValid())
+				return result;
+		}
+
+		// return success
+		return { };
+	}
 }
\ No newline at end of file
@@ -6,32 +6,89 @@
 *
 * Desc:		structure to define game events on the event queue
 *			"Depesche" is the German word for telegram
-* Hist:
+* Hist:		- 16/10/26: the payload is now stored inline and typed by the type of the depesche
+*			- 16/10/26: destinations can register a handler for each type of depesche
+*			- 16/10/26: destinations can handle batches of depesches of the same type
+*			- 17/10/26: getting the payload asserts that the requested type is the type of the depesche
 ****************************************************************************************/
 
 // INCLUDES /////////////////////////////////////////////////////////////////////////////
 
+// c++ includes
+#include <cassert>				// payload type checks
+#include <cstring>				// memcpy
+#include <type_traits>			// aligned storage and type traits
+
 // bell0bytes util
 #include "expected.h"
 
 // DEFINITIONS //////////////////////////////////////////////////////////////////////////
+namespace audio
+{
+	struct SoundEvent;
+	struct StreamEvent;
+}
+
 namespace core
 {
-	enum DepescheTypes { ActiveKeyMap, Gamepad, Damage, PlaySoundEvent, StopSoundEvent, BeginStream, EndStream };
+	enum DepescheTypes { ActiveKeyMap, Gamepad, Damage, PlaySoundEvent, StopSoundEvent, BeginStream, EndStream, NumberOfDepescheTypes };
 
 	class DepescheSender;
 	class DepescheDestination;
 
+	// the payload carried by each type of depesche
+	struct NoPayload { };
+	template<DepescheTypes type> struct DepeschePayload;
+	template<> struct DepeschePayload<ActiveKeyMap> { typedef bool Type; };							// true iff a new key chord was received while listening
+	template<> struct DepeschePayload<Gamepad> { typedef float Type; };								// the gamepad vibration speed
+	template<> struct DepeschePayload<Damage> { typedef unsigned int Type; };						// the number of cats still alive
+	template<> struct DepeschePayload<PlaySoundEvent> { typedef const audio::SoundEvent* Type; };	// the sound to play
+	template<> struct DepeschePayload<StopSoundEvent> { typedef const audio::SoundEvent* Type; };	// the sound to stop
+	template<> struct DepeschePayload<BeginStream> { typedef const audio::StreamEvent* Type; };		// the file to stream
+	template<> struct DepeschePayload<EndStream> { typedef NoPayload Type; };
+
 	struct Depesche
 	{
+	public:
+		static const size_t payloadSize = 16;		// the maximal size of a payload
+
 		DepescheSender* const sender;				// the sender of the message
 		DepescheDestination* const destination;		// the destined receiver of the message
 		const DepescheTypes type;					// the type of the message
-		void* const message;						// the actual message
 
+	private:
+		std::aligned_storage<payloadSize>::type payload;	// the actual message, stored inline
+
+		Depesche(DepescheSender&, DepescheDestination&, const DepescheTypes);
+
+	public:
 		Depesche();
-		Depesche(DepescheSender&, DepescheDestination&, const DepescheTypes, void* const);
 		~Depesche();
+
+		// create a depesche of the given type - the payload is copied into the depesche
+		template<DepescheTypes depescheType>
+		static Depesche create(DepescheSender& sender, DepescheDestination& destination, const typename DepeschePayload<depescheType>::Type& message = typename DepeschePayload<depescheType>::Type())
+		{
+			typedef typename DepeschePayload<depescheType>::Type Payload;
+			static_assert(sizeof(Payload) <= payloadSize, "The payload is too large to be stored in a depesche!");
+			static_assert(std::is_trivially_copyable<Payload>::value, "The payload of a depesche must be trivially copyable!");
+
+			Depesche depesche(sender, destination, depescheType);
+			std::memcpy(&depesche.payload, &message, sizeof(Payload));
+			return depesche;
+		}
+
+		// get the payload - the type of the depesche must match the requested type
+		// (the compiler only checks the size of the payload and that it can be copied; the type is checked in debug builds)
+		template<DepescheTypes depescheType>
+		const typename DepeschePayload<depescheType>::Type getMessage() const
+		{
+			assert(type == depescheType && "The depesche does not carry a payload of the requested type!");
+
+			typename DepeschePayload<depescheType>::Type message;
+			std::memcpy(&message, &payload, sizeof(message));
+			return message;
+		}
 	};
 
 	class DepescheSender
@@ -41,9 +98,42 @@ namespace core
 
 	class DepescheDestination
 	{
+	public:
+		typedef util::Expected<void>(*Handler)(DepescheDestination&, const Depesche&);
+
 	private:
+		Handler handlers[NumberOfDepescheTypes];	// the handler for each type of depesche
+
+		// the default handler: forward the message to the onMessage function
+		static util::Expected<void> forwardToOnMessage(DepescheDestination& destination, const Depesche& depesche) { return destination.onMessage(depesche); }
+
+		// call a member function of the actual destination
+		template<class Destination, util::Expected<void>(Destination::*handler)(const Depesche&)>
+		static util::Expected<void> invokeHandler(DepescheDestination& destination, const Depesche& depesche) { return (static_cast<Destination&>(destination).*handler)(depesche); }
+
+	protected:
+		DepescheDestination();
+
+		// register a member function to handle all depesches of the given type (call once, in the constructor)
+		template<DepescheTypes depescheType, class Destination, util::Expected<void>(Destination::*handler)(const Depesche&)>
+		void registerHandler()
+		{
+			handlers[depescheType] = &invokeHandler<Destination, handler>;
+		}
 
 	public:
-		virtual util::Expected<void> onMessage(const Depesche&) = 0;// { return { }; }	// handle events
+		// handle events: jump to the registered handler
+		util::Expected<void> handleMessage(const Depesche& depesche) { return handlers[depesche.type](*this, depesche); }
+
+		// handle all events without a registered handler
+		virtual util::Expected<void> onMessage(const Depesche&) { return { }; }
+
+		// handle a batch of events of the same type, sent to this destination
+		// the default implementation handles each depesche on its own
+		virtual util::Expected<void> onMessages(const Depesche* const depesches, const size_t nDepesches);
+
+		// destinations that do not care about the order of depesches of different types may return true here,
+		// the batched dispatcher then groups all their depesches by type; by default the order in which the depesches were sent is kept
+		virtual bool isOrderInsensitive() const { return false; }
 	};
 }
\ No newline at end of file
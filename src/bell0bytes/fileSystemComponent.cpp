@@ -4,9 +4,14 @@
 // windows
 #include <Shlobj.h>				// directory folders
 
+// Lua and Sol
+#include <sol.hpp>				// the configuration file is a Lua script
+#pragma comment(lib, "liblua53.a")
+
 // bell0bytes utilities
 #include "expected.h"			// error handling
 #include "serviceLocator.h"		// the service locator pattern
+#include "stringConverter.h"	// convert strings
 
 namespace fileSystem
 {
@@ -43,6 +48,8 @@ namespace fileSystem
 		// check for valid configuration file
 		if (!checkConfigurationFile())
 			util::ServiceLocator::getFileLogger()->print<util::SeverityType::warning>("Non-existent or invalid configuration file. Starting with default settings.");
+		else
+			loadConfiguration();
 	}
 	FileSystemComponent::~FileSystemComponent()
 	{ }
@@ -50,7 +57,24 @@ namespace fileSystem
 	/////////////////////////////////////////////////////////////////////////////////////////
 	///////////////////////////// Configuration Files ///////////////////////////////////////
 	/////////////////////////////////////////////////////////////////////////////////////////
-	util::Expected<void> FileSystemComponent::saveConfiguration(const unsigned int width, const unsigned int height, const unsigned int index, const bool fullscreen, const bool enableJoystick, const bool enableGamepad, const float musicVolume, const float soundEffectsVolume) const
+	UserConfiguration::UserConfiguration() : fullscreen(false), width(1920), height(1080), index(-1), joystick(false), gamepad(false), musicVolume(1.0f), soundEffectsVolume(1.0f)
+	{ }
+
+	util::Expected<void> FileSystemComponent::saveConfiguration(const unsigned int width, const unsigned int height, const unsigned int index, const bool fullscreen, const bool enableJoystick, const bool enableGamepad, const float musicVolume, const float soundEffectsVolume)
+	{
+		UserConfiguration configuration;
+		configuration.width = width;
+		configuration.height = height;
+		configuration.index = (int)index;
+		configuration.fullscreen = fullscreen;
+		configuration.joystick = enableJoystick;
+		configuration.gamepad = enableGamepad;
+		configuration.musicVolume = musicVolume;
+		configuration.soundEffectsVolume = soundEffectsVolume;
+
+		return saveConfiguration(configuration);
+	}
+	util::Expected<void> FileSystemComponent::saveConfiguration(const UserConfiguration& configuration)
 	{
 		// create directory (if it does not exist already)
 		HRESULT hr;
@@ -59,42 +83,27 @@ namespace fileSystem
 		if (FAILED(hr))
 			return std::runtime_error("Critical error: unable to get path to 'My Documents' folder!");
 #endif
-		// append name of the log file to the path
+		// append name of the configuration file to the path
 		std::wstring pathToPrefFile = pathToUserConfigurationFiles + L"\\" + userPrefFile; // L"\\bell0prefs.lua";
 
-		// the directory exists, check if the log file is accessible
-		std::ifstream prefStream(pathToPrefFile.c_str());
-		if (prefStream.good())
+		// write the file (the file is created if it does not exist yet)
+		try
 		{
-			// the file exists and can be read
-			try
-			{
-				util::Logger<util::FileLogPolicy> prefFileCreator(pathToPrefFile.c_str());
-				std::stringstream printPref;
-				printPref << "config =\r\n{ \r\n\tfullscreen = " << std::boolalpha << fullscreen << ",\r\n\tresolution = { width = " << width << ", height = " << height << ", index = " << index << " },\r\n\tjoystick = " << enableJoystick << ",\r\n\tgamepad = " << enableGamepad << ",\r\n" << "\tmusicVolume = " << musicVolume << ",\r\n " << "\tsoundEffectsVolume = " << soundEffectsVolume << "\r\n}";
-				prefFileCreator.print<util::config>(printPref.str());
-			}
-			catch (std::exception& e)
-			{
-				return e;
-			}
+			util::Logger<util::FileLogPolicy> prefFileCreator(pathToPrefFile.c_str());
+			std::stringstream printPref;
+			printPref << "config =\r\n{ \r\n\tfullscreen = " << std::boolalpha << configuration.fullscreen << ",\r\n\tresolution = { width = " << configuration.width << ", height = " << configuration.height << ", index = " << configuration.index << " },\r\n\tjoystick = " << configuration.joystick << ",\r\n\tgamepad = " << configuration.gamepad << ",\r\n" << "\tmusicVolume = " << configuration.musicVolume << ",\r\n " << "\tsoundEffectsVolume = " << configuration.soundEffectsVolume << "\r\n}";
+			prefFileCreator.print<util::config>(printPref.str());
 		}
-		else
+		catch (std::exception& e)
 		{
-			// the file does not exist --> create it
-			try
-			{
-				util::Logger<util::FileLogPolicy> prefFileCreator(pathToPrefFile.c_str());
-				std::stringstream printPref;
-				printPref << "config =\r\n{ \r\n\tfullscreen = " << std::boolalpha << fullscreen << ",\r\n\tresolution = { width = " << width << ", height = " << height << ", index = " << index << " },\r\n\tjoystick = " << enableJoystick << ",\r\n\tgamepad = " << enableGamepad << ",\r\n" << "\tmusicVolume = " << musicVolume << ",\r\n " << "\tsoundEffectsVolume = " << soundEffectsVolume << "\r\n}";
-				prefFileCreator.print<util::config>(printPref.str());
-			}
-			catch (std::exception& e)
-			{
-				return e;
-			}
+			return e;
 		}
 
+		// write through to the cache
+		userConfiguration = configuration;
+		validUserConfigurationFile = true;
+		writeConfigurationSnapshot();
+
 		// return success
 		return {};
 	}
@@ -122,7 +131,7 @@ namespace fileSystem
 				{
 					util::Logger<util::FileLogPolicy> prefFileCreator(pathToPrefFile.c_str());
 					std::stringstream printPref;
-					printPref << "config =\r\n{ \r\n\tfullscreen = true,\r\n\tresolution = { width = 1920, height = 1080 },\r\n\tjoystick = false,\r\n\tgamepad = false\r\n\tmusicVolume = 1,\r\n\tsoundEffectsVolume = 1\r\n}";
+					printPref << "config =\r\n{ \r\n\tfullscreen = true,\r\n\tresolution = { width = 1920, height = 1080 },\r\n\tjoystick = false,\r\n\tgamepad = false,\r\n\tmusicVolume = 1,\r\n\tsoundEffectsVolume = 1\r\n}";
 					prefFileCreator.print<util::config>(printPref.str());
 				}
 				catch (std::runtime_error)
@@ -138,7 +147,7 @@ namespace fileSystem
 			{
 				util::Logger<util::FileLogPolicy> prefFileCreator(pathToPrefFile.c_str());
 				std::stringstream printPref;
-				printPref << "config =\r\n{ \r\n\tfullscreen = true,\r\n\tresolution = { width = 1920, height = 1080 },\r\n\tjoystick = false,\r\n\tgamepad = false\r\n\tmusicVolume = 1,\r\n\tsoundEffectsVolume = 1\r\n}";
+				printPref << "config =\r\n{ \r\n\tfullscreen = true,\r\n\tresolution = { width = 1920, height = 1080 },\r\n\tjoystick = false,\r\n\tgamepad = false,\r\n\tmusicVolume = 1,\r\n\tsoundEffectsVolume = 1\r\n}";
 				prefFileCreator.print<util::config>(printPref.str());
 			}
 			catch (std::runtime_error)
@@ -151,6 +160,133 @@ namespace fileSystem
 		return true;
 	}
 
+	/////////////////////////////////////////////////////////////////////////////////////////
+	///////////////////////////// Configuration Cache ///////////////////////////////////////
+	/////////////////////////////////////////////////////////////////////////////////////////
+	void FileSystemComponent::loadConfiguration()
+	{
+#ifndef NDEBUG
+		LARGE_INTEGER frequency, startTime, endTime;
+		QueryPerformanceFrequency(&frequency);
+		QueryPerformanceCounter(&startTime);
+#endif
+		// the snapshot is only valid as long as the Lua file is unchanged
+		const bool readFromSnapshot = readConfigurationSnapshot();
+		if (!readFromSnapshot)
+		{
+			if (!parseConfigurationFile())
+			{
+				util::ServiceLocator::getFileLogger()->print<util::SeverityType::warning>("Unable to read the configuration file. Starting with default settings.");
+				userConfiguration = UserConfiguration();
+				validUserConfigurationFile = false;
+				return;
+			}
+
+			writeConfigurationSnapshot();
+		}
+
+#ifndef NDEBUG
+		QueryPerformanceCounter(&endTime);
+		std::stringstream res;
+		res << "The configuration was read from the " << (readFromSnapshot ? "binary snapshot" : "Lua configuration file") << " in " << (double)(endTime.QuadPart - startTime.QuadPart) * 1000.0 / (double)frequency.QuadPart << " ms.";
+		util::ServiceLocator::getFileLogger()->print<util::SeverityType::info>(res.str());
+#endif
+	}
+
+	namespace
+	{
+		// the layout of the configuration snapshot
+		struct ConfigurationSnapshot
+		{
+			unsigned int magic;						// snapshotMagic
+			unsigned int version;					// snapshotVersion
+			unsigned long long luaFileTime;			// the last write time of the Lua file the snapshot was taken from
+			unsigned long long luaFileSize;			// the size of that file
+			UserConfiguration configuration;		// the cached settings
+		};
+		const unsigned int snapshotMagic = 0x46455250;		// "PREF"
+		const unsigned int snapshotVersion = 1;
+
+		// get the last write time and the size of a file
+		bool getFileStamp(const std::wstring& file, unsigned long long& writeTime, unsigned long long& size)
+		{
+			WIN32_FILE_ATTRIBUTE_DATA attributes;
+			if (!GetFileAttributesExW(file.c_str(), GetFileExInfoStandard, &attributes))
+				return false;
+
+			writeTime = ((unsigned long long)attributes.ftLastWriteTime.dwHighDateTime << 32) | attributes.ftLastWriteTime.dwLowDateTime;
+			size = ((unsigned long long)attributes.nFileSizeHigh << 32) | attributes.nFileSizeLow;
+			return true;
+		}
+	}
+
+	const bool FileSystemComponent::readConfigurationSnapshot()
+	{
+		unsigned long long luaFileTime, luaFileSize;
+		if (!getFileStamp(pathToUserConfigurationFiles + L"\\" + userPrefFile, luaFileTime, luaFileSize))
+			return false;
+
+		std::ifstream snapshotStream(userPrefSnapshotFile.c_str(), std::ios::binary);
+		if (!snapshotStream.good())
+			return false;
+
+		ConfigurationSnapshot snapshot;
+		if (!snapshotStream.read((char*)&snapshot, sizeof(snapshot)))
+			return false;
+
+		// make sure the snapshot matches the current Lua file
+		if (snapshot.magic != snapshotMagic || snapshot.version != snapshotVersion || snapshot.luaFileTime != luaFileTime || snapshot.luaFileSize != luaFileSize)
+			return false;
+
+		userConfiguration = snapshot.configuration;
+		return true;
+	}
+
+	const bool FileSystemComponent::parseConfigurationFile()
+	{
+		std::wstring pathToPrefFile = pathToUserConfigurationFiles + L"\\" + userPrefFile;
+
+		try
+		{
+			sol::state lua;
+			lua.script_file(util::StringConverter::ws2s(pathToPrefFile));
+
+			// read from the configuration file, each missing value keeps its default
+			UserConfiguration configuration;
+			configuration.fullscreen = lua["config"]["fullscreen"].get_or(configuration.fullscreen);
+			configuration.width = lua["config"]["resolution"]["width"].get_or(configuration.width);
+			configuration.height = lua["config"]["resolution"]["height"].get_or(configuration.height);
+			configuration.index = lua["config"]["resolution"]["index"].get_or(configuration.index);
+			configuration.joystick = lua["config"]["joystick"].get_or(configuration.joystick);
+			configuration.gamepad = lua["config"]["gamepad"].get_or(configuration.gamepad);
+			configuration.musicVolume = lua["config"]["musicVolume"].get_or(configuration.musicVolume);
+			configuration.soundEffectsVolume = lua["config"]["soundEffectsVolume"].get_or(configuration.soundEffectsVolume);
+
+			userConfiguration = configuration;
+		}
+		catch (std::exception)
+		{
+			return false;
+		}
+
+		return true;
+	}
+
+	void FileSystemComponent::writeConfigurationSnapshot() const
+	{
+		ConfigurationSnapshot snapshot;
+		if (!getFileStamp(pathToUserConfigurationFiles + L"\\" + userPrefFile, snapshot.luaFileTime, snapshot.luaFileSize))
+			return;
+		snapshot.magic = snapshotMagic;
+		snapshot.version = snapshotVersion;
+		snapshot.configuration = userConfiguration;
+
+		// the snapshot is only a cache - if it can not be written, the Lua file is parsed again at the next start
+		std::ofstream snapshotStream(userPrefSnapshotFile.c_str(), std::ios::binary | std::ios::trunc);
+		if (snapshotStream.good())
+			snapshotStream.write((const char*)&snapshot, sizeof(snapshot));
+	}
+
 	/////////////////////////////////////////////////////////////////////////////////////////
 	///////////////////////////// Folder Paths //////////////////////////////////////////////
 	/////////////////////////////////////////////////////////////////////////////////////////
@@ -283,6 +419,7 @@ namespace fileSystem
 		keyBindingsFileKeyboard = pathToLocalAppData + L"keyBindingsKeyboard.dat";
 		keyBindingsFileJoystick = pathToLocalAppData + L"keyBindingsJoystick.dat";
 		keyBindingsFileGamepad = pathToLocalAppData + L"keyBindingsGamepad.dat";
+		userPrefSnapshotFile = pathToLocalAppData + L"bell0prefs.dat";
 
 		// return success
 		return true;
@@ -360,6 +497,17 @@ namespace fileSystem
 		// print starting message
 		util::ServiceLocator::getFileLogger()->print<util::SeverityType::info>("The file logger was created successfully.");
 #endif
+
+		// create the binary logger for hot code paths - the game runs fine without it
+		try
+		{
+			std::shared_ptr<util::BinaryLogger> binaryLogger(new util::BinaryLogger(pathToLogFiles + L"\\bell0engine.blog"));
+			util::ServiceLocator::provideBinaryLoggingService(binaryLogger);
+		}
+		catch (std::runtime_error&)
+		{
+			util::ServiceLocator::getFileLogger()->print<util::SeverityType::warning>("Unable to create the binary logger. Binary logging disabled.");
+		}
 	}
 
 	/////////////////////////////////////////////////////////////////////////////////////////
@@ -377,6 +525,10 @@ namespace fileSystem
 	{
 		return validUserConfigurationFile;
 	};
+	const UserConfiguration& FileSystemComponent::getConfiguration() const
+	{
+		return userConfiguration;
+	};
 	const bool FileSystemComponent::fileLoggerIsActive() const
 	{
 		return activeFileLogger;
@@ -5,7 +5,7 @@
 * Date:		26/06/2018 - Lenningen - Luxembourg
 *
 * Desc:		file system components of the DirectXApp class:
-* Hist:
+* Hist:		- 16/10/2026: the configuration file is parsed once and cached
 ****************************************************************************************/
 
 // INCLUDES /////////////////////////////////////////////////////////////////////////////
@@ -30,6 +30,21 @@ namespace util
 
 namespace fileSystem
 {
+	// the settings stored in the user configuration file
+	struct UserConfiguration
+	{
+		bool fullscreen;							// true iff the game starts in fullscreen mode
+		unsigned int width;							// the desired screen resolution
+		unsigned int height;
+		int index;									// the index of the desired display mode, -1 if unknown
+		bool joystick;								// true iff joystick support is enabled
+		bool gamepad;								// true iff gamepad support is enabled
+		float musicVolume;							// the volume of the music
+		float soundEffectsVolume;					// the volume of the sound effects
+
+		UserConfiguration();						// the default settings, used for each value missing in the configuration file
+	};
+
 	class FileSystemComponent
 	{
 	private:
@@ -53,6 +68,10 @@ namespace fileSystem
 
 		// configuration file names
 		const std::wstring userPrefFile;			// configuration file editable by the user
+		std::wstring userPrefSnapshotFile;			// binary snapshot of the configuration file
+
+		// the cached configuration
+		UserConfiguration userConfiguration;		// the settings read from the configuration file
 		
 		// key binding file names
 		std::wstring keyBindingsFileKeyboard;		// game input configuration file for keyboard input
@@ -67,6 +86,12 @@ namespace fileSystem
 		const bool getPathToMyDocuments();			// stores the path to the My Documents folder in the appropriate member variable
 		const bool getPathToApplicationDataFolders();// stores the paths to the application data folders
 		const bool checkConfigurationFile();		// checks the state of the configuration file, creates the file if it does not exist yet
+
+		// configuration cache
+		void loadConfiguration();					// reads the configuration snapshot, or parses the configuration file if the snapshot is outdated
+		const bool readConfigurationSnapshot();		// reads the binary snapshot, fails if the configuration file changed since the snapshot was written
+		const bool parseConfigurationFile();		// runs the Lua configuration file
+		void writeConfigurationSnapshot() const;	// writes the binary snapshot of the current configuration
 				
 		// file logger
 		void createLoggingService();				// creates the file logger and registers it as a service
@@ -80,7 +105,11 @@ namespace fileSystem
 		const std::wstring openFile(const DataFolders&, const std::wstring&) const;	// gets the correct path to a given filename in a specified data folder
 		
 		// write resolution and fullscreen state to lua file
-		util::Expected<void> saveConfiguration(const unsigned int width, const unsigned int height, const unsigned int index, const bool fullscreen, const bool enableJoystick, const bool enableGamepad, const float musicVolume, const float soundEffectsVolume) const;
+		util::Expected<void> saveConfiguration(const UserConfiguration& configuration);
+		util::Expected<void> saveConfiguration(const unsigned int width, const unsigned int height, const unsigned int index, const bool fullscreen, const bool enableJoystick, const bool enableGamepad, const float musicVolume, const float soundEffectsVolume);
+
+		// get the cached configuration - only meaningful if hasValidConfigurationFile returns true
+		const UserConfiguration& getConfiguration() const;
 
 		// get paths
 		const std::wstring& getPathToConfigurationFiles() const;
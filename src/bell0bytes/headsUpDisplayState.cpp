@@ -36,7 +36,8 @@ namespace UI
 	/////////////////////////////////////////////////////////////////////////////////////////
 	HeadsUpDisplayState::HeadsUpDisplayState(core::DirectXApp& dxApp, const std::wstring& name) : GameState(dxApp, name)
 	{
-
+		// register the message handlers
+		registerHandler<core::DepescheTypes::Damage, HeadsUpDisplayState, &HeadsUpDisplayState::onDamage>();
 	}
 
 	HeadsUpDisplayState::~HeadsUpDisplayState()
@@ -197,8 +198,24 @@ namespace UI
 					// handle interface messages
 					return handleInput(ih->activeKeyMap);
 		}
-		else if(depesche.type == core::DepescheTypes::Damage)
-			nActiveCats = *(unsigned int*)depesche.message;
+
+		// return success
+		return { };
+	}
+
+	util::Expected<void> HeadsUpDisplayState::onMessages(const core::Depesche* const depesches, const size_t nDepesches)
+	{
+		// only the most recent number of cats is of interest
+		if (nDepesches > 0 && depesches[0].type == core::DepescheTypes::Damage)
+			return onDamage(depesches[nDepesches - 1]);
+
+		return core::DepescheDestination::onMessages(depesches, nDepesches);
+	}
+
+	util::Expected<void> HeadsUpDisplayState::onDamage(const core::Depesche& depesche)
+	{
+		// update the number of cats still alive
+		nActiveCats = depesche.getMessage<core::DepescheTypes::Damage>();
 
 		// return success
 		return { };
@@ -43,6 +43,8 @@ namespace UI
 
 		HeadsUpDisplayState(core::DirectXApp& dxApp, const std::wstring& name);
 		util::Expected<void> onMessage(const core::Depesche&) override;
+		util::Expected<void> onDamage(const core::Depesche&);
+		util::Expected<void> onMessages(const core::Depesche* const depesches, const size_t nDepesches) override;
 
 	public:
 		virtual ~HeadsUpDisplayState();
@@ -7,10 +7,6 @@
 #include <wbemidl.h>
 #include <oleauto.h>
 
-// Lua and Sol
-#include <sol.hpp>
-#pragma comment(lib, "liblua53.a")
-
 // include class header
 #include "inputHandler.h"
 
@@ -267,7 +263,7 @@ namespace input
 					if (!(*it)->isPaused)
 					{
 						core::DepescheDestination* destination = *it;
-						core::Depesche depesche(*this, *destination, core::DepescheTypes::Gamepad, false);
+						core::Depesche depesche = core::Depesche::create<core::DepescheTypes::Gamepad>(*this, *destination);
 						dxApp.addMessage(depesche);
 					}
 				}
@@ -370,7 +366,7 @@ namespace input
 				if (!(*it)->isPaused)
 				{
 					core::DepescheDestination* destination = *it;
-					core::Depesche depesche(*this, *destination, core::DepescheTypes::ActiveKeyMap, false);
+					core::Depesche depesche = core::Depesche::create<core::DepescheTypes::ActiveKeyMap>(*this, *destination, false);
 					dxApp.addMessage(depesche);
 				}
 			}
@@ -404,8 +400,7 @@ namespace input
 						if (!(*it)->isPaused)
 						{
 							core::DepescheDestination* destination = (*it);
-							bool doListen = true;
-							core::Depesche depesche(*this, *destination, core::DepescheTypes::ActiveKeyMap, &doListen);
+							core::Depesche depesche = core::Depesche::create<core::DepescheTypes::ActiveKeyMap>(*this, *destination, true);
 							dxApp.addMessage(depesche);
 						}
 					}
@@ -614,8 +609,7 @@ namespace input
 								if (!(*it)->isPaused)
 								{
 									core::DepescheDestination* destination = (*it);
-									bool doListen = true;
-									core::Depesche depesche(*this, *destination, core::DepescheTypes::ActiveKeyMap, &doListen);
+									core::Depesche depesche = core::Depesche::create<core::DepescheTypes::ActiveKeyMap>(*this, *destination, true);
 									dxApp.addMessage(depesche);
 								}
 							}
@@ -1593,27 +1587,15 @@ namespace input
 	{
 		if (dxApp.getFileSystemComponent().hasValidConfigurationFile())
 		{
-			// configuration file exists, try to read from it
-			std::wstring pathToPrefFile = dxApp.getFileSystemComponent().getPathToConfigurationFiles() + L"\\" + dxApp.getFileSystemComponent().getPrefsFile();
-
-			try
-			{
-				sol::state lua;
-				lua.script_file(util::StringConverter::ws2s(pathToPrefFile));
-
-				// read from the configuration file, default to false
-				activeJoystick = lua["config"]["joystick"].get_or(false);
-				activeGamepad = lua["config"]["gamepad"].get_or(false);
+			// read from the cached configuration
+			const fileSystem::UserConfiguration& configuration = dxApp.getFileSystemComponent().getConfiguration();
+			activeJoystick = configuration.joystick;
+			activeGamepad = configuration.gamepad;
 #ifndef NDEBUG
-				std::stringstream res;
-				res << "The game controller states were read from the Lua configuration file: joystick: " << std::boolalpha << activeJoystick << " --- gamepad: " << std::boolalpha << activeGamepad << ".";
-				util::ServiceLocator::getFileLogger()->print<util::SeverityType::info>(res.str());
+			std::stringstream res;
+			res << "The game controller states were read from the Lua configuration file: joystick: " << std::boolalpha << activeJoystick << " --- gamepad: " << std::boolalpha << activeGamepad << ".";
+			util::ServiceLocator::getFileLogger()->print<util::SeverityType::info>(res.str());
 #endif
-			}
-			catch (std::exception)
-			{
-				util::ServiceLocator::getFileLogger()->print<util::SeverityType::warning>("Unable to read configuration file. Joystick and gamepad support disabled!");
-			}
 		}
 	}
 
@@ -1624,7 +1606,7 @@ namespace input
 	{
 		if (depesche.type == core::DepescheTypes::Gamepad)
 		{
-			float vibrationSpeed = *(float *)depesche.message;
+			float vibrationSpeed = depesche.getMessage<core::DepescheTypes::Gamepad>();
 			gamepad->vibrate(vibrationSpeed, vibrationSpeed);
 		}
 
@@ -78,7 +78,7 @@ namespace UI
 			return result;
 
 		// send depesche to play barking sound
-		core::Depesche depesche(*this, dxApp.getAudioComponent(), core::DepescheTypes::PlaySoundEvent, introMusic);
+		core::Depesche depesche = core::Depesche::create<core::DepescheTypes::PlaySoundEvent>(*this, dxApp.getAudioComponent(), introMusic);
 		dxApp.addMessage(depesche);
 
 		return { };
@@ -8,6 +8,8 @@
 *
 * History:	- 01/07/2017: fixed a memory leak
 *			- 02/07/2017: added overloaded print function to take a string
+*			- 16/10/2026: per-thread staging buffers, lock-free handoff to the daemon and
+*						  condition-driven flushes; compile-time severity filter
 *
 ****************************************************************************************/
 
@@ -20,6 +22,9 @@
 #include <atomic>							// atomic objects (no data races) 
 #include <thread>							// individual threats
 #include <mutex>							// lockable objects
+#include <condition_variable>				// wake up the logging daemon
+#include <memory>							// unique pointers
+#include <cstdio>							// snprintf
 #include <iostream>							// input and output streams
 #include <sstream>							// string streams
 #include <fstream>							// file streams
@@ -74,6 +79,75 @@ namespace util
 		config
 	};
 
+	// compile-time severity filter: bit i of the mask is set iff messages of severity i are logged
+	// the print functions of disabled severities are empty and optimized away
+#ifndef LOG_SEVERITY_MASK
+#define LOG_SEVERITY_MASK 0xFFu
+#endif
+	template<SeverityType severity>
+	struct SeverityFilter
+	{
+		static const bool enabled = ((LOG_SEVERITY_MASK >> severity) & 1u) != 0;
+	};
+
+	/////////////////////////////////////////////////////////////////////////////////////
+	////////////////////////////// LOG LINES ////////////////////////////////////////////
+	/////////////////////////////////////////////////////////////////////////////////////
+
+	struct ThreadLogBuffer;
+
+	// a single line of the log, handed from the thread that printed it to the logging daemon
+	struct LogLine
+	{
+		LogLine* next;									// the next line in the list
+		ThreadLogBuffer* const owner;					// the thread buffer the line belongs to
+		bool hasHeader;									// true iff the line starts with a header (i.e. has to start on a new line)
+		std::string text;								// the formatted line; its capacity is kept when the line is recycled
+
+		LogLine(ThreadLogBuffer* const owner) : next(nullptr), owner(owner), hasHeader(false), text() {};
+	};
+
+	// the staging area of a single thread
+	// only the owning thread takes lines from it; the logging daemon hands written lines back through the recycled list
+	struct ThreadLogBuffer
+	{
+		const std::thread::id threadID;					// the thread owning this buffer
+		std::string threadName;							// the human-readable name of the thread
+		LogLine* freeLines;								// lines ready to be reused (owning thread only)
+		std::atomic<LogLine*> recycledLines;			// lines handed back by the logging daemon
+		std::vector<std::unique_ptr<LogLine> > lines;	// all lines ever allocated for this thread
+
+		ThreadLogBuffer(const std::thread::id threadID) : threadID(threadID), threadName(), freeLines(nullptr), recycledLines(nullptr), lines() {};
+
+		// get an empty line (owning thread only)
+		LogLine* acquireLine()
+		{
+			if (!freeLines)
+				// grab all lines the daemon has written in the meantime
+				freeLines = recycledLines.exchange(nullptr, std::memory_order_acquire);
+
+			if (!freeLines)
+			{
+				// all lines are in flight: allocate a new one
+				lines.push_back(std::unique_ptr<LogLine>(new LogLine(this)));
+				return lines.back().get();
+			}
+
+			LogLine* line = freeLines;
+			freeLines = line->next;
+			return line;
+		}
+
+		// hand a written line back to its owner (logging daemon only)
+		void recycleLine(LogLine* line)
+		{
+			LogLine* head = recycledLines.load(std::memory_order_relaxed);
+			do
+				line->next = head;
+			while (!recycledLines.compare_exchange_weak(head, line, std::memory_order_release, std::memory_order_relaxed));
+		}
+	};
+
 	/////////////////////////////////////////////////////////////////////////////////////
 	////////////////////////////// LOGGER ///////////////////////////////////////////////
 	/////////////////////////////////////////////////////////////////////////////////////
@@ -86,21 +160,55 @@ namespace util
 	template<typename LogPolicy>
 	void loggingDaemon(Logger<LogPolicy>* logger)
 	{
-		// dump log data if present
-		std::unique_lock<std::timed_mutex> lock(logger->writeMutex, std::defer_lock);
-		do
+		std::string flushBuffer;				// all lines of a batch, written at once
+		bool wroteHeader = false;				// true iff a line with a header was written already
+
+		for (;;)
 		{
-			std::this_thread::sleep_for(std::chrono::milliseconds{ 50 });
-			if (logger->logBuffer.size())
+			// sleep until there is something to write
+			{
+				std::unique_lock<std::mutex> lock(logger->wakeMutex);
+				logger->daemonIsSleeping.store(true);
+				logger->wakeCondition.wait(lock, [logger] { return logger->pendingLines.load() != nullptr || !logger->isStillRunning.load(); });
+				logger->daemonIsSleeping.store(false);
+			}
+
+			// take all pending lines at once - they are stacked, last line first
+			LogLine* lines = logger->pendingLines.exchange(nullptr, std::memory_order_acquire);
+			if (!lines)
 			{
-				if (!lock.try_lock_for(std::chrono::milliseconds{ 50 }))
-					continue;
-				for (auto& x : logger->logBuffer)
-					logger->policy.write(x);
-				logger->logBuffer.clear();
-				lock.unlock();
+				if (!logger->isStillRunning.load())
+					break;
+				continue;
 			}
-		} while (logger->isStillRunning.test_and_set() || logger->logBuffer.size());
+
+			// restore the original order
+			LogLine* ordered = nullptr;
+			while (lines)
+			{
+				LogLine* next = lines->next;
+				lines->next = ordered;
+				ordered = lines;
+				lines = next;
+			}
+
+			// gather the batch and write it with a single call
+			flushBuffer.clear();
+			while (ordered)
+			{
+				LogLine* next = ordered->next;
+				if (ordered->hasHeader)
+				{
+					if (wroteHeader)
+						flushBuffer.append("\r\n");
+					wroteHeader = true;
+				}
+				flushBuffer.append(ordered->text);
+				ordered->owner->recycleLine(ordered);
+				ordered = next;
+			}
+			logger->policy.write(flushBuffer);
+		}
 	}
 
 	// the actual logger class to be instantiated with a specific log policy
@@ -108,13 +216,35 @@ namespace util
 	class Logger
 	{
 	private:
-		unsigned int logLineNumber;								// used to save the current line number
-		std::map<std::thread::id, std::string> threadName;		// defines a human-readable name for each thread
-		LogPolicy policy;										// the log policy (i.e. write to file, ...)
-		std::timed_mutex writeMutex;							// mutual exclusive writer
-		std::vector<std::string> logBuffer;						// the content to log
-		std::thread daemon;										// the actual logging daemon
-		std::atomic_flag isStillRunning{ ATOMIC_FLAG_INIT };	// lock-free boolean to check whether our daemon is still running or not
+		std::atomic<unsigned int> logLineNumber;							// used to save the current line number
+		LogPolicy policy;													// the log policy (i.e. write to file, ...)
+		std::thread daemon;													// the actual logging daemon
+		std::atomic<bool> isStillRunning;									// true iff the logging daemon should keep running
+
+		// lock-free handoff from the printing threads to the daemon
+		std::atomic<LogLine*> pendingLines;									// the lines waiting to be written, last line first
+		std::atomic<bool> daemonIsSleeping;									// true iff the daemon might be waiting for the condition variable
+		std::mutex wakeMutex;												// protects the sleep of the daemon
+		std::condition_variable wakeCondition;								// wakes the daemon up
+
+		// the staging buffers of the threads
+		std::mutex threadBufferMutex;										// only used the first time a thread prints to this logger
+		std::vector<std::unique_ptr<ThreadLogBuffer> > threadBuffers;		// the staging buffers of all threads that ever printed
+		const unsigned int loggerID;										// unique identifier of this logger
+
+		// get the staging buffer of the calling thread
+		ThreadLogBuffer& getThreadBuffer();
+
+		// format a message and hand it to the daemon
+		template<SeverityType severity>
+		void log(const std::string& msg);
+
+		// returns a unique identifier for each logger
+		static unsigned int createLoggerID()
+		{
+			static std::atomic<unsigned int> nLoggers(0);
+			return ++nLoggers;
+		}
 
 	public:
 		// constructor and destructor
@@ -133,11 +263,11 @@ namespace util
 	};
 
 	template<typename LogPolicy>
-	Logger<LogPolicy>::Logger(const std::wstring& name) : logLineNumber(0), threadName(), policy(), writeMutex(), logBuffer()
+	Logger<LogPolicy>::Logger(const std::wstring& name) : logLineNumber(0), policy(), isStillRunning(false), pendingLines(nullptr), daemonIsSleeping(false), threadBufferMutex(), threadBuffers(), loggerID(createLoggerID())
 	{
 		if (policy.openOutputStream(name))
 		{
-			isStillRunning.test_and_set();						// mark the logging daemon as running
+			isStillRunning.store(true);							// mark the logging daemon as running
 			daemon = std::move(std::thread{ loggingDaemon<LogPolicy>, this });
 		}
 		else
@@ -152,80 +282,131 @@ namespace util
 		util::ServiceLocator::getFileLogger()->print<util::SeverityType::info>("The file logger was destroyed.");
 #endif
 		// terminate the daemon by clearing the still running flag and letting it join to the main thread
-		isStillRunning.clear();
+		{
+			std::lock_guard<std::mutex> lock(wakeMutex);
+			isStillRunning.store(false);
+		}
+		wakeCondition.notify_one();
 		daemon.join();
 
-		// clear the thread name map
-		threadName.clear();
-		std::map<std::thread::id, std::string>().swap(threadName);
-
-		// clear the log vector
-		logBuffer.clear();
-		logBuffer.shrink_to_fit();
+		// delete the staging buffers
+		threadBuffers.clear();
 
 		// close the output stream
 		policy.closeOutputStream();
 	}
 
+	template<typename LogPolicy>
+	ThreadLogBuffer& Logger<LogPolicy>::getThreadBuffer()
+	{
+		// each thread remembers the buffer it used last
+		static thread_local ThreadLogBuffer* cachedBuffer = nullptr;
+		static thread_local unsigned int cachedLoggerID = 0;
+		if (cachedLoggerID == loggerID)
+			return *cachedBuffer;
+
+		// find (or create) the buffer of this thread
+		const std::thread::id threadID = std::this_thread::get_id();
+		std::lock_guard<std::mutex> lock(threadBufferMutex);
+		ThreadLogBuffer* buffer = nullptr;
+		for (auto& threadBuffer : threadBuffers)
+			if (threadBuffer->threadID == threadID)
+				buffer = threadBuffer.get();
+		if (!buffer)
+		{
+			threadBuffers.push_back(std::unique_ptr<ThreadLogBuffer>(new ThreadLogBuffer(threadID)));
+			buffer = threadBuffers.back().get();
+		}
+
+		cachedBuffer = buffer;
+		cachedLoggerID = loggerID;
+		return *buffer;
+	}
+
 	template<typename LogPolicy>
 	void Logger<LogPolicy>::setThreadName(const std::string& name)
 	{
-		threadName[std::this_thread::get_id()] = name;
+		getThreadBuffer().threadName = name;
 	}
 
 	template<typename LogPolicy>
 	template<SeverityType severity>
-	void Logger<LogPolicy>::print(std::stringstream stream)
+	void Logger<LogPolicy>::log(const std::string& msg)
 	{
-		std::stringstream logStream;
+		ThreadLogBuffer& buffer = getThreadBuffer();
+		LogLine* line = buffer.acquireLine();
+		line->text.clear();
+		line->hasHeader = severity != SeverityType::config;
+
 #pragma warning (push)
 #pragma warning (disable: 4127)		// disable constant if expr warning
 		// all severity types but the config type allow custom formatting
-		if(!(severity == SeverityType::config))		// todo: eliminate this warning with if constexpr once version 15.3 of Visual Studio with C++-17 support is available
+		if (!(severity == SeverityType::config))
 #pragma warning (pop)
 		{
 			// get time
 			SYSTEMTIME localTime;
 			GetLocalTime(&localTime);
 
-			// header: line number and date (x: xx/xx/xxxx xx:xx:xx)
-			if (logLineNumber != 0)
-				logStream << "\r\n";
-			logStream << logLineNumber++ << ": " << localTime.wDay << "/" << localTime.wMonth << "/" << localTime.wYear << " " << localTime.wHour << ":" << localTime.wMinute << ":" << localTime.wSecond << "\t";
-
 			// write down warning level
+			const char* severityName = "";
 			switch (severity)
 			{
 			case SeverityType::info:
-				logStream << "INFO:    ";
+				severityName = "INFO:    ";
 				break;
 			case SeverityType::debug:
-				logStream << "DEBUG:   ";
+				severityName = "DEBUG:   ";
 				break;
 			case SeverityType::warning:
-				logStream << "WARNING: ";
+				severityName = "WARNING: ";
 				break;
 			case SeverityType::error:
-				logStream << "ERROR:   ";
+				severityName = "ERROR:   ";
 				break;
 			};
 
+			// header: line number and date (x: xx/xx/xxxx xx:xx:xx)
+			char header[64];
+			const int headerLength = std::snprintf(header, sizeof(header), "%u: %u/%u/%u %u:%u:%u\t%s", logLineNumber++, localTime.wDay, localTime.wMonth, localTime.wYear, localTime.wHour, localTime.wMinute, localTime.wSecond, severityName);
+			if (headerLength > 0)
+				line->text.append(header, headerLength < (int)sizeof(header) ? headerLength : (int)sizeof(header) - 1);
+
 			// write thread name
-			logStream << threadName[std::this_thread::get_id()] << ":\t";
+			line->text.append(buffer.threadName);
+			line->text.append(":\t");
 		}
-		
+
 		// write the actual message
-		logStream << stream.str();
-		std::lock_guard<std::timed_mutex> lock(writeMutex);
-		logBuffer.push_back(logStream.str());
+		line->text.append(msg);
+
+		// push the line to the pending lines of the daemon
+		LogLine* head = pendingLines.load(std::memory_order_relaxed);
+		do
+			line->next = head;
+		while (!pendingLines.compare_exchange_weak(head, line));
+
+		// wake the daemon up if it is sleeping
+		if (daemonIsSleeping.load())
+		{
+			std::lock_guard<std::mutex> lock(wakeMutex);
+			wakeCondition.notify_one();
+		}
+	}
+
+	template<typename LogPolicy>
+	template<SeverityType severity>
+	void Logger<LogPolicy>::print(std::stringstream stream)
+	{
+		if (SeverityFilter<severity>::enabled)
+			log<severity>(stream.str());
 	}
 
 	template<typename LogPolicy>
 	template<SeverityType severity>
 	void Logger<LogPolicy>::print(std::string msg)
 	{
-		std::stringstream stream;
-		stream << msg.c_str();
-		this->print<severity>(std::stringstream(stream.str()));
+		if (SeverityFilter<severity>::enabled)
+			log<severity>(msg);
 	}
 }
\ No newline at end of file
@@ -94,7 +94,7 @@ namespace UI
 		if (!musicIsPlaying)
 		{
 			// send depesche to play music
-			core::Depesche depesche(*this, dxApp.getAudioComponent(), core::DepescheTypes::BeginStream, menuMusic);
+			core::Depesche depesche = core::Depesche::create<core::DepescheTypes::BeginStream>(*this, dxApp.getAudioComponent(), menuMusic);
 			dxApp.addMessage(depesche);
 		}
 		musicIsPlaying = true;
@@ -149,7 +149,7 @@ namespace UI
 			dxApp.getAudioComponent().playSoundEvent(*buttonSound);
 			Sleep(120);
 
-			core::Depesche depesche(*this, dxApp.getAudioComponent(), core::DepescheTypes::EndStream, nullptr);
+			core::Depesche depesche = core::Depesche::create<core::DepescheTypes::EndStream>(*this, dxApp.getAudioComponent());
 			dxApp.addMessage(depesche);
 			musicIsPlaying = false;
 
@@ -452,7 +452,7 @@ namespace UI
 			delete buttonSound;
 
 		// stop menu music
-		core::Depesche depesche(*this, dxApp.getAudioComponent(), core::DepescheTypes::EndStream, nullptr);
+		core::Depesche depesche = core::Depesche::create<core::DepescheTypes::EndStream>(*this, dxApp.getAudioComponent());
 		dxApp.addMessage(depesche);
 		musicIsPlaying = false;
 
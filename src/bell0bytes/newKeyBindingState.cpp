@@ -291,7 +291,7 @@ namespace UI
 	/////////////////////////////////////////////////////////////////////////////////////////
 	util::Expected<void> NewKeyBindingState::onMessage(const core::Depesche& depesche)
 	{
-		bool isListening = depesche.message;
+		bool isListening = depesche.type == core::DepescheTypes::ActiveKeyMap && depesche.getMessage<core::DepescheTypes::ActiveKeyMap>();
 		input::InputHandler* ih = (input::InputHandler*)depesche.sender;
 		
 		if (!isListening)
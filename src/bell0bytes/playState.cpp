@@ -84,7 +84,7 @@ namespace game
 		dxApp.overlayGameState(hud);
 
 		// send depesche to play barking sound
-		core::Depesche depesche(*this, dxApp.getAudioComponent(), core::DepescheTypes::PlaySoundEvent, dogBark);
+		core::Depesche depesche = core::Depesche::create<core::DepescheTypes::PlaySoundEvent>(*this, dxApp.getAudioComponent(), dogBark);
 		dxApp.addMessage(depesche);
 
 		firstCreation = false;
@@ -430,7 +430,7 @@ namespace game
 		for (auto cat : cats)
 		{
 			// notify the NPCs about the dogs position
-			core::Depesche depesche(*dog, *cat, core::DepescheTypes::Damage, nullptr);
+			core::Depesche depesche = core::Depesche::create<core::DepescheTypes::Damage>(*dog, *cat);
 			dxApp.addMessage(depesche);
 			
 			result = cat->update(dxApp, deltaTime, *catMeow);
@@ -449,14 +449,14 @@ namespace game
 				dog->stop();
 				
 				// send depesche to play barking sound
-				core::Depesche depesche(*this, dxApp.getAudioComponent(), core::DepescheTypes::PlaySoundEvent, dogBark);
+				core::Depesche depesche = core::Depesche::create<core::DepescheTypes::PlaySoundEvent>(*this, dxApp.getAudioComponent(), dogBark);
 				dxApp.addMessage(depesche);
 				
 				gameOver = true;
 				dxApp.getInputComponent().getInputHandler().vibrateGamepad(0.0f, 0.0f);
 			}
 
-		core::Depesche depesche(*this, *hud, core::DepescheTypes::Damage, &nAliveCats);
+		core::Depesche depesche = core::Depesche::create<core::DepescheTypes::Damage>(*this, *hud, nAliveCats);
 		dxApp.addMessage(depesche);
 
 		// return success
@@ -664,26 +664,26 @@ namespace game
 			if (health >= 3)
 			{
 				vibrationSpeed = 0.5f;
-				core::Depesche depesche(*this, dxApp.getInputComponent().getInputHandler(), core::DepescheTypes::Gamepad, &vibrationSpeed);
+				core::Depesche depesche = core::Depesche::create<core::DepescheTypes::Gamepad>(*this, dxApp.getInputComponent().getInputHandler(), vibrationSpeed);
 				dxApp.addMessage(depesche);
 			}
 			else if (health >= 2)
 			{
 				vibrationSpeed = 0.75f;
-				core::Depesche depesche(*this, dxApp.getInputComponent().getInputHandler(), core::DepescheTypes::Gamepad, &vibrationSpeed);
+				core::Depesche depesche = core::Depesche::create<core::DepescheTypes::Gamepad>(*this, dxApp.getInputComponent().getInputHandler(), vibrationSpeed);
 				dxApp.addMessage(depesche);
 			}
 			else if (health > 0)
 			{
 				vibrationSpeed = 1.0f;
-				core::Depesche depesche(*this, dxApp.getInputComponent().getInputHandler(), core::DepescheTypes::Gamepad, &vibrationSpeed);
+				core::Depesche depesche = core::Depesche::create<core::DepescheTypes::Gamepad>(*this, dxApp.getInputComponent().getInputHandler(), vibrationSpeed);
 				dxApp.addMessage(depesche);
 			}
 		}
 		else
 		{
 			vibrationSpeed = 0.0f;
-			core::Depesche depesche(*this, dxApp.getInputComponent().getInputHandler(), core::DepescheTypes::Gamepad, &vibrationSpeed);
+			core::Depesche depesche = core::Depesche::create<core::DepescheTypes::Gamepad>(*this, dxApp.getInputComponent().getInputHandler(), vibrationSpeed);
 			dxApp.addMessage(depesche);
 		}
 
@@ -699,7 +699,7 @@ namespace game
 		if (justKilled)
 		{
 			// send depesche to play meow sound
-			core::Depesche depesche(*this, dxApp.getAudioComponent(), core::DepescheTypes::PlaySoundEvent, (void*)&soundEvent);
+			core::Depesche depesche = core::Depesche::create<core::DepescheTypes::PlaySoundEvent>(*this, dxApp.getAudioComponent(), &soundEvent);
 			dxApp.addMessage(depesche);
 
 			justKilled = false;
@@ -0,0 +1,244 @@
+#pragma once
+
+/****************************************************************************************
+* Author:	Gilles Bellot
+* Date:		16/10/2026
+*
+* Desc:		a bounded, lock-free multi-producer single-consumer ring buffer
+*			to be used in the event pattern
+*			- the storage is allocated once, in the constructor
+*			- any thread may enqueue, only the thread owning the queue may dequeue
+*			- each slot carries a sequence number (D. Vyukov's bounded queue), thus
+*			  producers only ever contend on a single atomic counter
+*			- the overflowing ring buffer never drops a message: when the ring is full,
+*			  messages are kept in a locked overflow vector until the consumer drains it
+*
+* History:
+****************************************************************************************/
+
+// INCLUDES /////////////////////////////////////////////////////////////////////////////
+
+// c++ includes
+#include <atomic>				// atomic slot sequences and positions
+#include <cstddef>				// size_t
+#include <limits>				// numeric limits
+#include <memory>				// unique pointers
+#include <mutex>				// the overflow lock
+#include <new>					// placement new
+#include <stdexcept>			// runtime errors
+#include <type_traits>			// aligned storage
+#include <utility>				// std::move
+#include <vector>				// the overflow vector
+
+// CLASSES //////////////////////////////////////////////////////////////////////////////
+namespace util
+{
+	template<class T>
+	class RingBuffer
+	{
+	private:
+		// a slot in the ring
+		struct Cell
+		{
+			std::atomic<std::size_t> sequence;											// the position this slot is ready for
+			typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;			// raw storage for the element
+		};
+
+		// keep the producer and consumer positions on different cache lines
+		static const std::size_t cacheLineSize = 64;
+
+		std::unique_ptr<Cell[]> cells;				// the preallocated slots
+		const std::size_t mask;						// capacity - 1
+		char padding0[cacheLineSize];
+		std::atomic<std::size_t> enqueuePosition;	// the next position to be claimed by a producer
+		char padding1[cacheLineSize];
+		std::size_t dequeuePosition;				// the next position to be read by the consumer
+		char padding2[cacheLineSize];
+
+		// returns the front cell, if it is ready to be read, or nullptr
+		Cell* front() const
+		{
+			Cell* cell = &cells[dequeuePosition & mask];
+			if (cell->sequence.load(std::memory_order_acquire) != dequeuePosition + 1)
+				return nullptr;
+			return cell;
+		}
+
+		// destroys the element in the front cell and hands the cell back to the producers
+		void popFront(Cell* cell)
+		{
+			reinterpret_cast<T*>(&cell->storage)->~T();
+			cell->sequence.store(dequeuePosition + mask + 1, std::memory_order_release);
+			dequeuePosition++;
+		}
+
+	public:
+		// constructor and destructor
+		explicit RingBuffer(const std::size_t capacity = 1024) : cells(), mask(capacity - 1), enqueuePosition(0), dequeuePosition(0)
+		{
+			// the capacity must be a power of two
+			if (capacity < 2 || (capacity & (capacity - 1)) != 0)
+				throw std::runtime_error("Critical error: The capacity of a ring buffer must be a power of two!");
+
+			cells.reset(new Cell[capacity]);
+			for (std::size_t i = 0; i < capacity; i++)
+				cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+		~RingBuffer()
+		{
+			// destroy the elements that were never dequeued
+			Cell* cell;
+			while ((cell = front()) != nullptr)
+				popFront(cell);
+		}
+
+		RingBuffer(const RingBuffer&) = delete;
+		RingBuffer& operator=(const RingBuffer&) = delete;
+
+		// add a message to the queue - can be called from any thread
+		// returns false if the queue is full
+		const bool enqueue(const T& t)
+		{
+			Cell* cell;
+			std::size_t position = enqueuePosition.load(std::memory_order_relaxed);
+			for (;;)
+			{
+				cell = &cells[position & mask];
+				const std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+				const std::ptrdiff_t difference = (std::ptrdiff_t)sequence - (std::ptrdiff_t)position;
+
+				if (difference == 0)
+				{
+					// the slot is free: try to claim it
+					if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+						break;
+				}
+				else if (difference < 0)
+					// the consumer did not release this slot yet: the queue is full
+					return false;
+				else
+					// another producer claimed the slot: try again
+					position = enqueuePosition.load(std::memory_order_relaxed);
+			}
+
+			// construct the element in place and publish it to the consumer
+			new (&cell->storage) T(t);
+			cell->sequence.store(position + 1, std::memory_order_release);
+			return true;
+		}
+
+		// get the front message from the queue - consumer thread only
+		// if the queue is empty, a default-constructed message is returned
+		const T dequeue()
+		{
+			Cell* cell = front();
+			if (!cell)
+				return T();
+
+			T message(std::move(*reinterpret_cast<T*>(&cell->storage)));
+			popFront(cell);
+			return message;
+		}
+
+		// move all available messages (but at most maxMessages) to the back of the given container - consumer thread only
+		// returns the number of messages moved
+		template<class Container>
+		std::size_t drainInto(Container& container, const std::size_t maxMessages = std::numeric_limits<std::size_t>::max())
+		{
+			std::size_t nMessages = 0;
+			Cell* cell;
+			while (nMessages < maxMessages && (cell = front()) != nullptr)
+			{
+				container.push_back(std::move(*reinterpret_cast<T*>(&cell->storage)));
+				popFront(cell);
+				nMessages++;
+			}
+			return nMessages;
+		}
+
+		// consumer thread only
+		const bool isEmpty() const
+		{
+			return front() == nullptr;
+		}
+
+		// true iff every claimed slot was dequeued, i.e. no producer is still writing to the ring - consumer thread only
+		const bool isDrained() const
+		{
+			return enqueuePosition.load(std::memory_order_acquire) == dequeuePosition;
+		}
+
+		const std::size_t getCapacity() const
+		{
+			return mask + 1;
+		}
+	};
+
+	// a ring buffer that does not lose messages when it is full
+	// - while the ring has room, enqueueing is lock-free
+	// - when it is full, the messages are appended to an overflow vector, under a lock
+	// - while the overflow vector holds messages, new messages are appended to it as well, thus the messages
+	//   of each producer are drained in the order they were sent
+	template<class T>
+	class OverflowingRingBuffer
+	{
+	private:
+		RingBuffer<T> ring;							// the lock-free ring
+		std::mutex overflowMutex;					// protects the overflow vector
+		std::vector<T> overflow;					// the messages that did not fit into the ring
+		std::atomic<bool> overflowing;				// true iff the overflow vector holds messages
+
+	public:
+		// constructor
+		explicit OverflowingRingBuffer(const std::size_t capacity = 1024) : ring(capacity), overflowMutex(), overflow(), overflowing(false) {};
+
+		OverflowingRingBuffer(const OverflowingRingBuffer&) = delete;
+		OverflowingRingBuffer& operator=(const OverflowingRingBuffer&) = delete;
+
+		// add a message to the queue - can be called from any thread
+		// returns false if the ring was full and the message was kept in the overflow vector
+		const bool enqueue(const T& t)
+		{
+			if (!overflowing.load(std::memory_order_acquire) && ring.enqueue(t))
+				return true;
+
+			std::lock_guard<std::mutex> lock(overflowMutex);
+			overflow.push_back(t);
+			overflowing.store(true, std::memory_order_release);
+			return false;
+		}
+
+		// move all messages to the back of the given container, the ring first, then the overflow - consumer thread only
+		// returns the number of messages moved
+		template<class Container>
+		std::size_t drainInto(Container& container)
+		{
+			std::size_t nMessages = ring.drainInto(container);
+
+			// the overflowing messages were sent after the messages in the ring, by the same producers, thus they
+			// are only taken once the ring is drained; a producer still writing to a slot delays them to the next call
+			if (overflowing.load(std::memory_order_acquire) && ring.isDrained())
+			{
+				std::lock_guard<std::mutex> lock(overflowMutex);
+				for (T& t : overflow)
+					container.push_back(std::move(t));
+				nMessages += overflow.size();
+				overflow.clear();
+				overflowing.store(false, std::memory_order_release);
+			}
+
+			return nMessages;
+		}
+
+		// consumer thread only
+		const bool isEmpty() const
+		{
+			return ring.isEmpty() && !overflowing.load(std::memory_order_acquire);
+		}
+
+		const std::size_t getCapacity() const
+		{
+			return ring.getCapacity();
+		}
+	};
+}
@@ -8,4 +8,11 @@ namespace util
 	{
 		fileLogger = providedFileLogger;
 	}
+
+	// binary logger
+	std::shared_ptr<BinaryLogger> ServiceLocator::binaryLogger = NULL;
+	void ServiceLocator::provideBinaryLoggingService(const std::shared_ptr<BinaryLogger> providedBinaryLogger)
+	{
+		binaryLogger = providedBinaryLogger;
+	}
 }
\ No newline at end of file
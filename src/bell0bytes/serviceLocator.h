@@ -7,6 +7,7 @@
 * Desc:		service locator
 *
 * History:	- 07/10/2016: added file logging service
+*			- 16/10/2026: added binary logging service
 *
 ****************************************************************************************/
 
@@ -14,6 +15,7 @@
 
 // bell0bytes
 #include "log.h"							// logging
+#include "binaryLog.h"						// binary logging
 
 namespace util
 {
@@ -23,10 +25,15 @@ namespace util
 	{
 	private:
 		static std::shared_ptr<Logger<FileLogPolicy> > fileLogger;						// the file logger
+		static std::shared_ptr<BinaryLogger> binaryLogger;								// the binary logger
 		
 	public:
 		// file logging services
 		static Logger<FileLogPolicy>* getFileLogger() { return fileLogger.get(); };									// returns the file logger
 		static void provideFileLoggingService(const std::shared_ptr<Logger<FileLogPolicy> > providedFileLogger);	// sets the file logging service to the given logger
+
+		// binary logging services
+		static BinaryLogger* getBinaryLogger() { return binaryLogger.get(); };										// returns the binary logger, or nullptr if there is none
+		static void provideBinaryLoggingService(const std::shared_ptr<BinaryLogger> providedBinaryLogger);			// sets the binary logging service to the given logger
 	};
 }
\ No newline at end of file
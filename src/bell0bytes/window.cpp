@@ -1,15 +1,5 @@
 // INCLUDES /////////////////////////////////////////////////////////////////////////////
 
-// Lua and Sol
-
-// warning supression no longer needed with C++-17
-//#pragma warning( push )
-//#pragma warning( disable : 4127)	// disable constant if expr warning
-//#pragma warning( disable : 4702)	// disable unreachable code warning
-#include <sol.hpp>
-//#pragma warning( pop ) 
-#pragma comment(lib, "liblua53.a")
-
 // bell0bytes core
 #include "app.h"
 #include "window.h"
@@ -253,27 +243,15 @@ namespace core
 	{
 		if (dxApp.getFileSystemComponent().hasValidConfigurationFile())
 		{
-			// configuration file exists, try to read from it
-			std::wstring pathToPrefFile = dxApp.getFileSystemComponent().getPathToConfigurationFiles() + L"\\bell0prefs.lua";
-
-			try
-			{
-				sol::state lua;
-				lua.script_file(util::StringConverter::ws2s(pathToPrefFile));
-
-				// read from the configuration file, default to 1920 x 1080
-				clientWidth = lua["config"]["resolution"]["width"].get_or(1920);
-				clientHeight = lua["config"]["resolution"]["height"].get_or(1080);
+			// read from the cached configuration
+			const fileSystem::UserConfiguration& configuration = dxApp.getFileSystemComponent().getConfiguration();
+			clientWidth = configuration.width;
+			clientHeight = configuration.height;
 #ifndef NDEBUG
-				std::stringstream res;
-				res << "The client resolution was read from the Lua configuration file: " << clientWidth << " x " << clientHeight << ".";
-				util::ServiceLocator::getFileLogger()->print<util::SeverityType::info>(res.str());
+			std::stringstream res;
+			res << "The client resolution was read from the Lua configuration file: " << clientWidth << " x " << clientHeight << ".";
+			util::ServiceLocator::getFileLogger()->print<util::SeverityType::info>(res.str());
 #endif
-			}
-			catch (std::exception)
-			{
-				util::ServiceLocator::getFileLogger()->print<util::SeverityType::warning>("Unable to read configuration file. Starting with default resolution: 1920 x 1080");
-			}
 		}
 	}
 }
\ No newline at end of file
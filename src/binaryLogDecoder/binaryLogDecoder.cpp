@@ -0,0 +1,310 @@
+/****************************************************************************************
+* Author:	Gilles Bellot
+* Date:		16/10/2026
+*
+* Desc:		offline decoder for the binary log files written by util::BinaryLogger
+*			turns the records back into the text format of the file logger
+*
+*			usage:	binaryLogDecoder <input.blog> [output.log]
+*					the text is written to the standard output if no output file is given
+*
+*			standard C++ only, thus the tool can be built on any platform
+*
+* History:
+****************************************************************************************/
+
+// INCLUDES /////////////////////////////////////////////////////////////////////////////
+
+// c++ includes
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// bell0bytes util
+#include "../bell0bytes/binaryLogFormat.h"
+
+// FUNCTIONS ////////////////////////////////////////////////////////////////////////////
+namespace
+{
+	using namespace util::binaryLog;
+
+	// the names of the severity types, as printed by the file logger
+	const char* severityName(const uint8_t severity)
+	{
+		switch (severity)
+		{
+		case 0: return "INFO:    ";
+		case 1: return "DEBUG:   ";
+		case 2: return "WARNING: ";
+		case 3: return "ERROR:   ";
+		default: return "";
+		}
+	}
+
+	// read a value from the buffer; returns false if the buffer is too short
+	template<typename T>
+	bool readValue(const char*& in, const char* const end, T& value)
+	{
+		if ((size_t)(end - in) < sizeof(T))
+			return false;
+		std::memcpy(&value, in, sizeof(T));
+		in += sizeof(T);
+		return true;
+	}
+
+	// decode a single argument and append it to the output; returns false if the argument is corrupted
+	bool decodeArgument(const char*& in, const char* const end, std::string& out)
+	{
+		uint8_t type = 0;
+		if (!readValue(in, end, type))
+			return false;
+
+		char buffer[64];
+		switch (type)
+		{
+		case Int32:
+		{
+			int32_t value;
+			if (!readValue(in, end, value))
+				return false;
+			snprintf(buffer, sizeof(buffer), "%d", value);
+			break;
+		}
+		case UInt32:
+		{
+			uint32_t value;
+			if (!readValue(in, end, value))
+				return false;
+			snprintf(buffer, sizeof(buffer), "%u", value);
+			break;
+		}
+		case Int64:
+		{
+			int64_t value;
+			if (!readValue(in, end, value))
+				return false;
+			snprintf(buffer, sizeof(buffer), "%lld", (long long)value);
+			break;
+		}
+		case UInt64:
+		{
+			uint64_t value;
+			if (!readValue(in, end, value))
+				return false;
+			snprintf(buffer, sizeof(buffer), "%llu", (unsigned long long)value);
+			break;
+		}
+		case Double:
+		{
+			double value;
+			if (!readValue(in, end, value))
+				return false;
+			snprintf(buffer, sizeof(buffer), "%.20g", value);
+			break;
+		}
+		case String:
+		{
+			uint16_t length;
+			if (!readValue(in, end, length) || (size_t)(end - in) < length)
+				return false;
+			out.append(in, length);
+			in += length;
+			return true;
+		}
+		default:
+			return false;
+		}
+
+		out.append(buffer);
+		return true;
+	}
+
+	// find the next committed record, starting at the given position; returns false at the end of the file
+	// uncommitted records, reserved but never completed, are skipped using their size
+	// if the size is damaged as well, the search continues at the next aligned offset
+	bool nextRecord(const char*& in, const char* const end, RecordHeader& record, unsigned int& nUncommittedRecords)
+	{
+		while ((size_t)(end - in) >= sizeof(RecordHeader))
+		{
+			std::memcpy(&record, in, sizeof(record));
+			const bool validSize = record.size >= sizeof(RecordHeader) && record.size % recordAlignment == 0 && record.size <= (size_t)(end - in);
+
+			if (validSize && isCommitted(record.type))
+				return true;
+
+			if (validSize && record.type == Uncommitted)
+			{
+				nUncommittedRecords++;
+				in += record.size;
+			}
+			else
+				in += recordAlignment;
+		}
+
+		return false;
+	}
+
+	// decode a message record
+	bool decodeMessage(const FileHeader& fileHeader, const MessageHeader& header, const std::string& format, const char* in, const char* const end, const unsigned int lineNumber, std::string& out)
+	{
+		// compute the local time of the message
+		std::tm time = { };
+		time.tm_year = fileHeader.year - 1900;
+		time.tm_mon = fileHeader.month - 1;
+		time.tm_mday = fileHeader.day;
+		time.tm_hour = fileHeader.hour;
+		time.tm_min = fileHeader.minute;
+		time.tm_sec = fileHeader.second;
+		time.tm_isdst = -1;
+
+		double elapsedSeconds = 0.0;
+		if (fileHeader.ticksPerSecond && header.ticks >= fileHeader.startTicks)
+			elapsedSeconds = (double)(header.ticks - fileHeader.startTicks) / (double)fileHeader.ticksPerSecond;
+		time.tm_sec += (int)elapsedSeconds;
+		std::mktime(&time);
+		const unsigned int milliseconds = (unsigned int)((elapsedSeconds - (double)(long long)elapsedSeconds) * 1000.0);
+
+		// header: line number and date (x: xx/xx/xxxx xx:xx:xx.xxx)
+		char buffer[128];
+		snprintf(buffer, sizeof(buffer), "%u: %d/%d/%d %d:%d:%d.%03u\t%sthread %u:\t", lineNumber, time.tm_mday, time.tm_mon + 1, time.tm_year + 1900, time.tm_hour, time.tm_min, time.tm_sec, milliseconds, severityName(header.severity), header.threadID);
+		out.append(buffer);
+
+		// replace each "{}" by the next argument
+		unsigned int nDecodedArguments = 0;
+		size_t position = 0;
+		while (position < format.size())
+		{
+			const size_t placeholder = format.find("{}", position);
+			if (placeholder == std::string::npos)
+			{
+				out.append(format, position, std::string::npos);
+				break;
+			}
+
+			out.append(format, position, placeholder - position);
+			if (nDecodedArguments < header.nArguments)
+			{
+				if (!decodeArgument(in, end, out))
+					return false;
+				nDecodedArguments++;
+			}
+			position = placeholder + 2;
+		}
+
+		// append superfluous arguments
+		for (; nDecodedArguments < header.nArguments; nDecodedArguments++)
+		{
+			out.append(" ");
+			if (!decodeArgument(in, end, out))
+				return false;
+		}
+
+		return true;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2 || argc > 3)
+	{
+		std::cerr << "Usage: binaryLogDecoder <input.blog> [output.log]" << std::endl;
+		return 1;
+	}
+
+	// read the entire file
+	std::ifstream inputStream(argv[1], std::ios_base::binary);
+	if (!inputStream.is_open())
+	{
+		std::cerr << "ERROR: Unable to open " << argv[1] << std::endl;
+		return 1;
+	}
+	const std::vector<char> data((std::istreambuf_iterator<char>(inputStream)), std::istreambuf_iterator<char>());
+
+	// check the header
+	FileHeader fileHeader;
+	if (data.size() < sizeof(fileHeader))
+	{
+		std::cerr << "ERROR: " << argv[1] << " is not a binary log file!" << std::endl;
+		return 1;
+	}
+	std::memcpy(&fileHeader, data.data(), sizeof(fileHeader));
+	if (fileHeader.magic != fileMagic || fileHeader.version != fileVersion)
+	{
+		std::cerr << "ERROR: " << argv[1] << " is not a binary log file of version " << fileVersion << "!" << std::endl;
+		return 1;
+	}
+
+	const char* const begin = data.data() + sizeof(fileHeader);
+	const char* const end = data.data() + data.size();
+
+	// first pass: collect the format strings - a format may be written after the first message using it
+	std::unordered_map<uint32_t, std::string> formats;
+	unsigned int nUncommittedRecords = 0;
+	RecordHeader record;
+	for (const char* in = begin; nextRecord(in, end, record, nUncommittedRecords); in += record.size)
+	{
+		if (record.type == FormatRecord)
+		{
+			// strip the padding
+			const char* const format = in + sizeof(RecordHeader);
+			formats[record.formatID].assign(format, std::find(format, in + record.size, '\0'));
+		}
+	}
+
+	// second pass: decode the messages
+	std::string text;
+	unsigned int lineNumber = 0, nCorruptedRecords = 0;
+	nUncommittedRecords = 0;
+	for (const char* in = begin; nextRecord(in, end, record, nUncommittedRecords); in += record.size)
+	{
+		if (record.type == MessageRecord)
+		{
+			MessageHeader header;
+			std::string line;
+			const auto format = formats.find(record.formatID);
+			if (record.size >= sizeof(MessageHeader))
+				std::memcpy(&header, in, sizeof(header));
+
+			if (record.size < sizeof(MessageHeader) || format == formats.end() || !decodeMessage(fileHeader, header, format->second, in + sizeof(MessageHeader), in + record.size, lineNumber, line))
+				nCorruptedRecords++;
+			else
+			{
+				if (lineNumber++ != 0)
+					text.append("\r\n");
+				text.append(line);
+			}
+		}
+	}
+
+	// write the text
+	if (argc == 3)
+	{
+		std::ofstream outputStream(argv[2], std::ios_base::binary | std::ios_base::out);
+		if (!outputStream.is_open())
+		{
+			std::cerr << "ERROR: Unable to create " << argv[2] << std::endl;
+			return 1;
+		}
+		outputStream << text;
+	}
+	else
+		std::cout << text << std::endl;
+
+	std::cerr << "Decoded " << lineNumber << " messages";
+	if (nCorruptedRecords)
+		std::cerr << ", skipped " << nCorruptedRecords << " corrupted records";
+	if (nUncommittedRecords)
+		std::cerr << ", skipped " << nUncommittedRecords << " incomplete records";
+	std::cerr << "." << std::endl;
+
+	return 0;
+}